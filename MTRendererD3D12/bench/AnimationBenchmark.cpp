@@ -0,0 +1,130 @@
+/// @file AnimationBenchmark.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "BenchCommon.h"
+#include "AnimationClip.h"
+#include "AnimationSystem.h"
+#include "JobSystem.h"
+#include "TransformHierarchy.h"
+
+using namespace DirectX;
+
+namespace {
+    const UINT  SMOKE_INSTANCE_COUNT    = 2000;
+    const UINT  SMOKE_REPEAT_COUNT      = 3;
+    const UINT  DEFAULT_INSTANCE_COUNT  = 100000;
+    const UINT  DEFAULT_REPEAT_COUNT    = 20;
+    const UINT  CLIP_COUNT              = 64;
+    const UINT  CLIP_FRAME_COUNT        = 120;
+    const float FRAME_DELTA             = 1.0f / 60.0f;
+
+    /// @~english
+    /// @brief Clip turning and bobbing at its own rate
+    /// @~japanese
+    /// @brief 固有の速さで回転し上下するクリップ
+    bool BuildClip(UINT seed, AnimationClip *dstClip) {
+        AnimationClipSource source;
+        const float rate = 0.5f + static_cast<float>(seed % 7) * 0.25f;
+        for (UINT i = 0; i < CLIP_FRAME_COUNT; ++i) {
+            const float t = static_cast<float>(i) / source.sampleRate * rate;
+            XMFLOAT4 q;
+            XMStoreFloat4(&q, XMQuaternionRotationRollPitchYaw(t * 0.7f, t * 1.3f, t * 0.3f));
+            source.rotations.push_back(q);
+            source.translations.push_back(XMFLOAT3(std::sin(t), std::cos(t * 0.5f), static_cast<float>(seed)));
+            source.scales.push_back(XMFLOAT3(1.0f + 0.2f * std::sin(t), 1.0f, 1.0f));
+        }
+        return dstClip->Build(source);
+    }
+
+    /// @~english
+    /// @brief Time SampleBatch against a loop of the scalar AnimationClip::Sample, for nlerp and slerp
+    /// @~japanese
+    /// @brief SampleBatchをスカラーのAnimationClip::Sampleのループと比較して計測、nlerpとslerpそれぞれ
+    void RunSampling(const std::vector<AnimationClip> &clipPool, UINT instanceCount, UINT repeatCount) {
+        std::vector<const AnimationClip *> clips(instanceCount);
+        std::vector<float> times(instanceCount);
+        std::vector<UINT> dstIndices(instanceCount);
+        for (UINT i = 0; i < instanceCount; ++i) {
+            clips[i]      = &clipPool[(i * 7) % clipPool.size()];
+            times[i]      = static_cast<float>(i % 97) / 97.0f * clips[i]->GetDuration();
+            dstIndices[i] = i;
+        }
+        std::vector<XMVECTOR> translations(instanceCount), rotations(instanceCount), scales(instanceCount);
+
+        for (bool slerp : { false, true }) {
+            const float scalarTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+                for (UINT i = 0; i < instanceCount; ++i) {
+                    clips[i]->Sample(times[i], slerp, &translations[i], &rotations[i], &scales[i]);
+                }
+            });
+            ReportBenchCase(slerp ? "AnimationClip::Sample (scalar, slerp)" : "AnimationClip::Sample (scalar, nlerp)", instanceCount, scalarTimeInMs);
+
+            const float batchTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+                AnimationSystem::SampleBatch(instanceCount, clips.data(), times.data(), dstIndices.data(), slerp, translations.data(), rotations.data(), scales.data());
+            });
+            ReportBenchCase(slerp ? "AnimationSystem::SampleBatch (slerp)" : "AnimationSystem::SampleBatch (nlerp)", instanceCount, batchTimeInMs);
+
+            char reportStr[256];
+            snprintf(reportStr, sizeof(reportStr), "  SampleBatch speedup over scalar: %.2fx\n", scalarTimeInMs / std::max(batchTimeInMs, 1e-6f));
+            OutputDebugStringA(reportStr);
+        }
+    }
+
+    /// @~english
+    /// @brief Time AnimationSystem::Update writing into a transform hierarchy, serially and on the job system
+    /// @~japanese
+    /// @brief トランスフォーム階層へ書き込むAnimationSystem::Updateを計測、逐次およびJobSystem上で
+    void RunUpdate(const std::vector<AnimationClip> &clipPool, UINT instanceCount, UINT repeatCount, JobSystem *jobSystem) {
+        TransformHierarchy hierarchy;
+        std::vector<UINT> nodes(instanceCount);
+        hierarchy.CreateRootNodes(instanceCount, nodes.data());
+
+        AnimationSystem animationSystem;
+        for (UINT i = 0; i < instanceCount; ++i) {
+            animationSystem.Play(&clipPool[i % clipPool.size()], nodes[i], 1.0f + static_cast<float>(i % 5) * 0.1f, true);
+        }
+
+        const float serialTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+            animationSystem.Update(FRAME_DELTA, &hierarchy, nullptr);
+        });
+        ReportBenchCase("AnimationSystem::Update (serial)", instanceCount, serialTimeInMs);
+
+        const float parallelTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+            animationSystem.Update(FRAME_DELTA, &hierarchy, jobSystem);
+        });
+        ReportBenchCase("AnimationSystem::Update (JobSystem)", instanceCount, parallelTimeInMs);
+    }
+} // namespace ""
+
+/// @~english
+/// @brief Time the batched SIMD animation sampler against the scalar reference
+/// @details AnimationClip::Sample per instance against AnimationSystem::SampleBatch over the same instances, then
+///          the whole AnimationSystem::Update. "-instances <count>", "-repeat <count>".
+/// @~japanese
+/// @brief バッチ化したSIMDのアニメーションのサンプリングをスカラーの基準実装と比較して計測
+/// @details 同じインスタンスに対するインスタンス毎のAnimationClip::SampleとAnimationSystem::SampleBatch、
+///          次にAnimationSystem::Update全体
+int main(int argc, char **argv) {
+    const bool smoke = IsSmokeRun(argc, argv);
+    const UINT instanceCount = GetBenchOption(argc, argv, "-instances", smoke ? SMOKE_INSTANCE_COUNT : DEFAULT_INSTANCE_COUNT);
+    const UINT repeatCount   = GetBenchOption(argc, argv, "-repeat", smoke ? SMOKE_REPEAT_COUNT : DEFAULT_REPEAT_COUNT);
+
+    std::vector<AnimationClip> clipPool(CLIP_COUNT);
+    for (UINT i = 0; i < CLIP_COUNT; ++i) {
+        if (!BuildClip(i, &clipPool[i])) {
+            return -1;
+        }
+    }
+
+    JobSystem jobSystem;
+    if (!jobSystem.Init(0)) {
+        return -1;
+    }
+
+    RunSampling(clipPool, instanceCount, repeatCount);
+    RunUpdate(clipPool, instanceCount, repeatCount, &jobSystem);
+
+    jobSystem.Deinit();
+    return 0;
+}
@@ -0,0 +1,252 @@
+/// @file BVHBenchmark.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "BenchCommon.h"
+#include "BoundingVolumeHierarchy.h"
+#include "JobSystem.h"
+#include "ViewFrustum.h"
+
+#include <random>
+
+using namespace DirectX;
+
+namespace {
+    const UINT  SMOKE_OBJECT_COUNTS[]   = { 1000, 10000 };
+    const UINT  SMOKE_REPEAT_COUNT      = 3;
+    const UINT  DEFAULT_OBJECT_COUNTS[] = { 10000, 100000, 1000000 };
+    const UINT  DEFAULT_REPEAT_COUNT    = 10;
+    const UINT  QUERY_COUNT             = 64;       // Sphere, box and ray queries per run
+    const float OBJECT_SPACING          = 4.0f;     // Average distance between objects, the density stays the same at every count
+    const float OBJECT_MAX_EXTENT       = 1.0f;
+    const float QUERY_RADIUS            = 8.0f;
+    const float CAMERA_FAR_Z            = 200.0f;
+    const UINT  OBJECT_SEED             = 13;
+
+    /// @~english
+    /// @brief Object bounds and the queries run against them
+    /// @~japanese
+    /// @brief オブジェクトの境界とそれに対して実行するクエリ
+    struct BenchScene {
+        std::vector<XMFLOAT3>   boxMins;
+        std::vector<XMFLOAT3>   boxMaxs;
+        std::vector<XMFLOAT3>   queryPoints;
+        std::vector<XMFLOAT3>   rayDirections;
+        ViewFrustum             frustum;
+    };
+
+    /// @~english
+    /// @brief Scatter the objects in a cube sized for the count, the queries start inside the cube
+    /// @~japanese
+    /// @brief 数に応じた大きさの立方体内にオブジェクトを散らす、クエリは立方体内から開始する
+    void BuildScene(UINT objectCount, BenchScene *dstScene) {
+        std::mt19937 rng(OBJECT_SEED);
+        const float worldSize = std::cbrt(static_cast<float>(objectCount)) * OBJECT_SPACING;
+        std::uniform_real_distribution<float> position(0.0f, worldSize);
+        std::uniform_real_distribution<float> extent(0.1f, OBJECT_MAX_EXTENT);
+        std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+
+        dstScene->boxMins.resize(objectCount);
+        dstScene->boxMaxs.resize(objectCount);
+        for (UINT i = 0; i < objectCount; ++i) {
+            const XMVECTOR center  = XMVectorSet(position(rng), position(rng), position(rng), 0.0f);
+            const XMVECTOR extents = XMVectorSet(extent(rng), extent(rng), extent(rng), 0.0f);
+            XMStoreFloat3(&dstScene->boxMins[i], XMVectorSubtract(center, extents));
+            XMStoreFloat3(&dstScene->boxMaxs[i], XMVectorAdd(center, extents));
+        }
+
+        dstScene->queryPoints.resize(QUERY_COUNT);
+        dstScene->rayDirections.resize(QUERY_COUNT);
+        for (UINT i = 0; i < QUERY_COUNT; ++i) {
+            dstScene->queryPoints[i] = XMFLOAT3(position(rng), position(rng), position(rng));
+            XMStoreFloat3(&dstScene->rayDirections[i], XMVector3Normalize(XMVectorSet(direction(rng), direction(rng), direction(rng) + 0.01f, 0.0f)));
+        }
+
+        // Camera at the middle of one face, looking into the cube
+        // 立方体の1面の中央から内側を見るカメラ
+        const XMVECTOR eyePos  = XMVectorSet(worldSize * 0.5f, worldSize * 0.5f, 0.0f, 1.0f);
+        const XMMATRIX viewMtx = XMMatrixLookToLH(eyePos, XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+        const XMMATRIX projMtx = XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, CAMERA_FAR_Z);
+        dstScene->frustum.SetFromMatrix(XMMatrixMultiply(viewMtx, projMtx));
+    }
+
+    /// @~english
+    /// @brief Slab test of a ray against a box
+    /// @return Distance to the box, maxDistance if missed
+    /// @~japanese
+    /// @brief レイとボックスのスラブ判定
+    /// @return ボックスまでの距離、交差しない場合はmaxDistance
+    float IntersectRayBox(FXMVECTOR origin, FXMVECTOR invDirection, const XMFLOAT3 &boxMin, const XMFLOAT3 &boxMax, float maxDistance) {
+        const XMVECTOR t0 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&boxMin), origin), invDirection);
+        const XMVECTOR t1 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&boxMax), origin), invDirection);
+        XMFLOAT3 tNear, tFar;
+        XMStoreFloat3(&tNear, XMVectorMin(t0, t1));
+        XMStoreFloat3(&tFar,  XMVectorMax(t0, t1));
+        const float enter = std::max({ tNear.x, tNear.y, tNear.z, 0.0f });
+        const float exit  = std::min({ tFar.x, tFar.y, tFar.z, maxDistance });
+        return (enter <= exit) ? enter : maxDistance;
+    }
+
+    /// @~english
+    /// @brief Report the speedup of the BVH over the brute force scan, with the hits of both
+    /// @~japanese
+    /// @brief 総当たりの走査に対するBVHの速度向上を両者のヒット数と共に出力
+    void ReportSpeedup(const char *name, float bruteForceTimeInMs, float bvhTimeInMs, UINT bruteForceHitCount, UINT bvhHitCount) {
+        char reportStr[256];
+        snprintf(reportStr, sizeof(reportStr), "  %s speedup over brute force: %.2fx (hits %u / %u)\n",
+            name, bruteForceTimeInMs / std::max(bvhTimeInMs, 1e-6f), bruteForceHitCount, bvhHitCount);
+        OutputDebugStringA(reportStr);
+    }
+
+    /// @~english
+    /// @brief Time the frustum, sphere, box and ray queries of the BVH against a scan over every object
+    /// @details The BVH reports the fat boxes, so it may find a few more hits than the exact boxes of the scan.
+    /// @~japanese
+    /// @brief BVHの視錐台、球、ボックス、レイのクエリを全オブジェクトの走査と比較して計測
+    /// @details BVHは拡大したボックスで判定する為、正確なボックスの走査より多少多くヒットする事がある
+    void RunQueries(UINT objectCount, UINT repeatCount, JobSystem *jobSystem) {
+        BenchScene scene;
+        BuildScene(objectCount, &scene);
+
+        BoundingVolumeHierarchy bvh;
+        for (UINT i = 0; i < objectCount; ++i) {
+            bvh.Insert(XMLoadFloat3(&scene.boxMins[i]), XMLoadFloat3(&scene.boxMaxs[i]), i);
+        }
+        const float rebuildTimeInMs = MeasureMedianInMs(1, [&]() {
+            bvh.BeginRebuild();
+            while (!bvh.StepRebuild(jobSystem, DEFAULT_BVH_REBUILD_BUDGET_IN_MS)) {
+                ;
+            }
+        });
+        ReportBenchCase("BoundingVolumeHierarchy rebuild", objectCount, rebuildTimeInMs);
+
+        // Frustum
+        // 視錐台
+        UINT bruteForceHitCount = 0;
+        UINT bvhHitCount = 0;
+        float bruteForceTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+            bruteForceHitCount = 0;
+            for (UINT i = 0; i < objectCount; ++i) {
+                bruteForceHitCount += scene.frustum.TestBox(XMLoadFloat3(&scene.boxMins[i]), XMLoadFloat3(&scene.boxMaxs[i])) ? 1 : 0;
+            }
+        });
+        ReportBenchCase("Frustum query (brute force)", objectCount, bruteForceTimeInMs);
+        float bvhTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+            bvhHitCount = 0;
+            bvh.QueryFrustum(scene.frustum, [&](UINT) { bvhHitCount++; });
+        });
+        ReportBenchCase("Frustum query (BVH)", objectCount, bvhTimeInMs);
+        ReportSpeedup("Frustum", bruteForceTimeInMs, bvhTimeInMs, bruteForceHitCount, bvhHitCount);
+
+        // Spheres, the time per item is the time per query
+        // 球、要素あたりの時間はクエリあたりの時間
+        const XMVECTOR radiusSq = XMVectorReplicate(QUERY_RADIUS * QUERY_RADIUS);
+        bruteForceTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+            bruteForceHitCount = 0;
+            for (const auto &point : scene.queryPoints) {
+                const XMVECTOR center = XMLoadFloat3(&point);
+                for (UINT i = 0; i < objectCount; ++i) {
+                    const XMVECTOR below = XMVectorMax(XMVectorSubtract(XMLoadFloat3(&scene.boxMins[i]), center), XMVectorZero());
+                    const XMVECTOR above = XMVectorMax(XMVectorSubtract(center, XMLoadFloat3(&scene.boxMaxs[i])), XMVectorZero());
+                    bruteForceHitCount += XMVector3LessOrEqual(XMVector3LengthSq(XMVectorAdd(below, above)), radiusSq) ? 1 : 0;
+                }
+            }
+        });
+        ReportBenchCase("Sphere query (brute force)", QUERY_COUNT, bruteForceTimeInMs);
+        bvhTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+            bvhHitCount = 0;
+            for (const auto &point : scene.queryPoints) {
+                bvh.QuerySphere(XMLoadFloat3(&point), QUERY_RADIUS, [&](UINT) { bvhHitCount++; });
+            }
+        });
+        ReportBenchCase("Sphere query (BVH)", QUERY_COUNT, bvhTimeInMs);
+        ReportSpeedup("Sphere", bruteForceTimeInMs, bvhTimeInMs, bruteForceHitCount, bvhHitCount);
+
+        // Boxes
+        // ボックス
+        const XMVECTOR queryExtents = XMVectorReplicate(QUERY_RADIUS);
+        bruteForceTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+            bruteForceHitCount = 0;
+            for (const auto &point : scene.queryPoints) {
+                const XMVECTOR queryMin = XMVectorSubtract(XMLoadFloat3(&point), queryExtents);
+                const XMVECTOR queryMax = XMVectorAdd(XMLoadFloat3(&point), queryExtents);
+                for (UINT i = 0; i < objectCount; ++i) {
+                    bruteForceHitCount += (XMVector3LessOrEqual(XMLoadFloat3(&scene.boxMins[i]), queryMax) && XMVector3LessOrEqual(queryMin, XMLoadFloat3(&scene.boxMaxs[i]))) ? 1 : 0;
+                }
+            }
+        });
+        ReportBenchCase("Box query (brute force)", QUERY_COUNT, bruteForceTimeInMs);
+        bvhTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+            bvhHitCount = 0;
+            for (const auto &point : scene.queryPoints) {
+                bvh.QueryBox(XMVectorSubtract(XMLoadFloat3(&point), queryExtents), XMVectorAdd(XMLoadFloat3(&point), queryExtents), [&](UINT) { bvhHitCount++; });
+            }
+        });
+        ReportBenchCase("Box query (BVH)", QUERY_COUNT, bvhTimeInMs);
+        ReportSpeedup("Box", bruteForceTimeInMs, bvhTimeInMs, bruteForceHitCount, bvhHitCount);
+
+        // Closest hit rays, a hit counts once per ray
+        // 最近接のレイ、ヒットはレイ毎に1回と数える
+        const float maxRayDistance = std::cbrt(static_cast<float>(objectCount)) * OBJECT_SPACING * 2.0f;
+        bruteForceTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+            bruteForceHitCount = 0;
+            for (UINT q = 0; q < QUERY_COUNT; ++q) {
+                const XMVECTOR origin       = XMLoadFloat3(&scene.queryPoints[q]);
+                const XMVECTOR invDirection = XMVectorReciprocal(XMLoadFloat3(&scene.rayDirections[q]));
+                float closestDistance = maxRayDistance;
+                for (UINT i = 0; i < objectCount; ++i) {
+                    closestDistance = IntersectRayBox(origin, invDirection, scene.boxMins[i], scene.boxMaxs[i], closestDistance);
+                }
+                bruteForceHitCount += (closestDistance < maxRayDistance) ? 1 : 0;
+            }
+        });
+        ReportBenchCase("Ray query (brute force)", QUERY_COUNT, bruteForceTimeInMs);
+        bvhTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+            bvhHitCount = 0;
+            for (UINT q = 0; q < QUERY_COUNT; ++q) {
+                const XMVECTOR origin       = XMLoadFloat3(&scene.queryPoints[q]);
+                const XMVECTOR invDirection = XMVectorReciprocal(XMLoadFloat3(&scene.rayDirections[q]));
+                float closestDistance = maxRayDistance;
+                bvh.QueryRay(origin, XMLoadFloat3(&scene.rayDirections[q]), maxRayDistance, [&](UINT userData, float maxDistance) {
+                    closestDistance = IntersectRayBox(origin, invDirection, scene.boxMins[userData], scene.boxMaxs[userData], maxDistance);
+                    return closestDistance;
+                });
+                bvhHitCount += (closestDistance < maxRayDistance) ? 1 : 0;
+            }
+        });
+        ReportBenchCase("Ray query (BVH)", QUERY_COUNT, bvhTimeInMs);
+        ReportSpeedup("Ray", bruteForceTimeInMs, bvhTimeInMs, bruteForceHitCount, bvhHitCount);
+    }
+} // namespace ""
+
+/// @~english
+/// @brief Time the BVH queries against brute force scans at 10k to 1M objects
+/// @details "-objects <count>" runs a single object count instead of the default ones, "-repeat <count>".
+/// @~japanese
+/// @brief BVHのクエリを総当たりの走査と比較して1万から100万オブジェクトで計測
+/// @details "-objects <count>"で既定の数の代わりに1つのオブジェクト数のみ実行する
+int main(int argc, char **argv) {
+    const bool smoke = IsSmokeRun(argc, argv);
+    const UINT repeatCount = GetBenchOption(argc, argv, "-repeat", smoke ? SMOKE_REPEAT_COUNT : DEFAULT_REPEAT_COUNT);
+
+    std::vector<UINT> objectCounts;
+    if (FindBenchOption(argc, argv, "-objects") != 0) {
+        objectCounts.push_back(GetBenchOption(argc, argv, "-objects", 0u));
+    } else if (smoke) {
+        objectCounts.assign(std::begin(SMOKE_OBJECT_COUNTS), std::end(SMOKE_OBJECT_COUNTS));
+    } else {
+        objectCounts.assign(std::begin(DEFAULT_OBJECT_COUNTS), std::end(DEFAULT_OBJECT_COUNTS));
+    }
+
+    JobSystem jobSystem;
+    if (!jobSystem.Init(0)) {
+        return -1;
+    }
+
+    for (UINT objectCount : objectCounts) {
+        RunQueries(objectCount, repeatCount, &jobSystem);
+    }
+
+    jobSystem.Deinit();
+    return 0;
+}
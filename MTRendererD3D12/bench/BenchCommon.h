@@ -0,0 +1,81 @@
+/// @file BenchCommon.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+/// @~english
+/// @brief Options and timing shared by the benchmarks, each benchmark is one executable
+/// @details "-smoke" shrinks the workload so the build gate runs every benchmark quickly, the numbers of a
+///          smoke run only show that the code path works.
+/// @~japanese
+/// @brief ベンチマークで共有するオプションと計測、各ベンチマークは1つの実行ファイル
+/// @details "-smoke"で処理量を縮小しビルドの検証で全ベンチマークを素早く実行する、スモーク実行の数値は
+///          コードパスが動作する事のみを示す
+
+/// @~english
+/// @brief Find an option of the command line
+/// @return Index of the option, 0 if not found
+/// @~japanese
+/// @brief コマンドラインのオプションを検索
+/// @return オプションの番号、見つからない場合は0
+inline int FindBenchOption(int argc, char **argv, const char *name) {
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], name) == 0) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+/// @~english
+/// @brief Get the number following an option of the command line
+/// @~japanese
+/// @brief コマンドラインのオプションに続く数値を取得
+inline UINT GetBenchOption(int argc, char **argv, const char *name, UINT defaultValue) {
+    const int index = FindBenchOption(argc, argv, name);
+    return (index != 0 && index + 1 < argc) ? static_cast<UINT>(strtoul(argv[index + 1], nullptr, 10)) : defaultValue;
+}
+
+/// @~english
+/// @brief Get the string following an option of the command line
+/// @~japanese
+/// @brief コマンドラインのオプションに続く文字列を取得
+inline const char* GetBenchOption(int argc, char **argv, const char *name, const char *defaultValue) {
+    const int index = FindBenchOption(argc, argv, name);
+    return (index != 0 && index + 1 < argc) ? argv[index + 1] : defaultValue;
+}
+
+inline bool IsSmokeRun(int argc, char **argv) {
+    return FindBenchOption(argc, argv, "-smoke") != 0;
+}
+
+/// @~english
+/// @brief Run a function repeatedly and get the median time of a run
+/// @param[in] repeatCount Number of timed runs, one untimed run warms the caches first
+/// @~japanese
+/// @brief 関数を繰り返し実行し1回の実行の中央値の時間を取得
+/// @param[in] repeatCount 計測する実行回数、計測しない1回の実行で先にキャッシュを温める
+template<typename Func>
+float MeasureMedianInMs(UINT repeatCount, Func func) {
+    func();
+
+    std::vector<float> times(std::max(repeatCount, 1u));
+    for (auto &time : times) {
+        const auto beginTime = std::chrono::high_resolution_clock::now();
+        func();
+        time = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - beginTime).count();
+    }
+    std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+    return times[times.size() / 2];
+}
+
+/// @~english
+/// @brief Report a measured case, with the time per item
+/// @~japanese
+/// @brief 計測したケースを出力、要素あたりの時間と共に
+inline void ReportBenchCase(const char *name, UINT itemCount, float timeInMs) {
+    char reportStr[256];
+    snprintf(reportStr, sizeof(reportStr), "%-40s %9u items %10.3f ms %9.2f ns/item\n",
+        name, itemCount, timeInMs, timeInMs * 1000000.0f / static_cast<float>(std::max(itemCount, 1u)));
+    OutputDebugStringA(reportStr);
+}
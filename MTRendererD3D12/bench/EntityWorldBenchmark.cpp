@@ -0,0 +1,149 @@
+/// @file EntityWorldBenchmark.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "BenchCommon.h"
+#include "EntityWorld.h"
+#include "JobSystem.h"
+#include "SceneActor.h"
+
+#include <memory>
+#include <mutex>
+#include <random>
+
+using namespace DirectX;
+
+namespace {
+    const UINT SMOKE_ENTITY_COUNT   = 10000;
+    const UINT SMOKE_REPEAT_COUNT   = 3;
+    const UINT DEFAULT_ENTITY_COUNT = 1000000;
+    const UINT DEFAULT_REPEAT_COUNT = 20;
+    const UINT SHUFFLE_SEED         = 7;
+
+    /// @~english
+    /// @brief Render object of the pointer based layout the entity world replaced, one heap object per object
+    /// @~japanese
+    /// @brief エンティティワールドが置き換えたポインタ基準の配置の描画オブジェクト、オブジェクト毎に1つのヒープオブジェクト
+    class LegacyProxy {
+    public:
+        virtual ~LegacyProxy() = default;
+        virtual float GetWorldCenterLengthSq() const = 0;
+    };
+
+    /// @class LegacyMeshProxy
+    class LegacyMeshProxy : public LegacyProxy {
+    public:
+        float GetWorldCenterLengthSq() const override {
+            const XMVECTOR center = XMVector3Transform(XMLoadFloat4(&mesh.boundingSphere), XMLoadFloat4x4(&transform.worldMtx));
+            return XMVectorGetX(XMVector3LengthSq(center));
+        }
+
+        TransformComponent  transform;
+        MeshComponent       mesh;
+    };
+
+    /// @~english
+    /// @brief Transform of an object
+    /// @~japanese
+    /// @brief オブジェクトのトランスフォーム
+    XMMATRIX MakeWorldMatrix(UINT index) {
+        const float x = static_cast<float>(index % 1000);
+        const float z = static_cast<float>(index / 1000);
+        return XMMatrixMultiply(XMMatrixRotationRollPitchYaw(0.0f, x * 0.01f, 0.0f), XMMatrixTranslation(x, 0.0f, z));
+    }
+
+    /// @~english
+    /// @brief Sum of the squared lengths of the world space bounding sphere centers of a chunk of entities
+    /// @~japanese
+    /// @brief エンティティのチャンクのワールド空間のバウンディング球の中心の長さの2乗の合計
+    float SumWorldCenterLengthSq(UINT count, const TransformComponent *transforms, const MeshComponent *meshes) {
+        float sum = 0.0f;
+        for (UINT i = 0; i < count; ++i) {
+            const XMVECTOR center = XMVector3Transform(XMLoadFloat4(&meshes[i].boundingSphere), XMLoadFloat4x4(&transforms[i].worldMtx));
+            sum += XMVectorGetX(XMVector3LengthSq(center));
+        }
+        return sum;
+    }
+} // namespace ""
+
+/// @~english
+/// @brief Time iterating the components of the entity world against virtual calls through a pointer vector
+/// @details The pointer vector holds heap objects allocated in shuffled order, as objects created and destroyed over a
+///          session end up. Both sum the squared lengths of the world space bounding sphere centers. "-entities <count>", "-repeat <count>".
+/// @~japanese
+/// @brief エンティティワールドのコンポーネントの走査をポインタ配列を介した仮想呼び出しと比較して計測
+/// @details ポインタ配列はセッション中に生成と破棄を繰り返したオブジェクトのように、シャッフルした順序で確保した
+///          ヒープオブジェクトを保持する。両者ともワールド空間のバウンディング球の中心の長さの2乗を合計する
+int main(int argc, char **argv) {
+    const bool smoke = IsSmokeRun(argc, argv);
+    const UINT entityCount = GetBenchOption(argc, argv, "-entities", smoke ? SMOKE_ENTITY_COUNT : DEFAULT_ENTITY_COUNT);
+    const UINT repeatCount = GetBenchOption(argc, argv, "-repeat", smoke ? SMOKE_REPEAT_COUNT : DEFAULT_REPEAT_COUNT);
+
+    JobSystem jobSystem;
+    if (!jobSystem.Init(0)) {
+        return -1;
+    }
+
+    // Allocate the legacy objects in shuffled order so neighbours in the vector are not neighbours in memory
+    // 配列上の隣接がメモリ上で隣接しないように、旧来のオブジェクトをシャッフルした順序で確保
+    std::vector<UINT> allocOrder(entityCount);
+    for (UINT i = 0; i < entityCount; ++i) {
+        allocOrder[i] = i;
+    }
+    std::shuffle(allocOrder.begin(), allocOrder.end(), std::mt19937(SHUFFLE_SEED));
+
+    std::vector<std::unique_ptr<LegacyProxy>> legacyProxies(entityCount);
+    for (UINT index : allocOrder) {
+        auto proxy = std::make_unique<LegacyMeshProxy>();
+        XMStoreFloat4x4(&proxy->transform.worldMtx, MakeWorldMatrix(index));
+        proxy->mesh.boundingSphere = XMFLOAT4(0.0f, 0.5f, 0.0f, 1.0f);
+        legacyProxies[index] = std::move(proxy);
+    }
+
+    EntityWorld world;
+    for (UINT i = 0; i < entityCount; ++i) {
+        const UINT entity = world.CreateEntity<TransformComponent, MeshComponent>();
+        XMStoreFloat4x4(&world.GetComponent<TransformComponent>(entity)->worldMtx, MakeWorldMatrix(i));
+        world.GetComponent<MeshComponent>(entity)->boundingSphere = XMFLOAT4(0.0f, 0.5f, 0.0f, 1.0f);
+    }
+
+    float legacySum = 0.0f;
+    const float legacyTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+        legacySum = 0.0f;
+        for (const auto &proxy : legacyProxies) {
+            legacySum += proxy->GetWorldCenterLengthSq();
+        }
+    });
+    ReportBenchCase("Pointer vector (virtual)", entityCount, legacyTimeInMs);
+
+    float serialSum = 0.0f;
+    const float serialTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+        serialSum = 0.0f;
+        world.ForEach<TransformComponent, MeshComponent>([&](UINT count, const UINT *, TransformComponent *transforms, MeshComponent *meshes) {
+            serialSum += SumWorldCenterLengthSq(count, transforms, meshes);
+        });
+    });
+    ReportBenchCase("EntityWorld::ForEach", entityCount, serialTimeInMs);
+
+    float parallelSum = 0.0f;
+    std::mutex parallelSumMutex;
+    const float parallelTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+        parallelSum = 0.0f;
+        world.ParallelForEach<TransformComponent, MeshComponent>(&jobSystem, [&](UINT count, const UINT *, TransformComponent *transforms, MeshComponent *meshes) {
+            const float chunkSum = SumWorldCenterLengthSq(count, transforms, meshes);
+            std::lock_guard<std::mutex> lock(parallelSumMutex);
+            parallelSum += chunkSum;
+        });
+    });
+    ReportBenchCase("EntityWorld::ParallelForEach", entityCount, parallelTimeInMs);
+
+    char reportStr[256];
+    snprintf(reportStr, sizeof(reportStr), "  ForEach speedup over pointer vector: %.2fx (sums %.1f / %.1f / %.1f)\n",
+        legacyTimeInMs / std::max(serialTimeInMs, 1e-6f), legacySum, serialSum, parallelSum);
+    OutputDebugStringA(reportStr);
+    snprintf(reportStr, sizeof(reportStr), "  ParallelForEach speedup over pointer vector: %.2fx\n", legacyTimeInMs / std::max(parallelTimeInMs, 1e-6f));
+    OutputDebugStringA(reportStr);
+
+    jobSystem.Deinit();
+    return 0;
+}
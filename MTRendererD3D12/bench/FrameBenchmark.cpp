@@ -0,0 +1,181 @@
+/// @file FrameBenchmark.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "BenchCommon.h"
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "Scene.h"
+#include "ScratchArena.h"
+#include "StressScene.h"
+
+using namespace DirectX;
+
+namespace {
+    const UINT  SMOKE_ACTOR_COUNT       = 2000;
+    const UINT  SMOKE_WARMUP_FRAMES     = 5;
+    const UINT  SMOKE_FRAME_COUNT       = 20;
+    const UINT  DEFAULT_ACTOR_COUNT     = 100000;
+    const UINT  CANVAS_WIDTH            = 1280;
+    const UINT  CANVAS_HEIGHT           = 720;
+    const float FRAME_DELTA             = 1.0f / 60.0f;
+
+    /// @~english
+    /// @brief Get the camera of the committed proxies
+    /// @~japanese
+    /// @brief 伝達済みのProxyのカメラを取得
+    const CameraComponent* FindCamera(EntityWorld *world) {
+        const CameraComponent *camera = nullptr;
+        world->ForEach<CameraComponent>([&](UINT count, const UINT *entities, CameraComponent *cameras) {
+            if (camera == nullptr) {
+                camera = &cameras[0];
+            }
+        });
+        return camera;
+    }
+} // namespace ""
+
+/// @~english
+/// @brief Time the CPU stages of a frame over a stress scene, without a device
+/// @details Runs the stages of the MainThread and the RenderThread one after another on the calling thread and
+///          the workers: Scene::Update, Scene::Commit, Scene::BuildRenderQueue for the camera and
+///          Scene::PackInstanceMatrices into MAX_SCENE_INSTANCE_COUNT constants. The JSON has the layout of
+///          the renderer's "-benchmark", the stages of the device are left without samples.
+///          "-actors <count>", "-dynamic <ratio>", "-dist uniform|clustered|grid", "-seed <seed>",
+///          "-frames <count>", "-out <path>", "-baseline <path>". The exit code is the number of regressed metrics.
+/// @~japanese
+/// @brief ストレスシーンに対しフレームのCPUの各段階を計測、デバイスは使用しない
+/// @details MainThreadとRenderThreadの各段階を呼び出し元スレッドとワーカーで順に実行する：Scene::Update、
+///          Scene::Commit、カメラに対するScene::BuildRenderQueue、MAX_SCENE_INSTANCE_COUNT個の定数への
+///          Scene::PackInstanceMatrices。JSONはレンダラーの"-benchmark"と同じレイアウトで、デバイスの段階は
+///          サンプルを持たない。終了コードは退行したメトリクス数
+int main(int argc, char **argv) {
+    const bool smoke = IsSmokeRun(argc, argv);
+
+    StressSceneDesc desc;
+    desc.actorCount   = GetBenchOption(argc, argv, "-actors", smoke ? SMOKE_ACTOR_COUNT : DEFAULT_ACTOR_COUNT);
+    desc.dynamicRatio = std::clamp(strtof(GetBenchOption(argc, argv, "-dynamic", "0.5"), nullptr), 0.0f, 1.0f);
+    desc.seed         = GetBenchOption(argc, argv, "-seed", 0u);
+    if (!FindStressSceneDistribution(GetBenchOption(argc, argv, "-dist", "uniform"), &desc.distribution)) {
+        OutputDebugStringA("StressScene: unknown distribution\n");
+        return -1;
+    }
+
+    const char *scenePath = GetBenchOption(argc, argv, "-stressfile", "FrameBenchmark.mtss");
+    if (!GenerateStressScene(desc, scenePath)) {
+        OutputDebugStringA("StressScene: could not generate\n");
+        return -1;
+    }
+
+    JobSystem jobSystem;
+    if (!jobSystem.Init(0)) {
+        return -1;
+    }
+
+    // The camera of the renderer, the stress scene lies in front of it
+    // レンダラーのカメラ、ストレスシーンはその前方にある
+    Scene scene;
+    CameraSceneActor cameraActor;
+    cameraActor.Init(CANVAS_WIDTH, CANVAS_HEIGHT, 90.0f);
+    cameraActor.SetTickGroup(TickGroup::PostUpdate);
+    scene.AddActor(&cameraActor);
+    if (!scene.LoadSnapshot(scenePath, &jobSystem)) {
+        OutputDebugStringA("SceneSnapshot: could not load\n");
+        return -1;
+    }
+
+    // The transient data of a frame comes from an arena, as on the RenderThread
+    // フレームの一時データはRenderThreadと同様にアリーナから確保
+    ScratchArena frameArena;
+    if (!frameArena.Init(DEFAULT_SCRATCH_ARENA_SIZE)) {
+        return -1;
+    }
+    RenderQueue renderQueue;
+    LodSelector lodSelector;
+    XMFLOAT4X4  packedMatrices[MAX_SCENE_INSTANCE_COUNT];
+
+    BenchmarkRecorder recorder;
+    recorder.Init(smoke ? SMOKE_WARMUP_FRAMES : DEFAULT_BENCHMARK_WARMUP_FRAMES,
+        GetBenchOption(argc, argv, "-frames", smoke ? SMOKE_FRAME_COUNT : DEFAULT_BENCHMARK_FRAME_COUNT));
+
+    bool finished = false;
+    while (!finished) {
+        frameArena.Reset();
+        ScratchArena::SetThreadArena(&frameArena);
+        renderQueue.SetArena(&frameArena);
+
+        const auto beginTime = std::chrono::high_resolution_clock::now();
+        scene.Update(FRAME_DELTA, &jobSystem);
+        const auto commitBeginTime = std::chrono::high_resolution_clock::now();
+        scene.Commit(&jobSystem);
+        const auto commitEndTime = std::chrono::high_resolution_clock::now();
+
+        // The visibility of the view is not timed, as in the renderer
+        // ビューの可視判定はレンダラーと同様に計測しない
+        EntityWorld *world = &scene.GetProxyWorld();
+        const CameraComponent *camera = FindCamera(world);
+        ViewFrustum frustum;
+        frustum.SetFromMatrix(XMMatrixMultiply(XMMatrixTranspose(XMLoadFloat4x4(&camera->viewMtx)), XMMatrixTranspose(XMLoadFloat4x4(&camera->projMtx))));
+        ScratchVector<UINT8> entityViewMasks(world->GetEntityIndexCapacity(), 0);
+        scene.GetProxyBVH().QueryFrustums(&frustum, 1, [&](UINT entity, UINT viewMask) {
+            entityViewMasks[entity & ENTITY_INDEX_MASK] = static_cast<UINT8>(viewMask);
+        });
+        ScratchVector<XMFLOAT4X4> instanceMatrices(world->GetEntityCount());
+        lodSelector.SetProjectionScale(camera->projMtx._22);
+
+        RenderQueueView view;
+        view.camera          = camera;
+        view.entityViewMasks = entityViewMasks.data();
+        view.viewMask        = 1;
+        view.lodSelector     = &lodSelector;
+
+        const auto queueBeginTime = std::chrono::high_resolution_clock::now();
+        const UINT visibleCount = Scene::BuildRenderQueue(world, view, &jobSystem, &renderQueue, instanceMatrices.data());
+        const auto packBeginTime = std::chrono::high_resolution_clock::now();
+        const UINT packedCount = Scene::PackInstanceMatrices(renderQueue, visibleCount, instanceMatrices.data(), MAX_SCENE_INSTANCE_COUNT, packedMatrices);
+        const auto endTime = std::chrono::high_resolution_clock::now();
+
+        recorder.AddSample(BenchmarkMetric::Update, std::chrono::duration<float, std::milli>(commitBeginTime - beginTime).count());
+        recorder.AddSample(BenchmarkMetric::CommitSceneProxy, std::chrono::duration<float, std::milli>(commitEndTime - commitBeginTime).count());
+        recorder.AddSample(BenchmarkMetric::RenderQueue, std::chrono::duration<float, std::milli>(packBeginTime - queueBeginTime).count());
+        recorder.AddSample(BenchmarkMetric::InstancePacking, std::chrono::duration<float, std::milli>(endTime - packBeginTime).count());
+        recorder.AddInstancePacking(visibleCount, packedCount);
+        finished = recorder.EndFrame(std::chrono::duration<float, std::milli>(endTime - beginTime).count());
+    }
+
+    char labelStr[128];
+    snprintf(labelStr, sizeof(labelStr), "cpu stress %u actors, %.2f dynamic, %s, seed %u",
+        desc.actorCount, desc.dynamicRatio, GetStressSceneDistributionName(desc.distribution), desc.seed);
+
+    const char *outPath = GetBenchOption(argc, argv, "-out", "FrameBenchmark.json");
+    if (!recorder.WriteJson(outPath, labelStr)) {
+        OutputDebugStringA("Benchmark: could not write\n");
+        return -1;
+    }
+
+    BenchmarkSummary summaries[BENCHMARK_METRIC_COUNT];
+    for (UINT i = 0; i < BENCHMARK_METRIC_COUNT; ++i) {
+        summaries[i] = recorder.Summarize(static_cast<BenchmarkMetric>(i));
+
+        char reportStr[256];
+        snprintf(reportStr, sizeof(reportStr), "%-16s p50 %.3f ms, p99 %.3f ms\n", BenchmarkRecorder::GetMetricName(static_cast<BenchmarkMetric>(i)), summaries[i].p50InMs, summaries[i].p99InMs);
+        OutputDebugStringA(reportStr);
+    }
+
+    int ret = 0;
+    const char *baselinePath = GetBenchOption(argc, argv, "-baseline", static_cast<const char *>(nullptr));
+    if (baselinePath != nullptr) {
+        BenchmarkSummary baseline[BENCHMARK_METRIC_COUNT];
+        if (!BenchmarkRecorder::ReadJson(baselinePath, baseline)) {
+            OutputDebugStringA("Benchmark: could not read the baseline\n");
+            return -1;
+        }
+
+        std::string report;
+        ret = static_cast<int>(BenchmarkRecorder::Compare(summaries, baseline, DEFAULT_BENCHMARK_REGRESSION_TOLERANCE, &report));
+        OutputDebugStringA(report.c_str());
+    }
+
+    jobSystem.Deinit();
+    return ret;
+}
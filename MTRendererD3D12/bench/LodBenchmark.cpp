@@ -0,0 +1,164 @@
+/// @file LodBenchmark.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "BenchCommon.h"
+#include "JobSystem.h"
+#include "LodSelector.h"
+
+#include <random>
+
+namespace {
+    const UINT  SMOKE_INSTANCE_COUNT    = 10000;
+    const UINT  SMOKE_REPEAT_COUNT      = 3;
+    const UINT  SMOKE_FRAME_COUNT       = 4;
+    const UINT  DEFAULT_INSTANCE_COUNT  = 1000000;
+    const UINT  DEFAULT_REPEAT_COUNT    = 20;
+    const UINT  DEFAULT_FRAME_COUNT     = 60;
+    const UINT  BATCH_BLOCK_COUNT       = 64;       // LOD_SELECT_BLOCK_SIZE blocks per ParallelFor batch
+    const float PROJECTION_SCALE        = 1.0f / 0.41421356f;   // cot(45 deg / 2)
+    const float MAX_VIEW_DEPTH          = 500.0f;
+    const float DEPTH_JITTER            = 0.02f;    // Relative depth change per frame of the hysteresis run
+    const UINT  INSTANCE_SEED           = 17;
+
+    /// @~english
+    /// @brief Scalar selection with the default thresholds, the reference the SIMD selection is checked against
+    /// @~japanese
+    /// @brief 既定の閾値によるスカラーの選択、SIMDの選択を照合する基準実装
+    void SelectScalar(UINT count, const float *viewDepths, const float *radii, UINT *lods) {
+        float lowThresholds[MAX_MESH_LOD_COUNT - 1];
+        float highThresholds[MAX_MESH_LOD_COUNT - 1];
+        for (UINT n = 0; n < MAX_MESH_LOD_COUNT - 1; ++n) {
+            lowThresholds[n]  = DEFAULT_LOD_SCREEN_SIZES[n] * (1.0f - DEFAULT_LOD_HYSTERESIS);
+            highThresholds[n] = DEFAULT_LOD_SCREEN_SIZES[n] * (1.0f + DEFAULT_LOD_HYSTERESIS);
+        }
+
+        for (UINT i = 0; i < count; ++i) {
+            const float size = radii[i] * PROJECTION_SCALE / std::max(viewDepths[i], LOD_MIN_VIEW_DEPTH);
+            UINT lod = lods[i];
+            while (lod + 1 < MAX_MESH_LOD_COUNT && size < lowThresholds[lod]) {
+                lod++;
+            }
+            while (0 < lod && highThresholds[lod - 1] <= size) {
+                lod--;
+            }
+            lods[i] = lod;
+        }
+    }
+
+    /// @~english
+    /// @brief Select on the job system, in batches of whole blocks as the render queue build does
+    /// @~japanese
+    /// @brief 描画キューの構築と同様に、ブロック単位のバッチでJobSystem上で選択
+    void SelectParallel(const LodSelector &lodSelector, UINT count, const float *viewDepths, const float *radii, UINT *lods, JobSystem *jobSystem) {
+        jobSystem->ParallelFor(count, LOD_SELECT_BLOCK_SIZE * BATCH_BLOCK_COUNT, [&](UINT begin, UINT end) {
+            for (UINT blockBegin = begin; blockBegin < end; blockBegin += LOD_SELECT_BLOCK_SIZE) {
+                const UINT blockCount = std::min(end - blockBegin, LOD_SELECT_BLOCK_SIZE);
+                lodSelector.Select(blockCount, viewDepths + blockBegin, radii + blockBegin, lods + blockBegin);
+            }
+        });
+    }
+
+    /// @~english
+    /// @brief Count the LOD changes over frames of slightly moving instances
+    /// @~japanese
+    /// @brief 僅かに動くインスタンスのフレームに渡るLODの変化を数える
+    UINT CountLodChanges(const LodSelector &lodSelector, const std::vector<float> &viewDepths, const std::vector<float> &radii, UINT frameCount) {
+        const UINT instanceCount = static_cast<UINT>(viewDepths.size());
+        std::vector<float> depths(instanceCount);
+        std::vector<UINT> lods(instanceCount, 0);
+        std::vector<UINT> lastLods(instanceCount);
+        lodSelector.Select(instanceCount, viewDepths.data(), radii.data(), lods.data());
+
+        UINT changeCount = 0;
+        for (UINT frame = 0; frame < frameCount; ++frame) {
+            const float jitter = 1.0f + DEPTH_JITTER * ((frame % 2 == 0) ? 1.0f : -1.0f);
+            for (UINT i = 0; i < instanceCount; ++i) {
+                depths[i] = viewDepths[i] * jitter;
+            }
+            lastLods = lods;
+            lodSelector.Select(instanceCount, depths.data(), radii.data(), lods.data());
+            for (UINT i = 0; i < instanceCount; ++i) {
+                changeCount += (lods[i] != lastLods[i]) ? 1 : 0;
+            }
+        }
+        return changeCount;
+    }
+} // namespace ""
+
+/// @~english
+/// @brief Time the SIMD LOD selection against a scalar loop, serially and on the job system
+/// @details The instances are spread over the view depths so every LOD is used. The hysteresis run alternates the
+///          depths by DEPTH_JITTER each frame and counts the LOD changes with and without the band.
+///          "-instances <count>", "-repeat <count>", "-frames <count>".
+/// @~japanese
+/// @brief SIMDのLOD選択をスカラーのループと比較して計測、逐次およびJobSystem上で
+/// @details 全てのLODが使われるようにインスタンスをView空間の深度に散らす。ヒステリシスの実行はフレーム毎に深度を
+///          DEPTH_JITTERだけ交互に変え、帯の有無それぞれでLODの変化を数える
+int main(int argc, char **argv) {
+    const bool smoke = IsSmokeRun(argc, argv);
+    const UINT instanceCount = GetBenchOption(argc, argv, "-instances", smoke ? SMOKE_INSTANCE_COUNT : DEFAULT_INSTANCE_COUNT);
+    const UINT repeatCount   = GetBenchOption(argc, argv, "-repeat", smoke ? SMOKE_REPEAT_COUNT : DEFAULT_REPEAT_COUNT);
+    const UINT frameCount    = GetBenchOption(argc, argv, "-frames", smoke ? SMOKE_FRAME_COUNT : DEFAULT_FRAME_COUNT);
+
+    JobSystem jobSystem;
+    if (!jobSystem.Init(0)) {
+        return -1;
+    }
+
+    std::mt19937 rng(INSTANCE_SEED);
+    std::uniform_real_distribution<float> depth(1.0f, MAX_VIEW_DEPTH);
+    std::uniform_real_distribution<float> radius(0.5f, 4.0f);
+    std::vector<float> viewDepths(instanceCount);
+    std::vector<float> radii(instanceCount);
+    for (UINT i = 0; i < instanceCount; ++i) {
+        viewDepths[i] = depth(rng);
+        radii[i]      = radius(rng);
+    }
+
+    LodSelector lodSelector;
+    lodSelector.SetProjectionScale(PROJECTION_SCALE);
+
+    // The SIMD selection matches the scalar one from the same starting LODs
+    // 同じ開始LODからのSIMDの選択はスカラーの選択と一致する
+    std::vector<UINT> scalarLods(instanceCount, 0);
+    std::vector<UINT> simdLods(instanceCount, 0);
+    SelectScalar(instanceCount, viewDepths.data(), radii.data(), scalarLods.data());
+    lodSelector.Select(instanceCount, viewDepths.data(), radii.data(), simdLods.data());
+    UINT mismatchCount = 0;
+    UINT lodInstanceCounts[MAX_MESH_LOD_COUNT] = {};
+    for (UINT i = 0; i < instanceCount; ++i) {
+        mismatchCount += (scalarLods[i] != simdLods[i]) ? 1 : 0;
+        lodInstanceCounts[std::min(simdLods[i], MAX_MESH_LOD_COUNT - 1)]++;
+    }
+
+    const float scalarTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+        SelectScalar(instanceCount, viewDepths.data(), radii.data(), scalarLods.data());
+    });
+    ReportBenchCase("LOD selection (scalar)", instanceCount, scalarTimeInMs);
+
+    const float simdTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+        lodSelector.Select(instanceCount, viewDepths.data(), radii.data(), simdLods.data());
+    });
+    ReportBenchCase("LodSelector::Select", instanceCount, simdTimeInMs);
+
+    const float parallelTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+        SelectParallel(lodSelector, instanceCount, viewDepths.data(), radii.data(), simdLods.data(), &jobSystem);
+    });
+    ReportBenchCase("LodSelector::Select (JobSystem)", instanceCount, parallelTimeInMs);
+
+    char reportStr[256];
+    snprintf(reportStr, sizeof(reportStr), "  Select speedup over scalar: %.2fx, JobSystem: %.2fx (%u mismatches, LODs %u / %u / %u / %u)\n",
+        scalarTimeInMs / std::max(simdTimeInMs, 1e-6f), scalarTimeInMs / std::max(parallelTimeInMs, 1e-6f), mismatchCount,
+        lodInstanceCounts[0], lodInstanceCounts[1], lodInstanceCounts[2], lodInstanceCounts[3]);
+    OutputDebugStringA(reportStr);
+
+    const UINT hysteresisChangeCount = CountLodChanges(lodSelector, viewDepths, radii, frameCount);
+    lodSelector.SetHysteresis(0.0f);
+    const UINT noHysteresisChangeCount = CountLodChanges(lodSelector, viewDepths, radii, frameCount);
+    snprintf(reportStr, sizeof(reportStr), "  LOD changes over %u frames: %u with hysteresis, %u without\n", frameCount, hysteresisChangeCount, noHysteresisChangeCount);
+    OutputDebugStringA(reportStr);
+
+    jobSystem.Deinit();
+    return 0;
+}
@@ -0,0 +1,224 @@
+/// @file ParticleBenchmark.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "BenchCommon.h"
+#include "JobSystem.h"
+#include "ParticleSystem.h"
+
+#include <random>
+
+using namespace DirectX;
+
+namespace {
+    const UINT  SMOKE_PARTICLE_COUNT    = 32768;
+    const UINT  SMOKE_REPEAT_COUNT      = 3;
+    const UINT  DEFAULT_PARTICLE_COUNT  = 1250000;  // Capacity of all emitters, about 1.1M stay alive
+    const UINT  DEFAULT_REPEAT_COUNT    = 20;
+    const UINT  EMITTER_COUNT           = 16;
+    const float FILL_RATIO              = 0.9f;     // Alive particles over the capacity once the emission and the deaths balance
+    const float FRAME_DELTA             = 1.0f / 60.0f;
+    const UINT  EMITTER_SEED            = 19;
+
+    /// @~english
+    /// @brief Emitter settings, the emit rate keeps FILL_RATIO of the capacity alive
+    /// @~japanese
+    /// @brief エミッタの設定、放出レートは容量のFILL_RATIOを生存させる
+    ParticleEmitterDesc MakeEmitterDesc(UINT index, UINT capacity) {
+        ParticleEmitterDesc desc;
+        desc.position       = XMFLOAT3(static_cast<float>(index % 4) * 4.0f, 0.0f, static_cast<float>(index / 4) * 4.0f);
+        desc.positionSpread = 0.25f;
+        desc.velocity       = XMFLOAT3(0.0f, 1.5f, 0.0f);
+        desc.velocitySpread = 0.75f;
+        desc.acceleration   = XMFLOAT3(0.0f, -1.0f, 0.0f);
+        desc.drag           = 0.5f;
+        desc.minLifetime    = 1.0f;
+        desc.maxLifetime    = 2.0f;
+        desc.emitRate       = static_cast<float>(capacity) * FILL_RATIO / ((desc.minLifetime + desc.maxLifetime) * 0.5f);
+        desc.startColor     = XMFLOAT4(1.0f, 0.8f, 0.3f, 1.0f);
+        desc.endColor       = XMFLOAT4(1.0f, 0.2f, 0.0f, 0.0f);
+        desc.capacity       = capacity;
+        return desc;
+    }
+
+    /// @~english
+    /// @brief Particle of the scalar reference, all values of a particle together
+    /// @~japanese
+    /// @brief スカラーの基準実装のパーティクル、パーティクルの全ての値をまとめて持つ
+    struct ScalarParticle {
+        XMFLOAT3    position;
+        XMFLOAT3    velocity;
+        float       age;
+        float       lifetime;
+    };
+
+    /// @~english
+    /// @brief Scalar reference of the particle update, one particle at a time with swap and pop removal
+    /// @~japanese
+    /// @brief パーティクル更新のスカラーの基準実装、1パーティクルずつ更新し末尾との交換で削除する
+    class ScalarParticlePool {
+    public:
+        explicit ScalarParticlePool(const ParticleEmitterDesc &inDesc)
+        : desc(inDesc)
+        , emitAccumulator(0.0f)
+        , rng(EMITTER_SEED)
+        {
+            particles.reserve(desc.capacity);
+        }
+
+        /// @~english
+        /// @brief Simulate the particles and write the instances
+        /// @return Number of written instances
+        /// @~japanese
+        /// @brief パーティクルをシミュレーションしインスタンスを書き込む
+        /// @return 書き込んだインスタンス数
+        UINT Update(float delta, ParticleInstance *dstInstances) {
+            const float damping = std::max(1.0f - desc.drag * delta, 0.0f);
+            UINT i = 0;
+            while (i < particles.size()) {
+                ScalarParticle &particle = particles[i];
+                particle.age += delta;
+                if (particle.lifetime <= particle.age) {
+                    particle = particles.back();
+                    particles.pop_back();
+                    continue;
+                }
+                particle.velocity.x = (particle.velocity.x + desc.acceleration.x * delta) * damping;
+                particle.velocity.y = (particle.velocity.y + desc.acceleration.y * delta) * damping;
+                particle.velocity.z = (particle.velocity.z + desc.acceleration.z * delta) * damping;
+                particle.position.x += particle.velocity.x * delta;
+                particle.position.y += particle.velocity.y * delta;
+                particle.position.z += particle.velocity.z * delta;
+
+                const float t = std::min(particle.age / particle.lifetime, 1.0f);
+                ParticleInstance &instance = dstInstances[i];
+                instance.position = particle.position;
+                instance.size     = desc.startSize + (desc.endSize - desc.startSize) * t;
+                instance.color    = LerpColor(t);
+                ++i;
+            }
+
+            emitAccumulator += desc.emitRate * delta;
+            const float requested = std::floor(emitAccumulator);
+            emitAccumulator -= requested;
+            const UINT emitCount = std::min(static_cast<UINT>(requested), desc.capacity - static_cast<UINT>(particles.size()));
+            std::uniform_real_distribution<float> spread(-1.0f, 1.0f);
+            std::uniform_real_distribution<float> lifetime(desc.minLifetime, desc.maxLifetime);
+            for (UINT n = 0; n < emitCount; ++n) {
+                ScalarParticle particle;
+                particle.position = XMFLOAT3(desc.position.x + spread(rng) * desc.positionSpread, desc.position.y + spread(rng) * desc.positionSpread, desc.position.z + spread(rng) * desc.positionSpread);
+                particle.velocity = XMFLOAT3(desc.velocity.x + spread(rng) * desc.velocitySpread, desc.velocity.y + spread(rng) * desc.velocitySpread, desc.velocity.z + spread(rng) * desc.velocitySpread);
+                particle.age      = 0.0f;
+                particle.lifetime = lifetime(rng);
+
+                ParticleInstance &instance = dstInstances[particles.size()];
+                instance.position = particle.position;
+                instance.size     = desc.startSize;
+                instance.color    = LerpColor(0.0f);
+                particles.push_back(particle);
+            }
+            return static_cast<UINT>(particles.size());
+        }
+
+    private:
+        /// @~english
+        /// @brief Interpolate the color over the normalized age and pack it to R8G8B8A8_UNORM
+        /// @~japanese
+        /// @brief 正規化した経過時間で色を補間しR8G8B8A8_UNORMへパック
+        UINT LerpColor(float t) const {
+            const float startColor[4] = { desc.startColor.x, desc.startColor.y, desc.startColor.z, desc.startColor.w };
+            const float endColor[4]   = { desc.endColor.x, desc.endColor.y, desc.endColor.z, desc.endColor.w };
+            UINT color = 0;
+            for (UINT c = 0; c < 4; ++c) {
+                const float value = startColor[c] + (endColor[c] - startColor[c]) * t;
+                color |= static_cast<UINT>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f) << (c * 8);
+            }
+            return color;
+        }
+
+    private:
+        ParticleEmitterDesc         desc;
+        std::vector<ScalarParticle> particles;
+        float                       emitAccumulator;
+        std::mt19937                rng;
+    };
+} // namespace ""
+
+/// @~english
+/// @brief Time the SIMD particle update against a scalar loop, at 1M+ live particles
+/// @details Both run EMITTER_COUNT emitters until the emission and the deaths balance, then time one frame of
+///          simulation, emission and instance stream writes. "-particles <capacity>", "-repeat <count>".
+/// @~japanese
+/// @brief SIMDのパーティクル更新をスカラーのループと比較して、100万以上の生存パーティクルで計測
+/// @details 両者ともEMITTER_COUNT個のエミッタを放出と消滅が釣り合うまで実行し、その後シミュレーション、放出、
+///          インスタンスストリームの書き込みの1フレームを計測する
+int main(int argc, char **argv) {
+    const bool smoke = IsSmokeRun(argc, argv);
+    const UINT particleCount = GetBenchOption(argc, argv, "-particles", smoke ? SMOKE_PARTICLE_COUNT : DEFAULT_PARTICLE_COUNT);
+    const UINT repeatCount   = GetBenchOption(argc, argv, "-repeat", smoke ? SMOKE_REPEAT_COUNT : DEFAULT_REPEAT_COUNT);
+
+    // The emitters round their capacity up to the SIMD width
+    // エミッタは容量をSIMD幅へ切り上げる
+    const UINT emitterCapacity = std::max((particleCount / EMITTER_COUNT) & ~3u, 4u);
+
+    JobSystem jobSystem;
+    if (!jobSystem.Init(0)) {
+        return -1;
+    }
+
+    ParticleSystem particleSystem;
+    if (!particleSystem.Init(emitterCapacity * EMITTER_COUNT)) {
+        return -1;
+    }
+    std::vector<ScalarParticlePool> scalarPools;
+    for (UINT e = 0; e < EMITTER_COUNT; ++e) {
+        const ParticleEmitterDesc desc = MakeEmitterDesc(e, emitterCapacity);
+        if (particleSystem.CreateEmitter(desc) == INVALID_PARTICLE_EMITTER) {
+            return -1;
+        }
+        scalarPools.emplace_back(desc);
+    }
+    std::vector<ParticleInstance> scalarInstances(static_cast<size_t>(emitterCapacity) * EMITTER_COUNT);
+
+    auto updateScalar = [&]() {
+        UINT instanceCount = 0;
+        for (auto &pool : scalarPools) {
+            instanceCount += pool.Update(FRAME_DELTA, scalarInstances.data() + instanceCount);
+        }
+        return instanceCount;
+    };
+
+    // Run past the longest lifetime, so the particles of the first frames have died
+    // 最長の寿命より長く実行し、最初のフレームのパーティクルを消滅させる
+    const UINT warmUpFrameCount = static_cast<UINT>(MakeEmitterDesc(0, emitterCapacity).maxLifetime / FRAME_DELTA) + 1;
+    UINT scalarAliveCount = 0;
+    for (UINT frame = 0; frame < warmUpFrameCount; ++frame) {
+        particleSystem.Update(FRAME_DELTA, &jobSystem);
+        scalarAliveCount = updateScalar();
+    }
+    const UINT aliveCount = particleSystem.GetFrame().instanceCount;
+
+    const float scalarTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+        scalarAliveCount = updateScalar();
+    });
+    ReportBenchCase("Particle update (scalar)", scalarAliveCount, scalarTimeInMs);
+
+    const float serialTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+        particleSystem.Update(FRAME_DELTA, nullptr);
+    });
+    ReportBenchCase("ParticleSystem::Update (serial)", aliveCount, serialTimeInMs);
+
+    const float parallelTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+        particleSystem.Update(FRAME_DELTA, &jobSystem);
+    });
+    ReportBenchCase("ParticleSystem::Update (JobSystem)", aliveCount, parallelTimeInMs);
+
+    char reportStr[256];
+    snprintf(reportStr, sizeof(reportStr), "  Update speedup over scalar: %.2fx, JobSystem: %.2fx (%u draws, %u tasks)\n",
+        scalarTimeInMs / std::max(serialTimeInMs, 1e-6f), scalarTimeInMs / std::max(parallelTimeInMs, 1e-6f),
+        particleSystem.GetFrame().drawCount, particleSystem.GetStats().taskCount);
+    OutputDebugStringA(reportStr);
+
+    jobSystem.Deinit();
+    return 0;
+}
@@ -0,0 +1,128 @@
+/// @file PipelineMicroBenchmark.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "BenchCommon.h"
+#include "JobSystem.h"
+#include "Scene.h"
+#include "StressScene.h"
+
+using namespace DirectX;
+
+namespace {
+    const UINT  SMOKE_ACTOR_COUNT       = 2000;
+    const UINT  SMOKE_REPEAT_COUNT      = 3;
+    const UINT  DEFAULT_ACTOR_COUNT     = 100000;
+    const UINT  DEFAULT_REPEAT_COUNT    = 20;
+    const float FRAME_DELTA             = 1.0f / 60.0f;
+    const UINT  PACK_VISIBLE_COUNTS[]   = { 64, MAX_SCENE_INSTANCE_COUNT, 4096 };
+
+    /// @~english
+    /// @brief Load a stress scene into a scene
+    /// @~japanese
+    /// @brief ストレスシーンをシーンへ読み込む
+    bool LoadStressScene(Scene *scene, UINT actorCount, float dynamicRatio, const char *path, JobSystem *jobSystem) {
+        StressSceneDesc desc;
+        desc.actorCount   = actorCount;
+        desc.dynamicRatio = dynamicRatio;
+        return GenerateStressScene(desc, path) && scene->LoadSnapshot(path, jobSystem);
+    }
+
+    /// @~english
+    /// @brief Time Scene::Update and Scene::Commit apart, every actor is dynamic
+    /// @~japanese
+    /// @brief Scene::UpdateとScene::Commitを個別に計測、全アクタが動的
+    bool RunUpdateAndCommit(UINT actorCount, UINT repeatCount, JobSystem *jobSystem) {
+        Scene scene;
+        if (!LoadStressScene(&scene, actorCount, 1.0f, "PipelineMicroBenchmark.mtss", jobSystem)) {
+            return false;
+        }
+
+        // Commit is timed after an untimed Update, so it always has a frame of changes to publish
+        // Commitは計測しないUpdateの後に計測するため、常に1フレーム分の変更を伝達する
+        std::vector<float> updateTimes(std::max(repeatCount, 1u));
+        std::vector<float> commitTimes(updateTimes.size());
+        scene.Update(FRAME_DELTA, jobSystem);
+        scene.Commit(jobSystem);
+        for (size_t i = 0; i < updateTimes.size(); ++i) {
+            const auto beginTime = std::chrono::high_resolution_clock::now();
+            scene.Update(FRAME_DELTA, jobSystem);
+            const auto commitBeginTime = std::chrono::high_resolution_clock::now();
+            scene.Commit(jobSystem);
+            const auto endTime = std::chrono::high_resolution_clock::now();
+            updateTimes[i] = std::chrono::duration<float, std::milli>(commitBeginTime - beginTime).count();
+            commitTimes[i] = std::chrono::duration<float, std::milli>(endTime - commitBeginTime).count();
+        }
+        std::nth_element(updateTimes.begin(), updateTimes.begin() + updateTimes.size() / 2, updateTimes.end());
+        std::nth_element(commitTimes.begin(), commitTimes.begin() + commitTimes.size() / 2, commitTimes.end());
+
+        ReportBenchCase("Scene::Update (all dynamic)", actorCount, updateTimes[updateTimes.size() / 2]);
+        ReportBenchCase("Scene::Commit (all dynamic)", actorCount, commitTimes[commitTimes.size() / 2]);
+        return true;
+    }
+
+    /// @~english
+    /// @brief Time Scene::PackInstanceMatrices for a number of visible items, with and without the capacity of
+    ///        the constant buffer
+    /// @~japanese
+    /// @brief 可視の要素数に対しScene::PackInstanceMatricesを計測、定数バッファの容量の有無それぞれで
+    bool RunPacking(UINT visibleCount, UINT repeatCount, JobSystem *jobSystem) {
+        Scene scene;
+        if (!LoadStressScene(&scene, visibleCount, 0.0f, "PipelineMicroBenchmark.mtss", jobSystem)) {
+            return false;
+        }
+        scene.Update(FRAME_DELTA, jobSystem);
+        scene.Commit(jobSystem);
+
+        // Every proxy is visible, without a camera, a culling or a LOD selection
+        // カメラ、カリング、LOD選択無しで全Proxyを可視とする
+        RenderQueueView view;
+        RenderQueue renderQueue;
+        EntityWorld *world = &scene.GetProxyWorld();
+        std::vector<XMFLOAT4X4> instanceMatrices(world->GetEntityCount());
+        const UINT builtCount = Scene::BuildRenderQueue(world, view, jobSystem, &renderQueue, instanceMatrices.data());
+
+        std::vector<XMFLOAT4X4> packedMatrices(builtCount);
+        char nameStr[64];
+        UINT packedCount = 0;
+        const float cappedTimeInMs = MeasureMedianInMs(repeatCount * 10, [&]() {
+            packedCount = Scene::PackInstanceMatrices(renderQueue, builtCount, instanceMatrices.data(), MAX_SCENE_INSTANCE_COUNT, packedMatrices.data());
+        });
+        snprintf(nameStr, sizeof(nameStr), "PackInstanceMatrices (%u visible, cap %u)", builtCount, MAX_SCENE_INSTANCE_COUNT);
+        ReportBenchCase(nameStr, packedCount, cappedTimeInMs);
+
+        const float uncappedTimeInMs = MeasureMedianInMs(repeatCount * 10, [&]() {
+            packedCount = Scene::PackInstanceMatrices(renderQueue, builtCount, instanceMatrices.data(), builtCount, packedMatrices.data());
+        });
+        snprintf(nameStr, sizeof(nameStr), "PackInstanceMatrices (%u visible, no cap)", builtCount);
+        ReportBenchCase(nameStr, packedCount, uncappedTimeInMs);
+        return true;
+    }
+} // namespace ""
+
+/// @~english
+/// @brief Time the CPU stages of a frame one by one, each in isolation of the others
+/// @details Scene::Update and Scene::Commit over a scene of dynamic actors, Scene::PackInstanceMatrices
+///          at 64, MAX_SCENE_INSTANCE_COUNT and 4096 visible items. "-actors <count>", "-repeat <count>".
+/// @~japanese
+/// @brief フレームのCPUの各段階を他と切り離し1つずつ計測
+/// @details 動的なアクタのシーンに対するScene::UpdateとScene::Commit、可視の要素数64、
+///          MAX_SCENE_INSTANCE_COUNT、4096に対するScene::PackInstanceMatrices
+int main(int argc, char **argv) {
+    const bool smoke = IsSmokeRun(argc, argv);
+    const UINT actorCount  = GetBenchOption(argc, argv, "-actors", smoke ? SMOKE_ACTOR_COUNT : DEFAULT_ACTOR_COUNT);
+    const UINT repeatCount = GetBenchOption(argc, argv, "-repeat", smoke ? SMOKE_REPEAT_COUNT : DEFAULT_REPEAT_COUNT);
+
+    JobSystem jobSystem;
+    if (!jobSystem.Init(0)) {
+        return -1;
+    }
+
+    bool succeeded = RunUpdateAndCommit(actorCount, repeatCount, &jobSystem);
+    for (UINT visibleCount : PACK_VISIBLE_COUNTS) {
+        succeeded = succeeded && RunPacking(visibleCount, repeatCount, &jobSystem);
+    }
+
+    jobSystem.Deinit();
+    return succeeded ? 0 : -1;
+}
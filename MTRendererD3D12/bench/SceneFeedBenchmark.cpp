@@ -0,0 +1,181 @@
+/// @file SceneFeedBenchmark.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "BenchCommon.h"
+#include "SceneFeed.h"
+
+namespace {
+    const char *BENCH_FEED_NAME             = "MTRendererSceneFeedBenchmark";
+    const UINT  BENCH_ACTOR_COUNT           = 4096;
+    const UINT  BENCH_BATCH_SIZE            = 256;
+    const UINT  SMOKE_RECORD_COUNT          = 200000;
+    const UINT  DEFAULT_RECORD_COUNT        = 20000000;
+    const UINT  SMOKE_LATENCY_BATCH_COUNT   = 50;
+    const UINT  DEFAULT_LATENCY_BATCH_COUNT = 2000;
+    const auto  LATENCY_BATCH_INTERVAL      = std::chrono::microseconds(500);
+
+    /// @~english
+    /// @brief Transform of an actor as the consumer keeps it
+    /// @~japanese
+    /// @brief 消費者が保持するアクタのトランスフォーム
+    struct BenchActor {
+        float   translation[3];
+        float   rotation[3];
+        float   scale[3];
+        bool    spawned;
+    };
+
+    /// @~english
+    /// @brief Fill a batch of records, the first record of each actor spawns it
+    /// @~japanese
+    /// @brief レコードのバッチを埋める、各アクタの最初のレコードはそれを出現させる
+    void FillBatch(SceneFeedRecord *records, UINT count, UINT64 sequence) {
+        const INT64 timestamp = SceneFeed::GetTimestamp();
+        for (UINT i = 0; i < count; ++i, ++sequence) {
+            SceneFeedRecord &record = records[i];
+            record = SceneFeedRecord();
+            record.timestamp      = timestamp;
+            record.type           = (sequence < BENCH_ACTOR_COUNT) ? SceneFeedRecordType::Spawn : SceneFeedRecordType::Transform;
+            record.actorId        = static_cast<UINT>(sequence % BENCH_ACTOR_COUNT);
+            record.translation[0] = static_cast<float>(sequence % 1024);
+            record.rotation[2]    = static_cast<float>(sequence % 360);
+            record.scale[0]       = 1.0f;
+            record.scale[1]       = 1.0f;
+            record.scale[2]       = 1.0f;
+        }
+    }
+
+    /// @~english
+    /// @brief Apply a record the way the renderer does, straight into the actor
+    /// @~japanese
+    /// @brief レンダラーと同様にレコードをアクタへ直接適用
+    bool ApplyRecord(const SceneFeedRecord &record, BenchActor *actors) {
+        if (record.actorId >= BENCH_ACTOR_COUNT) {
+            return false;
+        }
+
+        BenchActor &actor = actors[record.actorId];
+        if (record.type == SceneFeedRecordType::Spawn) {
+            actor.spawned = true;
+        }
+        memcpy(actor.translation, record.translation, sizeof(actor.translation));
+        memcpy(actor.rotation, record.rotation, sizeof(actor.rotation));
+        memcpy(actor.scale, record.scale, sizeof(actor.scale));
+        return actor.spawned;
+    }
+
+    /// @~english
+    /// @brief Stream records through the ring, the producer publishes as fast as the ring allows or paced
+    /// @details The producer maps the feed on its own, like the simulation process, and runs on another
+    ///          thread. The latency is from the stamp of a record to the start of the drain consuming it.
+    /// @param[in] caseName Name of the case in the report
+    /// @param[in] batchCount Number of batches of BENCH_BATCH_SIZE records
+    /// @param[in] paced True to publish a batch every LATENCY_BATCH_INTERVAL, false to saturate the ring
+    /// @~japanese
+    /// @brief リングを通してレコードを流す、生産者はリングが許す限り速く、もしくは一定間隔で公開する
+    /// @details 生産者はシミュレーションプロセスと同様に独自にフィードをマッピングし、別スレッドで動作する。
+    ///          レイテンシはレコードの記録時刻からそれを消費する取り出しの開始まで
+    /// @param[in] caseName 出力でのケースの名前
+    /// @param[in] batchCount BENCH_BATCH_SIZE個のレコードのバッチ数
+    /// @param[in] paced LATENCY_BATCH_INTERVAL毎に1バッチ公開する場合はTrue、リングを飽和させる場合はFalse
+    bool RunStream(const char *caseName, UINT batchCount, bool paced) {
+        SceneFeed consumerFeed;
+        if (!consumerFeed.Create(BENCH_FEED_NAME, DEFAULT_SCENE_FEED_CAPACITY, BENCH_ACTOR_COUNT)) {
+            OutputDebugStringA("SceneFeed: could not create\n");
+            return false;
+        }
+
+        std::atomic<bool> producerFailed(false);
+        std::thread producer([&]() {
+            SceneFeed feed;
+            if (!feed.Open(BENCH_FEED_NAME)) {
+                producerFailed = true;
+                return;
+            }
+            SceneFeedRecord records[BENCH_BATCH_SIZE];
+            auto nextTime = std::chrono::steady_clock::now();
+            for (UINT64 batch = 0; batch < batchCount; ++batch) {
+                if (paced) {
+                    nextTime += LATENCY_BATCH_INTERVAL;
+                    std::this_thread::sleep_until(nextTime);
+                }
+                FillBatch(records, BENCH_BATCH_SIZE, batch * BENCH_BATCH_SIZE);
+
+                // The benchmark keeps every record, the simulation process would drop them instead
+                // ベンチマークは全レコードを保持する、シミュレーションプロセスは代わりに破棄する
+                UINT writtenCount = 0;
+                while (writtenCount < BENCH_BATCH_SIZE) {
+                    writtenCount += feed.Publish(records + writtenCount, BENCH_BATCH_SIZE - writtenCount);
+                }
+            }
+        });
+
+        std::vector<BenchActor> actors(BENCH_ACTOR_COUNT, BenchActor());
+        std::vector<float> latencies;
+        latencies.reserve(paced ? static_cast<size_t>(batchCount) * BENCH_BATCH_SIZE : 0);
+
+        const UINT64 recordCount = static_cast<UINT64>(batchCount) * BENCH_BATCH_SIZE;
+        UINT64 consumedCount = 0;
+        UINT   rejectedCount = 0;
+        double latencySumInMs = 0.0;
+        const auto beginTime = std::chrono::high_resolution_clock::now();
+        while (consumedCount < recordCount && !producerFailed) {
+            const INT64 consumeTimestamp = SceneFeed::GetTimestamp();
+            UINT skippedCount = 0;
+            consumedCount += consumerFeed.Consume([&](const SceneFeedRecord &record) {
+                const float latencyInMs = static_cast<float>(std::max<INT64>(consumeTimestamp - record.timestamp, 0)) / 1000000.0f;
+                latencySumInMs += latencyInMs;
+                if (paced) {
+                    latencies.push_back(latencyInMs);
+                }
+                if (!ApplyRecord(record, actors.data())) {
+                    rejectedCount++;
+                }
+            }, &skippedCount);
+            rejectedCount += skippedCount;
+        }
+        const float timeInMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - beginTime).count();
+        producer.join();
+        consumerFeed.Close();
+        if (producerFailed) {
+            OutputDebugStringA("SceneFeed: could not open\n");
+            return false;
+        }
+
+        char reportStr[256];
+        snprintf(reportStr, sizeof(reportStr), "%-40s %9llu records %10.3f ms %9.2f ns/record, %.1f M records/s, %u rejected\n",
+            caseName, static_cast<unsigned long long>(consumedCount), timeInMs, timeInMs * 1000000.0f / static_cast<float>(std::max<UINT64>(consumedCount, 1)),
+            static_cast<double>(consumedCount) / std::max(timeInMs, 0.001f) / 1000.0, rejectedCount);
+        OutputDebugStringA(reportStr);
+
+        if (!latencies.empty()) {
+            std::sort(latencies.begin(), latencies.end());
+            snprintf(reportStr, sizeof(reportStr), "%-40s mean %.4f ms, p50 %.4f ms, p99 %.4f ms, max %.4f ms\n",
+                "  latency", latencySumInMs / static_cast<double>(latencies.size()),
+                latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100], latencies.back());
+            OutputDebugStringA(reportStr);
+        }
+        return rejectedCount == 0;
+    }
+} // namespace ""
+
+/// @~english
+/// @brief Time the scene feed from a producer to a consumer through the shared memory ring
+/// @details The throughput case saturates the ring, the latency case publishes a batch of
+///          BENCH_BATCH_SIZE records every LATENCY_BATCH_INTERVAL and reports the percentiles of the time
+///          from stamping a record to draining it. "-records <count>", "-batches <count>".
+/// @~japanese
+/// @brief 共有メモリのリングを通した生産者から消費者へのシーンフィードを計測
+/// @details スループットのケースはリングを飽和させ、レイテンシのケースはLATENCY_BATCH_INTERVAL毎に
+///          BENCH_BATCH_SIZE個のレコードのバッチを公開し、レコードの記録から取り出しまでの時間の
+///          パーセンタイルを出力する
+int main(int argc, char **argv) {
+    const bool smoke = IsSmokeRun(argc, argv);
+    const UINT recordCount = GetBenchOption(argc, argv, "-records", smoke ? SMOKE_RECORD_COUNT : DEFAULT_RECORD_COUNT);
+    const UINT batchCount  = GetBenchOption(argc, argv, "-batches", smoke ? SMOKE_LATENCY_BATCH_COUNT : DEFAULT_LATENCY_BATCH_COUNT);
+
+    bool succeeded = RunStream("SceneFeed throughput (saturated)", std::max(recordCount / BENCH_BATCH_SIZE, 1u), false);
+    succeeded = succeeded && RunStream("SceneFeed latency (paced)", batchCount, true);
+    return succeeded ? 0 : -1;
+}
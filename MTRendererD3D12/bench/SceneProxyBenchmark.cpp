@@ -0,0 +1,118 @@
+/// @file SceneProxyBenchmark.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "BenchCommon.h"
+#include "EntityWorld.h"
+#include "SceneActor.h"
+#include "SceneProxyRegistry.h"
+#include "TransformHierarchy.h"
+
+#include <memory>
+
+using namespace DirectX;
+
+namespace {
+    const UINT SMOKE_ACTOR_COUNT    = 2000;
+    const UINT SMOKE_REPEAT_COUNT   = 3;
+    const UINT DEFAULT_ACTOR_COUNT  = 100000;
+    const UINT DEFAULT_REPEAT_COUNT = 20;
+    const UINT CAMERA_INTERVAL      = 64;   // One camera actor every this many actors
+
+    /// @~english
+    /// @brief Per object virtual commit the registry replaced
+    /// @~japanese
+    /// @brief レジストリが置き換えたオブジェクト毎の仮想関数による伝達
+    class VirtualCommitActor {
+    public:
+        virtual ~VirtualCommitActor() = default;
+        virtual void CommitProxy(EntityWorld *world, const TransformHierarchy &hierarchy) = 0;
+    };
+
+    /// @~english
+    /// @brief Actor committing through both paths, the work per actor is the one of SceneProxyBinding::CommitBatch
+    /// @~japanese
+    /// @brief 両方の経路で伝達するアクタ、アクタ毎の処理はSceneProxyBinding::CommitBatchと同じ
+    template<typename ActorT, typename ProxyT>
+    class BenchActor : public ActorT, public VirtualCommitActor {
+    public:
+        void SetTransformNode(UINT node) {
+            this->transformNode = node;
+        }
+
+        void CommitProxy(EntityWorld *world, const TransformHierarchy &hierarchy) override {
+            if (!world->IsAlive(this->proxyEntity)) {
+                this->proxyEntity = ProxyT::Create(world);
+            }
+            ProxyT::Commit(world, this, hierarchy.GetWorldMatrix(this->transformNode));
+        }
+    };
+
+    using BenchTriangleActor = BenchActor<TriangleSceneActor, TriangleSceneProxy>;
+    using BenchCameraActor   = BenchActor<CameraSceneActor, CameraSceneProxy>;
+} // namespace ""
+
+/// @~english
+/// @brief Time the devirtualized batch commit of SceneProxyRegistry against a virtual call per actor
+/// @details The same actors, mostly triangles with a camera every CAMERA_INTERVAL actors, are committed to the same
+///          proxies through a vector in creation order with a virtual call each, then through the per type actor lists
+///          of SceneProxyRegistry::CommitAll. "-actors <count>", "-repeat <count>".
+/// @~japanese
+/// @brief SceneProxyRegistryの仮想関数を介さないバッチ伝達をアクタ毎の仮想呼び出しと比較して計測
+/// @details 大半が三角形でCAMERA_INTERVAL毎にカメラを含む同じアクタを、生成順の配列を介したアクタ毎の仮想呼び出しと
+///          SceneProxyRegistry::CommitAllの型毎のアクタリストで、同じProxyへ伝達する
+int main(int argc, char **argv) {
+    const bool smoke = IsSmokeRun(argc, argv);
+    const UINT actorCount  = GetBenchOption(argc, argv, "-actors", smoke ? SMOKE_ACTOR_COUNT : DEFAULT_ACTOR_COUNT);
+    const UINT repeatCount = GetBenchOption(argc, argv, "-repeat", smoke ? SMOKE_REPEAT_COUNT : DEFAULT_REPEAT_COUNT);
+
+    TransformHierarchy hierarchy;
+    std::vector<UINT> nodes(actorCount);
+    hierarchy.CreateRootNodes(actorCount, nodes.data());
+
+    std::vector<std::unique_ptr<SceneActor>> actors(actorCount);
+    std::vector<VirtualCommitActor *> virtualActors(actorCount);
+    SceneProxyRegistry::ActorLists actorLists;
+    for (UINT i = 0; i < actorCount; ++i) {
+        const XMVECTOR translation = XMVectorSet(static_cast<float>(i % 1000), 0.0f, static_cast<float>(i / 1000), 1.0f);
+        hierarchy.SetLocalTransform(nodes[i], translation, XMQuaternionIdentity(), XMVectorSet(1.0f, 1.0f, 1.0f, 0.0f));
+
+        if (i % CAMERA_INTERVAL == 0) {
+            auto actor = std::make_unique<BenchCameraActor>();
+            actor->Init(1920, 1080, 60.0f);
+            actor->SetTransformNode(nodes[i]);
+            virtualActors[i] = actor.get();
+            SceneProxyRegistry::GetActorList<CameraSceneActor>(actorLists).push_back(actor.get());
+            actors[i] = std::move(actor);
+        } else {
+            auto actor = std::make_unique<BenchTriangleActor>();
+            actor->SetTransformNode(nodes[i]);
+            virtualActors[i] = actor.get();
+            SceneProxyRegistry::GetActorList<TriangleSceneActor>(actorLists).push_back(actor.get());
+            actors[i] = std::move(actor);
+        }
+    }
+    hierarchy.UpdateWorldMatrices(nullptr);
+
+    // Both paths commit to the same proxies, the warm-up run of the first one creates them
+    // 両方の経路は同じProxyへ伝達し、最初の経路の準備実行でProxyを生成する
+    EntityWorld world;
+    const float virtualTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+        for (auto actor : virtualActors) {
+            actor->CommitProxy(&world, hierarchy);
+        }
+    });
+    ReportBenchCase("Virtual commit per actor", actorCount, virtualTimeInMs);
+
+    const float registryTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+        SceneProxyRegistry::CommitAll(&world, hierarchy, actorLists);
+    });
+    ReportBenchCase("SceneProxyRegistry::CommitAll", actorCount, registryTimeInMs);
+
+    char reportStr[256];
+    snprintf(reportStr, sizeof(reportStr), "  CommitAll speedup over virtual commit: %.2fx (%u proxies)\n",
+        virtualTimeInMs / std::max(registryTimeInMs, 1e-6f), world.GetEntityCount());
+    OutputDebugStringA(reportStr);
+
+    return 0;
+}
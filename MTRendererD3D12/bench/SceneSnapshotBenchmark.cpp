@@ -0,0 +1,146 @@
+/// @file SceneSnapshotBenchmark.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "BenchCommon.h"
+#include "JobSystem.h"
+#include "Scene.h"
+#include "StressScene.h"
+
+#include <memory>
+
+using namespace DirectX;
+
+namespace {
+    const UINT  SMOKE_ACTOR_COUNT       = 10000;
+    const UINT  SMOKE_REPEAT_COUNT      = 3;
+    const UINT  DEFAULT_ACTOR_COUNT     = 1000000;
+    const UINT  DEFAULT_REPEAT_COUNT    = 5;
+    const UINT  HIERARCHY_FANOUT        = 4;
+    const float TARGET_LOAD_TIME_IN_MS  = 100.0f;   // Budget of loading DEFAULT_ACTOR_COUNT actors
+
+    /// @~english
+    /// @brief Write a snapshot of triangle actors forming one tree, each subtree splits its other nodes evenly
+    ///        into HIERARCHY_FANOUT child subtrees
+    /// @~japanese
+    /// @brief 1つのツリーを成す三角形のアクタのスナップショットを書き込む、各サブツリーは他のノードを
+    ///        HIERARCHY_FANOUT個の子のサブツリーへ均等に分ける
+    bool WriteHierarchySnapshot(UINT actorCount, const char *path) {
+        std::vector<UINT> nodeParents;
+        std::vector<UINT> nodeSubtreeSizes;
+        nodeParents.reserve(actorCount);
+        nodeSubtreeSizes.reserve(actorCount);
+
+        // Depth first with a stack of (parent, subtree size), the nodes come out in pre-order
+        // (親, サブツリーのサイズ)のスタックで深さ優先に辿り、ノードは前順に並ぶ
+        std::vector<std::pair<UINT, UINT>> stack;
+        if (0 < actorCount) {
+            stack.emplace_back(INVALID_SCENE_SNAPSHOT_INDEX, actorCount);
+        }
+        while (!stack.empty()) {
+            const auto [parent, size] = stack.back();
+            stack.pop_back();
+
+            const UINT position = static_cast<UINT>(nodeParents.size());
+            nodeParents.push_back(parent);
+            nodeSubtreeSizes.push_back(size);
+
+            // The first child is pushed last, so it comes right after its parent
+            // 最初の子を最後に積み、親の直後に並ぶようにする
+            const UINT childNodeCount = size - 1;
+            for (UINT c = HIERARCHY_FANOUT; 0 < c--; ) {
+                const UINT childSize = childNodeCount / HIERARCHY_FANOUT + ((c < childNodeCount % HIERARCHY_FANOUT) ? 1 : 0);
+                if (0 < childSize) {
+                    stack.emplace_back(position, childSize);
+                }
+            }
+        }
+
+        std::vector<UINT>                nodes(actorCount);
+        std::vector<XMFLOAT4>            translations(actorCount, XMFLOAT4(0.0f, 1.0f, 0.0f, 1.0f));
+        std::vector<XMFLOAT4>            rotations(actorCount, XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f));
+        std::vector<XMFLOAT4>            scales(actorCount, XMFLOAT4(1.0f, 1.0f, 1.0f, 0.0f));
+        std::vector<SceneSnapshotTick>   ticks(actorCount, SceneSnapshotTick{ static_cast<UINT>(TickGroup::Update), 1, 0.0f, SCENE_SNAPSHOT_FLAG_SLEEPING });
+        std::vector<SceneSnapshotMotion> motions(actorCount, SceneSnapshotMotion{ 0.0f, 0.0f, 0.0f, 0.0f });
+        std::iota(nodes.begin(), nodes.end(), 0u);
+
+        SceneSnapshotWriter writer;
+        writer.SetActorCount(SceneSnapshotActorType::Triangle, actorCount);
+        writer.SetArray(SceneSnapshotActorType::Triangle, SceneSnapshotField::Translation, translations.data());
+        writer.SetArray(SceneSnapshotActorType::Triangle, SceneSnapshotField::Rotation, rotations.data());
+        writer.SetArray(SceneSnapshotActorType::Triangle, SceneSnapshotField::Scale, scales.data());
+        writer.SetArray(SceneSnapshotActorType::Triangle, SceneSnapshotField::Node, nodes.data());
+        writer.SetArray(SceneSnapshotActorType::Triangle, SceneSnapshotField::Tick, ticks.data());
+        writer.SetArray(SceneSnapshotActorType::Triangle, SceneSnapshotField::Params, motions.data());
+        writer.SetActorCount(SceneSnapshotActorType::Camera, 0);
+        writer.SetHierarchy(nodeParents.data(), nodeSubtreeSizes.data());
+        return writer.SaveToFile(path);
+    }
+
+    /// @~english
+    /// @brief Time loading a snapshot into an empty scene, the scenes are destroyed outside the timing
+    /// @return Median time (milliseconds), negative if a load failed
+    /// @~japanese
+    /// @brief 空のシーンへのスナップショットの読み込みを計測、シーンの破棄は計測に含めない
+    /// @return 中央値の時間（ミリ秒、読み込みに失敗した場合は負の値
+    float MeasureLoadInMs(const char *path, UINT repeatCount, JobSystem *jobSystem) {
+        std::vector<float> loadTimes(std::max(repeatCount, 1u));
+        for (auto &loadTime : loadTimes) {
+            auto scene = std::make_unique<Scene>();
+            const auto beginTime = std::chrono::high_resolution_clock::now();
+            const bool loaded = scene->LoadSnapshot(path, jobSystem);
+            const auto endTime = std::chrono::high_resolution_clock::now();
+            if (!loaded) {
+                return -1.0f;
+            }
+            loadTime = std::chrono::duration<float, std::milli>(endTime - beginTime).count();
+        }
+        std::nth_element(loadTimes.begin(), loadTimes.begin() + loadTimes.size() / 2, loadTimes.end());
+        return loadTimes[loadTimes.size() / 2];
+    }
+} // namespace ""
+
+/// @~english
+/// @brief Time Scene::LoadSnapshot of a flat stress scene and of one tree of the same number of actors
+/// @details The tree splits every subtree into HIERARCHY_FANOUT children. Both are loaded on the job system into
+///          an empty scene and compared with TARGET_LOAD_TIME_IN_MS. "-actors <count>", "-repeat <count>".
+/// @~japanese
+/// @brief 平坦なストレスシーンと同じアクタ数の1つのツリーのScene::LoadSnapshotを計測
+/// @details ツリーは各サブツリーをHIERARCHY_FANOUT個の子に分ける。両者ともJobSystem上で空のシーンへ読み込み、
+///          TARGET_LOAD_TIME_IN_MSと比較する
+int main(int argc, char **argv) {
+    const bool smoke = IsSmokeRun(argc, argv);
+    const UINT actorCount  = GetBenchOption(argc, argv, "-actors", smoke ? SMOKE_ACTOR_COUNT : DEFAULT_ACTOR_COUNT);
+    const UINT repeatCount = GetBenchOption(argc, argv, "-repeat", smoke ? SMOKE_REPEAT_COUNT : DEFAULT_REPEAT_COUNT);
+
+    const char *flatPath      = "SceneSnapshotBenchmarkFlat.mtss";
+    const char *hierarchyPath = "SceneSnapshotBenchmarkHierarchy.mtss";
+    StressSceneDesc desc;
+    desc.actorCount = actorCount;
+    if (!GenerateStressScene(desc, flatPath) || !WriteHierarchySnapshot(actorCount, hierarchyPath)) {
+        OutputDebugStringA("SceneSnapshot: could not write\n");
+        return -1;
+    }
+
+    JobSystem jobSystem;
+    if (!jobSystem.Init(0)) {
+        return -1;
+    }
+
+    const float flatTimeInMs = MeasureLoadInMs(flatPath, repeatCount, &jobSystem);
+    const float hierarchyTimeInMs = MeasureLoadInMs(hierarchyPath, repeatCount, &jobSystem);
+    if (flatTimeInMs < 0.0f || hierarchyTimeInMs < 0.0f) {
+        OutputDebugStringA("SceneSnapshot: could not load\n");
+        return -1;
+    }
+    ReportBenchCase("Scene::LoadSnapshot (flat)", actorCount, flatTimeInMs);
+    ReportBenchCase("Scene::LoadSnapshot (hierarchy)", actorCount, hierarchyTimeInMs);
+
+    char reportStr[256];
+    snprintf(reportStr, sizeof(reportStr), "  Target: %.0f ms at %u actors, flat %.1f ms, hierarchy %.1f ms\n",
+        TARGET_LOAD_TIME_IN_MS, DEFAULT_ACTOR_COUNT, flatTimeInMs, hierarchyTimeInMs);
+    OutputDebugStringA(reportStr);
+
+    jobSystem.Deinit();
+    return 0;
+}
@@ -0,0 +1,160 @@
+/// @file TransformHierarchyBenchmark.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "BenchCommon.h"
+#include "JobSystem.h"
+#include "TransformHierarchy.h"
+
+#include <random>
+
+using namespace DirectX;
+
+namespace {
+    const UINT SMOKE_NODE_COUNT     = 4096;
+    const UINT SMOKE_REPEAT_COUNT   = 3;
+    const UINT DEFAULT_NODE_COUNT   = 100000;
+    const UINT DEFAULT_REPEAT_COUNT = 20;
+    const UINT DEEP_CHAIN_COUNT     = 16;
+    const UINT SHUFFLE_SEED         = 23;
+
+    /// @~english
+    /// @brief Shape of a benchmarked hierarchy
+    /// @~japanese
+    /// @brief 計測する階層の形
+    enum class HierarchyShape : UINT {
+        Deep,   ///< @~english DEEP_CHAIN_COUNT chains of parent and child @~japanese 親子のDEEP_CHAIN_COUNT本の連鎖
+        Wide,   ///< @~english One root, every other node is its child @~japanese 1つのルート、他の全ノードはその子
+    };
+
+    /// @~english
+    /// @brief Node of a tree linked by pointers, the layout the flat arrays replaced
+    /// @~japanese
+    /// @brief ポインタで繋いだツリーのノード、フラットな配列が置き換えた配置
+    struct PointerNode {
+        XMVECTOR            translation;
+        XMVECTOR            rotation;
+        XMVECTOR            scale;
+        XMMATRIX            worldMtx;
+        const PointerNode  *parent;
+    };
+
+    /// @~english
+    /// @brief Parent of each node, the parents come before their children
+    /// @~japanese
+    /// @brief 各ノードの親、親は子より前に並ぶ
+    std::vector<UINT> MakeParents(HierarchyShape shape, UINT nodeCount) {
+        std::vector<UINT> parents(nodeCount, INVALID_TRANSFORM_NODE);
+        if (shape == HierarchyShape::Deep) {
+            const UINT chainLength = std::max(nodeCount / DEEP_CHAIN_COUNT, 1u);
+            for (UINT i = 0; i < nodeCount; ++i) {
+                parents[i] = (i % chainLength == 0) ? INVALID_TRANSFORM_NODE : i - 1;
+            }
+        } else {
+            for (UINT i = 1; i < nodeCount; ++i) {
+                parents[i] = 0;
+            }
+        }
+        return parents;
+    }
+
+    /// @~english
+    /// @brief Time the world matrix update of one shape, the flat hierarchy against the pointer tree
+    /// @~japanese
+    /// @brief 1つの形のWorld変換行列の更新を計測、フラットな階層とポインタのツリーを比較
+    void RunShape(HierarchyShape shape, UINT nodeCount, UINT repeatCount, JobSystem *jobSystem) {
+        const std::vector<UINT> parents = MakeParents(shape, nodeCount);
+        const XMVECTOR translation = XMVectorSet(0.0f, 1.0f, 0.0f, 1.0f);
+        const XMVECTOR rotation    = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+        const XMVECTOR scale       = XMVectorSet(1.0f, 1.0f, 1.0f, 0.0f);
+
+        TransformHierarchy hierarchy;
+        hierarchy.Reserve(nodeCount);
+        std::vector<UINT> nodes(nodeCount);
+        for (UINT i = 0; i < nodeCount; ++i) {
+            nodes[i] = hierarchy.CreateNode((parents[i] == INVALID_TRANSFORM_NODE) ? INVALID_TRANSFORM_NODE : nodes[parents[i]]);
+            hierarchy.SetLocalTransform(nodes[i], translation, rotation, scale);
+        }
+
+        // The pointer nodes are allocated in shuffled order, as nodes created over a session end up
+        // ポインタのノードは、セッション中に生成されたノードのようにシャッフルした順序で確保する
+        std::vector<UINT> allocOrder(nodeCount);
+        std::iota(allocOrder.begin(), allocOrder.end(), 0u);
+        std::shuffle(allocOrder.begin(), allocOrder.end(), std::mt19937(SHUFFLE_SEED));
+        std::vector<std::unique_ptr<PointerNode>> pointerNodes(nodeCount);
+        for (UINT index : allocOrder) {
+            pointerNodes[index] = std::make_unique<PointerNode>();
+        }
+        const XMVECTOR rotationQuat = XMQuaternionRotationRollPitchYawFromVector(XMVectorScale(rotation, XM_PI / 180.0f));
+        for (UINT i = 0; i < nodeCount; ++i) {
+            PointerNode &node = *pointerNodes[i];
+            node.translation = translation;
+            node.rotation    = rotationQuat;
+            node.scale       = scale;
+            node.worldMtx    = XMMatrixIdentity();
+            node.parent      = (parents[i] == INVALID_TRANSFORM_NODE) ? nullptr : pointerNodes[parents[i]].get();
+        }
+
+        const char *shapeName = (shape == HierarchyShape::Deep) ? "deep" : "wide";
+        char caseName[64];
+        const float pointerTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+            for (const auto &node : pointerNodes) {
+                const XMMATRIX localMtx = XMMatrixMultiply(XMMatrixMultiply(XMMatrixScalingFromVector(node->scale), XMMatrixRotationQuaternion(node->rotation)), XMMatrixTranslationFromVector(node->translation));
+                node->worldMtx = (node->parent == nullptr) ? localMtx : XMMatrixMultiply(localMtx, node->parent->worldMtx);
+            }
+        });
+        snprintf(caseName, sizeof(caseName), "Pointer tree (%s)", shapeName);
+        ReportBenchCase(caseName, nodeCount, pointerTimeInMs);
+
+        const float serialTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+            hierarchy.UpdateWorldMatrices(nullptr);
+        });
+        snprintf(caseName, sizeof(caseName), "TransformHierarchy (%s, serial)", shapeName);
+        ReportBenchCase(caseName, nodeCount, serialTimeInMs);
+
+        const float parallelTimeInMs = MeasureMedianInMs(repeatCount, [&]() {
+            hierarchy.UpdateWorldMatrices(jobSystem);
+        });
+        snprintf(caseName, sizeof(caseName), "TransformHierarchy (%s, JobSystem)", shapeName);
+        ReportBenchCase(caseName, nodeCount, parallelTimeInMs);
+
+        // Both compute every matrix with the same operations, so they match bit for bit
+        // 両者は全ての行列を同じ演算で算出する為、ビット単位で一致する
+        UINT mismatchCount = 0;
+        for (UINT i = 0; i < nodeCount; ++i) {
+            mismatchCount += (memcmp(&hierarchy.GetWorldMatrix(nodes[i]), &pointerNodes[i]->worldMtx, sizeof(XMMATRIX)) != 0) ? 1 : 0;
+        }
+
+        const TransformHierarchyStats &stats = hierarchy.GetStats();
+        char reportStr[256];
+        snprintf(reportStr, sizeof(reportStr), "  Speedup over pointer tree: %.2fx, JobSystem: %.2fx (%u serial nodes, %u tasks, %u mismatches)\n",
+            pointerTimeInMs / std::max(serialTimeInMs, 1e-6f), pointerTimeInMs / std::max(parallelTimeInMs, 1e-6f), stats.serialNodeCount, stats.taskCount, mismatchCount);
+        OutputDebugStringA(reportStr);
+    }
+} // namespace ""
+
+/// @~english
+/// @brief Time the world matrix update of deep and wide hierarchies against a tree linked by pointers
+/// @details Each of the DEEP_CHAIN_COUNT deep chains has no split point and becomes one task, while the root of a
+///          wide hierarchy is its split point and the children are merged into tasks.
+///          "-nodes <count>", "-repeat <count>".
+/// @~japanese
+/// @brief 深い階層と広い階層のWorld変換行列の更新をポインタで繋いだツリーと比較して計測
+/// @details DEEP_CHAIN_COUNT本の深い連鎖はそれぞれ分割点を持たず1つのタスクとなる。一方広い階層はルートが
+///          分割点となり、子はタスクにまとめられる
+int main(int argc, char **argv) {
+    const bool smoke = IsSmokeRun(argc, argv);
+    const UINT nodeCount   = GetBenchOption(argc, argv, "-nodes", smoke ? SMOKE_NODE_COUNT : DEFAULT_NODE_COUNT);
+    const UINT repeatCount = GetBenchOption(argc, argv, "-repeat", smoke ? SMOKE_REPEAT_COUNT : DEFAULT_REPEAT_COUNT);
+
+    JobSystem jobSystem;
+    if (!jobSystem.Init(0)) {
+        return -1;
+    }
+
+    RunShape(HierarchyShape::Deep, nodeCount, repeatCount, &jobSystem);
+    RunShape(HierarchyShape::Wide, nodeCount, repeatCount, &jobSystem);
+
+    jobSystem.Deinit();
+    return 0;
+}
@@ -0,0 +1,452 @@
+/// @file DirectXMath.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+/// @~english
+/// @brief Subset of DirectXMath used by the CPU library, for the builds where the real header is not found.
+/// @details Only added to the include path by CMakeLists.txt when DirectXMath.h is missing. Follows the
+///          conventions of DirectXMath: row vectors, matrices multiplied left to right, XMVECTOR is an SSE
+///          register. Results match the SSE path of DirectXMath up to rounding.
+/// @~japanese
+/// @brief 実際のヘッダが見つからないビルド向けの、CPUライブラリが使用するDirectXMathのサブセット
+/// @details DirectXMath.hが無い場合にのみCMakeLists.txtがインクルードパスへ追加する。DirectXMathの規約に
+///          従う：行ベクトル、行列は左から右へ乗算、XMVECTORはSSEレジスタ。結果は丸めを除いてDirectXMathの
+///          SSE実装と一致する
+
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+
+#include <xmmintrin.h>
+#include <emmintrin.h>
+
+#define XM_CALLCONV
+
+namespace DirectX {
+
+constexpr float XM_PI       = 3.141592654f;
+constexpr float XM_2PI      = 6.283185307f;
+constexpr float XM_1DIVPI   = 0.318309886f;
+constexpr float XM_PIDIV2   = 1.570796327f;
+constexpr float XM_PIDIV4   = 0.785398163f;
+
+constexpr uint32_t XM_SELECT_0 = 0x00000000;
+constexpr uint32_t XM_SELECT_1 = 0xFFFFFFFF;
+
+using XMVECTOR = __m128;
+
+typedef const XMVECTOR  FXMVECTOR;
+typedef const XMVECTOR  GXMVECTOR;
+typedef const XMVECTOR& HXMVECTOR;
+typedef const XMVECTOR& CXMVECTOR;
+
+struct XMMATRIX;
+typedef const XMMATRIX& FXMMATRIX;
+typedef const XMMATRIX& CXMMATRIX;
+
+struct alignas(16) XMMATRIX {
+    XMVECTOR r[4];
+
+    XMMATRIX() = default;
+    XMMATRIX(FXMVECTOR r0, FXMVECTOR r1, FXMVECTOR r2, CXMVECTOR r3) : r{ r0, r1, r2, r3 } {}
+};
+
+struct XMFLOAT2 {
+    float x;
+    float y;
+
+    XMFLOAT2() = default;
+    constexpr XMFLOAT2(float _x, float _y) : x(_x), y(_y) {}
+};
+
+struct XMFLOAT3 {
+    float x;
+    float y;
+    float z;
+
+    XMFLOAT3() = default;
+    constexpr XMFLOAT3(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
+};
+
+struct XMFLOAT4 {
+    float x;
+    float y;
+    float z;
+    float w;
+
+    XMFLOAT4() = default;
+    constexpr XMFLOAT4(float _x, float _y, float _z, float _w) : x(_x), y(_y), z(_z), w(_w) {}
+};
+
+struct alignas(16) XMFLOAT4A : public XMFLOAT4 {
+    XMFLOAT4A() = default;
+    constexpr XMFLOAT4A(float _x, float _y, float _z, float _w) : XMFLOAT4(_x, _y, _z, _w) {}
+};
+
+struct XMFLOAT4X4 {
+    union {
+        struct {
+            float _11, _12, _13, _14;
+            float _21, _22, _23, _24;
+            float _31, _32, _33, _34;
+            float _41, _42, _43, _44;
+        };
+        float m[4][4];
+    };
+
+    XMFLOAT4X4() = default;
+    constexpr XMFLOAT4X4(float m00, float m01, float m02, float m03,
+                         float m10, float m11, float m12, float m13,
+                         float m20, float m21, float m22, float m23,
+                         float m30, float m31, float m32, float m33)
+        : _11(m00), _12(m01), _13(m02), _14(m03)
+        , _21(m10), _22(m11), _23(m12), _24(m13)
+        , _31(m20), _32(m21), _33(m22), _34(m23)
+        , _41(m30), _42(m31), _43(m32), _44(m33) {}
+
+    float operator() (size_t row, size_t column) const { return m[row][column]; }
+    float& operator() (size_t row, size_t column) { return m[row][column]; }
+};
+
+struct XMUINT4 {
+    uint32_t x;
+    uint32_t y;
+    uint32_t z;
+    uint32_t w;
+};
+
+//----------------------------------------------------------------------------------------------------
+// Scalar
+//----------------------------------------------------------------------------------------------------
+inline constexpr float XMConvertToRadians(float degrees) { return degrees * (XM_PI / 180.0f); }
+inline constexpr float XMConvertToDegrees(float radians) { return radians * (180.0f / XM_PI); }
+
+inline void XMScalarSinCos(float *sinValue, float *cosValue, float value) {
+    *sinValue = std::sin(value);
+    *cosValue = std::cos(value);
+}
+
+//----------------------------------------------------------------------------------------------------
+// Load and store
+//----------------------------------------------------------------------------------------------------
+inline XMVECTOR XM_CALLCONV XMLoadFloat(const float *source) { return _mm_load_ss(source); }
+inline XMVECTOR XM_CALLCONV XMLoadFloat2(const XMFLOAT2 *source) { return _mm_setr_ps(source->x, source->y, 0.0f, 0.0f); }
+inline XMVECTOR XM_CALLCONV XMLoadFloat3(const XMFLOAT3 *source) { return _mm_setr_ps(source->x, source->y, source->z, 0.0f); }
+inline XMVECTOR XM_CALLCONV XMLoadFloat4(const XMFLOAT4 *source) { return _mm_loadu_ps(&source->x); }
+inline XMVECTOR XM_CALLCONV XMLoadFloat4A(const XMFLOAT4A *source) { return _mm_load_ps(&source->x); }
+
+inline void XM_CALLCONV XMStoreFloat(float *destination, FXMVECTOR v) { _mm_store_ss(destination, v); }
+inline void XM_CALLCONV XMStoreFloat2(XMFLOAT2 *destination, FXMVECTOR v) { destination->x = v[0]; destination->y = v[1]; }
+inline void XM_CALLCONV XMStoreFloat3(XMFLOAT3 *destination, FXMVECTOR v) { destination->x = v[0]; destination->y = v[1]; destination->z = v[2]; }
+inline void XM_CALLCONV XMStoreFloat4(XMFLOAT4 *destination, FXMVECTOR v) { _mm_storeu_ps(&destination->x, v); }
+inline void XM_CALLCONV XMStoreFloat4A(XMFLOAT4A *destination, FXMVECTOR v) { _mm_store_ps(&destination->x, v); }
+
+inline XMMATRIX XM_CALLCONV XMLoadFloat4x4(const XMFLOAT4X4 *source) {
+    return XMMATRIX(_mm_loadu_ps(source->m[0]), _mm_loadu_ps(source->m[1]), _mm_loadu_ps(source->m[2]), _mm_loadu_ps(source->m[3]));
+}
+
+inline void XM_CALLCONV XMStoreFloat4x4(XMFLOAT4X4 *destination, FXMMATRIX m) {
+    _mm_storeu_ps(destination->m[0], m.r[0]);
+    _mm_storeu_ps(destination->m[1], m.r[1]);
+    _mm_storeu_ps(destination->m[2], m.r[2]);
+    _mm_storeu_ps(destination->m[3], m.r[3]);
+}
+
+//----------------------------------------------------------------------------------------------------
+// Vector
+//----------------------------------------------------------------------------------------------------
+inline XMVECTOR XM_CALLCONV XMVectorZero() { return _mm_setzero_ps(); }
+inline XMVECTOR XM_CALLCONV XMVectorSet(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+inline XMVECTOR XM_CALLCONV XMVectorReplicate(float value) { return _mm_set1_ps(value); }
+inline XMVECTOR XM_CALLCONV XMVectorTrueInt() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+
+inline float XM_CALLCONV XMVectorGetX(FXMVECTOR v) { return _mm_cvtss_f32(v); }
+inline float XM_CALLCONV XMVectorGetY(FXMVECTOR v) { return v[1]; }
+inline float XM_CALLCONV XMVectorGetZ(FXMVECTOR v) { return v[2]; }
+inline float XM_CALLCONV XMVectorGetW(FXMVECTOR v) { return v[3]; }
+inline float XM_CALLCONV XMVectorGetByIndex(FXMVECTOR v, size_t i) { return v[i]; }
+
+inline XMVECTOR XM_CALLCONV XMVectorSetX(FXMVECTOR v, float x) { XMVECTOR result = v; result[0] = x; return result; }
+inline XMVECTOR XM_CALLCONV XMVectorSetY(FXMVECTOR v, float y) { XMVECTOR result = v; result[1] = y; return result; }
+inline XMVECTOR XM_CALLCONV XMVectorSetZ(FXMVECTOR v, float z) { XMVECTOR result = v; result[2] = z; return result; }
+inline XMVECTOR XM_CALLCONV XMVectorSetW(FXMVECTOR v, float w) { XMVECTOR result = v; result[3] = w; return result; }
+
+inline XMVECTOR XM_CALLCONV XMVectorSplatX(FXMVECTOR v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)); }
+inline XMVECTOR XM_CALLCONV XMVectorSplatY(FXMVECTOR v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)); }
+inline XMVECTOR XM_CALLCONV XMVectorSplatZ(FXMVECTOR v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)); }
+inline XMVECTOR XM_CALLCONV XMVectorSplatW(FXMVECTOR v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)); }
+
+inline XMVECTOR XM_CALLCONV XMVectorAdd(FXMVECTOR v1, FXMVECTOR v2) { return _mm_add_ps(v1, v2); }
+inline XMVECTOR XM_CALLCONV XMVectorSubtract(FXMVECTOR v1, FXMVECTOR v2) { return _mm_sub_ps(v1, v2); }
+inline XMVECTOR XM_CALLCONV XMVectorMultiply(FXMVECTOR v1, FXMVECTOR v2) { return _mm_mul_ps(v1, v2); }
+inline XMVECTOR XM_CALLCONV XMVectorDivide(FXMVECTOR v1, FXMVECTOR v2) { return _mm_div_ps(v1, v2); }
+inline XMVECTOR XM_CALLCONV XMVectorMultiplyAdd(FXMVECTOR v1, FXMVECTOR v2, FXMVECTOR v3) { return _mm_add_ps(_mm_mul_ps(v1, v2), v3); }
+inline XMVECTOR XM_CALLCONV XMVectorScale(FXMVECTOR v, float scale) { return _mm_mul_ps(v, _mm_set1_ps(scale)); }
+inline XMVECTOR XM_CALLCONV XMVectorNegate(FXMVECTOR v) { return _mm_sub_ps(_mm_setzero_ps(), v); }
+inline XMVECTOR XM_CALLCONV XMVectorAbs(FXMVECTOR v) { return _mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), v), v); }
+inline XMVECTOR XM_CALLCONV XMVectorMin(FXMVECTOR v1, FXMVECTOR v2) { return _mm_min_ps(v1, v2); }
+inline XMVECTOR XM_CALLCONV XMVectorMax(FXMVECTOR v1, FXMVECTOR v2) { return _mm_max_ps(v1, v2); }
+inline XMVECTOR XM_CALLCONV XMVectorSqrt(FXMVECTOR v) { return _mm_sqrt_ps(v); }
+inline XMVECTOR XM_CALLCONV XMVectorReciprocal(FXMVECTOR v) { return _mm_div_ps(_mm_set1_ps(1.0f), v); }
+
+inline XMVECTOR XM_CALLCONV XMVectorLerp(FXMVECTOR v0, FXMVECTOR v1, float t) {
+    return _mm_add_ps(v0, _mm_mul_ps(_mm_sub_ps(v1, v0), _mm_set1_ps(t)));
+}
+
+inline XMVECTOR XM_CALLCONV XMVectorSelectControl(uint32_t index0, uint32_t index1, uint32_t index2, uint32_t index3) {
+    const __m128i control = _mm_setr_epi32(static_cast<int>(index0), static_cast<int>(index1), static_cast<int>(index2), static_cast<int>(index3));
+    return _mm_castsi128_ps(_mm_cmpgt_epi32(control, _mm_setzero_si128()));
+}
+
+inline XMVECTOR XM_CALLCONV XMVectorSelect(FXMVECTOR v1, FXMVECTOR v2, FXMVECTOR control) {
+    return _mm_or_ps(_mm_andnot_ps(control, v1), _mm_and_ps(v2, control));
+}
+
+inline XMVECTOR XM_CALLCONV XMVector3Dot(FXMVECTOR v1, FXMVECTOR v2) {
+    return _mm_set1_ps(v1[0] * v2[0] + v1[1] * v2[1] + v1[2] * v2[2]);
+}
+
+inline XMVECTOR XM_CALLCONV XMVector4Dot(FXMVECTOR v1, FXMVECTOR v2) {
+    return _mm_set1_ps(v1[0] * v2[0] + v1[1] * v2[1] + v1[2] * v2[2] + v1[3] * v2[3]);
+}
+
+inline XMVECTOR XM_CALLCONV XMVector3LengthSq(FXMVECTOR v) { return XMVector3Dot(v, v); }
+inline XMVECTOR XM_CALLCONV XMVector3Length(FXMVECTOR v) { return _mm_sqrt_ps(XMVector3Dot(v, v)); }
+inline XMVECTOR XM_CALLCONV XMVector4LengthSq(FXMVECTOR v) { return XMVector4Dot(v, v); }
+inline XMVECTOR XM_CALLCONV XMVector4Length(FXMVECTOR v) { return _mm_sqrt_ps(XMVector4Dot(v, v)); }
+
+// A zero vector stays zero, as in DirectXMath
+// DirectXMathと同様に零ベクトルは零のまま
+inline XMVECTOR XM_CALLCONV XMVector3Normalize(FXMVECTOR v) {
+    const float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    return (0.0f < length) ? _mm_div_ps(v, _mm_set1_ps(length)) : _mm_setzero_ps();
+}
+
+inline XMVECTOR XM_CALLCONV XMVector4Normalize(FXMVECTOR v) {
+    const float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2] + v[3] * v[3]);
+    return (0.0f < length) ? _mm_div_ps(v, _mm_set1_ps(length)) : _mm_setzero_ps();
+}
+
+inline XMVECTOR XM_CALLCONV XMVector3Cross(FXMVECTOR v1, FXMVECTOR v2) {
+    return _mm_setr_ps(
+        v1[1] * v2[2] - v1[2] * v2[1],
+        v1[2] * v2[0] - v1[0] * v2[2],
+        v1[0] * v2[1] - v1[1] * v2[0],
+        0.0f);
+}
+
+inline bool XM_CALLCONV XMVector3Equal(FXMVECTOR v1, FXMVECTOR v2) { return (_mm_movemask_ps(_mm_cmpeq_ps(v1, v2)) & 7) == 7; }
+inline bool XM_CALLCONV XMVector4Equal(FXMVECTOR v1, FXMVECTOR v2) { return _mm_movemask_ps(_mm_cmpeq_ps(v1, v2)) == 15; }
+inline bool XM_CALLCONV XMVector3Less(FXMVECTOR v1, FXMVECTOR v2) { return (_mm_movemask_ps(_mm_cmplt_ps(v1, v2)) & 7) == 7; }
+inline bool XM_CALLCONV XMVector3LessOrEqual(FXMVECTOR v1, FXMVECTOR v2) { return (_mm_movemask_ps(_mm_cmple_ps(v1, v2)) & 7) == 7; }
+inline bool XM_CALLCONV XMVector3Greater(FXMVECTOR v1, FXMVECTOR v2) { return (_mm_movemask_ps(_mm_cmpgt_ps(v1, v2)) & 7) == 7; }
+inline bool XM_CALLCONV XMVector3GreaterOrEqual(FXMVECTOR v1, FXMVECTOR v2) { return (_mm_movemask_ps(_mm_cmpge_ps(v1, v2)) & 7) == 7; }
+
+inline bool XM_CALLCONV XMVector3NearEqual(FXMVECTOR v1, FXMVECTOR v2, FXMVECTOR epsilon) {
+    const XMVECTOR delta = XMVectorAbs(_mm_sub_ps(v1, v2));
+    return (_mm_movemask_ps(_mm_cmple_ps(delta, epsilon)) & 7) == 7;
+}
+
+inline bool XM_CALLCONV XMVector4NearEqual(FXMVECTOR v1, FXMVECTOR v2, FXMVECTOR epsilon) {
+    const XMVECTOR delta = XMVectorAbs(_mm_sub_ps(v1, v2));
+    return _mm_movemask_ps(_mm_cmple_ps(delta, epsilon)) == 15;
+}
+
+inline XMVECTOR XM_CALLCONV XMVector4Transform(FXMVECTOR v, FXMMATRIX m) {
+    XMVECTOR result = _mm_mul_ps(XMVectorSplatX(v), m.r[0]);
+    result = _mm_add_ps(result, _mm_mul_ps(XMVectorSplatY(v), m.r[1]));
+    result = _mm_add_ps(result, _mm_mul_ps(XMVectorSplatZ(v), m.r[2]));
+    return _mm_add_ps(result, _mm_mul_ps(XMVectorSplatW(v), m.r[3]));
+}
+
+// The W of the vector is taken as 1
+// ベクトルのWは1とみなす
+inline XMVECTOR XM_CALLCONV XMVector3Transform(FXMVECTOR v, FXMMATRIX m) {
+    XMVECTOR result = _mm_mul_ps(XMVectorSplatX(v), m.r[0]);
+    result = _mm_add_ps(result, _mm_mul_ps(XMVectorSplatY(v), m.r[1]));
+    result = _mm_add_ps(result, _mm_mul_ps(XMVectorSplatZ(v), m.r[2]));
+    return _mm_add_ps(result, m.r[3]);
+}
+
+inline XMVECTOR XM_CALLCONV XMVector3TransformCoord(FXMVECTOR v, FXMMATRIX m) {
+    const XMVECTOR result = XMVector3Transform(v, m);
+    return _mm_div_ps(result, XMVectorSplatW(result));
+}
+
+// The W of the vector is taken as 0
+// ベクトルのWは0とみなす
+inline XMVECTOR XM_CALLCONV XMVector3TransformNormal(FXMVECTOR v, FXMMATRIX m) {
+    XMVECTOR result = _mm_mul_ps(XMVectorSplatX(v), m.r[0]);
+    result = _mm_add_ps(result, _mm_mul_ps(XMVectorSplatY(v), m.r[1]));
+    return _mm_add_ps(result, _mm_mul_ps(XMVectorSplatZ(v), m.r[2]));
+}
+
+//----------------------------------------------------------------------------------------------------
+// Plane
+//----------------------------------------------------------------------------------------------------
+inline XMVECTOR XM_CALLCONV XMPlaneDotCoord(FXMVECTOR plane, FXMVECTOR v) {
+    return _mm_set1_ps(plane[0] * v[0] + plane[1] * v[1] + plane[2] * v[2] + plane[3]);
+}
+
+inline XMVECTOR XM_CALLCONV XMPlaneNormalize(FXMVECTOR plane) {
+    const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+    return (0.0f < length) ? _mm_div_ps(plane, _mm_set1_ps(length)) : _mm_setzero_ps();
+}
+
+//----------------------------------------------------------------------------------------------------
+// Quaternion
+//----------------------------------------------------------------------------------------------------
+inline XMVECTOR XM_CALLCONV XMQuaternionIdentity() { return _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f); }
+inline XMVECTOR XM_CALLCONV XMQuaternionNormalize(FXMVECTOR q) { return XMVector4Normalize(q); }
+inline XMVECTOR XM_CALLCONV XMQuaternionDot(FXMVECTOR q1, FXMVECTOR q2) { return XMVector4Dot(q1, q2); }
+
+// Rotation by q1 followed by q2, the product q2 * q1
+// q1に続くq2による回転、積q2 * q1
+inline XMVECTOR XM_CALLCONV XMQuaternionMultiply(FXMVECTOR q1, FXMVECTOR q2) {
+    return _mm_setr_ps(
+        q2[3] * q1[0] + q2[0] * q1[3] + q2[1] * q1[2] - q2[2] * q1[1],
+        q2[3] * q1[1] - q2[0] * q1[2] + q2[1] * q1[3] + q2[2] * q1[0],
+        q2[3] * q1[2] + q2[0] * q1[1] - q2[1] * q1[0] + q2[2] * q1[3],
+        q2[3] * q1[3] - q2[0] * q1[0] - q2[1] * q1[1] - q2[2] * q1[2]);
+}
+
+// Roll about Z, then pitch about X, then yaw about Y
+// Z軸周りのロール、X軸周りのピッチ、Y軸周りのヨーの順
+inline XMVECTOR XM_CALLCONV XMQuaternionRotationRollPitchYaw(float pitch, float yaw, float roll) {
+    const float sp = std::sin(pitch * 0.5f), cp = std::cos(pitch * 0.5f);
+    const float sy = std::sin(yaw * 0.5f),   cy = std::cos(yaw * 0.5f);
+    const float sr = std::sin(roll * 0.5f),  cr = std::cos(roll * 0.5f);
+    return _mm_setr_ps(
+        sp * cy * cr + cp * sy * sr,
+        cp * sy * cr - sp * cy * sr,
+        cp * cy * sr - sp * sy * cr,
+        cp * cy * cr + sp * sy * sr);
+}
+
+inline XMVECTOR XM_CALLCONV XMQuaternionRotationRollPitchYawFromVector(FXMVECTOR angles) {
+    return XMQuaternionRotationRollPitchYaw(angles[0], angles[1], angles[2]);
+}
+
+// Takes the shorter arc, nearly equal rotations are interpolated linearly, as in DirectXMath
+// DirectXMathと同様に短い方の弧を取り、ほぼ等しい回転は線形に補間する
+inline XMVECTOR XM_CALLCONV XMQuaternionSlerp(FXMVECTOR q0, FXMVECTOR q1, float t) {
+    const float oneMinusEpsilon = 1.0f - 0.00001f;
+
+    float cosOmega = q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2] + q0[3] * q1[3];
+    const float sign = (cosOmega < 0.0f) ? -1.0f : 1.0f;
+    cosOmega *= sign;
+
+    float scale0 = 1.0f - t;
+    float scale1 = t;
+    if (cosOmega < oneMinusEpsilon) {
+        const float sinOmega = std::sqrt(1.0f - cosOmega * cosOmega);
+        const float omega = std::atan2(sinOmega, cosOmega);
+        scale0 = std::sin((1.0f - t) * omega) / sinOmega;
+        scale1 = std::sin(t * omega) / sinOmega;
+    }
+    scale1 *= sign;
+
+    return _mm_add_ps(_mm_mul_ps(q0, _mm_set1_ps(scale0)), _mm_mul_ps(q1, _mm_set1_ps(scale1)));
+}
+
+//----------------------------------------------------------------------------------------------------
+// Matrix
+//----------------------------------------------------------------------------------------------------
+inline XMMATRIX XM_CALLCONV XMMatrixIdentity() {
+    return XMMATRIX(_mm_setr_ps(1.0f, 0.0f, 0.0f, 0.0f), _mm_setr_ps(0.0f, 1.0f, 0.0f, 0.0f), _mm_setr_ps(0.0f, 0.0f, 1.0f, 0.0f), _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+}
+
+inline XMMATRIX XM_CALLCONV XMMatrixMultiply(FXMMATRIX m1, CXMMATRIX m2) {
+    XMMATRIX result;
+    for (int i = 0; i < 4; ++i) {
+        result.r[i] = XMVector4Transform(m1.r[i], m2);
+    }
+    return result;
+}
+
+inline XMMATRIX XM_CALLCONV XMMatrixTranspose(FXMMATRIX m) {
+    XMMATRIX result = m;
+    _MM_TRANSPOSE4_PS(result.r[0], result.r[1], result.r[2], result.r[3]);
+    return result;
+}
+
+inline XMMATRIX XM_CALLCONV XMMatrixTranslation(float x, float y, float z) {
+    XMMATRIX result = XMMatrixIdentity();
+    result.r[3] = _mm_setr_ps(x, y, z, 1.0f);
+    return result;
+}
+
+inline XMMATRIX XM_CALLCONV XMMatrixTranslationFromVector(FXMVECTOR offset) {
+    return XMMatrixTranslation(offset[0], offset[1], offset[2]);
+}
+
+inline XMMATRIX XM_CALLCONV XMMatrixScaling(float x, float y, float z) {
+    return XMMATRIX(_mm_setr_ps(x, 0.0f, 0.0f, 0.0f), _mm_setr_ps(0.0f, y, 0.0f, 0.0f), _mm_setr_ps(0.0f, 0.0f, z, 0.0f), _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+}
+
+inline XMMATRIX XM_CALLCONV XMMatrixScalingFromVector(FXMVECTOR scale) {
+    return XMMatrixScaling(scale[0], scale[1], scale[2]);
+}
+
+inline XMMATRIX XM_CALLCONV XMMatrixRotationQuaternion(FXMVECTOR q) {
+    const float x = q[0], y = q[1], z = q[2], w = q[3];
+    return XMMATRIX(
+        _mm_setr_ps(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w), 0.0f),
+        _mm_setr_ps(2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w), 0.0f),
+        _mm_setr_ps(2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y), 0.0f),
+        _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+}
+
+inline XMMATRIX XM_CALLCONV XMMatrixRotationRollPitchYaw(float pitch, float yaw, float roll) {
+    return XMMatrixRotationQuaternion(XMQuaternionRotationRollPitchYaw(pitch, yaw, roll));
+}
+
+inline XMMATRIX XM_CALLCONV XMMatrixRotationRollPitchYawFromVector(FXMVECTOR angles) {
+    return XMMatrixRotationQuaternion(XMQuaternionRotationRollPitchYawFromVector(angles));
+}
+
+inline XMMATRIX XM_CALLCONV XMMatrixRotationZ(float angle) {
+    const float s = std::sin(angle), c = std::cos(angle);
+    return XMMATRIX(_mm_setr_ps(c, s, 0.0f, 0.0f), _mm_setr_ps(-s, c, 0.0f, 0.0f), _mm_setr_ps(0.0f, 0.0f, 1.0f, 0.0f), _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+}
+
+inline XMMATRIX XM_CALLCONV XMMatrixLookToLH(FXMVECTOR eyePosition, FXMVECTOR eyeDirection, FXMVECTOR upDirection) {
+    const XMVECTOR r2 = XMVector3Normalize(eyeDirection);
+    const XMVECTOR r0 = XMVector3Normalize(XMVector3Cross(upDirection, r2));
+    const XMVECTOR r1 = XMVector3Cross(r2, r0);
+    const XMVECTOR negEye = XMVectorNegate(eyePosition);
+
+    XMMATRIX result(
+        XMVectorSetW(r0, XMVectorGetX(XMVector3Dot(r0, negEye))),
+        XMVectorSetW(r1, XMVectorGetX(XMVector3Dot(r1, negEye))),
+        XMVectorSetW(r2, XMVectorGetX(XMVector3Dot(r2, negEye))),
+        _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+    return XMMatrixTranspose(result);
+}
+
+inline XMMATRIX XM_CALLCONV XMMatrixLookAtLH(FXMVECTOR eyePosition, FXMVECTOR focusPosition, FXMVECTOR upDirection) {
+    return XMMatrixLookToLH(eyePosition, XMVectorSubtract(focusPosition, eyePosition), upDirection);
+}
+
+inline XMMATRIX XM_CALLCONV XMMatrixPerspectiveFovLH(float fovAngleY, float aspectRatio, float nearZ, float farZ) {
+    const float height = std::cos(fovAngleY * 0.5f) / std::sin(fovAngleY * 0.5f);
+    const float width  = height / aspectRatio;
+    const float range  = farZ / (farZ - nearZ);
+    return XMMATRIX(
+        _mm_setr_ps(width, 0.0f, 0.0f, 0.0f),
+        _mm_setr_ps(0.0f, height, 0.0f, 0.0f),
+        _mm_setr_ps(0.0f, 0.0f, range, 1.0f),
+        _mm_setr_ps(0.0f, 0.0f, -range * nearZ, 0.0f));
+}
+
+inline XMMATRIX XM_CALLCONV XMMatrixOrthographicLH(float viewWidth, float viewHeight, float nearZ, float farZ) {
+    const float range = 1.0f / (farZ - nearZ);
+    return XMMATRIX(
+        _mm_setr_ps(2.0f / viewWidth, 0.0f, 0.0f, 0.0f),
+        _mm_setr_ps(0.0f, 2.0f / viewHeight, 0.0f, 0.0f),
+        _mm_setr_ps(0.0f, 0.0f, range, 0.0f),
+        _mm_setr_ps(0.0f, 0.0f, -range * nearZ, 1.0f));
+}
+
+} // namespace DirectX
@@ -0,0 +1,142 @@
+/// @file AnimationClip.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "AnimationClip.h"
+
+using namespace DirectX;
+
+namespace {
+// Quantize value to 16 bits over [min, min + range]
+// valueを[min, min + range]の範囲で16bitに量子化
+UINT16 QuantizeRange(float value, float min, float range) {
+    if (range <= 0.0f) {
+        return 0;
+    }
+    const float fraction = std::clamp((value - min) / range, 0.0f, 1.0f);
+    return static_cast<UINT16>(fraction * ANIMATION_RANGE_QUANTIZE_SCALE + 0.5f);
+}
+
+// Quantize a quaternion component in [-1, 1] to 16 bits
+// [-1, 1]のクォータニオンの成分を16bitに量子化
+INT16 QuantizeRotation(float value) {
+    return static_cast<INT16>(std::lround(std::clamp(value, -1.0f, 1.0f) * ANIMATION_ROTATION_QUANTIZE_SCALE));
+}
+} // namespace ""
+
+//----------------------------------------------------------------------------------------------------
+// AnimationClip
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+AnimationClip::AnimationClip()
+: sampleRate(DEFAULT_ANIMATION_SAMPLE_RATE)
+, duration(0.0f)
+, translationMin(0.0f, 0.0f, 0.0f, 0.0f)
+, translationExtent(0.0f, 0.0f, 0.0f, 0.0f)
+, scaleMin(1.0f, 1.0f, 1.0f, 0.0f)
+, scaleExtent(0.0f, 0.0f, 0.0f, 0.0f)
+{
+    ;
+}
+
+// Build the clip by compressing keyframes
+// キーフレームを圧縮してクリップを構築
+bool AnimationClip::Build(const AnimationClipSource &source) {
+    const size_t frameCount = source.translations.size();
+    if (frameCount == 0 || MAX_ANIMATION_FRAME_COUNT < frameCount || source.sampleRate <= 0.0f) {
+        return false;
+    }
+    if (source.rotations.size() != frameCount || source.scales.size() != frameCount) {
+        return false;
+    }
+
+    // Ranges of the translation and scale tracks
+    // 平行移動とスケールのトラックの範囲
+    float tMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float tMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    float sMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float sMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (size_t i = 0; i < frameCount; ++i) {
+        const float t[3] = { source.translations[i].x, source.translations[i].y, source.translations[i].z };
+        const float s[3] = { source.scales[i].x, source.scales[i].y, source.scales[i].z };
+        for (UINT c = 0; c < 3; ++c) {
+            tMin[c] = std::min(tMin[c], t[c]);
+            tMax[c] = std::max(tMax[c], t[c]);
+            sMin[c] = std::min(sMin[c], s[c]);
+            sMax[c] = std::max(sMax[c], s[c]);
+        }
+    }
+
+    keys.resize(frameCount);
+    XMVECTOR prevRotation = XMQuaternionIdentity();
+    for (size_t i = 0; i < frameCount; ++i) {
+        AnimationKey &key = keys[i];
+        const float t[3] = { source.translations[i].x, source.translations[i].y, source.translations[i].z };
+        const float s[3] = { source.scales[i].x, source.scales[i].y, source.scales[i].z };
+        for (UINT c = 0; c < 3; ++c) {
+            key.translation[c] = QuantizeRange(t[c], tMin[c], tMax[c] - tMin[c]);
+            key.scale[c]       = QuantizeRange(s[c], sMin[c], sMax[c] - sMin[c]);
+        }
+
+        // Keep neighboring keys in the same hemisphere so the sampler can blend them without a sign test
+        // サンプリング時に符号判定せずブレンドできるよう、隣接するキーを同じ半球に揃える
+        XMVECTOR rotation = XMQuaternionNormalize(XMLoadFloat4(&source.rotations[i]));
+        if (0 < i && XMVectorGetX(XMVector4Dot(rotation, prevRotation)) < 0.0f) {
+            rotation = XMVectorNegate(rotation);
+        }
+        prevRotation = rotation;
+
+        XMFLOAT4 q;
+        XMStoreFloat4(&q, rotation);
+        key.rotation[0] = QuantizeRotation(q.x);
+        key.rotation[1] = QuantizeRotation(q.y);
+        key.rotation[2] = QuantizeRotation(q.z);
+        key.rotation[3] = QuantizeRotation(q.w);
+    }
+
+    sampleRate        = source.sampleRate;
+    duration          = static_cast<float>(frameCount - 1) / sampleRate;
+    translationMin    = XMFLOAT4(tMin[0], tMin[1], tMin[2], 0.0f);
+    translationExtent = XMFLOAT4((tMax[0] - tMin[0]) / ANIMATION_RANGE_QUANTIZE_SCALE, (tMax[1] - tMin[1]) / ANIMATION_RANGE_QUANTIZE_SCALE, (tMax[2] - tMin[2]) / ANIMATION_RANGE_QUANTIZE_SCALE, 0.0f);
+    scaleMin          = XMFLOAT4(sMin[0], sMin[1], sMin[2], 0.0f);
+    scaleExtent       = XMFLOAT4((sMax[0] - sMin[0]) / ANIMATION_RANGE_QUANTIZE_SCALE, (sMax[1] - sMin[1]) / ANIMATION_RANGE_QUANTIZE_SCALE, (sMax[2] - sMin[2]) / ANIMATION_RANGE_QUANTIZE_SCALE, 0.0f);
+
+    return true;
+}
+
+// Sample the clip
+// クリップをサンプリング
+void AnimationClip::Sample(float time, bool slerp, XMVECTOR *translation, XMVECTOR *rotation, XMVECTOR *scale) const {
+    if (keys.empty()) {
+        *translation = XMVectorZero();
+        *rotation    = XMQuaternionIdentity();
+        *scale       = XMVectorSet(1.0f, 1.0f, 1.0f, 0.0f);
+        return;
+    }
+
+    const UINT lastFrame = GetFrameCount() - 1;
+    const float frame = std::clamp(time * sampleRate, 0.0f, static_cast<float>(lastFrame));
+    const UINT frame0 = std::min(static_cast<UINT>(frame), lastFrame);
+    const UINT frame1 = std::min(frame0 + 1, lastFrame);
+    const float alpha = frame - static_cast<float>(frame0);
+
+    auto decode = [this](const AnimationKey &key, XMVECTOR *t, XMVECTOR *r, XMVECTOR *s) {
+        *t = XMVectorMultiplyAdd(XMVectorSet(key.translation[0], key.translation[1], key.translation[2], 0.0f), XMLoadFloat4(&translationExtent), XMLoadFloat4(&translationMin));
+        *s = XMVectorMultiplyAdd(XMVectorSet(key.scale[0], key.scale[1], key.scale[2], 0.0f), XMLoadFloat4(&scaleExtent), XMLoadFloat4(&scaleMin));
+        *r = XMVectorScale(XMVectorSet(key.rotation[0], key.rotation[1], key.rotation[2], key.rotation[3]), 1.0f / ANIMATION_ROTATION_QUANTIZE_SCALE);
+    };
+
+    XMVECTOR t0, r0, s0, t1, r1, s1;
+    decode(keys[frame0], &t0, &r0, &s0);
+    decode(keys[frame1], &t1, &r1, &s1);
+
+    *translation = XMVectorSetW(XMVectorLerp(t0, t1, alpha), 1.0f);
+    *scale       = XMVectorLerp(s0, s1, alpha);
+    // Blend along the shorter arc, as quantization can leave neighboring keys slightly apart in hemisphere
+    // 量子化により隣接するキーの半球がわずかにずれ得る為、短い方の弧に沿ってブレンドする
+    if (XMVectorGetX(XMVector4Dot(r0, r1)) < 0.0f) {
+        r1 = XMVectorNegate(r1);
+    }
+    *rotation    = slerp ? XMQuaternionSlerp(XMQuaternionNormalize(r0), XMQuaternionNormalize(r1), alpha) : XMQuaternionNormalize(XMVectorLerp(r0, r1, alpha));
+}
@@ -0,0 +1,165 @@
+/// @file AnimationClip.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+// Default value
+const float DEFAULT_ANIMATION_SAMPLE_RATE       = 30.0f;
+const UINT MAX_ANIMATION_FRAME_COUNT            = 65536;
+const float ANIMATION_ROTATION_QUANTIZE_SCALE   = 32767.0f;
+const float ANIMATION_RANGE_QUANTIZE_SCALE      = 65535.0f;
+
+
+/// @~english
+/// @brief Uniformly sampled keyframes of a clip before compression
+/// @~japanese
+/// @brief 圧縮前のクリップの等間隔にサンプリングしたキーフレーム
+/// @~
+/// @struct AnimationClipSource
+struct AnimationClipSource {
+    float                               sampleRate;     ///< @~english Keyframes per second @~japanese 1秒あたりのキーフレーム数
+    std::vector<DirectX::XMFLOAT3>      translations;
+    std::vector<DirectX::XMFLOAT4>      rotations;      ///< @~english Quaternions @~japanese クォータニオン
+    std::vector<DirectX::XMFLOAT3>      scales;
+
+    /// @brief コンストラクタ
+    AnimationClipSource()
+    : sampleRate(DEFAULT_ANIMATION_SAMPLE_RATE)
+    {
+        ;
+    }
+};
+
+/// @~english
+/// @brief Quantized keyframe of the translation, rotation and scale tracks, stored interleaved
+/// @~japanese
+/// @brief 平行移動、回転、スケールのトラックの量子化したキーフレーム、インターリーブして格納
+/// @~
+/// @struct AnimationKey
+struct AnimationKey {
+    UINT16  translation[3]; ///< @~english Fraction of the track range @~japanese トラックの範囲内の割合
+    UINT16  scale[3];       ///< @~english Fraction of the track range @~japanese トラックの範囲内の割合
+    INT16   rotation[4];    ///< @~english Normalized quaternion, same hemisphere as the previous key @~japanese 正規化したクォータニオン、前のキーと同じ半球
+};
+
+static_assert(sizeof(AnimationKey) == 20, "AnimationKey must stay packed.");
+
+
+/// @class AnimationClip
+/// @~english
+/// @brief Compressed transform animation of a node
+/// @details Keyframes are uniformly sampled, so the keys around a time are found without a search.
+///          Translation and scale are quantized to 16 bits over the range of their track and rotations
+///          to 16-bit normalized quaternions, which stores a key in 20 bytes instead of 40. The keys of
+///          the three tracks are interleaved so a sample reads two adjacent keys.
+/// @~japanese
+/// @brief ノードの圧縮したトランスフォームアニメーション
+/// @details キーフレームは等間隔にサンプリングされている為、時刻の前後のキーを探索せずに求められる。
+///          平行移動とスケールはトラックの範囲で16bitに、回転は16bitの正規化クォータニオンに量子化し、
+///          1キーを40byteではなく20byteで格納する。3トラックのキーはインターリーブされている為、
+///          サンプリングは隣接する2つのキーを読むだけで済む
+class AnimationClip {
+public:
+    /// @~english
+    /// @brief Build the clip by compressing keyframes
+    /// @param[in] source Keyframes, every track must have the same number of keys
+    /// @return True if succeeded, false if the source is empty, inconsistent or too long
+    /// @~japanese
+    /// @brief キーフレームを圧縮してクリップを構築
+    /// @param[in] source キーフレーム、全トラックが同じキー数である必要がある
+    /// @return 成功した場合にはTrue、ソースが空、不整合もしくは長すぎる場合はFalseを返す
+    bool Build(const AnimationClipSource &source);
+
+    /// @~english
+    /// @brief Sample the clip, scalar reference of AnimationSystem::SampleBatch
+    /// @param[in] time Time in seconds, clamped to the clip
+    /// @param[in] slerp True to interpolate the rotation with an exact slerp, false for nlerp
+    /// @param[out] translation Sampled translation
+    /// @param[out] rotation Sampled rotation quaternion
+    /// @param[out] scale Sampled scale
+    /// @~japanese
+    /// @brief クリップをサンプリング、AnimationSystem::SampleBatchのスカラーの基準実装
+    /// @param[in] time 秒単位の時刻、クリップの範囲に制限される
+    /// @param[in] slerp 回転を正確なslerpで補間する場合はTrue、nlerpの場合はFalse
+    /// @param[out] translation サンプリングした平行移動
+    /// @param[out] rotation サンプリングした回転クォータニオン
+    /// @param[out] scale サンプリングしたスケール
+    void Sample(float time, bool slerp, DirectX::XMVECTOR *translation, DirectX::XMVECTOR *rotation, DirectX::XMVECTOR *scale) const;
+
+    /// @~english
+    /// @brief Get the keys
+    /// @~japanese
+    /// @brief キーを取得
+    const AnimationKey* GetKeys() const {
+        return keys.data();
+    }
+
+    /// @~english
+    /// @brief Get the number of keys per track
+    /// @~japanese
+    /// @brief トラックあたりのキー数を取得
+    UINT GetFrameCount() const {
+        return static_cast<UINT>(keys.size());
+    }
+
+    /// @~english
+    /// @brief Get the number of keyframes per second
+    /// @~japanese
+    /// @brief 1秒あたりのキーフレーム数を取得
+    float GetSampleRate() const {
+        return sampleRate;
+    }
+
+    /// @~english
+    /// @brief Get the length in seconds
+    /// @~japanese
+    /// @brief 秒単位の長さを取得
+    float GetDuration() const {
+        return duration;
+    }
+
+    /// @~english
+    /// @name Dequantization ranges, value = min + key * extent
+    /// @~japanese
+    /// @name 逆量子化の範囲、値 = min + キー * extent
+    /// @{
+    const DirectX::XMFLOAT4& GetTranslationMin() const {
+        return translationMin;
+    }
+    const DirectX::XMFLOAT4& GetTranslationExtent() const {
+        return translationExtent;
+    }
+    const DirectX::XMFLOAT4& GetScaleMin() const {
+        return scaleMin;
+    }
+    const DirectX::XMFLOAT4& GetScaleExtent() const {
+        return scaleExtent;
+    }
+    /// @}
+
+    /// @~english
+    /// @brief Get the size of the compressed keys in bytes
+    /// @~japanese
+    /// @brief 圧縮したキーのバイトサイズを取得
+    size_t GetCompressedSize() const {
+        return keys.size() * sizeof(AnimationKey);
+    }
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    AnimationClip();
+
+private:
+    std::vector<AnimationKey>   keys;
+    float                       sampleRate;
+    float                       duration;
+
+    // The extents are divided by the quantization scale, w is unused
+    // extentは量子化スケールで割った値、wは未使用
+    DirectX::XMFLOAT4           translationMin;
+    DirectX::XMFLOAT4           translationExtent;
+    DirectX::XMFLOAT4           scaleMin;
+    DirectX::XMFLOAT4           scaleExtent;
+};
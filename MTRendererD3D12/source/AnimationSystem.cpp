@@ -0,0 +1,255 @@
+/// @file AnimationSystem.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "AnimationSystem.h"
+#include "AnimationClip.h"
+#include "JobSystem.h"
+#include "TransformHierarchy.h"
+
+using namespace DirectX;
+
+namespace {
+// Load three unsigned 16-bit values as floats, w is the following value
+// 3つの符号なし16bit値をfloatとして読み込む、wは後続の値
+__m128 LoadUnsigned16(const UINT16 *values) {
+    const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(values));
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(packed, _mm_setzero_si128()));
+}
+
+// Load four signed 16-bit values as floats
+// 4つの符号付き16bit値をfloatとして読み込む
+__m128 LoadSigned16(const INT16 *values) {
+    const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(values));
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16));
+}
+
+// a + (b - a) * t
+__m128 Lerp(__m128 a, __m128 b, __m128 t) {
+    return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+}
+} // namespace ""
+
+//----------------------------------------------------------------------------------------------------
+// AnimationSystem
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+AnimationSystem::AnimationSystem()
+: slerp(false)
+{
+    ;
+}
+
+// Play a clip on a transform node
+// トランスフォームノードにクリップを再生
+UINT AnimationSystem::Play(const AnimationClip *clip, UINT node, float speed, bool loop) {
+    if (clip == nullptr || clip->GetFrameCount() == 0 || node == INVALID_TRANSFORM_NODE) {
+        return INVALID_ANIMATION_INSTANCE;
+    }
+
+    UINT handle = 0;
+    if (freeHandles.empty()) {
+        handle = static_cast<UINT>(handleToIndex.size());
+        handleToIndex.push_back(INVALID_ANIMATION_INSTANCE);
+    } else {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    }
+
+    handleToIndex[handle] = GetInstanceCount();
+    indexToHandle.push_back(handle);
+    clips.push_back(clip);
+    nodes.push_back(node);
+    times.push_back(0.0f);
+    speeds.push_back(speed);
+    loops.push_back(loop ? 1 : 0);
+
+    return handle;
+}
+
+// Stop an instance, the node keeps its last sampled transform
+// インスタンスを停止、ノードは最後にサンプリングしたトランスフォームを保持する
+void AnimationSystem::Stop(UINT instance) {
+    if (!IsPlaying(instance)) {
+        return;
+    }
+
+    // Move the last instance into the hole
+    // 末尾のインスタンスを空いた位置へ移動
+    const UINT index = handleToIndex[instance];
+    const UINT last  = GetInstanceCount() - 1;
+    if (index != last) {
+        clips[index]         = clips[last];
+        nodes[index]         = nodes[last];
+        times[index]         = times[last];
+        speeds[index]        = speeds[last];
+        loops[index]         = loops[last];
+        indexToHandle[index] = indexToHandle[last];
+        handleToIndex[indexToHandle[index]] = index;
+    }
+    clips.pop_back();
+    nodes.pop_back();
+    times.pop_back();
+    speeds.pop_back();
+    loops.pop_back();
+    indexToHandle.pop_back();
+
+    handleToIndex[instance] = INVALID_ANIMATION_INSTANCE;
+    freeHandles.push_back(instance);
+}
+
+// Set the time of an instance
+// インスタンスの時刻をセット
+void AnimationSystem::SetTime(UINT instance, float time) {
+    if (IsPlaying(instance)) {
+        times[handleToIndex[instance]] = time;
+    }
+}
+
+// Advance the instances and write their local transforms
+// インスタンスを進めてローカルトランスフォームを書き込む
+void AnimationSystem::Update(float delta, TransformHierarchy *hierarchy, JobSystem *jobSystem) {
+    auto beginTime = std::chrono::high_resolution_clock::now();
+
+    const UINT count = GetInstanceCount();
+    auto updateRange = [this, hierarchy, delta](UINT begin, UINT end) {
+        UINT dstIndices[ANIMATION_SAMPLE_BLOCK_SIZE];
+
+        for (UINT first = begin; first < end; first += ANIMATION_SAMPLE_BLOCK_SIZE) {
+            const UINT blockCount = std::min(end - first, ANIMATION_SAMPLE_BLOCK_SIZE);
+            for (UINT i = 0; i < blockCount; ++i) {
+                const UINT index = first + i;
+                const float duration = clips[index]->GetDuration();
+                float time = times[index] + delta * speeds[index];
+                if (loops[index] != 0 && 0.0f < duration) {
+                    time = fmodf(time, duration);
+                    time = (time < 0.0f) ? time + duration : time;
+                } else {
+                    time = std::clamp(time, 0.0f, duration);
+                }
+                times[index]  = time;
+                dstIndices[i] = hierarchy->GetNodeIndex(nodes[index]);
+            }
+
+            SampleBatch(blockCount, clips.data() + first, times.data() + first, dstIndices, slerp,
+                        hierarchy->GetLocalTranslations(), hierarchy->GetLocalRotations(), hierarchy->GetLocalScales());
+        }
+    };
+
+    const UINT taskCount = (count + DEFAULT_ANIMATION_BATCH_SIZE - 1) / DEFAULT_ANIMATION_BATCH_SIZE;
+    if (jobSystem != nullptr && 1 < taskCount) {
+        jobSystem->ParallelFor(count, DEFAULT_ANIMATION_BATCH_SIZE, updateRange);
+    } else {
+        updateRange(0, count);
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    stats.instanceCount = count;
+    stats.taskCount     = taskCount;
+    stats.timeInMs      = std::chrono::duration<float, std::milli>(endTime - beginTime).count();
+}
+
+// Sample clips for many instances, four at a time with SSE
+// 多数のインスタンスのクリップをSSEで4つずつサンプリング
+void AnimationSystem::SampleBatch(UINT count, const AnimationClip *const *clips, const float *times, const UINT *dstIndices, bool slerp,
+                                  XMVECTOR *translations, XMVECTOR *rotations, XMVECTOR *scales) {
+    const __m128 translationW = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+    const __m128 half         = _mm_set1_ps(0.5f);
+    const __m128 one          = _mm_set1_ps(1.0f);
+    const __m128 threeHalves  = _mm_set1_ps(1.5f);
+
+    for (UINT i = 0; i < count; i += 4) {
+        const UINT laneCount = std::min(count - i, 4u);
+
+        __m128 r0[4], r1[4];
+        alignas(16) float alphas[4];
+
+        for (UINT lane = 0; lane < 4; ++lane) {
+            // Missing lanes repeat the last instance and are not written
+            // 足りないレーンは最後のインスタンスを繰り返し、書き込まない
+            const UINT src = i + std::min(lane, laneCount - 1);
+            const AnimationClip *clip = clips[src];
+
+            const UINT lastFrame = clip->GetFrameCount() - 1;
+            const float frame = std::clamp(times[src] * clip->GetSampleRate(), 0.0f, static_cast<float>(lastFrame));
+            const UINT frame0 = std::min(static_cast<UINT>(frame), lastFrame);
+            const UINT frame1 = std::min(frame0 + 1, lastFrame);
+            const AnimationKey &key0 = clip->GetKeys()[frame0];
+            const AnimationKey &key1 = clip->GetKeys()[frame1];
+            alphas[lane] = frame - static_cast<float>(frame0);
+
+            r0[lane] = LoadSigned16(key0.rotation);
+            r1[lane] = LoadSigned16(key1.rotation);
+
+            if (lane < laneCount) {
+                // Dequantization is affine, so the quantized keys are blended first, the extents zero the extra w value
+                // 逆量子化はアフィン変換なので量子化されたキーを先にブレンドする、extentは余分なwの値を0にする
+                const __m128 alpha = _mm_set1_ps(alphas[lane]);
+                const __m128 t = Lerp(LoadUnsigned16(key0.translation), LoadUnsigned16(key1.translation), alpha);
+                const __m128 s = Lerp(LoadUnsigned16(key0.scale), LoadUnsigned16(key1.scale), alpha);
+
+                const UINT dst = dstIndices[src];
+                const __m128 translation = _mm_add_ps(_mm_add_ps(_mm_mul_ps(t, _mm_loadu_ps(&clip->GetTranslationExtent().x)), _mm_loadu_ps(&clip->GetTranslationMin().x)), translationW);
+                const __m128 scale       = _mm_add_ps(_mm_mul_ps(s, _mm_loadu_ps(&clip->GetScaleExtent().x)), _mm_loadu_ps(&clip->GetScaleMin().x));
+                _mm_storeu_ps(reinterpret_cast<float *>(&translations[dst]), translation);
+                _mm_storeu_ps(reinterpret_cast<float *>(&scales[dst]), scale);
+            }
+        }
+
+        // Rotations of the four lanes as a structure of arrays
+        // 4レーンの回転を配列の構造体として扱う
+        _MM_TRANSPOSE4_PS(r0[0], r0[1], r0[2], r0[3]);
+        _MM_TRANSPOSE4_PS(r1[0], r1[1], r1[2], r1[3]);
+
+        // Keys built by AnimationClip are in the same hemisphere, but quantization can push a cosine near 0 below it,
+        // the second key is negated where the cosine is negative so the blend takes the shorter arc
+        // AnimationClipが構築したキーは同じ半球にあるが、量子化により0付近の余弦が負になり得る為、
+        // 余弦が負の場合は2つ目のキーを反転し短い方の弧でブレンドする
+        __m128 d = _mm_mul_ps(r0[0], r1[0]);
+        d = _mm_add_ps(d, _mm_mul_ps(r0[1], r1[1]));
+        d = _mm_add_ps(d, _mm_mul_ps(r0[2], r1[2]));
+        d = _mm_add_ps(d, _mm_mul_ps(r0[3], r1[3]));
+        const __m128 signMask = _mm_and_ps(d, _mm_set1_ps(-0.0f));
+        for (UINT c = 0; c < 4; ++c) {
+            r1[c] = _mm_xor_ps(r1[c], signMask);
+        }
+
+        __m128 alpha = _mm_load_ps(alphas);
+        if (slerp) {
+            // Correct the nlerp parameter with a polynomial fit in the cosine of the angle between the keys
+            // キー間の角度の余弦による多項式近似でnlerpのパラメータを補正
+            const float rotationScale = 1.0f / (ANIMATION_ROTATION_QUANTIZE_SCALE * ANIMATION_ROTATION_QUANTIZE_SCALE);
+            d = _mm_min_ps(_mm_mul_ps(_mm_xor_ps(d, signMask), _mm_set1_ps(rotationScale)), one);
+
+            const __m128 a = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-3.2452f), _mm_mul_ps(d, _mm_sub_ps(_mm_set1_ps(3.55645f), _mm_mul_ps(d, _mm_set1_ps(1.43519f)))))));
+            const __m128 b = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-1.06021f), _mm_mul_ps(d, _mm_set1_ps(0.215638f)))));
+            const __m128 centered = _mm_sub_ps(alpha, half);
+            const __m128 k = _mm_add_ps(_mm_mul_ps(a, _mm_mul_ps(centered, centered)), b);
+            alpha = _mm_add_ps(alpha, _mm_mul_ps(_mm_mul_ps(alpha, _mm_mul_ps(centered, _mm_sub_ps(alpha, one))), k));
+        }
+
+        __m128 q[4];
+        for (UINT c = 0; c < 4; ++c) {
+            q[c] = Lerp(r0[c], r1[c], alpha);
+        }
+
+        // Normalize with a refined reciprocal square root, which also removes the quantization scale
+        // 精度を上げた平方根の逆数で正規化、量子化のスケールも取り除かれる
+        __m128 lengthSq = _mm_mul_ps(q[0], q[0]);
+        lengthSq = _mm_add_ps(lengthSq, _mm_mul_ps(q[1], q[1]));
+        lengthSq = _mm_add_ps(lengthSq, _mm_mul_ps(q[2], q[2]));
+        lengthSq = _mm_add_ps(lengthSq, _mm_mul_ps(q[3], q[3]));
+        __m128 invLength = _mm_rsqrt_ps(lengthSq);
+        invLength = _mm_mul_ps(invLength, _mm_sub_ps(threeHalves, _mm_mul_ps(_mm_mul_ps(half, lengthSq), _mm_mul_ps(invLength, invLength))));
+        for (UINT c = 0; c < 4; ++c) {
+            q[c] = _mm_mul_ps(q[c], invLength);
+        }
+
+        _MM_TRANSPOSE4_PS(q[0], q[1], q[2], q[3]);
+        for (UINT lane = 0; lane < laneCount; ++lane) {
+            _mm_storeu_ps(reinterpret_cast<float *>(&rotations[dstIndices[i + lane]]), q[lane]);
+        }
+    }
+}
@@ -0,0 +1,177 @@
+/// @file AnimationSystem.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+class AnimationClip;
+class JobSystem;
+class TransformHierarchy;
+
+// Default value
+const UINT INVALID_ANIMATION_INSTANCE           = ~0u;
+const UINT DEFAULT_ANIMATION_BATCH_SIZE         = 256;
+const UINT ANIMATION_SAMPLE_BLOCK_SIZE          = 64;
+
+static_assert((ANIMATION_SAMPLE_BLOCK_SIZE % 4) == 0, "The animation block size must be a multiple of the SIMD width.");
+
+
+/// @~english
+/// @brief Statistics of the animation update
+/// @~japanese
+/// @brief アニメーション更新処理の統計情報
+/// @~
+/// @struct AnimationStats
+struct AnimationStats {
+    UINT    instanceCount;
+    UINT    taskCount;
+    float   timeInMs;
+
+    /// @brief コンストラクタ
+    AnimationStats()
+    : instanceCount(0)
+    , taskCount(0)
+    , timeInMs(0.0f)
+    {
+        ;
+    }
+};
+
+
+/// @class AnimationSystem
+/// @~english
+/// @brief Plays animation clips on transform nodes, sampling many instances per call with SSE
+/// @details Playing instances are stored as dense arrays behind stable handles. Every update advances
+///          the times and samples the instances in batches on the job system workers, writing the
+///          local transforms straight into the arrays of the transform hierarchy. Four instances are
+///          sampled at a time, their rotations are blended along the shorter arc as a structure of arrays
+///          with nlerp, or with nlerp corrected to approximate slerp. The error of the correction is below
+///          1e-3 radians.
+///          Animated nodes must not be written by SetLocalTransform in the same frame.
+/// @~japanese
+/// @brief トランスフォームノードにアニメーションクリップを再生し、1回の呼び出しでSSEにより多数のインスタンスをサンプリング
+/// @details 再生中のインスタンスは不変のハンドルの背後に密な配列として格納する。更新毎に時刻を進め、
+///          インスタンスをJobSystemのワーカー上でバッチ毎にサンプリングし、ローカルトランスフォームを
+///          トランスフォーム階層の配列へ直接書き込む。4インスタンスずつサンプリングし、回転は配列の構造体として
+///          短い方の弧に沿ってnlerp、もしくはslerpを近似するよう補正したnlerpでブレンドする。補正の誤差は1e-3ラジアン未満。
+///          アニメーションするノードは同じフレームでSetLocalTransformにより書き込んではならない
+class AnimationSystem {
+public:
+    /// @~english
+    /// @brief Play a clip on a transform node
+    /// @param[in] clip Clip to play, must outlive the instance
+    /// @param[in] node Handle of the transform node
+    /// @param[in] speed Playback speed
+    /// @param[in] loop True to loop, false to hold the last key
+    /// @return Handle of the instance
+    /// @~japanese
+    /// @brief トランスフォームノードにクリップを再生
+    /// @param[in] clip 再生するクリップ、インスタンスより長く存在する必要がある
+    /// @param[in] node トランスフォームノードのハンドル
+    /// @param[in] speed 再生速度
+    /// @param[in] loop ループする場合はTrue、最後のキーで止める場合はFalse
+    /// @return インスタンスのハンドル
+    UINT Play(const AnimationClip *clip, UINT node, float speed, bool loop);
+
+    /// @~english
+    /// @brief Stop an instance, the node keeps its last sampled transform
+    /// @~japanese
+    /// @brief インスタンスを停止、ノードは最後にサンプリングしたトランスフォームを保持する
+    void Stop(UINT instance);
+
+    /// @~english
+    /// @brief Test if an instance is playing
+    /// @~japanese
+    /// @brief インスタンスが再生中か調べる
+    bool IsPlaying(UINT instance) const {
+        return (instance < handleToIndex.size()) && (handleToIndex[instance] != INVALID_ANIMATION_INSTANCE);
+    }
+
+    /// @~english
+    /// @brief Set the time of an instance
+    /// @~japanese
+    /// @brief インスタンスの時刻をセット
+    void SetTime(UINT instance, float time);
+
+    /// @~english
+    /// @brief Select the rotation blend, approximate slerp if true, nlerp otherwise
+    /// @~japanese
+    /// @brief 回転のブレンドを選択、Trueの場合は近似slerp、そうでないならnlerp
+    void SetSlerp(bool enable) {
+        slerp = enable;
+    }
+
+    /// @~english
+    /// @brief Advance the instances and write their local transforms
+    /// @param[in] delta Time taken since the last frame (seconds
+    /// @param[in] hierarchy Transform hierarchy to write to
+    /// @param[in] jobSystem JobSystem to distribute the batches to (nullptr to run serially
+    /// @~japanese
+    /// @brief インスタンスを進めてローカルトランスフォームを書き込む
+    /// @param[in] delta 前フレームからの経過時間（秒
+    /// @param[in] hierarchy 書き込み先のトランスフォーム階層
+    /// @param[in] jobSystem バッチを分散するJobSystem（nullptrの場合は逐次実行
+    void Update(float delta, TransformHierarchy *hierarchy, JobSystem *jobSystem);
+
+    /// @~english
+    /// @brief Sample clips for many instances, four at a time with SSE
+    /// @param[in] count Number of instances
+    /// @param[in] clips Clip of each instance
+    /// @param[in] times Time of each instance, clamped to its clip
+    /// @param[in] dstIndices Index each instance writes to in the output arrays
+    /// @param[in] slerp True for approximate slerp, false for nlerp
+    /// @param[out] translations Output translations, w is 1
+    /// @param[out] rotations Output rotation quaternions
+    /// @param[out] scales Output scales, w is 0
+    /// @~japanese
+    /// @brief 多数のインスタンスのクリップをSSEで4つずつサンプリング
+    /// @param[in] count インスタンス数
+    /// @param[in] clips 各インスタンスのクリップ
+    /// @param[in] times 各インスタンスの時刻、クリップの範囲に制限される
+    /// @param[in] dstIndices 各インスタンスが書き込む出力配列内の番号
+    /// @param[in] slerp 近似slerpの場合はTrue、nlerpの場合はFalse
+    /// @param[out] translations 出力する平行移動、wは1
+    /// @param[out] rotations 出力する回転クォータニオン
+    /// @param[out] scales 出力するスケール、wは0
+    static void SampleBatch(UINT count, const AnimationClip *const *clips, const float *times, const UINT *dstIndices, bool slerp,
+                            DirectX::XMVECTOR *translations, DirectX::XMVECTOR *rotations, DirectX::XMVECTOR *scales);
+
+    /// @~english
+    /// @brief Get the number of playing instances
+    /// @~japanese
+    /// @brief 再生中のインスタンス数を取得
+    UINT GetInstanceCount() const {
+        return static_cast<UINT>(clips.size());
+    }
+
+    /// @~english
+    /// @brief Get the statistics of the last update
+    /// @~japanese
+    /// @brief 最後の更新処理の統計情報を取得
+    const AnimationStats& GetStats() const {
+        return stats;
+    }
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    AnimationSystem();
+
+private:
+    // Dense arrays of the playing instances
+    // 再生中のインスタンスの密な配列
+    std::vector<const AnimationClip *>  clips;
+    std::vector<UINT>                   nodes;
+    std::vector<float>                  times;
+    std::vector<float>                  speeds;
+    std::vector<UINT8>                  loops;
+
+    // Stable handles
+    // 不変のハンドル
+    std::vector<UINT>   indexToHandle;
+    std::vector<UINT>   handleToIndex;
+    std::vector<UINT>   freeHandles;
+
+    bool                slerp;
+    AnimationStats      stats;
+};
@@ -0,0 +1,223 @@
+/// @file Benchmark.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "Benchmark.h"
+
+namespace {
+    const char *METRIC_NAMES[BENCHMARK_METRIC_COUNT] = {
+        "MainFrame",
+        "Update",
+        "CommitSceneProxy",
+        "Handoff",
+        "RenderQueue",
+        "InstancePacking",
+        "RenderFrame",
+    };
+
+    /// @~english
+    /// @brief Get a percentile of sorted samples by the nearest rank
+    /// @~japanese
+    /// @brief ソート済みのサンプルのパーセンタイルを最近順位法で取得
+    float GetPercentile(const std::vector<float> &sortedSamples, float percentile) {
+        const auto rank = static_cast<size_t>(std::ceil(percentile * 0.01f * sortedSamples.size()));
+        return sortedSamples[std::clamp<size_t>(rank, 1, sortedSamples.size()) - 1];
+    }
+
+    /// @~english
+    /// @brief Read a number following a key inside an object of the JSON
+    /// @~japanese
+    /// @brief JSONのオブジェクト内のキーに続く数値を読み込む
+    bool ReadJsonNumber(const char *object, const char *objectEnd, const char *key, double *dstValue) {
+        char pattern[64];
+        snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+        const char *found = strstr(object, pattern);
+        if (found == nullptr || objectEnd <= found) {
+            return false;
+        }
+
+        char *end = nullptr;
+        *dstValue = strtod(found + strlen(pattern), &end);
+        return end != found + strlen(pattern);
+    }
+} // namespace ""
+
+// Constructor
+// コンストラクタ
+BenchmarkRecorder::BenchmarkRecorder()
+: sampleCounts()
+, warmupFrames(0)
+, frameIndex(0)
+, recording(false)
+, packedInstanceCount(0)
+, clampedInstanceCount(0)
+, clampedViewCount(0)
+{
+    ;
+}
+
+// Initialize and start the warm-up
+// 初期化しウォームアップを開始
+void BenchmarkRecorder::Init(UINT warmupFrames, UINT frameCount) {
+    // Every metric gets one sample per frame, the RenderThread ones beyond the MainThread frames are dropped
+    // 各メトリクスはフレーム毎に1サンプル、MainThreadのフレーム数を超えたRenderThreadのものは破棄する
+    for (UINT i = 0; i < BENCHMARK_METRIC_COUNT; ++i) {
+        samples[i].assign(frameCount, 0.0f);
+        sampleCounts[i].store(0);
+    }
+    packedInstanceCount.store(0);
+    clampedInstanceCount.store(0);
+    clampedViewCount.store(0);
+    this->warmupFrames = warmupFrames;
+    frameIndex = 0;
+    recording.store(warmupFrames == 0 && 0 < frameCount);
+}
+
+// End a MainThread frame
+// MainThreadのフレームを終了
+bool BenchmarkRecorder::EndFrame(float frameTimeInMs) {
+    if (!IsActive()) {
+        return false;
+    }
+
+    AddSample(BenchmarkMetric::MainFrame, frameTimeInMs);
+    ++frameIndex;
+
+    if (frameIndex == warmupFrames) {
+        recording.store(true);
+    }
+    if (frameIndex == warmupFrames + samples[0].size()) {
+        recording.store(false);
+        return true;
+    }
+    return false;
+}
+
+// Get the distribution of the samples of a metric
+// メトリクスのサンプルの分布を取得
+BenchmarkSummary BenchmarkRecorder::Summarize(BenchmarkMetric metric) const {
+    const UINT index = static_cast<UINT>(metric);
+    BenchmarkSummary summary;
+    const UINT sampleCount = sampleCounts[index].load(std::memory_order_acquire);
+    if (sampleCount == 0) {
+        return summary;
+    }
+
+    std::vector<float> sortedSamples(samples[index].begin(), samples[index].begin() + sampleCount);
+    std::sort(sortedSamples.begin(), sortedSamples.end());
+
+    summary.sampleCount = sampleCount;
+    summary.meanInMs    = static_cast<float>(std::accumulate(sortedSamples.begin(), sortedSamples.end(), 0.0) / sortedSamples.size());
+    summary.p50InMs     = GetPercentile(sortedSamples, 50.0f);
+    summary.p90InMs     = GetPercentile(sortedSamples, 90.0f);
+    summary.p99InMs     = GetPercentile(sortedSamples, 99.0f);
+    summary.maxInMs     = sortedSamples.back();
+    return summary;
+}
+
+// Write the distributions of every metric as JSON
+// 全メトリクスの分布をJSONで書き込む
+bool BenchmarkRecorder::WriteJson(const char *path, const char *label) const {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    char line[256];
+    snprintf(line, sizeof(line), "{\n  \"label\": \"%s\",\n  \"warmupFrames\": %u,\n  \"frames\": %u,\n  \"metrics\": {\n",
+        label, warmupFrames, static_cast<UINT>(samples[0].size()));
+    file << line;
+    for (UINT i = 0; i < BENCHMARK_METRIC_COUNT; ++i) {
+        const auto summary = Summarize(static_cast<BenchmarkMetric>(i));
+        snprintf(line, sizeof(line),
+            "    \"%s\": {\"samples\": %u, \"mean\": %.6f, \"p50\": %.6f, \"p90\": %.6f, \"p99\": %.6f, \"max\": %.6f}%s\n",
+            METRIC_NAMES[i], summary.sampleCount, summary.meanInMs, summary.p50InMs, summary.p90InMs, summary.p99InMs, summary.maxInMs,
+            (i + 1 < BENCHMARK_METRIC_COUNT) ? "," : "");
+        file << line;
+    }
+
+    // Instances beyond the constants of a view are not drawn, the timings of such a run understate the scene
+    // ビューの定数を超えたインスタンスは描画されない為、そのような実行の計測はシーンを過小評価する
+    snprintf(line, sizeof(line), "  },\n  \"instancePacking\": {\"packed\": %u, \"clamped\": %u, \"clampedViews\": %u}\n}\n",
+        packedInstanceCount.load(), clampedInstanceCount.load(), clampedViewCount.load());
+    file << line;
+
+    return static_cast<bool>(file);
+}
+
+// Read the distributions written by WriteJson
+// WriteJsonが書き込んだ分布を読み込む
+bool BenchmarkRecorder::ReadJson(const char *path, BenchmarkSummary *dstSummaries) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // Only the layout written by WriteJson is understood, each metric is a flat object of numbers
+    // WriteJsonが書き込むレイアウトのみを解釈する、各メトリクスは数値のみのフラットなオブジェクト
+    for (UINT i = 0; i < BENCHMARK_METRIC_COUNT; ++i) {
+        dstSummaries[i] = BenchmarkSummary();
+
+        char key[64];
+        snprintf(key, sizeof(key), "\"%s\": {", METRIC_NAMES[i]);
+        const char *object = strstr(text.c_str(), key);
+        if (object == nullptr) {
+            continue;
+        }
+        const char *objectEnd = strchr(object, '}');
+        if (objectEnd == nullptr) {
+            continue;
+        }
+
+        double sampleCount = 0.0, mean = 0.0, p50 = 0.0, p90 = 0.0, p99 = 0.0, max = 0.0;
+        if (ReadJsonNumber(object, objectEnd, "samples", &sampleCount) && ReadJsonNumber(object, objectEnd, "mean", &mean) &&
+            ReadJsonNumber(object, objectEnd, "p50", &p50) && ReadJsonNumber(object, objectEnd, "p90", &p90) &&
+            ReadJsonNumber(object, objectEnd, "p99", &p99) && ReadJsonNumber(object, objectEnd, "max", &max)) {
+            dstSummaries[i].sampleCount = static_cast<UINT>(sampleCount);
+            dstSummaries[i].meanInMs    = static_cast<float>(mean);
+            dstSummaries[i].p50InMs     = static_cast<float>(p50);
+            dstSummaries[i].p90InMs     = static_cast<float>(p90);
+            dstSummaries[i].p99InMs     = static_cast<float>(p99);
+            dstSummaries[i].maxInMs     = static_cast<float>(max);
+        }
+    }
+    return true;
+}
+
+// Compare the distributions of a run with a baseline
+// 実行の分布をベースラインと比較
+UINT BenchmarkRecorder::Compare(const BenchmarkSummary *summaries, const BenchmarkSummary *baseline, float tolerance, std::string *dstReport) {
+    auto isRegressed = [tolerance](float time, float baselineTime) {
+        return baselineTime * (1.0f + tolerance) < time && DEFAULT_BENCHMARK_REGRESSION_FLOOR_IN_MS < time - baselineTime;
+    };
+
+    UINT regressionCount = 0;
+    dstReport->clear();
+    for (UINT i = 0; i < BENCHMARK_METRIC_COUNT; ++i) {
+        const auto &current  = summaries[i];
+        const auto &previous = baseline[i];
+        if (current.sampleCount == 0 || previous.sampleCount == 0) {
+            continue;
+        }
+
+        const bool regressed = isRegressed(current.p50InMs, previous.p50InMs) || isRegressed(current.p99InMs, previous.p99InMs);
+        if (regressed) {
+            regressionCount++;
+        }
+
+        char line[256];
+        snprintf(line, sizeof(line), "%-16s p50 %.3f -> %.3f ms (%+.1f%%), p99 %.3f -> %.3f ms (%+.1f%%)%s\n", METRIC_NAMES[i],
+            previous.p50InMs, current.p50InMs, (current.p50InMs / std::max(previous.p50InMs, FLT_EPSILON) - 1.0f) * 100.0f,
+            previous.p99InMs, current.p99InMs, (current.p99InMs / std::max(previous.p99InMs, FLT_EPSILON) - 1.0f) * 100.0f,
+            regressed ? " REGRESSED" : "");
+        *dstReport += line;
+    }
+    return regressionCount;
+}
+
+// Get the name of a metric
+// メトリクスの名前を取得
+const char* BenchmarkRecorder::GetMetricName(BenchmarkMetric metric) {
+    return METRIC_NAMES[static_cast<UINT>(metric)];
+}
@@ -0,0 +1,204 @@
+/// @file Benchmark.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+// Default value
+const UINT  DEFAULT_BENCHMARK_WARMUP_FRAMES         = 120;
+const UINT  DEFAULT_BENCHMARK_FRAME_COUNT           = 1000;
+const float DEFAULT_BENCHMARK_REGRESSION_TOLERANCE  = 0.05f;    // Relative growth of a percentile counted as a regression
+const float DEFAULT_BENCHMARK_REGRESSION_FLOOR_IN_MS = 0.01f;   // Smaller growths are noise whatever their ratio
+
+
+/// @~english
+/// @brief Time measured per frame by a benchmark run
+/// @~japanese
+/// @brief ベンチマーク実行でフレーム毎に計測する時間
+/// @~
+/// @enum BenchmarkMetric
+enum class BenchmarkMetric : UINT {
+    MainFrame,          ///< @~english Whole MainThread frame @~japanese MainThreadのフレーム全体
+    Update,             ///< @~english PreUpdate and Update @~japanese PreUpdateとUpdate
+    CommitSceneProxy,
+    Handoff,            ///< @~english From the MainThread releasing the proxies to the waiting RenderThread resuming @~japanese MainThreadがProxyを解放してから待機中のRenderThreadが再開するまで
+    RenderQueue,        ///< @~english Building and sorting the render queues, every view @~japanese 描画キューの構築とソート、全ビュー
+    InstancePacking,    ///< @~english Packing the visible world matrices into the instance constants, every view @~japanese 可視のWorld変換行列のインスタンス定数への詰め込み、全ビュー
+    RenderFrame,        ///< @~english Whole RenderThread frame @~japanese RenderThreadのフレーム全体
+    Count,
+};
+
+const UINT BENCHMARK_METRIC_COUNT = static_cast<UINT>(BenchmarkMetric::Count);
+
+
+/// @~english
+/// @brief Distribution of the samples of a metric
+/// @~japanese
+/// @brief メトリクスのサンプルの分布
+/// @~
+/// @struct BenchmarkSummary
+struct BenchmarkSummary {
+    UINT    sampleCount;
+    float   meanInMs;
+    float   p50InMs;
+    float   p90InMs;
+    float   p99InMs;
+    float   maxInMs;
+
+    /// @brief コンストラクタ
+    BenchmarkSummary()
+    : sampleCount(0)
+    , meanInMs(0.0f)
+    , p50InMs(0.0f)
+    , p90InMs(0.0f)
+    , p99InMs(0.0f)
+    , maxInMs(0.0f)
+    {
+        ;
+    }
+};
+
+
+/// @class BenchmarkRecorder
+/// @~english
+/// @brief Collects per-frame times of a benchmark run and writes their percentiles as JSON
+/// @details The run skips the warm-up frames and stops after a fixed number of MainThread frames. Every
+///          metric is written by one thread only, the samples are stored in arrays allocated by Init and
+///          published by the release of their count, so they can be summarized while the run goes on. A run is compared to a baseline written
+///          earlier by comparing the median and the 99th percentile of each metric.
+/// @~japanese
+/// @brief ベンチマーク実行のフレーム毎の時間を集め、そのパーセンタイルをJSONで書き込む
+/// @details 実行はウォームアップのフレームを飛ばし、MainThreadの一定のフレーム数の後に停止する。各メトリクスは
+///          1つのスレッドのみが書き込み、サンプルはInitで確保した配列に格納してその数のリリースで公開する為、
+///          実行中でも要約できる。実行は各メトリクスの中央値と99パーセンタイルを比べる事で以前に書き込んだベースラインと
+///          比較する
+class BenchmarkRecorder {
+public:
+    /// @~english
+    /// @brief Initialize and start the warm-up
+    /// @param[in] warmupFrames MainThread frames not recorded
+    /// @param[in] frameCount MainThread frames recorded
+    /// @~japanese
+    /// @brief 初期化しウォームアップを開始
+    /// @param[in] warmupFrames 記録しないMainThreadのフレーム数
+    /// @param[in] frameCount 記録するMainThreadのフレーム数
+    void Init(UINT warmupFrames, UINT frameCount);
+
+    /// @~english
+    /// @brief Add a sample while recording, only called by the thread owning the metric
+    /// @~japanese
+    /// @brief 記録中にサンプルを追加、メトリクスを持つスレッドのみが呼び出す
+    void AddSample(BenchmarkMetric metric, float timeInMs) {
+        const UINT index = static_cast<UINT>(metric);
+        const UINT count = sampleCounts[index].load(std::memory_order_relaxed);
+        if (recording.load(std::memory_order_relaxed) && count < samples[index].size()) {
+            samples[index][count] = timeInMs;
+            sampleCounts[index].store(count + 1, std::memory_order_release);
+        }
+    }
+
+    /// @~english
+    /// @brief Add the instances of a view while recording, those beyond the instance constants are counted as clamped
+    /// @param[in] visibleCount Visible instances of the view
+    /// @param[in] packedCount Instances packed into the constants of the view
+    /// @~japanese
+    /// @brief 記録中にビューのインスタンスを追加、インスタンス定数を超えたものは切り詰めとして数える
+    /// @param[in] visibleCount ビューの可視のインスタンス数
+    /// @param[in] packedCount ビューの定数へ詰めたインスタンス数
+    void AddInstancePacking(UINT visibleCount, UINT packedCount) {
+        if (!recording.load(std::memory_order_relaxed)) {
+            return;
+        }
+        packedInstanceCount.fetch_add(packedCount, std::memory_order_relaxed);
+        if (packedCount < visibleCount) {
+            clampedViewCount.fetch_add(1, std::memory_order_relaxed);
+            clampedInstanceCount.fetch_add(visibleCount - packedCount, std::memory_order_relaxed);
+        }
+    }
+
+    /// @~english
+    /// @brief End a MainThread frame
+    /// @param[in] frameTimeInMs Time of the frame, recorded as BenchmarkMetric::MainFrame
+    /// @return True on the frame completing the run, false otherwise
+    /// @~japanese
+    /// @brief MainThreadのフレームを終了
+    /// @param[in] frameTimeInMs フレームの時間、BenchmarkMetric::MainFrameとして記録する
+    /// @return 実行を完了したフレームの場合はTrue、そうでないならFalseを返す
+    bool EndFrame(float frameTimeInMs);
+
+    bool IsActive() const {
+        return !samples[0].empty();
+    }
+
+    /// @~english
+    /// @brief Get the distribution of the samples of a metric
+    /// @~japanese
+    /// @brief メトリクスのサンプルの分布を取得
+    BenchmarkSummary Summarize(BenchmarkMetric metric) const;
+
+    /// @~english
+    /// @brief Write the distributions of every metric as JSON
+    /// @param[in] path Path of the file
+    /// @param[in] label Description of the run, e.g. the scene
+    /// @return True if succeeded, false if the file can not be written
+    /// @~japanese
+    /// @brief 全メトリクスの分布をJSONで書き込む
+    /// @param[in] path ファイルのパス
+    /// @param[in] label 実行の説明、シーンなど
+    /// @return 成功した場合にはTrue、ファイルに書き込めない場合はFalseを返す
+    bool WriteJson(const char *path, const char *label) const;
+
+    /// @~english
+    /// @brief Read the distributions written by WriteJson
+    /// @param[in] path Path of the file
+    /// @param[out] dstSummaries BENCHMARK_METRIC_COUNT summaries, those missing in the file have no samples
+    /// @return True if succeeded, false if the file can not be read
+    /// @~japanese
+    /// @brief WriteJsonが書き込んだ分布を読み込む
+    /// @param[in] path ファイルのパス
+    /// @param[out] dstSummaries BENCHMARK_METRIC_COUNT個の要約、ファイルに無いものはサンプルを持たない
+    /// @return 成功した場合にはTrue、ファイルを読み込めない場合はFalseを返す
+    static bool ReadJson(const char *path, BenchmarkSummary *dstSummaries);
+
+    /// @~english
+    /// @brief Compare the distributions of a run with a baseline
+    /// @param[in] summaries BENCHMARK_METRIC_COUNT summaries of the run
+    /// @param[in] baseline BENCHMARK_METRIC_COUNT summaries of the baseline
+    /// @param[in] tolerance Relative growth of the median or the 99th percentile counted as a regression
+    /// @param[out] dstReport One line per metric present in both
+    /// @return Number of regressed metrics
+    /// @~japanese
+    /// @brief 実行の分布をベースラインと比較
+    /// @param[in] summaries 実行のBENCHMARK_METRIC_COUNT個の要約
+    /// @param[in] baseline ベースラインのBENCHMARK_METRIC_COUNT個の要約
+    /// @param[in] tolerance 退行とみなす中央値もしくは99パーセンタイルの相対的な増加
+    /// @param[out] dstReport 両方にあるメトリクス毎に1行
+    /// @return 退行したメトリクス数
+    static UINT Compare(const BenchmarkSummary *summaries, const BenchmarkSummary *baseline, float tolerance, std::string *dstReport);
+
+    /// @~english
+    /// @brief Get the name of a metric, used as its key in the JSON
+    /// @~japanese
+    /// @brief メトリクスの名前を取得、JSONのキーとして使用する
+    static const char* GetMetricName(BenchmarkMetric metric);
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    BenchmarkRecorder();
+
+private:
+    std::vector<float>  samples[BENCHMARK_METRIC_COUNT];
+    std::atomic<UINT>   sampleCounts[BENCHMARK_METRIC_COUNT];   ///< @~english Each written by the thread owning the metric @~japanese それぞれメトリクスを持つスレッドが書き込む
+    UINT                warmupFrames;
+    UINT                frameIndex;                             ///< @~english Only used by the MainThread @~japanese MainThreadのみが使用する
+    std::atomic<bool>   recording;
+
+    /// @~english
+    /// @brief Instances packed into the constants and those dropped beyond them, written as "instancePacking"
+    /// @~japanese
+    /// @brief 定数へ詰めたインスタンスとそれを超えて破棄したもの、"instancePacking"として書き込む
+    std::atomic<UINT>   packedInstanceCount;
+    std::atomic<UINT>   clampedInstanceCount;
+    std::atomic<UINT>   clampedViewCount;
+};
@@ -0,0 +1,716 @@
+/// @file BoundingVolumeHierarchy.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "BoundingVolumeHierarchy.h"
+#include "JobSystem.h"
+
+using namespace DirectX;
+
+namespace {
+// Surface area of a box
+// ボックスの表面積
+float SurfaceArea(FXMVECTOR boxMin, FXMVECTOR boxMax) {
+    XMFLOAT3 size;
+    XMStoreFloat3(&size, XMVectorMax(XMVectorSubtract(boxMax, boxMin), XMVectorZero()));
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+// Surface area of the union of two boxes
+// 2つのボックスの和の表面積
+float UnionSurfaceArea(FXMVECTOR minA, FXMVECTOR maxA, FXMVECTOR minB, GXMVECTOR maxB) {
+    return SurfaceArea(XMVectorMin(minA, minB), XMVectorMax(maxA, maxB));
+}
+} // namespace ""
+
+//----------------------------------------------------------------------------------------------------
+// BoundingVolumeHierarchy
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+BoundingVolumeHierarchy::BoundingVolumeHierarchy()
+: root(INVALID_BVH_NODE)
+, refitCount(0)
+, rebuilding(false)
+, buildNodeCount(0)
+, rebuildCount(0)
+, rebuildStepCount(0)
+, rebuildTimeInMs(0.0f)
+, lastRebuildStepCount(0)
+, lastRebuildTimeInMs(0.0f)
+{
+    proxies.reserve(DEFAULT_BVH_PROXY_CAPACITY);
+    nodes.reserve(DEFAULT_BVH_PROXY_CAPACITY * 2);
+}
+
+// Destructor
+// デストラクタ
+BoundingVolumeHierarchy::~BoundingVolumeHierarchy() {
+    ;
+}
+
+// Add a proxy
+// Proxyを追加
+UINT BoundingVolumeHierarchy::Insert(FXMVECTOR boxMin, FXMVECTOR boxMax, UINT userData) {
+    CancelRebuild();
+
+    UINT proxy = INVALID_BVH_PROXY;
+    if (!freeProxies.empty()) {
+        proxy = freeProxies.back();
+        freeProxies.pop_back();
+    } else {
+        proxy = static_cast<UINT>(proxies.size());
+        proxies.emplace_back();
+    }
+
+    const XMVECTOR margin = XMVectorReplicate(DEFAULT_BVH_FAT_MARGIN);
+    Proxy &record = proxies[proxy];
+    XMStoreFloat3(&record.boxMin, XMVectorSubtract(boxMin, margin));
+    XMStoreFloat3(&record.boxMax, XMVectorAdd(boxMax, margin));
+    record.userData = userData;
+
+    const UINT leaf = AllocateNode();
+    Node &node = nodes[leaf];
+    node.boxMin = record.boxMin;
+    node.boxMax = record.boxMax;
+    node.child0 = INVALID_BVH_NODE;
+    node.child1 = proxy;
+    node.height = 0;
+    record.node = leaf;
+
+    InsertLeaf(leaf);
+
+    return proxy;
+}
+
+// Remove a proxy
+// Proxyを削除
+void BoundingVolumeHierarchy::Remove(UINT proxy) {
+    assert(proxy < proxies.size() && proxies[proxy].node != INVALID_BVH_NODE);
+    CancelRebuild();
+
+    const UINT leaf = proxies[proxy].node;
+    RemoveLeaf(leaf);
+    FreeNode(leaf);
+
+    proxies[proxy].node = INVALID_BVH_NODE;
+    freeProxies.push_back(proxy);
+}
+
+// Update the bounds of a proxy
+// Proxyの境界を更新
+bool BoundingVolumeHierarchy::Move(UINT proxy, FXMVECTOR boxMin, FXMVECTOR boxMax) {
+    assert(proxy < proxies.size() && proxies[proxy].node != INVALID_BVH_NODE);
+
+    Proxy &record = proxies[proxy];
+    if (XMVector3LessOrEqual(XMLoadFloat3(&record.boxMin), boxMin) && XMVector3LessOrEqual(boxMax, XMLoadFloat3(&record.boxMax))) {
+        return false;
+    }
+
+    const XMVECTOR margin = XMVectorReplicate(DEFAULT_BVH_FAT_MARGIN);
+    XMStoreFloat3(&record.boxMin, XMVectorSubtract(boxMin, margin));
+    XMStoreFloat3(&record.boxMax, XMVectorAdd(boxMax, margin));
+
+    // Recompute the ancestors until one does not change
+    // 変化しなくなるまで祖先を再計算
+    UINT index = record.node;
+    nodes[index].boxMin = record.boxMin;
+    nodes[index].boxMax = record.boxMax;
+    for (index = nodes[index].parent; index != INVALID_BVH_NODE; index = nodes[index].parent) {
+        Node &node = nodes[index];
+        const Node &child0 = nodes[node.child0];
+        const Node &child1 = nodes[node.child1];
+
+        XMFLOAT3 newMin, newMax;
+        XMStoreFloat3(&newMin, XMVectorMin(XMLoadFloat3(&child0.boxMin), XMLoadFloat3(&child1.boxMin)));
+        XMStoreFloat3(&newMax, XMVectorMax(XMLoadFloat3(&child0.boxMax), XMLoadFloat3(&child1.boxMax)));
+        if (memcmp(&newMin, &node.boxMin, sizeof(newMin)) == 0 && memcmp(&newMax, &node.boxMax, sizeof(newMax)) == 0) {
+            break;
+        }
+        node.boxMin = newMin;
+        node.boxMax = newMax;
+    }
+    refitCount++;
+
+    return true;
+}
+
+// Remove all proxies
+// 全Proxyを削除
+void BoundingVolumeHierarchy::Clear() {
+    CancelRebuild();
+
+    nodes.clear();
+    freeNodes.clear();
+    proxies.clear();
+    freeProxies.clear();
+    root       = INVALID_BVH_NODE;
+    refitCount = 0;
+}
+
+// Get the statistics
+// 統計情報を取得
+BVHStats BoundingVolumeHierarchy::GetStats() const {
+    BVHStats stats;
+    stats.proxyCount       = static_cast<UINT>(proxies.size() - freeProxies.size());
+    stats.nodeCount        = static_cast<UINT>(nodes.size() - freeNodes.size());
+    stats.height           = (root != INVALID_BVH_NODE) ? static_cast<UINT>(nodes[root].height) : 0;
+    stats.refitCount       = refitCount;
+    stats.rebuildCount     = rebuildCount;
+    stats.rebuildStepCount = lastRebuildStepCount;
+    stats.rebuildTimeInMs  = lastRebuildTimeInMs;
+    return stats;
+}
+
+// Split a query against several views into independent subtrees
+// 複数ビューに対するクエリを独立した部分木に分割
+UINT BoundingVolumeHierarchy::SplitViewQuery(const ViewFrustum *frustums, UINT viewCount, UINT maxEntryCount, BVHViewQueryEntry *dstEntries) const {
+    if (root == INVALID_BVH_NODE || viewCount == 0 || maxEntryCount == 0) {
+        return 0;
+    }
+
+    ViewPlaneGroup groups[MAX_BVH_QUERY_VIEW_COUNT / 4];
+    LoadViewPlanes(frustums, viewCount, groups);
+
+    // An expanded node is replaced by its first child and its second child is appended,
+    // a culled one by the last entry. Passes repeat until the entries are leaves or full.
+    // 展開したノードは1つ目の子で置き換えて2つ目の子を末尾に追加し、カリングしたノードは末尾の要素で置き換える。
+    // 要素が全て葉になるか容量に達するまで繰り返す
+    UINT entryCount = 0;
+    dstEntries[entryCount++] = MakeRootViewQueryEntry(viewCount);
+
+    bool expanded = true;
+    while (expanded && entryCount < maxEntryCount) {
+        expanded = false;
+        for (UINT i = 0; i < entryCount && entryCount < maxEntryCount;) {
+            const BVHViewQueryEntry entry = dstEntries[i];
+            const Node &node = nodes[entry.node];
+            if (node.IsLeaf()) {
+                ++i;
+                continue;
+            }
+
+            UINT insideMask = entry.insideMask;
+            const UINT viewMask = TestNodeViews(node, groups, entry.viewMask, &insideMask);
+            expanded = true;
+            if (viewMask == 0) {
+                dstEntries[i] = dstEntries[--entryCount];
+                continue;
+            }
+
+            dstEntries[i]            = { node.child0, viewMask, insideMask };
+            dstEntries[entryCount++] = { node.child1, viewMask, insideMask };
+            ++i;
+        }
+    }
+
+    return entryCount;
+}
+
+// Allocate a node
+// ノードを確保
+UINT BoundingVolumeHierarchy::AllocateNode() {
+    if (!freeNodes.empty()) {
+        const UINT node = freeNodes.back();
+        freeNodes.pop_back();
+        return node;
+    }
+
+    nodes.emplace_back();
+    return static_cast<UINT>(nodes.size() - 1);
+}
+
+// Release a node
+// ノードを解放
+void BoundingVolumeHierarchy::FreeNode(UINT node) {
+    nodes[node].height = -1;
+    freeNodes.push_back(node);
+}
+
+// Insert a leaf next to the sibling with the smallest surface area increase
+// 表面積の増加が最小となる兄弟の隣へ葉を挿入
+void BoundingVolumeHierarchy::InsertLeaf(UINT leaf) {
+    if (root == INVALID_BVH_NODE) {
+        root = leaf;
+        nodes[leaf].parent = INVALID_BVH_NODE;
+        return;
+    }
+
+    const XMVECTOR leafMin = XMLoadFloat3(&nodes[leaf].boxMin);
+    const XMVECTOR leafMax = XMLoadFloat3(&nodes[leaf].boxMax);
+
+    // Descend while pushing the leaf further down is cheaper than pairing it here
+    // ここで組にするより更に下へ降ろす方が安い間は降りる
+    UINT index = root;
+    while (!nodes[index].IsLeaf()) {
+        const Node &node = nodes[index];
+        const XMVECTOR nodeMin = XMLoadFloat3(&node.boxMin);
+        const XMVECTOR nodeMax = XMLoadFloat3(&node.boxMax);
+
+        const float area         = SurfaceArea(nodeMin, nodeMax);
+        const float combinedArea = UnionSurfaceArea(nodeMin, nodeMax, leafMin, leafMax);
+        const float cost         = 2.0f * combinedArea;
+        const float inheritance  = 2.0f * (combinedArea - area);
+
+        float childCosts[2];
+        const UINT children[2] = { node.child0, node.child1 };
+        for (UINT i = 0; i < 2; ++i) {
+            const Node &child = nodes[children[i]];
+            const XMVECTOR childMin = XMLoadFloat3(&child.boxMin);
+            const XMVECTOR childMax = XMLoadFloat3(&child.boxMax);
+            childCosts[i] = UnionSurfaceArea(childMin, childMax, leafMin, leafMax) + inheritance;
+            if (!child.IsLeaf()) {
+                childCosts[i] -= SurfaceArea(childMin, childMax);
+            }
+        }
+
+        if (cost < childCosts[0] && cost < childCosts[1]) {
+            break;
+        }
+        index = (childCosts[0] < childCosts[1]) ? children[0] : children[1];
+    }
+
+    // Pair the leaf with the sibling under a new parent
+    // 新しい親の下で葉と兄弟を組にする
+    const UINT sibling   = index;
+    const UINT oldParent = nodes[sibling].parent;
+    const UINT newParent = AllocateNode();
+    {
+        Node &node = nodes[newParent];
+        XMStoreFloat3(&node.boxMin, XMVectorMin(leafMin, XMLoadFloat3(&nodes[sibling].boxMin)));
+        XMStoreFloat3(&node.boxMax, XMVectorMax(leafMax, XMLoadFloat3(&nodes[sibling].boxMax)));
+        node.parent = oldParent;
+        node.child0 = sibling;
+        node.child1 = leaf;
+        node.height = nodes[sibling].height + 1;
+    }
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent    = newParent;
+
+    if (oldParent != INVALID_BVH_NODE) {
+        Node &parent = nodes[oldParent];
+        if (parent.child0 == sibling) {
+            parent.child0 = newParent;
+        } else {
+            parent.child1 = newParent;
+        }
+    } else {
+        root = newParent;
+    }
+
+    // Rebalance and refit the ancestors
+    // 祖先を再平衡化しリフィット
+    for (index = nodes[leaf].parent; index != INVALID_BVH_NODE; index = nodes[index].parent) {
+        index = Balance(index);
+
+        Node &node = nodes[index];
+        const Node &child0 = nodes[node.child0];
+        const Node &child1 = nodes[node.child1];
+        node.height = 1 + std::max(child0.height, child1.height);
+        XMStoreFloat3(&node.boxMin, XMVectorMin(XMLoadFloat3(&child0.boxMin), XMLoadFloat3(&child1.boxMin)));
+        XMStoreFloat3(&node.boxMax, XMVectorMax(XMLoadFloat3(&child0.boxMax), XMLoadFloat3(&child1.boxMax)));
+    }
+}
+
+// Remove a leaf, its sibling takes the place of the parent
+// 葉を削除、兄弟が親の位置を引き継ぐ
+void BoundingVolumeHierarchy::RemoveLeaf(UINT leaf) {
+    if (leaf == root) {
+        root = INVALID_BVH_NODE;
+        return;
+    }
+
+    const UINT parent      = nodes[leaf].parent;
+    const UINT grandParent = nodes[parent].parent;
+    const UINT sibling     = (nodes[parent].child0 == leaf) ? nodes[parent].child1 : nodes[parent].child0;
+
+    if (grandParent == INVALID_BVH_NODE) {
+        root = sibling;
+        nodes[sibling].parent = INVALID_BVH_NODE;
+        FreeNode(parent);
+        return;
+    }
+
+    Node &grand = nodes[grandParent];
+    if (grand.child0 == parent) {
+        grand.child0 = sibling;
+    } else {
+        grand.child1 = sibling;
+    }
+    nodes[sibling].parent = grandParent;
+    FreeNode(parent);
+
+    for (UINT index = grandParent; index != INVALID_BVH_NODE; index = nodes[index].parent) {
+        index = Balance(index);
+
+        Node &node = nodes[index];
+        const Node &child0 = nodes[node.child0];
+        const Node &child1 = nodes[node.child1];
+        node.height = 1 + std::max(child0.height, child1.height);
+        XMStoreFloat3(&node.boxMin, XMVectorMin(XMLoadFloat3(&child0.boxMin), XMLoadFloat3(&child1.boxMin)));
+        XMStoreFloat3(&node.boxMax, XMVectorMax(XMLoadFloat3(&child0.boxMax), XMLoadFloat3(&child1.boxMax)));
+    }
+}
+
+// Rotate the taller grandchild up if the children differ in height by more than one
+// 子の高さが2以上異なる場合は高い方の孫を上へ回転
+UINT BoundingVolumeHierarchy::Balance(UINT indexA) {
+    Node &nodeA = nodes[indexA];
+    if (nodeA.IsLeaf() || nodeA.height < 2) {
+        return indexA;
+    }
+
+    auto fit = [this](UINT index) {
+        Node &node = nodes[index];
+        const Node &child0 = nodes[node.child0];
+        const Node &child1 = nodes[node.child1];
+        node.height = 1 + std::max(child0.height, child1.height);
+        XMStoreFloat3(&node.boxMin, XMVectorMin(XMLoadFloat3(&child0.boxMin), XMLoadFloat3(&child1.boxMin)));
+        XMStoreFloat3(&node.boxMax, XMVectorMax(XMLoadFloat3(&child0.boxMax), XMLoadFloat3(&child1.boxMax)));
+    };
+
+    // Rotate the child on side up, A keeps the other child and takes the shorter grandchild
+    // side側の子を上へ回転、Aはもう一方の子と低い方の孫を持つ
+    auto rotate = [&](UINT side) {
+        const UINT indexB = (side == 0) ? nodeA.child0 : nodeA.child1;
+        Node &nodeB = nodes[indexB];
+        const UINT indexF = nodeB.child0;
+        const UINT indexG = nodeB.child1;
+
+        nodeB.child0 = indexA;
+        nodeB.parent = nodeA.parent;
+        nodeA.parent = indexB;
+
+        if (nodeB.parent != INVALID_BVH_NODE) {
+            Node &parent = nodes[nodeB.parent];
+            if (parent.child0 == indexA) {
+                parent.child0 = indexB;
+            } else {
+                parent.child1 = indexB;
+            }
+        } else {
+            root = indexB;
+        }
+
+        const bool keepF = nodes[indexG].height < nodes[indexF].height;
+        const UINT taller  = keepF ? indexF : indexG;
+        const UINT shorter = keepF ? indexG : indexF;
+        nodeB.child1 = taller;
+        if (side == 0) {
+            nodeA.child0 = shorter;
+        } else {
+            nodeA.child1 = shorter;
+        }
+        nodes[shorter].parent = indexA;
+
+        fit(indexA);
+        fit(indexB);
+        return indexB;
+    };
+
+    const INT balance = nodes[nodeA.child1].height - nodes[nodeA.child0].height;
+    if (1 < balance) {
+        return rotate(1);
+    }
+    if (balance < -1) {
+        return rotate(0);
+    }
+    return indexA;
+}
+
+// Start rebuilding the tree from the current proxies
+// 現在のProxyからツリーの再構築を開始
+void BoundingVolumeHierarchy::BeginRebuild() {
+    CancelRebuild();
+
+    const UINT proxyCount = static_cast<UINT>(proxies.size() - freeProxies.size());
+    if (proxyCount == 0) {
+        return;
+    }
+
+    buildRefs.clear();
+    buildRefs.reserve(proxyCount);
+    for (UINT proxy = 0; proxy < static_cast<UINT>(proxies.size()); ++proxy) {
+        const Proxy &record = proxies[proxy];
+        if (record.node == INVALID_BVH_NODE) {
+            continue;
+        }
+
+        BuildRef ref;
+        XMStoreFloat3(&ref.center, XMVectorScale(XMVectorAdd(XMLoadFloat3(&record.boxMin), XMLoadFloat3(&record.boxMax)), 0.5f));
+        ref.proxy = proxy;
+        buildRefs.push_back(ref);
+    }
+
+    // A binary tree over n leaves has exactly 2n - 1 nodes, the root is node 0
+    // n個の葉を持つ二分木のノードは丁度2n - 1個、ルートはノード0
+    buildNodes.resize(static_cast<size_t>(proxyCount) * 2 - 1);
+    buildNodeCount.store(1);
+
+    BuildRange range;
+    range.begin  = 0;
+    range.end    = proxyCount;
+    range.node   = 0;
+    range.parent = INVALID_BVH_NODE;
+    pendingRanges.clear();
+    pendingRanges.push_back(range);
+
+    rebuilding       = true;
+    rebuildStepCount = 0;
+    rebuildTimeInMs  = 0.0f;
+}
+
+// Advance the pending rebuild
+// 実行中の再構築を進める
+bool BoundingVolumeHierarchy::StepRebuild(JobSystem *jobSystem, float budgetInMs) {
+    if (!rebuilding) {
+        return false;
+    }
+
+    auto beginTime = std::chrono::high_resolution_clock::now();
+    auto elapsedInMs = [beginTime] {
+        return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - beginTime).count();
+    };
+
+    // Ranges are taken in slices of a few per thread so the budget is checked between subtrees
+    // 予算を部分木の間で確認できるよう、範囲はスレッドあたり数個ずつ取り出す
+    const UINT threadCount = (jobSystem != nullptr) ? jobSystem->GetWorkerCount() + 1 : 1;
+    const UINT sliceSize   = threadCount * DEFAULT_BVH_BUILD_RANGES_PER_THREAD;
+
+    while (!pendingRanges.empty() && elapsedInMs() < budgetInMs) {
+        const UINT sliceCount = std::min(static_cast<UINT>(pendingRanges.size()), sliceSize);
+        const UINT sliceBegin = static_cast<UINT>(pendingRanges.size()) - sliceCount;
+        splitRanges.resize(static_cast<size_t>(sliceCount) * 2);
+
+        // Small ranges are finished by one task, large ones are split into two pending ranges
+        // 小さな範囲は1つのタスクで完成させ、大きな範囲は2つの実行待ちの範囲へ分割
+        auto func = [this, sliceBegin](UINT begin, UINT end) {
+            for (UINT i = begin; i < end; ++i) {
+                const BuildRange &range = pendingRanges[sliceBegin + i];
+                BuildRange *children = &splitRanges[static_cast<size_t>(i) * 2];
+                if (range.end - range.begin <= DEFAULT_BVH_BUILD_TASK_SIZE) {
+                    BuildSubtree(range);
+                    children[0].node = INVALID_BVH_NODE;
+                    children[1].node = INVALID_BVH_NODE;
+                    continue;
+                }
+
+                const UINT mid   = SplitBuildRange(range.begin, range.end);
+                const UINT child = buildNodeCount.fetch_add(2);
+
+                Node &node = buildNodes[range.node];
+                node.parent = range.parent;
+                node.child0 = child;
+                node.child1 = child + 1;
+
+                children[0] = { range.begin, mid, child, range.node };
+                children[1] = { mid, range.end, child + 1, range.node };
+            }
+        };
+        if (jobSystem != nullptr) {
+            jobSystem->ParallelFor(sliceCount, 1, func);
+        } else {
+            func(0, sliceCount);
+        }
+
+        pendingRanges.resize(sliceBegin);
+        for (const auto &range : splitRanges) {
+            if (range.node != INVALID_BVH_NODE) {
+                pendingRanges.push_back(range);
+            }
+        }
+    }
+
+    rebuildStepCount++;
+    rebuildTimeInMs += elapsedInMs();
+
+    if (!pendingRanges.empty()) {
+        return false;
+    }
+
+    FinishRebuild();
+    return true;
+}
+
+// Partition a range of BuildRefs with binned SAH
+// BuildRefの範囲をビン分割SAHで分割
+UINT BoundingVolumeHierarchy::SplitBuildRange(UINT begin, UINT end) {
+    const UINT count = end - begin;
+    const UINT mid   = begin + count / 2;
+
+    XMVECTOR centerMin = XMLoadFloat3(&buildRefs[begin].center);
+    XMVECTOR centerMax = centerMin;
+    for (UINT i = begin + 1; i < end; ++i) {
+        const XMVECTOR center = XMLoadFloat3(&buildRefs[i].center);
+        centerMin = XMVectorMin(centerMin, center);
+        centerMax = XMVectorMax(centerMax, center);
+    }
+
+    // Split the longest axis of the centers
+    // 中心の範囲が最も長い軸で分割
+    XMFLOAT3 extent;
+    XMStoreFloat3(&extent, XMVectorSubtract(centerMax, centerMin));
+    UINT axis = 0;
+    if (extent.y > (&extent.x)[axis]) {
+        axis = 1;
+    }
+    if (extent.z > (&extent.x)[axis]) {
+        axis = 2;
+    }
+    const float axisMin    = XMVectorGetByIndex(centerMin, axis);
+    const float axisExtent = (&extent.x)[axis];
+    if (axisExtent <= 0.0f) {
+        return mid;
+    }
+
+    // Bin the proxies by center and accumulate their boxes
+    // 中心でProxyをビンに振り分け、ボックスを集計
+    const UINT binCount = DEFAULT_BVH_BUILD_BIN_COUNT;
+    const float binScale = static_cast<float>(binCount) * (1.0f - 1.0e-5f) / axisExtent;
+    auto getBin = [&](const BuildRef &ref) {
+        return std::min(static_cast<UINT>(((&ref.center.x)[axis] - axisMin) * binScale), binCount - 1);
+    };
+
+    UINT     binCounts[binCount] = {};
+    XMVECTOR binMin[binCount];
+    XMVECTOR binMax[binCount];
+    for (UINT bin = 0; bin < binCount; ++bin) {
+        binMin[bin] = XMVectorReplicate(FLT_MAX);
+        binMax[bin] = XMVectorReplicate(-FLT_MAX);
+    }
+    for (UINT i = begin; i < end; ++i) {
+        const UINT bin = getBin(buildRefs[i]);
+        const Proxy &record = proxies[buildRefs[i].proxy];
+        binCounts[bin]++;
+        binMin[bin] = XMVectorMin(binMin[bin], XMLoadFloat3(&record.boxMin));
+        binMax[bin] = XMVectorMax(binMax[bin], XMLoadFloat3(&record.boxMax));
+    }
+
+    // Sweep from the right, then from the left evaluating count * area of both sides
+    // 右から走査した後、左から両側の要素数 * 面積を評価しながら走査
+    float rightCosts[binCount];
+    XMVECTOR sweepMin = XMVectorReplicate(FLT_MAX);
+    XMVECTOR sweepMax = XMVectorReplicate(-FLT_MAX);
+    UINT sweepCount = 0;
+    for (UINT bin = binCount - 1; 0 < bin; --bin) {
+        sweepMin = XMVectorMin(sweepMin, binMin[bin]);
+        sweepMax = XMVectorMax(sweepMax, binMax[bin]);
+        sweepCount += binCounts[bin];
+        rightCosts[bin] = (sweepCount != 0) ? SurfaceArea(sweepMin, sweepMax) * static_cast<float>(sweepCount) : 0.0f;
+    }
+
+    UINT  bestBin  = 0;
+    float bestCost = FLT_MAX;
+    sweepMin = XMVectorReplicate(FLT_MAX);
+    sweepMax = XMVectorReplicate(-FLT_MAX);
+    sweepCount = 0;
+    for (UINT bin = 1; bin < binCount; ++bin) {
+        sweepMin = XMVectorMin(sweepMin, binMin[bin - 1]);
+        sweepMax = XMVectorMax(sweepMax, binMax[bin - 1]);
+        sweepCount += binCounts[bin - 1];
+        if (sweepCount == 0 || sweepCount == count) {
+            continue;
+        }
+
+        const float cost = SurfaceArea(sweepMin, sweepMax) * static_cast<float>(sweepCount) + rightCosts[bin];
+        if (cost < bestCost) {
+            bestCost = cost;
+            bestBin  = bin;
+        }
+    }
+
+    // Fall back to the median when the split is too uneven, which bounds the depth of the tree
+    // 分割が偏り過ぎる場合は中央値へフォールバック、これによりツリーの深さが抑えられる
+    BuildRef *first = buildRefs.data() + begin;
+    BuildRef *last  = buildRefs.data() + end;
+    if (bestBin != 0) {
+        BuildRef *split = std::partition(first, last, [&](const BuildRef &ref) {
+            return getBin(ref) < bestBin;
+        });
+        const UINT splitIndex = static_cast<UINT>(split - buildRefs.data());
+        const UINT minCount   = count / 8;
+        if (minCount <= splitIndex - begin && minCount <= end - splitIndex) {
+            return splitIndex;
+        }
+    }
+
+    std::nth_element(first, buildRefs.data() + mid, last, [axis](const BuildRef &a, const BuildRef &b) {
+        return (&a.center.x)[axis] < (&b.center.x)[axis];
+    });
+    return mid;
+}
+
+// Build a whole subtree of a range on the calling thread
+// 範囲の部分木全体を呼び出し元スレッドで構築
+void BoundingVolumeHierarchy::BuildSubtree(const BuildRange &range) {
+    // The median fallback keeps the depth below log(8/7) of the count, well within the stack
+    // 中央値へのフォールバックにより深さは要素数のlog(8/7)未満に収まり、スタックに十分収まる
+    BuildRange stack[MAX_BVH_TRAVERSAL_DEPTH];
+    UINT stackSize = 0;
+    stack[stackSize++] = range;
+
+    while (stackSize != 0) {
+        const BuildRange current = stack[--stackSize];
+        Node &node = buildNodes[current.node];
+        node.parent = current.parent;
+
+        if (current.end - current.begin == 1) {
+            node.child0 = INVALID_BVH_NODE;
+            node.child1 = buildRefs[current.begin].proxy;
+            continue;
+        }
+
+        const UINT mid   = SplitBuildRange(current.begin, current.end);
+        const UINT child = buildNodeCount.fetch_add(2);
+        node.child0 = child;
+        node.child1 = child + 1;
+
+        assert(stackSize + 2 <= MAX_BVH_TRAVERSAL_DEPTH);
+        stack[stackSize++] = { mid, current.end, child + 1, current.node };
+        stack[stackSize++] = { current.begin, mid, child, current.node };
+    }
+}
+
+// Replace the tree with the completed rebuild
+// 完了した再構築でツリーを置き換え
+void BoundingVolumeHierarchy::FinishRebuild() {
+    assert(buildNodeCount.load() == buildNodes.size());
+
+    nodes.swap(buildNodes);
+    freeNodes.clear();
+    root = 0;
+
+    // Children are allocated after their parent, so a reverse walk fits the boxes bottom up.
+    // Proxies moved during the rebuild are picked up here.
+    // 子は親の後に確保される為、逆順に辿るとボックスを下から合わせられる
+    // 再構築中に移動したProxyはここで反映される
+    for (UINT index = static_cast<UINT>(nodes.size()); 0 < index--;) {
+        Node &node = nodes[index];
+        if (node.IsLeaf()) {
+            Proxy &record = proxies[node.child1];
+            record.node = index;
+            node.boxMin = record.boxMin;
+            node.boxMax = record.boxMax;
+            node.height = 0;
+        } else {
+            const Node &child0 = nodes[node.child0];
+            const Node &child1 = nodes[node.child1];
+            node.height = 1 + std::max(child0.height, child1.height);
+            XMStoreFloat3(&node.boxMin, XMVectorMin(XMLoadFloat3(&child0.boxMin), XMLoadFloat3(&child1.boxMin)));
+            XMStoreFloat3(&node.boxMax, XMVectorMax(XMLoadFloat3(&child0.boxMax), XMLoadFloat3(&child1.boxMax)));
+        }
+    }
+
+    rebuilding           = false;
+    refitCount           = 0;
+    lastRebuildStepCount = rebuildStepCount;
+    lastRebuildTimeInMs  = rebuildTimeInMs;
+    rebuildCount++;
+}
+
+// Discard the pending rebuild
+// 実行中の再構築を破棄
+void BoundingVolumeHierarchy::CancelRebuild() {
+    rebuilding = false;
+    pendingRanges.clear();
+}
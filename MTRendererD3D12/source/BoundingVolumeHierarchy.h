@@ -0,0 +1,627 @@
+/// @file BoundingVolumeHierarchy.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+#include "ViewFrustum.h"
+
+class JobSystem;
+
+// Default value
+const UINT INVALID_BVH_PROXY                    = ~0u;
+const UINT INVALID_BVH_NODE                     = ~0u;
+const UINT DEFAULT_BVH_PROXY_CAPACITY           = 1024;
+const float DEFAULT_BVH_FAT_MARGIN              = 0.1f;
+const UINT DEFAULT_BVH_BUILD_TASK_SIZE          = 1024;
+const UINT DEFAULT_BVH_BUILD_BIN_COUNT          = 16;
+const UINT DEFAULT_BVH_BUILD_RANGES_PER_THREAD  = 2;
+const float DEFAULT_BVH_REBUILD_BUDGET_IN_MS    = 1.0f;
+const float DEFAULT_BVH_REBUILD_REFIT_RATIO     = 0.5f;
+const UINT MAX_BVH_TRAVERSAL_DEPTH              = 256;
+const UINT MAX_BVH_QUERY_VIEW_COUNT             = 8;
+
+static_assert((MAX_BVH_QUERY_VIEW_COUNT % 4) == 0, "The views are tested four at a time with SSE.");
+
+
+/// @~english
+/// @brief Statistics of the bounding volume hierarchy
+/// @~japanese
+/// @brief 境界ボリューム階層の統計情報
+/// @~
+/// @struct BVHStats
+struct BVHStats {
+    UINT    proxyCount;
+    UINT    nodeCount;
+    UINT    height;
+    UINT    refitCount;         ///< @~english Refits since the last rebuild @~japanese 直前の再構築以降のリフィット数
+    UINT    rebuildCount;
+    UINT    rebuildStepCount;   ///< @~english Steps taken by the last rebuild @~japanese 直前の再構築に掛かったステップ数
+    float   rebuildTimeInMs;    ///< @~english Total time of the last rebuild @~japanese 直前の再構築の合計時間
+
+    /// @brief コンストラクタ
+    BVHStats()
+    : proxyCount(0)
+    , nodeCount(0)
+    , height(0)
+    , refitCount(0)
+    , rebuildCount(0)
+    , rebuildStepCount(0)
+    , rebuildTimeInMs(0.0f)
+    {
+        ;
+    }
+};
+
+
+/// @~english
+/// @brief Subtree of a query against several views, with the views and planes still to be tested
+/// @~japanese
+/// @brief 複数ビューに対するクエリの部分木、まだテストが必要なビューと平面を持つ
+/// @~
+/// @struct BVHViewQueryEntry
+struct BVHViewQueryEntry {
+    UINT    node;
+    UINT    viewMask;       ///< @~english Views the subtree may be visible in @~japanese 部分木が可視の可能性があるビュー
+    UINT    insideMask;     ///< @~english Views fully containing the subtree @~japanese 部分木を完全に含むビュー
+};
+
+
+/// @class BoundingVolumeHierarchy
+/// @~english
+/// @brief Dynamic AABB tree over the bounds of the scene proxies
+/// @details Leaves hold boxes enlarged by a margin, so small motions do not touch the tree. A leaf leaving its
+///          box is refitted in place and its ancestors are recomputed up to the first unchanged one.
+///          Inserts pick the sibling with the smallest surface area increase and rotations keep the tree
+///          balanced. Refits degrade the tree over time, so a binned SAH rebuild can be run in time
+///          slices on the JobSystem and swapped in when complete; queries keep using the current tree
+///          meanwhile. Queries are const and may run concurrently with each other.
+/// @~japanese
+/// @brief シーンProxyの境界に対する動的AABBツリー
+/// @details 葉はマージン分拡大したボックスを持ち、小さな移動ではツリーに触れない。ボックスから外れた葉は
+///          その場でリフィットし、祖先は変化しなくなるまで再計算する。挿入は表面積の増加が最小となる兄弟を
+///          選び、回転でツリーの平衡を保つ。リフィットでツリーの品質は徐々に劣化する為、ビン分割SAHによる
+///          再構築をJobSystem上で時分割に実行し、完了時に差し替える。その間クエリは現在のツリーを使い続ける。
+///          クエリはconstであり、互いに並行して実行できる
+class BoundingVolumeHierarchy {
+public:
+    /// @~english
+    /// @brief Add a proxy, cancels a pending rebuild
+    /// @param[in] boxMin Minimum corner
+    /// @param[in] boxMax Maximum corner
+    /// @param[in] userData Value passed to the query callbacks
+    /// @return Proxy id
+    /// @~japanese
+    /// @brief Proxyを追加、実行中の再構築は中止される
+    /// @param[in] boxMin 最小座標
+    /// @param[in] boxMax 最大座標
+    /// @param[in] userData クエリのコールバックへ渡す値
+    /// @return Proxy ID
+    UINT Insert(DirectX::FXMVECTOR boxMin, DirectX::FXMVECTOR boxMax, UINT userData);
+
+    /// @~english
+    /// @brief Remove a proxy, cancels a pending rebuild
+    /// @~japanese
+    /// @brief Proxyを削除、実行中の再構築は中止される
+    void Remove(UINT proxy);
+
+    /// @~english
+    /// @brief Update the bounds of a proxy
+    /// @return True if the leaf was refitted, false if the bounds are still inside its enlarged box
+    /// @~japanese
+    /// @brief Proxyの境界を更新
+    /// @return 葉をリフィットした場合はTrue、境界が拡大したボックス内に収まっている場合はFalseを返す
+    bool Move(UINT proxy, DirectX::FXMVECTOR boxMin, DirectX::FXMVECTOR boxMax);
+
+    /// @~english
+    /// @brief Start rebuilding the tree from the current proxies
+    /// @~japanese
+    /// @brief 現在のProxyからツリーの再構築を開始
+    void BeginRebuild();
+
+    /// @~english
+    /// @brief Advance the pending rebuild
+    /// @details Pending ranges are taken a few per thread and distributed over the JobSystem. Large ranges
+    ///          are split in two and pushed back, ranges up to DEFAULT_BVH_BUILD_TASK_SIZE are built completely
+    ///          by one task. Slices stop once the budget is spent, so the last one may run past it.
+    /// @param[in] jobSystem Job system to distribute the ranges to (nullptr to run on the calling thread
+    /// @param[in] budgetInMs Time budget of this step
+    /// @return True if the rebuild completed and the new tree is in use
+    /// @~japanese
+    /// @brief 実行中の再構築を進める
+    /// @details 実行待ちの範囲をスレッドあたり数個ずつ取り出し、JobSystemへ分散する。大きな範囲は2つに分割して
+    ///          戻し、DEFAULT_BVH_BUILD_TASK_SIZE以下の範囲は1つのタスクで全て構築する。予算を使い切ると取り出しを
+    ///          止める為、最後の1回分超過する事がある
+    /// @param[in] jobSystem 範囲を分散するJobSystem（nullptrの場合は呼び出し元スレッドで実行
+    /// @param[in] budgetInMs このステップの時間予算
+    /// @return 再構築が完了し新しいツリーが使用されている場合はTrue
+    bool StepRebuild(JobSystem *jobSystem, float budgetInMs);
+
+    /// @~english
+    /// @brief Test if a rebuild is pending
+    /// @~japanese
+    /// @brief 再構築が実行中か調べる
+    bool IsRebuilding() const {
+        return rebuilding;
+    }
+
+    /// @~english
+    /// @brief Call func(userData) for each proxy whose box is at least partially inside the frustum
+    /// @details Planes fully containing a node are not tested again for its descendants.
+    /// @~japanese
+    /// @brief ボックスが視錐台内に含まれるProxy毎にfunc(userData)を呼び出す
+    /// @details ノードを完全に含む平面はその子孫に対して再びテストしない
+    template<typename Func>
+    void QueryFrustum(const ViewFrustum &frustum, Func func) const {
+        if (root == INVALID_BVH_NODE) {
+            return;
+        }
+
+        const UINT planeCount = static_cast<UINT>(FrustumPlane::Count);
+        DirectX::XMVECTOR planes[planeCount];
+        DirectX::XMVECTOR absPlanes[planeCount];
+        for (UINT i = 0; i < planeCount; ++i) {
+            planes[i]    = frustum.GetPlane(static_cast<FrustumPlane>(i));
+            absPlanes[i] = DirectX::XMVectorAbs(planes[i]);
+        }
+
+        struct StackEntry {
+            UINT    node;
+            UINT    planeMask;
+        };
+        StackEntry stack[MAX_BVH_TRAVERSAL_DEPTH];
+        UINT stackSize = 0;
+        stack[stackSize++] = { root, (1u << planeCount) - 1u };
+
+        while (stackSize != 0) {
+            const StackEntry entry = stack[--stackSize];
+            const Node &node = nodes[entry.node];
+
+            UINT planeMask = entry.planeMask;
+            if (planeMask != 0) {
+                const DirectX::XMVECTOR boxMin  = DirectX::XMLoadFloat3(&node.boxMin);
+                const DirectX::XMVECTOR boxMax  = DirectX::XMLoadFloat3(&node.boxMax);
+                const DirectX::XMVECTOR center  = DirectX::XMVectorSetW(DirectX::XMVectorScale(DirectX::XMVectorAdd(boxMin, boxMax), 0.5f), 1.0f);
+                const DirectX::XMVECTOR extents = DirectX::XMVectorScale(DirectX::XMVectorSubtract(boxMax, boxMin), 0.5f);
+
+                bool outside = false;
+                for (UINT i = 0; i < planeCount; ++i) {
+                    if ((planeMask & (1u << i)) == 0) {
+                        continue;
+                    }
+                    const float dist   = DirectX::XMVectorGetX(DirectX::XMVector4Dot(planes[i], center));
+                    const float radius = DirectX::XMVectorGetX(DirectX::XMVector3Dot(absPlanes[i], extents));
+                    if (dist < -radius) {
+                        outside = true;
+                        break;
+                    }
+                    if (radius <= dist) {
+                        planeMask &= ~(1u << i);
+                    }
+                }
+                if (outside) {
+                    continue;
+                }
+            }
+
+            if (node.IsLeaf()) {
+                func(proxies[node.child1].userData);
+            } else {
+                assert(stackSize + 2 <= MAX_BVH_TRAVERSAL_DEPTH);
+                stack[stackSize++] = { node.child1, planeMask };
+                stack[stackSize++] = { node.child0, planeMask };
+            }
+        }
+    }
+
+    /// @~english
+    /// @brief Call func(userData, viewMask) for each proxy whose box is at least partially inside some of the frustums
+    /// @details The tree is walked once for all views. The bounds of a node are loaded once and tested against
+    ///          four views at a time with SSE, and views fully containing it are not tested again for its
+    ///          descendants, so the cost grows slower than the number of views.
+    /// @param[in] frustums Frustums of the views, up to MAX_BVH_QUERY_VIEW_COUNT
+    /// @param[in] viewCount Number of views
+    /// @param[in] entry Subtree to query, from SplitViewQuery
+    /// @param[in] func Called with the bit of each view the proxy is visible in
+    /// @~japanese
+    /// @brief ボックスがいずれかの視錐台内に含まれるProxy毎にfunc(userData, viewMask)を呼び出す
+    /// @details ツリーは全ビューに対して1回だけ走査する。ノードの境界は1回だけ読み込み、SSEで4ビューずつ
+    ///          テストする。ノードを完全に含むビューはその子孫に対して再びテストしない為、コストはビュー数ほどには
+    ///          増えない
+    /// @param[in] frustums ビューの視錐台、MAX_BVH_QUERY_VIEW_COUNT個まで
+    /// @param[in] viewCount ビュー数
+    /// @param[in] entry クエリする部分木、SplitViewQueryで得る
+    /// @param[in] func Proxyが可視であるビューのビットを渡して呼ばれる
+    template<typename Func>
+    void QueryFrustums(const ViewFrustum *frustums, UINT viewCount, const BVHViewQueryEntry &entry, Func func) const {
+        ViewPlaneGroup groups[MAX_BVH_QUERY_VIEW_COUNT / 4];
+        LoadViewPlanes(frustums, viewCount, groups);
+
+        BVHViewQueryEntry stack[MAX_BVH_TRAVERSAL_DEPTH];
+        UINT stackSize = 0;
+        stack[stackSize++] = entry;
+
+        while (stackSize != 0) {
+            const BVHViewQueryEntry current = stack[--stackSize];
+            const Node &node = nodes[current.node];
+
+            UINT insideMask = current.insideMask;
+            const UINT viewMask = TestNodeViews(node, groups, current.viewMask, &insideMask);
+            if (viewMask == 0) {
+                continue;
+            }
+
+            if (node.IsLeaf()) {
+                func(proxies[node.child1].userData, viewMask);
+            } else {
+                assert(stackSize + 2 <= MAX_BVH_TRAVERSAL_DEPTH);
+                stack[stackSize++] = { node.child1, viewMask, insideMask };
+                stack[stackSize++] = { node.child0, viewMask, insideMask };
+            }
+        }
+    }
+
+    /// @~english
+    /// @brief Call func(userData, viewMask) for each proxy whose box is at least partially inside some of the frustums
+    /// @~japanese
+    /// @brief ボックスがいずれかの視錐台内に含まれるProxy毎にfunc(userData, viewMask)を呼び出す
+    template<typename Func>
+    void QueryFrustums(const ViewFrustum *frustums, UINT viewCount, Func func) const {
+        if (root != INVALID_BVH_NODE && viewCount != 0) {
+            QueryFrustums(frustums, viewCount, MakeRootViewQueryEntry(viewCount), func);
+        }
+    }
+
+    /// @~english
+    /// @brief Split a query against several views into independent subtrees, to run them in parallel
+    /// @details The top of the tree is expanded breadth first and culled on the way, so the subtrees only
+    ///          test what is left. Leaves reached before enough subtrees are found are returned as they are.
+    /// @param[in] frustums Frustums of the views, up to MAX_BVH_QUERY_VIEW_COUNT
+    /// @param[in] viewCount Number of views
+    /// @param[in] maxEntryCount Capacity of dstEntries
+    /// @param[out] dstEntries Subtrees to pass to QueryFrustums
+    /// @return Number of subtrees, 0 if nothing is visible
+    /// @~japanese
+    /// @brief 複数ビューに対するクエリを、並列に実行する為独立した部分木に分割
+    /// @details ツリーの上部を幅優先で展開しながらカリングする為、部分木は残りのテストのみ行う。十分な数の
+    ///          部分木が見つかる前に到達した葉はそのまま返す
+    /// @param[in] frustums ビューの視錐台、MAX_BVH_QUERY_VIEW_COUNT個まで
+    /// @param[in] viewCount ビュー数
+    /// @param[in] maxEntryCount dstEntriesの容量
+    /// @param[out] dstEntries QueryFrustumsへ渡す部分木
+    /// @return 部分木の数、何も可視でない場合は0
+    UINT SplitViewQuery(const ViewFrustum *frustums, UINT viewCount, UINT maxEntryCount, BVHViewQueryEntry *dstEntries) const;
+
+    /// @~english
+    /// @brief Call func(userData) for each proxy whose box overlaps the sphere
+    /// @~japanese
+    /// @brief ボックスが球と重なるProxy毎にfunc(userData)を呼び出す
+    template<typename Func>
+    void QuerySphere(DirectX::FXMVECTOR center, float radius, Func func) const {
+        const DirectX::XMVECTOR radiusSq = DirectX::XMVectorReplicate(radius * radius);
+        Traverse([&](const Node &node) {
+            // Distance from the center to the box
+            // 中心からボックスまでの距離
+            const DirectX::XMVECTOR below = DirectX::XMVectorMax(DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&node.boxMin), center), DirectX::XMVectorZero());
+            const DirectX::XMVECTOR above = DirectX::XMVectorMax(DirectX::XMVectorSubtract(center, DirectX::XMLoadFloat3(&node.boxMax)), DirectX::XMVectorZero());
+            return DirectX::XMVector3LessOrEqual(DirectX::XMVector3LengthSq(DirectX::XMVectorAdd(below, above)), radiusSq);
+        }, func);
+    }
+
+    /// @~english
+    /// @brief Call func(userData) for each proxy whose box overlaps the box
+    /// @~japanese
+    /// @brief ボックスが指定したボックスと重なるProxy毎にfunc(userData)を呼び出す
+    template<typename Func>
+    void QueryBox(DirectX::FXMVECTOR boxMin, DirectX::FXMVECTOR boxMax, Func func) const {
+        Traverse([&](const Node &node) {
+            return DirectX::XMVector3LessOrEqual(DirectX::XMLoadFloat3(&node.boxMin), boxMax)
+                && DirectX::XMVector3LessOrEqual(boxMin, DirectX::XMLoadFloat3(&node.boxMax));
+        }, func);
+    }
+
+    /// @~english
+    /// @brief Call func(userData, maxDistance) for each proxy whose box is hit by the ray
+    /// @details func returns the new max distance, so returning the hit distance clips the rest of the
+    ///          traversal to closer proxies and returning 0 ends the query.
+    /// @param[in] origin Ray origin
+    /// @param[in] direction Ray direction, the distances are in units of its length
+    /// @param[in] maxDistance Initial max distance
+    /// @~japanese
+    /// @brief ボックスがレイと交差するProxy毎にfunc(userData, maxDistance)を呼び出す
+    /// @details funcは新しい最大距離を返す。交差距離を返すと以降の走査はより近いProxyに限られ、0を返すと
+    ///          クエリを終了する
+    /// @param[in] origin レイの始点
+    /// @param[in] direction レイの方向、距離はその長さを単位とする
+    /// @param[in] maxDistance 最大距離の初期値
+    template<typename Func>
+    void QueryRay(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float maxDistance, Func func) const {
+        // Axes parallel to the ray give infinite slabs, which the min/max below handle
+        // レイと平行な軸は無限大のスラブとなるが、下記のmin/maxで扱える
+        const DirectX::XMVECTOR invDirection = DirectX::XMVectorReciprocal(direction);
+        Traverse([&](const Node &node) {
+            const DirectX::XMVECTOR t0 = DirectX::XMVectorMultiply(DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&node.boxMin), origin), invDirection);
+            const DirectX::XMVECTOR t1 = DirectX::XMVectorMultiply(DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&node.boxMax), origin), invDirection);
+            DirectX::XMFLOAT3 tNear, tFar;
+            DirectX::XMStoreFloat3(&tNear, DirectX::XMVectorMin(t0, t1));
+            DirectX::XMStoreFloat3(&tFar,  DirectX::XMVectorMax(t0, t1));
+            const float enter = std::max({ tNear.x, tNear.y, tNear.z, 0.0f });
+            const float exit  = std::min({ tFar.x, tFar.y, tFar.z, maxDistance });
+            return enter <= exit;
+        }, [&](UINT userData) {
+            maxDistance = func(userData, maxDistance);
+            return 0.0f < maxDistance;
+        });
+    }
+
+    /// @~english
+    /// @brief Get the enlarged box of a proxy
+    /// @~japanese
+    /// @brief Proxyの拡大したボックスを取得
+    void GetFatBox(UINT proxy, DirectX::XMVECTOR *dstBoxMin, DirectX::XMVECTOR *dstBoxMax) const {
+        *dstBoxMin = DirectX::XMLoadFloat3(&proxies[proxy].boxMin);
+        *dstBoxMax = DirectX::XMLoadFloat3(&proxies[proxy].boxMax);
+    }
+
+    /// @~english
+    /// @brief Get the user data of a proxy
+    /// @~japanese
+    /// @brief Proxyのユーザーデータを取得
+    UINT GetUserData(UINT proxy) const {
+        return proxies[proxy].userData;
+    }
+
+    /// @~english
+    /// @brief Get the statistics
+    /// @~japanese
+    /// @brief 統計情報を取得
+    BVHStats GetStats() const;
+
+    /// @~english
+    /// @brief Remove all proxies
+    /// @~japanese
+    /// @brief 全Proxyを削除
+    void Clear();
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    BoundingVolumeHierarchy();
+
+    /// @~english
+    /// @brief Destructor
+    /// @~japanese
+    /// @brief デストラクタ
+    ~BoundingVolumeHierarchy();
+
+private:
+    /// @~english
+    /// @brief Node of the tree
+    /// @~japanese
+    /// @brief ツリーのノード
+    /// @~
+    /// @struct Node
+    struct Node {
+        DirectX::XMFLOAT3   boxMin;
+        UINT                parent;
+        DirectX::XMFLOAT3   boxMax;
+        UINT                child0;     ///< @~english INVALID_BVH_NODE for leaves @~japanese 葉の場合はINVALID_BVH_NODE
+        UINT                child1;     ///< @~english Proxy id for leaves @~japanese 葉の場合はProxy ID
+        INT                 height;     ///< @~english 0 for leaves, -1 when free @~japanese 葉の場合は0、未使用の場合は-1
+
+        bool IsLeaf() const {
+            return child0 == INVALID_BVH_NODE;
+        }
+    };
+
+    /// @~english
+    /// @brief Proxy record
+    /// @~japanese
+    /// @brief Proxyの記録
+    /// @~
+    /// @struct Proxy
+    struct Proxy {
+        DirectX::XMFLOAT3   boxMin;     ///< @~english Enlarged by the margin @~japanese マージン分拡大済み
+        UINT                node;       ///< @~english Leaf node, INVALID_BVH_NODE when free @~japanese 葉のノード、未使用の場合はINVALID_BVH_NODE
+        DirectX::XMFLOAT3   boxMax;     ///< @~english Enlarged by the margin @~japanese マージン分拡大済み
+        UINT                userData;
+    };
+
+    /// @~english
+    /// @brief Proxy referenced by the rebuild
+    /// @~japanese
+    /// @brief 再構築が参照するProxy
+    /// @~
+    /// @struct BuildRef
+    struct BuildRef {
+        DirectX::XMFLOAT3   center;
+        UINT                proxy;
+    };
+
+    /// @~english
+    /// @brief Range of BuildRefs to turn into a subtree
+    /// @~japanese
+    /// @brief 部分木へ変換するBuildRefの範囲
+    /// @~
+    /// @struct BuildRange
+    struct BuildRange {
+        UINT    begin;
+        UINT    end;
+        UINT    node;
+        UINT    parent;
+    };
+
+    /// @~english
+    /// @brief Depth first traversal, overlap(node) culls subtrees and func(userData) returns false to stop
+    /// @~japanese
+    /// @brief 深さ優先の走査、overlap(node)で部分木を除外し、func(userData)がFalseを返すと終了する
+    template<typename OverlapFunc, typename Func>
+    void Traverse(OverlapFunc overlap, Func func) const {
+        if (root == INVALID_BVH_NODE) {
+            return;
+        }
+
+        UINT stack[MAX_BVH_TRAVERSAL_DEPTH];
+        UINT stackSize = 0;
+        stack[stackSize++] = root;
+
+        while (stackSize != 0) {
+            const Node &node = nodes[stack[--stackSize]];
+            if (!overlap(node)) {
+                continue;
+            }
+
+            if (node.IsLeaf()) {
+                if constexpr (std::is_same_v<decltype(func(0u)), bool>) {
+                    if (!func(proxies[node.child1].userData)) {
+                        return;
+                    }
+                } else {
+                    func(proxies[node.child1].userData);
+                }
+            } else {
+                assert(stackSize + 2 <= MAX_BVH_TRAVERSAL_DEPTH);
+                stack[stackSize++] = node.child1;
+                stack[stackSize++] = node.child0;
+            }
+        }
+    }
+
+    /// @~english
+    /// @brief Frustum planes of four views, one lane per view
+    /// @~japanese
+    /// @brief 4ビュー分の視錐台平面、ビュー毎に1レーン
+    /// @~
+    /// @struct ViewPlaneGroup
+    struct ViewPlaneGroup {
+        __m128  normalX[static_cast<UINT>(FrustumPlane::Count)];
+        __m128  normalY[static_cast<UINT>(FrustumPlane::Count)];
+        __m128  normalZ[static_cast<UINT>(FrustumPlane::Count)];
+        __m128  distance[static_cast<UINT>(FrustumPlane::Count)];
+        __m128  absNormalX[static_cast<UINT>(FrustumPlane::Count)];
+        __m128  absNormalY[static_cast<UINT>(FrustumPlane::Count)];
+        __m128  absNormalZ[static_cast<UINT>(FrustumPlane::Count)];
+    };
+
+    /// @~english
+    /// @brief Query entry covering the whole tree for every view
+    /// @~japanese
+    /// @brief 全ビューに対してツリー全体を対象とするクエリの要素
+    BVHViewQueryEntry MakeRootViewQueryEntry(UINT viewCount) const {
+        return { root, (1u << viewCount) - 1u, 0u };
+    }
+
+    /// @~english
+    /// @brief Transpose the planes of the views into groups of four, the unused lanes contain everything
+    /// @~japanese
+    /// @brief ビューの平面を4つずつのグループへ転置、未使用のレーンは全てを含む
+    static void LoadViewPlanes(const ViewFrustum *frustums, UINT viewCount, ViewPlaneGroup *dstGroups) {
+        assert(viewCount <= MAX_BVH_QUERY_VIEW_COUNT);
+        const UINT planeCount = static_cast<UINT>(FrustumPlane::Count);
+        for (UINT group = 0; group * 4 < viewCount; ++group) {
+            for (UINT i = 0; i < planeCount; ++i) {
+                DirectX::XMFLOAT4 lanes[4] = {};
+                for (UINT lane = 0; lane < 4 && group * 4 + lane < viewCount; ++lane) {
+                    DirectX::XMStoreFloat4(&lanes[lane], frustums[group * 4 + lane].GetPlane(static_cast<FrustumPlane>(i)));
+                }
+                ViewPlaneGroup &dst = dstGroups[group];
+                dst.normalX[i]    = _mm_setr_ps(lanes[0].x, lanes[1].x, lanes[2].x, lanes[3].x);
+                dst.normalY[i]    = _mm_setr_ps(lanes[0].y, lanes[1].y, lanes[2].y, lanes[3].y);
+                dst.normalZ[i]    = _mm_setr_ps(lanes[0].z, lanes[1].z, lanes[2].z, lanes[3].z);
+                dst.distance[i]   = _mm_setr_ps(lanes[0].w, lanes[1].w, lanes[2].w, lanes[3].w);
+                dst.absNormalX[i] = _mm_setr_ps(std::fabs(lanes[0].x), std::fabs(lanes[1].x), std::fabs(lanes[2].x), std::fabs(lanes[3].x));
+                dst.absNormalY[i] = _mm_setr_ps(std::fabs(lanes[0].y), std::fabs(lanes[1].y), std::fabs(lanes[2].y), std::fabs(lanes[3].y));
+                dst.absNormalZ[i] = _mm_setr_ps(std::fabs(lanes[0].z), std::fabs(lanes[1].z), std::fabs(lanes[2].z), std::fabs(lanes[3].z));
+            }
+        }
+    }
+
+    /// @~english
+    /// @brief Test a node against the views of the mask, returns the views it is visible in and adds the views containing it to insideMask
+    /// @details Children lie inside their parent, so a view containing a node contains its descendants.
+    /// @~japanese
+    /// @brief マスクのビューに対してノードをテストし、可視であるビューを返す。ノードを含むビューはinsideMaskへ追加する
+    /// @details 子は親の内側にある為、ノードを含むビューはその子孫も含む
+    static UINT TestNodeViews(const Node &node, const ViewPlaneGroup *groups, UINT viewMask, UINT *insideMask) {
+        const UINT activeMask = viewMask & ~*insideMask;
+        if (activeMask == 0) {
+            return viewMask;
+        }
+
+        const __m128 centerX  = _mm_set1_ps((node.boxMin.x + node.boxMax.x) * 0.5f);
+        const __m128 centerY  = _mm_set1_ps((node.boxMin.y + node.boxMax.y) * 0.5f);
+        const __m128 centerZ  = _mm_set1_ps((node.boxMin.z + node.boxMax.z) * 0.5f);
+        const __m128 extentX  = _mm_set1_ps((node.boxMax.x - node.boxMin.x) * 0.5f);
+        const __m128 extentY  = _mm_set1_ps((node.boxMax.y - node.boxMin.y) * 0.5f);
+        const __m128 extentZ  = _mm_set1_ps((node.boxMax.z - node.boxMin.z) * 0.5f);
+        const __m128 zero     = _mm_setzero_ps();
+
+        for (UINT group = 0; (activeMask >> (group * 4)) != 0; ++group) {
+            const UINT laneMask = (activeMask >> (group * 4)) & 0xfu;
+            if (laneMask == 0) {
+                continue;
+            }
+
+            const ViewPlaneGroup &planes = groups[group];
+            __m128 outside = zero;
+            __m128 inside  = _mm_cmpeq_ps(zero, zero);
+            for (UINT i = 0; i < static_cast<UINT>(FrustumPlane::Count); ++i) {
+                const __m128 dist   = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(planes.normalX[i], centerX), _mm_mul_ps(planes.normalY[i], centerY)), _mm_mul_ps(planes.normalZ[i], centerZ)), planes.distance[i]);
+                const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planes.absNormalX[i], extentX), _mm_mul_ps(planes.absNormalY[i], extentY)), _mm_mul_ps(planes.absNormalZ[i], extentZ));
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_sub_ps(zero, radius)));
+                inside  = _mm_and_ps(inside, _mm_cmple_ps(radius, dist));
+            }
+
+            const UINT outsideLanes = static_cast<UINT>(_mm_movemask_ps(outside)) & laneMask;
+            const UINT insideLanes  = static_cast<UINT>(_mm_movemask_ps(inside)) & laneMask & ~outsideLanes;
+            viewMask    &= ~(outsideLanes << (group * 4));
+            *insideMask |= insideLanes << (group * 4);
+        }
+        return viewMask;
+    }
+
+    UINT AllocateNode();
+    void FreeNode(UINT node);
+    void InsertLeaf(UINT leaf);
+    void RemoveLeaf(UINT leaf);
+    UINT Balance(UINT node);
+    void CancelRebuild();
+
+    /// @~english
+    /// @brief Partition a range of BuildRefs with binned SAH, returns the split position
+    /// @~japanese
+    /// @brief BuildRefの範囲をビン分割SAHで分割し、分割位置を返す
+    UINT SplitBuildRange(UINT begin, UINT end);
+
+    /// @~english
+    /// @brief Build a whole subtree of a range on the calling thread
+    /// @~japanese
+    /// @brief 範囲の部分木全体を呼び出し元スレッドで構築
+    void BuildSubtree(const BuildRange &range);
+
+    /// @~english
+    /// @brief Replace the tree with the completed rebuild and fit its boxes to the current proxies
+    /// @~japanese
+    /// @brief 完了した再構築でツリーを置き換え、ボックスを現在のProxyへ合わせる
+    void FinishRebuild();
+
+private:
+    std::vector<Node>       nodes;
+    std::vector<UINT>       freeNodes;
+    std::vector<Proxy>      proxies;
+    std::vector<UINT>       freeProxies;
+    UINT                    root;
+    UINT                    refitCount;
+
+    bool                    rebuilding;
+    std::vector<BuildRef>   buildRefs;
+    std::vector<Node>       buildNodes;
+    std::atomic<UINT>       buildNodeCount;
+    std::vector<BuildRange> pendingRanges;
+    std::vector<BuildRange> splitRanges;    ///< @~english Two per pending range @~japanese 実行待ちの範囲毎に2つ
+    UINT                    rebuildCount;
+    UINT                    rebuildStepCount;
+    float                   rebuildTimeInMs;
+    UINT                    lastRebuildStepCount;
+    float                   lastRebuildTimeInMs;
+};
@@ -0,0 +1,203 @@
+/// @file CommandBundleCache.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "CommandBundleCache.h"
+
+namespace {
+// Size of the part of a key holding its runs
+// キーの連続を保持する部分のサイズ
+size_t GetKeySize(const BundleKey &key) {
+    return offsetof(BundleKey, runs) + sizeof(BundleRun) * key.runCount;
+}
+
+// 64-bit FNV-1a hash of the used part of a key
+// キーの使用部分の64bit FNV-1aハッシュ
+UINT64 HashKey(const BundleKey &key) {
+    const BYTE *bytes = reinterpret_cast<const BYTE *>(&key);
+    const size_t size = GetKeySize(key);
+
+    UINT64 hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+} // namespace ""
+
+//----------------------------------------------------------------------------------------------------
+// CommandBundleCache
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+CommandBundleCache::CommandBundleCache()
+: entryCount(0)
+, frameLatency(0)
+, frameIndex(0)
+, recordTimePerRunInMs(0.0f)
+{
+    ;
+}
+
+// Initialize
+// 初期化
+bool CommandBundleCache::Init(ID3D12Device *inD3dDevice, UINT capacity, UINT inFrameLatency) {
+    if (inD3dDevice == nullptr || capacity == 0 || !entries.empty()) {
+        return false;
+    }
+
+    // Buckets are kept at most half full
+    // バケットは半分以下の占有率に保つ
+    UINT bucketCount = 1;
+    while (bucketCount < capacity * 2) {
+        bucketCount *= 2;
+    }
+
+    d3dDevice    = inD3dDevice;
+    frameLatency = inFrameLatency;
+    entries.resize(capacity);
+    buckets.resize(bucketCount);
+    Invalidate();
+    return true;
+}
+
+// Deinitialize
+// 終了処理
+void CommandBundleCache::Deinit() {
+    entries.clear();
+    buckets.clear();
+    entryCount = 0;
+    d3dDevice.Reset();
+}
+
+// Drop every entry
+// 全エントリを破棄
+void CommandBundleCache::Invalidate() {
+    // The allocators and bundles are kept to be reset by the next recordings
+    // アロケータとバンドルは次の記録でリセットする為に保持する
+    for (auto &entry : entries) {
+        entry.recorded = false;
+    }
+    std::fill(buckets.begin(), buckets.end(), INVALID_BUNDLE_CACHE_ENTRY);
+    entryCount        = 0;
+    stats.cachedCount = 0;
+}
+
+// Start a frame
+// フレームを開始
+void CommandBundleCache::BeginFrame(UINT64 inFrameIndex) {
+    const UINT cachedCount = stats.cachedCount;
+    stats             = BundleCacheStats();
+    stats.cachedCount = cachedCount;
+    frameIndex        = inFrameIndex;
+}
+
+// Find the entry of a key, adding one if it is missing
+// キーのエントリを検索し、無い場合は追加する
+UINT CommandBundleCache::FindEntry(const BundleKey &key) {
+    assert(key.runCount <= MAX_BUNDLE_RUN_COUNT);
+    if (entries.empty()) {
+        return INVALID_BUNDLE_CACHE_ENTRY;
+    }
+
+    stats.lookupCount++;
+    const UINT64 hash = HashKey(key);
+    const size_t keySize = GetKeySize(key);
+    UINT &bucket = buckets[hash & (buckets.size() - 1)];
+    for (UINT index = bucket; index != INVALID_BUNDLE_CACHE_ENTRY; index = entries[index].next) {
+        Entry &entry = entries[index];
+        if (entry.hash == hash && entry.key.runCount == key.runCount && memcmp(&entry.key, &key, keySize) == 0) {
+            entry.lastUsedFrame = frameIndex;
+            entry.lookupCount   = std::min(entry.lookupCount + 1, DEFAULT_BUNDLE_RECORD_THRESHOLD);
+            return index;
+        }
+    }
+
+    const UINT index = (entryCount < entries.size()) ? entryCount++ : ReplaceEntry();
+    if (index == INVALID_BUNDLE_CACHE_ENTRY) {
+        return INVALID_BUNDLE_CACHE_ENTRY;
+    }
+
+    Entry &entry = entries[index];
+    entry.hash          = hash;
+    entry.lastUsedFrame = frameIndex;
+    entry.lookupCount   = 1;
+    entry.recorded      = false;
+    entry.next          = bucket;
+    memcpy(&entry.key, &key, keySize);
+    bucket = index;
+    return index;
+}
+
+// Pick the entry to hold a new key
+// 新しいキーを保持するエントリを選ぶ
+UINT CommandBundleCache::ReplaceEntry() {
+    // Bundles stay referenced by the command lists of the frames in flight
+    // バンドルは実行中のフレームのCommandListから参照され続ける
+    UINT victim = INVALID_BUNDLE_CACHE_ENTRY;
+    for (UINT i = 0; i < entryCount; ++i) {
+        const Entry &entry = entries[i];
+        const UINT64 releaseFrame = entry.lastUsedFrame + (entry.recorded ? frameLatency : 0);
+        if (releaseFrame < frameIndex && (victim == INVALID_BUNDLE_CACHE_ENTRY || entry.lastUsedFrame < entries[victim].lastUsedFrame)) {
+            victim = i;
+        }
+    }
+    if (victim == INVALID_BUNDLE_CACHE_ENTRY) {
+        return INVALID_BUNDLE_CACHE_ENTRY;
+    }
+
+    Entry &entry = entries[victim];
+    UINT *link = &buckets[entry.hash & (buckets.size() - 1)];
+    while (*link != victim) {
+        link = &entries[*link].next;
+    }
+    *link = entry.next;
+
+    if (entry.recorded) {
+        stats.cachedCount--;
+    }
+    stats.evictionCount++;
+    return victim;
+}
+
+// Reset the bundle of an entry for recording
+// 記録の為にエントリのバンドルをリセット
+ID3D12GraphicsCommandList *CommandBundleCache::BeginRecord(Entry *entry) {
+    // The bundle is created in the recording state, later recordings reset it
+    // バンドルは記録状態で生成され、以降の記録ではリセットする
+    if (entry->d3dBundle == nullptr) {
+        if (FAILED(d3dDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_BUNDLE, IID_PPV_ARGS(&entry->d3dAllocator)))) {
+            return nullptr;
+        }
+        if (FAILED(d3dDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_BUNDLE, entry->d3dAllocator.Get(), nullptr, IID_PPV_ARGS(&entry->d3dBundle)))) {
+            entry->d3dAllocator.Reset();
+            return nullptr;
+        }
+    } else {
+        if (FAILED(entry->d3dAllocator->Reset()) || FAILED(entry->d3dBundle->Reset(entry->d3dAllocator.Get(), nullptr))) {
+            return nullptr;
+        }
+    }
+    return entry->d3dBundle.Get();
+}
+
+// Close the bundle of an entry and account the recording time
+// エントリのバンドルを閉じ、記録時間を計上
+void CommandBundleCache::EndRecord(Entry *entry, UINT runCount, float timeInMs) {
+    entry->d3dBundle->Close();
+    entry->recorded = true;
+
+    stats.cachedCount++;
+    stats.recordCount++;
+    stats.recordTimeInMs += timeInMs;
+
+    if (0 < runCount) {
+        const float timePerRunInMs = timeInMs / runCount;
+        if (recordTimePerRunInMs <= 0.0f) {
+            recordTimePerRunInMs = timePerRunInMs;
+        } else {
+            recordTimePerRunInMs += (timePerRunInMs - recordTimePerRunInMs) * DEFAULT_BUNDLE_RECORD_TIME_SMOOTHING;
+        }
+    }
+}
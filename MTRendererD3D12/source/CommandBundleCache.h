@@ -0,0 +1,226 @@
+/// @file CommandBundleCache.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+// Default value
+const UINT DEFAULT_BUNDLE_CACHE_CAPACITY         = 256;
+const UINT DEFAULT_BUNDLE_RECORD_THRESHOLD       = 2;
+const float DEFAULT_BUNDLE_RECORD_TIME_SMOOTHING = 0.1f;
+const UINT MAX_BUNDLE_RUN_COUNT                  = 64;
+const UINT INVALID_BUNDLE_CACHE_ENTRY            = ~0u;
+
+
+/// @~english
+/// @brief Instanced draw over a run of render queue items with equal state
+/// @~japanese
+/// @brief 等しいステートを持つ描画キュー要素の連続に対するインスタンス描画
+/// @~
+/// @struct BundleRun
+struct BundleRun {
+    UINT64  stateKey;           ///< @~english Sort key with the depth bits cleared @~japanese 深度ビットを0にしたソートキー
+    UINT    instanceOffset;
+    UINT    instanceCount;
+};
+
+
+/// @~english
+/// @brief Inputs a draw sequence is recorded from, equal keys record equal commands
+/// @~japanese
+/// @brief 描画の並びを記録する入力、等しいキーは等しいコマンドを記録する
+/// @~
+/// @struct BundleKey
+struct BundleKey {
+    D3D12_GPU_VIRTUAL_ADDRESS   cbLocation;
+    UINT                        depthOnly;
+    UINT                        runCount;
+    BundleRun                   runs[MAX_BUNDLE_RUN_COUNT];
+};
+
+
+/// @~english
+/// @brief Statistics of the bundle cache over a frame
+/// @~japanese
+/// @brief フレーム内のバンドルキャッシュの統計情報
+/// @~
+/// @struct BundleCacheStats
+struct BundleCacheStats {
+    UINT    lookupCount;
+    UINT    hitCount;
+    UINT    recordCount;
+    UINT    evictionCount;
+    UINT    cachedCount;        ///< @~english Entries holding a recorded bundle @~japanese 記録済みのバンドルを持つエントリ
+    UINT    replayedDrawCount;
+    float   recordTimeInMs;
+    float   savedTimeInMs;      ///< @~english Recording time of the replayed draws, estimated from the recorded ones @~japanese 再生した描画の記録時間、記録したものから推定
+
+    /// @brief コンストラクタ
+    BundleCacheStats()
+    : lookupCount(0)
+    , hitCount(0)
+    , recordCount(0)
+    , evictionCount(0)
+    , cachedCount(0)
+    , replayedDrawCount(0)
+    , recordTimeInMs(0.0f)
+    , savedTimeInMs(0.0f)
+    {
+        ;
+    }
+};
+
+
+/// @class CommandBundleCache
+/// @~english
+/// @brief Cache of bundles recorded from draw sequences that stay unchanged over frames
+/// @details A sequence gets a bundle once it has been looked up DEFAULT_BUNDLE_RECORD_THRESHOLD times,
+///          so sequences that change every frame are recorded directly and never pay for a bundle.
+///          Entries are found by a hash of the key and replayed until evicted, the least recently
+///          used entry the GPU is done with is replaced when the cache is full. Keys only name their
+///          resources by index, Invalidate the cache when those change. Not thread safe.
+/// @~japanese
+/// @brief フレームを跨いで変化しない描画の並びから記録したバンドルのキャッシュ
+/// @details 並びはDEFAULT_BUNDLE_RECORD_THRESHOLD回検索されて初めてバンドルを持つ為、毎フレーム
+///          変化する並びは直接記録され、バンドルのコストを払う事はない。エントリはキーのハッシュで
+///          検索し、追い出されるまで再生する。キャッシュが満杯の場合はGPUが使い終えた中で最も長く
+///          使われていないエントリを置き換える。キーはリソースを番号でのみ参照する為、それらが変わる
+///          場合はInvalidateする事。スレッドセーフではない
+class CommandBundleCache {
+public:
+    /// @~english
+    /// @brief Initialize
+    /// @param[in] d3dDevice Device creating the bundles
+    /// @param[in] capacity Number of entries
+    /// @param[in] frameLatency Number of frames the GPU may still execute a bundle after its use
+    /// @return True if initialization succeeded, false otherwise
+    /// @~japanese
+    /// @brief 初期化
+    /// @param[in] d3dDevice バンドルを生成するデバイス
+    /// @param[in] capacity エントリ数
+    /// @param[in] frameLatency 使用後にGPUがバンドルを実行し得るフレーム数
+    /// @return 初期化に成功した場合にはTrue、そうでないならFalseを返す
+    bool Init(ID3D12Device *d3dDevice, UINT capacity, UINT frameLatency);
+
+    /// @~english
+    /// @brief Deinitialize
+    /// @~japanese
+    /// @brief 終了処理
+    void Deinit();
+
+    /// @~english
+    /// @brief Drop every entry, the bundles must no longer be in use by the GPU
+    /// @~japanese
+    /// @brief 全エントリを破棄、バンドルはGPUで使用中であってはならない
+    void Invalidate();
+
+    /// @~english
+    /// @brief Start a frame and reset the statistics
+    /// @~japanese
+    /// @brief フレームを開始し統計情報をリセット
+    void BeginFrame(UINT64 frameIndex);
+
+    /// @~english
+    /// @brief Get the bundle of a draw sequence, recording it when the sequence has become stable
+    /// @param[in] key Inputs of the draw sequence
+    /// @param[in] recordFunc Records the sequence into the bundle given as ID3D12GraphicsCommandList *
+    /// @return Bundle to execute, nullptr if the sequence is to be recorded directly
+    /// @~japanese
+    /// @brief 描画の並びのバンドルを取得、並びが安定した場合は記録する
+    /// @param[in] key 描画の並びの入力
+    /// @param[in] recordFunc ID3D12GraphicsCommandList *で渡されるバンドルへ並びを記録する
+    /// @return 実行するバンドル、並びを直接記録すべき場合はnullptr
+    template<typename RecordFunc>
+    ID3D12GraphicsCommandList *Acquire(const BundleKey &key, RecordFunc recordFunc) {
+        const UINT entryIndex = FindEntry(key);
+        if (entryIndex == INVALID_BUNDLE_CACHE_ENTRY) {
+            return nullptr;
+        }
+
+        Entry &entry = entries[entryIndex];
+        if (entry.recorded) {
+            stats.hitCount++;
+            stats.replayedDrawCount += key.runCount;
+            stats.savedTimeInMs += key.runCount * recordTimePerRunInMs;
+            return entry.d3dBundle.Get();
+        }
+        if (entry.lookupCount < DEFAULT_BUNDLE_RECORD_THRESHOLD) {
+            return nullptr;
+        }
+
+        const auto beginTime = std::chrono::high_resolution_clock::now();
+        ID3D12GraphicsCommandList *d3dBundle = BeginRecord(&entry);
+        if (d3dBundle == nullptr) {
+            return nullptr;
+        }
+        recordFunc(d3dBundle);
+        EndRecord(&entry, key.runCount, std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - beginTime).count());
+        return d3dBundle;
+    }
+
+    /// @~english
+    /// @brief Get the statistics of the current frame
+    /// @~japanese
+    /// @brief 現在のフレームの統計情報を取得
+    const BundleCacheStats& GetStats() const {
+        return stats;
+    }
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    CommandBundleCache();
+
+private:
+    /// @struct Entry
+    struct Entry {
+        Microsoft::WRL::ComPtr<ID3D12CommandAllocator>      d3dAllocator;
+        Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>   d3dBundle;
+        UINT64      hash;
+        UINT64      lastUsedFrame;
+        UINT        lookupCount;
+        UINT        next;           ///< @~english Next entry of the hash bucket @~japanese ハッシュバケットの次のエントリ
+        bool        recorded;
+        BundleKey   key;
+    };
+
+    /// @~english
+    /// @brief Find the entry of a key, adding one if it is missing
+    /// @return Index of the entry, INVALID_BUNDLE_CACHE_ENTRY if no entry can be replaced
+    /// @~japanese
+    /// @brief キーのエントリを検索し、無い場合は追加する
+    /// @return エントリの番号、置き換え可能なエントリが無い場合はINVALID_BUNDLE_CACHE_ENTRY
+    UINT FindEntry(const BundleKey &key);
+
+    /// @~english
+    /// @brief Pick the entry to hold a new key and unlink it from its bucket
+    /// @~japanese
+    /// @brief 新しいキーを保持するエントリを選び、バケットから外す
+    UINT ReplaceEntry();
+
+    /// @~english
+    /// @brief Reset the bundle of an entry for recording
+    /// @~japanese
+    /// @brief 記録の為にエントリのバンドルをリセット
+    ID3D12GraphicsCommandList *BeginRecord(Entry *entry);
+
+    /// @~english
+    /// @brief Close the bundle of an entry and account the recording time
+    /// @~japanese
+    /// @brief エントリのバンドルを閉じ、記録時間を計上
+    void EndRecord(Entry *entry, UINT runCount, float timeInMs);
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12Device>    d3dDevice;
+    std::vector<Entry>      entries;
+    std::vector<UINT>       buckets;
+    UINT                    entryCount;
+    UINT                    frameLatency;
+    UINT64                  frameIndex;
+
+    // Running average of the recording cost, used to estimate the time the replays save
+    // 記録コストの移動平均、再生で節約した時間の推定に使用
+    float                   recordTimePerRunInMs;
+
+    BundleCacheStats        stats;
+};
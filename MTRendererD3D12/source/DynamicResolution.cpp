@@ -0,0 +1,91 @@
+/// @file DynamicResolution.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "DynamicResolution.h"
+
+//----------------------------------------------------------------------------------------------------
+// DynamicResolutionController
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+DynamicResolutionController::DynamicResolutionController()
+: scale(DEFAULT_RESOLUTION_MAX_SCALE)
+, fullScaleCostInMs(0.0f)
+{
+    ;
+}
+
+// Initialize
+// 初期化
+void DynamicResolutionController::Init(const DynamicResolutionDesc &inDesc) {
+    desc              = inDesc;
+    desc.minScale     = std::clamp(desc.minScale, desc.scaleStep, 1.0f);
+    desc.maxScale     = std::clamp(desc.maxScale, desc.minScale, 1.0f);
+    scale             = desc.maxScale;
+    fullScaleCostInMs = 0.0f;
+    stats             = DynamicResolutionStats();
+}
+
+// Feed a measured GPU frame time
+// 計測したGPUフレーム時間を入力
+float DynamicResolutionController::Update(float gpuTimeInMs, float frameScale) {
+    if (gpuTimeInMs <= 0.0f || frameScale <= 0.0f) {
+        return scale;
+    }
+
+    stats.frameCount++;
+    stats.gpuTimeInMs   += gpuTimeInMs;
+    stats.maxGpuTimeInMs = std::max(stats.maxGpuTimeInMs, gpuTimeInMs);
+    if (desc.targetFrameTimeInMs < gpuTimeInMs) {
+        stats.overBudgetCount++;
+    }
+
+    // An overrun replaces the estimate at once, drops are smoothed out
+    // 超過は推定を即座に置き換え、低下は平滑化する
+    const float costInMs = gpuTimeInMs / (frameScale * frameScale);
+    if (fullScaleCostInMs <= 0.0f || fullScaleCostInMs < costInMs) {
+        fullScaleCostInMs = costInMs;
+    } else {
+        fullScaleCostInMs += (costInMs - fullScaleCostInMs) * desc.costSmoothing;
+    }
+
+    const float wantedScale = std::clamp(std::sqrt(desc.targetFrameTimeInMs * desc.headroom / fullScaleCostInMs), desc.minScale, desc.maxScale);
+    if (std::fabs(wantedScale - scale) <= scale * desc.deadband && wantedScale != desc.minScale && wantedScale != desc.maxScale) {
+        return scale;
+    }
+
+    // Quantize toward the wanted scale so every change moves by at least one step, but never past the scales
+    // whose deadband holds the wanted scale, otherwise the next measurement would move it back
+    // 全ての変更が少なくとも1ステップ動くよう望むスケールへ向けて量子化するが、デッドバンドが望むスケールを
+    // 含むスケールを越えない、越えると次の計測で戻る事になる
+    const bool decrease = wantedScale < scale;
+    const float gain = decrease ? desc.decreaseGain : desc.increaseGain;
+    const float stepCount = (scale + (wantedScale - scale) * gain) / desc.scaleStep;
+    float nextScale = (decrease ? std::floor(stepCount) : std::ceil(stepCount)) * desc.scaleStep;
+    if (decrease) {
+        const float bandScale = std::ceil(wantedScale / (1.0f + desc.deadband) / desc.scaleStep) * desc.scaleStep;
+        if (nextScale < bandScale && bandScale < scale) {
+            nextScale = bandScale;
+        }
+    } else {
+        if (desc.deadband < 1.0f) {
+            const float bandScale = std::floor(wantedScale / (1.0f - desc.deadband) / desc.scaleStep) * desc.scaleStep;
+            if (bandScale < nextScale && scale < bandScale) {
+                nextScale = bandScale;
+            }
+        }
+
+        // At low scales the deadband may be narrower than a step, a raise is only taken when it lands closer
+        // 低いスケールではデッドバンドがステップより狭い場合があり、上げるのは近付く場合のみとする
+        if (std::fabs(wantedScale - scale) <= std::fabs(wantedScale - nextScale) && wantedScale != desc.maxScale) {
+            return scale;
+        }
+    }
+    nextScale = std::clamp(nextScale, desc.minScale, desc.maxScale);
+    if (nextScale != scale) {
+        scale = nextScale;
+        stats.changeCount++;
+    }
+    return scale;
+}
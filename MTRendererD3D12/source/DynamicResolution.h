@@ -0,0 +1,142 @@
+/// @file DynamicResolution.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+// Default value
+const float DEFAULT_RESOLUTION_TARGET_FRAME_TIME_IN_MS  = 1000.0f / 60.0f;
+const float DEFAULT_RESOLUTION_HEADROOM                 = 0.9f;
+const float DEFAULT_RESOLUTION_MIN_SCALE                = 0.5f;
+const float DEFAULT_RESOLUTION_MAX_SCALE                = 1.0f;
+const float DEFAULT_RESOLUTION_SCALE_STEP               = 1.0f / 32.0f;
+const float DEFAULT_RESOLUTION_INCREASE_GAIN            = 0.2f;
+const float DEFAULT_RESOLUTION_DECREASE_GAIN            = 0.8f;
+const float DEFAULT_RESOLUTION_DEADBAND                 = 0.05f;
+const float DEFAULT_RESOLUTION_COST_SMOOTHING           = 0.3f;
+
+
+/// @~english
+/// @brief Configuration of the dynamic resolution controller
+/// @~japanese
+/// @brief 動的解像度の制御の設定
+/// @~
+/// @struct DynamicResolutionDesc
+struct DynamicResolutionDesc {
+    float   targetFrameTimeInMs;    ///< @~english GPU frame budget @~japanese GPUのフレーム予算
+    float   headroom;               ///< @~english Part of the budget aimed at, the rest absorbs spikes @~japanese 目標とする予算の割合、残りはスパイクを吸収する
+    float   minScale;
+    float   maxScale;
+    float   scaleStep;              ///< @~english Scales are multiples of the step @~japanese スケールはステップの倍数
+    float   increaseGain;           ///< @~english Part of the way to the wanted scale taken per frame when raising it @~japanese 上げる場合にフレーム毎に望むスケールへ近付く割合
+    float   decreaseGain;           ///< @~english Same when lowering it, higher so an overrun is left quickly @~japanese 下げる場合の同様の割合、超過から素早く抜ける為に高い
+    float   deadband;               ///< @~english Relative difference of the wanted scale left alone @~japanese 放置する望むスケールとの相対的な差
+    float   costSmoothing;          ///< @~english Weight of a new measurement in the cost estimate @~japanese コストの推定における新しい計測の重み
+
+    /// @brief コンストラクタ
+    DynamicResolutionDesc()
+    : targetFrameTimeInMs(DEFAULT_RESOLUTION_TARGET_FRAME_TIME_IN_MS)
+    , headroom(DEFAULT_RESOLUTION_HEADROOM)
+    , minScale(DEFAULT_RESOLUTION_MIN_SCALE)
+    , maxScale(DEFAULT_RESOLUTION_MAX_SCALE)
+    , scaleStep(DEFAULT_RESOLUTION_SCALE_STEP)
+    , increaseGain(DEFAULT_RESOLUTION_INCREASE_GAIN)
+    , decreaseGain(DEFAULT_RESOLUTION_DECREASE_GAIN)
+    , deadband(DEFAULT_RESOLUTION_DEADBAND)
+    , costSmoothing(DEFAULT_RESOLUTION_COST_SMOOTHING)
+    {
+        ;
+    }
+};
+
+
+/// @~english
+/// @brief Statistics of the dynamic resolution since the last reset
+/// @~japanese
+/// @brief 前回のリセット以降の動的解像度の統計情報
+/// @~
+/// @struct DynamicResolutionStats
+struct DynamicResolutionStats {
+    UINT    frameCount;
+    UINT    overBudgetCount;        ///< @~english Frames measured over the target frame time @~japanese 目標フレーム時間を超えて計測されたフレーム
+    UINT    changeCount;
+    float   gpuTimeInMs;            ///< @~english Sum of the measured GPU frame times @~japanese 計測したGPUフレーム時間の合計
+    float   maxGpuTimeInMs;
+
+    /// @brief コンストラクタ
+    DynamicResolutionStats()
+    : frameCount(0)
+    , overBudgetCount(0)
+    , changeCount(0)
+    , gpuTimeInMs(0.0f)
+    , maxGpuTimeInMs(0.0f)
+    {
+        ;
+    }
+};
+
+
+/// @class DynamicResolutionController
+/// @~english
+/// @brief Picks the render scale per frame to hold the measured GPU frame time in a budget
+/// @details GPU timings arrive a few frames late, so each one comes with the scale its frame was rendered
+///          at and is turned into the cost of a full resolution frame, taking the cost as proportional
+///          to the pixel count. The scale that would meet the budget follows from the smoothed cost, and
+///          the current scale moves part of the way there, faster down than up. Differences within the
+///          deadband are ignored and scales are quantized toward the wanted scale without stepping past its
+///          deadband, so a steady load settles on one scale instead of dithering. Independent of D3D12, it
+///          can be fed recorded frame time traces.
+/// @~japanese
+/// @brief 計測したGPUフレーム時間を予算内に保つ為、フレーム毎に描画スケールを選ぶ
+/// @details GPUの計測は数フレーム遅れて届く為、各計測はそのフレームを描画したスケールと共に渡し、
+///          コストはピクセル数に比例するとして全解像度のフレームのコストに換算する。予算を満たすスケールは
+///          平滑化したコストから求め、現在のスケールはそこへ一部だけ近付き、上げるより下げる方が速い。
+///          デッドバンド内の差は無視し、スケールは望むスケールへ向けてそのデッドバンドを越えないよう量子化
+///          する為、一定の負荷では揺れずに1つのスケールに落ち着く。D3D12に依存せず、記録したフレーム時間のトレースを入力できる
+class DynamicResolutionController {
+public:
+    /// @~english
+    /// @brief Initialize
+    /// @~japanese
+    /// @brief 初期化
+    void Init(const DynamicResolutionDesc &desc);
+
+    /// @~english
+    /// @brief Feed a measured GPU frame time
+    /// @param[in] gpuTimeInMs GPU time of a finished frame
+    /// @param[in] frameScale Scale the frame was rendered at
+    /// @return Scale to render the next frame at
+    /// @~japanese
+    /// @brief 計測したGPUフレーム時間を入力
+    /// @param[in] gpuTimeInMs 完了したフレームのGPU時間
+    /// @param[in] frameScale フレームを描画したスケール
+    /// @return 次のフレームを描画するスケール
+    float Update(float gpuTimeInMs, float frameScale);
+
+    float GetScale() const {
+        return scale;
+    }
+
+    const DynamicResolutionDesc& GetDesc() const {
+        return desc;
+    }
+
+    const DynamicResolutionStats& GetStats() const {
+        return stats;
+    }
+
+    void ResetStats() {
+        stats = DynamicResolutionStats();
+    }
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    DynamicResolutionController();
+
+private:
+    DynamicResolutionDesc   desc;
+    float                   scale;
+    float                   fullScaleCostInMs;  ///< @~english Smoothed GPU time of a frame at scale 1, 0 before the first measurement @~japanese スケール1のフレームの平滑化したGPU時間、最初の計測前は0
+    DynamicResolutionStats  stats;
+};
@@ -0,0 +1,253 @@
+/// @file EntityWorld.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "EntityWorld.h"
+#include "JobSystem.h"
+
+namespace {
+// Registered component types
+// 登録済みのコンポーネント種別
+std::mutex          componentTypeMtx;
+ComponentTypeInfo   componentTypes[MAX_COMPONENT_TYPES];
+UINT                componentTypeCount = 0;
+
+// Round up value to a multiple of alignment
+// valueをalignmentの倍数に切り上げ
+UINT AlignUp(UINT value, UINT alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+} // namespace ""
+
+// Register a component type and return its id
+// コンポーネント種別を登録しIDを返す
+UINT RegisterComponentType(const ComponentTypeInfo &info) {
+    std::lock_guard<std::mutex> lock(componentTypeMtx);
+
+    assert(componentTypeCount < MAX_COMPONENT_TYPES);
+    componentTypes[componentTypeCount] = info;
+    return componentTypeCount++;
+}
+
+// Get the registered information of a component type
+// 登録済みコンポーネント種別の情報を取得
+const ComponentTypeInfo& GetComponentTypeInfo(UINT typeId) {
+    assert(typeId < componentTypeCount);
+    return componentTypes[typeId];
+}
+
+//----------------------------------------------------------------------------------------------------
+// EntityWorld
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+EntityWorld::EntityWorld()
+: aliveCount(0)
+{
+    ;
+}
+
+// Destructor
+// デストラクタ
+EntityWorld::~EntityWorld() {
+    Clear();
+}
+
+// Destroy all entities and release the chunks
+// 全エンティティを破棄しチャンクを解放
+void EntityWorld::Clear() {
+    for (auto &archetype : archetypes) {
+        for (auto &chunk : archetype->chunks) {
+            _aligned_free(chunk.data);
+        }
+    }
+    archetypes.clear();
+    entityRecords.clear();
+    freeEntityIndices.clear();
+    gatheredChunks.clear();
+    aliveCount = 0;
+}
+
+// Find or create the archetype of mask
+// maskのアーキタイプを検索、無ければ生成
+UINT EntityWorld::FindOrCreateArchetype(ComponentMask mask) {
+    for (UINT i = 0; i < static_cast<UINT>(archetypes.size()); ++i) {
+        if (archetypes[i]->mask == mask) {
+            return i;
+        }
+    }
+
+    auto archetype = std::make_unique<Archetype>();
+    archetype->mask = mask;
+
+    UINT rowSize = static_cast<UINT>(sizeof(UINT));
+    for (UINT typeId = 0; typeId < MAX_COMPONENT_TYPES; ++typeId) {
+        if ((mask & (1u << typeId)) != 0) {
+            archetype->columnOfType[typeId] = static_cast<UINT>(archetype->columnTypes.size());
+            archetype->columnTypes.push_back(typeId);
+            rowSize += GetComponentTypeInfo(typeId).size;
+        }
+    }
+    archetype->columnOffsets.resize(archetype->columnTypes.size());
+
+    // Largest row count whose aligned columns fit in a chunk
+    // アライメントした各列がチャンクに収まる最大の行数
+    UINT capacity = DEFAULT_CHUNK_SIZE / rowSize;
+    for (; 0 < capacity; --capacity) {
+        UINT offset = capacity * static_cast<UINT>(sizeof(UINT));
+        for (size_t column = 0; column < archetype->columnTypes.size(); ++column) {
+            const auto &info = GetComponentTypeInfo(archetype->columnTypes[column]);
+            offset = AlignUp(offset, info.alignment);
+            archetype->columnOffsets[column] = offset;
+            offset += capacity * info.size;
+        }
+        if (offset <= DEFAULT_CHUNK_SIZE) {
+            break;
+        }
+    }
+    assert(0 < capacity);
+    archetype->chunkCapacity = capacity;
+
+    archetypes.push_back(std::move(archetype));
+    return static_cast<UINT>(archetypes.size() - 1);
+}
+
+// Create an entity with the components in mask
+// maskに含まれるコンポーネントを持つエンティティを生成
+UINT EntityWorld::CreateEntity(ComponentMask mask) {
+    const UINT archetypeIndex = FindOrCreateArchetype(mask);
+    Archetype &archetype = *archetypes[archetypeIndex];
+
+    // Append to the last chunk, all chunks before it are full. The chunk is allocated before the id so a failure
+    // leaves the world unchanged
+    // 末尾のチャンクに追加、それ以前のチャンクは全て埋まっている。失敗時にワールドを変更しない様、チャンクは
+    // IDより先に確保
+    if (archetype.usedChunkCount == 0 || archetype.chunks[archetype.usedChunkCount - 1].count == archetype.chunkCapacity) {
+        if (archetype.chunks.size() == archetype.usedChunkCount) {
+            Chunk chunk;
+            chunk.data = static_cast<BYTE *>(_aligned_malloc(DEFAULT_CHUNK_SIZE, DEFAULT_CHUNK_ALIGNMENT));
+            if (chunk.data == nullptr) {
+                OutputDebugStringA("EntityWorld: could not allocate a chunk\n");
+                return INVALID_ENTITY;
+            }
+            archetype.chunks.push_back(chunk);
+        }
+        archetype.usedChunkCount++;
+    }
+
+    // Allocate the entity id
+    // エンティティIDを確保
+    UINT index = 0;
+    if (freeEntityIndices.empty()) {
+        index = static_cast<UINT>(entityRecords.size());
+        assert(index <= ENTITY_INDEX_MASK);
+        entityRecords.emplace_back();
+    } else {
+        index = freeEntityIndices.back();
+        freeEntityIndices.pop_back();
+    }
+    EntityRecord &record = entityRecords[index];
+    const UINT entity = (record.generation << ENTITY_INDEX_BITS) | index;
+
+    Chunk &chunk = archetype.chunks[archetype.usedChunkCount - 1];
+    const UINT row = chunk.count++;
+
+    reinterpret_cast<UINT *>(chunk.data)[row] = entity;
+    for (size_t column = 0; column < archetype.columnTypes.size(); ++column) {
+        const auto &info = GetComponentTypeInfo(archetype.columnTypes[column]);
+        info.construct(chunk.data + archetype.columnOffsets[column] + row * info.size);
+    }
+
+    record.archetypeIndex = archetypeIndex;
+    record.chunkIndex     = archetype.usedChunkCount - 1;
+    record.row            = row;
+
+    aliveCount++;
+    return entity;
+}
+
+// Destroy an entity
+// エンティティを破棄
+void EntityWorld::DestroyEntity(UINT entity) {
+    if (!IsAlive(entity)) {
+        return;
+    }
+
+    EntityRecord &record = entityRecords[entity & ENTITY_INDEX_MASK];
+    Archetype &archetype = *archetypes[record.archetypeIndex];
+
+    // Move the last entity of the archetype into the hole
+    // アーキタイプ末尾のエンティティで穴を埋める
+    Chunk &lastChunk = archetype.chunks[archetype.usedChunkCount - 1];
+    const UINT lastRow = lastChunk.count - 1;
+    if (record.chunkIndex != archetype.usedChunkCount - 1 || record.row != lastRow) {
+        Chunk &chunk = archetype.chunks[record.chunkIndex];
+        const UINT movedEntity = reinterpret_cast<UINT *>(lastChunk.data)[lastRow];
+
+        reinterpret_cast<UINT *>(chunk.data)[record.row] = movedEntity;
+        for (size_t column = 0; column < archetype.columnTypes.size(); ++column) {
+            const UINT size   = GetComponentTypeInfo(archetype.columnTypes[column]).size;
+            const UINT offset = archetype.columnOffsets[column];
+            memcpy(chunk.data + offset + record.row * size, lastChunk.data + offset + lastRow * size, size);
+        }
+
+        EntityRecord &movedRecord = entityRecords[movedEntity & ENTITY_INDEX_MASK];
+        movedRecord.chunkIndex = record.chunkIndex;
+        movedRecord.row        = record.row;
+    }
+
+    lastChunk.count--;
+    if (lastChunk.count == 0) {
+        archetype.usedChunkCount--;
+    }
+
+    record.archetypeIndex = INVALID_ENTITY;
+    record.generation     = (record.generation + 1) & (~0u >> ENTITY_INDEX_BITS);
+    freeEntityIndices.push_back(entity & ENTITY_INDEX_MASK);
+
+    aliveCount--;
+}
+
+// Test if an entity is alive
+// エンティティが有効か調べる
+bool EntityWorld::IsAlive(UINT entity) const {
+    if (entity == INVALID_ENTITY) {
+        return false;
+    }
+
+    const UINT index = entity & ENTITY_INDEX_MASK;
+    if (entityRecords.size() <= index) {
+        return false;
+    }
+
+    const EntityRecord &record = entityRecords[index];
+    return record.archetypeIndex != INVALID_ENTITY && record.generation == (entity >> ENTITY_INDEX_BITS);
+}
+
+// Collect the chunks matching mask into gatheredChunks
+// maskに一致するチャンクをgatheredChunksへ収集
+void EntityWorld::GatherChunks(ComponentMask mask) {
+    gatheredChunks.clear();
+    UINT offset = 0;
+    for (UINT i = 0; i < static_cast<UINT>(archetypes.size()); ++i) {
+        const Archetype &archetype = *archetypes[i];
+        if ((archetype.mask & mask) != mask) {
+            continue;
+        }
+        for (UINT c = 0; c < archetype.usedChunkCount; ++c) {
+            gatheredChunks.push_back({ i, c, offset });
+            offset += archetype.chunks[c].count;
+        }
+    }
+}
+
+// Run func over the gathered chunks with jobSystem
+// 収集したチャンクに対しjobSystemでfuncを実行
+void EntityWorld::RunParallel(JobSystem *jobSystem, JobSystem::BatchFunc func) {
+    const UINT chunkCount = static_cast<UINT>(gatheredChunks.size());
+    if (jobSystem != nullptr) {
+        jobSystem->ParallelFor(chunkCount, 1, func);
+    } else {
+        func(0, chunkCount);
+    }
+}
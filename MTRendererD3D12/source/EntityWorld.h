@@ -0,0 +1,399 @@
+/// @file EntityWorld.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+#include "JobSystem.h"
+
+// Default value
+const UINT INVALID_ENTITY           = ~0u;
+const UINT ENTITY_INDEX_BITS        = 24;
+const UINT ENTITY_INDEX_MASK        = (1u << ENTITY_INDEX_BITS) - 1u;
+const UINT MAX_COMPONENT_TYPES      = 32;
+const UINT DEFAULT_CHUNK_SIZE       = 16 * 1024;
+const UINT DEFAULT_CHUNK_ALIGNMENT  = 64;
+
+
+/// @~english
+/// @brief Bit set of component types
+/// @~japanese
+/// @brief コンポーネント種別のビット集合
+using ComponentMask = UINT;
+
+/// @~english
+/// @brief Size and alignment of a component type
+/// @~japanese
+/// @brief コンポーネント種別のサイズとアライメント
+/// @~
+/// @struct ComponentTypeInfo
+struct ComponentTypeInfo {
+    UINT    size;
+    UINT    alignment;
+    void    (*construct)(void *dst);
+
+    /// @brief コンストラクタ
+    ComponentTypeInfo()
+    : size(0)
+    , alignment(0)
+    , construct(nullptr)
+    {
+        ;
+    }
+};
+
+/// @~english
+/// @brief Register a component type and return its id
+/// @~japanese
+/// @brief コンポーネント種別を登録しIDを返す
+UINT RegisterComponentType(const ComponentTypeInfo &info);
+
+/// @~english
+/// @brief Get the registered information of a component type
+/// @~japanese
+/// @brief 登録済みコンポーネント種別の情報を取得
+const ComponentTypeInfo& GetComponentTypeInfo(UINT typeId);
+
+/// @~english
+/// @brief Get the id of a component type, registered on first use
+/// @~japanese
+/// @brief コンポーネント種別のIDを取得、初回使用時に登録される
+template<typename T>
+UINT GetComponentTypeId() {
+    static_assert(std::is_trivially_copyable_v<T>, "Components are moved with memcpy and must be trivially copyable.");
+
+    static const UINT typeId = [] {
+        ComponentTypeInfo info;
+        info.size      = static_cast<UINT>(sizeof(T));
+        info.alignment = static_cast<UINT>(alignof(T));
+        info.construct = [](void *dst) { new (dst) T(); };
+        return RegisterComponentType(info);
+    }();
+    return typeId;
+}
+
+/// @~english
+/// @brief Make the mask of component types
+/// @~japanese
+/// @brief コンポーネント種別のマスクを作成
+template<typename... Ts>
+ComponentMask MakeComponentMask() {
+    return (0u | ... | (1u << GetComponentTypeId<Ts>()));
+}
+
+
+/// @class EntityWorld
+/// @~english
+/// @brief Entity and component storage grouped by archetype
+/// @details Entities with the same set of components share an archetype. Each archetype stores
+///          its components in fixed size chunks as separate arrays (SoA), so queries iterate
+///          matching chunks linearly. Chunks are kept dense by moving the last entity into holes.
+/// @~japanese
+/// @brief アーキタイプ毎にまとめたエンティティとコンポーネントの格納領域
+/// @details 同じコンポーネントの組を持つエンティティは同じアーキタイプに属する。各アーキタイプは
+///          固定サイズのチャンクにコンポーネント毎の配列（SoA）として格納するため、クエリは一致する
+///          チャンクを線形に走査できる。削除時は末尾のエンティティで穴を埋めチャンクを密に保つ
+class EntityWorld {
+public:
+    /// @~english
+    /// @brief Create an entity with the given components
+    /// @return Entity id, INVALID_ENTITY if a chunk could not be allocated
+    /// @~japanese
+    /// @brief 指定したコンポーネントを持つエンティティを生成
+    /// @return エンティティID、チャンクを確保できなかった場合はINVALID_ENTITY
+    template<typename... Ts>
+    UINT CreateEntity() {
+        return CreateEntity(MakeComponentMask<Ts...>());
+    }
+
+    /// @~english
+    /// @brief Create an entity with the components in mask
+    /// @return Entity id, INVALID_ENTITY if a chunk could not be allocated
+    /// @~japanese
+    /// @brief maskに含まれるコンポーネントを持つエンティティを生成
+    /// @return エンティティID、チャンクを確保できなかった場合はINVALID_ENTITY
+    UINT CreateEntity(ComponentMask mask);
+
+    /// @~english
+    /// @brief Destroy an entity
+    /// @~japanese
+    /// @brief エンティティを破棄
+    void DestroyEntity(UINT entity);
+
+    /// @~english
+    /// @brief Test if an entity is alive
+    /// @~japanese
+    /// @brief エンティティが有効か調べる
+    bool IsAlive(UINT entity) const;
+
+    /// @~english
+    /// @brief Get a component of an entity
+    /// @return Pointer to the component, nullptr if the entity does not have it
+    /// @~japanese
+    /// @brief エンティティのコンポーネントを取得
+    /// @return コンポーネントへのポインタ、持っていない場合はnullptr
+    template<typename T>
+    T* GetComponent(UINT entity) {
+        if (!IsAlive(entity)) {
+            return nullptr;
+        }
+        const EntityRecord &record = entityRecords[entity & ENTITY_INDEX_MASK];
+        Archetype *archetype = archetypes[record.archetypeIndex].get();
+        const UINT column = archetype->columnOfType[GetComponentTypeId<T>()];
+        if (column == INVALID_ENTITY) {
+            return nullptr;
+        }
+        return reinterpret_cast<T *>(archetype->chunks[record.chunkIndex].data + archetype->columnOffsets[column]) + record.row;
+    }
+
+    /// @~english
+    /// @brief Call func for each chunk containing all of Ts
+    /// @details func is called as func(count, const UINT *entities, Ts *...components).
+    /// @~japanese
+    /// @brief Tsを全て含むチャンク毎にfuncを呼び出す
+    /// @details funcはfunc(count, const UINT *entities, Ts *...components)として呼ばれる
+    template<typename... Ts, typename Func>
+    void ForEach(Func func) {
+        const ComponentMask mask = MakeComponentMask<Ts...>();
+        for (auto &archetype : archetypes) {
+            if ((archetype->mask & mask) != mask) {
+                continue;
+            }
+            for (UINT i = 0; i < archetype->usedChunkCount; ++i) {
+                const Chunk &chunk = archetype->chunks[i];
+                func(chunk.count, GetEntityArray(chunk), GetComponentArray<Ts>(*archetype, chunk)...);
+            }
+        }
+    }
+
+    /// @~english
+    /// @brief Call func for each chunk containing all of Ts in parallel
+    /// @details Chunks are distributed to the workers of jobSystem, func must be thread safe.
+    /// @~japanese
+    /// @brief Tsを全て含むチャンク毎にfuncを並列に呼び出す
+    /// @details チャンクはjobSystemのワーカーに分配されるため、funcはスレッドセーフである必要がある
+    template<typename... Ts, typename Func>
+    void ParallelForEach(JobSystem *jobSystem, Func func) {
+        const ComponentMask mask = MakeComponentMask<Ts...>();
+        GatherChunks(mask);
+
+        RunParallel(jobSystem, [this, &func](UINT begin, UINT end) {
+            for (UINT i = begin; i < end; ++i) {
+                Archetype &archetype = *archetypes[gatheredChunks[i].archetypeIndex];
+                Chunk &chunk = archetype.chunks[gatheredChunks[i].chunkIndex];
+                func(chunk.count, GetEntityArray(chunk), GetComponentArray<Ts>(archetype, chunk)...);
+            }
+        });
+    }
+
+    /// @~english
+    /// @brief Call func for each chunk containing all of Ts in parallel, with the position of the chunk in the query
+    /// @details func is called as func(offset, count, const UINT *entities, Ts *...components), where offset is
+    ///          the number of matching entities in the preceding chunks. The offsets cover [0, CountEntities<Ts...>())
+    ///          so the results can be written to disjoint ranges of one array.
+    /// @~japanese
+    /// @brief Tsを全て含むチャンク毎に、クエリ内でのチャンクの位置と共にfuncを並列に呼び出す
+    /// @details funcはfunc(offset, count, const UINT *entities, Ts *...components)として呼ばれ、offsetは先行する
+    ///          チャンクに含まれる一致エンティティ数。offsetは[0, CountEntities<Ts...>())を覆う為、結果を1つの配列の
+    ///          重ならない範囲へ書き込める
+    template<typename... Ts, typename Func>
+    void ParallelForEachIndexed(JobSystem *jobSystem, Func func) {
+        const ComponentMask mask = MakeComponentMask<Ts...>();
+        GatherChunks(mask);
+
+        RunParallel(jobSystem, [this, &func](UINT begin, UINT end) {
+            for (UINT i = begin; i < end; ++i) {
+                Archetype &archetype = *archetypes[gatheredChunks[i].archetypeIndex];
+                Chunk &chunk = archetype.chunks[gatheredChunks[i].chunkIndex];
+                func(gatheredChunks[i].offset, chunk.count, GetEntityArray(chunk), GetComponentArray<Ts>(archetype, chunk)...);
+            }
+        });
+    }
+
+    /// @~english
+    /// @brief Count the entities containing all of Ts
+    /// @~japanese
+    /// @brief Tsを全て含むエンティティ数を数える
+    template<typename... Ts>
+    UINT CountEntities() const {
+        const ComponentMask mask = MakeComponentMask<Ts...>();
+        UINT count = 0;
+        for (auto &archetype : archetypes) {
+            if ((archetype->mask & mask) != mask) {
+                continue;
+            }
+            for (UINT i = 0; i < archetype->usedChunkCount; ++i) {
+                count += archetype->chunks[i].count;
+            }
+        }
+        return count;
+    }
+
+    /// @~english
+    /// @brief Get the number of alive entities
+    /// @~japanese
+    /// @brief 有効なエンティティ数を取得
+    UINT GetEntityCount() const {
+        return aliveCount;
+    }
+
+    /// @~english
+    /// @brief Get the upper bound of the entity indices (entity & ENTITY_INDEX_MASK)
+    /// @~japanese
+    /// @brief エンティティ番号（entity & ENTITY_INDEX_MASK）の上限を取得
+    UINT GetEntityIndexCapacity() const {
+        return static_cast<UINT>(entityRecords.size());
+    }
+
+    /// @~english
+    /// @brief Get the number of archetypes
+    /// @~japanese
+    /// @brief アーキタイプ数を取得
+    UINT GetArchetypeCount() const {
+        return static_cast<UINT>(archetypes.size());
+    }
+
+    /// @~english
+    /// @brief Destroy all entities and release the chunks
+    /// @~japanese
+    /// @brief 全エンティティを破棄しチャンクを解放
+    void Clear();
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    EntityWorld();
+
+    /// @~english
+    /// @brief Destructor
+    /// @~japanese
+    /// @brief デストラクタ
+    ~EntityWorld();
+
+    EntityWorld(const EntityWorld &) = delete;
+    EntityWorld& operator=(const EntityWorld &) = delete;
+
+private:
+    /// @~english
+    /// @brief Fixed size block storing the components of an archetype
+    /// @~japanese
+    /// @brief アーキタイプのコンポーネントを格納する固定サイズのブロック
+    /// @~
+    /// @struct Chunk
+    struct Chunk {
+        BYTE   *data;
+        UINT    count;
+
+        /// @brief コンストラクタ
+        Chunk()
+        : data(nullptr)
+        , count(0)
+        {
+            ;
+        }
+    };
+
+    /// @~english
+    /// @brief Layout and chunks of a set of components
+    /// @~japanese
+    /// @brief コンポーネントの組のレイアウトとチャンク
+    /// @~
+    /// @struct Archetype
+    struct Archetype {
+        ComponentMask       mask;
+        UINT                chunkCapacity;
+        std::vector<UINT>   columnTypes;
+        std::vector<UINT>   columnOffsets;
+        UINT                columnOfType[MAX_COMPONENT_TYPES];
+        std::vector<Chunk>  chunks;
+        UINT                usedChunkCount;
+
+        /// @brief コンストラクタ
+        Archetype()
+        : mask(0)
+        , chunkCapacity(0)
+        , usedChunkCount(0)
+        {
+            for (auto &column : columnOfType) {
+                column = INVALID_ENTITY;
+            }
+        }
+    };
+
+    /// @~english
+    /// @brief Location of an entity
+    /// @~japanese
+    /// @brief エンティティの格納位置
+    /// @~
+    /// @struct EntityRecord
+    struct EntityRecord {
+        UINT    archetypeIndex;
+        UINT    chunkIndex;
+        UINT    row;
+        UINT    generation;
+
+        /// @brief コンストラクタ
+        EntityRecord()
+        : archetypeIndex(INVALID_ENTITY)
+        , chunkIndex(0)
+        , row(0)
+        , generation(0)
+        {
+            ;
+        }
+    };
+
+    /// @~english
+    /// @brief Chunk matched by a query
+    /// @~japanese
+    /// @brief クエリに一致したチャンク
+    /// @~
+    /// @struct ChunkRef
+    struct ChunkRef {
+        UINT    archetypeIndex;
+        UINT    chunkIndex;
+        UINT    offset;     ///< @~english Matching entities in the preceding chunks @~japanese 先行するチャンクの一致エンティティ数
+    };
+
+    /// @~english
+    /// @brief Find or create the archetype of mask
+    /// @~japanese
+    /// @brief maskのアーキタイプを検索、無ければ生成
+    UINT FindOrCreateArchetype(ComponentMask mask);
+
+    /// @~english
+    /// @brief Collect the chunks matching mask into gatheredChunks
+    /// @~japanese
+    /// @brief maskに一致するチャンクをgatheredChunksへ収集
+    void GatherChunks(ComponentMask mask);
+
+    /// @~english
+    /// @brief Run func over the gathered chunks with jobSystem
+    /// @~japanese
+    /// @brief 収集したチャンクに対しjobSystemでfuncを実行
+    void RunParallel(JobSystem *jobSystem, JobSystem::BatchFunc func);
+
+    /// @~english
+    /// @brief Get the entity id array of a chunk
+    /// @~japanese
+    /// @brief チャンクのエンティティID配列を取得
+    static const UINT* GetEntityArray(const Chunk &chunk) {
+        return reinterpret_cast<const UINT *>(chunk.data);
+    }
+
+    /// @~english
+    /// @brief Get the component array of a chunk
+    /// @~japanese
+    /// @brief チャンクのコンポーネント配列を取得
+    template<typename T>
+    static T* GetComponentArray(const Archetype &archetype, const Chunk &chunk) {
+        return reinterpret_cast<T *>(chunk.data + archetype.columnOffsets[archetype.columnOfType[GetComponentTypeId<T>()]]);
+    }
+
+private:
+    std::vector<std::unique_ptr<Archetype>> archetypes;
+    std::vector<EntityRecord>               entityRecords;
+    std::vector<UINT>                       freeEntityIndices;
+    std::vector<ChunkRef>                   gatheredChunks;
+    UINT                                    aliveCount;
+};
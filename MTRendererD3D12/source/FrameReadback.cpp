@@ -0,0 +1,130 @@
+/// @file FrameReadback.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "FrameReadback.h"
+
+//----------------------------------------------------------------------------------------------------
+// FrameReadbackRing
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+FrameReadbackRing::FrameReadbackRing()
+: acquirePosition(0)
+, readyPosition(0)
+, deliverPosition(0)
+, deliveredCount(0)
+, terminate(false)
+{
+    ;
+}
+
+// Destructor
+// デストラクタ
+FrameReadbackRing::~FrameReadbackRing() {
+    Deinit();
+}
+
+// Initialize and start the consumer thread
+// 初期化し消費者スレッドを開始
+bool FrameReadbackRing::Init(UINT slotCount, const DeliverFunc &inDeliverFunc) {
+    if (consumerThread.joinable() || slotCount == 0 || !inDeliverFunc) {
+        return false;
+    }
+
+    slots.assign(slotCount, 0);
+    acquirePosition = 0;
+    readyPosition.store(0);
+    deliverPosition.store(0);
+    deliveredCount.store(0);
+    stats       = FrameReadbackStats();
+    deliverFunc = inDeliverFunc;
+    terminate   = false;
+
+    consumerThread = std::thread(ConsumerThreadFunc, this);
+    return true;
+}
+
+// Deliver the slots already handed over and stop the consumer thread
+// 受け渡し済みのスロットを受け渡し、消費者スレッドを停止
+void FrameReadbackRing::Deinit() {
+    {
+        std::lock_guard<std::mutex> lock(consumerMtx);
+        terminate = true;
+    }
+    consumerCond.notify_all();
+
+    if (consumerThread.joinable()) {
+        consumerThread.join();
+    }
+    deliverFunc = nullptr;
+}
+
+// Acquire a slot for a frame
+// フレームの為にスロットを取得
+UINT FrameReadbackRing::Acquire(UINT64 frameNumber, UINT64 *fenceValue) {
+    if (slots.empty() || acquirePosition - deliverPosition.load(std::memory_order_acquire) == slots.size()) {
+        stats.skippedCount++;
+        return INVALID_READBACK_SLOT;
+    }
+
+    const UINT slotIndex = static_cast<UINT>(acquirePosition % slots.size());
+    slots[slotIndex] = frameNumber;
+    *fenceValue = ++acquirePosition;
+    stats.capturedCount++;
+    return slotIndex;
+}
+
+// Hand the slots finished by the GPU to the consumer thread
+// GPUが完了したスロットを消費者スレッドへ渡す
+void FrameReadbackRing::Poll(UINT64 completedFenceValue, UINT64 frameNumber) {
+    const UINT64 position    = readyPosition.load(std::memory_order_relaxed);
+    const UINT64 endPosition = std::min(completedFenceValue, acquirePosition);
+    if (endPosition <= position) {
+        return;
+    }
+
+    for (UINT64 i = position; i < endPosition; ++i) {
+        const UINT latencyInFrames = static_cast<UINT>(frameNumber - slots[i % slots.size()]);
+        stats.readyCount++;
+        stats.latencyInFrames   += latencyInFrames;
+        stats.maxLatencyInFrames = std::max(stats.maxLatencyInFrames, latencyInFrames);
+    }
+
+    // Publish under the lock so the consumer cannot miss the wake up between its check and its wait
+    // 消費者が確認と待機の間に起床を逃さないよう、ロック下で公開する
+    {
+        std::lock_guard<std::mutex> lock(consumerMtx);
+        readyPosition.store(endPosition, std::memory_order_release);
+    }
+    consumerCond.notify_one();
+}
+
+// Consumer thread function
+// 消費者スレッド処理関数
+void FrameReadbackRing::ConsumerThreadFunc(FrameReadbackRing *ring) {
+    for (;;) {
+        UINT64 endPosition = 0;
+        {
+            std::unique_lock<std::mutex> lock(ring->consumerMtx);
+            ring->consumerCond.wait(lock, [ring] {
+                return ring->terminate || ring->deliverPosition.load(std::memory_order_relaxed) != ring->readyPosition.load(std::memory_order_relaxed);
+            });
+            endPosition = ring->readyPosition.load(std::memory_order_acquire);
+        }
+
+        UINT64 position = ring->deliverPosition.load(std::memory_order_relaxed);
+        if (position == endPosition) {
+            return;
+        }
+
+        // The slot goes back to the RenderThread only once it is delivered
+        // スロットは受け渡し後にRenderThreadへ返す
+        for (; position < endPosition; ++position) {
+            const UINT slotIndex = static_cast<UINT>(position % ring->slots.size());
+            ring->deliverFunc(slotIndex, ring->slots[slotIndex]);
+            ring->deliverPosition.store(position + 1, std::memory_order_release);
+            ring->deliveredCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,178 @@
+/// @file FrameReadback.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+// Default value
+const UINT DEFAULT_READBACK_SLOT_COUNT  = 4;
+const UINT INVALID_READBACK_SLOT        = ~0u;
+
+
+/// @~english
+/// @brief Rendered frame handed to a readback consumer
+/// @~japanese
+/// @brief 読み戻しの消費者へ渡す描画済みフレーム
+/// @~
+/// @struct ReadbackFrame
+struct ReadbackFrame {
+    UINT64          frameNumber;    ///< @~english RenderThread frame the pixels were rendered in @~japanese ピクセルを描画したRenderThreadのフレーム
+    UINT            width;
+    UINT            height;
+    UINT            rowPitch;       ///< @~english Bytes between the starts of two rows @~japanese 2つの行の先頭の間のバイト数
+    const UINT8    *pixels;         ///< @~english RGBA8 rows, only valid during the call @~japanese RGBA8の行、呼び出しの間のみ有効
+};
+
+
+/// @~english
+/// @brief Function receiving the rendered frames on the consumer thread
+/// @~japanese
+/// @brief 消費者スレッドで描画済みフレームを受け取る関数
+using FrameReadbackConsumer = std::function<void(const ReadbackFrame &frame)>;
+
+
+/// @~english
+/// @brief Statistics of the readback since the last reset
+/// @~japanese
+/// @brief 前回のリセット以降の読み戻しの統計情報
+/// @~
+/// @struct FrameReadbackStats
+struct FrameReadbackStats {
+    UINT    capturedCount;
+    UINT    skippedCount;           ///< @~english Frames not captured because every slot was busy @~japanese 全スロットが使用中の為にキャプチャしなかったフレーム
+    UINT    readyCount;             ///< @~english Captures the GPU finished, handed to the consumer thread @~japanese GPUが完了し消費者スレッドへ渡したキャプチャ
+    UINT    latencyInFrames;        ///< @~english Sum of the frames from the capture to the hand over @~japanese キャプチャから受け渡しまでのフレーム数の合計
+    UINT    maxLatencyInFrames;
+
+    /// @brief コンストラクタ
+    FrameReadbackStats()
+    : capturedCount(0)
+    , skippedCount(0)
+    , readyCount(0)
+    , latencyInFrames(0)
+    , maxLatencyInFrames(0)
+    {
+        ;
+    }
+};
+
+
+/// @class FrameReadbackRing
+/// @~english
+/// @brief Ring of readback slots, handing each one to a consumer thread once the GPU has written it
+/// @details The RenderThread acquires a slot for a frame, records the copy into the slot and signals a fence
+///          with the value of the slot after the frame. Polling the completed fence value then moves the
+///          finished slots to the consumer thread, which delivers them in order and frees them. A frame is
+///          skipped when every slot is busy, so neither the RenderThread nor the GPU ever waits for the
+///          consumer. The ring knows nothing of D3D12, the slots are only indices and fence values.
+/// @~japanese
+/// @brief 読み戻しスロットのリング、GPUが書き込み終えた各スロットを消費者スレッドへ渡す
+/// @details RenderThreadはフレームの為にスロットを取得し、スロットへのコピーを記録し、フレームの後に
+///          スロットの値でフェンスをシグナルする。完了したフェンス値のポーリングで完了したスロットを
+///          消費者スレッドへ移し、消費者スレッドは順に受け渡して解放する。全スロットが使用中の場合は
+///          フレームをスキップする為、RenderThreadもGPUも消費者を待つ事はない。リングはD3D12を知らず、
+///          スロットは番号とフェンス値でしかない
+class FrameReadbackRing {
+public:
+    /// @~english
+    /// @brief Function delivering a slot, called on the consumer thread
+    /// @~japanese
+    /// @brief スロットを受け渡す関数、消費者スレッドで呼ばれる
+    using DeliverFunc = std::function<void(UINT slotIndex, UINT64 frameNumber)>;
+
+    /// @~english
+    /// @brief Initialize and start the consumer thread
+    /// @param[in] slotCount Number of slots
+    /// @param[in] deliverFunc Function delivering the finished slots
+    /// @return True if initialization succeeded, false otherwise
+    /// @~japanese
+    /// @brief 初期化し消費者スレッドを開始
+    /// @param[in] slotCount スロット数
+    /// @param[in] deliverFunc 完了したスロットを受け渡す関数
+    /// @return 初期化に成功した場合にはTrue、そうでないならFalseを返す
+    bool Init(UINT slotCount, const DeliverFunc &deliverFunc);
+
+    /// @~english
+    /// @brief Deliver the slots already handed over and stop the consumer thread
+    /// @~japanese
+    /// @brief 受け渡し済みのスロットを受け渡し、消費者スレッドを停止
+    void Deinit();
+
+    /// @~english
+    /// @brief Acquire a slot for a frame, only called by the RenderThread
+    /// @param[in] frameNumber Frame captured into the slot
+    /// @param[out] fenceValue Value to signal the fence with once the copy is submitted
+    /// @return Slot index, INVALID_READBACK_SLOT if every slot is busy
+    /// @~japanese
+    /// @brief フレームの為にスロットを取得、RenderThreadのみが呼び出す
+    /// @param[in] frameNumber スロットへキャプチャするフレーム
+    /// @param[out] fenceValue コピーの発行後にフェンスをシグナルする値
+    /// @return スロット番号、全スロットが使用中の場合はINVALID_READBACK_SLOT
+    UINT Acquire(UINT64 frameNumber, UINT64 *fenceValue);
+
+    /// @~english
+    /// @brief Hand the slots finished by the GPU to the consumer thread, only called by the RenderThread
+    /// @param[in] completedFenceValue Completed value of the fence
+    /// @param[in] frameNumber Current frame, for the latency
+    /// @~japanese
+    /// @brief GPUが完了したスロットを消費者スレッドへ渡す、RenderThreadのみが呼び出す
+    /// @param[in] completedFenceValue フェンスの完了した値
+    /// @param[in] frameNumber 現在のフレーム、レイテンシ用
+    void Poll(UINT64 completedFenceValue, UINT64 frameNumber);
+
+    /// @~english
+    /// @brief Get the number of slots delivered since the last call and reset it
+    /// @~japanese
+    /// @brief 前回の呼び出し以降に受け渡したスロット数を取得しリセット
+    UINT TakeDeliveredCount() {
+        return deliveredCount.exchange(0);
+    }
+
+    UINT GetSlotCount() const {
+        return static_cast<UINT>(slots.size());
+    }
+
+    const FrameReadbackStats& GetStats() const {
+        return stats;
+    }
+
+    void ResetStats() {
+        stats = FrameReadbackStats();
+    }
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    FrameReadbackRing();
+
+    /// @~english
+    /// @brief Destructor
+    /// @~japanese
+    /// @brief デストラクタ
+    ~FrameReadbackRing();
+
+private:
+    /// @~english
+    /// @brief Consumer thread function
+    /// @~japanese
+    /// @brief 消費者スレッド処理関数
+    static void ConsumerThreadFunc(FrameReadbackRing *ring);
+
+private:
+    // Positions count up forever, the slot is the position modulo the slot count and its fence value the position plus one.
+    // Slots are acquired, finished and delivered in order, so [delivered, ready) wait for the consumer and [ready, acquire) for the GPU.
+    // 位置は増加し続け、スロットは位置をスロット数で割った余り、フェンス値は位置に1を足したもの。
+    // スロットは順に取得、完了、受け渡しされる為、[delivered, ready)は消費者を、[ready, acquire)はGPUを待つ
+    std::vector<UINT64>     slots;              ///< @~english Frame number of each slot @~japanese 各スロットのフレーム番号
+    UINT64                  acquirePosition;    ///< @~english Only used by the RenderThread @~japanese RenderThreadのみが使用する
+    std::atomic<UINT64>     readyPosition;      ///< @~english Written by the RenderThread @~japanese RenderThreadが書き込む
+    std::atomic<UINT64>     deliverPosition;    ///< @~english Written by the consumer thread @~japanese 消費者スレッドが書き込む
+    std::atomic<UINT>       deliveredCount;
+    FrameReadbackStats      stats;
+
+    DeliverFunc             deliverFunc;
+    std::thread             consumerThread;
+    std::mutex              consumerMtx;
+    std::condition_variable consumerCond;
+    bool                    terminate;          ///< @~english Guarded by consumerMtx @~japanese consumerMtxで保護
+};
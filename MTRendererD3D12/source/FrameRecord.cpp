@@ -0,0 +1,235 @@
+/// @file FrameRecord.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "FrameRecord.h"
+
+//----------------------------------------------------------------------------------------------------
+// FrameRecorder
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+FrameRecorder::FrameRecorder()
+: frameOffset(0)
+, frameCount(0)
+, inFrame(false)
+{
+    ;
+}
+
+// Destructor
+// デストラクタ
+FrameRecorder::~FrameRecorder() {
+    Close();
+}
+
+// Create the stream
+// ストリームを生成
+bool FrameRecorder::Open(const char *path, UINT feedActorCapacity) {
+    if (file.is_open()) {
+        return false;
+    }
+
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    FrameRecordHeader header = {};
+    header.magic             = FRAME_RECORD_MAGIC;
+    header.version           = FRAME_RECORD_VERSION;
+    header.inputEventSize    = sizeof(InputEvent);
+    header.feedRecordSize    = sizeof(SceneFeedRecord);
+    header.feedActorCapacity = feedActorCapacity;
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    buffer.clear();
+    buffer.reserve(DEFAULT_FRAME_RECORD_BUFFER_SIZE);
+    frameOffset = 0;
+    frameCount  = 0;
+    inFrame     = false;
+    return static_cast<bool>(file);
+}
+
+// Write the buffered frames and close the stream
+// バッファ内のフレームを書き込みストリームを閉じる
+void FrameRecorder::Close() {
+    if (!file.is_open()) {
+        return;
+    }
+
+    // A frame left open is dropped, it would not replay the same
+    // 開いたままのフレームは同じように再生できない為破棄する
+    if (inFrame) {
+        buffer.resize(frameOffset);
+        inFrame = false;
+    }
+    frameOffset = buffer.size();
+    Flush();
+    file.close();
+}
+
+// Begin a frame
+// フレームを開始
+void FrameRecorder::BeginFrame(float delta) {
+    if (!file.is_open()) {
+        return;
+    }
+
+    if (inFrame) {
+        buffer.resize(frameOffset);
+    }
+
+    FrameRecordEntry entry = {};
+    entry.delta = delta;
+    frameOffset = buffer.size();
+    Append(&entry, sizeof(entry));
+    inFrame = true;
+}
+
+// Add input events applied in the frame
+// フレームで適用した入力イベントを追加
+void FrameRecorder::AddInputEvents(const InputEvent *events, UINT count) {
+    if (!inFrame || count == 0) {
+        return;
+    }
+
+    assert(GetCurrentEntry()->feedRecordCount == 0);
+    Append(events, sizeof(InputEvent) * count);
+    GetCurrentEntry()->inputCount += count;
+}
+
+// Add a scene feed record applied in the frame
+// フレームで適用したシーンフィードのレコードを追加
+void FrameRecorder::AddFeedRecord(const SceneFeedRecord &record) {
+    if (!inFrame) {
+        return;
+    }
+
+    Append(&record, sizeof(record));
+    GetCurrentEntry()->feedRecordCount++;
+}
+
+// End the frame
+// フレームを終了
+void FrameRecorder::EndFrame(UINT64 checksum) {
+    if (!inFrame) {
+        return;
+    }
+
+    FrameRecordEntry *entry = GetCurrentEntry();
+    if (IsChecksumFrame()) {
+        entry->flags   |= FRAME_RECORD_FLAG_CHECKSUM;
+        entry->checksum = checksum;
+    }
+    frameOffset = buffer.size();
+    frameCount++;
+    inFrame = false;
+}
+
+// Append data to the current frame
+// 現在のフレームへデータを追加
+void FrameRecorder::Append(const void *data, size_t size) {
+    // Make room by writing out the finished frames, the buffer only grows for a frame larger than itself
+    // 完了したフレームを書き出して空きを作る、バッファが伸びるのはそれ自体より大きなフレームの場合のみ
+    if (buffer.capacity() < buffer.size() + size) {
+        Flush();
+    }
+
+    const BYTE *bytes = static_cast<const BYTE *>(data);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+// Write the finished frames to the file
+// 完了したフレームをファイルへ書き込む
+void FrameRecorder::Flush() {
+    if (frameOffset == 0) {
+        return;
+    }
+
+    file.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(frameOffset));
+    buffer.erase(buffer.begin(), buffer.begin() + frameOffset);
+    frameOffset = 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+// FrameReplay
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+FrameReplay::FrameReplay()
+: position(0)
+, feedActorCapacity(0)
+{
+    ;
+}
+
+// Read a stream
+// ストリームを読み込む
+bool FrameReplay::Open(const char *path) {
+    Close();
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+
+    const auto size = static_cast<size_t>(file.tellg());
+    if (size < sizeof(FrameRecordHeader)) {
+        return false;
+    }
+    stream.resize(size);
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char *>(stream.data()), size)) {
+        Close();
+        return false;
+    }
+
+    FrameRecordHeader header;
+    memcpy(&header, stream.data(), sizeof(header));
+    if (header.magic != FRAME_RECORD_MAGIC || header.version != FRAME_RECORD_VERSION ||
+        header.inputEventSize != sizeof(InputEvent) || header.feedRecordSize != sizeof(SceneFeedRecord)) {
+        Close();
+        return false;
+    }
+
+    position          = sizeof(FrameRecordHeader);
+    feedActorCapacity = header.feedActorCapacity;
+    return true;
+}
+
+// Release the stream
+// ストリームを解放
+void FrameReplay::Close() {
+    stream.clear();
+    stream.shrink_to_fit();
+    position          = 0;
+    feedActorCapacity = 0;
+}
+
+// Read the next frame
+// 次のフレームを読み込む
+bool FrameReplay::NextFrame(ReplayFrame *dstFrame) {
+    if (stream.size() - position < sizeof(FrameRecordEntry)) {
+        return false;
+    }
+
+    const auto entry = reinterpret_cast<const FrameRecordEntry *>(stream.data() + position);
+    const size_t inputSize = sizeof(InputEvent) * static_cast<size_t>(entry->inputCount);
+    const size_t feedSize  = sizeof(SceneFeedRecord) * static_cast<size_t>(entry->feedRecordCount);
+    if (stream.size() - position - sizeof(FrameRecordEntry) < inputSize + feedSize) {
+        return false;
+    }
+
+    const BYTE *data = stream.data() + position + sizeof(FrameRecordEntry);
+    dstFrame->delta           = entry->delta;
+    dstFrame->inputEvents     = reinterpret_cast<const InputEvent *>(data);
+    dstFrame->inputCount      = entry->inputCount;
+    dstFrame->feedRecords     = reinterpret_cast<const SceneFeedRecord *>(data + inputSize);
+    dstFrame->feedRecordCount = entry->feedRecordCount;
+    dstFrame->hasChecksum     = (entry->flags & FRAME_RECORD_FLAG_CHECKSUM) != 0;
+    dstFrame->checksum        = entry->checksum;
+
+    position += sizeof(FrameRecordEntry) + inputSize + feedSize;
+    return true;
+}
@@ -0,0 +1,271 @@
+/// @file FrameRecord.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+#include "InputQueue.h"
+#include "SceneFeed.h"
+
+// Binary frame record identifier ('MTRR')
+const UINT   FRAME_RECORD_MAGIC                     = 0x5252544du;
+const UINT   FRAME_RECORD_VERSION                   = 2;
+const size_t DEFAULT_FRAME_RECORD_BUFFER_SIZE       = 1024 * 1024;
+const UINT   DEFAULT_FRAME_RECORD_CHECKSUM_INTERVAL = 30;           // Frames between two checksums of the scene
+
+// Flags of FrameRecordEntry
+const UINT FRAME_RECORD_FLAG_CHECKSUM = 0x1;
+
+
+/// @~english
+/// @brief Header at the start of the stream
+/// @~japanese
+/// @brief ストリーム先頭のヘッダ
+/// @~
+/// @struct FrameRecordHeader
+struct FrameRecordHeader {
+    UINT    magic;
+    UINT    version;
+    UINT    inputEventSize;     ///< @~english Checked together with the version, the events are stored as they are @~japanese バージョンと共に確認する、イベントはそのまま格納する
+    UINT    feedRecordSize;
+    UINT    feedActorCapacity;  ///< @~english Of the scene feed the records came from, the replay allocates as many feed actors @~japanese レコードの元のシーンフィードのもの、再生は同数のフィードのアクタを確保する
+    UINT    reserved;
+};
+
+/// @~english
+/// @brief Frame in the stream, followed by its input events and then its scene feed records
+/// @~japanese
+/// @brief ストリーム内のフレーム、その入力イベント、続いてシーンフィードのレコードが後に続く
+/// @~
+/// @struct FrameRecordEntry
+struct FrameRecordEntry {
+    float   delta;              ///< @~english Passed to MTRenderer::Update, bit for bit @~japanese MTRenderer::Updateへビット単位でそのまま渡す
+    UINT    inputCount;
+    UINT    feedRecordCount;
+    UINT    flags;              ///< @~english FRAME_RECORD_FLAG_* @~japanese FRAME_RECORD_FLAG_*
+    UINT64  checksum;           ///< @~english Of the scene after the update, valid with FRAME_RECORD_FLAG_CHECKSUM @~japanese 更新後のシーンのもの、FRAME_RECORD_FLAG_CHECKSUMと共に有効
+};
+static_assert(sizeof(FrameRecordHeader) % alignof(SceneFeedRecord) == 0 && sizeof(FrameRecordEntry) % alignof(SceneFeedRecord) == 0 && sizeof(InputEvent) % alignof(SceneFeedRecord) == 0,
+    "Every part of a frame must keep the next one aligned.");
+
+
+/// @~english
+/// @brief Frame read from a stream, the arrays point into the stream
+/// @~japanese
+/// @brief ストリームから読み込んだフレーム、配列はストリーム内を指す
+/// @~
+/// @struct ReplayFrame
+struct ReplayFrame {
+    float                   delta;
+    const InputEvent       *inputEvents;
+    UINT                    inputCount;
+    const SceneFeedRecord  *feedRecords;
+    UINT                    feedRecordCount;
+    bool                    hasChecksum;
+    UINT64                  checksum;
+
+    /// @brief コンストラクタ
+    ReplayFrame()
+    : delta(0.0f)
+    , inputEvents(nullptr)
+    , inputCount(0)
+    , feedRecords(nullptr)
+    , feedRecordCount(0)
+    , hasChecksum(false)
+    , checksum(0)
+    {
+        ;
+    }
+};
+
+
+/// @~english
+/// @brief Statistics of a replay
+/// @~japanese
+/// @brief 再生の統計情報
+/// @~
+/// @struct FrameReplayStats
+struct FrameReplayStats {
+    UINT64  frameCount;
+    UINT    checkedCount;
+    UINT    mismatchCount;          ///< @~english Checksums differing from the recorded ones @~japanese 記録されたものと異なるチェックサム
+    UINT64  firstMismatchFrame;
+    float   timeInMs;               ///< @~english From the first frame to the last one @~japanese 最初のフレームから最後のフレームまで
+
+    /// @brief コンストラクタ
+    FrameReplayStats()
+    : frameCount(0)
+    , checkedCount(0)
+    , mismatchCount(0)
+    , firstMismatchFrame(0)
+    , timeInMs(0.0f)
+    {
+        ;
+    }
+};
+
+
+/// @class FrameRecorder
+/// @~english
+/// @brief Records what drives the simulation frame by frame to a binary stream
+/// @details A frame is the delta of the update, the input events and the scene feed records applied in
+///          it, and periodically a checksum of the scene. Frames are gathered in a buffer allocated once
+///          and written to the file when it fills up, so recording does not use the heap per frame.
+/// @~japanese
+/// @brief シミュレーションを動かすものをフレーム毎にバイナリストリームへ記録する
+/// @details フレームは更新の経過時間、その中で適用した入力イベントとシーンフィードのレコード、及び定期的な
+///          シーンのチェックサム。フレームは一度だけ確保したバッファに集め、満杯になった時にファイルへ
+///          書き込む為、記録はフレーム毎にヒープを使用しない
+class FrameRecorder {
+public:
+    /// @~english
+    /// @brief Create the stream
+    /// @param[in] path Path of the stream
+    /// @param[in] feedActorCapacity Actor capacity of the scene feed whose records are added, 0 without a feed
+    /// @return True if succeeded, false if the file can not be created
+    /// @~japanese
+    /// @brief ストリームを生成
+    /// @param[in] path ストリームのパス
+    /// @param[in] feedActorCapacity 追加するレコードのシーンフィードのアクタ容量、フィードが無い場合は0
+    /// @return 成功した場合にはTrue、ファイルを生成できない場合はFalseを返す
+    bool Open(const char *path, UINT feedActorCapacity);
+
+    /// @~english
+    /// @brief Write the buffered frames and close the stream
+    /// @~japanese
+    /// @brief バッファ内のフレームを書き込みストリームを閉じる
+    void Close();
+
+    /// @~english
+    /// @brief Begin a frame
+    /// @param[in] delta Time passed to the update
+    /// @~japanese
+    /// @brief フレームを開始
+    /// @param[in] delta 更新へ渡す時間
+    void BeginFrame(float delta);
+
+    /// @~english
+    /// @brief Add input events applied in the frame, before any scene feed record
+    /// @~japanese
+    /// @brief フレームで適用した入力イベントを追加、シーンフィードのレコードより前に
+    void AddInputEvents(const InputEvent *events, UINT count);
+
+    /// @~english
+    /// @brief Add a scene feed record applied in the frame
+    /// @~japanese
+    /// @brief フレームで適用したシーンフィードのレコードを追加
+    void AddFeedRecord(const SceneFeedRecord &record);
+
+    /// @~english
+    /// @brief End the frame
+    /// @param[in] checksum Checksum of the scene, only stored if IsChecksumFrame()
+    /// @~japanese
+    /// @brief フレームを終了
+    /// @param[in] checksum シーンのチェックサム、IsChecksumFrame()の場合のみ格納する
+    void EndFrame(UINT64 checksum);
+
+    /// @~english
+    /// @brief Get whether the current frame stores a checksum
+    /// @~japanese
+    /// @brief 現在のフレームがチェックサムを格納するかどうかを取得
+    bool IsChecksumFrame() const {
+        return (frameCount % DEFAULT_FRAME_RECORD_CHECKSUM_INTERVAL) == 0;
+    }
+
+    bool IsOpen() const {
+        return file.is_open();
+    }
+
+    UINT64 GetFrameCount() const {
+        return frameCount;
+    }
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    FrameRecorder();
+
+    /// @~english
+    /// @brief Destructor
+    /// @~japanese
+    /// @brief デストラクタ
+    ~FrameRecorder();
+
+private:
+    /// @~english
+    /// @brief Append data to the current frame
+    /// @~japanese
+    /// @brief 現在のフレームへデータを追加
+    void Append(const void *data, size_t size);
+
+    /// @~english
+    /// @brief Write the finished frames to the file
+    /// @~japanese
+    /// @brief 完了したフレームをファイルへ書き込む
+    void Flush();
+
+    FrameRecordEntry* GetCurrentEntry() {
+        return reinterpret_cast<FrameRecordEntry *>(buffer.data() + frameOffset);
+    }
+
+private:
+    std::ofstream       file;
+    std::vector<BYTE>   buffer;
+    size_t              frameOffset;    ///< @~english Start of the current frame in the buffer @~japanese バッファ内の現在のフレームの先頭
+    UINT64              frameCount;
+    bool                inFrame;
+};
+
+
+/// @class FrameReplay
+/// @~english
+/// @brief Reads back a stream written by FrameRecorder frame by frame
+/// @details The whole stream is read when opened, the frames then point into it.
+/// @~japanese
+/// @brief FrameRecorderが書き込んだストリームをフレーム毎に読み戻す
+/// @details 開く時にストリーム全体を読み込み、フレームはその中を指す
+class FrameReplay {
+public:
+    /// @~english
+    /// @brief Read a stream
+    /// @return True if succeeded, false if the file does not exist or its layout differs
+    /// @~japanese
+    /// @brief ストリームを読み込む
+    /// @return 成功した場合にはTrue、ファイルが存在しないかレイアウトが異なる場合はFalseを返す
+    bool Open(const char *path);
+
+    /// @~english
+    /// @brief Release the stream
+    /// @~japanese
+    /// @brief ストリームを解放
+    void Close();
+
+    /// @~english
+    /// @brief Read the next frame
+    /// @param[out] dstFrame Frame, valid until the stream is closed
+    /// @return True if a frame was read, false at the end of the stream or if the frame is truncated
+    /// @~japanese
+    /// @brief 次のフレームを読み込む
+    /// @param[out] dstFrame フレーム、ストリームを閉じるまで有効
+    /// @return フレームを読み込んだ場合はTrue、ストリームの終端もしくはフレームが途切れている場合はFalseを返す
+    bool NextFrame(ReplayFrame *dstFrame);
+
+    bool IsOpen() const {
+        return !stream.empty();
+    }
+
+    UINT GetFeedActorCapacity() const {
+        return feedActorCapacity;
+    }
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    FrameReplay();
+
+private:
+    std::vector<BYTE>   stream;
+    size_t              position;
+    UINT                feedActorCapacity;
+};
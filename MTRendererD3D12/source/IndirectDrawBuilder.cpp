@@ -0,0 +1,176 @@
+/// @file IndirectDrawBuilder.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "IndirectDrawBuilder.h"
+#include "JobSystem.h"
+
+namespace {
+// Range of items handled by a task and the place of its output
+// タスクが扱う要素の範囲と出力の位置
+struct BuildTask {
+    UINT    begin;
+    UINT    end;
+    UINT    recordCount;
+    UINT    batchCount;
+    UINT    instanceCount;
+    UINT    recordOffset;
+    UINT    batchOffset;
+};
+
+// True if the item starts a run of equal state
+// 要素が等しいステートの連続を開始する場合はTrue
+bool IsRunStart(const RenderItem *items, UINT index) {
+    return index == 0 || RenderQueue::GetStateKey(items[index].sortKey) != RenderQueue::GetStateKey(items[index - 1].sortKey);
+}
+
+// True if the item starts a batch, a batch spans the items of a pass and pipeline
+// 要素がバッチを開始する場合はTrue、バッチはパスとパイプラインが等しい要素に渡る
+bool IsBatchStart(const RenderItem *items, UINT index) {
+    return index == 0 || (items[index].sortKey >> SORT_KEY_PIPELINE_SHIFT) != (items[index - 1].sortKey >> SORT_KEY_PIPELINE_SHIFT);
+}
+
+// True if the pipeline and mesh of a sort key exist
+// ソートキーのパイプラインとメッシュが存在する場合はTrue
+bool IsDrawable(const IndirectDrawBuildDesc &desc, UINT64 sortKey) {
+    return RenderQueue::GetPipeline(sortKey) < desc.pipelineCount && RenderQueue::GetMesh(sortKey) < desc.meshCount;
+}
+
+// Count the records and batches starting in the range of a task
+// タスクの範囲で始まるレコードとバッチを数える
+void CountTask(const IndirectDrawBuildDesc &desc, BuildTask *task) {
+    task->recordCount   = 0;
+    task->batchCount    = 0;
+    task->instanceCount = 0;
+    for (UINT i = task->begin; i < task->end; ++i) {
+        if (IsBatchStart(desc.items, i)) {
+            task->batchCount++;
+        }
+
+        // Every item of a drawable run is an instance of its record
+        // 描画可能な連続の全要素はそのレコードのインスタンスとなる
+        if (IsDrawable(desc, desc.items[i].sortKey)) {
+            task->instanceCount++;
+            if (IsRunStart(desc.items, i)) {
+                task->recordCount++;
+            }
+        }
+    }
+}
+
+// Write the records and batches starting in the range of a task, a run may continue past the range
+// タスクの範囲で始まるレコードとバッチを書き込む、連続は範囲を越えて続く場合がある
+void WriteTask(const IndirectDrawBuildDesc &desc, UINT itemCount, const BuildTask &task, IndirectDrawRecord *dstRecords, IndirectDrawBatch *dstBatches) {
+    const RenderItem *items = desc.items;
+    UINT recordIndex = task.recordOffset;
+    UINT batchIndex  = task.batchOffset;
+    for (UINT i = task.begin; i < task.end; ++i) {
+        const UINT64 sortKey = items[i].sortKey;
+        if (IsBatchStart(items, i)) {
+            IndirectDrawBatch &batch = dstBatches[batchIndex++];
+            batch.pipelineIndex = RenderQueue::GetPipeline(sortKey);
+            batch.firstRecord   = recordIndex;
+            batch.recordCount   = 0;
+        }
+        if (!IsRunStart(items, i) || !IsDrawable(desc, sortKey)) {
+            continue;
+        }
+
+        const UINT64 stateKey = RenderQueue::GetStateKey(sortKey);
+        UINT runEnd = i + 1;
+        while (runEnd < itemCount && RenderQueue::GetStateKey(items[runEnd].sortKey) == stateKey) {
+            runEnd++;
+        }
+
+        const UINT lodIndex = std::min(RenderQueue::GetLod(sortKey), MAX_MESH_LOD_COUNT - 1);
+        const IndirectMeshRange &range = desc.meshRanges[RenderQueue::GetMesh(sortKey) * MAX_MESH_LOD_COUNT + lodIndex];
+
+        IndirectDrawRecord &record = dstRecords[recordIndex++];
+        record.instanceOffset        = i;
+        record.indexCountPerInstance = range.indexCount;
+        record.instanceCount         = runEnd - i;
+        record.startIndexLocation    = range.startIndex;
+        record.baseVertexLocation    = range.baseVertex;
+        record.startInstanceLocation = 0;
+    }
+}
+} // namespace ""
+
+//----------------------------------------------------------------------------------------------------
+// IndirectDrawBuilder
+//----------------------------------------------------------------------------------------------------
+// Build the records and batches
+// レコードとバッチを生成
+void IndirectDrawBuilder::Build(const IndirectDrawBuildDesc &desc, JobSystem *jobSystem, IndirectDrawRecord *dstRecords, IndirectDrawBatch *dstBatches, IndirectDrawBuildResult *dstResult) {
+    *dstResult = IndirectDrawBuildResult();
+
+    // Passes are sorted, so the opaque items of the prepass lead the queue
+    // パス順にソートされている為、プリパスの不透明要素はキューの先頭にある
+    UINT itemCount = desc.itemCount;
+    if (desc.depthOnly) {
+        const UINT64 opaquePass = static_cast<UINT64>(RenderPass::Opaque);
+        const RenderItem *opaqueEnd = std::partition_point(desc.items, desc.items + itemCount, [opaquePass](const RenderItem &item) {
+            return (item.sortKey >> SORT_KEY_PASS_SHIFT) == opaquePass;
+        });
+        itemCount = static_cast<UINT>(opaqueEnd - desc.items);
+    }
+    if (itemCount == 0) {
+        return;
+    }
+
+    BuildTask tasks[MAX_INDIRECT_BUILD_TASK_COUNT];
+    const UINT taskCount = std::clamp((itemCount + DEFAULT_INDIRECT_BUILD_BATCH_SIZE - 1) / DEFAULT_INDIRECT_BUILD_BATCH_SIZE, 1u, MAX_INDIRECT_BUILD_TASK_COUNT);
+    for (UINT t = 0; t < taskCount; ++t) {
+        tasks[t].begin = static_cast<UINT>(static_cast<UINT64>(itemCount) * t / taskCount);
+        tasks[t].end   = static_cast<UINT>(static_cast<UINT64>(itemCount) * (t + 1) / taskCount);
+    }
+
+    auto runTasks = [jobSystem, taskCount](const auto &func) {
+        if (jobSystem != nullptr && 1 < taskCount) {
+            jobSystem->ParallelFor(taskCount, 1, func);
+        } else {
+            func(0, taskCount);
+        }
+    };
+
+    BuildTask *taskArray = tasks;
+    runTasks([&desc, taskArray](UINT begin, UINT end) {
+        for (UINT t = begin; t < end; ++t) {
+            CountTask(desc, &taskArray[t]);
+        }
+    });
+
+    // Each task writes after the output of the earlier ones
+    // 各タスクは前のタスクの出力の後に書き込む
+    UINT recordCount   = 0;
+    UINT batchCount    = 0;
+    UINT instanceCount = 0;
+    for (UINT t = 0; t < taskCount; ++t) {
+        tasks[t].recordOffset = recordCount;
+        tasks[t].batchOffset  = batchCount;
+        recordCount   += tasks[t].recordCount;
+        batchCount    += tasks[t].batchCount;
+        instanceCount += tasks[t].instanceCount;
+    }
+
+    runTasks([&desc, taskArray, itemCount, dstRecords, dstBatches](UINT begin, UINT end) {
+        for (UINT t = begin; t < end; ++t) {
+            WriteTask(desc, itemCount, taskArray[t], dstRecords, dstBatches);
+        }
+    });
+
+    // A batch ends where the next one starts, the batches left without a drawable run are removed
+    // バッチは次のバッチの開始位置で終わり、描画可能な連続を持たないバッチは除く
+    UINT dstBatchIndex = 0;
+    for (UINT b = 0; b < batchCount; ++b) {
+        const UINT recordEnd = (b + 1 < batchCount) ? dstBatches[b + 1].firstRecord : recordCount;
+        IndirectDrawBatch batch = dstBatches[b];
+        batch.recordCount = recordEnd - batch.firstRecord;
+        if (batch.recordCount != 0) {
+            dstBatches[dstBatchIndex++] = batch;
+        }
+    }
+    dstResult->recordCount   = recordCount;
+    dstResult->batchCount    = dstBatchIndex;
+    dstResult->instanceCount = instanceCount;
+}
@@ -0,0 +1,127 @@
+/// @file IndirectDrawBuilder.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+#include "LodSelector.h"
+#include "RenderQueue.h"
+
+class JobSystem;
+
+// Default value
+const UINT DEFAULT_INDIRECT_BUILD_BATCH_SIZE    = 4096;
+const UINT MAX_INDIRECT_BUILD_TASK_COUNT        = 64;
+
+
+/// @~english
+/// @brief Command of the indirect draws, the draw constants (b1) followed by D3D12_DRAW_INDEXED_ARGUMENTS
+/// @~japanese
+/// @brief 間接描画のコマンド、描画定数（b1）とそれに続くD3D12_DRAW_INDEXED_ARGUMENTS
+/// @~
+/// @struct IndirectDrawRecord
+struct IndirectDrawRecord {
+    UINT    instanceOffset;     ///< @~english First instance of the draw in the scene constant buffer @~japanese シーン定数バッファ内での描画の先頭インスタンス
+    UINT    indexCountPerInstance;
+    UINT    instanceCount;
+    UINT    startIndexLocation;
+    INT     baseVertexLocation;
+    UINT    startInstanceLocation;
+};
+
+
+/// @~english
+/// @brief Consecutive records of a pipeline, submitted with one ExecuteIndirect
+/// @~japanese
+/// @brief パイプラインの連続するレコード、1回のExecuteIndirectで発行する
+/// @~
+/// @struct IndirectDrawBatch
+struct IndirectDrawBatch {
+    UINT    pipelineIndex;
+    UINT    firstRecord;
+    UINT    recordCount;
+};
+
+
+/// @~english
+/// @brief Location of a mesh LOD in the shared geometry pools
+/// @~japanese
+/// @brief 共有ジオメトリプール内でのメッシュのLODの位置
+/// @~
+/// @struct IndirectMeshRange
+struct IndirectMeshRange {
+    UINT    indexCount;
+    UINT    startIndex;
+    INT     baseVertex;
+};
+
+
+/// @~english
+/// @brief Inputs of the indirect draw argument generation
+/// @~japanese
+/// @brief 間接描画の引数生成の入力
+/// @~
+/// @struct IndirectDrawBuildDesc
+struct IndirectDrawBuildDesc {
+    const RenderItem           *items;          ///< @~english Sorted render queue items @~japanese ソート済みの描画キューの要素
+    UINT                        itemCount;
+    bool                        depthOnly;      ///< @~english Only the opaque items are drawn @~japanese 不透明要素のみ描画する
+    const IndirectMeshRange    *meshRanges;     ///< @~english MAX_MESH_LOD_COUNT ranges per mesh @~japanese メッシュ毎にMAX_MESH_LOD_COUNT個の範囲
+    UINT                        meshCount;
+    UINT                        pipelineCount;
+};
+
+
+/// @~english
+/// @brief Outputs of the indirect draw argument generation
+/// @~japanese
+/// @brief 間接描画の引数生成の出力
+/// @~
+/// @struct IndirectDrawBuildResult
+struct IndirectDrawBuildResult {
+    UINT    recordCount;
+    UINT    batchCount;
+    UINT    instanceCount;      ///< @~english Instances drawn by the records @~japanese レコードが描画するインスタンス数
+
+    /// @brief コンストラクタ
+    IndirectDrawBuildResult()
+    : recordCount(0)
+    , batchCount(0)
+    , instanceCount(0)
+    {
+        ;
+    }
+};
+
+
+/// @class IndirectDrawBuilder
+/// @~english
+/// @brief Generation of the packed ExecuteIndirect arguments from a sorted render queue
+/// @details Every run of items with equal state becomes one record, exactly like the direct submission,
+///          and consecutive records of a pipeline form a batch. Runs naming an unknown pipeline or mesh
+///          are dropped. The items are split into tasks that count their runs and batches in parallel,
+///          then write them at the offsets of a prefix sum, so the output does not depend on the worker
+///          count and is identical byte for byte to a serial build.
+/// @~japanese
+/// @brief ソート済みの描画キューからの詰め込んだExecuteIndirect引数の生成
+/// @details 等しいステートを持つ要素の連続は直接発行と全く同じく1つのレコードとなり、パイプラインの
+///          連続するレコードはバッチとなる。未知のパイプラインまたはメッシュを参照する連続は除く。要素は
+///          タスクに分割し、連続とバッチを並列に数えた後にプレフィックス和のオフセットへ書き込む為、
+///          出力はワーカー数に依存せず、直列の生成とバイト単位で一致する
+class IndirectDrawBuilder {
+public:
+    /// @~english
+    /// @brief Build the records and batches
+    /// @param[in] desc Inputs
+    /// @param[in] jobSystem Job system running the tasks, nullptr to build on the calling thread
+    /// @param[out] dstRecords Records, room for itemCount of them
+    /// @param[out] dstBatches Batches, room for itemCount of them
+    /// @param[out] dstResult Number of records, batches and instances
+    /// @~japanese
+    /// @brief レコードとバッチを生成
+    /// @param[in] desc 入力
+    /// @param[in] jobSystem タスクを実行するJobSystem、nullptrの場合は呼び出し元のスレッドで生成する
+    /// @param[out] dstRecords レコード、itemCount個分の領域
+    /// @param[out] dstBatches バッチ、itemCount個分の領域
+    /// @param[out] dstResult レコード数、バッチ数、インスタンス数
+    static void Build(const IndirectDrawBuildDesc &desc, JobSystem *jobSystem, IndirectDrawRecord *dstRecords, IndirectDrawBatch *dstBatches, IndirectDrawBuildResult *dstResult);
+};
@@ -0,0 +1,68 @@
+/// @file InputQueue.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "InputQueue.h"
+
+//----------------------------------------------------------------------------------------------------
+// InputQueue
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+InputQueue::InputQueue()
+: readPosition(0)
+, writePosition(0)
+, droppedCount(0)
+{
+    ;
+}
+
+// Push an event
+// イベントを追加
+bool InputQueue::Push(const InputEvent &event) {
+    const UINT position = writePosition.load(std::memory_order_relaxed);
+    if (position - readPosition.load(std::memory_order_acquire) == DEFAULT_INPUT_QUEUE_CAPACITY) {
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Publish the slot only once it is written
+    // スロットは書き込み後に公開する
+    events[position & (DEFAULT_INPUT_QUEUE_CAPACITY - 1)] = event;
+    writePosition.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+// Pop the oldest events
+// 最も古いイベントを取り出す
+UINT InputQueue::Pop(InputEvent *dstEvents, UINT maxCount) {
+    const UINT position = readPosition.load(std::memory_order_relaxed);
+    const UINT count    = std::min(writePosition.load(std::memory_order_acquire) - position, maxCount);
+    for (UINT i = 0; i < count; ++i) {
+        dstEvents[i] = events[(position + i) & (DEFAULT_INPUT_QUEUE_CAPACITY - 1)];
+    }
+
+    // Hand the slots back to the producer once they are read
+    // スロットは読み込み後に生産者へ返す
+    readPosition.store(position + count, std::memory_order_release);
+    return count;
+}
+
+//----------------------------------------------------------------------------------------------------
+// InputLatencyTracker
+//----------------------------------------------------------------------------------------------------
+// The last submitted frame was presented
+// 最後に発行したフレームを表示した
+void InputLatencyTracker::OnFramePresented(INT64 timestamp) {
+    if (submittedStamp.eventCount != 0) {
+        const float queueTimeInMs = static_cast<float>(submittedStamp.consumeTimestamp - submittedStamp.oldestTimestamp) / 1000000.0f;
+        const float latencyInMs   = static_cast<float>(timestamp - submittedStamp.oldestTimestamp) / 1000000.0f;
+        stats.frameCount++;
+        stats.eventCount      += submittedStamp.eventCount;
+        stats.queueTimeInMs   += queueTimeInMs;
+        stats.maxQueueTimeInMs = std::max(stats.maxQueueTimeInMs, queueTimeInMs);
+        stats.latencyInMs     += latencyInMs;
+        stats.maxLatencyInMs   = std::max(stats.maxLatencyInMs, latencyInMs);
+    }
+    submittedStamp = InputFrameStamp();
+}
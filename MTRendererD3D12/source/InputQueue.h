@@ -0,0 +1,249 @@
+/// @file InputQueue.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+// Default value
+const UINT   DEFAULT_INPUT_QUEUE_CAPACITY   = 1024;     // Power of two
+const UINT   DEFAULT_INPUT_DRAIN_BATCH_SIZE = 64;
+const UINT   MAX_INPUT_KEY_CODE             = 256;
+const size_t INPUT_QUEUE_CACHE_LINE_SIZE    = 64;
+
+
+/// @enum InputEventType
+enum class InputEventType : UINT {
+    KeyDown,
+    KeyUp,
+    MouseMove,
+};
+
+
+/// @~english
+/// @brief Input event stamped when the platform layer received it
+/// @~japanese
+/// @brief プラットフォーム層が受け取った時刻を記録した入力イベント
+/// @~
+/// @struct InputEvent
+struct InputEvent {
+    INT64           timestamp;      ///< @~english InputQueue::GetTimestamp() at reception @~japanese 受信時のInputQueue::GetTimestamp()
+    InputEventType  type;
+    UINT            code;           ///< @~english Virtual key code of the key events @~japanese キーイベントの仮想キーコード
+    INT             x;              ///< @~english Cursor position of the mouse events @~japanese マウスイベントのカーソル位置
+    INT             y;
+};
+
+
+/// @class InputQueue
+/// @~english
+/// @brief Lock-free single producer, single consumer ring of input events
+/// @details The platform layer pushes and the MainThread pops, neither ever blocks. Events pushed while
+///          the ring is full are dropped and counted, so a stalled simulation cannot stall the window.
+///          The read and write positions sit on their own cache lines.
+/// @~japanese
+/// @brief ロックフリーの単一生産者・単一消費者の入力イベントのリング
+/// @details プラットフォーム層が追加しMainThreadが取り出す、どちらもブロックしない。リングが満杯の間に
+///          追加されたイベントは破棄して数える為、シミュレーションの停滞がウィンドウを停滞させる事はない。
+///          読み込み位置と書き込み位置はそれぞれ別のキャッシュラインに置く
+class InputQueue {
+public:
+    /// @~english
+    /// @brief Push an event, only called by the producer
+    /// @return True if the event was queued, false if the ring was full
+    /// @~japanese
+    /// @brief イベントを追加、生産者のみが呼び出す
+    /// @return イベントを追加した場合にはTrue、リングが満杯の場合はFalseを返す
+    bool Push(const InputEvent &event);
+
+    /// @~english
+    /// @brief Pop the oldest events, only called by the consumer
+    /// @param[out] dstEvents Events in the order they were pushed
+    /// @param[in] maxCount Room of dstEvents
+    /// @return Number of events popped
+    /// @~japanese
+    /// @brief 最も古いイベントを取り出す、消費者のみが呼び出す
+    /// @param[out] dstEvents 追加された順のイベント
+    /// @param[in] maxCount dstEventsの要素数
+    /// @return 取り出したイベント数
+    UINT Pop(InputEvent *dstEvents, UINT maxCount);
+
+    /// @~english
+    /// @brief Get the number of events dropped since the last call and reset it
+    /// @~japanese
+    /// @brief 前回の呼び出し以降に破棄されたイベント数を取得しリセット
+    UINT TakeDroppedCount() {
+        return droppedCount.exchange(0);
+    }
+
+    /// @~english
+    /// @brief Get the time events are stamped with, in nanoseconds of a monotonic clock shared by all threads
+    /// @~japanese
+    /// @brief イベントに記録する時刻を取得、全スレッドで共通の単調増加する時計のナノ秒
+    static INT64 GetTimestamp() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    InputQueue();
+
+private:
+    static_assert((DEFAULT_INPUT_QUEUE_CAPACITY & (DEFAULT_INPUT_QUEUE_CAPACITY - 1)) == 0, "The capacity must be a power of two");
+
+    // Positions count up forever, the slot is the position masked by the capacity
+    // 位置は増加し続け、スロットは位置を容量でマスクしたもの
+    alignas(INPUT_QUEUE_CACHE_LINE_SIZE) std::atomic<UINT>  readPosition;   ///< @~english Written by the consumer @~japanese 消費者が書き込む
+    alignas(INPUT_QUEUE_CACHE_LINE_SIZE) std::atomic<UINT>  writePosition;  ///< @~english Written by the producer @~japanese 生産者が書き込む
+    std::atomic<UINT>                                       droppedCount;
+    alignas(INPUT_QUEUE_CACHE_LINE_SIZE) InputEvent         events[DEFAULT_INPUT_QUEUE_CAPACITY];
+};
+
+
+/// @~english
+/// @brief Key and cursor state built from the events on the MainThread
+/// @~japanese
+/// @brief MainThreadでイベントから構築するキーとカーソルの状態
+/// @~
+/// @struct InputState
+struct InputState {
+    bool    keyDown[MAX_INPUT_KEY_CODE];
+    INT     cursorX;
+    INT     cursorY;
+
+    /// @brief Apply an event
+    void Apply(const InputEvent &event) {
+        switch (event.type) {
+        case InputEventType::KeyDown:
+        case InputEventType::KeyUp:
+            if (event.code < MAX_INPUT_KEY_CODE) {
+                keyDown[event.code] = (event.type == InputEventType::KeyDown);
+            }
+            break;
+        case InputEventType::MouseMove:
+            cursorX = event.x;
+            cursorY = event.y;
+            break;
+        }
+    }
+
+    bool IsKeyDown(UINT code) const {
+        return code < MAX_INPUT_KEY_CODE && keyDown[code];
+    }
+
+    /// @brief コンストラクタ
+    InputState()
+    : keyDown{}
+    , cursorX(0)
+    , cursorY(0)
+    {
+        ;
+    }
+};
+
+
+/// @~english
+/// @brief Input consumed by a MainThread frame, carried with the frame down to its presentation
+/// @~japanese
+/// @brief MainThreadのフレームが消費した入力、フレームと共にその表示まで運ぶ
+/// @~
+/// @struct InputFrameStamp
+struct InputFrameStamp {
+    UINT    eventCount;
+    INT64   oldestTimestamp;    ///< @~english Reception of the oldest event @~japanese 最も古いイベントの受信時刻
+    INT64   consumeTimestamp;   ///< @~english Start of the MainThread frame @~japanese MainThreadのフレームの開始時刻
+
+    /// @brief Add an event consumed by the frame
+    void Add(const InputEvent &event) {
+        oldestTimestamp = (eventCount == 0) ? event.timestamp : std::min(oldestTimestamp, event.timestamp);
+        eventCount++;
+    }
+
+    /// @brief コンストラクタ
+    InputFrameStamp()
+    : eventCount(0)
+    , oldestTimestamp(0)
+    , consumeTimestamp(0)
+    {
+        ;
+    }
+};
+
+
+/// @~english
+/// @brief Input latency over the frames presented since the last reset
+/// @~japanese
+/// @brief 前回のリセット以降に表示したフレームの入力レイテンシ
+/// @~
+/// @struct InputLatencyStats
+struct InputLatencyStats {
+    UINT    frameCount;         ///< @~english Presented frames that consumed input @~japanese 入力を消費して表示したフレーム
+    UINT    eventCount;
+    float   queueTimeInMs;      ///< @~english Sum of the waits of the oldest events for the MainThread @~japanese 最も古いイベントがMainThreadを待った時間の合計
+    float   maxQueueTimeInMs;
+    float   latencyInMs;        ///< @~english Sum of the times from the oldest events to the presentation @~japanese 最も古いイベントから表示までの時間の合計
+    float   maxLatencyInMs;
+
+    /// @brief コンストラクタ
+    InputLatencyStats()
+    : frameCount(0)
+    , eventCount(0)
+    , queueTimeInMs(0.0f)
+    , maxQueueTimeInMs(0.0f)
+    , latencyInMs(0.0f)
+    , maxLatencyInMs(0.0f)
+    {
+        ;
+    }
+};
+
+
+/// @class InputLatencyTracker
+/// @~english
+/// @brief Follows the input of a frame through the RenderThread stages to the present that shows it
+/// @details A frame is recorded by Render, submitted by the next PopulateCommandList and shown by the
+///          Present after that, so the stamp moves one stage per call. Only used by the RenderThread.
+/// @~japanese
+/// @brief フレームの入力をRenderThreadの各段階を通してそれを表示するPresentまで追跡する
+/// @details フレームはRenderで記録し、次のPopulateCommandListで発行し、その次のPresentで表示する為、
+///          スタンプは呼び出し毎に1段階進む。RenderThreadのみが使用する
+class InputLatencyTracker {
+public:
+    /// @~english
+    /// @brief The commands of a frame were recorded
+    /// @~japanese
+    /// @brief フレームのコマンドを記録した
+    void OnFrameRecorded(const InputFrameStamp &stamp) {
+        recordedStamp = stamp;
+    }
+
+    /// @~english
+    /// @brief The last recorded frame was submitted to the GPU
+    /// @~japanese
+    /// @brief 最後に記録したフレームをGPUへ発行した
+    void OnFrameSubmitted() {
+        submittedStamp = recordedStamp;
+        recordedStamp  = InputFrameStamp();
+    }
+
+    /// @~english
+    /// @brief The last submitted frame was presented
+    /// @param[in] timestamp InputQueue::GetTimestamp() when Present returned
+    /// @~japanese
+    /// @brief 最後に発行したフレームを表示した
+    /// @param[in] timestamp Presentから戻った時のInputQueue::GetTimestamp()
+    void OnFramePresented(INT64 timestamp);
+
+    const InputLatencyStats& GetStats() const {
+        return stats;
+    }
+
+    void ResetStats() {
+        stats = InputLatencyStats();
+    }
+
+private:
+    InputFrameStamp     recordedStamp;
+    InputFrameStamp     submittedStamp;
+    InputLatencyStats   stats;
+};
@@ -0,0 +1,186 @@
+/// @file JobSystem.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "JobSystem.h"
+
+//----------------------------------------------------------------------------------------------------
+// JobSystem
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+JobSystem::JobSystem()
+: terminate(false)
+{
+    ;
+}
+
+// Destructor
+// デストラクタ
+JobSystem::~JobSystem() {
+    Deinit();
+}
+
+// Initialize
+// 初期化
+bool JobSystem::Init(UINT workerCount, const WorkerInitFunc &inWorkerInitFunc) {
+    if (!workers.empty()) {
+        return false;
+    }
+
+    if (workerCount == 0) {
+        // Leave room for the MainThread and the RenderThread
+        // MainThreadとRenderThreadの分を空けておく
+        const UINT hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = (2 < hardwareThreads) ? hardwareThreads - 2 : 1;
+    }
+
+    // The arenas are made first, a worker sets its own one before it takes jobs
+    // アリーナを先に作成し、ワーカーはジョブを取る前に自身のアリーナをセットする
+    workerArenas.reserve(workerCount);
+    for (UINT i = 0; i < workerCount; ++i) {
+        workerArenas.push_back(std::make_unique<ScratchArena>());
+        if (!workerArenas.back()->Init(DEFAULT_WORKER_SCRATCH_ARENA_SIZE)) {
+            workerArenas.clear();
+            return false;
+        }
+    }
+
+    terminate      = false;
+    workerInitFunc = inWorkerInitFunc;
+    workers.reserve(workerCount);
+    for (UINT i = 0; i < workerCount; ++i) {
+        workers.emplace_back(WorkerThreadFunc, this, i);
+    }
+
+    return true;
+}
+
+// Deinitialize
+// 終了処理
+void JobSystem::Deinit() {
+    {
+        std::lock_guard<std::mutex> lock(queueMtx);
+        terminate = true;
+    }
+    queueCond.notify_all();
+
+    for (auto &worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+    workerArenas.clear();
+    workerInitFunc = nullptr;
+}
+
+// Run func over [0, count) split into batches and wait for completion
+// [0, count)をバッチに分割してfuncを実行し、完了を待つ
+void JobSystem::ParallelFor(UINT count, UINT batchSize, BatchFunc func) {
+    if (count == 0) {
+        return;
+    }
+    batchSize = std::max(batchSize, 1u);
+
+    // Run on the calling thread when there is nothing to share
+    // 分配する必要が無い場合は呼び出し元スレッドで実行
+    if (workers.empty() || count <= batchSize) {
+        func(0, count);
+        return;
+    }
+
+    ParallelJob job;
+    job.func      = &func;
+    job.count     = count;
+    job.batchSize = batchSize;
+
+    {
+        std::lock_guard<std::mutex> lock(queueMtx);
+        jobQueue.push_back(&job);
+    }
+    queueCond.notify_all();
+
+    // The calling thread also takes batches
+    // 呼び出し元スレッドもバッチを実行
+    RunBatches(&job);
+
+    // Wait until all batches are done and no worker refers to the job
+    // 全バッチが完了し、ジョブを参照するワーカーが居なくなるまで待つ
+    std::unique_lock<std::mutex> lock(queueMtx);
+    auto found = std::find(jobQueue.begin(), jobQueue.end(), &job);
+    if (found != jobQueue.end()) {
+        jobQueue.erase(found);
+    }
+    doneCond.wait(lock, [&job] {
+        return job.doneCount.load() == job.count && job.refCount == 0;
+    });
+}
+
+// Run batches of the job until all of them are taken
+// 全バッチが取得されるまでジョブのバッチを実行
+void JobSystem::RunBatches(ParallelJob *job) {
+    for (;;) {
+        const UINT begin = job->nextIndex.fetch_add(job->batchSize);
+        if (job->count <= begin) {
+            break;
+        }
+        const UINT end = std::min(begin + job->batchSize, job->count);
+
+        (*job->func)(begin, end);
+
+        if (job->doneCount.fetch_add(end - begin) + (end - begin) == job->count) {
+            // Wake up the caller waiting for the last batch
+            // 最後のバッチを待つ呼び出し元を起こす
+            std::lock_guard<std::mutex> lock(queueMtx);
+            doneCond.notify_all();
+        }
+    }
+}
+
+// Worker thread function
+// ワーカースレッド処理関数
+void JobSystem::WorkerThreadFunc(JobSystem *jobSystem, UINT workerIndex) {
+    ScratchArena *arena = jobSystem->workerArenas[workerIndex].get();
+    ScratchArena::SetThreadArena(arena);
+
+    if (jobSystem->workerInitFunc) {
+        jobSystem->workerInitFunc(workerIndex);
+    }
+
+    for (;;) {
+        ParallelJob *job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(jobSystem->queueMtx);
+            jobSystem->queueCond.wait(lock, [jobSystem] {
+                return jobSystem->terminate || !jobSystem->jobQueue.empty();
+            });
+
+            if (jobSystem->jobQueue.empty()) {
+                return;
+            }
+
+            job = jobSystem->jobQueue.front();
+
+            // Remove the job from the queue once all batches are taken
+            // 全バッチが取得済みであればキューから外す
+            if (job->count <= job->nextIndex.load()) {
+                jobSystem->jobQueue.erase(jobSystem->jobQueue.begin());
+                continue;
+            }
+            job->refCount++;
+        }
+
+        jobSystem->RunBatches(job);
+
+        // Nested loops run inside the batches above, so nothing refers to the arena any more
+        // ネストしたループは上のバッチ内で実行される為、アリーナを参照するものはもう無い
+        arena->Reset();
+
+        {
+            std::lock_guard<std::mutex> lock(jobSystem->queueMtx);
+            job->refCount--;
+            jobSystem->doneCond.notify_all();
+        }
+    }
+}
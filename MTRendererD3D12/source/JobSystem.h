@@ -0,0 +1,174 @@
+/// @file JobSystem.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+#include "ScratchArena.h"
+
+// Default value
+const UINT   DEFAULT_JOB_BATCH_SIZE             = 64;
+const size_t DEFAULT_WORKER_SCRATCH_ARENA_SIZE  = 256 * 1024;
+
+
+/// @class JobSystem
+/// @~english
+/// @brief Worker thread pool which runs data parallel loops
+/// @details Each worker owns a ScratchArena set as its thread arena, so batch functions can use
+///          ScratchAllocator on any thread. The arena of a worker is reset when it leaves a loop.
+/// @~japanese
+/// @brief データ並列ループを実行するワーカースレッドプール
+/// @details 各ワーカーはスレッドのアリーナとしてセットしたScratchArenaを持つ為、バッチ関数はどのスレッドでも
+///          ScratchAllocatorを使用できる。ワーカーのアリーナはループから離れる時にリセットされる
+class JobSystem {
+public:
+    /// @~english
+    /// @brief Reference to the function called for each batch [begin, end)
+    /// @details Refers to the callable it is made from without copying it or allocating, so it is passed by value
+    ///          and must not outlive the callable. A lambda written in the call to ParallelFor lives long enough.
+    /// @~japanese
+    /// @brief バッチ[begin, end)毎に呼ばれる関数への参照
+    /// @details 作成元の呼び出し可能オブジェクトをコピーや確保をせずに参照する為、値渡しで扱い、参照先より長く
+    ///          保持してはならない。ParallelForの呼び出しの中に書いたラムダは十分に長く存在する
+    /// @~
+    /// @class BatchFunc
+    class BatchFunc {
+    public:
+        template<typename Func, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Func>, BatchFunc> && std::is_invocable_v<Func &, UINT, UINT>>>
+        BatchFunc(Func &&func)
+        : callable(const_cast<void *>(static_cast<const void *>(std::addressof(func))))
+        , invoke([](void *callable, UINT begin, UINT end) {
+            (*static_cast<std::remove_reference_t<Func> *>(callable))(begin, end);
+        })
+        {
+            ;
+        }
+
+        void operator()(UINT begin, UINT end) const {
+            invoke(callable, begin, end);
+        }
+
+    private:
+        void   *callable;
+        void  (*invoke)(void *callable, UINT begin, UINT end);
+    };
+
+    /// @~english
+    /// @brief Function called by each worker thread before it takes jobs
+    /// @~japanese
+    /// @brief 各ワーカースレッドがジョブを取る前に呼ばれる関数
+    using WorkerInitFunc = std::function<void(UINT workerIndex)>;
+
+    /// @~english
+    /// @brief Initialize
+    /// @param[in] workerCount Number of worker threads (0 to use the number of hardware threads minus the main and render threads
+    /// @param[in] workerInitFunc Function called on each worker thread, to place it on the CPU for example
+    /// @return True if initialization succeeded, false otherwise
+    /// @~japanese
+    /// @brief 初期化
+    /// @param[in] workerCount ワーカースレッド数（0の場合はハードウェアスレッド数からMain, Renderスレッド分を引いた数
+    /// @param[in] workerInitFunc 各ワーカースレッドで呼ばれる関数、CPUへの配置等に使用
+    /// @return 初期化に成功した場合にはTrue、そうでないならFalseを返す
+    bool Init(UINT workerCount, const WorkerInitFunc &workerInitFunc = nullptr);
+
+    /// @~english
+    /// @brief Deinitialize
+    /// @~japanese
+    /// @brief 終了処理
+    void Deinit();
+
+    /// @~english
+    /// @brief Run func over [0, count) split into batches and wait for completion
+    /// @param[in] count Number of items
+    /// @param[in] batchSize Number of items per batch
+    /// @param[in] func Function called for each batch, its scratch allocations are valid until it returns
+    /// @~japanese
+    /// @brief [0, count)をバッチに分割してfuncを実行し、完了を待つ
+    /// @param[in] count 要素数
+    /// @param[in] batchSize バッチあたりの要素数
+    /// @param[in] func バッチ毎に呼ばれる関数、そのアリーナからの確保は関数から戻るまで有効
+    void ParallelFor(UINT count, UINT batchSize, BatchFunc func);
+
+    /// @~english
+    /// @brief Get the number of worker threads
+    /// @~japanese
+    /// @brief ワーカースレッド数を取得
+    UINT GetWorkerCount() const {
+        return static_cast<UINT>(workers.size());
+    }
+
+    /// @~english
+    /// @brief Get the scratch arena of a worker
+    /// @details Only to read its statistics between loops, the arena is used by the worker thread.
+    /// @~japanese
+    /// @brief ワーカーのアリーナを取得
+    /// @details ループ間での統計情報の参照用、アリーナはワーカースレッドが使用する
+    const ScratchArena& GetWorkerArena(UINT workerIndex) const {
+        return *workerArenas[workerIndex];
+    }
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    JobSystem();
+
+    /// @~english
+    /// @brief Destructor
+    /// @~japanese
+    /// @brief デストラクタ
+    ~JobSystem();
+
+private:
+    /// @~english
+    /// @brief Parallel loop shared by the caller and the workers
+    /// @~japanese
+    /// @brief 呼び出し元とワーカーで共有する並列ループ
+    /// @~
+    /// @struct ParallelJob
+    struct ParallelJob {
+        const BatchFunc    *func;
+        UINT                count;
+        UINT                batchSize;
+        std::atomic<UINT>   nextIndex;
+        std::atomic<UINT>   doneCount;
+        UINT                refCount;   ///< @~english Guarded by queueMtx @~japanese queueMtxで保護
+
+        /// @brief コンストラクタ
+        ParallelJob()
+        : func(nullptr)
+        , count(0)
+        , batchSize(1)
+        , nextIndex(0)
+        , doneCount(0)
+        , refCount(0)
+        {
+            ;
+        }
+    };
+
+    /// @~english
+    /// @brief Worker thread function
+    /// @param[in] jobSystem Pointer to JobSystem
+    /// @param[in] workerIndex Index of the worker
+    /// @~japanese
+    /// @brief ワーカースレッド処理関数
+    /// @param[in] jobSystem JobSystemへのポインタ
+    /// @param[in] workerIndex ワーカーの番号
+    static void WorkerThreadFunc(JobSystem *jobSystem, UINT workerIndex);
+
+    /// @~english
+    /// @brief Run batches of the job until all of them are taken
+    /// @~japanese
+    /// @brief 全バッチが取得されるまでジョブのバッチを実行
+    void RunBatches(ParallelJob *job);
+
+private:
+    std::vector<std::thread>                    workers;
+    std::vector<std::unique_ptr<ScratchArena>>  workerArenas;
+    WorkerInitFunc                              workerInitFunc;
+    std::vector<ParallelJob *>                  jobQueue;
+    std::mutex                                  queueMtx;
+    std::condition_variable                     queueCond;
+    std::condition_variable                     doneCond;
+    bool                                        terminate;
+};
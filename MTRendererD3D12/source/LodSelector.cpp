@@ -0,0 +1,138 @@
+/// @file LodSelector.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "LodSelector.h"
+
+//----------------------------------------------------------------------------------------------------
+// LodSelector
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+LodSelector::LodSelector()
+: screenSizes()
+, screenSizeCount(0)
+, hysteresis(DEFAULT_LOD_HYSTERESIS)
+, projScale(1.0f)
+, lodBias(0.0f)
+, frameBudgetInMs(DEFAULT_LOD_FRAME_BUDGET_IN_MS)
+, smoothedFrameTimeInMs(0.0f)
+, lowThresholds()
+, highThresholds()
+{
+    SetScreenSizes(DEFAULT_LOD_SCREEN_SIZES, _countof(DEFAULT_LOD_SCREEN_SIZES));
+}
+
+// Set the screen sizes between the LODs
+// LOD間の画面サイズをセット
+void LodSelector::SetScreenSizes(const float *inScreenSizes, UINT count) {
+    assert(count < MAX_MESH_LOD_COUNT);
+
+    screenSizeCount = std::min(count, MAX_MESH_LOD_COUNT - 1);
+    for (UINT i = 0; i < screenSizeCount; i++) {
+        screenSizes[i] = inScreenSizes[i];
+    }
+    UpdateThresholds();
+}
+
+// Set the relative width of the hysteresis band around the thresholds
+// 閾値周りのヒステリシス帯の相対幅をセット
+void LodSelector::SetHysteresis(float inHysteresis) {
+    hysteresis = std::clamp(inHysteresis, 0.0f, 1.0f);
+    UpdateThresholds();
+}
+
+// Set the bias
+// バイアスをセット
+void LodSelector::SetBias(float bias) {
+    lodBias    = std::clamp(bias, 0.0f, MAX_LOD_BIAS);
+    stats.bias = lodBias;
+    UpdateThresholds();
+}
+
+// Update the bias from the time spent on the last frame
+// 前フレームに費やした時間からバイアスを更新
+void LodSelector::UpdateBias(float frameTimeInMs) {
+    if (smoothedFrameTimeInMs <= 0.0f) {
+        smoothedFrameTimeInMs = frameTimeInMs;
+    } else {
+        smoothedFrameTimeInMs += (frameTimeInMs - smoothedFrameTimeInMs) * DEFAULT_LOD_FRAME_TIME_SMOOTHING;
+    }
+    stats.frameTimeInMs = smoothedFrameTimeInMs;
+
+    if (frameBudgetInMs <= 0.0f) {
+        return;
+    }
+
+    // Step proportionally to the relative error, hold inside the dead band below the budget
+    // 相対誤差に比例して変化させ、予算以下の不感帯の中では維持する
+    const float error = smoothedFrameTimeInMs / frameBudgetInMs - 1.0f;
+    if (error > 0.0f || error < -DEFAULT_LOD_BIAS_TOLERANCE) {
+        const float bias = std::clamp(lodBias + error * DEFAULT_LOD_BIAS_GAIN, 0.0f, MAX_LOD_BIAS);
+        if (bias != lodBias) {
+            SetBias(bias);
+        }
+    }
+}
+
+// Select the LODs of instances
+// インスタンスのLODを選択
+void LodSelector::Select(UINT count, const float *viewDepths, const float *radii, UINT *lods) const {
+    const __m128 scale    = _mm_set1_ps(projScale);
+    const __m128 minDepth = _mm_set1_ps(LOD_MIN_VIEW_DEPTH);
+    const __m128 one      = _mm_set1_ps(1.0f);
+
+    UINT i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 depth = _mm_max_ps(_mm_loadu_ps(viewDepths + i), minDepth);
+        const __m128 size  = _mm_div_ps(_mm_mul_ps(_mm_loadu_ps(radii + i), scale), depth);
+
+        // Count the thresholds above the screen size on both sides of the band
+        // 帯の両側で画面サイズより大きい閾値を数える
+        __m128 coarsest = _mm_setzero_ps();
+        __m128 finest   = _mm_setzero_ps();
+        for (UINT n = 0; n < MAX_MESH_LOD_COUNT - 1; n++) {
+            coarsest = _mm_add_ps(coarsest, _mm_and_ps(_mm_cmplt_ps(size, _mm_set1_ps(lowThresholds[n])), one));
+            finest   = _mm_add_ps(finest, _mm_and_ps(_mm_cmplt_ps(size, _mm_set1_ps(highThresholds[n])), one));
+        }
+
+        // Keep the current LOD while it lies inside the band
+        // 現在のLODが帯の内側にある間は維持する
+        const __m128 current = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lods + i)));
+        const __m128 lod     = _mm_min_ps(_mm_max_ps(current, coarsest), finest);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(lods + i), _mm_cvttps_epi32(lod));
+    }
+
+    for (; i < count; i++) {
+        const float size = radii[i] * projScale / std::max(viewDepths[i], LOD_MIN_VIEW_DEPTH);
+
+        UINT coarsest = 0;
+        UINT finest   = 0;
+        for (UINT n = 0; n < MAX_MESH_LOD_COUNT - 1; n++) {
+            coarsest += (size < lowThresholds[n]) ? 1 : 0;
+            finest   += (size < highThresholds[n]) ? 1 : 0;
+        }
+        lods[i] = std::min(std::max(lods[i], coarsest), finest);
+    }
+}
+
+// Set the number of visible instances per LOD
+// LOD毎の可視インスタンス数をセット
+void LodSelector::SetInstanceCounts(const UINT *instanceCounts) {
+    for (UINT i = 0; i < MAX_MESH_LOD_COUNT; i++) {
+        stats.instanceCounts[i] = instanceCounts[i];
+    }
+}
+
+// Rebuild the biased thresholds of the hysteresis band
+// ヒステリシス帯のバイアス適用済みの閾値を再構築
+void LodSelector::UpdateThresholds() {
+    const float biasScale = exp2f(lodBias);
+    for (UINT n = 0; n < MAX_MESH_LOD_COUNT - 1; n++) {
+        // Unused thresholds never match, so the LOD stays below screenSizeCount
+        // 未使用の閾値は一致しないため、LODはscreenSizeCount以下に留まる
+        const float threshold = (n < screenSizeCount) ? screenSizes[n] * biasScale : 0.0f;
+        lowThresholds[n]  = threshold * (1.0f - hysteresis);
+        highThresholds[n] = threshold * (1.0f + hysteresis);
+    }
+}
@@ -0,0 +1,175 @@
+/// @file LodSelector.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+// Default value
+const UINT MAX_MESH_LOD_COUNT                   = 4;
+const UINT LOD_SELECT_BLOCK_SIZE                = 64;
+const float DEFAULT_LOD_SCREEN_SIZES[]          = { 0.3f, 0.15f, 0.075f };
+const float DEFAULT_LOD_HYSTERESIS              = 0.1f;
+const float DEFAULT_LOD_FRAME_BUDGET_IN_MS      = 4.0f;
+const float DEFAULT_LOD_BIAS_TOLERANCE          = 0.1f;
+const float DEFAULT_LOD_BIAS_GAIN               = 0.05f;
+const float DEFAULT_LOD_FRAME_TIME_SMOOTHING    = 0.1f;
+const float MAX_LOD_BIAS                        = 3.0f;
+const float LOD_MIN_VIEW_DEPTH                  = 1.0e-4f;
+
+static_assert(_countof(DEFAULT_LOD_SCREEN_SIZES) == MAX_MESH_LOD_COUNT - 1, "A screen size is needed between each pair of LODs.");
+static_assert((LOD_SELECT_BLOCK_SIZE % 4) == 0, "The LOD block size must be a multiple of the SIMD width.");
+
+
+/// @~english
+/// @brief Statistics of the LOD selection
+/// @~japanese
+/// @brief LOD選択の統計情報
+/// @~
+/// @struct LodStats
+struct LodStats {
+    UINT    instanceCounts[MAX_MESH_LOD_COUNT]; ///< @~english Visible instances per LOD @~japanese LOD毎の可視インスタンス数
+    float   bias;
+    float   frameTimeInMs;                      ///< @~english Smoothed frame time driving the bias @~japanese バイアスを決める平滑化したフレーム時間
+
+    /// @brief コンストラクタ
+    LodStats()
+    : instanceCounts()
+    , bias(0.0f)
+    , frameTimeInMs(0.0f)
+    {
+        ;
+    }
+};
+
+
+/// @class LodSelector
+/// @~english
+/// @brief Screen size based mesh LOD selection with hysteresis and a frame time driven bias
+/// @details The screen size of an instance is the height of its bounding sphere on screen divided by
+///          the screen height, radius * cot(fovY / 2) / viewDepth. LOD n is used below screen size n - 1.
+///          The current LOD of an instance is kept while the screen size stays within the hysteresis band
+///          around the thresholds, so instances near a threshold do not flip every frame. The bias scales
+///          every threshold by 2^bias, it rises while the frame time is over budget and falls back once
+///          there is headroom. Selection is done four instances at a time with SSE and is thread safe.
+/// @~japanese
+/// @brief ヒステリシスとフレーム時間で決まるバイアスを持つ、画面サイズに基づくメッシュのLOD選択
+/// @details インスタンスの画面サイズは画面上の境界球の高さを画面の高さで割ったもので、
+///          radius * cot(fovY / 2) / viewDepth である。画面サイズn - 1未満でLOD nを使用する。
+///          画面サイズが閾値周りのヒステリシス帯の内側にある間は現在のLODを維持するため、閾値付近の
+///          インスタンスが毎フレーム切り替わることはない。バイアスは全ての閾値を2^bias倍し、フレーム時間が
+///          予算を超えている間は上がり、余裕ができると下がる。選択はSSEで4インスタンスずつ行い、スレッドセーフ
+class LodSelector {
+public:
+    /// @~english
+    /// @brief Set the screen sizes between the LODs
+    /// @param[in] screenSizes Descending screen sizes, screenSizes[n] separates LOD n and n + 1
+    /// @param[in] count Number of screen sizes, up to MAX_MESH_LOD_COUNT - 1
+    /// @~japanese
+    /// @brief LOD間の画面サイズをセット
+    /// @param[in] screenSizes 降順の画面サイズ、screenSizes[n]がLOD nとn + 1を分ける
+    /// @param[in] count 画面サイズの数、MAX_MESH_LOD_COUNT - 1まで
+    void SetScreenSizes(const float *screenSizes, UINT count);
+
+    /// @~english
+    /// @brief Set the relative width of the hysteresis band around the thresholds
+    /// @~japanese
+    /// @brief 閾値周りのヒステリシス帯の相対幅をセット
+    void SetHysteresis(float hysteresis);
+
+    /// @~english
+    /// @brief Set the projection scale, cot(fovY / 2) which is _22 of the projection matrix
+    /// @~japanese
+    /// @brief 射影スケールをセット、射影行列の_22であるcot(fovY / 2)
+    void SetProjectionScale(float scale) {
+        projScale = scale;
+    }
+
+    /// @~english
+    /// @brief Set the bias, clamped to [0, MAX_LOD_BIAS]
+    /// @~japanese
+    /// @brief バイアスをセット、[0, MAX_LOD_BIAS]に制限される
+    void SetBias(float bias);
+
+    /// @~english
+    /// @brief Get the bias
+    /// @~japanese
+    /// @brief バイアスを取得
+    float GetBias() const {
+        return lodBias;
+    }
+
+    /// @~english
+    /// @brief Set the frame time the bias aims at
+    /// @~japanese
+    /// @brief バイアスが目標とするフレーム時間をセット
+    void SetFrameBudget(float budgetInMs) {
+        frameBudgetInMs = budgetInMs;
+    }
+
+    /// @~english
+    /// @brief Update the bias from the time spent on the last frame
+    /// @details The bias is held while the smoothed frame time is within [1 - tolerance, 1] of the budget.
+    /// @param[in] frameTimeInMs Time of the last frame
+    /// @~japanese
+    /// @brief 前フレームに費やした時間からバイアスを更新
+    /// @details 平滑化したフレーム時間が予算の[1 - tolerance, 1]倍の範囲にある間はバイアスを維持する
+    /// @param[in] frameTimeInMs 前フレームの時間
+    void UpdateBias(float frameTimeInMs);
+
+    /// @~english
+    /// @brief Select the LODs of instances
+    /// @param[in] count Number of instances
+    /// @param[in] viewDepths View space depth of the bounding sphere centers
+    /// @param[in] radii World space radius of the bounding spheres
+    /// @param[in,out] lods LOD of the last frame on input, new LOD on output
+    /// @~japanese
+    /// @brief インスタンスのLODを選択
+    /// @param[in] count インスタンス数
+    /// @param[in] viewDepths 境界球の中心のView空間の深度
+    /// @param[in] radii ワールド空間の境界球の半径
+    /// @param[in,out] lods 入力は前フレームのLOD、出力は新しいLOD
+    void Select(UINT count, const float *viewDepths, const float *radii, UINT *lods) const;
+
+    /// @~english
+    /// @brief Get the statistics, the instance counts are filled by the caller
+    /// @~japanese
+    /// @brief 統計情報を取得、インスタンス数は呼び出し元が設定する
+    const LodStats& GetStats() const {
+        return stats;
+    }
+
+    /// @~english
+    /// @brief Set the number of visible instances per LOD
+    /// @~japanese
+    /// @brief LOD毎の可視インスタンス数をセット
+    void SetInstanceCounts(const UINT *instanceCounts);
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    LodSelector();
+
+private:
+    /// @~english
+    /// @brief Rebuild the biased thresholds of the hysteresis band
+    /// @~japanese
+    /// @brief ヒステリシス帯のバイアス適用済みの閾値を再構築
+    void UpdateThresholds();
+
+private:
+    float       screenSizes[MAX_MESH_LOD_COUNT - 1];
+    UINT        screenSizeCount;
+    float       hysteresis;
+    float       projScale;
+    float       lodBias;
+    float       frameBudgetInMs;
+    float       smoothedFrameTimeInMs;
+
+    // Thresholds with the bias applied, a LOD coarser than the current one is taken below lowThresholds
+    // and a finer one above highThresholds
+    // バイアス適用済みの閾値、lowThresholds未満で現在より粗いLOD、highThresholdsより上で細かいLODへ移る
+    float       lowThresholds[MAX_MESH_LOD_COUNT - 1];
+    float       highThresholds[MAX_MESH_LOD_COUNT - 1];
+
+    LodStats    stats;
+};
@@ -3,226 +3,71 @@
 
 #include "stdafx.h"
 #include "MTRendererD3D12.h"
+#include "MeshOptimizer.h"
+#include "MeshletBuilder.h"
 
 using namespace DirectX;
 
-//----------------------------------------------------------------------------------------------------
-// SceneActor
-//----------------------------------------------------------------------------------------------------
-// Constructor
-// RXgN^
-SceneActor::SceneActor(SceneActorType inType)
-: type(inType)
-{
-    translation = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
-    rotation    = XMVectorSet(0.0f, 0.0f, 0.0f, 0.0f);
-    scale       = XMVectorSet(1.0f, 1.0f, 1.0f, 0.0f);
-}
-
-// Destructor
-// fXgN^
-SceneActor::~SceneActor() {
-    ;
-}
-
-//----------------------------------------------------------------------------------------------------
-// TriangleSceneActor
-//----------------------------------------------------------------------------------------------------
-// Constructor
-// RXgN^
-TriangleSceneActor::TriangleSceneActor()
-: SceneActor(SceneActorType::Triangle)
-, rotSpeed(1.0f)
-, scaleSpeed(1.0f)
-, rotAngle(0.0f)
-, scaleAngle(0.0f)
-{
-    ;
-}
-
-// Destructor
-// fXgN^
-TriangleSceneActor::~TriangleSceneActor() {
-    ;
-}
-
-// Update process
-// XV
-void TriangleSceneActor::Update(float delta) {
-    // Z-axis rotaion at specified speed
-    // w葬xZ]
-    rotAngle += 360.0f * GetRotSpeed() * delta;
-    while (360.0f < rotAngle) {
-        rotAngle -= 360.0f;
-    }
-    rotation = XMVectorSetZ(rotation, rotAngle);
-
-    // Zoom in and out at 0.5 to 2.5 times
-    // 0.5`2.5{Ŋgk
-    scaleAngle += 2.0f * XM_PI * GetScaleSpeed() * delta;
-    while ((2.0f * XM_PI) < scaleAngle) {
-        scaleAngle -= 2.0f * XM_PI;
-    }
-    float s = std::sinf(scaleAngle) + 1.5f;
-    scale = XMVectorSet(s, s, s, 0.0f);
-}
-
-//----------------------------------------------------------------------------------------------------
-// CameraSceneActor
-//----------------------------------------------------------------------------------------------------
-// Constructor
-// RXgN^
-CameraSceneActor::CameraSceneActor()
-: SceneActor(SceneActorType::Camera) 
-, screenWidth(0)
-, screenHeight(0)
-, fovInDeg(0.0f) 
-{
-    translation = XMVectorSet(0.0f, 0.0f, -5.0f, 1.0f);
-    rotation    = XMVectorSet(0.0f, 0.0f, 0.0f, 0.0f);
-    scale       = XMVectorSet(1.0f, 1.0f, 1.0f, 0.0f);
-
-    cameraEye = XMVectorSet(0.0f, 0.0f, 0.0f, 0.0f);
-    cameraAt  = XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f);
-    cameraUp  = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
-}
-
-// Destructor
-// fXgN^
-CameraSceneActor::~CameraSceneActor() {
-    ;
-}
-
-// Update process
-// XV
-void CameraSceneActor::Update(float delta) {
-    // Jp[^
-    // ʒu:   (0.0f, 0.0f, 0.0f)
-    // O: (0.0f, 0.0f, 1.0f)
-    // : (0.0f, 1.0f, 0.0f)
-    // Ƃĉ]Kp
-    const float d2r = XM_PI / 180.0f;
-    XMMATRIX rotMtx = XMMatrixRotationRollPitchYawFromVector(XMVectorMultiply(rotation, XMVectorSet(d2r, d2r, d2r, 0.0f)));
-    XMVECTOR dirVec = XMVector3Transform(XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), rotMtx);
-    XMVECTOR upVec  = XMVector3Transform(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), rotMtx);
-
-    cameraEye = translation;
-    cameraAt  = XMVectorAdd(cameraEye, dirVec);
-    cameraUp  = upVec;
-}
-
-// Initialization process
-/// 
-bool CameraSceneActor::Init(const UINT width, const UINT height, const float degFov) {
-    screenWidth  = width;
-    screenHeight = height;
-    fovInDeg     = degFov;
-
-    return true;
-}
-
-//----------------------------------------------------------------------------------------------------
-// SceneProxy
-//----------------------------------------------------------------------------------------------------
-// Constructor
-// RXgN^
-SceneProxy::SceneProxy(SceneProxyType inType)
-: type(inType)
-{
-    ;
-}
-
-// Destructor
-// fXgN^
-SceneProxy::~SceneProxy() {
-    ;
-}
-
-//----------------------------------------------------------------------------------------------------
-// TriangleSceneProxy
-//----------------------------------------------------------------------------------------------------
-// Constructor
-// RXgN^
-TriangleSceneProxy::TriangleSceneProxy()
-: SceneProxy(SceneProxyType::Triangle)
-{
-    ;
-}
-
-// Destructor
-// fXgN^
-TriangleSceneProxy::~TriangleSceneProxy() {
-    ;
-}
-
-// Transfer render information from Actor to Proxy
-// ActorProxy֕``B
-void TriangleSceneProxy::Commit(SceneActor *actor) {
-    auto triSceneActor = static_cast<TriangleSceneActor*>(actor);
-
-    // WorldϊsZo
-    const float d2r = XM_PI / 180.0f; // Degree to Radian
-    XMMATRIX scaleMtx = XMMatrixScalingFromVector(triSceneActor->scale);
-    XMMATRIX rotMtx   = XMMatrixRotationRollPitchYawFromVector(XMVectorMultiply(triSceneActor->rotation, XMVectorSet(d2r, d2r, d2r, 0.0f)));
-    XMMATRIX transMtx = XMMatrixTranslationFromVector(triSceneActor->translation);
-    worldMtx = XMMatrixMultiply(XMMatrixMultiply(scaleMtx, rotMtx), transMtx);
-}
-
-//----------------------------------------------------------------------------------------------------
-// CameraSceneProxy
-//----------------------------------------------------------------------------------------------------
-// Constructor
-// RXgN^
-CameraSceneProxy::CameraSceneProxy()
-: SceneProxy(SceneProxyType::Camera)
-{
-    ;
-}
-
-// Destructor
-// fXgN^
-CameraSceneProxy::~CameraSceneProxy() {
-    ;
-}
-
-// Transfer render information from Actor to Proxy
-// ActorProxy֕``B
-void CameraSceneProxy::Commit(SceneActor *actor) {
-    auto cameraSceneActor = static_cast<CameraSceneActor*>(actor);
-
-    viewport.TopLeftX = 0.0f;
-    viewport.TopLeftY = 0.0f;
-    viewport.Width    = static_cast<float>(cameraSceneActor->screenWidth);
-    viewport.Height   = static_cast<float>(cameraSceneActor->screenHeight);
-    viewport.MinDepth = D3D12_MIN_DEPTH;
-    viewport.MaxDepth = D3D12_MAX_DEPTH;
-
-    scissorRect.left   = 0;
-    scissorRect.top    = 0;
-    scissorRect.right  = cameraSceneActor->screenWidth;
-    scissorRect.bottom = cameraSceneActor->screenHeight;
-
-    const float aspectRatio = static_cast<float>(cameraSceneActor->screenWidth) / static_cast<float>(cameraSceneActor->screenHeight);
-    const float fovAngleY   = cameraSceneActor->fovInDeg * XM_PI / 180.0f;
-
-    viewMtx = XMMatrixTranspose(XMMatrixLookAtLH(cameraSceneActor->cameraEye, cameraSceneActor->cameraAt, cameraSceneActor->cameraUp));
-    projMtx = XMMatrixTranspose(XMMatrixPerspectiveFovLH(fovAngleY, aspectRatio, 0.01f, 1000.0f));
+namespace {
+// Bake the motion of TriangleSceneActor::Update over one scale period, which is a whole number of turns at the default speeds
+// TriangleSceneActor::Updateの動きを拡縮の1周期分焼き込む、デフォルトの速度では回転も整数周になる
+void BakeTriangleMotion(float rotSpeed, float scaleSpeed, AnimationClipSource *dstSource) {
+    const float duration = 1.0f / scaleSpeed;
+    const UINT frameCount = static_cast<UINT>(duration * dstSource->sampleRate + 0.5f) + 1;
+
+    dstSource->translations.assign(frameCount, XMFLOAT3(0.0f, 0.0f, 0.0f));
+    dstSource->rotations.resize(frameCount);
+    dstSource->scales.resize(frameCount);
+    for (UINT i = 0; i < frameCount; ++i) {
+        const float time = static_cast<float>(i) / dstSource->sampleRate;
+        const float s = std::sinf(2.0f * XM_PI * scaleSpeed * time) + 1.5f;
+        XMStoreFloat4(&dstSource->rotations[i], XMQuaternionRotationRollPitchYaw(0.0f, 0.0f, 2.0f * XM_PI * rotSpeed * time));
+        dstSource->scales[i] = XMFLOAT3(s, s, s);
+    }
 }
-
+} // namespace ""
 
 //----------------------------------------------------------------------------------------------------
 // MTRenderer
 //----------------------------------------------------------------------------------------------------
-// CEBhEbZ[Wnh
+// メインウィンドウ向けメッセージハンドラ
 LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) {
+    // Input is stamped on arrival and queued without waiting on the MainThread or the RenderThread
+    // 入力は到着時に時刻を記録し、MainThreadとRenderThreadを待たずにキューへ追加する
+    MTRenderer *renderer = reinterpret_cast<MTRenderer *>(GetWindowLongPtr(hWnd, GWLP_USERDATA));
+    InputEvent inputEvent = {};
+    inputEvent.timestamp = InputQueue::GetTimestamp();
+
     switch (message) {
     case WM_CREATE:
+        SetWindowLongPtr(hWnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(reinterpret_cast<LPCREATESTRUCT>(lParam)->lpCreateParams));
         break;
 
     case WM_KEYDOWN:
+        // Auto-repeats carry no new state
+        // オートリピートは新しい状態を持たない
+        if (renderer != nullptr && (lParam & (1 << 30)) == 0) {
+            inputEvent.type = InputEventType::KeyDown;
+            inputEvent.code = static_cast<UINT>(wParam);
+            renderer->PushInputEvent(inputEvent);
+        }
         break;
 
     case WM_KEYUP:
+        if (renderer != nullptr) {
+            inputEvent.type = InputEventType::KeyUp;
+            inputEvent.code = static_cast<UINT>(wParam);
+            renderer->PushInputEvent(inputEvent);
+        }
+        break;
+
+    case WM_MOUSEMOVE:
+        if (renderer != nullptr) {
+            inputEvent.type = InputEventType::MouseMove;
+            inputEvent.x    = static_cast<INT>(static_cast<short>(LOWORD(lParam)));
+            inputEvent.y    = static_cast<INT>(static_cast<short>(HIWORD(lParam)));
+            renderer->PushInputEvent(inputEvent);
+        }
         break;
 
     case WM_DESTROY:
@@ -237,7 +82,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 }
 
 // Constructor
-// RXgN^
+// コンストラクタ
 MTRenderer::MTRenderer(HINSTANCE hInstance, int nCmdShow)
 : renderTheadReady(false)
 , mainTheadReady(false)
@@ -250,31 +95,38 @@ MTRenderer::MTRenderer(HINSTANCE hInstance, int nCmdShow)
 , backBufferIndex(0)
 , backBufferCount(0)
 , fenceEvent(nullptr)
+, mainThreadArenaIndex(0)
+, renderFrameCount(0)
+, timestampFrequency(0)
+, readbackFootprint{}
+, readbackBufferSize(0)
+, requestedReadbackCount(0)
+, feedActorCount(0)
 {
     ;
 }
 
 // Destructor
-// fXgN^
+// デストラクタ
 MTRenderer::~MTRenderer() {
     ;
 }
 
 // Initialize
-// 
+// 初期化処理
 bool MTRenderer::Init() {
     return Init(DEFAULT_CANVAS_WIDTH, DEFAULT_CANVAS_HEIGHT, DEFAULT_FRAME_COUNT, L"Multi-Threaded Renderer");
 }
 
 // Initialize
-// 
+// 初期化処理
 bool MTRenderer::Init(const UINT width, const UINT height, const UINT inBackBufferCount, LPCWSTR titleStr) {
     canvasWidth     = width;
     canvasHeight    = height;
     backBufferCount = inBackBufferCount;
 
     // Initialize WindowClass
-    // WindowClass
+    // WindowClass初期化
     WNDCLASSEX wcex = { 0 };
     wcex.cbSize        = sizeof(WNDCLASSEX);
     wcex.style         = CS_HREDRAW | CS_VREDRAW;
@@ -290,7 +142,7 @@ bool MTRenderer::Init(const UINT width, const UINT height, const UINT inBackBuff
     AdjustWindowRect(&windowRect, WS_OVERLAPPEDWINDOW, FALSE);
 
     // Craete window
-    // Window
+    // Window生成
     windowHandle = CreateWindow(
         wcex.lpszClassName,
         titleStr,
@@ -302,7 +154,7 @@ bool MTRenderer::Init(const UINT width, const UINT height, const UINT inBackBuff
         nullptr,
         nullptr,
         instanceHandle,
-        nullptr);
+        this);
 
     if (windowHandle == nullptr) {
         Deinit();
@@ -319,25 +171,111 @@ bool MTRenderer::Init(const UINT width, const UINT height, const UINT inBackBuff
         return false;
     }
 
-    sceneActors.reserve(DEFAULT_SCENE_ACTOR_CAPACITY);
-    sceneProxies.reserve(DEFAULT_SCENE_PROXY_CAPACITY);
+    // Place the threads before the workers start, every thread applies its own placement.
+    // A guessed topology may name processors the process may not run on, so it is never pinned
+    // ワーカーの開始前にスレッドの配置を決める、各スレッドは自身の配置を適用する。
+    // 推測したトポロジはプロセスが実行できないプロセッサを指す場合がある為、固定しない
+    {
+        const bool detected = cpuTopology.Detect();
+
+        ThreadPlacementDesc placementDesc;
+        placementDesc.pinThreads = detected && TestFlag(GlobalFlag::EnableThreadPinning);
+        threadPlacement.Init(cpuTopology, placementDesc);
+
+        if (TestFlag(GlobalFlag::EnableStatsReport)) {
+            char reportStr[256];
+            snprintf(reportStr, sizeof(reportStr), "CpuTopology: %u logical processors, %u cores (%u performance), %u cache domains%s, threads %s\n",
+                static_cast<UINT>(cpuTopology.GetProcessors().size()), cpuTopology.GetCoreCount(), cpuTopology.GetPerformanceCoreCount(), cpuTopology.GetCacheDomainCount(),
+                detected ? "" : " (guessed)", threadPlacement.IsPinned() ? "pinned" : "not pinned");
+            OutputDebugStringA(reportStr);
+        }
+    }
+
+    const ThreadPlacement *placement = &threadPlacement;
+    if (!jobSystem.Init(0, [placement](UINT workerIndex) { placement->ApplyToCurrentThread(ThreadRole::Worker, workerIndex); })) {
+        Deinit();
+        return false;
+    }
+
+    if (!occlusionCuller.Init(DEFAULT_OCCLUSION_BUFFER_WIDTH, DEFAULT_OCCLUSION_BUFFER_HEIGHT)) {
+        Deinit();
+        return false;
+    }
+
+    if (!particleSystem.Init(DEFAULT_MAX_PARTICLE_COUNT)) {
+        Deinit();
+        return false;
+    }
+
+    if (!frameReadbackRing.Init(DEFAULT_READBACK_SLOT_COUNT, [this](UINT slotIndex, UINT64 frameNumber) { DeliverReadbackSlot(slotIndex, frameNumber); })) {
+        Deinit();
+        return false;
+    }
+
+    // Initialize the scratch arenas for transient frame data
+    // フレーム内の一時データ向けのアリーナを初期化
+    for (auto &arena : mainThreadArenas) {
+        if (!arena.Init(DEFAULT_SCRATCH_ARENA_SIZE)) {
+            Deinit();
+            return false;
+        }
+    }
+    for (UINT i = 0; i < backBufferCount; ++i) {
+        if (!frameDataArray[i].renderThreadArena.Init(DEFAULT_SCRATCH_ARENA_SIZE)) {
+            Deinit();
+            return false;
+        }
+    }
+
+    scene.Reserve(DEFAULT_SCENE_ACTOR_CAPACITY);
 
     // Initialize default camera
-    // ftHgJ
+    // デフォルトカメラを初期化
     defaultCameraActor.Init(width, height, 90.0f);
+    defaultCameraActor.SetTickGroup(TickGroup::PostUpdate);
     AddSceneActor(&defaultCameraActor);
 
     // Initialize default actor
-    // ftHg̃AN^
+    // デフォルトのアクタを初期化
     defaultTriangleActor.SetRotSpeed(1.0f);
     defaultTriangleActor.SetScaleSpeed(0.5f);
     AddSceneActor(&defaultTriangleActor);
 
+    // The default actor plays its motion as a clip and does not need to tick
+    // デフォルトのアクタは動きをクリップとして再生し、更新する必要はない
+    AnimationClipSource triangleMotion;
+    BakeTriangleMotion(defaultTriangleActor.GetRotSpeed(), defaultTriangleActor.GetScaleSpeed(), &triangleMotion);
+    if (defaultTriangleClip.Build(triangleMotion) && PlaySceneActorAnimation(&defaultTriangleActor, &defaultTriangleClip, 1.0f, true)) {
+        defaultTriangleActor.Sleep();
+    }
+
+    // Initialize default particle emitter
+    // デフォルトのパーティクルエミッタを初期化
+    ParticleEmitterDesc emitterDesc;
+    emitterDesc.velocity       = XMFLOAT3(0.0f, 1.5f, 0.0f);
+    emitterDesc.velocitySpread = 0.75f;
+    emitterDesc.acceleration   = XMFLOAT3(0.0f, -1.0f, 0.0f);
+    emitterDesc.drag           = 0.5f;
+    emitterDesc.emitRate       = 8192.0f;
+    emitterDesc.startColor     = XMFLOAT4(1.0f, 0.8f, 0.3f, 1.0f);
+    emitterDesc.endColor       = XMFLOAT4(1.0f, 0.2f, 0.0f, 0.0f);
+    emitterDesc.capacity       = 32768;
+    particleSystem.CreateEmitter(emitterDesc);
+
+    // Static scenes keep their draw sequences, replay them from bundles by default
+    // 静的なシーンは描画の並びを保つ為、デフォルトでバンドルから再生する
+    SetFlag(GlobalFlag::EnableBundleCache);
+
+    // Hold the GPU frame budget by scaling the render resolution
+    // 描画解像度をスケールしてGPUのフレーム予算を保つ
+    resolutionController.Init(DynamicResolutionDesc());
+    SetFlag(GlobalFlag::EnableDynamicResolution);
+
     return true;
 }
 
 // Deinitialize
-// I
+// 終了処理
 void MTRenderer::Deinit() {
     SetFlag(GlobalFlag::TerminateRenderer);
 
@@ -353,15 +291,23 @@ void MTRenderer::Deinit() {
         fenceEvent = nullptr;
     }
 
-    for (size_t i = 0; i < sceneProxies.size(); ++i) {
-        auto proxy = sceneProxies[i];
-        delete proxy;
-        sceneProxies[i] = nullptr;
-    }
+    scene.Clear();
+    renderQueue.SetArena(nullptr);
+    occlusionCuller.Deinit();
+    bundleCache.Deinit();
+    frameReadbackRing.Deinit();
+    sceneFeed.Close();
+    feedActors.reset();
+    feedActorCount = 0;
+    feedActorSpawned.clear();
+    frameRecorder.Close();
+    frameReplay.Close();
+
+    jobSystem.Deinit();
 }
 
 // Run the MTRenderer
-// MTRenderers
+// MTRendererを実行
 int MTRenderer::Run() {
     mainThread   = std::thread(MainThreadFunc, this);
     renderThread = std::thread(RenderThreadFunc, this);
@@ -379,31 +325,39 @@ int MTRenderer::Run() {
 }
 
 // Set the specified flag
-// w肵tOZbg
+// 指定したフラグをセット
 void MTRenderer::SetFlag(const GlobalFlag flag) {
     flags |= static_cast<UINT>(flag);
 }
 
 // Clear the specified flag
-// w肵tONA
+// 指定したフラグをクリア
 void MTRenderer::ClearFlag(const GlobalFlag flag) {
     flags &= ~static_cast<UINT>(flag);
 }
 
 // Test the specified flag
-// w肵tOZbgĂ邩ׂ
+// 指定したフラグがセットされているか調べる
 bool MTRenderer::TestFlag(const GlobalFlag flag) {
     return (flags & static_cast<UINT>(flag)) != 0;
 }
 
-// Add actor
-// AN^ǉ
-void MTRenderer::AddSceneActor(SceneActor *actor) {
-    if (actor == nullptr) {
-        return;
-    }
+// Play an animation clip on an actor, replacing the one playing
+// アクタにアニメーションクリップを再生、再生中のものは置き換える
+bool MTRenderer::PlaySceneActorAnimation(SceneActor *actor, const AnimationClip *clip, float speed, bool loop) {
+    return scene.PlayAnimation(actor, clip, speed, loop);
+}
+
+// Stop the animation of an actor, its translation, rotation and scale apply again
+// アクタのアニメーションを停止、平行移動、回転、スケールが再び適用される
+void MTRenderer::StopSceneActorAnimation(SceneActor *actor) {
+    scene.StopAnimation(actor);
+}
 
-    sceneActors.push_back(actor);
+// Attach an actor to a parent actor
+// アクタを親アクタへ接続
+bool MTRenderer::AttachSceneActor(SceneActor *child, SceneActor *parent) {
+    return scene.AttachActor(child, parent);
 }
 
 namespace {
@@ -432,97 +386,293 @@ void SetThreadName(LPCSTR name, DWORD threadId) {
         ;
     }
 }
+
+// Create a buffer on the upload heap and transfer the data (nullptr to leave it uninitialized
+// UploadHeapにバッファを生成しデータを転送（nullptrの場合は初期化しない
+bool CreateUploadBuffer(ID3D12Device *device, const void *data, UINT size, ComPtr<ID3D12Resource> *dstResource) {
+    D3D12_HEAP_PROPERTIES d3dHeapProp;
+    d3dHeapProp.Type                 = D3D12_HEAP_TYPE_UPLOAD;
+    d3dHeapProp.CPUPageProperty      = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+    d3dHeapProp.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+    d3dHeapProp.CreationNodeMask     = 1;
+    d3dHeapProp.VisibleNodeMask      = 1;
+
+    D3D12_RESOURCE_DESC d3dResDesc;
+    d3dResDesc.Dimension          = D3D12_RESOURCE_DIMENSION_BUFFER;
+    d3dResDesc.Alignment          = 0;
+    d3dResDesc.Width              = size;
+    d3dResDesc.Height             = 1;
+    d3dResDesc.DepthOrArraySize   = 1;
+    d3dResDesc.MipLevels          = 1;
+    d3dResDesc.Format             = DXGI_FORMAT_UNKNOWN;
+    d3dResDesc.SampleDesc.Count   = 1;
+    d3dResDesc.SampleDesc.Quality = 0;
+    d3dResDesc.Layout             = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+    d3dResDesc.Flags              = D3D12_RESOURCE_FLAG_NONE;
+
+    if (FAILED(device->CreateCommittedResource(&d3dHeapProp, D3D12_HEAP_FLAG_NONE, &d3dResDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(dstResource->ReleaseAndGetAddressOf())))) {
+        return false;
+    }
+
+    if (data == nullptr) {
+        return true;
+    }
+
+    // Transfer data
+    // データ転送
+    void *dst = nullptr;
+    D3D12_RANGE range = { 0, 0 };
+    (*dstResource)->Map(0, &range, &dst);
+    if (dst != nullptr) {
+        memcpy(dst, data, size);
+    }
+    (*dstResource)->Unmap(0, nullptr);
+
+    return true;
+}
+
+// Create the command signature of IndirectDrawRecord, the draw constants (b1) followed by an indexed draw
+// IndirectDrawRecordのCommandSignatureを生成、描画定数（b1）とそれに続くインデックス描画
+bool CreateIndirectDrawSignature(ID3D12Device *device, ID3D12RootSignature *rootSignature, ComPtr<ID3D12CommandSignature> *dstSignature) {
+    D3D12_INDIRECT_ARGUMENT_DESC argumentDescs[2] = {};
+    argumentDescs[0].Type                             = D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT;
+    argumentDescs[0].Constant.RootParameterIndex      = 1;
+    argumentDescs[0].Constant.DestOffsetIn32BitValues = 0;
+    argumentDescs[0].Constant.Num32BitValuesToSet     = 1;
+    argumentDescs[1].Type                             = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
+
+    D3D12_COMMAND_SIGNATURE_DESC signatureDesc = {};
+    signatureDesc.ByteStride       = sizeof(IndirectDrawRecord);
+    signatureDesc.NumArgumentDescs = _countof(argumentDescs);
+    signatureDesc.pArgumentDescs   = argumentDescs;
+    signatureDesc.NodeMask         = 0;
+
+    return SUCCEEDED(device->CreateCommandSignature(&signatureDesc, rootSignature, IID_PPV_ARGS(dstSignature->ReleaseAndGetAddressOf())));
+}
+
+// Build the default triangle split into 4^level triangles, the colors are interpolated so every level looks the same
+// デフォルトの三角形を4^level個の三角形に分割して構築、色は補間する為どのレベルも同じ見た目になる
+void BuildSubdividedTriangle(UINT level, MeshData *dstMeshData) {
+    const MeshVertex corners[3] =
+    {
+        { { +0.0f, +0.5773503f, 0.0f }, { 1.0f, 0.0f, 0.0f, 1.0f } },
+        { { +0.5f, -0.2886751f, 0.0f }, { 0.0f, 1.0f, 0.0f, 1.0f } },
+        { { -0.5f, -0.2886751f, 0.0f }, { 0.0f, 0.0f, 1.0f, 1.0f } }
+    };
+
+    // Vertex (row, column) lies at barycentric (1 - row / n, (row - column) / n, column / n)
+    // 頂点(row, column)は重心座標(1 - row / n, (row - column) / n, column / n)に位置する
+    const UINT segmentCount = 1u << level;
+    auto vertexIndex = [](UINT row, UINT column) {
+        return row * (row + 1) / 2 + column;
+    };
+
+    dstMeshData->vertices.clear();
+    dstMeshData->indices.clear();
+    for (UINT row = 0; row <= segmentCount; ++row) {
+        for (UINT column = 0; column <= row; ++column) {
+            const float weights[3] = {
+                1.0f - static_cast<float>(row) / segmentCount,
+                static_cast<float>(row - column) / segmentCount,
+                static_cast<float>(column) / segmentCount };
+
+            MeshVertex vertex = {};
+            for (UINT corner = 0; corner < 3; ++corner) {
+                for (UINT i = 0; i < 3; ++i) {
+                    vertex.pos[i] += corners[corner].pos[i] * weights[corner];
+                }
+                for (UINT i = 0; i < 4; ++i) {
+                    vertex.color[i] += corners[corner].color[i] * weights[corner];
+                }
+            }
+            dstMeshData->vertices.push_back(vertex);
+        }
+    }
+
+    // Keep the clockwise winding of the source triangle
+    // 元の三角形の時計回りの巻き順を維持
+    for (UINT row = 0; row < segmentCount; ++row) {
+        for (UINT column = 0; column <= row; ++column) {
+            dstMeshData->indices.insert(dstMeshData->indices.end(), { vertexIndex(row, column), vertexIndex(row + 1, column), vertexIndex(row + 1, column + 1) });
+            if (column < row) {
+                dstMeshData->indices.insert(dstMeshData->indices.end(), { vertexIndex(row, column), vertexIndex(row + 1, column + 1), vertexIndex(row, column + 1) });
+            }
+        }
+    }
+}
+
+// Accumulate the frame time of a thread and report its spread periodically if report is set
+// スレッドのフレーム時間を集計し、reportがセットされている場合はそのばらつきを定期的に出力
+void ReportFrameTime(const char *threadName, const ThreadPlacement &placement, bool report, float timeInMs, FrameTimeStats *stats) {
+    stats->Add(timeInMs);
+    if (stats->frameCount < DEFAULT_RENDER_STATS_INTERVAL) {
+        return;
+    }
+
+    if (report) {
+        char reportStr[256];
+        snprintf(reportStr, sizeof(reportStr), "FrameTime %s: mean %.3f ms, stddev %.3f ms, max %.3f ms (%s)\n",
+            threadName, stats->GetMeanInMs(), stats->GetStdDevInMs(), stats->maxTimeInMs, placement.IsPinned() ? "pinned" : "not pinned");
+        OutputDebugStringA(reportStr);
+    }
+    *stats = FrameTimeStats();
+}
+
+// Scale a viewport to the part of the scene target drawn at the render scale
+// ビューポートを描画スケールで描画するシーンターゲットの部分へスケーリング
+D3D12_VIEWPORT ScaleViewport(const D3D12_VIEWPORT &viewport, float scale) {
+    D3D12_VIEWPORT scaledViewport = viewport;
+    scaledViewport.TopLeftX = viewport.TopLeftX * scale;
+    scaledViewport.TopLeftY = viewport.TopLeftY * scale;
+    scaledViewport.Width    = viewport.Width * scale;
+    scaledViewport.Height   = viewport.Height * scale;
+    return scaledViewport;
+}
+
+// Scale a rectangle to the part of the scene target drawn at the render scale
+// 矩形を描画スケールで描画するシーンターゲットの部分へスケーリング
+D3D12_RECT ScaleRect(const D3D12_RECT &rect, float scale) {
+    D3D12_RECT scaledRect;
+    scaledRect.left   = static_cast<LONG>(std::floor(rect.left * scale));
+    scaledRect.top    = static_cast<LONG>(std::floor(rect.top * scale));
+    scaledRect.right  = static_cast<LONG>(std::ceil(rect.right * scale));
+    scaledRect.bottom = static_cast<LONG>(std::ceil(rect.bottom * scale));
+    return scaledRect;
+}
 } // namespace ""
 
 // Main thread function
-// CXbh֐
+// メインスレッド処理関数
 int MTRenderer::MainThreadFunc(MTRenderer *renderer) {
     SetThreadName("MainThread", GetThreadId(renderer->mainThread.native_handle()));
+    renderer->threadPlacement.ApplyToCurrentThread(ThreadRole::Main, 0);
 
     float delta = 0.0f;
+    UINT frameCount = 0;
+    FrameTimeStats frameTimeStats;
 
     while (!renderer->TestFlag(GlobalFlag::TerminateRenderer)) {
         auto beginTime = std::chrono::system_clock::now();
 
+        // Steady state frames must not use the heap (checked in debug builds)
+        // 定常状態のフレームはヒープを使用しない（デバッグビルドで検証）
+        HeapAllocationGuard heapGuard(DEFAULT_HEAP_GUARD_WARMUP_FRAMES <= frameCount);
+        frameCount = std::min(frameCount + 1, DEFAULT_HEAP_GUARD_WARMUP_FRAMES);
+
+        // A replay drives the frame with the recorded delta instead of the measured one
+        // 再生は計測した経過時間の代わりに記録した経過時間でフレームを動かす
+        float updateDelta = delta;
+        renderer->BeginRecordedFrame(&updateDelta);
+
         // N-frame pre-update process
-        // Nt[̎OXV
+        // Nフレームの事前更新処理
+        const auto updateBeginTime = std::chrono::high_resolution_clock::now();
         renderer->PreUpdate();
 
         // N-frame update process
-        // Nt[̍XV
-        renderer->Update(delta);
+        // Nフレームの更新処理
+        renderer->Update(updateDelta);
+        const auto updateEndTime = std::chrono::high_resolution_clock::now();
+        renderer->EndRecordedFrame();
 
         // Wait until the RenderThread is ready to receive the SceneProxy
-        // RenderThreadSceneProxy󂯎\ɂȂ܂ő҂
+        // RenderThreadがSceneProxy受け取り可能になるまで待つ
         renderer->SyncRenderThread();
 
         // Transfer N-frame render information from Actor to Proxy
-        // ActorProxyNt[̕``B
+        // ActorからProxyへNフレームの描画情報を伝達
+        const auto commitBeginTime = std::chrono::high_resolution_clock::now();
         renderer->CommitSceneProxy();
+        const auto commitEndTime = std::chrono::high_resolution_clock::now();
 
         // Restart RenderThread
-        // RehderThreadĊJ
+        // RehderThread再開
         renderer->RestartRenderThread();
 
         auto endTime = std::chrono::system_clock::now();
         delta = std::chrono::duration<float>(endTime - beginTime).count();
+
+        ReportFrameTime("MainThread", renderer->threadPlacement, renderer->TestFlag(GlobalFlag::EnableStatsReport), delta * 1000.0f, &frameTimeStats);
+
+        // Time the stages for a benchmark run, which closes the window once it has its frames
+        // ベンチマーク実行の為に各段階を計測する、フレームが揃ったらウィンドウを閉じる
+        renderer->benchmark.AddSample(BenchmarkMetric::Update, std::chrono::duration<float, std::milli>(updateEndTime - updateBeginTime).count());
+        renderer->benchmark.AddSample(BenchmarkMetric::CommitSceneProxy, std::chrono::duration<float, std::milli>(commitEndTime - commitBeginTime).count());
+        if (renderer->benchmark.EndFrame(delta * 1000.0f)) {
+            PostMessage(renderer->windowHandle, WM_CLOSE, 0, 0);
+        }
     }
 
     // Avoid deadlocks
-    // fbhbN
+    // デッドロック回避
     renderer->RestartRenderThread();
 
     return 0;
 }
 
 // Render thread function
-// `Xbh֐
+// 描画スレッド処理関数
 int MTRenderer::RenderThreadFunc(MTRenderer *renderer) {
     SetThreadName("RenderThread", GetThreadId(renderer->renderThread.native_handle()));
+    renderer->threadPlacement.ApplyToCurrentThread(ThreadRole::Render, 0);
+
+    UINT frameCount = 0;
+    FrameTimeStats frameTimeStats;
 
     while (!renderer->TestFlag(GlobalFlag::TerminateRenderer)) {
+        const auto beginTime = std::chrono::high_resolution_clock::now();
+
+        // Steady state frames must not use the heap (checked in debug builds)
+        // 定常状態のフレームはヒープを使用しない（デバッグビルドで検証）
+        HeapAllocationGuard heapGuard(DEFAULT_HEAP_GUARD_WARMUP_FRAMES <= frameCount);
+        frameCount = std::min(frameCount + 1, DEFAULT_HEAP_GUARD_WARMUP_FRAMES);
+
         // Notify MainThread that the SceneProxy is ready to be received
-        // MainThreadSceneProxy󂯎\ɂȂʒm
+        // MainThreadへSceneProxyが受け取り可能になった事を通知
         renderer->RestartMainThread();
 
         // Receives N-frame render information
-        // Nt[̕`󂯎
+        // Nフレームの描画情報を受け取り
         renderer->SyncMainThread();
 
         // N-frame pre-render process
-        // Nt[̎O`揈
+        // Nフレームの事前描画処理
         renderer->PreRender();
 
         // Wait for completion of GPU processing of N-2 frames
-        // N-2t[GPU҂
+        // N-2フレームのGPU処理完了を待つ
         renderer->SyncGPU();
 
         // Wait for V-Sync and update the image
-        // ҂A摜XV
+        // 垂直同期を待ち、画像を更新
         renderer->Present();
 
         // Populate CommandList for N-1 frame
-        // N-1t[CommandListLbN
+        // N-1フレームのCommandListをキック
         renderer->PopulateCommandList();
 
         // Render N frames
-        // Nt[`
+        // Nフレームを描画
         renderer->Render();
+
+        const float frameTimeInMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - beginTime).count();
+        ReportFrameTime("RenderThread", renderer->threadPlacement, renderer->TestFlag(GlobalFlag::EnableStatsReport), frameTimeInMs, &frameTimeStats);
+        renderer->benchmark.AddSample(BenchmarkMetric::RenderFrame, frameTimeInMs);
     }
 
     // Avoid deadlocks
-    // fbhbN
+    // デッドロック回避
     renderer->RestartMainThread();
     
     // Wait for completion of last GPU process
-    // ŌGPŮ҂
+    // 最後のGPU処理の完了を待つ
     renderer->SyncGPU();
 
     return 0;
 }
 
 // Initialize devices
-// `foCX̏
+// 描画デバイスの初期化
 bool MTRenderer::InitDevices() {
 
     UINT dxgiFactoryFlags = 0;
@@ -540,7 +690,7 @@ bool MTRenderer::InitDevices() {
 #endif
 
     // Crate IDXGIFactory6
-    // IDXGIFactory6𐶐
+    // IDXGIFactory6を生成
     {
         ComPtr<IDXGIFactory4> dxgiFactory4 = nullptr;
         if (FAILED(CreateDXGIFactory2(dxgiFactoryFlags, IID_PPV_ARGS(&dxgiFactory4)))) {
@@ -555,7 +705,7 @@ bool MTRenderer::InitDevices() {
     }
 
     // Get IDXGIAdapter1
-    // IDXGIAdapter1擾
+    // IDXGIAdapter1を取得
     {
         ComPtr<IDXGIAdapter1> dxgiAdapter1 = nullptr;
 
@@ -564,24 +714,31 @@ bool MTRenderer::InitDevices() {
             DXGI_GPU_PREFERENCE_UNSPECIFIED
         };
 
+        // The software rasterizer runs the renderer on machines without a GPU, e.g. for benchmark runs of the CPU frame
+        // ソフトウェアラスタライザはGPUの無いマシンでレンダラを動かす、CPUフレームのベンチマーク実行など
+        if (TestFlag(GlobalFlag::UseWarpAdapter)) {
+            if (FAILED(dxgiFactory->EnumWarpAdapter(IID_PPV_ARGS(&dxgiAdapter1)))) {
+                return false;
+            }
+        }
+
         for (auto pref : gpuPreferences) {
+            if (dxgiAdapter1.Get() != nullptr) {
+                break;
+            }
+
             UINT adapterIdx = 0;
             while (dxgiFactory->EnumAdapterByGpuPreference(adapterIdx, pref, IID_PPV_ARGS(&dxgiAdapter1)) != DXGI_ERROR_NOT_FOUND) {
                 DXGI_ADAPTER_DESC1 desc;
                 dxgiAdapter1->GetDesc1(&desc);
 
-                if ((desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE) != 0) {
-                    continue;
-                }
-
-                if (SUCCEEDED(D3D12CreateDevice(dxgiAdapter1.Get(), D3D_FEATURE_LEVEL_12_0, _uuidof(ID3D12Device), nullptr))) {
+                if ((desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE) == 0 &&
+                    SUCCEEDED(D3D12CreateDevice(dxgiAdapter1.Get(), D3D_FEATURE_LEVEL_12_0, _uuidof(ID3D12Device), nullptr))) {
                     break;
                 }
+                dxgiAdapter1.Reset();
                 ++adapterIdx;
             }
-            if (dxgiAdapter1.Get() != nullptr) {
-                break;
-            }
         }
         if (dxgiAdapter1.Get() == nullptr) {
             return false;
@@ -590,7 +747,7 @@ bool MTRenderer::InitDevices() {
     }
 
     // Create ID3D12Device6
-    // ID3D12Device6𐶐
+    // ID3D12Device6を生成
     {
         ComPtr<ID3D12Device> device;
         if (FAILED(D3D12CreateDevice(dxgiAdapter.Get(), D3D_FEATURE_LEVEL_12_0, IID_PPV_ARGS(&device)))) {
@@ -603,7 +760,7 @@ bool MTRenderer::InitDevices() {
     }
 
     // Create command queue
-    // CommandQueue
+    // CommandQueue生成
     {
         D3D12_COMMAND_QUEUE_DESC queueDesc = {};
         queueDesc.Type     = D3D12_COMMAND_LIST_TYPE_DIRECT;
@@ -619,7 +776,7 @@ bool MTRenderer::InitDevices() {
     }
 
     // Create swap chain
-    // SwapChain
+    // SwapChain生成
     {
         DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
         swapChainDesc.Width              = canvasWidth;
@@ -645,20 +802,20 @@ bool MTRenderer::InitDevices() {
         }
 
         // Disable Alt+Enter switching
-        // Alt+Enter̐؂ւ֎~
+        // Alt+Enterの切り替えを禁止
         dxgiFactory->MakeWindowAssociation(windowHandle, DXGI_MWA_NO_ALT_ENTER);
 
         // Get the initial back buffer number
-        // ̃obNobt@ԍ擾
+        // 初期のバックバッファ番号を取得
         backBufferIndex = dxgiSwapChain->GetCurrentBackBufferIndex();
     }
 
     // Create descriptor heaps
-    // DescriptorHeap
+    // DescriptorHeap生成
     {
         D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc = {};
         rtvHeapDesc.Type           = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
-        rtvHeapDesc.NumDescriptors = backBufferCount;
+        rtvHeapDesc.NumDescriptors = backBufferCount * 2;
         rtvHeapDesc.Flags          = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
         rtvHeapDesc.NodeMask       = 0;
 
@@ -698,7 +855,7 @@ bool MTRenderer::InitDevices() {
     }
 
     // Get render targets
-    // RenderTarget擾
+    // RenderTarget取得
     {
         D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = d3dRTVHeap->GetCPUDescriptorHandleForHeapStart();
         rtvDescriptorSize = d3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
@@ -712,115 +869,316 @@ bool MTRenderer::InitDevices() {
             rtvHandle.ptr += static_cast<SIZE_T>(rtvDescriptorSize);
         }
     }
-    return true;
-}
 
-// Initialize resources
-// e탊\[X
-bool MTRenderer::InitResources() {
-    // Create vertex buffer and vertex buffer view
-    // VertexBuffer, VertexBufferView
+    // Create depth buffers, one per back buffer as each frame is recorded independently
+    // DepthBuffer生成、各フレームは独立して記録される為バックバッファ毎に1つ
     {
-        const Vertex vertices[] =
-        {
-            { { +0.0f, +0.5773503f, 0.0f }, { 1.0f, 0.0f, 0.0f, 1.0f } },
-            { { +0.5f, -0.2886751f, 0.0f }, { 0.0f, 1.0f, 0.0f, 1.0f } },
-            { { -0.5f, -0.2886751f, 0.0f }, { 0.0f, 0.0f, 1.0f, 1.0f } }
-        };
+        D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle = d3dDSVHeap->GetCPUDescriptorHandleForHeapStart();
+        dsvDescriptorSize = d3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
 
         D3D12_HEAP_PROPERTIES d3dHeapProp;
-        d3dHeapProp.Type                 = D3D12_HEAP_TYPE_UPLOAD;
+        d3dHeapProp.Type                 = D3D12_HEAP_TYPE_DEFAULT;
         d3dHeapProp.CPUPageProperty      = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
         d3dHeapProp.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
         d3dHeapProp.CreationNodeMask     = 1;
         d3dHeapProp.VisibleNodeMask      = 1;
 
         D3D12_RESOURCE_DESC d3dResDesc;
-        d3dResDesc.Dimension          = D3D12_RESOURCE_DIMENSION_BUFFER;
+        d3dResDesc.Dimension          = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
         d3dResDesc.Alignment          = 0;
-        d3dResDesc.Width              = sizeof(vertices);
-        d3dResDesc.Height             = 1;
+        d3dResDesc.Width              = canvasWidth;
+        d3dResDesc.Height             = canvasHeight;
         d3dResDesc.DepthOrArraySize   = 1;
         d3dResDesc.MipLevels          = 1;
-        d3dResDesc.Format             = DXGI_FORMAT_UNKNOWN;
+        d3dResDesc.Format             = DEFAULT_DEPTH_FORMAT;
         d3dResDesc.SampleDesc.Count   = 1;
         d3dResDesc.SampleDesc.Quality = 0;
-        d3dResDesc.Layout             = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-        d3dResDesc.Flags              = D3D12_RESOURCE_FLAG_NONE;
-
-        if (FAILED(d3dDevice->CreateCommittedResource(&d3dHeapProp, D3D12_HEAP_FLAG_NONE, &d3dResDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&vtxBuffer)))) {
-            return false;
-        }
+        d3dResDesc.Layout             = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+        d3dResDesc.Flags              = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL | D3D12_RESOURCE_FLAG_DENY_SHADER_RESOURCE;
 
-        // Transfer vertex data
-        // _f[^]
-        void *dst = nullptr;
-        D3D12_RANGE range = { 0, 0 };
-        vtxBuffer->Map(0, &range, &dst);
-        if (dst != nullptr) {
-            memcpy(dst, vertices, sizeof(vertices));
-        }
-        vtxBuffer->Unmap(0, nullptr);
-
-        vtxBufferView.BufferLocation = vtxBuffer->GetGPUVirtualAddress();
-        vtxBufferView.StrideInBytes  = sizeof(Vertex);
-        vtxBufferView.SizeInBytes    = sizeof(vertices);
-    }
+        D3D12_CLEAR_VALUE clearValue = {};
+        clearValue.Format               = DEFAULT_DEPTH_FORMAT;
+        clearValue.DepthStencil.Depth   = 1.0f;
+        clearValue.DepthStencil.Stencil = 0;
 
-    // Create root signature
-    // RootSignature
-    {
-        D3D12_ROOT_PARAMETER rootParameters[1];
-        rootParameters[0].ParameterType                       = D3D12_ROOT_PARAMETER_TYPE_CBV;
-        rootParameters[0].Descriptor.ShaderRegister           = 0;
-        rootParameters[0].Descriptor.RegisterSpace            = 0;
-        rootParameters[0].ShaderVisibility                    = D3D12_SHADER_VISIBILITY_VERTEX;
+        D3D12_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
+        dsvDesc.Format        = DEFAULT_DEPTH_FORMAT;
+        dsvDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D;
+        dsvDesc.Flags         = D3D12_DSV_FLAG_NONE;
 
-        D3D12_ROOT_SIGNATURE_DESC rootSignatureDesc = {};
-        rootSignatureDesc.NumParameters     = 1;
-        rootSignatureDesc.pParameters       = rootParameters;
-        rootSignatureDesc.NumStaticSamplers = 0;
-        rootSignatureDesc.pStaticSamplers   = nullptr;
-        rootSignatureDesc.Flags             = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
-        
-        ComPtr<ID3DBlob> sigBlob;
-        ComPtr<ID3DBlob> errBlob;
-        if (FAILED(D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &sigBlob, &errBlob))) {
-            return false;
-        }
+        for (UINT i = 0; i < backBufferCount; ++i) {
+            if (FAILED(d3dDevice->CreateCommittedResource(&d3dHeapProp, D3D12_HEAP_FLAG_NONE, &d3dResDesc, D3D12_RESOURCE_STATE_DEPTH_WRITE, &clearValue, IID_PPV_ARGS(&d3dDepthBuffer[i])))) {
+                return false;
+            }
 
-        if (FAILED(d3dDevice->CreateRootSignature(0, sigBlob->GetBufferPointer(), sigBlob->GetBufferSize(), IID_PPV_ARGS(&d3dRootSignature)))) {
-            return false;
+            d3dDevice->CreateDepthStencilView(d3dDepthBuffer[i].Get(), &dsvDesc, dsvHandle);
+            dsvHandle.ptr += static_cast<SIZE_T>(dsvDescriptorSize);
         }
     }
 
-    // Create pipeline state object
-    // PipelineStateObject
+    // Create scene targets, the RTVs follow those of the back buffers and the SRVs follow the CBVs
+    // SceneTarget生成、RTVはバックバッファのものに続き、SRVはCBVに続く
     {
-        ComPtr<ID3DBlob> vsBlob;
-        ComPtr<ID3DBlob> psBlob;
+        D3D12_HEAP_PROPERTIES d3dHeapProp;
+        d3dHeapProp.Type                 = D3D12_HEAP_TYPE_DEFAULT;
+        d3dHeapProp.CPUPageProperty      = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+        d3dHeapProp.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+        d3dHeapProp.CreationNodeMask     = 1;
+        d3dHeapProp.VisibleNodeMask      = 1;
 
-        // Shader
-        {
-            UINT compileFlags = 0;
+        D3D12_RESOURCE_DESC d3dResDesc;
+        d3dResDesc.Dimension          = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+        d3dResDesc.Alignment          = 0;
+        d3dResDesc.Width              = canvasWidth;
+        d3dResDesc.Height             = canvasHeight;
+        d3dResDesc.DepthOrArraySize   = 1;
+        d3dResDesc.MipLevels          = 1;
+        d3dResDesc.Format             = DXGI_FORMAT_R8G8B8A8_UNORM;
+        d3dResDesc.SampleDesc.Count   = 1;
+        d3dResDesc.SampleDesc.Quality = 0;
+        d3dResDesc.Layout             = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+        d3dResDesc.Flags              = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
 
-        #if defined(_DEBUG)
-            compileFlags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-        #endif
+        D3D12_CLEAR_VALUE clearValue = {};
+        clearValue.Format   = DXGI_FORMAT_R8G8B8A8_UNORM;
+        clearValue.Color[0] = 0.3f;
+        clearValue.Color[1] = 0.3f;
+        clearValue.Color[2] = 0.3f;
+        clearValue.Color[3] = 1.0f;
 
-            WCHAR assetsPath[512];
-            DWORD size = GetModuleFileName(nullptr, assetsPath, _countof(assetsPath));
-            if (size == 0 || size == _countof(assetsPath)) {
+        const UINT srvDescriptorSize = d3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+        D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = d3dRTVHeap->GetCPUDescriptorHandleForHeapStart();
+        rtvHandle.ptr += static_cast<SIZE_T>(backBufferCount) * static_cast<SIZE_T>(rtvDescriptorSize);
+        D3D12_CPU_DESCRIPTOR_HANDLE srvHandle = d3dCBVHeap->GetCPUDescriptorHandleForHeapStart();
+        srvHandle.ptr += static_cast<SIZE_T>(DEFAULT_CBV_COUNT * backBufferCount) * static_cast<SIZE_T>(srvDescriptorSize);
+
+        for (UINT i = 0; i < backBufferCount; ++i) {
+            if (FAILED(d3dDevice->CreateCommittedResource(&d3dHeapProp, D3D12_HEAP_FLAG_NONE, &d3dResDesc, D3D12_RESOURCE_STATE_RENDER_TARGET, &clearValue, IID_PPV_ARGS(&d3dSceneTarget[i])))) {
                 return false;
             }
 
-            WCHAR *lastSlash = wcsrchr(assetsPath, L'\\');
-            if (lastSlash != nullptr) {
-                lastSlash[1] = L'\0';
-            }
-            
-            std::wstring shaderFile = assetsPath;
-            shaderFile += L"simple_shaders.hlsl";
+            d3dDevice->CreateRenderTargetView(d3dSceneTarget[i].Get(), nullptr, rtvHandle);
+            d3dDevice->CreateShaderResourceView(d3dSceneTarget[i].Get(), nullptr, srvHandle);
+            rtvHandle.ptr += static_cast<SIZE_T>(rtvDescriptorSize);
+            srvHandle.ptr += static_cast<SIZE_T>(srvDescriptorSize);
+        }
+    }
+
+    // Create timestamp queries, two per frame
+    // タイムスタンプクエリ生成、フレーム毎に2つ
+    {
+        D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+        queryHeapDesc.Type     = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+        queryHeapDesc.Count    = 2 * backBufferCount;
+        queryHeapDesc.NodeMask = 0;
+        if (FAILED(d3dDevice->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&d3dTimestampQueryHeap)))) {
+            return false;
+        }
+
+        D3D12_HEAP_PROPERTIES d3dHeapProp;
+        d3dHeapProp.Type                 = D3D12_HEAP_TYPE_READBACK;
+        d3dHeapProp.CPUPageProperty      = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+        d3dHeapProp.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+        d3dHeapProp.CreationNodeMask     = 1;
+        d3dHeapProp.VisibleNodeMask      = 1;
+
+        D3D12_RESOURCE_DESC d3dResDesc;
+        d3dResDesc.Dimension          = D3D12_RESOURCE_DIMENSION_BUFFER;
+        d3dResDesc.Alignment          = 0;
+        d3dResDesc.Width              = sizeof(UINT64) * 2 * backBufferCount;
+        d3dResDesc.Height             = 1;
+        d3dResDesc.DepthOrArraySize   = 1;
+        d3dResDesc.MipLevels          = 1;
+        d3dResDesc.Format             = DXGI_FORMAT_UNKNOWN;
+        d3dResDesc.SampleDesc.Count   = 1;
+        d3dResDesc.SampleDesc.Quality = 0;
+        d3dResDesc.Layout             = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+        d3dResDesc.Flags              = D3D12_RESOURCE_FLAG_NONE;
+
+        if (FAILED(d3dDevice->CreateCommittedResource(&d3dHeapProp, D3D12_HEAP_FLAG_NONE, &d3dResDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&d3dTimestampReadbackBuffer)))) {
+            return false;
+        }
+        if (FAILED(d3dCommandQueue->GetTimestampFrequency(&timestampFrequency))) {
+            return false;
+        }
+    }
+
+    // Create readback buffers laid out for a copy of a back buffer
+    // バックバッファのコピー向けにレイアウトした読み戻しバッファ生成
+    {
+        const D3D12_RESOURCE_DESC backBufferDesc = d3dRenderTarget[0]->GetDesc();
+        d3dDevice->GetCopyableFootprints(&backBufferDesc, 0, 1, 0, &readbackFootprint, nullptr, nullptr, &readbackBufferSize);
+
+        D3D12_HEAP_PROPERTIES d3dHeapProp;
+        d3dHeapProp.Type                 = D3D12_HEAP_TYPE_READBACK;
+        d3dHeapProp.CPUPageProperty      = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+        d3dHeapProp.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+        d3dHeapProp.CreationNodeMask     = 1;
+        d3dHeapProp.VisibleNodeMask      = 1;
+
+        D3D12_RESOURCE_DESC d3dResDesc;
+        d3dResDesc.Dimension          = D3D12_RESOURCE_DIMENSION_BUFFER;
+        d3dResDesc.Alignment          = 0;
+        d3dResDesc.Width              = readbackBufferSize;
+        d3dResDesc.Height             = 1;
+        d3dResDesc.DepthOrArraySize   = 1;
+        d3dResDesc.MipLevels          = 1;
+        d3dResDesc.Format             = DXGI_FORMAT_UNKNOWN;
+        d3dResDesc.SampleDesc.Count   = 1;
+        d3dResDesc.SampleDesc.Quality = 0;
+        d3dResDesc.Layout             = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+        d3dResDesc.Flags              = D3D12_RESOURCE_FLAG_NONE;
+
+        for (auto &d3dReadbackBufferSlot : d3dReadbackBuffer) {
+            if (FAILED(d3dDevice->CreateCommittedResource(&d3dHeapProp, D3D12_HEAP_FLAG_NONE, &d3dResDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&d3dReadbackBufferSlot)))) {
+                return false;
+            }
+        }
+        if (FAILED(d3dDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&d3dReadbackFence)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Initialize resources
+// 各種リソースを初期化
+bool MTRenderer::InitResources() {
+    // Build the LODs of the default mesh through the mesh conversion path, LOD n has 4^(MAX_MESH_LOD_COUNT - 1 - n) triangles
+    // メッシュ変換処理を通してデフォルトメッシュのLODを構築、LOD nは4^(MAX_MESH_LOD_COUNT - 1 - n)個の三角形を持つ
+    DrawMesh drawMesh;
+    drawMesh.lodCount = MAX_MESH_LOD_COUNT;
+    for (UINT lod = 0; lod < MAX_MESH_LOD_COUNT; ++lod) {
+        MeshAsset &meshAsset = triangleMeshLods[lod];
+        {
+            MeshData meshData;
+            BuildSubdividedTriangle(MAX_MESH_LOD_COUNT - 1 - lod, &meshData);
+
+            MeshOptimizeReport report;
+            if (!MeshOptimizer::Optimize(meshData, MeshOptimizeSettings(), &report)) {
+                return false;
+            }
+
+            if (TestFlag(GlobalFlag::EnableStatsReport)) {
+                char reportStr[256];
+                snprintf(reportStr, sizeof(reportStr), "MeshOptimizer: LOD %u, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f (%.3f ms)\n",
+                    lod, report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr, report.timeInMs);
+                OutputDebugStringA(reportStr);
+            }
+
+            // Meshlets are stored alongside the mesh for cluster culling
+            // クラスタカリング用にMeshletをメッシュと一緒に格納
+            MeshletData meshletData;
+            if (!MeshletBuilder::Build(meshData, DEFAULT_MESHLET_MAX_VERTICES, DEFAULT_MESHLET_MAX_PRIMITIVES, &meshletData, nullptr)) {
+                return false;
+            }
+
+            if (!meshAsset.Build(meshData, &meshletData)) {
+                return false;
+            }
+        }
+
+        // The buffer views are set when the geometry pools are built
+        // バッファのViewはジオメトリプールの構築時にセットする
+        DrawMeshLod &drawMeshLod = drawMesh.lods[lod];
+        drawMeshLod.indexCount = meshAsset.GetHeader().indexCount;
+        drawMeshLod.asset      = &meshAsset;
+    }
+
+    // Mesh index 0
+    // メッシュ番号0
+    drawMeshes.push_back(drawMesh);
+
+    if (!BuildGeometryPools()) {
+        return false;
+    }
+
+    // Create the quad every particle is expanded from
+    // 各パーティクルを展開する四角形を生成
+    {
+        const XMFLOAT2 corners[4] = { { -1.0f, +1.0f }, { +1.0f, +1.0f }, { +1.0f, -1.0f }, { -1.0f, -1.0f } };
+        const UINT16 indices[6] = { 0, 1, 2, 0, 2, 3 };
+        if (!CreateUploadBuffer(d3dDevice.Get(), corners, sizeof(corners), &particleQuadVtxBuffer)) {
+            return false;
+        }
+
+        if (!CreateUploadBuffer(d3dDevice.Get(), indices, sizeof(indices), &particleQuadIdxBuffer)) {
+            return false;
+        }
+
+        particleQuadVtxBufferView.BufferLocation = particleQuadVtxBuffer->GetGPUVirtualAddress();
+        particleQuadVtxBufferView.StrideInBytes  = sizeof(XMFLOAT2);
+        particleQuadVtxBufferView.SizeInBytes    = sizeof(corners);
+        particleQuadIdxBufferView.BufferLocation = particleQuadIdxBuffer->GetGPUVirtualAddress();
+        particleQuadIdxBufferView.SizeInBytes    = sizeof(indices);
+        particleQuadIdxBufferView.Format         = DXGI_FORMAT_R16_UINT;
+    }
+
+    // Create root signature
+    // RootSignature生成
+    {
+        D3D12_ROOT_PARAMETER rootParameters[2];
+        rootParameters[0].ParameterType                       = D3D12_ROOT_PARAMETER_TYPE_CBV;
+        rootParameters[0].Descriptor.ShaderRegister           = 0;
+        rootParameters[0].Descriptor.RegisterSpace            = 0;
+        rootParameters[0].ShaderVisibility                    = D3D12_SHADER_VISIBILITY_VERTEX;
+
+        // Draw constants, the first instance of the draw in the scene constant buffer
+        // 描画定数、シーン定数バッファ内での描画の先頭インスタンス
+        rootParameters[1].ParameterType                       = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+        rootParameters[1].Constants.ShaderRegister            = 1;
+        rootParameters[1].Constants.RegisterSpace             = 0;
+        rootParameters[1].Constants.Num32BitValues            = 1;
+        rootParameters[1].ShaderVisibility                    = D3D12_SHADER_VISIBILITY_VERTEX;
+
+        D3D12_ROOT_SIGNATURE_DESC rootSignatureDesc = {};
+        rootSignatureDesc.NumParameters     = _countof(rootParameters);
+        rootSignatureDesc.pParameters       = rootParameters;
+        rootSignatureDesc.NumStaticSamplers = 0;
+        rootSignatureDesc.pStaticSamplers   = nullptr;
+        rootSignatureDesc.Flags             = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
+        
+        ComPtr<ID3DBlob> sigBlob;
+        ComPtr<ID3DBlob> errBlob;
+        if (FAILED(D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &sigBlob, &errBlob))) {
+            return false;
+        }
+
+        if (FAILED(d3dDevice->CreateRootSignature(0, sigBlob->GetBufferPointer(), sigBlob->GetBufferSize(), IID_PPV_ARGS(&d3dRootSignature)))) {
+            return false;
+        }
+    }
+
+    // Create pipeline state object
+    // PipelineStateObject生成
+    {
+        ComPtr<ID3DBlob> vsBlob;
+        ComPtr<ID3DBlob> psBlob;
+        ComPtr<ID3DBlob> particleVSBlob;
+        ComPtr<ID3DBlob> upscaleVSBlob;
+        ComPtr<ID3DBlob> upscalePSBlob;
+
+        // Shader初期化
+        {
+            UINT compileFlags = 0;
+
+        #if defined(_DEBUG)
+            compileFlags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+        #endif
+
+            WCHAR assetsPath[512];
+            DWORD size = GetModuleFileName(nullptr, assetsPath, _countof(assetsPath));
+            if (size == 0 || size == _countof(assetsPath)) {
+                return false;
+            }
+
+            WCHAR *lastSlash = wcsrchr(assetsPath, L'\\');
+            if (lastSlash != nullptr) {
+                lastSlash[1] = L'\0';
+            }
+            
+            std::wstring shaderFile = assetsPath;
+            shaderFile += L"simple_shaders.hlsl";
 
             if (FAILED(D3DCompileFromFile(shaderFile.c_str(), nullptr, nullptr, "VSMain", "vs_5_0", compileFlags, 0, &vsBlob, nullptr))) {
                 return false;
@@ -828,10 +1186,19 @@ bool MTRenderer::InitResources() {
             if (FAILED(D3DCompileFromFile(shaderFile.c_str(), nullptr, nullptr, "PSMain", "ps_5_0", compileFlags, 0, &psBlob, nullptr))) {
                 return false;
             }
+            if (FAILED(D3DCompileFromFile(shaderFile.c_str(), nullptr, nullptr, "VSParticle", "vs_5_0", compileFlags, 0, &particleVSBlob, nullptr))) {
+                return false;
+            }
+            if (FAILED(D3DCompileFromFile(shaderFile.c_str(), nullptr, nullptr, "VSUpscale", "vs_5_0", compileFlags, 0, &upscaleVSBlob, nullptr))) {
+                return false;
+            }
+            if (FAILED(D3DCompileFromFile(shaderFile.c_str(), nullptr, nullptr, "PSUpscale", "ps_5_0", compileFlags, 0, &upscalePSBlob, nullptr))) {
+                return false;
+            }
         }
 
         // Input layout definition
-        // InputLayout`
+        // InputLayout定義
         D3D12_INPUT_ELEMENT_DESC inputElementDescs[] =
         {
             { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT,    0,  0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
@@ -851,6 +1218,7 @@ bool MTRenderer::InitResources() {
         psoDesc.PrimitiveTopologyType           = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
         psoDesc.NumRenderTargets                = 1;
         psoDesc.RTVFormats[0]                   = DXGI_FORMAT_R8G8B8A8_UNORM;
+        psoDesc.DSVFormat                       = DEFAULT_DEPTH_FORMAT;
         psoDesc.SampleDesc.Count                = 1;
         psoDesc.SampleDesc.Quality              = 0;
         psoDesc.NodeMask                        = 0;
@@ -875,8 +1243,10 @@ bool MTRenderer::InitResources() {
         }
 
         // Depth stencil state
-        psoDesc.DepthStencilState.DepthEnable                  = FALSE;
-        psoDesc.DepthStencilState.DepthWriteMask               = D3D12_DEPTH_WRITE_MASK_ZERO;
+        // LESS_EQUAL lets the opaque pass shade the pixels laid down by the depth prepass
+        // LESS_EQUALにより不透明パスは深度プリパスで書き込んだピクセルをシェーディングできる
+        psoDesc.DepthStencilState.DepthEnable                  = TRUE;
+        psoDesc.DepthStencilState.DepthWriteMask               = D3D12_DEPTH_WRITE_MASK_ALL;
         psoDesc.DepthStencilState.DepthFunc                    = D3D12_COMPARISON_FUNC_LESS_EQUAL;
         psoDesc.DepthStencilState.StencilEnable                = FALSE;
         psoDesc.DepthStencilState.StencilReadMask              = 0xff;
@@ -906,10 +1276,155 @@ bool MTRenderer::InitResources() {
         if (FAILED(d3dDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&d3dPipelineState)))) {
             return false;
         }
+
+        // Depth only variant for the depth prepass, without pixel shader and render targets
+        // 深度プリパス向けの深度のみのバリエーション、PixelShaderとRenderTarget無し
+        ComPtr<ID3D12PipelineState> d3dDepthOnlyPipelineState;
+        {
+            D3D12_GRAPHICS_PIPELINE_STATE_DESC depthOnlyDesc = psoDesc;
+            depthOnlyDesc.PS.pShaderBytecode = nullptr;
+            depthOnlyDesc.PS.BytecodeLength  = 0;
+            depthOnlyDesc.NumRenderTargets   = 0;
+            depthOnlyDesc.RTVFormats[0]      = DXGI_FORMAT_UNKNOWN;
+            depthOnlyDesc.BlendState.RenderTarget[0].RenderTargetWriteMask = 0;
+
+            if (FAILED(d3dDevice->CreateGraphicsPipelineState(&depthOnlyDesc, IID_PPV_ARGS(&d3dDepthOnlyPipelineState)))) {
+                return false;
+            }
+        }
+
+        // Particle variant, the quad corners come from slot 0 and the instances from slot 1.
+        // Blended additively and tested against the depth without writing it, so the particles need no sorting.
+        // パーティクル向けのバリエーション、四角形の角はスロット0、インスタンスはスロット1から読み込む
+        // 加算合成し、深度は書き込まずにテストのみ行う為パーティクルのソートは不要
+        {
+            D3D12_INPUT_ELEMENT_DESC particleElementDescs[] =
+            {
+                { "CORNER",            0, DXGI_FORMAT_R32G32_FLOAT,    0,  0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,   0 },
+                { "PARTICLE_POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 1,  0, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+                { "PARTICLE_SIZE",     0, DXGI_FORMAT_R32_FLOAT,       1, 12, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+                { "COLOR",             0, DXGI_FORMAT_R8G8B8A8_UNORM,  1, 16, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 }
+            };
+
+            D3D12_GRAPHICS_PIPELINE_STATE_DESC particleDesc = psoDesc;
+            particleDesc.VS.pShaderBytecode             = particleVSBlob->GetBufferPointer();
+            particleDesc.VS.BytecodeLength              = particleVSBlob->GetBufferSize();
+            particleDesc.InputLayout.pInputElementDescs = particleElementDescs;
+            particleDesc.InputLayout.NumElements        = _countof(particleElementDescs);
+            particleDesc.BlendState.RenderTarget[0].BlendEnable = TRUE;
+            particleDesc.BlendState.RenderTarget[0].SrcBlend    = D3D12_BLEND_SRC_ALPHA;
+            particleDesc.BlendState.RenderTarget[0].DestBlend   = D3D12_BLEND_ONE;
+            particleDesc.DepthStencilState.DepthWriteMask       = D3D12_DEPTH_WRITE_MASK_ZERO;
+            particleDesc.RasterizerState.CullMode               = D3D12_CULL_MODE_NONE;
+
+            if (FAILED(d3dDevice->CreateGraphicsPipelineState(&particleDesc, IID_PPV_ARGS(&d3dParticlePipelineState)))) {
+                return false;
+            }
+        }
+
+        // Upscale pipeline, a full screen triangle sampling the scene target with a bilinear filter
+        // アップスケールのパイプライン、シーンターゲットをバイリニアでサンプリングする全画面の三角形
+        {
+            D3D12_DESCRIPTOR_RANGE srvRange = {};
+            srvRange.RangeType                         = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+            srvRange.NumDescriptors                    = 1;
+            srvRange.BaseShaderRegister                = 0;
+            srvRange.RegisterSpace                     = 0;
+            srvRange.OffsetInDescriptorsFromTableStart = 0;
+
+            D3D12_ROOT_PARAMETER upscaleParameters[2];
+            upscaleParameters[0].ParameterType                       = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+            upscaleParameters[0].DescriptorTable.NumDescriptorRanges = 1;
+            upscaleParameters[0].DescriptorTable.pDescriptorRanges   = &srvRange;
+            upscaleParameters[0].ShaderVisibility                    = D3D12_SHADER_VISIBILITY_PIXEL;
+
+            // The part of the scene target holding the frame, as a UV scale and the largest UV to sample
+            // シーンターゲットのフレームを保持する部分、UVのスケールとサンプリングする最大のUV
+            upscaleParameters[1].ParameterType                       = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+            upscaleParameters[1].Constants.ShaderRegister            = 2;
+            upscaleParameters[1].Constants.RegisterSpace             = 0;
+            upscaleParameters[1].Constants.Num32BitValues            = 4;
+            upscaleParameters[1].ShaderVisibility                    = D3D12_SHADER_VISIBILITY_ALL;
+
+            D3D12_STATIC_SAMPLER_DESC samplerDesc = {};
+            samplerDesc.Filter           = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
+            samplerDesc.AddressU         = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+            samplerDesc.AddressV         = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+            samplerDesc.AddressW         = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+            samplerDesc.ComparisonFunc   = D3D12_COMPARISON_FUNC_NEVER;
+            samplerDesc.MaxLOD           = D3D12_FLOAT32_MAX;
+            samplerDesc.ShaderRegister   = 0;
+            samplerDesc.RegisterSpace    = 0;
+            samplerDesc.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+
+            D3D12_ROOT_SIGNATURE_DESC upscaleSignatureDesc = {};
+            upscaleSignatureDesc.NumParameters     = _countof(upscaleParameters);
+            upscaleSignatureDesc.pParameters       = upscaleParameters;
+            upscaleSignatureDesc.NumStaticSamplers = 1;
+            upscaleSignatureDesc.pStaticSamplers   = &samplerDesc;
+            upscaleSignatureDesc.Flags             = D3D12_ROOT_SIGNATURE_FLAG_NONE;
+
+            ComPtr<ID3DBlob> sigBlob;
+            ComPtr<ID3DBlob> errBlob;
+            if (FAILED(D3D12SerializeRootSignature(&upscaleSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &sigBlob, &errBlob))) {
+                return false;
+            }
+            if (FAILED(d3dDevice->CreateRootSignature(0, sigBlob->GetBufferPointer(), sigBlob->GetBufferSize(), IID_PPV_ARGS(&d3dUpscaleRootSignature)))) {
+                return false;
+            }
+
+            D3D12_GRAPHICS_PIPELINE_STATE_DESC upscaleDesc = psoDesc;
+            upscaleDesc.pRootSignature                 = d3dUpscaleRootSignature.Get();
+            upscaleDesc.VS.pShaderBytecode             = upscaleVSBlob->GetBufferPointer();
+            upscaleDesc.VS.BytecodeLength              = upscaleVSBlob->GetBufferSize();
+            upscaleDesc.PS.pShaderBytecode             = upscalePSBlob->GetBufferPointer();
+            upscaleDesc.PS.BytecodeLength              = upscalePSBlob->GetBufferSize();
+            upscaleDesc.InputLayout.pInputElementDescs = nullptr;
+            upscaleDesc.InputLayout.NumElements        = 0;
+            upscaleDesc.DSVFormat                      = DXGI_FORMAT_UNKNOWN;
+            upscaleDesc.DepthStencilState.DepthEnable    = FALSE;
+            upscaleDesc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ZERO;
+            upscaleDesc.RasterizerState.CullMode         = D3D12_CULL_MODE_NONE;
+
+            if (FAILED(d3dDevice->CreateGraphicsPipelineState(&upscaleDesc, IID_PPV_ARGS(&d3dUpscalePipelineState)))) {
+                return false;
+            }
+        }
+
+        // Pipeline index 0
+        // パイプライン番号0
+        DrawPipeline drawPipeline;
+        drawPipeline.d3dPipelineState          = d3dPipelineState;
+        drawPipeline.d3dDepthOnlyPipelineState = d3dDepthOnlyPipelineState;
+        drawPipeline.d3dRootSignature          = d3dRootSignature;
+        if (!CreateIndirectDrawSignature(d3dDevice.Get(), d3dRootSignature.Get(), &drawPipeline.d3dCommandSignature)) {
+            return false;
+        }
+        drawPipelines.push_back(drawPipeline);
+    }
+
+    // Record the state every frame starts from into a bundle once
+    // 全フレームの開始時のステートを一度だけバンドルへ記録
+    {
+        if (FAILED(d3dDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_BUNDLE, IID_PPV_ARGS(&d3dPrologueAllocator)))) {
+            return false;
+        }
+        if (FAILED(d3dDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_BUNDLE, d3dPrologueAllocator.Get(), d3dPipelineState.Get(), IID_PPV_ARGS(&d3dPrologueBundle)))) {
+            return false;
+        }
+        d3dPrologueBundle->SetGraphicsRootSignature(d3dRootSignature.Get());
+        d3dPrologueBundle->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        d3dPrologueBundle->Close();
+
+        // A bundle may still be executed by the frames in flight after its last use
+        // バンドルは最後の使用後も実行中のフレームから実行され得る
+        if (!bundleCache.Init(d3dDevice.Get(), DEFAULT_BUNDLE_CACHE_CAPACITY, backBufferCount)) {
+            return false;
+        }
     }
 
     // Create an initialize frame data 
-    // FrameDataA
+    // FrameData生成、初期化
     {
         D3D12_CPU_DESCRIPTOR_HANDLE cbvHandle = d3dCBVHeap->GetCPUDescriptorHandleForHeapStart();
 
@@ -917,13 +1432,13 @@ bool MTRenderer::InitResources() {
             auto &frameData = frameDataArray[i];
 
             // Create command allocator
-            // CommandAllocator
+            // CommandAllocator生成
             if (FAILED(d3dDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&frameData.d3dCommandAllocator)))) {
                 return false;
             }
 
             // Create command list
-            // CommandList
+            // CommandList生成
             {
                 if (FAILED(d3dDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, frameData.d3dCommandAllocator.Get(), d3dPipelineState.Get(), IID_PPV_ARGS(&frameData.d3dCommandList)))) {
                     return false;
@@ -931,24 +1446,24 @@ bool MTRenderer::InitResources() {
 
                 // Command lists are created in the recording state, but there is nothing to record yet.
                 // The main loop expects it to be closed, so close it now.
-                // uL^vԂȂ̂ŒɕĂ
+                // 生成時「記録中」状態なので直後に閉じておく
                 frameData.d3dCommandList->Close();
             }
 
             // Create fence
-            // Fence
+            // Fence生成
             {
                 if (FAILED(d3dDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&frameData.d3dFence)))) {
                     return false;
                 }
 
                 // Initialize fence value
-                // rptFXl
+                // 比較用フェンス値を初期化
                 frameData.fenceValue = 1;
             }
 
             // Create constant buffer
-            // ConstantBuffer
+            // ConstantBuffer生成
             {
                 D3D12_HEAP_PROPERTIES d3dHeapProp;
                 d3dHeapProp.Type                 = D3D12_HEAP_TYPE_UPLOAD;
@@ -960,7 +1475,7 @@ bool MTRenderer::InitResources() {
                 D3D12_RESOURCE_DESC d3dResDesc;
                 d3dResDesc.Dimension          = D3D12_RESOURCE_DIMENSION_BUFFER;
                 d3dResDesc.Alignment          = 0;
-                d3dResDesc.Width              = sizeof(SceneConstantBuffer);
+                d3dResDesc.Width              = sizeof(SceneConstantBuffer) * MAX_VIEW_COUNT;
                 d3dResDesc.Height             = 1;
                 d3dResDesc.DepthOrArraySize   = 1;
                 d3dResDesc.MipLevels          = 1;
@@ -981,11 +1496,17 @@ bool MTRenderer::InitResources() {
                 d3dDevice->CreateConstantBufferView(&cbvDesc, cbvHandle);
                 cbvHandle.ptr += d3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
             }
+
+            // Create the indirect arguments, every pass of every view has room for a record per instance
+            // 間接描画の引数を生成、全ビューの全パスがインスタンス毎に1レコード分の領域を持つ
+            if (!CreateUploadBuffer(d3dDevice.Get(), nullptr, sizeof(IndirectDrawRecord) * DEFAULT_INDIRECT_RECORD_CAPACITY, &frameData.d3dIndirectArgBuffer)) {
+                return false;
+            }
         }
     }
 
     // Generate an event to wait for GPU processing to complete
-    // GPU҂߂̃Cxg𐶐
+    // GPU処理完了を待つためのイベントを生成
     fenceEvent = CreateEvent(nullptr, FALSE /*ManualReset*/, FALSE /*InitialState*/, L"GPUSyncFence");
     if (fenceEvent == nullptr) {
         return false;
@@ -994,70 +1515,450 @@ bool MTRenderer::InitResources() {
     return true;
 }
 
-// OXV
+// Merge the geometry of every mesh LOD into shared vertex and index pools
+// 全メッシュのLODのジオメトリを共有の頂点プールとインデックスプールへまとめる
+bool MTRenderer::BuildGeometryPools() {
+    // Every mesh is drawn with the same input layout, the indices are widened to 32 bits
+    // 全メッシュは同じ入力レイアウトで描画し、インデックスは32bitへ拡張する
+    const UINT vertexStride = drawMeshes.empty() ? 0 : drawMeshes[0].lods[0].asset->GetHeader().vertexStride;
+    UINT vertexCount = 0;
+    UINT indexCount  = 0;
+    for (const auto &drawMesh : drawMeshes) {
+        for (UINT lod = 0; lod < drawMesh.lodCount; ++lod) {
+            const MeshAssetHeader &header = drawMesh.lods[lod].asset->GetHeader();
+            if (header.vertexStride != vertexStride) {
+                return false;
+            }
+            vertexCount += header.vertexCount;
+            indexCount  += header.indexCount;
+        }
+    }
+    if (vertexCount == 0 || indexCount == 0) {
+        return false;
+    }
+
+    if (!CreateUploadBuffer(d3dDevice.Get(), nullptr, vertexStride * vertexCount, &geometryVtxPool) ||
+        !CreateUploadBuffer(d3dDevice.Get(), nullptr, sizeof(UINT) * indexCount, &geometryIdxPool)) {
+        return false;
+    }
+
+    BYTE *dstVertices = nullptr;
+    UINT *dstIndices  = nullptr;
+    D3D12_RANGE range = { 0, 0 };
+    geometryVtxPool->Map(0, &range, reinterpret_cast<void **>(&dstVertices));
+    geometryIdxPool->Map(0, &range, reinterpret_cast<void **>(&dstIndices));
+    if (dstVertices == nullptr || dstIndices == nullptr) {
+        return false;
+    }
+
+    const D3D12_GPU_VIRTUAL_ADDRESS vtxPoolLocation = geometryVtxPool->GetGPUVirtualAddress();
+    const D3D12_GPU_VIRTUAL_ADDRESS idxPoolLocation = geometryIdxPool->GetGPUVirtualAddress();
+    indirectMeshRanges.resize(drawMeshes.size() * MAX_MESH_LOD_COUNT);
+
+    UINT vertexOffset = 0;
+    UINT indexOffset  = 0;
+    for (size_t meshIndex = 0; meshIndex < drawMeshes.size(); ++meshIndex) {
+        DrawMesh &drawMesh = drawMeshes[meshIndex];
+        for (UINT lod = 0; lod < drawMesh.lodCount; ++lod) {
+            DrawMeshLod &drawMeshLod = drawMesh.lods[lod];
+            const MeshAsset &meshAsset = *drawMeshLod.asset;
+            const MeshAssetHeader &header = meshAsset.GetHeader();
+
+            memcpy(dstVertices + static_cast<size_t>(vertexStride) * vertexOffset, meshAsset.GetVertexData(), meshAsset.GetVertexDataSize());
+            if (meshAsset.GetIndexFormat() == DXGI_FORMAT_R16_UINT) {
+                const UINT16 *srcIndices = static_cast<const UINT16 *>(meshAsset.GetIndexData());
+                std::copy(srcIndices, srcIndices + header.indexCount, dstIndices + indexOffset);
+            } else {
+                memcpy(dstIndices + indexOffset, meshAsset.GetIndexData(), meshAsset.GetIndexDataSize());
+            }
+
+            // The direct draws see their LOD through views over its part of the pools
+            // 直接描画はプールの該当部分を指すViewを通してLODを参照する
+            drawMeshLod.vtxBufferView.BufferLocation = vtxPoolLocation + static_cast<UINT64>(vertexStride) * vertexOffset;
+            drawMeshLod.vtxBufferView.StrideInBytes  = vertexStride;
+            drawMeshLod.vtxBufferView.SizeInBytes    = meshAsset.GetVertexDataSize();
+            drawMeshLod.idxBufferView.BufferLocation = idxPoolLocation + sizeof(UINT) * indexOffset;
+            drawMeshLod.idxBufferView.SizeInBytes    = sizeof(UINT) * header.indexCount;
+            drawMeshLod.idxBufferView.Format         = DXGI_FORMAT_R32_UINT;
+
+            IndirectMeshRange &meshRange = indirectMeshRanges[meshIndex * MAX_MESH_LOD_COUNT + lod];
+            meshRange.indexCount = header.indexCount;
+            meshRange.startIndex = indexOffset;
+            meshRange.baseVertex = static_cast<INT>(vertexOffset);
+
+            vertexOffset += header.vertexCount;
+            indexOffset  += header.indexCount;
+        }
+
+        // LODs past lodCount fall back to the coarsest one
+        // lodCount以降のLODは最も粗いLODを使用する
+        for (UINT lod = drawMesh.lodCount; lod < MAX_MESH_LOD_COUNT; ++lod) {
+            indirectMeshRanges[meshIndex * MAX_MESH_LOD_COUNT + lod] = indirectMeshRanges[meshIndex * MAX_MESH_LOD_COUNT + drawMesh.lodCount - 1];
+        }
+    }
+    geometryVtxPool->Unmap(0, nullptr);
+    geometryIdxPool->Unmap(0, nullptr);
+
+    geometryVtxPoolView.BufferLocation = vtxPoolLocation;
+    geometryVtxPoolView.StrideInBytes  = vertexStride;
+    geometryVtxPoolView.SizeInBytes    = vertexStride * vertexCount;
+    geometryIdxPoolView.BufferLocation = idxPoolLocation;
+    geometryIdxPoolView.SizeInBytes    = sizeof(UINT) * indexCount;
+    geometryIdxPoolView.Format         = DXGI_FORMAT_R32_UINT;
+    return true;
+}
+
+// 事前更新処理
 void MTRenderer::PreUpdate() {
-    ;
+    // The arena used two frames ago is no longer read by the RenderThread
+    // 2フレーム前に使用したアリーナはRenderThreadから参照されていない
+    mainThreadArenaIndex = (mainThreadArenaIndex + 1) % MAIN_THREAD_ARENA_COUNT;
+    mainThreadArenas[mainThreadArenaIndex].Reset();
+    ScratchArena::SetThreadArena(&mainThreadArenas[mainThreadArenaIndex]);
+
+    // Drain the input received since the last frame, the window never waits for this
+    // 前フレーム以降に受け取った入力を取り出す、ウィンドウがこれを待つ事はない
+    frameInputStamp = InputFrameStamp();
+    frameInputStamp.consumeTimestamp = InputQueue::GetTimestamp();
+    InputEvent inputEvents[DEFAULT_INPUT_DRAIN_BATCH_SIZE];
+    for (;;) {
+        // Live input is discarded during a replay, the recorded one is applied instead
+        // 再生中は実際の入力を破棄し、代わりに記録したものを適用する
+        const UINT inputCount = inputQueue.Pop(inputEvents, DEFAULT_INPUT_DRAIN_BATCH_SIZE);
+        if (!frameReplay.IsOpen()) {
+            for (UINT i = 0; i < inputCount; ++i) {
+                inputState.Apply(inputEvents[i]);
+                frameInputStamp.Add(inputEvents[i]);
+            }
+            frameRecorder.AddInputEvents(inputEvents, inputCount);
+        }
+        if (inputCount < DEFAULT_INPUT_DRAIN_BATCH_SIZE) {
+            break;
+        }
+    }
+    if (frameReplay.IsOpen()) {
+        for (UINT i = 0; i < replayFrame.inputCount; ++i) {
+            inputState.Apply(replayFrame.inputEvents[i]);
+        }
+    }
+
+    ConsumeSceneFeed();
 }
 
-// XV
+// Apply the records published to the scene feed since the last frame to the feed actors
+// 前フレーム以降にシーンフィードへ公開されたレコードをフィードのアクタへ適用
+void MTRenderer::ConsumeSceneFeed() {
+    if (frameReplay.IsOpen()) {
+        // Only applied records are recorded, so every id is below the feed actor capacity of the stream
+        // 適用したレコードのみを記録する為、全てのIDはストリームのフィードのアクタ容量未満
+        for (UINT i = 0; i < replayFrame.feedRecordCount; ++i) {
+            ApplySceneFeedRecord(replayFrame.feedRecords[i]);
+        }
+        return;
+    }
+    if (!sceneFeed.IsOpen()) {
+        return;
+    }
+
+    const auto beginTime = std::chrono::high_resolution_clock::now();
+    const INT64 consumeTimestamp = SceneFeed::GetTimestamp();
+    UINT skippedCount = 0;
+    sceneFeed.Consume([&](const SceneFeedRecord &record) {
+        const float latencyInMs = static_cast<float>(std::max<INT64>(consumeTimestamp - record.timestamp, 0)) / 1000000.0f;
+        sceneFeedStats.recordCount++;
+        sceneFeedStats.latencyInMs   += latencyInMs;
+        sceneFeedStats.maxLatencyInMs = std::max(sceneFeedStats.maxLatencyInMs, latencyInMs);
+
+        if (ApplySceneFeedRecord(record)) {
+            frameRecorder.AddFeedRecord(record);
+        } else {
+            sceneFeedStats.rejectedCount++;
+        }
+    }, &skippedCount);
+    sceneFeedStats.rejectedCount += skippedCount;
+    sceneFeedStats.timeInMs += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - beginTime).count();
+}
+
+// Apply a scene feed record to its feed actor
+// シーンフィードのレコードをそのフィードのアクタへ適用
+bool MTRenderer::ApplySceneFeedRecord(const SceneFeedRecord &record) {
+    if (feedActorCount <= record.actorId) {
+        return false;
+    }
+
+    // The pool is registered up front, the records only show, hide and move its actors
+    // プールは事前に登録済みで、レコードはそのアクタの表示、非表示、移動のみを行う
+    TriangleSceneActor &actor = feedActors[record.actorId];
+    switch (record.type) {
+    case SceneFeedRecordType::Spawn:
+        feedActorSpawned[record.actorId] = true;
+        sceneFeedStats.spawnCount++;
+        break;
+    case SceneFeedRecordType::Despawn:
+        if (!feedActorSpawned[record.actorId]) {
+            return false;
+        }
+        actor.scale = XMVectorZero();
+        feedActorSpawned[record.actorId] = false;
+        sceneFeedStats.despawnCount++;
+        return true;
+    case SceneFeedRecordType::Transform:
+        if (!feedActorSpawned[record.actorId]) {
+            return false;
+        }
+        break;
+    default:
+        return false;
+    }
+
+    actor.translation = XMVectorSet(record.translation[0], record.translation[1], record.translation[2], 0.0f);
+    actor.rotation    = XMVectorSet(record.rotation[0], record.rotation[1], record.rotation[2], 0.0f);
+    actor.scale       = XMVectorSet(record.scale[0], record.scale[1], record.scale[2], 0.0f);
+    return true;
+}
+
+// Allocate and register the actors driven by the scene feed
+// シーンフィードが動かすアクタを確保し登録
+bool MTRenderer::CreateFeedActors(UINT actorCapacity) {
+    // The pool can not grow once its actors are in the scene
+    // プールのアクタがシーンに入った後は拡張できない
+    if (feedActors != nullptr) {
+        return actorCapacity <= feedActorCount;
+    }
+    if (actorCapacity == 0) {
+        return true;
+    }
+
+    // The actors are driven by the feed only, they never tick and stay hidden until spawned
+    // アクタはフィードのみで動き、更新されず、スポーンまで非表示のまま
+    feedActors     = std::make_unique<TriangleSceneActor[]>(actorCapacity);
+    feedActorCount = actorCapacity;
+    feedActorSpawned.assign(actorCapacity, false);
+    for (UINT i = 0; i < actorCapacity; ++i) {
+        feedActors[i].scale = XMVectorZero();
+        feedActors[i].Sleep();
+    }
+    AddSceneActors(feedActors.get(), actorCapacity);
+    return true;
+}
+
+// Connect to the scene feed of a simulation process
+// シミュレーションプロセスのシーンフィードへ接続
+bool MTRenderer::ConnectSceneFeed(const char *name) {
+    if (sceneFeed.IsOpen() || !sceneFeed.Open(name)) {
+        return false;
+    }
+
+    if (!CreateFeedActors(sceneFeed.GetActorCapacity())) {
+        sceneFeed.Close();
+        return false;
+    }
+    sceneFeedStats = SceneFeedStats();
+    return true;
+}
+
+// Save the triangle and camera actors of the scene to a snapshot file
+// シーンの三角形とカメラのアクタをスナップショットファイルへ保存
+bool MTRenderer::SaveSceneSnapshot(const char *path) {
+    return scene.SaveSnapshot(path);
+}
+
+// Add the actors of a snapshot file to the scene
+// スナップショットファイルのアクタをシーンへ追加
+bool MTRenderer::LoadSceneSnapshot(const char *path) {
+    const auto beginTime = std::chrono::high_resolution_clock::now();
+    const size_t actorCount = scene.GetActorCount();
+    if (!scene.LoadSnapshot(path, &jobSystem)) {
+        return false;
+    }
+
+    if (TestFlag(GlobalFlag::EnableStatsReport)) {
+        char reportStr[256];
+        snprintf(reportStr, sizeof(reportStr), "SceneSnapshot: %u actors loaded (%.3f ms)\n", static_cast<UINT>(scene.GetActorCount() - actorCount),
+            std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - beginTime).count());
+        OutputDebugStringA(reportStr);
+    }
+    return true;
+}
+
+// Record the frames to a stream for FrameReplay
+// FrameReplay用にフレームをストリームへ記録
+bool MTRenderer::StartFrameRecording(const char *path) {
+    if (frameReplay.IsOpen()) {
+        return false;
+    }
+    return frameRecorder.Open(path, feedActorCount);
+}
+
+// Drive the frames from a recorded stream
+// 記録したストリームからフレームを動かす
+bool MTRenderer::StartFrameReplay(const char *path, bool unthrottled) {
+    if (frameRecorder.IsOpen() || !frameReplay.Open(path)) {
+        return false;
+    }
+    if (!CreateFeedActors(frameReplay.GetFeedActorCapacity())) {
+        frameReplay.Close();
+        return false;
+    }
+
+    frameReplayStats = FrameReplayStats();
+    if (unthrottled) {
+        SetFlag(GlobalFlag::DisableVSync);
+    }
+    return true;
+}
+
+// Begin the frame of the recording or the replay
+// 記録もしくは再生のフレームを開始
+void MTRenderer::BeginRecordedFrame(float *delta) {
+    if (frameReplay.IsOpen()) {
+        if (frameReplayStats.frameCount == 0) {
+            replayBeginTime = std::chrono::high_resolution_clock::now();
+        }
+        if (frameReplay.NextFrame(&replayFrame)) {
+            *delta = replayFrame.delta;
+        } else {
+            FinishFrameReplay();
+        }
+    }
+    frameRecorder.BeginFrame(*delta);
+}
+
+// End the frame of the recording or the replay
+// 記録もしくは再生のフレームを終了
+void MTRenderer::EndRecordedFrame() {
+    if (frameReplay.IsOpen()) {
+        if (replayFrame.hasChecksum) {
+            frameReplayStats.checkedCount++;
+            if (scene.GetTransformHierarchy().ComputeChecksum() != replayFrame.checksum && frameReplayStats.mismatchCount++ == 0) {
+                frameReplayStats.firstMismatchFrame = frameReplayStats.frameCount;
+            }
+        }
+        frameReplayStats.frameCount++;
+    }
+    if (frameRecorder.IsOpen()) {
+        frameRecorder.EndFrame(frameRecorder.IsChecksumFrame() ? scene.GetTransformHierarchy().ComputeChecksum() : 0);
+    }
+}
+
+// Report the replay and close the window
+// 再生を報告しウィンドウを閉じる
+void MTRenderer::FinishFrameReplay() {
+    frameReplayStats.timeInMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - replayBeginTime).count();
+    frameReplay.Close();
+    replayFrame = ReplayFrame();
+
+    char reportStr[256];
+    if (0 < frameReplayStats.mismatchCount) {
+        snprintf(reportStr, sizeof(reportStr), "FrameReplay: %llu frames, %.3f ms (%.1f fps), %u of %u checksums differ, first at frame %llu\n",
+            frameReplayStats.frameCount, frameReplayStats.timeInMs, frameReplayStats.frameCount * 1000.0f / std::max(frameReplayStats.timeInMs, FLT_EPSILON),
+            frameReplayStats.mismatchCount, frameReplayStats.checkedCount, frameReplayStats.firstMismatchFrame);
+    } else {
+        snprintf(reportStr, sizeof(reportStr), "FrameReplay: %llu frames, %.3f ms (%.1f fps), %u checksums match\n",
+            frameReplayStats.frameCount, frameReplayStats.timeInMs, frameReplayStats.frameCount * 1000.0f / std::max(frameReplayStats.timeInMs, FLT_EPSILON),
+            frameReplayStats.checkedCount);
+    }
+    OutputDebugStringA(reportStr);
+
+    PostMessage(windowHandle, WM_CLOSE, 0, 0);
+}
+
+// Time the frames of the pipeline
+// パイプラインのフレームを計測
+void MTRenderer::StartBenchmark(UINT warmupFrames, UINT frameCount) {
+    benchmark.Init(warmupFrames, frameCount);
+    SetFlag(GlobalFlag::DisableVSync);
+}
+
+// 更新処理
 void MTRenderer::Update(float delta) {
-    for (auto actor : sceneActors) {
-        actor->Update(delta);
+    // Tick the actors and propagate their transforms on the workers
+    // アクタを更新し、そのトランスフォームをワーカーで伝播
+    scene.Update(delta, &jobSystem);
+
+    // Simulate the particles into the instance stream committed to the RenderThread
+    // RenderThreadへ伝達するインスタンスストリームへパーティクルをシミュレーション
+    particleSystem.Update(delta, &jobSystem);
+
+    // Report the tick groups periodically
+    // 更新グループを定期的に出力
+    const TickScheduler &tickScheduler = scene.GetTickScheduler();
+    const bool statsInterval = (tickScheduler.GetFrameIndex() % DEFAULT_RENDER_STATS_INTERVAL) == 0;
+    if (statsInterval && TestFlag(GlobalFlag::EnableStatsReport)) {
+        static const char *groupNames[TICK_GROUP_COUNT] = { "PreUpdate", "Update", "PostUpdate", "PreCommit" };
+        for (UINT group = 0; group < TICK_GROUP_COUNT; ++group) {
+            const auto &tickStats = tickScheduler.GetStats(static_cast<TickGroup>(group));
+
+            char reportStr[256];
+            snprintf(reportStr, sizeof(reportStr), "TickGroup %s: %u ticked, %u throttled, %u sleeping, %u dependencies, %.3f ms (CPU %.3f ms)\n",
+                groupNames[group], tickStats.tickedCount, tickStats.throttledCount, tickStats.sleepingCount, tickStats.dependencyCount, tickStats.timeInMs, tickStats.cpuTimeInMs);
+            OutputDebugStringA(reportStr);
+        }
+
+        const auto &animationStats = scene.GetAnimationSystem().GetStats();
+
+        char reportStr[256];
+        snprintf(reportStr, sizeof(reportStr), "AnimationSystem: %u instances, %u tasks, %.3f ms\n",
+            animationStats.instanceCount, animationStats.taskCount, animationStats.timeInMs);
+        OutputDebugStringA(reportStr);
+
+        const auto &particleStats = particleSystem.GetStats();
+        snprintf(reportStr, sizeof(reportStr), "ParticleSystem: %u emitters, %u alive, %u emitted, %u killed, %u tasks, %.3f ms\n",
+            particleStats.emitterCount, particleStats.aliveCount, particleStats.emittedCount, particleStats.killedCount, particleStats.taskCount, particleStats.timeInMs);
+        OutputDebugStringA(reportStr);
+
+        if (sceneFeed.IsOpen()) {
+            const float feedRecordCount = static_cast<float>(std::max(sceneFeedStats.recordCount, 1u));
+            snprintf(reportStr, sizeof(reportStr), "SceneFeed: %u records (%u spawns, %u despawns, %u rejected), latency %.3f ms (max %.3f ms), %.3f ms, %llu dropped by the producer\n",
+                sceneFeedStats.recordCount, sceneFeedStats.spawnCount, sceneFeedStats.despawnCount, sceneFeedStats.rejectedCount,
+                sceneFeedStats.latencyInMs / feedRecordCount, sceneFeedStats.maxLatencyInMs, sceneFeedStats.timeInMs, static_cast<unsigned long long>(sceneFeed.TakeDroppedCount()));
+            OutputDebugStringA(reportStr);
+        }
+    }
+
+    // The accumulated statistics restart every interval, reported or not
+    // 蓄積した統計情報は出力の有無によらずインターバル毎に再開する
+    if (statsInterval) {
+        sceneFeedStats = SceneFeedStats();
     }
 }
 
-// RenderThreadSceneProxy󂯎\ɂȂ܂ő҂
+// RenderThreadがSceneProxy受け取り可能になるまで待つ
 void MTRenderer::SyncRenderThread() {
     std::unique_lock<std::mutex> lock(syncRenderThreadMtx);
 
     // Wait until you get a notification from RenderThread.
-    // RenderThreadʒm܂ő҂
+    // RenderThreadから通知がくるまで待つ
     syncRenderThreadCond.wait(lock, [this] {
         return renderTheadReady;
     });
 
     // Reset
-    // Zbg
+    // リセット
     renderTheadReady = false;
 }
 
-// ActorProxy֕``B
+// ActorからProxyへ描画情報を伝達
 void MTRenderer::CommitSceneProxy() {
-    if (sceneProxies.size() < sceneActors.size()) {
-        for (size_t i = sceneProxies.size(); i < sceneActors.size(); ++i) {
-            auto actor = sceneActors[i];
-
-            switch (actor->GetActorType()) {
-            case SceneActorType::Camera:
-                sceneProxies.push_back(new CameraSceneProxy);
-                break;
-
-            case SceneActorType::Triangle:
-                sceneProxies.push_back(new TriangleSceneProxy);
-                break;
-
-            default:
-                ;
-            }
-        }
-    }
-
-    assert(sceneActors.size() == sceneProxies.size());
-
-    for (size_t i = 0; i < sceneProxies.size(); ++i) {
-        auto proxy = sceneProxies[i];
-        proxy->Commit(sceneActors[i]);
-    }
+    // Commit the proxies and refit their bounds in the BVH
+    // Proxyを伝達しその境界をBVHへ反映
+    scene.Commit(&jobSystem);
+
+    // The next update writes the other instance stream, this one stays valid while the RenderThread reads it
+    // 次の更新は他方のインスタンスストリームへ書き込む為、RenderThreadが参照する間も有効
+    committedParticleFrame = particleSystem.GetFrame();
+    committedInputStamp    = frameInputStamp;
 }
 
 void MTRenderer::RestartRenderThread() {
     {
         std::lock_guard<std::mutex> lock(syncMainThreadMtx);
         mainTheadReady = true;
+        mainThreadReadyTime = std::chrono::high_resolution_clock::now();
     }
 
     // Notify the RenderThread that the SceneProxy has been passed
-    // SceneProxy̎󂯓nRenderThread֒ʒm
+    // SceneProxyの受け渡しが完了した事をRenderThreadへ通知
     syncMainThreadCond.notify_one();
 }
 
@@ -1068,7 +1969,7 @@ void MTRenderer::RestartMainThread() {
     }
 
     // Notify MainThread that the SceneProxy is ready to be received
-    // SceneProxy󂯓\ƂMainThread֒ʒm
+    // SceneProxyが受け入れ可能という事をMainThreadへ通知
     syncRenderThreadCond.notify_one();
 }
 
@@ -1076,22 +1977,55 @@ void MTRenderer::SyncMainThread() {
     std::unique_lock<std::mutex> lock(syncMainThreadMtx);
 
     // Wait until the SceneProxy has been passed
-    // SceneProxy̎󂯓n܂ő҂
+    // SceneProxyの受け渡しが完了するまで待つ
+    const bool waited = !mainTheadReady;
     syncMainThreadCond.wait(lock, [this] {
         return mainTheadReady;
     });
 
+    // The handoff latency is only meaningful when this thread was asleep
+    // 受け渡しの遅延はこのスレッドが休止していた場合のみ意味を持つ
+    if (waited) {
+        benchmark.AddSample(BenchmarkMetric::Handoff, std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - mainThreadReadyTime).count());
+    }
+
     // Reset
-    // Zbg
+    // リセット
     mainTheadReady = false;
 }
 
-// O`揈
+// 事前描画処理
 void MTRenderer::PreRender() {
-    ;
+    if (!TestFlag(GlobalFlag::EnableOcclusionCull)) {
+        return;
+    }
+
+    const CameraComponent *camera = nullptr;
+    scene.GetProxyWorld().ForEach<CameraComponent>([&](UINT count, const UINT *entities, CameraComponent *cameras) {
+        if (camera == nullptr) {
+            camera = &cameras[0];
+        }
+    });
+    if (camera == nullptr) {
+        return;
+    }
+
+    // Rasterize the occluders of the committed proxies on the workers, Render tests against them
+    // 伝達済みのProxyの遮蔽物をワーカーでラスタライズし、Renderでそれに対してテストする
+    const XMMATRIX viewProjMtx = XMMatrixMultiply(XMMatrixTranspose(XMLoadFloat4x4(&camera->viewMtx)), XMMatrixTranspose(XMLoadFloat4x4(&camera->projMtx)));
+    occlusionCuller.Begin(viewProjMtx);
+    scene.GetProxyWorld().ForEach<TransformComponent, MeshComponent>([&](UINT count, const UINT *entities, TransformComponent *transforms, MeshComponent *meshes) {
+        for (UINT i = 0; i < count; ++i) {
+            if (meshes[i].occluder && meshes[i].meshIndex < drawMeshes.size()) {
+                const auto &mesh = drawMeshes[meshes[i].meshIndex];
+                occlusionCuller.AddOccluder(*mesh.GetLod(mesh.lodCount - 1).asset, XMLoadFloat4x4(&transforms[i].worldMtx));
+            }
+        }
+    });
+    occlusionCuller.Rasterize(&jobSystem);
 }
 
-// N-2t[GPU҂
+// N-2フレームのGPU処理完了を待つ
 void MTRenderer::SyncGPU() {
     auto &syncFrameData = frameDataArray[backBufferIndex];
 
@@ -1100,7 +2034,7 @@ void MTRenderer::SyncGPU() {
     }
 
     // Wait for completion of GPU processing of N-2 frames
-    // N-2t[GPU҂
+    // N-2フレームのGPU処理完了を待つ
     if (syncFrameData.d3dFence->GetCompletedValue() < syncFrameData.fenceValue) {
         if (SUCCEEDED(syncFrameData.d3dFence->SetEventOnCompletion(syncFrameData.fenceValue, fenceEvent))) {
             WaitForSingleObject(fenceEvent, INFINITE);
@@ -1110,20 +2044,21 @@ void MTRenderer::SyncGPU() {
     syncFrameData.syncGPU = false;
 }
 
-// ҂A`XV
+// 垂直同期を待ち、描画を更新
 void MTRenderer::Present() {
     UINT prevBackBufferIndex = backBufferIndex;
 
     // Wait for V-Sync and update the image
-    // ҂ĕ`C[WXV
-    dxgiSwapChain->Present(1, 0);
+    // 垂直同期を待って描画イメージ更新
+    dxgiSwapChain->Present(TestFlag(GlobalFlag::DisableVSync) ? 0 : 1, 0);
+    inputLatencyTracker.OnFramePresented(InputQueue::GetTimestamp());
 
     // Update back buffer index
-    // obNobt@ԍXV
+    // バックバッファ番号更新
     backBufferIndex = dxgiSwapChain->GetCurrentBackBufferIndex();
 }
 
-// N-1t[CommandListLbN
+// N-1フレームのCommandListをキック
 void MTRenderer::PopulateCommandList() {
     auto &frameData = frameDataArray[backBufferIndex];
 
@@ -1132,123 +2067,806 @@ void MTRenderer::PopulateCommandList() {
     }
 
     // Populate CommandList for N-1 frame
-    // N-1t[̕`R}hLbN
+    // N-1フレームの描画コマンドをキック
     ID3D12CommandList *d3dCommandLists[] = { frameData.d3dCommandList.Get() };
     d3dCommandQueue->ExecuteCommandLists(1, d3dCommandLists);
+    inputLatencyTracker.OnFrameSubmitted();
+
+    // Set the fences after the command list, so they complete once the GPU has finished the frame
+    // フェンスはCommandListの後にセットし、GPUがフレームを完了した時点で完了させる
+    d3dCommandQueue->Signal(frameData.d3dFence.Get(), frameData.fenceValue);
+    if (frameData.readbackFenceValue != 0) {
+        d3dCommandQueue->Signal(d3dReadbackFence.Get(), frameData.readbackFenceValue);
+        frameData.readbackFenceValue = 0;
+    }
 }
 
-// Nt[`
+// Nフレームを描画
 void MTRenderer::Render() {
+    const auto beginTime = std::chrono::high_resolution_clock::now();
     const UINT nextBackBufferIndex = (backBufferIndex + 1) % backBufferCount;
     auto &frameData = frameDataArray[nextBackBufferIndex];
 
     // Reset CommandAllocator to recover memory previously used for recording
-    // ȑOL^ɎgpCommandAllocatorZbg
+    // 以前記録に使用したメモリを回収する為CommandAllocatorをリセット
     frameData.d3dCommandAllocator->Reset();
 
+    // The scratch arena of the frame shares the lifetime of the CommandAllocator
+    // フレームのアリーナはCommandAllocatorと同じ寿命を持つ
+    frameData.renderThreadArena.Reset();
+    ScratchArena::SetThreadArena(&frameData.renderThreadArena);
+    renderQueue.SetArena(&frameData.renderThreadArena);
+
+    // The GPU finished the last frame recorded here, so its timestamps are ready and pick the scale of this one
+    // ここで最後に記録したフレームはGPUで完了している為、そのタイムスタンプは読み込め、このフレームのスケールを決める
+    const UINT queryIndex = nextBackBufferIndex * 2;
+    if (frameData.timestampsPending) {
+        D3D12_RANGE readRange = { sizeof(UINT64) * queryIndex, sizeof(UINT64) * (queryIndex + 2) };
+        UINT64 *timestamps = nullptr;
+        if (SUCCEEDED(d3dTimestampReadbackBuffer->Map(0, &readRange, reinterpret_cast<void **>(&timestamps)))) {
+            const UINT64 beginTimestamp = timestamps[queryIndex];
+            const UINT64 endTimestamp   = timestamps[queryIndex + 1];
+            D3D12_RANGE writtenRange = { 0, 0 };
+            d3dTimestampReadbackBuffer->Unmap(0, &writtenRange);
+
+            if (beginTimestamp < endTimestamp && timestampFrequency != 0 && TestFlag(GlobalFlag::EnableDynamicResolution)) {
+                const float gpuTimeInMs = static_cast<float>(static_cast<double>(endTimestamp - beginTimestamp) * 1000.0 / static_cast<double>(timestampFrequency));
+                resolutionController.Update(gpuTimeInMs, frameData.resolutionScale);
+            }
+        }
+        frameData.timestampsPending = false;
+    }
+    const float resolutionScale = TestFlag(GlobalFlag::EnableDynamicResolution) ? resolutionController.GetScale() : 1.0f;
+    frameData.resolutionScale = resolutionScale;
+
+    // Hand the read back frames the GPU has finished to the consumer thread, without waiting for the others
+    // GPUが完了した読み戻しフレームを消費者スレッドへ渡し、他のものは待たない
+    frameReadbackRing.Poll(d3dReadbackFence->GetCompletedValue(), renderFrameCount + 1);
+
     // Reset ComandList before render starts
-    // `JnOComandListZbg
+    // 描画開始前にComandListをリセット
     frameData.d3dCommandList->Reset(frameData.d3dCommandAllocator.Get(), d3dPipelineState.Get());
 
-    frameData.d3dCommandList->SetGraphicsRootSignature(d3dRootSignature.Get());
-
     ID3D12DescriptorHeap *d3dDescHeaps[] = { d3dCBVHeap.Get() };
     frameData.d3dCommandList->SetDescriptorHeaps(1, d3dDescHeaps);
 
-    // Bind ConstantBuffer to pipeline
-    // ConstantBufferoCh
-    D3D12_GPU_VIRTUAL_ADDRESS cbLocation = frameData.d3dConstantBuffer->GetGPUVirtualAddress();
-    frameData.d3dCommandList->SetGraphicsRootConstantBufferView(0, cbLocation);
+    // The root signature and topology come from the prologue bundle recorded at initialization
+    // RootSignatureとトポロジは初期化時に記録したプロローグのバンドルからセットする
+    frameData.d3dCommandList->ExecuteBundle(d3dPrologueBundle.Get());
+    frameData.d3dCommandList->EndQuery(d3dTimestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, queryIndex);
 
-    // Start updating ConstantBuffer
-    // ConstantBuffer̍XVJn
+    // Start updating ConstantBuffer, each view has its own slice
+    // ConstantBufferの更新開始、各ビューは自身の領域を持つ
+    const D3D12_GPU_VIRTUAL_ADDRESS cbLocation = frameData.d3dConstantBuffer->GetGPUVirtualAddress();
     D3D12_RANGE range = { 0, 0 };
     SceneConstantBuffer *cbvData = nullptr;
     frameData.d3dConstantBuffer->Map(0, &range, reinterpret_cast<void **>(&cbvData));
 
-    // J
-    for (auto sceneProxy : sceneProxies) {
-        if (sceneProxy->GetProxyType() == SceneProxyType::Camera) {
-            auto cameraSceneProxy = static_cast<CameraSceneProxy *>(sceneProxy);
+    // The indirect draw records of all views and passes are written one after another
+    // 全ビューと全パスの間接描画のレコードは順に書き込む
+    const bool indirectDraw = TestFlag(GlobalFlag::EnableIndirectDraw);
+    IndirectDrawRecord *indirectRecords = nullptr;
+    UINT indirectRecordCount = 0;
+    if (indirectDraw) {
+        frameData.d3dIndirectArgBuffer->Map(0, &range, reinterpret_cast<void **>(&indirectRecords));
+    }
 
-            frameData.d3dCommandList->RSSetViewports(1, &cameraSceneProxy->GetViewport());
-            frameData.d3dCommandList->RSSetScissorRects(1, &cameraSceneProxy->GetScissorRect());
+    // カメラ処理
+    // Every camera is a view, the first one is the primary view the occlusion buffer and the LODs follow
+    // 各カメラがビューとなり、最初のものはオクルージョンバッファとLODが従う主ビューとなる
+    const CameraComponent *cameras[MAX_VIEW_COUNT];
+    ViewFrustum frustums[MAX_VIEW_COUNT];
+    UINT viewCount = 0;
+    scene.GetProxyWorld().ForEach<CameraComponent>([&](UINT count, const UINT *entities, CameraComponent *cameraComponents) {
+        for (UINT i = 0; i < count && viewCount < MAX_VIEW_COUNT; ++i) {
+            const CameraComponent &camera = cameraComponents[i];
+            cbvData[viewCount].ViewMatrix = camera.viewMtx;
+            cbvData[viewCount].ProjMatrix = camera.projMtx;
+            frustums[viewCount].SetFromMatrix(XMMatrixMultiply(XMMatrixTranspose(XMLoadFloat4x4(&camera.viewMtx)), XMMatrixTranspose(XMLoadFloat4x4(&camera.projMtx))));
+            cameras[viewCount++] = &camera;
+        }
+    });
 
-            cameraSceneProxy->GetViewMatrix(&cbvData->ViewMatrix);
-            cameraSceneProxy->GetProjectionMatrix(&cbvData->ProjMatrix);
-            break;
+    // Set render targets, the scene is drawn to the scene target and upscaled to the back buffer at the end
+    // RenderTargetセット、シーンはシーンターゲットへ描画し最後にバックバッファへアップスケールする
+    D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = d3dRTVHeap->GetCPUDescriptorHandleForHeapStart();
+    rtvHandle.ptr += static_cast<SIZE_T>(backBufferCount + nextBackBufferIndex) * static_cast<SIZE_T>(rtvDescriptorSize);
+    D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle = d3dDSVHeap->GetCPUDescriptorHandleForHeapStart();
+    dsvHandle.ptr += static_cast<SIZE_T>(nextBackBufferIndex) * static_cast<SIZE_T>(dsvDescriptorSize);
+    frameData.d3dCommandList->OMSetRenderTargets(1, &rtvHandle, FALSE, &dsvHandle);
+
+    // Clear render targets, only the part drawn at the render scale
+    // RenderTargetクリア、描画スケールで描画する部分のみ
+    const D3D12_RECT canvasRect = { 0, 0, static_cast<LONG>(canvasWidth), static_cast<LONG>(canvasHeight) };
+    const D3D12_RECT renderRect = ScaleRect(canvasRect, resolutionScale);
+    const float clearColor[] = { 0.3f, 0.3f, 0.3f, 1.0f };
+    frameData.d3dCommandList->ClearRenderTargetView(rtvHandle, clearColor, 1, &renderRect);
+    frameData.d3dCommandList->ClearDepthStencilView(dsvHandle, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 1, &renderRect);
+
+    // Collect the proxies inside each view from the BVH in one pass shared by the views
+    // ビューで共有する1回の走査で、各ビューの視野内のProxyをBVHから収集
+    const UINT entityIndexCapacity = scene.GetProxyWorld().GetEntityIndexCapacity();
+    UINT8 *entityViewMasks = frameData.renderThreadArena.AllocateArray<UINT8>(entityIndexCapacity);
+    memset(entityViewMasks, 0, entityIndexCapacity);
+    ComputeViewVisibility(frustums, viewCount, &frameData.renderThreadArena, entityViewMasks);
+
+    // The GPU finished with the instance buffer of the frame before its CommandAllocator was reset, so it can be replaced
+    // フレームのインスタンスバッファはCommandAllocatorのリセット前にGPUの使用が終わっている為、置き換えられる
+    const ParticleFrame &particleFrame = committedParticleFrame;
+    if (frameData.particleInstanceCapacity < particleFrame.instanceCount) {
+        UINT capacity = std::max(frameData.particleInstanceCapacity, DEFAULT_PARTICLE_UPLOAD_BATCH_SIZE);
+        while (capacity < particleFrame.instanceCount) {
+            capacity *= 2;
+        }
+        if (CreateUploadBuffer(d3dDevice.Get(), nullptr, capacity * sizeof(ParticleInstance), &frameData.d3dParticleInstanceBuffer)) {
+            frameData.particleInstanceCapacity = capacity;
+        } else {
+            frameData.particleInstanceCapacity = 0;
         }
     }
 
-    // Present -> RenderTarget
-    {
-        D3D12_RESOURCE_BARRIER d3dResBarrier;
-        d3dResBarrier.Type                   = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-        d3dResBarrier.Flags                  = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-        d3dResBarrier.Transition.pResource   = d3dRenderTarget[nextBackBufferIndex].Get();
-        d3dResBarrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;
-        d3dResBarrier.Transition.StateAfter  = D3D12_RESOURCE_STATE_RENDER_TARGET;
-        d3dResBarrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-
-        frameData.d3dCommandList->ResourceBarrier(1, &d3dResBarrier);
+    // The particle instances are uploaded once and drawn by every view, copied in batches on the workers
+    // パーティクルのインスタンスは1回だけ転送して全ビューで描画する、ワーカー上でバッチ毎にコピーする
+    bool drawParticles = false;
+    if (viewCount != 0 && particleFrame.drawCount != 0 && particleFrame.instanceCount <= frameData.particleInstanceCapacity) {
+        ParticleInstance *dstInstances = nullptr;
+        if (SUCCEEDED(frameData.d3dParticleInstanceBuffer->Map(0, &range, reinterpret_cast<void **>(&dstInstances)))) {
+            const ParticleInstance *srcInstances = particleFrame.instances;
+            jobSystem.ParallelFor(particleFrame.instanceCount, DEFAULT_PARTICLE_UPLOAD_BATCH_SIZE, [dstInstances, srcInstances](UINT begin, UINT end) {
+                memcpy(dstInstances + begin, srcInstances + begin, sizeof(ParticleInstance) * (end - begin));
+            });
+            frameData.d3dParticleInstanceBuffer->Unmap(0, nullptr);
+            drawParticles = true;
+        }
     }
 
-    // Set render targets
-    // RenderTargetZbg
-    D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = d3dRTVHeap->GetCPUDescriptorHandleForHeapStart();
-    rtvHandle.ptr += static_cast<SIZE_T>(nextBackBufferIndex) * static_cast<SIZE_T>(rtvDescriptorSize);
-    frameData.d3dCommandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
+    // The PipelineState and RootSignature are left by the prologue bundle
+    // PipelineStateとRootSignatureはプロローグのバンドルでセット済み
+    CommandListState commandListState;
+    commandListState.d3dPipelineState = d3dPipelineState.Get();
+    commandListState.d3dRootSignature = d3dRootSignature.Get();
+    commandListState.materialIndex    = ~0u;
+    commandListState.meshIndex        = ~0u;
+    commandListState.lodIndex         = ~0u;
+
+    RenderSubmitStats submitStats;
+
+    // Draw the views one after another, each with its own constants, culling results and render queue pass
+    // ビューを順に描画、各ビューは自身の定数、カリング結果、描画キューのパスを持つ
+    renderFrameCount++;
+    bundleCache.BeginFrame(renderFrameCount);
+    inputLatencyTracker.OnFrameRecorded(committedInputStamp);
+    const bool statsInterval = (renderFrameCount % DEFAULT_RENDER_STATS_INTERVAL) == 0;
+    const bool reportStats   = statsInterval && TestFlag(GlobalFlag::EnableStatsReport);
+    const bool occlusionCull = TestFlag(GlobalFlag::EnableOcclusionCull);
+    XMFLOAT4X4 *instanceMatrices = frameData.renderThreadArena.AllocateArray<XMFLOAT4X4>(scene.GetProxyWorld().GetEntityCount());
+    float renderQueueTimeInMs = 0.0f;
+    float packTimeInMs = 0.0f;
+    for (UINT viewIndex = 0; viewIndex < viewCount; ++viewIndex) {
+        const CameraComponent *camera = cameras[viewIndex];
+        const D3D12_GPU_VIRTUAL_ADDRESS viewCBLocation = cbLocation + sizeof(SceneConstantBuffer) * viewIndex;
+        const D3D12_VIEWPORT viewport    = ScaleViewport(camera->viewport, resolutionScale);
+        const D3D12_RECT     scissorRect = ScaleRect(camera->scissorRect, resolutionScale);
+        frameData.d3dCommandList->RSSetViewports(1, &viewport);
+        frameData.d3dCommandList->RSSetScissorRects(1, &scissorRect);
+
+        // Bind ConstantBuffer to pipeline
+        // ConstantBufferをバインド
+        frameData.d3dCommandList->SetGraphicsRootConstantBufferView(0, viewCBLocation);
+
+        // Views drawn over the earlier ones start from a cleared depth in their area
+        // 前のビューの上に描画するビューは自身の領域の深度をクリアして開始する
+        if (viewIndex != 0) {
+            frameData.d3dCommandList->ClearDepthStencilView(dsvHandle, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 1, &scissorRect);
+        }
 
-    // Clear render targets
-    // RenderTargetNA
-    const float clearColor[] = { 0.3f, 0.3f, 0.3f, 1.0f };
-    frameData.d3dCommandList->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
-    
-    // TriangleCX^X`
-    UINT instanceCount = 0;
-    for (auto sceneProxy : sceneProxies) {
-        if (sceneProxy->GetProxyType() == SceneProxyType::Triangle) {
-            auto triSceneProxy = static_cast<TriangleSceneProxy *>(sceneProxy);
-            triSceneProxy->GetWorldMatrix(&cbvData->worldMatrix[instanceCount]);
+        // The projection matrix is symmetric in Y, so _22 stays in place when transposed
+        // 射影行列はYについて対称の為、_22は転置しても同じ位置にある
+        lodSelector.SetProjectionScale(camera->projMtx._22);
+
+        // The occlusion buffer is rasterized from the primary view, which also keeps the LODs for the hysteresis
+        // オクルージョンバッファは主ビューからラスタライズし、主ビューはヒステリシスの為にLODも保持する
+        const bool primaryView = (viewIndex == 0);
+        RenderQueueView view;
+        view.camera          = camera;
+        view.entityViewMasks = entityViewMasks;
+        view.viewMask        = static_cast<UINT8>(1u << viewIndex);
+        view.occlusionCuller = (primaryView && occlusionCull) ? &occlusionCuller : nullptr;
+        view.lodSelector     = &lodSelector;
+        view.storeLods       = primaryView;
+
+        // Emit the draw requests keyed by state and view depth, and sort them
+        // ステートとView空間の深度をキーとした描画要求を発行しソート
+        const auto queueBeginTime = std::chrono::high_resolution_clock::now();
+        const UINT visibleCount = Scene::BuildRenderQueue(&scene.GetProxyWorld(), view, &jobSystem, &renderQueue, instanceMatrices);
+        if (primaryView && occlusionCull) {
+            occlusionCuller.SetTestResult(viewVisibilityStats.inViewCounts[0], viewVisibilityStats.inViewCounts[0] - visibleCount);
+        }
 
-            instanceCount++;
+        const auto packBeginTime = std::chrono::high_resolution_clock::now();
+        renderQueueTimeInMs += std::chrono::duration<float, std::milli>(packBeginTime - queueBeginTime).count();
+
+        // Write the visible instances in sorted order, the nearest ones are kept when the buffer is full
+        // 可視のインスタンスをソート順に書き込み、バッファが溢れる場合は手前のものが残る
+        const RenderItem *renderItems = renderQueue.GetItems();
+        const UINT instanceCount = Scene::PackInstanceMatrices(renderQueue, visibleCount, instanceMatrices, static_cast<UINT>(_countof(cbvData->worldMatrix)), cbvData[viewIndex].worldMatrix);
+        packTimeInMs += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - packBeginTime).count();
+        benchmark.AddInstancePacking(visibleCount, instanceCount);
+
+        // Lay down the depth of the opaque items so the opaque pass shades each pixel once,
+        // the direct submission takes over when the indirect records of the frame are full
+        // 不透明パスが各ピクセルを1回だけシェーディングするよう、不透明要素の深度を先に書き込む。
+        // フレームの間接描画のレコードが満杯の場合は直接発行が引き継ぐ
+        for (const bool depthOnly : { true, false }) {
+            if (depthOnly && !TestFlag(GlobalFlag::EnableDepthPrepass)) {
+                continue;
+            }
+            if (!indirectDraw || !SubmitIndirect(frameData.d3dCommandList.Get(), viewCBLocation, instanceCount, depthOnly, frameData.d3dIndirectArgBuffer.Get(), indirectRecords, &indirectRecordCount, &commandListState, &submitStats)) {
+                SubmitRenderQueue(frameData.d3dCommandList.Get(), viewCBLocation, instanceCount, depthOnly, &commandListState, &submitStats);
+            }
+        }
+
+        if (drawParticles) {
+            SubmitParticles(frameData.d3dCommandList.Get(), viewCBLocation, frameData.d3dParticleInstanceBuffer.Get(), &commandListState);
+        }
+
+        // The visible items of the primary view lead its queue, count them per LOD
+        // 主ビューの可視の要素はそのキューの先頭にある為、LOD毎に数える
+        if (primaryView && reportStats) {
+            UINT lodInstanceCounts[MAX_MESH_LOD_COUNT] = {};
+            for (UINT i = 0; i < visibleCount; ++i) {
+                lodInstanceCounts[std::min(RenderQueue::GetLod(renderItems[i].sortKey), MAX_MESH_LOD_COUNT - 1)]++;
+            }
+            lodSelector.SetInstanceCounts(lodInstanceCounts);
         }
     }
+    renderSubmitStats = submitStats;
+    benchmark.AddSample(BenchmarkMetric::RenderQueue, renderQueueTimeInMs);
+    benchmark.AddSample(BenchmarkMetric::InstancePacking, packTimeInMs);
 
     // End updating ConstantBuffer
-    // ConstantBuffer̍XVI
+    // ConstantBufferの更新終了
     frameData.d3dConstantBuffer->Unmap(0, nullptr);
+    if (indirectRecords != nullptr) {
+        D3D12_RANGE writtenRange = { 0, sizeof(IndirectDrawRecord) * indirectRecordCount };
+        frameData.d3dIndirectArgBuffer->Unmap(0, &writtenRange);
+    }
+
+    // Report the sort throughput and the state changes periodically
+    // ソートのスループットとステート変更数を定期的に出力
+    if (reportStats) {
+        const auto &queueStats = renderQueue.GetStats();
+        const float keysPerSec = (0.0f < queueStats.sortTimeInMs) ? queueStats.itemCount * 1000.0f / queueStats.sortTimeInMs : 0.0f;
+
+        char reportStr[256];
+        snprintf(reportStr, sizeof(reportStr), "RenderQueue: %u items, %u passes, %.3f ms (%.2f Mkeys/s), %u draws (%u prepass), PSO %u, RootSig %u, Material %u, VB %u\n",
+            queueStats.itemCount, queueStats.sortPassCount, queueStats.sortTimeInMs, keysPerSec / 1000000.0f,
+            submitStats.drawCount, submitStats.prepassDrawCount, submitStats.pipelineChanges, submitStats.rootSignatureChanges, submitStats.materialChanges, submitStats.vertexBufferChanges);
+        OutputDebugStringA(reportStr);
+
+        if (indirectDraw) {
+            snprintf(reportStr, sizeof(reportStr), "IndirectDraw: %u ExecuteIndirect, %u records, build %.3f ms\n",
+                submitStats.indirectCount, indirectRecordCount, submitStats.indirectBuildTimeInMs);
+            OutputDebugStringA(reportStr);
+        }
+
+        if (TestFlag(GlobalFlag::EnableBundleCache)) {
+            const auto &bundleStats = bundleCache.GetStats();
+            const float hitRate = (0 < bundleStats.lookupCount) ? bundleStats.hitCount * 100.0f / bundleStats.lookupCount : 0.0f;
+            snprintf(reportStr, sizeof(reportStr), "BundleCache: %u / %u hits (%.1f%%), %u draws replayed, %u recorded (%.3f ms), %u evicted, %u cached, ~%.3f ms recording saved\n",
+                bundleStats.hitCount, bundleStats.lookupCount, hitRate, bundleStats.replayedDrawCount, bundleStats.recordCount, bundleStats.recordTimeInMs,
+                bundleStats.evictionCount, bundleStats.cachedCount, bundleStats.savedTimeInMs);
+            OutputDebugStringA(reportStr);
+        }
+
+        const BVHStats bvhStats = scene.GetProxyBVH().GetStats();
+        snprintf(reportStr, sizeof(reportStr), "SceneProxyBVH: %u proxies, height %u, %u refits, %u rebuilds (last %.3f ms in %u steps)\n",
+            bvhStats.proxyCount, bvhStats.height, bvhStats.refitCount, bvhStats.rebuildCount, bvhStats.rebuildTimeInMs, bvhStats.rebuildStepCount);
+        OutputDebugStringA(reportStr);
+
+        const auto &visibilityStats = viewVisibilityStats;
+        snprintf(reportStr, sizeof(reportStr), "ViewVisibility: %u views, %u queries, %.3f ms, %u / %u / %u / %u in view\n",
+            visibilityStats.viewCount, visibilityStats.queryCount, visibilityStats.timeInMs,
+            visibilityStats.inViewCounts[0], visibilityStats.inViewCounts[1], visibilityStats.inViewCounts[2], visibilityStats.inViewCounts[3]);
+        OutputDebugStringA(reportStr);
+
+        if (occlusionCull) {
+            const auto &occlusionStats = occlusionCuller.GetStats();
+            snprintf(reportStr, sizeof(reportStr), "OcclusionCuller: %u occluders, %u triangles, %.3f ms, %u / %u culled\n",
+                occlusionStats.occluderCount, occlusionStats.triangleCount, occlusionStats.rasterizeTimeInMs, occlusionStats.culledCount, occlusionStats.testedCount);
+            OutputDebugStringA(reportStr);
+        }
 
-    if (0 < instanceCount) {
-        // Set vertex buffer
-        // VertexBufferZbg
-        frameData.d3dCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-        frameData.d3dCommandList->IASetVertexBuffers(0, 1, &vtxBufferView);
+        const auto &lodStats = lodSelector.GetStats();
+        snprintf(reportStr, sizeof(reportStr), "LodSelector: %u / %u / %u / %u instances per LOD, bias %.2f, frame %.3f ms\n",
+            lodStats.instanceCounts[0], lodStats.instanceCounts[1], lodStats.instanceCounts[2], lodStats.instanceCounts[3], lodStats.bias, lodStats.frameTimeInMs);
+        OutputDebugStringA(reportStr);
+
+        const auto &inputStats = inputLatencyTracker.GetStats();
+        const float inputFrameCount = static_cast<float>(std::max(inputStats.frameCount, 1u));
+        snprintf(reportStr, sizeof(reportStr), "InputLatency: %u events in %u frames, queue %.3f ms (max %.3f ms), to present %.3f ms (max %.3f ms), %u dropped\n",
+            inputStats.eventCount, inputStats.frameCount, inputStats.queueTimeInMs / inputFrameCount, inputStats.maxQueueTimeInMs,
+            inputStats.latencyInMs / inputFrameCount, inputStats.maxLatencyInMs, inputQueue.TakeDroppedCount());
+        OutputDebugStringA(reportStr);
+
+        if (TestFlag(GlobalFlag::EnableDynamicResolution)) {
+            const auto &resolutionStats = resolutionController.GetStats();
+            const float resolutionFrameCount = static_cast<float>(std::max(resolutionStats.frameCount, 1u));
+            snprintf(reportStr, sizeof(reportStr), "DynamicResolution: scale %.3f (%ux%u), GPU %.3f ms (max %.3f ms), %u / %u over budget, %u changes\n",
+                resolutionScale, renderRect.right, renderRect.bottom, resolutionStats.gpuTimeInMs / resolutionFrameCount, resolutionStats.maxGpuTimeInMs,
+                resolutionStats.overBudgetCount, resolutionStats.frameCount, resolutionStats.changeCount);
+            OutputDebugStringA(reportStr);
+        }
 
-        // Draw instaced
-        // CX^X`
-        frameData.d3dCommandList->DrawInstanced(3, instanceCount, 0, 0);
+        const auto &readbackStats = frameReadbackRing.GetStats();
+        if (readbackStats.capturedCount != 0 || readbackStats.readyCount != 0 || readbackStats.skippedCount != 0) {
+            const float readyCount = static_cast<float>(std::max(readbackStats.readyCount, 1u));
+            snprintf(reportStr, sizeof(reportStr), "FrameReadback: %u captured, %u skipped (ring full), %u ready after %.2f frames (max %u), %u delivered\n",
+                readbackStats.capturedCount, readbackStats.skippedCount, readbackStats.readyCount, readbackStats.latencyInFrames / readyCount,
+                readbackStats.maxLatencyInFrames, frameReadbackRing.TakeDeliveredCount());
+            OutputDebugStringA(reportStr);
+        }
     }
 
-    // RenderTarget -> Present
-    {
-        D3D12_RESOURCE_BARRIER d3dResBarrier;
-        d3dResBarrier.Type                   = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-        d3dResBarrier.Flags                  = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-        d3dResBarrier.Transition.pResource   = d3dRenderTarget[nextBackBufferIndex].Get();
-        d3dResBarrier.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
-        d3dResBarrier.Transition.StateAfter  = D3D12_RESOURCE_STATE_PRESENT;
-        d3dResBarrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    // The accumulated statistics restart every interval, reported or not
+    // 蓄積した統計情報は出力の有無によらずインターバル毎に再開する
+    if (statsInterval) {
+        inputLatencyTracker.ResetStats();
+        resolutionController.ResetStats();
+        frameReadbackRing.ResetStats();
+    }
 
-        frameData.d3dCommandList->ResourceBarrier(1, &d3dResBarrier);
+    // Stretch the scene over the back buffer, which also moves the back buffer to the present state
+    // シーンをバックバッファ全体へ引き伸ばし、バックバッファをPresentの状態へ移す
+    UpscaleSceneTarget(frameData.d3dCommandList.Get(), nextBackBufferIndex, resolutionScale);
+
+    // Copy the frame out when requested, a frame finding every slot busy leaves the request to the next one
+    // 要求された場合はフレームをコピーし、全スロットが使用中のフレームは要求を次のフレームに任せる
+    if (requestedReadbackCount.load(std::memory_order_relaxed) != 0) {
+        const UINT slotIndex = frameReadbackRing.Acquire(renderFrameCount, &frameData.readbackFenceValue);
+        if (slotIndex != INVALID_READBACK_SLOT) {
+            CopyToReadbackSlot(frameData.d3dCommandList.Get(), nextBackBufferIndex, slotIndex);
+            requestedReadbackCount.fetch_sub(1);
+        }
     }
 
+    // The end timestamp is resolved once the frame has finished, and read by the next Render of this frame data
+    // 終了のタイムスタンプはフレームの完了時に解決され、このフレームデータの次のRenderで読み込む
+    frameData.d3dCommandList->EndQuery(d3dTimestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, queryIndex + 1);
+    frameData.d3dCommandList->ResolveQueryData(d3dTimestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, queryIndex, 2, d3dTimestampReadbackBuffer.Get(), sizeof(UINT64) * queryIndex);
+    frameData.timestampsPending = true;
+
     // Close command list
-    // CommandList
+    // CommandListを閉じる
     frameData.d3dCommandList->Close();
 
-    // Set the fence for GPU synchronization
-    // GPUptFXZbg
-    d3dCommandQueue->Signal(frameData.d3dFence.Get(), frameData.fenceValue);
+    // The fence for GPU synchronization is set by PopulateCommandList after the command list
+    // GPU同期用フェンスはPopulateCommandListがCommandListの後にセットする
     frameData.syncGPU = true;
+
+    // Coarsen the LODs while the RenderThread work of a frame is over budget
+    // フレームのRenderThreadの処理が予算を超えている間はLODを粗くする
+    float frameTimeInMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - beginTime).count();
+    if (occlusionCull) {
+        frameTimeInMs += occlusionCuller.GetStats().rasterizeTimeInMs;
+    }
+    lodSelector.UpdateBias(frameTimeInMs);
+}
+
+// Stretch the part of the scene target holding the frame over the back buffer
+// シーンターゲットのフレームを保持する部分をバックバッファ全体へ引き伸ばす
+void MTRenderer::UpscaleSceneTarget(ID3D12GraphicsCommandList *d3dCommandList, UINT frameIndex, float scale) {
+    // SceneTarget: RenderTarget -> PixelShaderResource, BackBuffer: Present -> RenderTarget
+    D3D12_RESOURCE_BARRIER d3dResBarriers[2];
+    d3dResBarriers[0].Type                   = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    d3dResBarriers[0].Flags                  = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+    d3dResBarriers[0].Transition.pResource   = d3dSceneTarget[frameIndex].Get();
+    d3dResBarriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
+    d3dResBarriers[0].Transition.StateAfter  = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+    d3dResBarriers[0].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    d3dResBarriers[1]                        = d3dResBarriers[0];
+    d3dResBarriers[1].Transition.pResource   = d3dRenderTarget[frameIndex].Get();
+    d3dResBarriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;
+    d3dResBarriers[1].Transition.StateAfter  = D3D12_RESOURCE_STATE_RENDER_TARGET;
+    d3dCommandList->ResourceBarrier(_countof(d3dResBarriers), d3dResBarriers);
+
+    D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = d3dRTVHeap->GetCPUDescriptorHandleForHeapStart();
+    rtvHandle.ptr += static_cast<SIZE_T>(frameIndex) * static_cast<SIZE_T>(rtvDescriptorSize);
+    d3dCommandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
+
+    const D3D12_VIEWPORT viewport    = { 0.0f, 0.0f, static_cast<float>(canvasWidth), static_cast<float>(canvasHeight), 0.0f, 1.0f };
+    const D3D12_RECT     scissorRect = { 0, 0, static_cast<LONG>(canvasWidth), static_cast<LONG>(canvasHeight) };
+    d3dCommandList->RSSetViewports(1, &viewport);
+    d3dCommandList->RSSetScissorRects(1, &scissorRect);
+
+    // The SRVs of the scene targets follow the CBVs
+    // シーンターゲットのSRVはCBVに続く
+    D3D12_GPU_DESCRIPTOR_HANDLE srvHandle = d3dCBVHeap->GetGPUDescriptorHandleForHeapStart();
+    srvHandle.ptr += static_cast<UINT64>(DEFAULT_CBV_COUNT * backBufferCount + frameIndex) * d3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    // Stop half a texel short of the drawn part, so the bilinear filter does not pull in the stale texels beyond it
+    // バイリニアフィルタがその先の古いテクセルを取り込まないよう、描画した部分の半テクセル手前で止める
+    const D3D12_RECT renderRect = ScaleRect(scissorRect, scale);
+    const float upscaleConstants[4] = {
+        static_cast<float>(renderRect.right) / canvasWidth,
+        static_cast<float>(renderRect.bottom) / canvasHeight,
+        (static_cast<float>(renderRect.right) - 0.5f) / canvasWidth,
+        (static_cast<float>(renderRect.bottom) - 0.5f) / canvasHeight,
+    };
+
+    d3dCommandList->SetGraphicsRootSignature(d3dUpscaleRootSignature.Get());
+    d3dCommandList->SetPipelineState(d3dUpscalePipelineState.Get());
+    d3dCommandList->SetGraphicsRootDescriptorTable(0, srvHandle);
+    d3dCommandList->SetGraphicsRoot32BitConstants(1, _countof(upscaleConstants), upscaleConstants, 0);
+    d3dCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    d3dCommandList->DrawInstanced(3, 1, 0, 0);
+
+    // SceneTarget: PixelShaderResource -> RenderTarget, BackBuffer: RenderTarget -> Present
+    std::swap(d3dResBarriers[0].Transition.StateBefore, d3dResBarriers[0].Transition.StateAfter);
+    std::swap(d3dResBarriers[1].Transition.StateBefore, d3dResBarriers[1].Transition.StateAfter);
+    d3dCommandList->ResourceBarrier(_countof(d3dResBarriers), d3dResBarriers);
+}
+
+// Copy the back buffer into a readback slot
+// バックバッファを読み戻しスロットへコピー
+void MTRenderer::CopyToReadbackSlot(ID3D12GraphicsCommandList *d3dCommandList, UINT frameIndex, UINT slotIndex) {
+    // Present -> CopySource
+    D3D12_RESOURCE_BARRIER d3dResBarrier;
+    d3dResBarrier.Type                   = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    d3dResBarrier.Flags                  = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+    d3dResBarrier.Transition.pResource   = d3dRenderTarget[frameIndex].Get();
+    d3dResBarrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;
+    d3dResBarrier.Transition.StateAfter  = D3D12_RESOURCE_STATE_COPY_SOURCE;
+    d3dResBarrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    d3dCommandList->ResourceBarrier(1, &d3dResBarrier);
+
+    D3D12_TEXTURE_COPY_LOCATION dstLocation = {};
+    dstLocation.pResource       = d3dReadbackBuffer[slotIndex].Get();
+    dstLocation.Type            = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+    dstLocation.PlacedFootprint = readbackFootprint;
+
+    D3D12_TEXTURE_COPY_LOCATION srcLocation = {};
+    srcLocation.pResource        = d3dRenderTarget[frameIndex].Get();
+    srcLocation.Type             = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    srcLocation.SubresourceIndex = 0;
+
+    d3dCommandList->CopyTextureRegion(&dstLocation, 0, 0, 0, &srcLocation, nullptr);
+
+    // CopySource -> Present
+    std::swap(d3dResBarrier.Transition.StateBefore, d3dResBarrier.Transition.StateAfter);
+    d3dCommandList->ResourceBarrier(1, &d3dResBarrier);
+}
+
+// Hand a finished readback slot to the consumer
+// 完了した読み戻しスロットを消費者へ渡す
+void MTRenderer::DeliverReadbackSlot(UINT slotIndex, UINT64 frameNumber) {
+    if (!frameReadbackConsumer) {
+        return;
+    }
+
+    D3D12_RANGE readRange = { 0, static_cast<SIZE_T>(readbackBufferSize) };
+    UINT8 *pixels = nullptr;
+    if (FAILED(d3dReadbackBuffer[slotIndex]->Map(0, &readRange, reinterpret_cast<void **>(&pixels)))) {
+        return;
+    }
+
+    ReadbackFrame frame;
+    frame.frameNumber = frameNumber;
+    frame.width       = readbackFootprint.Footprint.Width;
+    frame.height      = readbackFootprint.Footprint.Height;
+    frame.rowPitch    = readbackFootprint.Footprint.RowPitch;
+    frame.pixels      = pixels + readbackFootprint.Offset;
+    frameReadbackConsumer(frame);
+
+    D3D12_RANGE writtenRange = { 0, 0 };
+    d3dReadbackBuffer[slotIndex]->Unmap(0, &writtenRange);
+}
+
+// Record the sorted render queue as instanced draws over runs of equal state
+// ソート済みの描画キューを等しいステートの連続毎にインスタンス描画として記録
+void MTRenderer::SubmitRenderQueue(ID3D12GraphicsCommandList *d3dCommandList, D3D12_GPU_VIRTUAL_ADDRESS cbLocation, UINT itemCount, bool depthOnly, CommandListState *state, RenderSubmitStats *stats) {
+    const RenderItem *renderItems = renderQueue.GetItems();
+    const UINT64 opaquePass = static_cast<UINT64>(RenderPass::Opaque);
+    const bool useBundles = TestFlag(GlobalFlag::EnableBundleCache);
+
+    // Consecutive runs of a pipeline are gathered into a key and replayed together from a bundle
+    // 同じパイプラインの連続した描画はキーへまとめ、バンドルからまとめて再生する
+    BundleKey &key = bundleKey;
+    key.cbLocation = cbLocation;
+    key.depthOnly  = depthOnly ? 1 : 0;
+    key.runCount   = 0;
+
+    for (UINT runBegin = 0; runBegin < itemCount;) {
+        const UINT64 sortKey  = renderItems[runBegin].sortKey;
+        const UINT64 stateKey = RenderQueue::GetStateKey(sortKey);
+
+        UINT runEnd = runBegin + 1;
+        while (runEnd < itemCount && RenderQueue::GetStateKey(renderItems[runEnd].sortKey) == stateKey) {
+            runEnd++;
+        }
+
+        // Only opaque items write depth in the prepass, passes are sorted so the rest follows them
+        // プリパスで深度を書き込むのは不透明要素のみ、パス順にソートされている為残りはその後に続く
+        if (depthOnly && (sortKey >> SORT_KEY_PASS_SHIFT) != opaquePass) {
+            break;
+        }
+
+        const UINT pipelineIndex = RenderQueue::GetPipeline(sortKey);
+        const UINT meshIndex     = RenderQueue::GetMesh(sortKey);
+        if (drawPipelines.size() <= pipelineIndex || drawMeshes.size() <= meshIndex) {
+            runBegin = runEnd;
+            continue;
+        }
+
+        // The depth is dropped so the run only names what is recorded
+        // 深度を除き、連続は記録される内容のみを表す
+        BundleRun run;
+        run.stateKey       = stateKey << SORT_KEY_DEPTH_BITS;
+        run.instanceOffset = runBegin;
+        run.instanceCount  = runEnd - runBegin;
+        runBegin = runEnd;
+
+        if (!useBundles) {
+            RecordRun(d3dCommandList, cbLocation, depthOnly, run, state, stats);
+            continue;
+        }
+
+        if (key.runCount == MAX_BUNDLE_RUN_COUNT || (key.runCount != 0 && RenderQueue::GetPipeline(key.runs[0].stateKey) != pipelineIndex)) {
+            SubmitBundleRuns(d3dCommandList, key, state, stats);
+            key.runCount = 0;
+        }
+        key.runs[key.runCount++] = run;
+    }
+
+    if (key.runCount != 0) {
+        SubmitBundleRuns(d3dCommandList, key, state, stats);
+    }
+}
+
+// Record the runs of a bundle key, from its bundle when the cache has one
+// バンドルキーの連続を記録、キャッシュがバンドルを持つ場合はそこから記録する
+void MTRenderer::SubmitBundleRuns(ID3D12GraphicsCommandList *d3dCommandList, const BundleKey &key, CommandListState *state, RenderSubmitStats *stats) {
+    const bool depthOnly = (key.depthOnly != 0);
+
+    // A bundle starts from an undefined state, so it sets everything its draws need
+    // バンドルは未定義のステートから始まる為、描画に必要な全てをセットする
+    ID3D12GraphicsCommandList *d3dBundle = bundleCache.Acquire(key, [&](ID3D12GraphicsCommandList *d3dRecordBundle) {
+        CommandListState bundleState;
+        bundleState.d3dPipelineState = nullptr;
+        bundleState.d3dRootSignature = nullptr;
+        bundleState.materialIndex    = ~0u;
+        bundleState.meshIndex        = ~0u;
+        bundleState.lodIndex         = ~0u;
+
+        RenderSubmitStats bundleStats;
+        d3dRecordBundle->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        for (UINT i = 0; i < key.runCount; ++i) {
+            RecordRun(d3dRecordBundle, key.cbLocation, depthOnly, key.runs[i], &bundleState, &bundleStats);
+        }
+    });
+
+    if (d3dBundle == nullptr) {
+        for (UINT i = 0; i < key.runCount; ++i) {
+            RecordRun(d3dCommandList, key.cbLocation, depthOnly, key.runs[i], state, stats);
+        }
+        return;
+    }
+    d3dCommandList->ExecuteBundle(d3dBundle);
+
+    // The state the bundle ends with is left on the command list
+    // バンドルの最後のステートはCommandListに残る
+    const UINT64 lastStateKey = key.runs[key.runCount - 1].stateKey;
+    const auto &pipeline = drawPipelines[RenderQueue::GetPipeline(lastStateKey)];
+    state->d3dPipelineState = depthOnly ? pipeline.d3dDepthOnlyPipelineState.Get() : pipeline.d3dPipelineState.Get();
+    state->d3dRootSignature = pipeline.d3dRootSignature.Get();
+    state->meshIndex        = RenderQueue::GetMesh(lastStateKey);
+    state->lodIndex         = RenderQueue::GetLod(lastStateKey);
+    if (!depthOnly) {
+        state->materialIndex = RenderQueue::GetMaterial(lastStateKey);
+    }
+
+    stats->bundleCount++;
+    stats->bundledDrawCount += key.runCount;
+    stats->drawCount        += key.runCount;
+    for (UINT i = 0; i < key.runCount; ++i) {
+        if (depthOnly) {
+            stats->prepassDrawCount++;
+        } else {
+            stats->instanceCount += key.runs[i].instanceCount;
+        }
+    }
+}
+
+// Record the instanced draw of a run and the state changes it needs
+// 連続のインスタンス描画と必要なステート変更を記録
+void MTRenderer::RecordRun(ID3D12GraphicsCommandList *d3dCommandList, D3D12_GPU_VIRTUAL_ADDRESS cbLocation, bool depthOnly, const BundleRun &run, CommandListState *state, RenderSubmitStats *stats) {
+    const UINT pipelineIndex = RenderQueue::GetPipeline(run.stateKey);
+    const UINT materialIndex = RenderQueue::GetMaterial(run.stateKey);
+    const UINT meshIndex     = RenderQueue::GetMesh(run.stateKey);
+    const UINT lodIndex      = RenderQueue::GetLod(run.stateKey);
+
+    const auto &pipeline = drawPipelines[pipelineIndex];
+    ID3D12PipelineState *d3dPipelineState = depthOnly ? pipeline.d3dDepthOnlyPipelineState.Get() : pipeline.d3dPipelineState.Get();
+    if (d3dPipelineState != state->d3dPipelineState) {
+        d3dCommandList->SetPipelineState(d3dPipelineState);
+        state->d3dPipelineState = d3dPipelineState;
+        stats->pipelineChanges++;
+    }
+
+    // Root arguments are lost when the root signature changes
+    // RootSignatureが変わるとルート引数は失われる
+    if (pipeline.d3dRootSignature.Get() != state->d3dRootSignature) {
+        d3dCommandList->SetGraphicsRootSignature(pipeline.d3dRootSignature.Get());
+        d3dCommandList->SetGraphicsRootConstantBufferView(0, cbLocation);
+        state->d3dRootSignature = pipeline.d3dRootSignature.Get();
+        stats->rootSignatureChanges++;
+    }
+
+    // Materials have no resources to bind yet, only the change is counted
+    // マテリアルはまだバインドするリソースを持たない為、変化のみ数える
+    if (!depthOnly && materialIndex != state->materialIndex) {
+        state->materialIndex = materialIndex;
+        stats->materialChanges++;
+    }
+
+    const auto &mesh = drawMeshes[meshIndex].GetLod(lodIndex);
+    if (meshIndex != state->meshIndex || lodIndex != state->lodIndex) {
+        d3dCommandList->IASetVertexBuffers(0, 1, &mesh.vtxBufferView);
+        d3dCommandList->IASetIndexBuffer(&mesh.idxBufferView);
+        state->meshIndex = meshIndex;
+        state->lodIndex  = lodIndex;
+        stats->vertexBufferChanges++;
+    }
+
+    // Draw instaced
+    // インスタンス描画
+    d3dCommandList->SetGraphicsRoot32BitConstant(1, run.instanceOffset, 0);
+    d3dCommandList->DrawIndexedInstanced(mesh.indexCount, run.instanceCount, 0, 0, 0);
+    stats->drawCount++;
+    if (depthOnly) {
+        stats->prepassDrawCount++;
+    } else {
+        stats->instanceCount += run.instanceCount;
+    }
+}
+
+// Write the sorted render queue as indirect draw records and submit one ExecuteIndirect per pipeline
+// ソート済みの描画キューを間接描画のレコードとして書き込み、パイプライン毎に1回のExecuteIndirectを発行
+bool MTRenderer::SubmitIndirect(ID3D12GraphicsCommandList *d3dCommandList, D3D12_GPU_VIRTUAL_ADDRESS cbLocation, UINT itemCount, bool depthOnly, ID3D12Resource *d3dArgBuffer, IndirectDrawRecord *dstRecords, UINT *recordCount, CommandListState *state, RenderSubmitStats *stats) {
+    if (dstRecords == nullptr || DEFAULT_INDIRECT_RECORD_CAPACITY - *recordCount < itemCount) {
+        return false;
+    }
+    const auto beginTime = std::chrono::high_resolution_clock::now();
+
+    IndirectDrawBuildDesc buildDesc;
+    buildDesc.items         = renderQueue.GetItems();
+    buildDesc.itemCount     = itemCount;
+    buildDesc.depthOnly     = depthOnly;
+    buildDesc.meshRanges    = indirectMeshRanges.data();
+    buildDesc.meshCount     = static_cast<UINT>(drawMeshes.size());
+    buildDesc.pipelineCount = static_cast<UINT>(drawPipelines.size());
+
+    // The records are written straight into the upload buffer of the frame
+    // レコードはフレームのアップロードバッファへ直接書き込む
+    const UINT firstRecord = *recordCount;
+    IndirectDrawBatch *batches = ScratchArena::GetThreadArena()->AllocateArray<IndirectDrawBatch>(std::max(itemCount, 1u));
+    IndirectDrawBuildResult buildResult;
+    IndirectDrawBuilder::Build(buildDesc, &jobSystem, dstRecords + firstRecord, batches, &buildResult);
+    *recordCount += buildResult.recordCount;
+    stats->indirectBuildTimeInMs += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - beginTime).count();
+
+    // Every mesh is drawn from the pools, only the pipeline changes between the batches
+    // 全メッシュをプールから描画する為、バッチ間で変わるのはパイプラインのみ
+    if (buildResult.batchCount != 0) {
+        d3dCommandList->IASetVertexBuffers(0, 1, &geometryVtxPoolView);
+        d3dCommandList->IASetIndexBuffer(&geometryIdxPoolView);
+        state->meshIndex = ~0u;
+        state->lodIndex  = ~0u;
+        stats->vertexBufferChanges++;
+    }
+
+    for (UINT b = 0; b < buildResult.batchCount; ++b) {
+        const IndirectDrawBatch &batch = batches[b];
+        const auto &pipeline = drawPipelines[batch.pipelineIndex];
+        ID3D12PipelineState *d3dPipelineState = depthOnly ? pipeline.d3dDepthOnlyPipelineState.Get() : pipeline.d3dPipelineState.Get();
+        if (d3dPipelineState != state->d3dPipelineState) {
+            d3dCommandList->SetPipelineState(d3dPipelineState);
+            state->d3dPipelineState = d3dPipelineState;
+            stats->pipelineChanges++;
+        }
+
+        // Root arguments are lost when the root signature changes
+        // RootSignatureが変わるとルート引数は失われる
+        if (pipeline.d3dRootSignature.Get() != state->d3dRootSignature) {
+            d3dCommandList->SetGraphicsRootSignature(pipeline.d3dRootSignature.Get());
+            d3dCommandList->SetGraphicsRootConstantBufferView(0, cbLocation);
+            state->d3dRootSignature = pipeline.d3dRootSignature.Get();
+            stats->rootSignatureChanges++;
+        }
+
+        const UINT64 argOffset = sizeof(IndirectDrawRecord) * static_cast<UINT64>(firstRecord + batch.firstRecord);
+        d3dCommandList->ExecuteIndirect(pipeline.d3dCommandSignature.Get(), batch.recordCount, d3dArgBuffer, argOffset, nullptr, 0);
+        stats->indirectCount++;
+        stats->drawCount += batch.recordCount;
+        if (depthOnly) {
+            stats->prepassDrawCount += batch.recordCount;
+        }
+    }
+    if (!depthOnly) {
+        stats->instanceCount += buildResult.instanceCount;
+    }
+    return true;
+}
+
+// Record one instanced draw per emitter of the committed particles
+// 伝達済みのパーティクルのエミッタ毎に1回のインスタンス描画を記録
+void MTRenderer::SubmitParticles(ID3D12GraphicsCommandList *d3dCommandList, D3D12_GPU_VIRTUAL_ADDRESS cbLocation, ID3D12Resource *d3dInstanceBuffer, CommandListState *state) {
+    const ParticleFrame &particleFrame = committedParticleFrame;
+    if (particleFrame.drawCount == 0) {
+        return;
+    }
+
+    if (d3dRootSignature.Get() != state->d3dRootSignature) {
+        d3dCommandList->SetGraphicsRootSignature(d3dRootSignature.Get());
+        d3dCommandList->SetGraphicsRootConstantBufferView(0, cbLocation);
+        state->d3dRootSignature = d3dRootSignature.Get();
+    }
+    d3dCommandList->SetPipelineState(d3dParticlePipelineState.Get());
+    state->d3dPipelineState = d3dParticlePipelineState.Get();
+
+    // The quad replaces the vertex buffer of the meshes
+    // 四角形がメッシュの頂点バッファを置き換える
+    D3D12_VERTEX_BUFFER_VIEW vtxBufferViews[2];
+    vtxBufferViews[0]                = particleQuadVtxBufferView;
+    vtxBufferViews[1].BufferLocation = d3dInstanceBuffer->GetGPUVirtualAddress();
+    vtxBufferViews[1].StrideInBytes  = sizeof(ParticleInstance);
+    vtxBufferViews[1].SizeInBytes    = sizeof(ParticleInstance) * particleFrame.instanceCount;
+    d3dCommandList->IASetVertexBuffers(0, _countof(vtxBufferViews), vtxBufferViews);
+    d3dCommandList->IASetIndexBuffer(&particleQuadIdxBufferView);
+    state->meshIndex = ~0u;
+    state->lodIndex  = ~0u;
+
+    for (UINT i = 0; i < particleFrame.drawCount; ++i) {
+        const ParticleDraw &draw = particleFrame.draws[i];
+        d3dCommandList->DrawIndexedInstanced(6, draw.instanceCount, 0, 0, draw.instanceOffset);
+    }
+}
+
+// Find the views each mesh proxy is visible in, with one parallel pass over the BVH shared by all views
+// 全ビューで共有するBVHの1回の並列走査で、各メッシュProxyが可視であるビューを求める
+void MTRenderer::ComputeViewVisibility(const ViewFrustum *frustums, UINT viewCount, ScratchArena *arena, UINT8 *dstEntityViewMasks) {
+    const auto beginTime = std::chrono::high_resolution_clock::now();
+
+    // The top of the tree is culled while it is split into a few subtrees per thread
+    // ツリーの上部はスレッドあたり数個の部分木に分割する間にカリングされる
+    const UINT maxQueryCount = (jobSystem.GetWorkerCount() + 1) * DEFAULT_VIEW_QUERIES_PER_THREAD;
+    BVHViewQueryEntry *queries = arena->AllocateArray<BVHViewQueryEntry>(maxQueryCount);
+    UINT *queryInViewCounts = arena->AllocateArray<UINT>(maxQueryCount * MAX_VIEW_COUNT);
+    const UINT queryCount = scene.GetProxyBVH().SplitViewQuery(frustums, viewCount, maxQueryCount, queries);
+
+    // Each proxy is a leaf of exactly one subtree, so the queries write disjoint masks
+    // 各Proxyはちょうど1つの部分木の葉である為、クエリは互いに重ならないマスクへ書き込む
+    jobSystem.ParallelFor(queryCount, 1, [&](UINT begin, UINT end) {
+        for (UINT query = begin; query < end; ++query) {
+            UINT inViewCounts[MAX_VIEW_COUNT] = {};
+            scene.GetProxyBVH().QueryFrustums(frustums, viewCount, queries[query], [&](UINT entity, UINT viewMask) {
+                dstEntityViewMasks[entity & ENTITY_INDEX_MASK] = static_cast<UINT8>(viewMask);
+                for (UINT view = 0; view < viewCount; ++view) {
+                    inViewCounts[view] += (viewMask >> view) & 1u;
+                }
+            });
+            memcpy(&queryInViewCounts[query * MAX_VIEW_COUNT], inViewCounts, sizeof(inViewCounts));
+        }
+    });
+
+    ViewVisibilityStats stats;
+    stats.viewCount  = viewCount;
+    stats.queryCount = queryCount;
+    for (UINT query = 0; query < queryCount; ++query) {
+        for (UINT view = 0; view < MAX_VIEW_COUNT; ++view) {
+            stats.inViewCounts[view] += queryInViewCounts[query * MAX_VIEW_COUNT + view];
+        }
+    }
+    stats.timeInMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - beginTime).count();
+    viewVisibilityStats = stats;
 }
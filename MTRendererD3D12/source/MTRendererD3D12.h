@@ -3,6 +3,28 @@
 
 #pragma once
 
+#include "MeshAsset.h"
+#include "AnimationClip.h"
+#include "AnimationSystem.h"
+#include "Benchmark.h"
+#include "BoundingVolumeHierarchy.h"
+#include "CommandBundleCache.h"
+#include "DynamicResolution.h"
+#include "EntityWorld.h"
+#include "FrameReadback.h"
+#include "FrameRecord.h"
+#include "IndirectDrawBuilder.h"
+#include "InputQueue.h"
+#include "JobSystem.h"
+#include "LodSelector.h"
+#include "OcclusionCuller.h"
+#include "ParticleSystem.h"
+#include "RenderQueue.h"
+#include "Scene.h"
+#include "SceneFeed.h"
+#include "ScratchArena.h"
+#include "ThreadTopology.h"
+
 using Microsoft::WRL::ComPtr;
 
 // Default value
@@ -14,428 +36,355 @@ const UINT DEFAULT_CBV_COUNT              = 64;
 const UINT DEFAULT_SRV_COUNT              = 64;
 const UINT DEFAULT_UAV_COUNT              = 32;
 const UINT DEFAULT_SAMPLER_COUNT          = 64;
-const size_t DEFAULT_SCENE_ACTOR_CAPACITY = 32;
-const size_t DEFAULT_SCENE_PROXY_CAPACITY = 32;
-
-
-/// @enum SceneActorType
-enum class SceneActorType : UINT {
-    Camera,     ///< @~ CameraActor
-    Triangle,   ///< @~ TriangleActor
-};
-
-/// @enum SceneProxyType
-enum class SceneProxyType : UINT {
-    Camera,     ///< @~ CameraActor
-    Triangle,   ///< @~ TriangleActor
-};
-
-
-/// @class SceneActor
-class SceneActor {
-public:
-    /// @~english Translation component
-    /// @~japanese sړ
-    DirectX::XMVECTOR   translation;
-
-    /// @~english Rotation component
-    /// @~japanese ]
-    DirectX::XMVECTOR   rotation;
-
-    /// @~english Scale component
-    /// @~japanese XP[
-    DirectX::XMVECTOR   scale;
-
-    /// @~english
-    /// @brief Update process
-    /// @param[in] delta Time taken between frames (seconds
-    /// @~japanese
-    /// @brief XV
-    /// @param[in] delta t[ԂɊ|ԁib
-    virtual void Update(float delta) = 0;
-
-    /// @~english
-    /// @brief Get actor type
-    /// @return SceneActorType
-    /// @~japanese
-    /// @brief SceneActorType擾
-    /// @return SceneActorType
-    SceneActorType GetActorType() const {
-        return type;
+const UINT MAIN_THREAD_ARENA_COUNT        = 2;
+const UINT DEFAULT_RENDER_STATS_INTERVAL  = 300;
+const UINT DEFAULT_PARTICLE_UPLOAD_BATCH_SIZE = 65536;
+const UINT MAX_VIEW_COUNT                 = 4;
+const UINT DEFAULT_VIEW_QUERIES_PER_THREAD = 4;
+const UINT DEFAULT_INDIRECT_RECORD_CAPACITY = MAX_VIEW_COUNT * 2 * MAX_SCENE_INSTANCE_COUNT;
+
+static_assert(MAX_VIEW_COUNT <= MAX_BVH_QUERY_VIEW_COUNT && MAX_VIEW_COUNT <= 8, "The views of a proxy must fit in a byte and in one BVH query.");
+static_assert(sizeof(IndirectDrawRecord) == sizeof(UINT) + sizeof(D3D12_DRAW_INDEXED_ARGUMENTS) && offsetof(IndirectDrawRecord, indexCountPerInstance) == sizeof(UINT),
+    "An indirect draw record must be the draw constant followed by the indexed draw arguments.");
+const DXGI_FORMAT DEFAULT_DEPTH_FORMAT    = DXGI_FORMAT_D32_FLOAT;
+
+
+
+/// @~english
+/// @brief Statistics of the visibility pass shared by the views
+/// @~japanese
+/// @brief ビューで共有する可視判定処理の統計情報
+/// @~
+/// @struct ViewVisibilityStats
+struct ViewVisibilityStats {
+    UINT    viewCount;
+    UINT    queryCount;                     ///< @~english Subtrees queried in parallel @~japanese 並列にクエリした部分木の数
+    UINT    inViewCounts[MAX_VIEW_COUNT];
+    float   timeInMs;
+
+    /// @brief コンストラクタ
+    ViewVisibilityStats()
+    : viewCount(0)
+    , queryCount(0)
+    , inViewCounts()
+    , timeInMs(0.0f)
+    {
+        ;
     }
-
-    /// @~english 
-    /// @brief Constructor
-    /// @param[in] inType Actor type
-    /// @~japanese
-    /// @brief RXgN^
-    /// @param[in] inType AN^̎
-    SceneActor(SceneActorType inType);
-
-    /// @~english
-    /// @brief Destructor
-    /// @~japanese
-    /// @brief fXgN^
-    virtual ~SceneActor();
-
-protected:
-    /// @~english Actor type
-    /// @~japanese Actor̎
-    SceneActorType      type;
 };
 
-/// @class TriangleSceneActor
-class TriangleSceneActor : public SceneActor {
-friend class TriangleSceneProxy;
-
-public:
-    /// @~english
-    /// @brief Update process
-    /// @param[in] delta Time taken between frames (seconds
-    /// @~japanese
-    /// @brief XV
-    /// @param[in] delta t[ԂɊ|ԁib
-    virtual void Update(float delta) override;
-
-    /// @~english
-    /// @brief Set the speed at which the rotation is updated
-    /// @~japanese
-    /// @brief ]XV鑬xZbg
-    void SetRotSpeed(const float newSpeed) {
-        rotSpeed = newSpeed;
-    }
-
-    /// @~english
-    /// @brief Get the speed at which the rotation is updated
-    /// @return Rotation speed
-    /// @~japanese
-    /// @brief ]XV鑬x擾
-    /// @return ]x
-    float GetRotSpeed() const {
-        return rotSpeed;
-    }
-
-    /// @~english
-    /// @brief Set the speed at which the scale is updated
-    /// @~japanese
-    /// @brief XP[XV鑬xZbg
-    void SetScaleSpeed(const float newSpeed) {
-        scaleSpeed = newSpeed;
-    }
 
-    /// @~english
-    /// @brief Get the speed at which the scale is updated
-    /// @return Scale speed
-    /// @~japanese
-    /// @brief XP[XV鑬x擾
-    /// @return XP[x
-    float GetScaleSpeed() const {
-        return scaleSpeed;
-    }
-    
-    /// @~english 
-    /// @brief Constructor
-    /// @~japanese
-    /// @brief RXgN^
-    TriangleSceneActor();
-
-    /// @~english
-    /// @brief Destructor
-    /// @~japanese
-    /// @brief fXgN^
-    virtual ~TriangleSceneActor();
-
-protected:
-    float   rotSpeed;
-    float   scaleSpeed;
-
-    float rotAngle;
-    float scaleAngle;
+/// @enum GlobalFlag
+enum class GlobalFlag : UINT {
+    TerminateRenderer       = (1u << 0u),
+    EnableDepthPrepass      = (1u << 1u),   ///< @~english Lay down depth before the opaque pass @~japanese 不透明パスの前に深度を書き込む
+    EnableOcclusionCull     = (1u << 2u),   ///< @~english Skip the proxies hidden by occluders @~japanese 遮蔽物に隠れたProxyを描画しない
+    EnableBundleCache       = (1u << 3u),   ///< @~english Replay the unchanged draw sequences from bundles @~japanese 変化の無い描画の並びをバンドルから再生する
+    EnableIndirectDraw      = (1u << 4u),   ///< @~english Submit the render queue with one ExecuteIndirect per pipeline @~japanese 描画キューをパイプライン毎に1回のExecuteIndirectで発行する
+    EnableThreadPinning     = (1u << 5u),   ///< @~english Pin the threads to logical processors, read once in Init @~japanese スレッドを論理プロセッサに固定する、Initで一度だけ参照する
+    EnableDynamicResolution = (1u << 6u),   ///< @~english Scale the render resolution to hold the GPU frame budget @~japanese GPUのフレーム予算を保つ為に描画解像度をスケールする
+    DisableVSync            = (1u << 7u),   ///< @~english Present without waiting for the vertical blank, for throughput runs @~japanese 垂直同期を待たずに表示する、スループット計測用
+    UseWarpAdapter          = (1u << 8u),   ///< @~english Create the device on the software rasterizer, read once in Init @~japanese ソフトウェアラスタライザ上にデバイスを生成する、Initで一度だけ参照する
+    EnableStatsReport       = (1u << 9u),   ///< @~english Write the load times and the periodic statistics to the debug output @~japanese 読み込み時間と定期的な統計情報をデバッグ出力へ書き込む
 };
 
-/// @class CameraSceneActor
-class CameraSceneActor : public SceneActor {
-friend class CameraSceneProxy;
 
+/// @class MTRenderer
+class MTRenderer {
 public:
+    
     /// @~english
-    /// @brief Update process
-    /// @param[in] delta Time taken between frames (seconds
+    /// @brief Initialize
+    /// @return True if initialization succeeded, false otherwise
     /// @~japanese
-    /// @brief XV
-    /// @param[in] delta t[ԂɊ|ԁib
-    virtual void Update(float delta) override;
+    /// @brief 初期化
+    /// @return 初期化に成功した場合にはTrue、そうでないならFalseを返す
+    bool Init();
 
     /// @~english
     /// @brief Initialize
     /// @param[in] width  Screen width
     /// @param[in] height Screen height
-    /// @param[in] defFov Field of view in Degree
+    /// @param[in] inBackBufferCount Number of back buffers
+    /// @param[in] titleStr Window title string
     /// @return True if initialization succeeded, false otherwise
     /// @~japanese
-    /// @brief 
-    /// @param[in] width  XN[
-    /// @param[in] height XN[
-    /// @param[in] defFov pipx
-    /// @return ɐꍇɂTrueAłȂȂFalseԂ
-    bool Init(const UINT width, const UINT height, const float degFov);
-
-    /// @~english 
-    /// @brief Constructor
-    /// @~japanese
-    /// @brief RXgN^
-    CameraSceneActor();
+    /// @brief 初期化
+    /// @param[in] width  スクリーン幅
+    /// @param[in] height スクリーン高さ
+    /// @param[in] inBackBufferCount バックバッファ数
+    /// @param[in] titleStr ウィンドウタイトル文字列
+    /// @return 初期化に成功した場合にはTrue、そうでないならFalseを返す
+    bool Init(const UINT width, const UINT height, const UINT inBackBufferCount, LPCWSTR titleStr);
 
     /// @~english
-    /// @brief Destructor
+    /// @brief Run the MTRenderer
+    /// @return Return code
     /// @~japanese
-    /// @brief fXgN^
-    ~CameraSceneActor();
-
-protected:
-    UINT    screenWidth;
-    UINT    screenHeight;
-    float   fovInDeg;
-
-    DirectX::XMVECTOR   cameraEye;
-    DirectX::XMVECTOR   cameraAt;
-    DirectX::XMVECTOR   cameraUp;
-};
-
+    /// @brief MTRendererを実行
+    /// @return 終了ステータス
+    int Run();
 
-/// @class SceneProxy
-class SceneProxy {
-public:
     /// @~english
-    /// @brief Transfer render information from Actor to Proxy
-    /// @param[in] actor Pointer to actor
+    /// @brief Deinitialize
     /// @~japanese
-    /// @brief ActorProxy֕``B
-    /// @param[in] actor AN^ւ̃|C^
-    virtual void Commit(SceneActor *actor) = 0;
+    /// @brief 終了処理
+    void Deinit();
 
     /// @~english
-    /// @brief Get proxy type
-    /// @return SceneProxyType
-    /// @~japanese
-    /// @brief SceneProxyType擾
-    /// @return SceneProxyType
-    SceneProxyType GetProxyType() const {
-        return type;
-    }
-
-    /// @~english 
-    /// @brief Constructor
-    /// @param[in] inType Actor type
+    /// @brief Set the specified flag
     /// @~japanese
-    /// @brief RXgN^
-    /// @param[in] inType AN^̎
-    SceneProxy(SceneProxyType inType);
+    /// @brief 指定したフラグをセット
+    void SetFlag(const GlobalFlag flag);
 
     /// @~english
-    /// @brief Destructor
+    /// @brief Clear the specified flag
     /// @~japanese
-    /// @brief fXgN^
-    virtual ~SceneProxy();
-
-protected:
-    SceneProxyType type;
-};
+    /// @brief 指定したフラグをクリア
+    void ClearFlag(const GlobalFlag flag);
 
-/// @class TriangleSceneProxy
-class TriangleSceneProxy : public SceneProxy {
-public:
     /// @~english
-    /// @brief Transfer render information from Actor to Proxy
-    /// @param[in] actor Pointer to actor
+    /// @brief Test the specified flag
+    /// @return True if specified flag is set, false otherwise
     /// @~japanese
-    /// @brief ActorProxy֕``B
-    /// @param[in] actor AN^ւ̃|C^
-    virtual void Commit(SceneActor *actor) override;
+    /// @brief 指定したフラグがセットされているか調べる
+    /// @return 指定したフラグがセットされていればTrue、そうでないならFalse
+    bool TestFlag(const GlobalFlag flag);
 
     /// @~english
-    /// @brief Get the world transformation matrix
-    /// @return World transformation matrix
+    /// @brief Queue an input event for the next MainThread frame, never blocks
+    /// @param[in] event Event stamped with InputQueue::GetTimestamp()
+    /// @return True if the event was queued, false if the queue was full
     /// @~japanese
-    /// @brief Worldϊs擾
-    /// @return Worldϊs
-    void GetWorldMatrix(DirectX::XMFLOAT4X4 *dstWorldMtx) {
-        XMStoreFloat4x4(dstWorldMtx, worldMtx);
+    /// @brief 次のMainThreadのフレームへ入力イベントを追加、ブロックしない
+    /// @param[in] event InputQueue::GetTimestamp()を記録したイベント
+    /// @return イベントを追加した場合にはTrue、キューが満杯の場合はFalseを返す
+    bool PushInputEvent(const InputEvent &event) {
+        return inputQueue.Push(event);
     }
 
-    /// @~english 
-    /// @brief Constructor
-    /// @~japanese
-    /// @brief RXgN^
-    TriangleSceneProxy();
-
     /// @~english
-    /// @brief Destructor
-    /// @~japanese
-    /// @brief fXgN^
-    virtual ~TriangleSceneProxy();
-
-protected:
-    DirectX::XMMATRIX   worldMtx;
-};
-
-/// @class CameraSceneProxy
-class CameraSceneProxy : public SceneProxy {
-public:
-    /// @~english
-    /// @brief Transfer render information from Actor to Proxy
-    /// @param[in] actor Pointer to actor
+    /// @brief Get the input state of the current MainThread frame
     /// @~japanese
-    /// @brief ActorProxy֕``B
-    /// @param[in] actor AN^ւ̃|C^
-    virtual void Commit(SceneActor *actor) override;
-
-    /// @~english
-    /// @brief Get view port
-    /// @return D3D12_VIEWPORT
-    /// @~japanese
-    /// @brief Viewport擾
-    /// @return D3D12_VIEWPORT
-    D3D12_VIEWPORT& GetViewport() {
-        return viewport;
+    /// @brief 現在のMainThreadのフレームの入力状態を取得
+    const InputState& GetInputState() const {
+        return inputState;
     }
 
     /// @~english
-    /// @brief Get scissor rect
-    /// @return D3D12_RECT
+    /// @brief Set the function receiving the read back frames on the consumer thread, called before Run
     /// @~japanese
-    /// @brief ScissorRect擾
-    /// @return D3D12_RECT
-    D3D12_RECT& GetScissorRect() {
-        return scissorRect;
+    /// @brief 読み戻したフレームを消費者スレッドで受け取る関数を設定、Runの前に呼び出す
+    void SetFrameReadbackConsumer(const FrameReadbackConsumer &consumer) {
+        frameReadbackConsumer = consumer;
     }
 
     /// @~english
-    /// @brief Get the view transformation matrix
-    /// @return View transformation matrix
+    /// @brief Request the next frames to be read back, frames finding every readback slot busy are left to the following ones
+    /// @param[in] frameCount Number of frames to read back
     /// @~japanese
-    /// @brief Viewϊs擾
-    /// @return Viewϊs
-    void GetViewMatrix(DirectX::XMFLOAT4X4 *dstViewMtx) {
-        XMStoreFloat4x4(dstViewMtx, viewMtx);
+    /// @brief 次のフレームの読み戻しを要求、全ての読み戻しスロットが使用中のフレームは後続のフレームに任せる
+    /// @param[in] frameCount 読み戻すフレーム数
+    void RequestFrameReadback(UINT frameCount) {
+        requestedReadbackCount.fetch_add(frameCount);
     }
 
     /// @~english
-    /// @brief Get the projection matrix
-    /// @return Projection matrix
-    /// @~japanese
-    /// @brief ˉes擾
-    /// @return ˉes
-    void GetProjectionMatrix(DirectX::XMFLOAT4X4 *dstProjMtx) {
-        XMStoreFloat4x4(dstProjMtx, projMtx);
+    /// @brief Connect to the scene feed of a simulation process, called before Run
+    /// @details Every frame the MainThread consumes the published records in place. A TriangleSceneActor per
+    ///          actor id of the feed is allocated and added to the scene here, so consuming never allocates:
+    ///          a spawn shows the actor of the id, a despawn parks it at zero scale.
+    /// @param[in] name Name of the shared memory created by the simulation process
+    /// @return True if succeeded, false if the feed does not exist or its layout differs
+    /// @~japanese
+    /// @brief シミュレーションプロセスのシーンフィードへ接続、Runの前に呼び出す
+    /// @details MainThreadが毎フレーム公開されたレコードをその場で消費する。フィードのアクタID毎の
+    ///          TriangleSceneActorはここで確保してシーンへ追加する為、消費時は確保しない：出現はそのIDの
+    ///          アクタを表示し、消滅はスケール0で待機させる
+    /// @param[in] name シミュレーションプロセスが生成した共有メモリの名前
+    /// @return 成功した場合にはTrue、フィードが存在しないかレイアウトが異なる場合はFalseを返す
+    bool ConnectSceneFeed(const char *name);
+
+    /// @~english
+    /// @brief Save the triangle and camera actors of the scene to a snapshot file, call before Run or after Deinit
+    /// @details Each field is written as one array per actor type: transform, parent, tick settings and
+    ///          the parameters of the type. Animations playing on the actors are not saved.
+    /// @param[in] path Path of the file
+    /// @return True if succeeded, false if the file can not be written
+    /// @~japanese
+    /// @brief シーンの三角形とカメラのアクタをスナップショットファイルへ保存、Runの前もしくはDeinitの後に呼び出す
+    /// @details 各フィールドはアクタ種別毎に1つの配列として書き込む：トランスフォーム、親、更新設定、
+    ///          種別のパラメータ。アクタで再生中のアニメーションは保存しない
+    /// @param[in] path ファイルのパス
+    /// @return 成功した場合にはTrue、ファイルに書き込めない場合はFalseを返す
+    bool SaveSceneSnapshot(const char *path);
+
+    /// @~english
+    /// @brief Add the actors of a snapshot file to the scene, call before Run
+    /// @details The file is mapped and its arrays are read in place, the actors of each type are built in
+    ///          one allocation and added at once. Their proxies are created by the first commit like those
+    ///          of any added actor.
+    /// @param[in] path Path of the file
+    /// @return True if succeeded, false if the file does not exist or its layout differs
+    /// @~japanese
+    /// @brief スナップショットファイルのアクタをシーンへ追加、Runの前に呼び出す
+    /// @details ファイルをマッピングしてその配列をその場で読み込み、各種別のアクタは1回の確保で構築し
+    ///          一括で追加する。Proxyは他の追加したアクタと同様に最初の伝達で生成される
+    /// @param[in] path ファイルのパス
+    /// @return 成功した場合にはTrue、ファイルが存在しないかレイアウトが異なる場合はFalseを返す
+    bool LoadSceneSnapshot(const char *path);
+
+    /// @~english
+    /// @brief Record the frames to a stream for FrameReplay, call before Run
+    /// @details Each frame stores the delta passed to Update, the input events and scene feed records
+    ///          applied in it, and every DEFAULT_FRAME_RECORD_CHECKSUM_INTERVAL frames a checksum of the
+    ///          world matrices. The stream is closed by Deinit. Connect the scene feed first, the stream
+    ///          keeps its actor capacity for the replay.
+    /// @param[in] path Path of the stream
+    /// @return True if succeeded, false if replaying or the file can not be created
+    /// @~japanese
+    /// @brief FrameReplay用にフレームをストリームへ記録、Runの前に呼び出す
+    /// @details 各フレームはUpdateへ渡す経過時間、その中で適用した入力イベントとシーンフィードのレコード、
+    ///          及びDEFAULT_FRAME_RECORD_CHECKSUM_INTERVALフレーム毎にWorld変換行列のチェックサムを格納する。
+    ///          ストリームはDeinitで閉じる。シーンフィードは先に接続する、ストリームは再生の為にその
+    ///          アクタ容量を保持する
+    /// @param[in] path ストリームのパス
+    /// @return 成功した場合にはTrue、再生中もしくはファイルを生成できない場合はFalseを返す
+    bool StartFrameRecording(const char *path);
+
+    /// @~english
+    /// @brief Drive the frames from a recorded stream, call before Run
+    /// @details The recorded deltas, input events and scene feed records replace the measured and live
+    ///          ones, so the scene evolves bit for bit as it did when recorded, given the same initial scene.
+    ///          The recorded checksums are compared along the way. The window closes at the end of the stream.
+    ///          The feed actors are allocated for the actor capacity of the recorded feed.
+    /// @param[in] path Path of the stream
+    /// @param[in] unthrottled True to present without waiting for the vertical blank, running as fast as possible
+    /// @return True if succeeded, false if recording, or the stream does not exist or its layout differs
+    /// @~japanese
+    /// @brief 記録したストリームからフレームを動かす、Runの前に呼び出す
+    /// @details 記録した経過時間、入力イベント、シーンフィードのレコードが計測したもの及び実際のものを
+    ///          置き換える為、初期シーンが同じであればシーンは記録時とビット単位で同じように変化する。
+    ///          記録したチェックサムは途中で比較する。ストリームの終端でウィンドウを閉じる。フィードの
+    ///          アクタは記録したフィードのアクタ容量分を確保する
+    /// @param[in] path ストリームのパス
+    /// @param[in] unthrottled 垂直同期を待たずに表示し、可能な限り速く実行する場合はTrue
+    /// @return 成功した場合にはTrue、記録中、もしくはストリームが存在しないかレイアウトが異なる場合はFalseを返す
+    bool StartFrameReplay(const char *path, bool unthrottled);
+
+    /// @~english
+    /// @brief Time the frames of the pipeline, call before Run
+    /// @details Presents without waiting for the vertical blank. The window closes once the frames are
+    ///          recorded, the results are read from GetBenchmark() after Deinit.
+    /// @param[in] warmupFrames MainThread frames not recorded
+    /// @param[in] frameCount MainThread frames recorded
+    /// @~japanese
+    /// @brief パイプラインのフレームを計測、Runの前に呼び出す
+    /// @details 垂直同期を待たずに表示する。フレームを記録し終えるとウィンドウを閉じ、結果はDeinitの後に
+    ///          GetBenchmark()から読み込む
+    /// @param[in] warmupFrames 記録しないMainThreadのフレーム数
+    /// @param[in] frameCount 記録するMainThreadのフレーム数
+    void StartBenchmark(UINT warmupFrames, UINT frameCount);
+
+    const BenchmarkRecorder& GetBenchmark() const {
+        return benchmark;
     }
 
-    /// @~english 
-    /// @brief Constructor
-    /// @~japanese
-    /// @brief RXgN^
-    CameraSceneProxy();
-
-    /// @~english
-    /// @brief Destructor
-    /// @~japanese
-    /// @brief fXgN^
-    virtual ~CameraSceneProxy();
-
-protected:
-    D3D12_VIEWPORT      viewport;
-    D3D12_RECT          scissorRect;
-    DirectX::XMMATRIX   viewMtx;
-    DirectX::XMMATRIX   projMtx;
-};
-
-
-/// @enum GlobalFlag
-enum class GlobalFlag : UINT {
-    TerminateRenderer   = (1u << 0u),
-};
-
-
-/// @class MTRenderer
-class MTRenderer {
-public:
-    
-    /// @~english
-    /// @brief Initialize
-    /// @return True if initialization succeeded, false otherwise
-    /// @~japanese
-    /// @brief 
-    /// @return ɐꍇɂTrueAłȂȂFalseԂ
-    bool Init();
-
     /// @~english
-    /// @brief Initialize
-    /// @param[in] width  Screen width
-    /// @param[in] height Screen height
-    /// @param[in] inBackBufferCount Number of back buffers
-    /// @param[in] titleStr Window title string
-    /// @return True if initialization succeeded, false otherwise
+    /// @brief Add actor
+    /// @param[in] actor Pointer to actor, the type must be registered in SceneProxyRegistry
     /// @~japanese
-    /// @brief 
-    /// @param[in] width  XN[
-    /// @param[in] height XN[
-    /// @param[in] inBackBufferCount obNobt@
-    /// @param[in] titleStr EBhE^Cg
-    /// @return ɐꍇɂTrueAłȂȂFalseԂ
-    bool Init(const UINT width, const UINT height, const UINT inBackBufferCount, LPCWSTR titleStr);
+    /// @brief アクタを追加
+    /// @param[in] actor アクタへのポインタ、型はSceneProxyRegistryに登録されている必要がある
+    template<typename ActorT>
+    void AddSceneActor(ActorT *actor) {
+        scene.AddActor(actor);
+    }
 
     /// @~english
-    /// @brief Run the MTRenderer
-    /// @return Return code
+    /// @brief Add a contiguous array of actors at once
+    /// @param[in] actors Array of actors, the type must be registered in SceneProxyRegistry
+    /// @param[in] count Number of actors
     /// @~japanese
-    /// @brief MTRenderers
-    /// @return IXe[^X
-    int Run();
+    /// @brief 連続したアクタの配列を一括で追加
+    /// @param[in] actors アクタの配列、型はSceneProxyRegistryに登録されている必要がある
+    /// @param[in] count アクタ数
+    template<typename ActorT>
+    void AddSceneActors(ActorT *actors, UINT count) {
+        scene.AddActors(actors, count);
+    }
 
     /// @~english
-    /// @brief Deinitialize
-    /// @~japanese
-    /// @brief I
-    void Deinit();
+    /// @brief Make an actor tick after another one within the same frame
+    /// @param[in] actor Pointer to actor
+    /// @param[in] prerequisite Pointer to actor to tick first
+    /// @return True if succeeded, false if the prerequisite is in a later tick group or the dependency makes a cycle
+    /// @~japanese
+    /// @brief 同じフレーム内でアクタを別のアクタの後に更新させる
+    /// @param[in] actor アクタへのポインタ
+    /// @param[in] prerequisite 先に更新するアクタへのポインタ
+    /// @return 成功した場合にはTrue、前提条件が後の更新グループにあるか依存が循環する場合はFalseを返す
+    bool AddSceneActorTickPrerequisite(SceneActor *actor, SceneActor *prerequisite) {
+        return scene.AddTickPrerequisite(actor, prerequisite);
+    }
 
     /// @~english
-    /// @brief Set the specified flag
+    /// @brief Play an animation clip on an actor, replacing the one playing
+    /// @details While the clip plays the local transform of the actor comes from the clip, not from
+    ///          its translation, rotation and scale.
+    /// @param[in] actor Pointer to actor
+    /// @param[in] clip Clip to play, must outlive the playback
+    /// @param[in] speed Playback speed
+    /// @param[in] loop True to loop, false to hold the last key
+    /// @return True if succeeded, false if the actor is not added or the clip is empty
     /// @~japanese
-    /// @brief w肵tOZbg
-    void SetFlag(const GlobalFlag flag);
+    /// @brief アクタにアニメーションクリップを再生、再生中のものは置き換える
+    /// @details 再生中のアクタのローカルトランスフォームは平行移動、回転、スケールではなくクリップから得る
+    /// @param[in] actor アクタへのポインタ
+    /// @param[in] clip 再生するクリップ、再生中は存在する必要がある
+    /// @param[in] speed 再生速度
+    /// @param[in] loop ループする場合はTrue、最後のキーで止める場合はFalse
+    /// @return 成功した場合にはTrue、アクタが追加されていないかクリップが空の場合はFalseを返す
+    bool PlaySceneActorAnimation(SceneActor *actor, const AnimationClip *clip, float speed, bool loop);
 
     /// @~english
-    /// @brief Clear the specified flag
+    /// @brief Stop the animation of an actor, its translation, rotation and scale apply again
     /// @~japanese
-    /// @brief w肵tONA
-    void ClearFlag(const GlobalFlag flag);
+    /// @brief アクタのアニメーションを停止、平行移動、回転、スケールが再び適用される
+    void StopSceneActorAnimation(SceneActor *actor);
 
     /// @~english
-    /// @brief Test the specified flag
-    /// @return True if specified flag is set, false otherwise
+    /// @brief Attach an actor to a parent actor
+    /// @param[in] child Pointer to actor
+    /// @param[in] parent Pointer to parent actor (nullptr to detach
+    /// @return True if succeeded, false if the parent is the actor itself or one of its descendants
     /// @~japanese
-    /// @brief w肵tOZbgĂ邩ׂ
-    /// @return w肵tOZbgĂTrueAłȂȂFalse
-    bool TestFlag(const GlobalFlag flag);
+    /// @brief アクタを親アクタへ接続
+    /// @param[in] child アクタへのポインタ
+    /// @param[in] parent 親アクタへのポインタ（nullptrの場合は切り離す
+    /// @return 成功した場合にはTrue、親がアクタ自身もしくはその子孫の場合はFalseを返す
+    bool AttachSceneActor(SceneActor *child, SceneActor *parent);
 
     /// @~english
-    /// @brief Add actor
-    /// @param[in] actor Pointer to actor
+    /// @brief Get the bounding volume hierarchy over the mesh proxies for spatial queries
+    /// @details Updated by the MainThread while committing the proxies, the user data is the proxy entity.
     /// @~japanese
-    /// @brief AN^ǉ
-    /// @param[in] actor AN^ւ̃|C^
-    void AddSceneActor(SceneActor *actor);
+    /// @brief 空間クエリ用のメッシュProxyに対する境界ボリューム階層を取得
+    /// @details MainThreadがProxyの伝達時に更新する、ユーザーデータはProxyエンティティ
+    const BoundingVolumeHierarchy& GetSceneProxyBVH() const {
+        return scene.GetProxyBVH();
+    }
 
     /// @~english 
     /// @brief Constructor
     /// @~japanese
-    /// @brief RXgN^
+    /// @brief コンストラクタ
     MTRenderer(HINSTANCE hInstance, int nCmdShow);
 
     /// @~english
     /// @brief Destructor
     /// @~japanese
-    /// @brief fXgN^
+    /// @brief デストラクタ
     ~MTRenderer();
 
 private:
@@ -444,9 +393,9 @@ private:
     /// @param[in] renderer Pointer to MTRenderer
     /// @return Return code
     /// @~japanese
-    /// @brief CXbh֐
-    /// @param renderer MTRendererւ̃|C^
-    /// @return IXe[^X
+    /// @brief メインスレッド処理関数
+    /// @param renderer MTRendererへのポインタ
+    /// @return 終了ステータス
     static int MainThreadFunc(MTRenderer *renderer);
 
     /// @~english
@@ -454,31 +403,39 @@ private:
     /// @param[in] renderer Pointer to MTRenderer
     /// @return Return code
     /// @~japanese
-    /// @brief `Xbh֐
-    /// @param renderer MTRendererւ̃|C^
-    /// @return IXe[^X
+    /// @brief 描画スレッド処理関数
+    /// @param renderer MTRendererへのポインタ
+    /// @return 終了ステータス
     static int RenderThreadFunc(MTRenderer *renderer);
 
     /// @~english
     /// @brief Initialize devices
     /// @return True if initialization succeeded, false otherwise
     /// @~japanese
-    /// @brief foCX̏
-    /// @return ɐꍇɂTrueAłȂȂFalseԂ
+    /// @brief デバイスの初期化
+    /// @return 初期化に成功した場合にはTrue、そうでないならFalseを返す
     bool InitDevices();
 
     /// @~english
     /// @brief Initialize resources
     /// @return True if initialization succeeded, false otherwise
     /// @~japanese
-    /// @brief e탊\[X
-    /// @return ɐꍇɂTrueAłȂȂFalseԂ
+    /// @brief 各種リソースを初期化
+    /// @return 初期化に成功した場合にはTrue、そうでないならFalseを返す
     bool InitResources();
 
+    /// @~english
+    /// @brief Merge the geometry of every mesh LOD into shared vertex and index pools
+    /// @return True if the pools were built, false otherwise
+    /// @~japanese
+    /// @brief 全メッシュのLODのジオメトリを共有の頂点プールとインデックスプールへまとめる
+    /// @return プールを構築した場合はTrue、そうでないならFalseを返す
+    bool BuildGeometryPools();
+
     /// @~english
     /// @name Main thread processes
     /// @~japanese
-    /// @name MainThread
+    /// @name MainThread処理
     /// @{
     void PreUpdate();
     void Update(float delta);
@@ -490,7 +447,7 @@ private:
     /// @~english
     /// @name Render thread processes
     /// @~japanese
-    /// @name RenderThead
+    /// @name RenderThead処理
     /// @{
     void RestartMainThread();
     void SyncMainThread();
@@ -501,6 +458,200 @@ private:
     void Render();
     /// @}
 
+    /// @~english
+    /// @brief State last set on the CommandList, used to skip redundant changes
+    /// @~japanese
+    /// @brief CommandListに最後にセットしたステート、冗長な変更の省略に使用
+    /// @~
+    /// @struct CommandListState
+    struct CommandListState {
+        ID3D12PipelineState    *d3dPipelineState;
+        ID3D12RootSignature    *d3dRootSignature;
+        UINT                    materialIndex;
+        UINT                    meshIndex;
+        UINT                    lodIndex;
+    };
+
+    /// @~english
+    /// @brief Record the sorted render queue as instanced draws over runs of equal state
+    /// @param[in] d3dCommandList Destination command list
+    /// @param[in] cbLocation Address of the scene constant buffer
+    /// @param[in] itemCount Number of leading items to record
+    /// @param[in] depthOnly True to record the opaque items with the depth only pipelines
+    /// @param[in,out] state State of the command list
+    /// @param[in,out] stats Submission statistics
+    /// @~japanese
+    /// @brief ソート済みの描画キューを等しいステートの連続毎にインスタンス描画として記録
+    /// @param[in] d3dCommandList 記録先のCommandList
+    /// @param[in] cbLocation シーン定数バッファのアドレス
+    /// @param[in] itemCount 記録する先頭からの要素数
+    /// @param[in] depthOnly 不透明要素を深度のみのパイプラインで記録する場合はTrue
+    /// @param[in,out] state CommandListのステート
+    /// @param[in,out] stats 発行の統計情報
+    void SubmitRenderQueue(ID3D12GraphicsCommandList *d3dCommandList, D3D12_GPU_VIRTUAL_ADDRESS cbLocation, UINT itemCount, bool depthOnly, CommandListState *state, RenderSubmitStats *stats);
+
+    /// @~english
+    /// @brief Write the sorted render queue as indirect draw records and submit one ExecuteIndirect per pipeline
+    /// @param[in] d3dCommandList Destination command list
+    /// @param[in] cbLocation Address of the scene constant buffer
+    /// @param[in] itemCount Number of leading items to record
+    /// @param[in] depthOnly True to record the opaque items with the depth only pipelines
+    /// @param[in] d3dArgBuffer Buffer the records are read from by the GPU
+    /// @param[in,out] dstRecords Mapped records of the frame
+    /// @param[in,out] recordCount Records of the frame written so far
+    /// @param[in,out] state State of the command list
+    /// @param[in,out] stats Submission statistics
+    /// @return False if the records of the frame are full, nothing is recorded then
+    /// @~japanese
+    /// @brief ソート済みの描画キューを間接描画のレコードとして書き込み、パイプライン毎に1回のExecuteIndirectを発行
+    /// @param[in] d3dCommandList 記録先のCommandList
+    /// @param[in] cbLocation シーン定数バッファのアドレス
+    /// @param[in] itemCount 記録する先頭からの要素数
+    /// @param[in] depthOnly 不透明要素を深度のみのパイプラインで記録する場合はTrue
+    /// @param[in] d3dArgBuffer GPUがレコードを読み込むバッファ
+    /// @param[in,out] dstRecords マップしたフレームのレコード
+    /// @param[in,out] recordCount これまでに書き込んだフレームのレコード数
+    /// @param[in,out] state CommandListのステート
+    /// @param[in,out] stats 発行の統計情報
+    /// @return フレームのレコードが満杯の場合はFalse、その場合は何も記録しない
+    bool SubmitIndirect(ID3D12GraphicsCommandList *d3dCommandList, D3D12_GPU_VIRTUAL_ADDRESS cbLocation, UINT itemCount, bool depthOnly, ID3D12Resource *d3dArgBuffer, IndirectDrawRecord *dstRecords, UINT *recordCount, CommandListState *state, RenderSubmitStats *stats);
+
+    /// @~english
+    /// @brief Record the runs of a bundle key, from its bundle when the cache has one
+    /// @param[in] d3dCommandList Destination command list
+    /// @param[in] key Runs of a single pipeline
+    /// @param[in,out] state State of the command list
+    /// @param[in,out] stats Submission statistics
+    /// @~japanese
+    /// @brief バンドルキーの連続を記録、キャッシュがバンドルを持つ場合はそこから記録する
+    /// @param[in] d3dCommandList 記録先のCommandList
+    /// @param[in] key 単一のパイプラインの連続
+    /// @param[in,out] state CommandListのステート
+    /// @param[in,out] stats 発行の統計情報
+    void SubmitBundleRuns(ID3D12GraphicsCommandList *d3dCommandList, const BundleKey &key, CommandListState *state, RenderSubmitStats *stats);
+
+    /// @~english
+    /// @brief Record the instanced draw of a run and the state changes it needs
+    /// @param[in] d3dCommandList Destination command list or bundle
+    /// @param[in] cbLocation Address of the scene constant buffer
+    /// @param[in] depthOnly True to record with the depth only pipeline
+    /// @param[in] run Run to draw
+    /// @param[in,out] state State of the command list
+    /// @param[in,out] stats Submission statistics
+    /// @~japanese
+    /// @brief 連続のインスタンス描画と必要なステート変更を記録
+    /// @param[in] d3dCommandList 記録先のCommandListまたはバンドル
+    /// @param[in] cbLocation シーン定数バッファのアドレス
+    /// @param[in] depthOnly 深度のみのパイプラインで記録する場合はTrue
+    /// @param[in] run 描画する連続
+    /// @param[in,out] state CommandListのステート
+    /// @param[in,out] stats 発行の統計情報
+    void RecordRun(ID3D12GraphicsCommandList *d3dCommandList, D3D12_GPU_VIRTUAL_ADDRESS cbLocation, bool depthOnly, const BundleRun &run, CommandListState *state, RenderSubmitStats *stats);
+
+    /// @~english
+    /// @brief Record one instanced draw per emitter of the committed particles
+    /// @param[in] d3dCommandList Destination command list
+    /// @param[in] cbLocation Address of the scene constant buffer
+    /// @param[in] d3dInstanceBuffer Instance buffer of the frame holding the committed instances
+    /// @param[in,out] state State of the command list
+    /// @~japanese
+    /// @brief 伝達済みのパーティクルのエミッタ毎に1回のインスタンス描画を記録
+    /// @param[in] d3dCommandList 記録先のCommandList
+    /// @param[in] cbLocation シーン定数バッファのアドレス
+    /// @param[in] d3dInstanceBuffer 伝達済みのインスタンスを保持するフレームのインスタンスバッファ
+    /// @param[in,out] state CommandListのステート
+    void SubmitParticles(ID3D12GraphicsCommandList *d3dCommandList, D3D12_GPU_VIRTUAL_ADDRESS cbLocation, ID3D12Resource *d3dInstanceBuffer, CommandListState *state);
+
+    /// @~english
+    /// @brief Find the views each mesh proxy is visible in, with one parallel pass over the BVH shared by all views
+    /// @param[in] frustums Frustums of the views
+    /// @param[in] viewCount Number of views
+    /// @param[in] arena Arena for the transient data
+    /// @param[out] dstEntityViewMasks Views per entity index, must be cleared
+    /// @~japanese
+    /// @brief 全ビューで共有するBVHの1回の並列走査で、各メッシュProxyが可視であるビューを求める
+    /// @param[in] frustums ビューの視錐台
+    /// @param[in] viewCount ビュー数
+    /// @param[in] arena 一時データ用のアリーナ
+    /// @param[out] dstEntityViewMasks エンティティ番号毎のビュー、クリアされている必要がある
+    void ComputeViewVisibility(const ViewFrustum *frustums, UINT viewCount, ScratchArena *arena, UINT8 *dstEntityViewMasks);
+
+    /// @~english
+    /// @brief Stretch the part of the scene target holding the frame over the back buffer
+    /// @param[in] d3dCommandList Destination command list
+    /// @param[in] frameIndex Back buffer and scene target of the frame
+    /// @param[in] scale Render scale of the frame
+    /// @~japanese
+    /// @brief シーンターゲットのフレームを保持する部分をバックバッファ全体へ引き伸ばす
+    /// @param[in] d3dCommandList 記録先のCommandList
+    /// @param[in] frameIndex フレームのバックバッファとシーンターゲット
+    /// @param[in] scale フレームの描画スケール
+    void UpscaleSceneTarget(ID3D12GraphicsCommandList *d3dCommandList, UINT frameIndex, float scale);
+
+    /// @~english
+    /// @brief Copy the back buffer into a readback slot, the back buffer is in the present state before and after
+    /// @param[in] d3dCommandList Destination command list
+    /// @param[in] frameIndex Back buffer of the frame
+    /// @param[in] slotIndex Readback slot
+    /// @~japanese
+    /// @brief バックバッファを読み戻しスロットへコピー、バックバッファは前後ともPresentの状態
+    /// @param[in] d3dCommandList 記録先のCommandList
+    /// @param[in] frameIndex フレームのバックバッファ
+    /// @param[in] slotIndex 読み戻しスロット
+    void CopyToReadbackSlot(ID3D12GraphicsCommandList *d3dCommandList, UINT frameIndex, UINT slotIndex);
+
+    /// @~english
+    /// @brief Hand a finished readback slot to the consumer, called on the consumer thread
+    /// @param[in] slotIndex Readback slot
+    /// @param[in] frameNumber Frame copied into the slot
+    /// @~japanese
+    /// @brief 完了した読み戻しスロットを消費者へ渡す、消費者スレッドで呼ばれる
+    /// @param[in] slotIndex 読み戻しスロット
+    /// @param[in] frameNumber スロットへコピーしたフレーム
+    void DeliverReadbackSlot(UINT slotIndex, UINT64 frameNumber);
+
+    /// @~english
+    /// @brief Apply the records published to the scene feed since the last frame to the feed actors
+    /// @~japanese
+    /// @brief 前フレーム以降にシーンフィードへ公開されたレコードをフィードのアクタへ適用
+    void ConsumeSceneFeed();
+
+    /// @~english
+    /// @brief Apply a scene feed record to its feed actor
+    /// @return True if applied, false if the record has an unknown type or actor
+    /// @~japanese
+    /// @brief シーンフィードのレコードをそのフィードのアクタへ適用
+    /// @return 適用した場合はTrue、不明な種別またはアクタのレコードの場合はFalseを返す
+    bool ApplySceneFeedRecord(const SceneFeedRecord &record);
+
+    /// @~english
+    /// @brief Allocate and register the actors driven by the scene feed, once for the feed or the replay
+    /// @param[in] actorCapacity Number of actor ids
+    /// @return True if succeeded, false if the pool already exists with fewer actors
+    /// @~japanese
+    /// @brief シーンフィードが動かすアクタを確保し登録、フィードもしくは再生に対し一度だけ
+    /// @param[in] actorCapacity アクタIDの数
+    /// @return 成功した場合にはTrue、プールが既により少ないアクタで存在する場合はFalseを返す
+    bool CreateFeedActors(UINT actorCapacity);
+
+    /// @~english
+    /// @brief Begin the frame of the recording or the replay, a replay replaces the delta
+    /// @~japanese
+    /// @brief 記録もしくは再生のフレームを開始、再生は経過時間を置き換える
+    void BeginRecordedFrame(float *delta);
+
+    /// @~english
+    /// @brief End the frame of the recording or the replay with the checksum of the updated scene
+    /// @~japanese
+    /// @brief 更新したシーンのチェックサムで記録もしくは再生のフレームを終了
+    void EndRecordedFrame();
+
+    /// @~english
+    /// @brief Report the replay and close the window
+    /// @~japanese
+    /// @brief 再生を報告しウィンドウを閉じる
+    void FinishFrameReplay();
+
 private:
     std::thread mainThread;
     std::thread renderThread;
@@ -511,6 +662,7 @@ private:
     std::mutex              syncRenderThreadMtx;
     std::condition_variable syncMainThreadCond;
     std::condition_variable syncRenderThreadCond;
+    std::chrono::high_resolution_clock::time_point mainThreadReadyTime;    ///< @~english When mainTheadReady was set, guarded by syncMainThreadMtx @~japanese mainTheadReadyをセットした時刻、syncMainThreadMtxで保護する
 
     UINT        canvasWidth;
     UINT        canvasHeight;
@@ -531,6 +683,37 @@ private:
     
     ComPtr<ID3D12Resource>  d3dRenderTarget[MAX_FRAME_COUNT];
     UINT                    rtvDescriptorSize;
+    ComPtr<ID3D12Resource>  d3dDepthBuffer[MAX_FRAME_COUNT];
+    UINT                    dsvDescriptorSize;
+
+    /// @~english
+    /// @brief Full size targets the scene is drawn to at the render scale, upscaled to the back buffers
+    /// @~japanese
+    /// @brief シーンを描画スケールで描画する全サイズのターゲット、バックバッファへアップスケールする
+    ComPtr<ID3D12Resource>          d3dSceneTarget[MAX_FRAME_COUNT];
+    ComPtr<ID3D12RootSignature>     d3dUpscaleRootSignature;
+    ComPtr<ID3D12PipelineState>     d3dUpscalePipelineState;
+
+    /// @~english
+    /// @brief Timestamps at the start and the end of each frame, read back once the frame has finished
+    /// @~japanese
+    /// @brief 各フレームの開始と終了のタイムスタンプ、フレームの完了後に読み戻す
+    ComPtr<ID3D12QueryHeap>         d3dTimestampQueryHeap;
+    ComPtr<ID3D12Resource>          d3dTimestampReadbackBuffer;
+    UINT64                          timestampFrequency;
+    DynamicResolutionController     resolutionController;
+
+    /// @~english
+    /// @brief Readback buffers of the back buffer copies, one per slot of the ring, and the fence signaled after each copy
+    /// @~japanese
+    /// @brief バックバッファのコピーの読み戻しバッファ、リングのスロット毎に1つ、各コピーの後にシグナルするフェンス
+    ComPtr<ID3D12Resource>              d3dReadbackBuffer[DEFAULT_READBACK_SLOT_COUNT];
+    ComPtr<ID3D12Fence>                 d3dReadbackFence;
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT  readbackFootprint;
+    UINT64                              readbackBufferSize;
+    FrameReadbackRing                   frameReadbackRing;
+    FrameReadbackConsumer               frameReadbackConsumer;
+    std::atomic<UINT>                   requestedReadbackCount;
 
     ComPtr<IDXGIFactory6>   dxgiFactory;
     ComPtr<IDXGIAdapter1>   dxgiAdapter;
@@ -540,36 +723,115 @@ private:
 #endif
 
 
+    /// @~english
+    /// @brief Constants of a view, the constant buffer of a frame holds MAX_VIEW_COUNT of them
+    /// @~japanese
+    /// @brief ビューの定数、フレームの定数バッファはMAX_VIEW_COUNT個を保持する
+    /// @~
     /// @struct SceneConstantBuffer
     struct SceneConstantBuffer {
         DirectX::XMFLOAT4X4 ViewMatrix;
         DirectX::XMFLOAT4X4 ProjMatrix;
-        DirectX::XMFLOAT4X4 worldMatrix[510];
+        DirectX::XMFLOAT4X4 worldMatrix[MAX_SCENE_INSTANCE_COUNT];
     };
 
     // ConstantBuffer size must be 256-byte aligned
-    // ConstantBuffer̃TCY256-byteACgKv
+    // ConstantBufferのサイズは256-byteアライメントが必要
     static_assert((sizeof(SceneConstantBuffer) % 256) == 0, "Constant buffer size must be 256-byte aligned.");
 
+    // Resources
+    MeshAsset                   triangleMeshLods[MAX_MESH_LOD_COUNT];
+
+    /// @~english
+    /// @brief Vertices and 32-bit indices of every mesh LOD, the indirect draws address them with offsets
+    /// @~japanese
+    /// @brief 全メッシュのLODの頂点と32bitインデックス、間接描画はオフセットで参照する
+    ComPtr<ID3D12Resource>          geometryVtxPool;
+    ComPtr<ID3D12Resource>          geometryIdxPool;
+    D3D12_VERTEX_BUFFER_VIEW        geometryVtxPoolView;
+    D3D12_INDEX_BUFFER_VIEW         geometryIdxPoolView;
+    std::vector<IndirectMeshRange>  indirectMeshRanges;
+
+    /// @~english
+    /// @brief Pipeline and quad of the particles, the instances are read from a second vertex stream
+    /// @~japanese
+    /// @brief パーティクルのパイプラインと四角形、インスタンスは2つ目の頂点ストリームから読み込む
+    ComPtr<ID3D12PipelineState> d3dParticlePipelineState;
+    ComPtr<ID3D12Resource>      particleQuadVtxBuffer;
+    ComPtr<ID3D12Resource>      particleQuadIdxBuffer;
+    D3D12_VERTEX_BUFFER_VIEW    particleQuadVtxBufferView;
+    D3D12_INDEX_BUFFER_VIEW     particleQuadIdxBufferView;
+
+    /// @~english
+    /// @brief Bundle setting the root signature and topology every frame starts from
+    /// @~japanese
+    /// @brief 全フレームの開始時のRootSignatureとトポロジをセットするバンドル
+    ComPtr<ID3D12CommandAllocator>      d3dPrologueAllocator;
+    ComPtr<ID3D12GraphicsCommandList>   d3dPrologueBundle;
+
+    /// @~english
+    /// @brief Bundles of the draw sequences of the render queue, keyed by the runs they draw
+    /// @~japanese
+    /// @brief 描画キューの描画の並びのバンドル、描画する連続をキーとする
+    CommandBundleCache  bundleCache;
+    BundleKey           bundleKey;
+
     /// @~english
-    /// @brief Vertex data definition
+    /// @brief Pipeline referenced by the pipeline index of a sort key
+    /// @details Every root signature starts with the scene CBV (b0) followed by the draw constants (b1).
     /// @~japanese
-    /// @brief _f[^`
+    /// @brief ソートキーのパイプライン番号が参照するパイプライン
+    /// @details 全てのRootSignatureはシーンCBV（b0）、描画定数（b1）の順で始まる
     /// @~
-    /// @struct Vertex
-    struct Vertex {
-        float pos[3];
-        float color[4];
+    /// @struct DrawPipeline
+    struct DrawPipeline {
+        ComPtr<ID3D12PipelineState> d3dPipelineState;
+        ComPtr<ID3D12PipelineState> d3dDepthOnlyPipelineState;    ///< @~english Used by the depth prepass @~japanese 深度プリパスで使用
+        ComPtr<ID3D12RootSignature> d3dRootSignature;
+        ComPtr<ID3D12CommandSignature> d3dCommandSignature;       ///< @~english Layout of IndirectDrawRecord @~japanese IndirectDrawRecordのレイアウト
     };
 
-    // Resources
-    ComPtr<ID3D12Resource>      vtxBuffer;
-    D3D12_VERTEX_BUFFER_VIEW    vtxBufferView;
+    /// @~english
+    /// @brief Level of detail of a DrawMesh
+    /// @~japanese
+    /// @brief DrawMeshの詳細度
+    /// @~
+    /// @struct DrawMeshLod
+    struct DrawMeshLod {
+        D3D12_VERTEX_BUFFER_VIEW    vtxBufferView;
+        D3D12_INDEX_BUFFER_VIEW     idxBufferView;
+        UINT                        indexCount;
+        const MeshAsset            *asset;
+    };
+
+    /// @~english
+    /// @brief Mesh referenced by the mesh and LOD indices of a sort key
+    /// @details LODs past lodCount fall back to the coarsest one. The coarsest LOD is also the occluder.
+    /// @~japanese
+    /// @brief ソートキーのメッシュ番号とLOD番号が参照するメッシュ
+    /// @details lodCount以降のLODは最も粗いLODを使用する。最も粗いLODは遮蔽物にも使用する
+    /// @~
+    /// @struct DrawMesh
+    struct DrawMesh {
+        DrawMeshLod lods[MAX_MESH_LOD_COUNT];
+        UINT        lodCount;
+
+        /// @~english
+        /// @brief Get a LOD, clamped to the available ones
+        /// @~japanese
+        /// @brief LODを取得、存在するものに制限される
+        const DrawMeshLod& GetLod(UINT lodIndex) const {
+            return lods[std::min(lodIndex, lodCount - 1)];
+        }
+    };
+
+    std::vector<DrawPipeline>   drawPipelines;
+    std::vector<DrawMesh>       drawMeshes;
 
     /// @~english
     /// @brief Resources needed each frames
     /// @~japanese
-    /// @brief t[ɕKvȃ\[X
+    /// @brief フレーム毎に必要なリソース
     /// @~
     /// @struct FrameData
     struct FrameData {
@@ -580,10 +842,36 @@ private:
         UINT64                              fenceValue;
         bool                                syncGPU;
 
-        /// @brief RXgN^
+        /// @~english Particle instances of the frame, grown when the committed instances do not fit
+        /// @~japanese フレームのパーティクルのインスタンス、伝達済みのインスタンスが収まらない場合は拡張される
+        ComPtr<ID3D12Resource>              d3dParticleInstanceBuffer;
+        UINT                                particleInstanceCapacity;
+
+        /// @~english Records of the indirect draws, DEFAULT_INDIRECT_RECORD_CAPACITY of them
+        /// @~japanese 間接描画のレコード、DEFAULT_INDIRECT_RECORD_CAPACITY個
+        ComPtr<ID3D12Resource>              d3dIndirectArgBuffer;
+
+        /// @~english Render scale of the frame, and whether its timestamps are waiting to be read
+        /// @~japanese フレームの描画スケール、タイムスタンプが読み込みを待っているか
+        float                               resolutionScale;
+        bool                                timestampsPending;
+
+        /// @~english Value to signal the readback fence with once the frame is submitted, 0 if the frame is not read back
+        /// @~japanese フレームの発行後に読み戻しのフェンスをシグナルする値、フレームを読み戻さない場合は0
+        UINT64                              readbackFenceValue;
+
+        /// @~english Transient data of the RenderThread, reset together with the CommandAllocator
+        /// @~japanese RenderThreadの一時データ、CommandAllocatorと同時にリセットされる
+        ScratchArena                        renderThreadArena;
+
+        /// @brief コンストラクタ
         FrameData()
         : fenceValue(0)
         , syncGPU(false)
+        , particleInstanceCapacity(0)
+        , resolutionScale(1.0f)
+        , timestampsPending(false)
+        , readbackFenceValue(0)
         {
             ;
         }
@@ -591,13 +879,103 @@ private:
 
     FrameData   frameDataArray[MAX_FRAME_COUNT];
 
+    /// @~english
+    /// @brief Transient data of the MainThread, double buffered as the RenderThread reads the previous frame
+    /// @~japanese
+    /// @brief MainThreadの一時データ、RenderThreadが前フレームを参照する為ダブルバッファ
+    ScratchArena    mainThreadArenas[MAIN_THREAD_ARENA_COUNT];
+    UINT            mainThreadArenaIndex;
+
+    /// @~english
+    /// @brief Draw requests of the RenderThread sorted by state
+    /// @~japanese
+    /// @brief ステート順にソートするRenderThreadの描画要求
+    RenderQueue         renderQueue;
+    RenderSubmitStats   renderSubmitStats;
+    UINT                renderFrameCount;
+    ViewVisibilityStats viewVisibilityStats;
+
+    /// @~english
+    /// @brief Occlusion buffer rasterized in PreRender and tested in Render
+    /// @~japanese
+    /// @brief PreRenderでラスタライズしRenderでテストするオクルージョンバッファ
+    OcclusionCuller     occlusionCuller;
+
+    /// @~english
+    /// @brief LOD selection of the RenderThread, biased by the CPU time of the RenderThread frames
+    /// @~japanese
+    /// @brief RenderThreadのLOD選択、RenderThreadのフレームのCPU時間でバイアスが掛かる
+    LodSelector         lodSelector;
+
     UINT    flags;
     UINT    backBufferIndex;
     UINT    backBufferCount;
     HANDLE  fenceEvent;
 
+    /// @~english
+    /// @brief Placement of the MainThread, the RenderThread and the workers on the detected CPU topology
+    /// @~japanese
+    /// @brief 検出したCPUトポロジ上のMainThread、RenderThread、ワーカーの配置
+    CpuTopology                 cpuTopology;
+    ThreadPlacement             threadPlacement;
+
+    JobSystem                   jobSystem;
+
+    /// @~english
+    /// @brief Particles simulated by the MainThread, the frame of the last update is committed to the RenderThread
+    /// @~japanese
+    /// @brief MainThreadがシミュレーションするパーティクル、最後の更新のフレームをRenderThreadへ伝達する
+    ParticleSystem              particleSystem;
+    ParticleFrame               committedParticleFrame;
+
+    /// @~english
+    /// @brief Input pushed by the window procedure and drained by PreUpdate, the stamp of the frame goes along with the commit
+    /// @~japanese
+    /// @brief ウィンドウプロシージャが追加しPreUpdateが取り出す入力、フレームのスタンプは伝達と共に渡す
+    InputQueue                  inputQueue;
+    InputState                  inputState;
+    InputFrameStamp             frameInputStamp;
+    InputFrameStamp             committedInputStamp;
+    InputLatencyTracker         inputLatencyTracker;
+
+    /// @~english
+    /// @brief Records of the simulation process consumed by PreUpdate, and the actors they drive indexed by actor id
+    /// @~japanese
+    /// @brief PreUpdateが消費するシミュレーションプロセスのレコード、及びそれが動かすアクタIDで引くアクタ
+    SceneFeed                               sceneFeed;
+    std::unique_ptr<TriangleSceneActor[]>   feedActors;
+    UINT                                    feedActorCount;
+    std::vector<bool>                       feedActorSpawned;
+    SceneFeedStats                          sceneFeedStats;
+
+    /// @~english
+    /// @brief Frames recorded or replayed by the MainThread
+    /// @~japanese
+    /// @brief MainThreadが記録もしくは再生するフレーム
+    FrameRecorder                                   frameRecorder;
+    FrameReplay                                     frameReplay;
+    ReplayFrame                                     replayFrame;
+    FrameReplayStats                                frameReplayStats;
+    std::chrono::high_resolution_clock::time_point  replayBeginTime;
+
+    /// @~english
+    /// @brief Frame times of a benchmark run, written by both threads
+    /// @~japanese
+    /// @brief ベンチマーク実行のフレーム時間、両スレッドが書き込む
+    BenchmarkRecorder                               benchmark;
+
+    /// @~english
+    /// @brief Baked motion of the default actor
+    /// @~japanese
+    /// @brief デフォルトのアクタの焼き込んだ動き
+    AnimationClip               defaultTriangleClip;
+
     CameraSceneActor            defaultCameraActor;
     TriangleSceneActor          defaultTriangleActor;
-    std::vector<SceneActor *>   sceneActors;
-    std::vector<SceneProxy *>   sceneProxies;
+
+    /// @~english
+    /// @brief Actors and the proxies committed from them, read by the RenderThread between two commits
+    /// @~japanese
+    /// @brief アクタとそこから伝達したProxy、2回の伝達の間にRenderThreadが参照する
+    Scene                       scene;
 };
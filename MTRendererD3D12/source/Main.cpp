@@ -3,16 +3,157 @@
 
 #include "stdafx.h"
 #include "MTRendererD3D12.h"
+#include "StressScene.h"
 
-/// @brief Win32Gg|Cg
+namespace {
+// Get the value following an option of the command line, up to the next space
+// コマンドラインのオプションに続く値を次の空白まで取得
+bool GetCommandLineOption(LPCSTR cmdLine, const char *name, std::string *dstValue) {
+    const std::string prefix = std::string(name) + ' ';
+    const char *option = strstr(cmdLine, prefix.c_str());
+    if (option == nullptr) {
+        return false;
+    }
+
+    *dstValue = option + prefix.size();
+    *dstValue = dstValue->substr(0, dstValue->find(' '));
+    return !dstValue->empty();
+}
+} // namespace ""
+
+/// @brief Win32エントリポイント
 int APIENTRY WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ LPSTR lpCmdLine, _In_ int nCmdShow) {
 
     MTRenderer renderer(hInstance, nCmdShow);
+
+    // "-warp" runs on the software rasterizer, e.g. on machines without a GPU
+    // "-warp"でソフトウェアラスタライザ上で実行する、GPUの無いマシンなど
+    if (strstr(lpCmdLine, "-warp") != nullptr) {
+        renderer.SetFlag(GlobalFlag::UseWarpAdapter);
+    }
+
+    // "-pinthreads" binds the MainThread, the RenderThread and the workers to logical processors
+    // "-pinthreads"でMainThread、RenderThread、ワーカーを論理プロセッサに固定する
+    if (strstr(lpCmdLine, "-pinthreads") != nullptr) {
+        renderer.SetFlag(GlobalFlag::EnableThreadPinning);
+    }
+
+    // "-stats" writes the load times and the periodic statistics of the threads and the systems to the debug output
+    // "-stats"で読み込み時間とスレッド、各システムの定期的な統計情報をデバッグ出力へ書き込む
+    if (strstr(lpCmdLine, "-stats") != nullptr) {
+        renderer.SetFlag(GlobalFlag::EnableStatsReport);
+    }
     if (!renderer.Init()) {
         return 0;
     }
+
+    // Drive the scene from a simulation process, "-scenefeed <name>" names the shared memory of its feed
+    // シミュレーションプロセスからシーンを動かす、"-scenefeed <名前>"でそのフィードの共有メモリを指定する
+    std::string feedName;
+    if (GetCommandLineOption(lpCmdLine, "-scenefeed", &feedName) && !renderer.ConnectSceneFeed(feedName.c_str())) {
+        OutputDebugStringA("SceneFeed: could not connect\n");
+    }
+
+    // "-loadsnapshot <path>" adds the actors of a scene snapshot, "-savesnapshot <path>" saves the scene on exit
+    // "-loadsnapshot <パス>"でシーンスナップショットのアクタを追加、"-savesnapshot <パス>"で終了時にシーンを保存
+    std::string loadSnapshotPath;
+    if (GetCommandLineOption(lpCmdLine, "-loadsnapshot", &loadSnapshotPath) && !renderer.LoadSceneSnapshot(loadSnapshotPath.c_str())) {
+        OutputDebugStringA("SceneSnapshot: could not load\n");
+    }
+
+    // "-stress <count>" generates a stress scene of as many actors to "-stressfile <path>" and adds it, shaped by
+    // "-stressdynamic <ratio>", "-stressdist uniform|clustered|grid" and "-stressseed <seed>"
+    // "-stress <数>"でその数のアクタのストレスシーンを"-stressfile <パス>"へ生成し追加する、
+    // "-stressdynamic <割合>"、"-stressdist uniform|clustered|grid"、"-stressseed <シード>"で形を指定する
+    std::string sceneLabel = "default";
+    std::string optionValue;
+    if (GetCommandLineOption(lpCmdLine, "-stress", &optionValue)) {
+        StressSceneDesc desc;
+        desc.actorCount = static_cast<UINT>(strtoul(optionValue.c_str(), nullptr, 10));
+        if (GetCommandLineOption(lpCmdLine, "-stressdynamic", &optionValue)) {
+            desc.dynamicRatio = std::clamp(strtof(optionValue.c_str(), nullptr), 0.0f, 1.0f);
+        }
+        if (GetCommandLineOption(lpCmdLine, "-stressdist", &optionValue) && !FindStressSceneDistribution(optionValue.c_str(), &desc.distribution)) {
+            OutputDebugStringA("StressScene: unknown distribution\n");
+        }
+        if (GetCommandLineOption(lpCmdLine, "-stressseed", &optionValue)) {
+            desc.seed = static_cast<UINT>(strtoul(optionValue.c_str(), nullptr, 10));
+        }
+
+        std::string stressPath = "StressScene.mtss";
+        GetCommandLineOption(lpCmdLine, "-stressfile", &stressPath);
+        if (!GenerateStressScene(desc, stressPath.c_str()) || !renderer.LoadSceneSnapshot(stressPath.c_str())) {
+            OutputDebugStringA("StressScene: could not generate\n");
+        }
+
+        char labelStr[128];
+        snprintf(labelStr, sizeof(labelStr), "stress %u actors, %.2f dynamic, %s, seed %u",
+            desc.actorCount, desc.dynamicRatio, GetStressSceneDistributionName(desc.distribution), desc.seed);
+        sceneLabel = labelStr;
+    }
+
+    // "-record <path>" records the frames, "-replay <path>" replays them paced by the display and
+    // "-replayfast <path>" as fast as possible
+    // "-record <パス>"でフレームを記録、"-replay <パス>"で表示に合わせて、"-replayfast <パス>"で可能な限り速く再生する
+    std::string recordPath;
+    if (GetCommandLineOption(lpCmdLine, "-record", &recordPath) && !renderer.StartFrameRecording(recordPath.c_str())) {
+        OutputDebugStringA("FrameRecorder: could not start\n");
+    }
+    std::string replayPath;
+    const bool replayFast = GetCommandLineOption(lpCmdLine, "-replayfast", &replayPath);
+    if ((replayFast || GetCommandLineOption(lpCmdLine, "-replay", &replayPath)) && !renderer.StartFrameReplay(replayPath.c_str(), replayFast)) {
+        OutputDebugStringA("FrameReplay: could not start\n");
+    }
+
+    // "-benchmark <path>" times the frames and writes their percentiles as JSON, "-benchmarkframes <count>" sets
+    // the frames recorded after the warm-up
+    // "-benchmark <パス>"でフレームを計測しそのパーセンタイルをJSONで書き込む、"-benchmarkframes <数>"で
+    // ウォームアップ後に記録するフレーム数を指定する
+    std::string benchmarkPath;
+    const bool benchmark = GetCommandLineOption(lpCmdLine, "-benchmark", &benchmarkPath);
+    if (benchmark) {
+        UINT frameCount = DEFAULT_BENCHMARK_FRAME_COUNT;
+        if (GetCommandLineOption(lpCmdLine, "-benchmarkframes", &optionValue)) {
+            frameCount = std::max(static_cast<UINT>(strtoul(optionValue.c_str(), nullptr, 10)), 1u);
+        }
+        renderer.StartBenchmark(DEFAULT_BENCHMARK_WARMUP_FRAMES, frameCount);
+    }
+
     int ret = renderer.Run();
     renderer.Deinit();
 
+    // "-baseline <path>" compares the run with an earlier one, the exit code is the number of regressed metrics
+    // "-baseline <パス>"で以前の実行と比較する、終了コードは退行したメトリクス数
+    if (benchmark) {
+        const BenchmarkRecorder &recorder = renderer.GetBenchmark();
+        if (!recorder.WriteJson(benchmarkPath.c_str(), sceneLabel.c_str())) {
+            OutputDebugStringA("Benchmark: could not write\n");
+        }
+
+        std::string baselinePath;
+        BenchmarkSummary baseline[BENCHMARK_METRIC_COUNT];
+        if (GetCommandLineOption(lpCmdLine, "-baseline", &baselinePath)) {
+            if (BenchmarkRecorder::ReadJson(baselinePath.c_str(), baseline)) {
+                BenchmarkSummary summaries[BENCHMARK_METRIC_COUNT];
+                for (UINT i = 0; i < BENCHMARK_METRIC_COUNT; ++i) {
+                    summaries[i] = recorder.Summarize(static_cast<BenchmarkMetric>(i));
+                }
+
+                std::string report;
+                ret = static_cast<int>(BenchmarkRecorder::Compare(summaries, baseline, DEFAULT_BENCHMARK_REGRESSION_TOLERANCE, &report));
+                OutputDebugStringA(report.c_str());
+            } else {
+                OutputDebugStringA("Benchmark: could not read the baseline\n");
+            }
+        }
+    }
+
+    // The threads are stopped, the scene no longer changes
+    // スレッドは停止しており、シーンはもう変化しない
+    std::string saveSnapshotPath;
+    if (GetCommandLineOption(lpCmdLine, "-savesnapshot", &saveSnapshotPath) && !renderer.SaveSceneSnapshot(saveSnapshotPath.c_str())) {
+        OutputDebugStringA("SceneSnapshot: could not save\n");
+    }
+
     return ret;
 }
@@ -0,0 +1,180 @@
+/// @file MeshAsset.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "MeshAsset.h"
+
+namespace {
+// Round up to a multiple of 4 bytes
+// 4バイト境界に切り上げ
+UINT AlignUp4(const UINT size) {
+    return (size + 3u) & ~3u;
+}
+
+// Test if a section of count elements of stride bytes at offset lies in size bytes, computed in 64 bits so a
+// corrupt header can not wrap around
+// offsetのstrideバイトの要素count個のセクションがsizeバイト内にあるか調べる、破損したヘッダで桁あふれ
+// しないよう64bitで計算する
+bool IsSectionInside(UINT offset, UINT count, UINT stride, size_t size) {
+    if ((offset % 4) != 0) {
+        return false;
+    }
+    return static_cast<UINT64>(offset) + static_cast<UINT64>(count) * stride <= static_cast<UINT64>(size);
+}
+} // namespace ""
+
+//----------------------------------------------------------------------------------------------------
+// MeshAsset
+//----------------------------------------------------------------------------------------------------
+// Build the binary layout from mesh data
+// メッシュデータからバイナリレイアウトを構築
+bool MeshAsset::Build(const MeshData &meshData, const MeshletData *meshletData) {
+    blob.clear();
+
+    if (meshData.vertices.empty() || meshData.indices.empty() || (meshData.indices.size() % 3) != 0) {
+        return false;
+    }
+
+    // Use 16-bit indices whenever all vertices are addressable
+    // 全頂点を参照できる場合は16-bitインデックスを使用
+    const bool  use16bit    = meshData.vertices.size() <= 0xffff;
+    const UINT  indexStride = use16bit ? 2 : 4;
+
+    MeshAssetHeader header = {};
+    header.magic            = MESH_ASSET_MAGIC;
+    header.version          = MESH_ASSET_VERSION;
+    header.vertexStride     = sizeof(MeshVertex);
+    header.vertexCount      = static_cast<UINT>(meshData.vertices.size());
+    header.vertexDataOffset = AlignUp4(sizeof(MeshAssetHeader));
+    header.indexFormat      = use16bit ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+    header.indexCount       = static_cast<UINT>(meshData.indices.size());
+    header.indexDataOffset  = AlignUp4(header.vertexDataOffset + header.vertexStride * header.vertexCount);
+
+    // Meshlets are placed after the index data
+    // Meshletはインデックスデータの後ろに配置
+    UINT tail = AlignUp4(header.indexDataOffset + indexStride * header.indexCount);
+    if (meshletData != nullptr && !meshletData->meshlets.empty()) {
+        if (meshletData->bounds.size() != meshletData->meshlets.size()) {
+            return false;
+        }
+
+        header.meshletCount           = static_cast<UINT>(meshletData->meshlets.size());
+        header.meshletDataOffset      = tail;
+        header.meshletBoundsOffset    = header.meshletDataOffset + sizeof(Meshlet) * header.meshletCount;
+        header.meshletVertexCount     = static_cast<UINT>(meshletData->vertexIndices.size());
+        header.meshletVertexOffset    = header.meshletBoundsOffset + sizeof(MeshletBounds) * header.meshletCount;
+        header.meshletPrimitiveCount  = static_cast<UINT>(meshletData->primitives.size());
+        header.meshletPrimitiveOffset = header.meshletVertexOffset + sizeof(UINT) * header.meshletVertexCount;
+        tail = header.meshletPrimitiveOffset + sizeof(UINT) * header.meshletPrimitiveCount;
+    }
+
+    blob.resize(tail);
+    memcpy(blob.data(), &header, sizeof(header));
+    memcpy(blob.data() + header.vertexDataOffset, meshData.vertices.data(), header.vertexStride * header.vertexCount);
+
+    if (use16bit) {
+        auto dst = reinterpret_cast<UINT16 *>(blob.data() + header.indexDataOffset);
+        for (size_t i = 0; i < meshData.indices.size(); ++i) {
+            dst[i] = static_cast<UINT16>(meshData.indices[i]);
+        }
+    } else {
+        memcpy(blob.data() + header.indexDataOffset, meshData.indices.data(), indexStride * header.indexCount);
+    }
+
+    if (0 < header.meshletCount) {
+        memcpy(blob.data() + header.meshletDataOffset,      meshletData->meshlets.data(),      sizeof(Meshlet) * header.meshletCount);
+        memcpy(blob.data() + header.meshletBoundsOffset,    meshletData->bounds.data(),        sizeof(MeshletBounds) * header.meshletCount);
+        memcpy(blob.data() + header.meshletVertexOffset,    meshletData->vertexIndices.data(), sizeof(UINT) * header.meshletVertexCount);
+        memcpy(blob.data() + header.meshletPrimitiveOffset, meshletData->primitives.data(),    sizeof(UINT) * header.meshletPrimitiveCount);
+    }
+
+    return true;
+}
+
+// Adopt serialized binary data
+// シリアライズ済みバイナリデータを取り込む
+bool MeshAsset::Load(const void *data, size_t size) {
+    blob.clear();
+
+    if (data == nullptr || size < sizeof(MeshAssetHeader)) {
+        return false;
+    }
+
+    MeshAssetHeader header;
+    memcpy(&header, data, sizeof(header));
+
+    if (header.magic != MESH_ASSET_MAGIC || header.version != MESH_ASSET_VERSION || header.vertexStride != sizeof(MeshVertex)) {
+        return false;
+    }
+    if (header.indexFormat != DXGI_FORMAT_R16_UINT && header.indexFormat != DXGI_FORMAT_R32_UINT) {
+        return false;
+    }
+
+    // Validate the data ranges, every section must lie in the data and be aligned for the reads of its elements
+    // データ範囲の検証、全セクションはデータ内にあり、要素の読み込みに対して整列している必要がある
+    const UINT indexStride = (header.indexFormat == DXGI_FORMAT_R16_UINT) ? 2 : 4;
+    if (header.vertexCount == 0 || header.indexCount == 0) {
+        return false;
+    }
+    if (!IsSectionInside(header.vertexDataOffset, header.vertexCount, header.vertexStride, size) ||
+        !IsSectionInside(header.indexDataOffset, header.indexCount, indexStride, size)) {
+        return false;
+    }
+    if (0 < header.meshletCount) {
+        if (!IsSectionInside(header.meshletDataOffset, header.meshletCount, sizeof(Meshlet), size) ||
+            !IsSectionInside(header.meshletBoundsOffset, header.meshletCount, sizeof(MeshletBounds), size) ||
+            !IsSectionInside(header.meshletVertexOffset, header.meshletVertexCount, sizeof(UINT), size) ||
+            !IsSectionInside(header.meshletPrimitiveOffset, header.meshletPrimitiveCount, sizeof(UINT), size)) {
+            return false;
+        }
+
+        // Meshlets must reference their own ranges of the meshlet vertex indices and primitives
+        // Meshletは自身のMeshlet頂点インデックスとプリミティブの範囲を参照する必要がある
+        const BYTE *meshlets = static_cast<const BYTE *>(data) + header.meshletDataOffset;
+        for (UINT i = 0; i < header.meshletCount; ++i) {
+            Meshlet meshlet;
+            memcpy(&meshlet, meshlets + sizeof(Meshlet) * i, sizeof(meshlet));
+            if (header.meshletVertexCount < static_cast<UINT64>(meshlet.vertexOffset) + meshlet.vertexCount ||
+                header.meshletPrimitiveCount < static_cast<UINT64>(meshlet.primitiveOffset) + meshlet.primitiveCount) {
+                return false;
+            }
+        }
+    }
+
+    blob.assign(static_cast<const BYTE *>(data), static_cast<const BYTE *>(data) + size);
+    return true;
+}
+
+// Load from file
+// ファイルから読み込み
+bool MeshAsset::LoadFromFile(const char *path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+
+    const auto size = static_cast<size_t>(file.tellg());
+    std::vector<BYTE> data(size);
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char *>(data.data()), size)) {
+        return false;
+    }
+
+    return Load(data.data(), data.size());
+}
+
+// Save to file
+// ファイルへ保存
+bool MeshAsset::SaveToFile(const char *path) const {
+    if (!IsValid()) {
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char *>(blob.data()), blob.size());
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,262 @@
+/// @file MeshAsset.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+// Binary mesh identifier ('MTMS')
+const UINT MESH_ASSET_MAGIC   = 0x534d544du;
+const UINT MESH_ASSET_VERSION = 2;
+
+
+/// @~english
+/// @brief Vertex data definition
+/// @~japanese
+/// @brief 頂点データ定義
+/// @~
+/// @struct MeshVertex
+struct MeshVertex {
+    float pos[3];
+    float color[4];
+};
+
+/// @~english
+/// @brief Editable mesh data used by the conversion path
+/// @~japanese
+/// @brief 変換処理で使用する編集可能なメッシュデータ
+/// @~
+/// @struct MeshData
+struct MeshData {
+    std::vector<MeshVertex> vertices;
+    std::vector<UINT>       indices;
+};
+
+/// @~english
+/// @brief Cluster of a mesh with bounded vertex and primitive counts
+/// @~japanese
+/// @brief 頂点数とプリミティブ数が制限されたメッシュのクラスタ
+/// @~
+/// @struct Meshlet
+struct Meshlet {
+    UINT    vertexCount;
+    UINT    vertexOffset;       ///< @~english Offset into the meshlet vertex indices @~japanese Meshlet頂点インデックス内のオフセット
+    UINT    primitiveCount;
+    UINT    primitiveOffset;    ///< @~english Offset into the packed primitives @~japanese パック済みプリミティブ内のオフセット
+};
+
+/// @~english
+/// @brief Culling data of a meshlet (object space)
+/// @~japanese
+/// @brief Meshletのカリング用データ（オブジェクト空間
+/// @~
+/// @struct MeshletBounds
+struct MeshletBounds {
+    DirectX::XMFLOAT3   center;
+    float               radius;
+    DirectX::XMFLOAT3   coneAxis;
+    float               coneCutoff;     ///< @~english 1.0 when the cone can not be used for culling @~japanese コーンがカリングに使用できない場合は1.0
+};
+
+/// @~english
+/// @brief Meshlets built from mesh data
+/// @~japanese
+/// @brief メッシュデータから構築したMeshlet
+/// @~
+/// @struct MeshletData
+struct MeshletData {
+    std::vector<Meshlet>        meshlets;
+    std::vector<MeshletBounds>  bounds;
+    std::vector<UINT>           vertexIndices;  ///< @~english Indices into the mesh vertices @~japanese メッシュ頂点へのインデックス
+    std::vector<UINT>           primitives;     ///< @~english Local indices packed as 10:10:10 @~japanese 10:10:10でパックしたローカルインデックス
+};
+
+/// @~english
+/// @brief Header of the binary mesh layout
+/// @~japanese
+/// @brief バイナリメッシュレイアウトのヘッダ
+/// @~
+/// @struct MeshAssetHeader
+struct MeshAssetHeader {
+    UINT    magic;
+    UINT    version;
+    UINT    vertexStride;
+    UINT    vertexCount;
+    UINT    vertexDataOffset;
+    UINT    indexFormat;        ///< @~english DXGI_FORMAT_R16_UINT or DXGI_FORMAT_R32_UINT @~japanese DXGI_FORMAT_R16_UINT か DXGI_FORMAT_R32_UINT
+    UINT    indexCount;
+    UINT    indexDataOffset;
+    UINT    meshletCount;
+    UINT    meshletDataOffset;
+    UINT    meshletBoundsOffset;
+    UINT    meshletVertexCount;
+    UINT    meshletVertexOffset;
+    UINT    meshletPrimitiveCount;
+    UINT    meshletPrimitiveOffset;
+};
+
+
+/// @class MeshAsset
+/// @~english
+/// @brief Binary mesh which can be copied as-is into vertex and index buffers
+/// @~japanese
+/// @brief そのままVertexBuffer, IndexBufferへコピー可能なバイナリメッシュ
+class MeshAsset {
+public:
+    /// @~english
+    /// @brief Build the binary layout from mesh data
+    /// @param[in] meshData Source mesh data
+    /// @param[in] meshletData Meshlets stored alongside the mesh (optional
+    /// @return True if build succeeded, false otherwise
+    /// @~japanese
+    /// @brief メッシュデータからバイナリレイアウトを構築
+    /// @param[in] meshData 元となるメッシュデータ
+    /// @param[in] meshletData メッシュと一緒に格納するMeshlet（省略可
+    /// @return 構築に成功した場合にはTrue、そうでないならFalseを返す
+    bool Build(const MeshData &meshData, const MeshletData *meshletData = nullptr);
+
+    /// @~english
+    /// @brief Adopt serialized binary data
+    /// @param[in] data Pointer to binary data
+    /// @param[in] size Size of binary data in bytes
+    /// @return True if the data is a valid mesh, false otherwise
+    /// @~japanese
+    /// @brief シリアライズ済みバイナリデータを取り込む
+    /// @param[in] data バイナリデータへのポインタ
+    /// @param[in] size バイナリデータのバイト数
+    /// @return 有効なメッシュであればTrue、そうでないならFalseを返す
+    bool Load(const void *data, size_t size);
+
+    /// @~english
+    /// @brief Load from file
+    /// @param[in] path File path
+    /// @return True if loading succeeded, false otherwise
+    /// @~japanese
+    /// @brief ファイルから読み込み
+    /// @param[in] path ファイルパス
+    /// @return 読み込みに成功した場合にはTrue、そうでないならFalseを返す
+    bool LoadFromFile(const char *path);
+
+    /// @~english
+    /// @brief Save to file
+    /// @param[in] path File path
+    /// @return True if saving succeeded, false otherwise
+    /// @~japanese
+    /// @brief ファイルへ保存
+    /// @param[in] path ファイルパス
+    /// @return 保存に成功した場合にはTrue、そうでないならFalseを返す
+    bool SaveToFile(const char *path) const;
+
+    /// @~english
+    /// @brief Check if the asset holds a valid mesh
+    /// @~japanese
+    /// @brief 有効なメッシュを保持しているか調べる
+    bool IsValid() const {
+        return !blob.empty();
+    }
+
+    /// @~english
+    /// @brief Get the header
+    /// @~japanese
+    /// @brief ヘッダを取得
+    const MeshAssetHeader& GetHeader() const {
+        return *reinterpret_cast<const MeshAssetHeader *>(blob.data());
+    }
+
+    /// @~english
+    /// @brief Get the vertex data
+    /// @~japanese
+    /// @brief 頂点データを取得
+    const void* GetVertexData() const {
+        return blob.data() + GetHeader().vertexDataOffset;
+    }
+
+    /// @~english
+    /// @brief Get the vertex data size in bytes
+    /// @~japanese
+    /// @brief 頂点データのバイト数を取得
+    UINT GetVertexDataSize() const {
+        return GetHeader().vertexStride * GetHeader().vertexCount;
+    }
+
+    /// @~english
+    /// @brief Get the index data
+    /// @~japanese
+    /// @brief インデックスデータを取得
+    const void* GetIndexData() const {
+        return blob.data() + GetHeader().indexDataOffset;
+    }
+
+    /// @~english
+    /// @brief Get the index data size in bytes
+    /// @~japanese
+    /// @brief インデックスデータのバイト数を取得
+    UINT GetIndexDataSize() const {
+        return GetIndexStride() * GetHeader().indexCount;
+    }
+
+    /// @~english
+    /// @brief Get the index format
+    /// @~japanese
+    /// @brief インデックスフォーマットを取得
+    DXGI_FORMAT GetIndexFormat() const {
+        return static_cast<DXGI_FORMAT>(GetHeader().indexFormat);
+    }
+
+    /// @~english
+    /// @brief Get the size of one index in bytes
+    /// @~japanese
+    /// @brief インデックス1つ分のバイト数を取得
+    UINT GetIndexStride() const {
+        return (GetIndexFormat() == DXGI_FORMAT_R16_UINT) ? 2 : 4;
+    }
+
+    /// @~english
+    /// @brief Get the number of meshlets
+    /// @~japanese
+    /// @brief Meshlet数を取得
+    UINT GetMeshletCount() const {
+        return GetHeader().meshletCount;
+    }
+
+    /// @~english
+    /// @brief Get the meshlets
+    /// @~japanese
+    /// @brief Meshletを取得
+    const Meshlet* GetMeshlets() const {
+        return reinterpret_cast<const Meshlet *>(blob.data() + GetHeader().meshletDataOffset);
+    }
+
+    /// @~english
+    /// @brief Get the culling data of the meshlets
+    /// @~japanese
+    /// @brief Meshletのカリング用データを取得
+    const MeshletBounds* GetMeshletBounds() const {
+        return reinterpret_cast<const MeshletBounds *>(blob.data() + GetHeader().meshletBoundsOffset);
+    }
+
+    /// @~english
+    /// @brief Get the meshlet vertex indices
+    /// @~japanese
+    /// @brief Meshlet頂点インデックスを取得
+    const UINT* GetMeshletVertexIndices() const {
+        return reinterpret_cast<const UINT *>(blob.data() + GetHeader().meshletVertexOffset);
+    }
+
+    /// @~english
+    /// @brief Get the packed meshlet primitives
+    /// @~japanese
+    /// @brief パック済みMeshletプリミティブを取得
+    const UINT* GetMeshletPrimitives() const {
+        return reinterpret_cast<const UINT *>(blob.data() + GetHeader().meshletPrimitiveOffset);
+    }
+
+    /// @~english
+    /// @brief Get the serialized binary data
+    /// @~japanese
+    /// @brief シリアライズ済みバイナリデータを取得
+    const std::vector<BYTE>& GetBinary() const {
+        return blob;
+    }
+
+private:
+    std::vector<BYTE>   blob;
+};
@@ -0,0 +1,428 @@
+/// @file MeshOptimizer.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "MeshOptimizer.h"
+
+using namespace DirectX;
+
+namespace {
+// Parameters of the Forsyth vertex cache optimizer
+// Forsyth方式頂点キャッシュ最適化のパラメータ
+const UINT  FORSYTH_CACHE_SIZE          = 32;
+const UINT  FORSYTH_MAX_VALENCE         = 32;
+const float FORSYTH_CACHE_DECAY_POWER   = 1.5f;
+const float FORSYTH_LAST_TRI_SCORE      = 0.75f;
+const float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+const float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+const UINT  INVALID_INDEX               = ~0u;
+
+/// @brief Forsyth方式のスコアテーブル
+struct ForsythScoreTable {
+    float cacheScore[FORSYTH_CACHE_SIZE];
+    float valenceScore[FORSYTH_MAX_VALENCE + 1];
+
+    ForsythScoreTable() {
+        for (UINT i = 0; i < FORSYTH_CACHE_SIZE; ++i) {
+            if (i < 3) {
+                // Vertices used by the last triangle get a fixed score so that the strip does not turn back
+                // 直前の三角形の頂点は折り返しを防ぐため固定スコア
+                cacheScore[i] = FORSYTH_LAST_TRI_SCORE;
+            } else {
+                const float scaler = 1.0f / static_cast<float>(FORSYTH_CACHE_SIZE - 3);
+                cacheScore[i] = std::pow(1.0f - static_cast<float>(i - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+            }
+        }
+
+        valenceScore[0] = 0.0f;
+        for (UINT i = 1; i <= FORSYTH_MAX_VALENCE; ++i) {
+            valenceScore[i] = FORSYTH_VALENCE_BOOST_SCALE * std::pow(static_cast<float>(i), -FORSYTH_VALENCE_BOOST_POWER);
+        }
+    }
+
+    float GetVertexScore(const UINT cachePos, const UINT remainingTris) const {
+        if (remainingTris == 0) {
+            return -1.0f;
+        }
+
+        float score = (cachePos < FORSYTH_CACHE_SIZE) ? cacheScore[cachePos] : 0.0f;
+        score += valenceScore[std::min(remainingTris, FORSYTH_MAX_VALENCE)];
+        return score;
+    }
+};
+
+// Update the FIFO cache and return the number of misses
+// FIFOキャッシュを更新しミス数を返す
+UINT UpdateFifoCache(const UINT *tri, std::vector<UINT> &timestamps, UINT &timestamp, const UINT cacheSize) {
+    UINT misses = 0;
+    for (UINT k = 0; k < 3; ++k) {
+        const UINT v = tri[k];
+        if (cacheSize < timestamp - timestamps[v]) {
+            timestamps[v] = timestamp++;
+            misses++;
+        }
+    }
+    return misses;
+}
+
+// Load vertex position
+// 頂点位置を読み込み
+XMVECTOR LoadPosition(const MeshVertex &vertex) {
+    return XMVectorSet(vertex.pos[0], vertex.pos[1], vertex.pos[2], 0.0f);
+}
+} // namespace ""
+
+//----------------------------------------------------------------------------------------------------
+// MeshOptimizer
+//----------------------------------------------------------------------------------------------------
+// Run all optimization steps on the mesh data
+// メッシュデータに全ての最適化処理を適用
+bool MeshOptimizer::Optimize(MeshData &meshData, const MeshOptimizeSettings &settings, MeshOptimizeReport *report) {
+    const size_t indexCount  = meshData.indices.size();
+    const size_t vertexCount = meshData.vertices.size();
+
+    if (indexCount == 0 || (indexCount % 3) != 0) {
+        return false;
+    }
+    for (auto index : meshData.indices) {
+        if (vertexCount <= index) {
+            return false;
+        }
+    }
+
+    auto beginTime = std::chrono::high_resolution_clock::now();
+
+    MeshOptimizeReport result;
+    result.before = AnalyzeVertexCache(meshData.indices.data(), indexCount, vertexCount, settings.cacheSize);
+
+    // Vertex cache reordering
+    // 頂点キャッシュ向けの並び替え
+    std::vector<UINT> cacheOptimized(indexCount);
+    OptimizeVertexCache(cacheOptimized.data(), meshData.indices.data(), indexCount, vertexCount);
+
+    // Overdraw-aware cluster ordering
+    // オーバードローを考慮したクラスタの並び替え
+    if (settings.optimizeOverdraw) {
+        result.clusterCount = OptimizeOverdraw(meshData.indices.data(), cacheOptimized.data(), indexCount, meshData.vertices.data(), vertexCount, settings.cacheSize, settings.overdrawThreshold);
+    } else {
+        meshData.indices.swap(cacheOptimized);
+        result.clusterCount = 1;
+    }
+
+    // Vertex fetch remapping
+    // 頂点フェッチ向けの再マップ
+    if (settings.optimizeVertexFetch) {
+        std::vector<MeshVertex> vertices(vertexCount);
+        const size_t usedCount = OptimizeVertexFetch(vertices.data(), meshData.indices.data(), indexCount, meshData.vertices.data(), vertexCount);
+        vertices.resize(usedCount);
+        meshData.vertices.swap(vertices);
+    }
+
+    result.after = AnalyzeVertexCache(meshData.indices.data(), indexCount, meshData.vertices.size(), settings.cacheSize);
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    result.timeInMs = std::chrono::duration<float, std::milli>(endTime - beginTime).count();
+
+    if (report != nullptr) {
+        *report = result;
+    }
+    return true;
+}
+
+// Reorder triangles for the post-transform vertex cache (Forsyth)
+// 頂点キャッシュ向けに三角形を並び替え（Forsyth方式
+void MeshOptimizer::OptimizeVertexCache(UINT *dstIndices, const UINT *srcIndices, size_t indexCount, size_t vertexCount) {
+    static const ForsythScoreTable scoreTable;
+
+    const size_t triCount = indexCount / 3;
+    if (triCount == 0) {
+        return;
+    }
+
+    // Build vertex to triangle adjacency
+    // 頂点から三角形への隣接情報を構築
+    std::vector<UINT> remainingTris(vertexCount, 0);
+    for (size_t i = 0; i < indexCount; ++i) {
+        remainingTris[srcIndices[i]]++;
+    }
+
+    std::vector<UINT> adjacencyOffsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        adjacencyOffsets[v + 1] = adjacencyOffsets[v] + remainingTris[v];
+    }
+
+    std::vector<UINT> adjacency(indexCount);
+    {
+        std::vector<UINT> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t t = 0; t < triCount; ++t) {
+            for (size_t k = 0; k < 3; ++k) {
+                const UINT v = srcIndices[t * 3 + k];
+                adjacency[fill[v]++] = static_cast<UINT>(t);
+            }
+        }
+    }
+
+    // Initial scores
+    // 初期スコア
+    std::vector<UINT>  cachePos(vertexCount, FORSYTH_CACHE_SIZE);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        vertexScores[v] = scoreTable.GetVertexScore(FORSYTH_CACHE_SIZE, remainingTris[v]);
+    }
+
+    std::vector<float> triScores(triCount);
+    std::vector<bool>  emitted(triCount, false);
+    UINT  bestTri   = 0;
+    float bestScore = -1.0f;
+    for (size_t t = 0; t < triCount; ++t) {
+        const UINT *tri = &srcIndices[t * 3];
+        triScores[t] = vertexScores[tri[0]] + vertexScores[tri[1]] + vertexScores[tri[2]];
+        if (bestScore < triScores[t]) {
+            bestScore = triScores[t];
+            bestTri   = static_cast<UINT>(t);
+        }
+    }
+
+    UINT cache[FORSYTH_CACHE_SIZE + 3];
+    UINT cacheCount = 0;
+    size_t cursor = 0;
+
+    for (size_t out = 0; out < triCount; ++out) {
+        // Fall back to the next unemitted triangle when nothing in the cache is usable
+        // キャッシュ内に候補が無い場合は未出力の次の三角形を使用
+        if (bestTri == INVALID_INDEX) {
+            while (emitted[cursor]) {
+                ++cursor;
+            }
+            bestTri = static_cast<UINT>(cursor);
+        }
+
+        const UINT *tri = &srcIndices[bestTri * 3];
+        dstIndices[out * 3 + 0] = tri[0];
+        dstIndices[out * 3 + 1] = tri[1];
+        dstIndices[out * 3 + 2] = tri[2];
+        emitted[bestTri] = true;
+
+        // Remove the triangle from the adjacency of its vertices
+        // 頂点の隣接情報から三角形を削除
+        for (UINT k = 0; k < 3; ++k) {
+            const UINT v = tri[k];
+            UINT *adjBegin = &adjacency[adjacencyOffsets[v]];
+            UINT *adjEnd   = adjBegin + remainingTris[v];
+            auto found = std::find(adjBegin, adjEnd, bestTri);
+            if (found != adjEnd) {
+                *found = *(adjEnd - 1);
+                remainingTris[v]--;
+            }
+        }
+
+        // Push the triangle vertices to the front of the LRU cache
+        // 三角形の頂点をLRUキャッシュの先頭へ追加
+        UINT newCache[FORSYTH_CACHE_SIZE + 3];
+        UINT newCacheCount = 0;
+        newCache[newCacheCount++] = tri[0];
+        newCache[newCacheCount++] = tri[1];
+        newCache[newCacheCount++] = tri[2];
+        for (UINT i = 0; i < cacheCount; ++i) {
+            const UINT v = cache[i];
+            if (v != tri[0] && v != tri[1] && v != tri[2]) {
+                newCache[newCacheCount++] = v;
+            }
+        }
+
+        // Update scores of vertices whose cache position changed
+        // キャッシュ位置が変化した頂点のスコアを更新
+        for (UINT i = 0; i < newCacheCount; ++i) {
+            const UINT v = newCache[i];
+            cachePos[v] = (i < FORSYTH_CACHE_SIZE) ? i : FORSYTH_CACHE_SIZE;
+
+            const float score = scoreTable.GetVertexScore(cachePos[v], remainingTris[v]);
+            const float diff  = score - vertexScores[v];
+            vertexScores[v] = score;
+
+            const UINT *adjBegin = &adjacency[adjacencyOffsets[v]];
+            for (UINT j = 0; j < remainingTris[v]; ++j) {
+                triScores[adjBegin[j]] += diff;
+            }
+        }
+
+        cacheCount = std::min(newCacheCount, FORSYTH_CACHE_SIZE);
+        memcpy(cache, newCache, sizeof(UINT) * cacheCount);
+
+        // Pick the best triangle adjacent to the cache
+        // キャッシュに隣接する三角形から最良のものを選択
+        bestTri   = INVALID_INDEX;
+        bestScore = -1.0f;
+        for (UINT i = 0; i < cacheCount; ++i) {
+            const UINT v = cache[i];
+            const UINT *adjBegin = &adjacency[adjacencyOffsets[v]];
+            for (UINT j = 0; j < remainingTris[v]; ++j) {
+                const UINT t = adjBegin[j];
+                if (bestScore < triScores[t]) {
+                    bestScore = triScores[t];
+                    bestTri   = t;
+                }
+            }
+        }
+    }
+}
+
+// Reorder cache-optimized clusters so that outward facing ones are drawn first
+// 外向きのクラスタから描画されるよう、キャッシュ最適化済みのクラスタを並び替え
+UINT MeshOptimizer::OptimizeOverdraw(UINT *dstIndices, const UINT *srcIndices, size_t indexCount, const MeshVertex *vertices, size_t vertexCount, UINT cacheSize, float threshold) {
+    const size_t triCount = indexCount / 3;
+    if (triCount == 0) {
+        return 0;
+    }
+
+    std::vector<UINT> timestamps(vertexCount, 0);
+    UINT timestamp = cacheSize + 1;
+
+    // Hard boundaries: triangles which start with a cold cache, the first one always does even if it is
+    // degenerate or shares its vertices, so every triangle belongs to a cluster
+    // ハード境界: キャッシュが全てミスする三角形、最初の三角形は縮退や頂点の共有があっても常に境界となる為、
+    // 全ての三角形がいずれかのクラスタに属する
+    std::vector<UINT> hardBoundaries(1, 0);
+    UpdateFifoCache(&srcIndices[0], timestamps, timestamp, cacheSize);
+    for (size_t t = 1; t < triCount; ++t) {
+        if (UpdateFifoCache(&srcIndices[t * 3], timestamps, timestamp, cacheSize) == 3) {
+            hardBoundaries.push_back(static_cast<UINT>(t));
+        }
+    }
+    hardBoundaries.push_back(static_cast<UINT>(triCount));
+
+    // Soft boundaries: split hard clusters where the running ACMR stays within the threshold
+    // ソフト境界: 累積ACMRが閾値内に収まる位置でハードクラスタを分割
+    std::vector<UINT> clusters;
+    for (size_t c = 0; c + 1 < hardBoundaries.size(); ++c) {
+        const UINT start = hardBoundaries[c];
+        const UINT end   = hardBoundaries[c + 1];
+
+        timestamp += cacheSize + 1;
+        UINT clusterMisses = 0;
+        for (UINT t = start; t < end; ++t) {
+            clusterMisses += UpdateFifoCache(&srcIndices[t * 3], timestamps, timestamp, cacheSize);
+        }
+        const float clusterThreshold = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - start);
+
+        clusters.push_back(start);
+
+        timestamp += cacheSize + 1;
+        UINT runningMisses = 0;
+        UINT runningTris   = 0;
+        for (UINT t = start; t < end; ++t) {
+            runningMisses += UpdateFifoCache(&srcIndices[t * 3], timestamps, timestamp, cacheSize);
+            runningTris++;
+
+            if (t + 1 < end && static_cast<float>(runningMisses) <= clusterThreshold * static_cast<float>(runningTris)) {
+                clusters.push_back(t + 1);
+
+                timestamp += cacheSize + 1;
+                runningMisses = 0;
+                runningTris   = 0;
+            }
+        }
+    }
+    clusters.push_back(static_cast<UINT>(triCount));
+
+    const size_t clusterCount = clusters.size() - 1;
+
+    // Mesh centroid
+    // メッシュ中心
+    XMVECTOR meshCentroid = XMVectorZero();
+    for (size_t i = 0; i < indexCount; ++i) {
+        meshCentroid = XMVectorAdd(meshCentroid, LoadPosition(vertices[srcIndices[i]]));
+    }
+    meshCentroid = XMVectorScale(meshCentroid, 1.0f / static_cast<float>(indexCount));
+
+    // Sort key: distance of the cluster from the mesh center along the cluster normal
+    // ソートキー: クラスタ法線方向のメッシュ中心からの距離
+    std::vector<float> sortKeys(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c) {
+        XMVECTOR centroid  = XMVectorZero();
+        XMVECTOR normal    = XMVectorZero();
+        float    totalArea = 0.0f;
+
+        for (UINT t = clusters[c]; t < clusters[c + 1]; ++t) {
+            XMVECTOR p0 = LoadPosition(vertices[srcIndices[t * 3 + 0]]);
+            XMVECTOR p1 = LoadPosition(vertices[srcIndices[t * 3 + 1]]);
+            XMVECTOR p2 = LoadPosition(vertices[srcIndices[t * 3 + 2]]);
+
+            XMVECTOR faceNormal = XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0));
+            const float area    = XMVectorGetX(XMVector3Length(faceNormal));
+
+            centroid  = XMVectorAdd(centroid, XMVectorScale(XMVectorAdd(XMVectorAdd(p0, p1), p2), area / 3.0f));
+            normal    = XMVectorAdd(normal, faceNormal);
+            totalArea += area;
+        }
+
+        if (0.0f < totalArea) {
+            centroid = XMVectorScale(centroid, 1.0f / totalArea);
+        }
+        normal = XMVector3Normalize(normal);
+
+        sortKeys[c] = XMVectorGetX(XMVector3Dot(XMVectorSubtract(centroid, meshCentroid), normal));
+    }
+
+    std::vector<UINT> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&sortKeys](UINT a, UINT b) {
+        return sortKeys[b] < sortKeys[a];
+    });
+
+    size_t out = 0;
+    for (auto c : order) {
+        const size_t begin = static_cast<size_t>(clusters[c]) * 3;
+        const size_t end   = static_cast<size_t>(clusters[c + 1]) * 3;
+        memcpy(&dstIndices[out], &srcIndices[begin], sizeof(UINT) * (end - begin));
+        out += end - begin;
+    }
+    assert(out == indexCount);
+
+    return static_cast<UINT>(clusterCount);
+}
+
+// Reorder vertices in order of first use and remap indices
+// 頂点を初回参照順に並び替え、インデックスを再マップ
+size_t MeshOptimizer::OptimizeVertexFetch(MeshVertex *dstVertices, UINT *indices, size_t indexCount, const MeshVertex *srcVertices, size_t vertexCount) {
+    std::vector<UINT> remap(vertexCount, INVALID_INDEX);
+    UINT nextVertex = 0;
+
+    for (size_t i = 0; i < indexCount; ++i) {
+        const UINT v = indices[i];
+        if (remap[v] == INVALID_INDEX) {
+            dstVertices[nextVertex] = srcVertices[v];
+            remap[v] = nextVertex++;
+        }
+        indices[i] = remap[v];
+    }
+
+    return nextVertex;
+}
+
+// Simulate a FIFO vertex cache and compute ACMR/ATVR
+// FIFO頂点キャッシュをシミュレートしACMR/ATVRを算出
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const UINT *indices, size_t indexCount, size_t vertexCount, UINT cacheSize) {
+    VertexCacheStats stats;
+
+    std::vector<UINT> timestamps(vertexCount, 0);
+    std::vector<bool> referenced(vertexCount, false);
+    UINT timestamp = cacheSize + 1;
+
+    for (size_t t = 0; t < indexCount / 3; ++t) {
+        stats.cacheMisses += UpdateFifoCache(&indices[t * 3], timestamps, timestamp, cacheSize);
+    }
+    for (size_t i = 0; i < indexCount; ++i) {
+        if (!referenced[indices[i]]) {
+            referenced[indices[i]] = true;
+            stats.vertexCount++;
+        }
+    }
+
+    stats.triangleCount = static_cast<UINT>(indexCount / 3);
+    stats.acmr = (0 < stats.triangleCount) ? static_cast<float>(stats.cacheMisses) / static_cast<float>(stats.triangleCount) : 0.0f;
+    stats.atvr = (0 < stats.vertexCount)   ? static_cast<float>(stats.cacheMisses) / static_cast<float>(stats.vertexCount)   : 0.0f;
+
+    return stats;
+}
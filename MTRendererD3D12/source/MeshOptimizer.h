@@ -0,0 +1,173 @@
+/// @file MeshOptimizer.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+#include "MeshAsset.h"
+
+// Default value
+const UINT  DEFAULT_VERTEX_CACHE_SIZE   = 16;
+const float DEFAULT_OVERDRAW_THRESHOLD  = 1.05f;
+
+
+/// @~english
+/// @brief Post-transform vertex cache statistics
+/// @~japanese
+/// @brief 頂点キャッシュの統計情報
+/// @~
+/// @struct VertexCacheStats
+struct VertexCacheStats {
+    UINT    triangleCount;
+    UINT    vertexCount;        ///< @~english Number of referenced vertices @~japanese 参照されている頂点数
+    UINT    cacheMisses;
+    float   acmr;               ///< @~english Average cache miss ratio (misses per triangle) @~japanese 三角形あたりのキャッシュミス数
+    float   atvr;               ///< @~english Average transformed vertex ratio (misses per vertex) @~japanese 頂点あたりのキャッシュミス数
+
+    /// @brief コンストラクタ
+    VertexCacheStats()
+    : triangleCount(0)
+    , vertexCount(0)
+    , cacheMisses(0)
+    , acmr(0.0f)
+    , atvr(0.0f)
+    {
+        ;
+    }
+};
+
+/// @~english
+/// @brief Settings of the mesh optimization stage
+/// @~japanese
+/// @brief メッシュ最適化処理の設定
+/// @~
+/// @struct MeshOptimizeSettings
+struct MeshOptimizeSettings {
+    UINT    cacheSize;              ///< @~english FIFO cache size used for analysis and clustering @~japanese 解析とクラスタ分割に使用するFIFOキャッシュサイズ
+    float   overdrawThreshold;      ///< @~english Allowed ACMR degradation of overdraw ordering @~japanese オーバードロー最適化で許容するACMRの悪化率
+    bool    optimizeOverdraw;
+    bool    optimizeVertexFetch;
+
+    /// @brief コンストラクタ
+    MeshOptimizeSettings()
+    : cacheSize(DEFAULT_VERTEX_CACHE_SIZE)
+    , overdrawThreshold(DEFAULT_OVERDRAW_THRESHOLD)
+    , optimizeOverdraw(true)
+    , optimizeVertexFetch(true)
+    {
+        ;
+    }
+};
+
+/// @~english
+/// @brief Result of the mesh optimization stage
+/// @~japanese
+/// @brief メッシュ最適化処理の結果
+/// @~
+/// @struct MeshOptimizeReport
+struct MeshOptimizeReport {
+    VertexCacheStats    before;
+    VertexCacheStats    after;
+    UINT                clusterCount;
+    float               timeInMs;
+
+    /// @brief コンストラクタ
+    MeshOptimizeReport()
+    : clusterCount(0)
+    , timeInMs(0.0f)
+    {
+        ;
+    }
+};
+
+
+/// @class MeshOptimizer
+/// @~english
+/// @brief Offline index and vertex reordering for the post-transform cache and overdraw
+/// @~japanese
+/// @brief 頂点キャッシュとオーバードロー向けのオフライン並び替え処理
+class MeshOptimizer {
+public:
+    /// @~english
+    /// @brief Run all optimization steps on the mesh data
+    /// @param[in,out] meshData Mesh data to optimize
+    /// @param[in] settings Optimization settings
+    /// @param[out] report ACMR/ATVR before and after (optional
+    /// @return True if optimization succeeded, false otherwise
+    /// @~japanese
+    /// @brief メッシュデータに全ての最適化処理を適用
+    /// @param[in,out] meshData 最適化するメッシュデータ
+    /// @param[in] settings 最適化設定
+    /// @param[out] report 最適化前後のACMR/ATVR（省略可
+    /// @return 最適化に成功した場合にはTrue、そうでないならFalseを返す
+    static bool Optimize(MeshData &meshData, const MeshOptimizeSettings &settings, MeshOptimizeReport *report);
+
+    /// @~english
+    /// @brief Reorder triangles for the post-transform vertex cache (Forsyth)
+    /// @param[out] dstIndices Destination indices (must not alias srcIndices
+    /// @param[in] srcIndices Source indices
+    /// @param[in] indexCount Number of indices
+    /// @param[in] vertexCount Number of vertices
+    /// @~japanese
+    /// @brief 頂点キャッシュ向けに三角形を並び替え（Forsyth方式
+    /// @param[out] dstIndices 出力先インデックス（srcIndicesと重複不可
+    /// @param[in] srcIndices 入力インデックス
+    /// @param[in] indexCount インデックス数
+    /// @param[in] vertexCount 頂点数
+    static void OptimizeVertexCache(UINT *dstIndices, const UINT *srcIndices, size_t indexCount, size_t vertexCount);
+
+    /// @~english
+    /// @brief Reorder cache-optimized clusters so that outward facing ones are drawn first
+    /// @param[out] dstIndices Destination indices (must not alias srcIndices
+    /// @param[in] srcIndices Source indices, already optimized for the vertex cache
+    /// @param[in] indexCount Number of indices
+    /// @param[in] vertices Vertex array
+    /// @param[in] vertexCount Number of vertices
+    /// @param[in] cacheSize FIFO cache size
+    /// @param[in] threshold Allowed ACMR degradation
+    /// @return Number of clusters
+    /// @~japanese
+    /// @brief 外向きのクラスタから描画されるよう、キャッシュ最適化済みのクラスタを並び替え
+    /// @param[out] dstIndices 出力先インデックス（srcIndicesと重複不可
+    /// @param[in] srcIndices 頂点キャッシュ最適化済みの入力インデックス
+    /// @param[in] indexCount インデックス数
+    /// @param[in] vertices 頂点配列
+    /// @param[in] vertexCount 頂点数
+    /// @param[in] cacheSize FIFOキャッシュサイズ
+    /// @param[in] threshold 許容するACMRの悪化率
+    /// @return クラスタ数
+    static UINT OptimizeOverdraw(UINT *dstIndices, const UINT *srcIndices, size_t indexCount, const MeshVertex *vertices, size_t vertexCount, UINT cacheSize, float threshold);
+
+    /// @~english
+    /// @brief Reorder vertices in order of first use and remap indices
+    /// @param[out] dstVertices Destination vertices (must not alias srcVertices
+    /// @param[in,out] indices Indices to remap
+    /// @param[in] indexCount Number of indices
+    /// @param[in] srcVertices Source vertices
+    /// @param[in] vertexCount Number of vertices
+    /// @return Number of referenced vertices written to dstVertices
+    /// @~japanese
+    /// @brief 頂点を初回参照順に並び替え、インデックスを再マップ
+    /// @param[out] dstVertices 出力先頂点（srcVerticesと重複不可
+    /// @param[in,out] indices 再マップするインデックス
+    /// @param[in] indexCount インデックス数
+    /// @param[in] srcVertices 入力頂点
+    /// @param[in] vertexCount 頂点数
+    /// @return dstVerticesへ書き込んだ参照頂点数
+    static size_t OptimizeVertexFetch(MeshVertex *dstVertices, UINT *indices, size_t indexCount, const MeshVertex *srcVertices, size_t vertexCount);
+
+    /// @~english
+    /// @brief Simulate a FIFO vertex cache and compute ACMR/ATVR
+    /// @param[in] indices Indices
+    /// @param[in] indexCount Number of indices
+    /// @param[in] vertexCount Number of vertices
+    /// @param[in] cacheSize FIFO cache size
+    /// @return Cache statistics
+    /// @~japanese
+    /// @brief FIFO頂点キャッシュをシミュレートしACMR/ATVRを算出
+    /// @param[in] indices インデックス
+    /// @param[in] indexCount インデックス数
+    /// @param[in] vertexCount 頂点数
+    /// @param[in] cacheSize FIFOキャッシュサイズ
+    /// @return キャッシュ統計情報
+    static VertexCacheStats AnalyzeVertexCache(const UINT *indices, size_t indexCount, size_t vertexCount, UINT cacheSize);
+};
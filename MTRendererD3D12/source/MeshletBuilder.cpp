@@ -0,0 +1,305 @@
+/// @file MeshletBuilder.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "MeshletBuilder.h"
+
+using namespace DirectX;
+
+namespace {
+const UINT INVALID_INDEX = ~0u;
+
+// Pack local indices of a primitive (10:10:10)
+// プリミティブのローカルインデックスをパック（10:10:10
+UINT PackPrimitive(const UINT i0, const UINT i1, const UINT i2) {
+    return (i0 & 0x3ffu) | ((i1 & 0x3ffu) << 10) | ((i2 & 0x3ffu) << 20);
+}
+
+// Unpack local indices of a primitive
+// プリミティブのローカルインデックスを展開
+void UnpackPrimitive(const UINT packed, UINT *dst) {
+    dst[0] = packed & 0x3ffu;
+    dst[1] = (packed >> 10) & 0x3ffu;
+    dst[2] = (packed >> 20) & 0x3ffu;
+}
+
+// Load vertex position
+// 頂点位置を読み込み
+XMVECTOR LoadPosition(const MeshVertex &vertex) {
+    return XMVectorSet(vertex.pos[0], vertex.pos[1], vertex.pos[2], 0.0f);
+}
+} // namespace ""
+
+//----------------------------------------------------------------------------------------------------
+// MeshletBuilder
+//----------------------------------------------------------------------------------------------------
+// Build meshlets in index order
+// インデックス順にMeshletを構築
+bool MeshletBuilder::Build(const MeshData &meshData, UINT maxVertices, UINT maxPrimitives, MeshletData *dstMeshletData, MeshletBuildStats *stats) {
+    if (dstMeshletData == nullptr) {
+        return false;
+    }
+
+    // Nothing is left in the destination on failure, so a truncated build can not pass for a complete one
+    // 失敗時は出力先に何も残さない為、途中までの構築が完全なものと取り違えられる事は無い
+    dstMeshletData->meshlets.clear();
+    dstMeshletData->bounds.clear();
+    dstMeshletData->vertexIndices.clear();
+    dstMeshletData->primitives.clear();
+
+    if (maxVertices < 3 || MAX_MESHLET_VERTICES < maxVertices || maxPrimitives < 1 || MAX_MESHLET_PRIMITIVES < maxPrimitives) {
+        return false;
+    }
+    if (meshData.indices.empty() || (meshData.indices.size() % 3) != 0 || MAX_MESHLET_SOURCE_INDEX_COUNT < meshData.indices.size()) {
+        return false;
+    }
+
+    // Every index is validated before any meshlet is emitted
+    // Meshletを出力する前に全インデックスを検証
+    const size_t vertexCount = meshData.vertices.size();
+    for (const UINT index : meshData.indices) {
+        if (vertexCount <= index) {
+            return false;
+        }
+    }
+
+    auto beginTime = std::chrono::high_resolution_clock::now();
+
+    auto &meshlets      = dstMeshletData->meshlets;
+    auto &vertexIndices = dstMeshletData->vertexIndices;
+    auto &primitives    = dstMeshletData->primitives;
+
+    const size_t triCount = meshData.indices.size() / 3;
+    meshlets.reserve(triCount / maxPrimitives + 1);
+    vertexIndices.reserve(meshData.indices.size());
+    primitives.reserve(triCount);
+
+    // Local index of each vertex in the current meshlet
+    // 現在のMeshlet内での各頂点のローカルインデックス
+    std::vector<UINT> localIndices(meshData.vertices.size(), INVALID_INDEX);
+
+    Meshlet current = {};
+    auto flush = [&]() {
+        if (current.primitiveCount == 0) {
+            return;
+        }
+        meshlets.push_back(current);
+
+        for (UINT i = 0; i < current.vertexCount; ++i) {
+            localIndices[vertexIndices[current.vertexOffset + i]] = INVALID_INDEX;
+        }
+
+        current.vertexCount     = 0;
+        current.vertexOffset    = static_cast<UINT>(vertexIndices.size());
+        current.primitiveCount  = 0;
+        current.primitiveOffset = static_cast<UINT>(primitives.size());
+    };
+
+    for (size_t t = 0; t < triCount; ++t) {
+        const UINT *tri = &meshData.indices[t * 3];
+
+        UINT newVertices = 0;
+        for (UINT k = 0; k < 3; ++k) {
+            newVertices += (localIndices[tri[k]] == INVALID_INDEX) ? 1 : 0;
+        }
+
+        // Start a new meshlet when the limits would be exceeded
+        // 上限を超える場合は新しいMeshletを開始
+        if (maxVertices < current.vertexCount + newVertices || maxPrimitives < current.primitiveCount + 1) {
+            flush();
+        }
+
+        UINT local[3];
+        for (UINT k = 0; k < 3; ++k) {
+            if (localIndices[tri[k]] == INVALID_INDEX) {
+                localIndices[tri[k]] = current.vertexCount++;
+                vertexIndices.push_back(tri[k]);
+            }
+            local[k] = localIndices[tri[k]];
+        }
+
+        primitives.push_back(PackPrimitive(local[0], local[1], local[2]));
+        current.primitiveCount++;
+    }
+    flush();
+
+    // Culling data
+    // カリング用データ
+    dstMeshletData->bounds.resize(meshlets.size());
+    for (size_t i = 0; i < meshlets.size(); ++i) {
+        dstMeshletData->bounds[i] = ComputeBounds(meshData, *dstMeshletData, meshlets[i]);
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    if (stats != nullptr) {
+        stats->meshletCount      = static_cast<UINT>(meshlets.size());
+        stats->triangleCount     = static_cast<UINT>(triCount);
+        stats->averageVertices   = static_cast<float>(vertexIndices.size()) / static_cast<float>(meshlets.size());
+        stats->averagePrimitives = static_cast<float>(primitives.size()) / static_cast<float>(meshlets.size());
+        stats->timeInMs          = std::chrono::duration<float, std::milli>(endTime - beginTime).count();
+    }
+
+    return true;
+}
+
+// Compute the bounding sphere and normal cone of a meshlet
+// Meshletの境界球と法線コーンを算出
+MeshletBounds MeshletBuilder::ComputeBounds(const MeshData &meshData, const MeshletData &meshletData, const Meshlet &meshlet) {
+    MeshletBounds bounds = {};
+
+    const UINT *vertexIndices = &meshletData.vertexIndices[meshlet.vertexOffset];
+    auto position = [&](UINT localIndex) {
+        return LoadPosition(meshData.vertices[vertexIndices[localIndex]]);
+    };
+
+    // Bounding sphere (Ritter)
+    // 境界球（Ritter法
+    {
+        XMVECTOR p0 = position(0);
+
+        XMVECTOR p1 = p0;
+        float maxDistSq = -1.0f;
+        for (UINT i = 0; i < meshlet.vertexCount; ++i) {
+            const float distSq = XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(position(i), p0)));
+            if (maxDistSq < distSq) {
+                maxDistSq = distSq;
+                p1 = position(i);
+            }
+        }
+
+        XMVECTOR p2 = p1;
+        maxDistSq = -1.0f;
+        for (UINT i = 0; i < meshlet.vertexCount; ++i) {
+            const float distSq = XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(position(i), p1)));
+            if (maxDistSq < distSq) {
+                maxDistSq = distSq;
+                p2 = position(i);
+            }
+        }
+
+        XMVECTOR center = XMVectorScale(XMVectorAdd(p1, p2), 0.5f);
+        float    radius = 0.5f * std::sqrt(maxDistSq);
+
+        // Grow the sphere to contain all vertices
+        // 全頂点を含むよう球を拡大
+        for (UINT i = 0; i < meshlet.vertexCount; ++i) {
+            XMVECTOR offset = XMVectorSubtract(position(i), center);
+            const float dist = XMVectorGetX(XMVector3Length(offset));
+            if (radius < dist) {
+                const float newRadius = 0.5f * (radius + dist);
+                center = XMVectorAdd(center, XMVectorScale(offset, (newRadius - radius) / dist));
+                radius = newRadius;
+            }
+        }
+
+        XMStoreFloat3(&bounds.center, center);
+        bounds.radius = radius;
+    }
+
+    // Normal cone
+    // 法線コーン
+    {
+        std::vector<XMFLOAT3> normals;
+        normals.reserve(meshlet.primitiveCount);
+
+        XMVECTOR axis = XMVectorZero();
+        for (UINT i = 0; i < meshlet.primitiveCount; ++i) {
+            UINT local[3];
+            UnpackPrimitive(meshletData.primitives[meshlet.primitiveOffset + i], local);
+
+            XMVECTOR p0 = position(local[0]);
+            XMVECTOR normal = XMVector3Cross(XMVectorSubtract(position(local[1]), p0), XMVectorSubtract(position(local[2]), p0));
+            if (XMVectorGetX(XMVector3LengthSq(normal)) <= 0.0f) {
+                continue;
+            }
+
+            normal = XMVector3Normalize(normal);
+            axis   = XMVectorAdd(axis, normal);
+
+            XMFLOAT3 n;
+            XMStoreFloat3(&n, normal);
+            normals.push_back(n);
+        }
+
+        bounds.coneCutoff = 1.0f;
+        bounds.coneAxis   = XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+        if (!normals.empty() && 0.0f < XMVectorGetX(XMVector3LengthSq(axis))) {
+            axis = XMVector3Normalize(axis);
+
+            float minDot = 1.0f;
+            for (const auto &n : normals) {
+                minDot = std::min(minDot, XMVectorGetX(XMVector3Dot(axis, XMLoadFloat3(&n))));
+            }
+
+            // A cone wider than a hemisphere can not be used for culling
+            // 半球より広いコーンはカリングに使用できない
+            if (0.0f < minDot) {
+                XMStoreFloat3(&bounds.coneAxis, axis);
+                bounds.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+            }
+        }
+    }
+
+    return bounds;
+}
+
+//----------------------------------------------------------------------------------------------------
+// MeshletCuller
+//----------------------------------------------------------------------------------------------------
+// Cull meshlets by frustum and normal cone
+// 視錐台と法線コーンでMeshletをカリング
+UINT MeshletCuller::Cull(const MeshletBounds *bounds, UINT meshletCount, FXMMATRIX worldMtx, const ViewFrustum &frustum, FXMVECTOR cameraPos, UINT *dstVisible, MeshletCullStats *stats) {
+    auto beginTime = std::chrono::high_resolution_clock::now();
+
+    // Largest axis scale of the world matrix
+    // World変換行列の最大軸スケール
+    const float scaleX = XMVectorGetX(XMVector3LengthSq(worldMtx.r[0]));
+    const float scaleY = XMVectorGetX(XMVector3LengthSq(worldMtx.r[1]));
+    const float scaleZ = XMVectorGetX(XMVector3LengthSq(worldMtx.r[2]));
+    const float maxScale = std::sqrt(std::max(scaleX, std::max(scaleY, scaleZ)));
+
+    UINT frustumCulled  = 0;
+    UINT backfaceCulled = 0;
+    UINT visibleCount   = 0;
+
+    for (UINT i = 0; i < meshletCount; ++i) {
+        const auto &meshletBounds = bounds[i];
+
+        XMVECTOR center = XMVector3TransformCoord(XMLoadFloat3(&meshletBounds.center), worldMtx);
+        const float radius = meshletBounds.radius * maxScale;
+
+        if (!frustum.TestSphere(center, radius)) {
+            frustumCulled++;
+            continue;
+        }
+
+        // Whole cluster faces away from the camera
+        // クラスタ全体がカメラに対して裏向き
+        if (meshletBounds.coneCutoff < 1.0f) {
+            XMVECTOR axis = XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&meshletBounds.coneAxis), worldMtx));
+            XMVECTOR view = XMVectorSubtract(center, cameraPos);
+            const float viewDist = XMVectorGetX(XMVector3Length(view));
+
+            if (meshletBounds.coneCutoff * viewDist + radius <= XMVectorGetX(XMVector3Dot(view, axis))) {
+                backfaceCulled++;
+                continue;
+            }
+        }
+
+        dstVisible[visibleCount++] = i;
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    if (stats != nullptr) {
+        stats->testedCount         += meshletCount;
+        stats->frustumCulledCount  += frustumCulled;
+        stats->backfaceCulledCount += backfaceCulled;
+        stats->visibleCount        += visibleCount;
+        stats->timeInMs            += std::chrono::duration<float, std::milli>(endTime - beginTime).count();
+    }
+
+    return visibleCount;
+}
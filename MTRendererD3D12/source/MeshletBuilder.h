@@ -0,0 +1,145 @@
+/// @file MeshletBuilder.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+#include "MeshAsset.h"
+#include "ViewFrustum.h"
+
+// Default value
+const UINT DEFAULT_MESHLET_MAX_VERTICES       = 64;
+const UINT DEFAULT_MESHLET_MAX_PRIMITIVES     = 126;
+const UINT MAX_MESHLET_VERTICES               = 256;
+const UINT MAX_MESHLET_PRIMITIVES             = 256;
+const size_t MAX_MESHLET_SOURCE_INDEX_COUNT   = 0xffffffffu;    // Meshlet offsets are 32-bit
+
+
+/// @~english
+/// @brief Statistics of the meshlet builder
+/// @~japanese
+/// @brief Meshlet構築処理の統計情報
+/// @~
+/// @struct MeshletBuildStats
+struct MeshletBuildStats {
+    UINT    meshletCount;
+    UINT    triangleCount;
+    float   averageVertices;
+    float   averagePrimitives;
+    float   timeInMs;
+
+    /// @brief コンストラクタ
+    MeshletBuildStats()
+    : meshletCount(0)
+    , triangleCount(0)
+    , averageVertices(0.0f)
+    , averagePrimitives(0.0f)
+    , timeInMs(0.0f)
+    {
+        ;
+    }
+};
+
+/// @~english
+/// @brief Statistics of the meshlet culler
+/// @~japanese
+/// @brief Meshletカリング処理の統計情報
+/// @~
+/// @struct MeshletCullStats
+struct MeshletCullStats {
+    UINT    testedCount;
+    UINT    frustumCulledCount;
+    UINT    backfaceCulledCount;
+    UINT    visibleCount;
+    float   timeInMs;
+
+    /// @brief コンストラクタ
+    MeshletCullStats()
+    : testedCount(0)
+    , frustumCulledCount(0)
+    , backfaceCulledCount(0)
+    , visibleCount(0)
+    , timeInMs(0.0f)
+    {
+        ;
+    }
+};
+
+
+/// @class MeshletBuilder
+/// @~english
+/// @brief Split indexed meshes into meshlets and compute their culling data
+/// @~japanese
+/// @brief インデックス付きメッシュをMeshletへ分割しカリング用データを算出
+class MeshletBuilder {
+public:
+    /// @~english
+    /// @brief Build meshlets in index order
+    /// @param[in] meshData Source mesh data (vertex cache optimized order is recommended
+    /// @param[in] maxVertices Maximum number of vertices per meshlet
+    /// @param[in] maxPrimitives Maximum number of primitives per meshlet
+    /// @param[out] dstMeshletData Destination meshlet data
+    /// @param[out] stats Builder statistics (optional
+    /// @return True if build succeeded, false if a limit or the mesh is invalid, the destination is then left empty
+    /// @~japanese
+    /// @brief インデックス順にMeshletを構築
+    /// @param[in] meshData 元となるメッシュデータ（頂点キャッシュ最適化済みの順序を推奨
+    /// @param[in] maxVertices Meshletあたりの最大頂点数
+    /// @param[in] maxPrimitives Meshletあたりの最大プリミティブ数
+    /// @param[out] dstMeshletData 出力先Meshletデータ
+    /// @param[out] stats 構築処理の統計情報（省略可
+    /// @return 構築に成功した場合にはTrue、上限もしくはメッシュが不正な場合はFalseを返し、出力先は空のままとなる
+    static bool Build(const MeshData &meshData, UINT maxVertices, UINT maxPrimitives, MeshletData *dstMeshletData, MeshletBuildStats *stats);
+
+    /// @~english
+    /// @brief Compute the bounding sphere and normal cone of a meshlet
+    /// @param[in] meshData Source mesh data
+    /// @param[in] meshletData Meshlet data
+    /// @param[in] meshlet Target meshlet
+    /// @return Culling data
+    /// @~japanese
+    /// @brief Meshletの境界球と法線コーンを算出
+    /// @param[in] meshData 元となるメッシュデータ
+    /// @param[in] meshletData Meshletデータ
+    /// @param[in] meshlet 対象のMeshlet
+    /// @return カリング用データ
+    static MeshletBounds ComputeBounds(const MeshData &meshData, const MeshletData &meshletData, const Meshlet &meshlet);
+};
+
+
+/// @class MeshletCuller
+/// @~english
+/// @brief CPU reference implementation of per-meshlet visibility
+/// @details Not called by the renderer yet. Its draws are instanced runs submitted with ExecuteIndirect, which
+///          have no per-instance cluster ranges to drop, so cluster culling waits for a mesh shader path that
+///          runs this test per instance on the GPU. Until then this is the reference that path is checked
+///          against, covered by MeshletBuilderTest.
+/// @~japanese
+/// @brief Meshlet単位の可視判定のCPUリファレンス実装
+/// @details レンダラーからはまだ呼ばれない。描画はExecuteIndirectで発行するインスタンス描画であり、
+///          インスタンス毎に除外するクラスタの範囲を持たない為、クラスタカリングはこの判定をGPU上で
+///          インスタンス毎に行うメッシュシェーダーのパスを待つ。それまではそのパスを検証する基準実装であり、
+///          MeshletBuilderTestで検証する
+class MeshletCuller {
+public:
+    /// @~english
+    /// @brief Cull meshlets by frustum and normal cone
+    /// @param[in] bounds Culling data of the meshlets
+    /// @param[in] meshletCount Number of meshlets
+    /// @param[in] worldMtx World matrix of the instance (uniform scale
+    /// @param[in] frustum View frustum in world space
+    /// @param[in] cameraPos Camera position in world space
+    /// @param[out] dstVisible Indices of visible meshlets (meshletCount elements
+    /// @param[out] stats Culling statistics (optional, accumulated
+    /// @return Number of visible meshlets
+    /// @~japanese
+    /// @brief 視錐台と法線コーンでMeshletをカリング
+    /// @param[in] bounds Meshletのカリング用データ
+    /// @param[in] meshletCount Meshlet数
+    /// @param[in] worldMtx インスタンスのWorld変換行列（均一スケール
+    /// @param[in] frustum ワールド空間の視錐台
+    /// @param[in] cameraPos ワールド空間のカメラ位置
+    /// @param[out] dstVisible 可視Meshletのインデックス（meshletCount要素
+    /// @param[out] stats カリング統計情報（省略可、加算される
+    /// @return 可視Meshlet数
+    static UINT Cull(const MeshletBounds *bounds, UINT meshletCount, DirectX::FXMMATRIX worldMtx, const ViewFrustum &frustum, DirectX::FXMVECTOR cameraPos, UINT *dstVisible, MeshletCullStats *stats);
+};
@@ -0,0 +1,423 @@
+/// @file OcclusionCuller.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "OcclusionCuller.h"
+#include "JobSystem.h"
+
+using namespace DirectX;
+
+namespace {
+const UINT FULL_TILE_MASK = ~0u;
+
+// Round up value to a multiple of alignment
+// valueをalignmentの倍数に切り上げ
+UINT AlignUp(UINT value, UINT alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Load the position of an occluder vertex
+// 遮蔽物の頂点位置を読み込み
+XMVECTOR LoadPosition(const BYTE *vertexData, UINT stride, UINT index) {
+    const MeshVertex *vertex = reinterpret_cast<const MeshVertex *>(vertexData + static_cast<size_t>(stride) * index);
+    return XMVectorSet(vertex->pos[0], vertex->pos[1], vertex->pos[2], 1.0f);
+}
+
+// Load an index of an occluder
+// 遮蔽物のインデックスを読み込み
+UINT LoadIndex(const void *indexData, UINT indexStride, UINT i) {
+    if (indexStride == 2) {
+        return static_cast<const UINT16 *>(indexData)[i];
+    }
+    return static_cast<const UINT *>(indexData)[i];
+}
+} // namespace ""
+
+//----------------------------------------------------------------------------------------------------
+// OcclusionCuller
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+OcclusionCuller::OcclusionCuller()
+: width(0)
+, height(0)
+, tileCountX(0)
+, tileCountY(0)
+{
+    XMStoreFloat4x4(&viewProjMtx, XMMatrixIdentity());
+}
+
+// Destructor
+// デストラクタ
+OcclusionCuller::~OcclusionCuller() {
+    Deinit();
+}
+
+// Initialize
+// 初期化
+bool OcclusionCuller::Init(UINT inWidth, UINT inHeight) {
+    if (inWidth == 0 || inHeight == 0) {
+        return false;
+    }
+
+    width      = AlignUp(inWidth, OCCLUSION_TILE_WIDTH);
+    height     = AlignUp(inHeight, OCCLUSION_TILE_HEIGHT);
+    tileCountX = width / OCCLUSION_TILE_WIDTH;
+    tileCountY = height / OCCLUSION_TILE_HEIGHT;
+
+    tiles.resize(static_cast<size_t>(tileCountX) * tileCountY);
+    triangles.reserve(DEFAULT_OCCLUDER_TRIANGLE_CAPACITY);
+
+    // Halve the levels down to a single texel
+    // レベルを1テクセルになるまで半分にする
+    hiZLevels.clear();
+    size_t texelCount = 0;
+    for (UINT levelWidth = tileCountX, levelHeight = tileCountY; ; levelWidth = (levelWidth + 1) / 2, levelHeight = (levelHeight + 1) / 2) {
+        HiZLevel level;
+        level.width  = levelWidth;
+        level.height = levelHeight;
+        level.offset = texelCount;
+        hiZLevels.push_back(level);
+        texelCount += static_cast<size_t>(levelWidth) * levelHeight;
+        if (levelWidth == 1 && levelHeight == 1) {
+            break;
+        }
+    }
+    hiZDepths.resize(texelCount);
+
+    Begin(XMMatrixIdentity());
+    return true;
+}
+
+// Deinitialize
+// 終了処理
+void OcclusionCuller::Deinit() {
+    tiles.clear();
+    tiles.shrink_to_fit();
+    triangles.clear();
+    triangles.shrink_to_fit();
+    hiZLevels.clear();
+    hiZDepths.clear();
+    hiZDepths.shrink_to_fit();
+    width      = 0;
+    height     = 0;
+    tileCountX = 0;
+    tileCountY = 0;
+}
+
+// Start a frame, the occluders of the previous frame are removed
+// フレームを開始、前フレームの遮蔽物は削除される
+void OcclusionCuller::Begin(FXMMATRIX inViewProjMtx) {
+    XMStoreFloat4x4(&viewProjMtx, inViewProjMtx);
+    triangles.clear();
+    stats = OcclusionCullStats();
+
+    for (auto &tile : tiles) {
+        tile.mask  = 0;
+        tile.zMax0 = 1.0f;
+        tile.zMax1 = 0.0f;
+    }
+    std::fill(hiZDepths.begin(), hiZDepths.end(), 1.0f);
+}
+
+// Add the triangles of a mesh as an occluder
+// メッシュの三角形を遮蔽物として追加
+void OcclusionCuller::AddOccluder(const MeshAsset &mesh, FXMMATRIX worldMtx) {
+    const MeshAssetHeader &header = mesh.GetHeader();
+    const BYTE *vertexData = static_cast<const BYTE *>(mesh.GetVertexData());
+    const void *indexData  = mesh.GetIndexData();
+    const UINT indexStride = mesh.GetIndexStride();
+
+    const XMMATRIX worldViewProjMtx = XMMatrixMultiply(worldMtx, XMLoadFloat4x4(&viewProjMtx));
+    const float halfWidth  = 0.5f * static_cast<float>(width);
+    const float halfHeight = 0.5f * static_cast<float>(height);
+
+    stats.occluderCount++;
+
+    for (UINT i = 0; i + 2 < header.indexCount; i += 3) {
+        float x[3];
+        float y[3];
+        float zMax = 0.0f;
+        bool clipped = false;
+
+        for (UINT v = 0; v < 3; ++v) {
+            XMFLOAT4 clipPos;
+            XMStoreFloat4(&clipPos, XMVector4Transform(LoadPosition(vertexData, header.vertexStride, LoadIndex(indexData, indexStride, i + v)), worldViewProjMtx));
+            if (clipPos.w < OCCLUSION_NEAR_CLIP_W) {
+                clipped = true;
+                break;
+            }
+
+            const float invW = 1.0f / clipPos.w;
+            x[v] = (clipPos.x * invW + 1.0f) * halfWidth;
+            y[v] = (1.0f - clipPos.y * invW) * halfHeight;
+            zMax = std::max(zMax, clipPos.z * invW);
+        }
+        if (clipped || 1.0f < zMax) {
+            continue;
+        }
+
+        // Orient counterclockwise in buffer space so the inside is where all edge functions are positive
+        // 全エッジ関数が正となる側が内側となるようバッファ空間で向きを揃える
+        const float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+        if (area == 0.0f) {
+            continue;
+        }
+        if (area < 0.0f) {
+            std::swap(x[1], x[2]);
+            std::swap(y[1], y[2]);
+        }
+
+        // Bounding box in tiles, clamped to the buffer
+        // タイル単位の境界ボックス、バッファ内に制限
+        const float minX = std::max(std::min({ x[0], x[1], x[2] }), 0.0f);
+        const float minY = std::max(std::min({ y[0], y[1], y[2] }), 0.0f);
+        const float maxX = std::min(std::max({ x[0], x[1], x[2] }), static_cast<float>(width) - 1.0f);
+        const float maxY = std::min(std::max({ y[0], y[1], y[2] }), static_cast<float>(height) - 1.0f);
+        if (maxX < minX || maxY < minY) {
+            continue;
+        }
+
+        ScreenTriangle triangle;
+        for (UINT e = 0; e < 3; ++e) {
+            const UINT n = (e + 1) % 3;
+            triangle.edgeA[e] = y[e] - y[n];
+            triangle.edgeB[e] = x[n] - x[e];
+            triangle.edgeC[e] = -(triangle.edgeA[e] * x[e] + triangle.edgeB[e] * y[e]);
+        }
+        triangle.zMax     = std::max(zMax, 0.0f);
+        triangle.tileMinX = static_cast<UINT>(minX) / OCCLUSION_TILE_WIDTH;
+        triangle.tileMinY = static_cast<UINT>(minY) / OCCLUSION_TILE_HEIGHT;
+        triangle.tileMaxX = static_cast<UINT>(maxX) / OCCLUSION_TILE_WIDTH;
+        triangle.tileMaxY = static_cast<UINT>(maxY) / OCCLUSION_TILE_HEIGHT;
+        triangles.push_back(triangle);
+    }
+
+    stats.triangleCount = static_cast<UINT>(triangles.size());
+}
+
+// Rasterize the occluders added since Begin()
+// Begin()以降に追加した遮蔽物をラスタライズ
+void OcclusionCuller::Rasterize(JobSystem *jobSystem) {
+    auto beginTime = std::chrono::high_resolution_clock::now();
+
+    // Tile rows are independent, each one is written by a single task
+    // タイル行は独立しており、各行は1つのタスクのみが書き込む
+    const auto func = [this](UINT begin, UINT end) {
+        for (UINT tileY = begin; tileY < end; ++tileY) {
+            RasterizeTileRow(tileY);
+        }
+    };
+    if (jobSystem != nullptr && !triangles.empty()) {
+        jobSystem->ParallelFor(tileCountY, 1, func);
+    } else {
+        func(0, tileCountY);
+    }
+    BuildHiZ();
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    stats.rasterizeTimeInMs = std::chrono::duration<float, std::milli>(endTime - beginTime).count();
+}
+
+// Rasterize the triangles overlapping a tile row
+// タイル行に重なる三角形をラスタライズ
+void OcclusionCuller::RasterizeTileRow(UINT tileY) {
+    Tile *tileRow = &tiles[static_cast<size_t>(tileY) * tileCountX];
+
+    // Pixel centers of the left and right halves of a tile row
+    // タイル行の左半分と右半分のピクセル中心
+    const __m128 offsetLo = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 offsetHi = _mm_setr_ps(4.5f, 5.5f, 6.5f, 7.5f);
+    const __m128 zero     = _mm_setzero_ps();
+
+    for (const auto &triangle : triangles) {
+        if (tileY < triangle.tileMinY || triangle.tileMaxY < tileY) {
+            continue;
+        }
+
+        const __m128 edgeA[3] = { _mm_set1_ps(triangle.edgeA[0]), _mm_set1_ps(triangle.edgeA[1]), _mm_set1_ps(triangle.edgeA[2]) };
+
+        for (UINT tileX = triangle.tileMinX; tileX <= triangle.tileMaxX; ++tileX) {
+            const float pixelX = static_cast<float>(tileX * OCCLUSION_TILE_WIDTH);
+            const __m128 xLo = _mm_add_ps(_mm_set1_ps(pixelX), offsetLo);
+            const __m128 xHi = _mm_add_ps(_mm_set1_ps(pixelX), offsetHi);
+
+            UINT coverage = 0;
+            for (UINT row = 0; row < OCCLUSION_TILE_HEIGHT; ++row) {
+                const float pixelY = static_cast<float>(tileY * OCCLUSION_TILE_HEIGHT + row) + 0.5f;
+
+                __m128 insideLo = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                __m128 insideHi = insideLo;
+                for (UINT e = 0; e < 3; ++e) {
+                    // A * x + (B * y + C) for 8 pixels
+                    // 8ピクセル分のA * x + (B * y + C)
+                    const __m128 rowValue = _mm_set1_ps(triangle.edgeB[e] * pixelY + triangle.edgeC[e]);
+                    insideLo = _mm_and_ps(insideLo, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[e], xLo), rowValue), zero));
+                    insideHi = _mm_and_ps(insideHi, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[e], xHi), rowValue), zero));
+                }
+
+                const UINT rowMask = static_cast<UINT>(_mm_movemask_ps(insideLo)) | (static_cast<UINT>(_mm_movemask_ps(insideHi)) << 4);
+                coverage |= rowMask << (row * OCCLUSION_TILE_WIDTH);
+            }
+
+            if (coverage != 0) {
+                UpdateTile(&tileRow[tileX], coverage, triangle.zMax);
+            }
+        }
+    }
+}
+
+// Build the hierarchical depth buffer from the far depths of the tiles
+// タイルの奥側深度から階層深度バッファを構築
+void OcclusionCuller::BuildHiZ() {
+    if (hiZLevels.empty()) {
+        return;
+    }
+
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        hiZDepths[i] = tiles[i].zMax0;
+    }
+
+    // A texel past the edge of the level below repeats the last one
+    // 下のレベルの端を越えるテクセルは最後のものを繰り返す
+    for (size_t l = 1; l < hiZLevels.size(); ++l) {
+        const HiZLevel &src = hiZLevels[l - 1];
+        const HiZLevel &dst = hiZLevels[l];
+        const float *srcDepths = &hiZDepths[src.offset];
+        float *dstDepths = &hiZDepths[dst.offset];
+        for (UINT y = 0; y < dst.height; ++y) {
+            const UINT y0 = y * 2;
+            const UINT y1 = std::min(y0 + 1, src.height - 1);
+            for (UINT x = 0; x < dst.width; ++x) {
+                const UINT x0 = x * 2;
+                const UINT x1 = std::min(x0 + 1, src.width - 1);
+                dstDepths[static_cast<size_t>(y) * dst.width + x] = std::max(
+                    std::max(srcDepths[static_cast<size_t>(y0) * src.width + x0], srcDepths[static_cast<size_t>(y0) * src.width + x1]),
+                    std::max(srcDepths[static_cast<size_t>(y1) * src.width + x0], srcDepths[static_cast<size_t>(y1) * src.width + x1]));
+            }
+        }
+    }
+}
+
+// Merge the coverage of a triangle into a tile
+// 三角形のカバレッジをタイルへ統合
+void OcclusionCuller::UpdateTile(Tile *tile, UINT coverage, float zTriangle) {
+    // Start a new working layer when the triangle is far from it compared to the distance to the reference layer
+    // 参照レイヤまでの距離に比べ三角形が作業レイヤから離れている場合は作業レイヤを作り直す
+    const float distToTriangle = tile->zMax1 - zTriangle;
+    const float distToLayer0   = tile->zMax0 - tile->zMax1;
+    if (distToLayer0 < distToTriangle) {
+        tile->mask  = 0;
+        tile->zMax1 = 0.0f;
+    }
+
+    tile->zMax1 = std::max(tile->zMax1, zTriangle);
+    tile->mask |= coverage;
+
+    // A fully covered working layer becomes the reference layer
+    // 完全に覆われた作業レイヤは参照レイヤとなる
+    if (tile->mask == FULL_TILE_MASK) {
+        tile->zMax0 = std::min(tile->zMax0, tile->zMax1);
+        tile->mask  = 0;
+        tile->zMax1 = 0.0f;
+    }
+}
+
+// Test if a sphere may be visible
+// 球が可視の可能性があるか調べる
+bool OcclusionCuller::TestSphere(FXMVECTOR center, float radius) const {
+    if (tiles.empty()) {
+        return true;
+    }
+
+    // Project the corners of the box around the sphere
+    // 球を囲むボックスの頂点を射影
+    const XMMATRIX mtx = XMLoadFloat4x4(&viewProjMtx);
+    const XMVECTOR extents = XMVectorReplicate(radius);
+    const XMVECTOR boxMin  = XMVectorSetW(XMVectorSubtract(center, extents), 1.0f);
+    const XMVECTOR boxMax  = XMVectorSetW(XMVectorAdd(center, extents), 1.0f);
+
+    float minX = FLT_MAX;
+    float minY = FLT_MAX;
+    float maxX = -FLT_MAX;
+    float maxY = -FLT_MAX;
+    float zMin = FLT_MAX;
+    UINT behindCount = 0;
+    for (UINT corner = 0; corner < 8; ++corner) {
+        const XMVECTOR select = XMVectorSelectControl(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1, 0);
+        XMFLOAT4 clipPos;
+        XMStoreFloat4(&clipPos, XMVector4Transform(XMVectorSelect(boxMin, boxMax, select), mtx));
+
+        if (clipPos.w < OCCLUSION_NEAR_CLIP_W) {
+            behindCount++;
+            continue;
+        }
+
+        const float invW = 1.0f / clipPos.w;
+        const float x = (clipPos.x * invW + 1.0f) * 0.5f * static_cast<float>(width);
+        const float y = (1.0f - clipPos.y * invW) * 0.5f * static_cast<float>(height);
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+        zMin = std::min(zMin, clipPos.z * invW);
+    }
+
+    // Entirely behind the camera, or crossing the near plane which is treated as visible
+    // 全体がカメラの後方、もしくはニア平面と交差する場合は可視として扱う
+    if (behindCount != 0) {
+        return behindCount != 8;
+    }
+
+    // Outside the screen or beyond the far plane
+    // 画面外もしくはファー平面より奥
+    if (maxX < 0.0f || maxY < 0.0f || static_cast<float>(width) <= minX || static_cast<float>(height) <= minY || 1.0f < zMin) {
+        return false;
+    }
+
+    const UINT tileMinX = static_cast<UINT>(std::max(minX, 0.0f)) / OCCLUSION_TILE_WIDTH;
+    const UINT tileMinY = static_cast<UINT>(std::max(minY, 0.0f)) / OCCLUSION_TILE_HEIGHT;
+    const UINT tileMaxX = std::min(static_cast<UINT>(maxX) / OCCLUSION_TILE_WIDTH, tileCountX - 1);
+    const UINT tileMaxY = std::min(static_cast<UINT>(maxY) / OCCLUSION_TILE_HEIGHT, tileCountY - 1);
+
+    // Hidden if the nearest point is behind the farthest depth of the at most 2x2 texels of the first level covering the
+    // rectangle, the tiles are only visited when that level is too coarse to tell
+    // 矩形を覆う最初のレベルの最大2x2テクセルの最も奥の深度より最も手前の点が奥にあれば隠れている、そのレベルが
+    // 粗く判断できない場合のみタイルを調べる
+    UINT level     = 0;
+    UINT texelMinX = tileMinX;
+    UINT texelMinY = tileMinY;
+    UINT texelMaxX = tileMaxX;
+    UINT texelMaxY = tileMaxY;
+    while (level + 1 < hiZLevels.size() && (1 < texelMaxX - texelMinX || 1 < texelMaxY - texelMinY)) {
+        texelMinX >>= 1;
+        texelMinY >>= 1;
+        texelMaxX >>= 1;
+        texelMaxY >>= 1;
+        level++;
+    }
+    float zFar = 0.0f;
+    for (UINT y = texelMinY; y <= texelMaxY; ++y) {
+        for (UINT x = texelMinX; x <= texelMaxX; ++x) {
+            zFar = std::max(zFar, GetHiZDepth(level, x, y));
+        }
+    }
+    if (zFar < zMin) {
+        return false;
+    }
+    if (level == 0) {
+        return true;
+    }
+
+    // Visible if the nearest point is in front of the occluders of any tile
+    // いずれかのタイルで最も手前の点が遮蔽物より手前であれば可視
+    for (UINT tileY = tileMinY; tileY <= tileMaxY; ++tileY) {
+        const Tile *tileRow = &tiles[static_cast<size_t>(tileY) * tileCountX];
+        for (UINT tileX = tileMinX; tileX <= tileMaxX; ++tileX) {
+            if (zMin <= tileRow[tileX].zMax0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,265 @@
+/// @file OcclusionCuller.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+#include "MeshAsset.h"
+
+class JobSystem;
+
+// Default value
+const UINT DEFAULT_OCCLUSION_BUFFER_WIDTH       = 256;
+const UINT DEFAULT_OCCLUSION_BUFFER_HEIGHT      = 144;
+const UINT DEFAULT_OCCLUDER_TRIANGLE_CAPACITY   = 4096;
+const UINT OCCLUSION_TILE_WIDTH                 = 8;
+const UINT OCCLUSION_TILE_HEIGHT                = 4;
+const float OCCLUSION_NEAR_CLIP_W               = 1.0e-4f;
+
+
+/// @~english
+/// @brief Statistics of the occlusion culler
+/// @~japanese
+/// @brief オクルージョンカリング処理の統計情報
+/// @~
+/// @struct OcclusionCullStats
+struct OcclusionCullStats {
+    UINT    occluderCount;
+    UINT    triangleCount;      ///< @~english Occluder triangles in front of the near plane @~japanese ニア平面より手前にある遮蔽物の三角形
+    UINT    testedCount;
+    UINT    culledCount;
+    float   rasterizeTimeInMs;
+
+    /// @brief コンストラクタ
+    OcclusionCullStats()
+    : occluderCount(0)
+    , triangleCount(0)
+    , testedCount(0)
+    , culledCount(0)
+    , rasterizeTimeInMs(0.0f)
+    {
+        ;
+    }
+};
+
+
+/// @class OcclusionCuller
+/// @~english
+/// @brief CPU occlusion culling with a low resolution masked depth buffer
+/// @details The buffer is split into 8x4 pixel tiles. Each tile stores a conservative far depth of the
+///          occluders covering all of it and a working layer made of a 32-bit coverage mask and its
+///          farthest depth. Occluder triangles are rasterized per tile with SSE, four pixels per edge
+///          test, and merged into the layers (masked occlusion culling). Bands of tile rows are
+///          rasterized in parallel. The far depths of the tiles then form a hierarchical depth buffer,
+///          each level holding the farthest depth of 2x2 texels of the level below, so a sphere covering
+///          many tiles is rejected from a few texels of a coarse level. Depth is post-projection z/w,
+///          larger is farther.
+/// @~japanese
+/// @brief 低解像度のマスク付き深度バッファによるCPUオクルージョンカリング
+/// @details バッファは8x4ピクセルのタイルに分割する。各タイルはタイル全体を覆う遮蔽物の保守的な
+///          奥側深度と、32bitのカバレッジマスクとその最も奥の深度からなる作業レイヤを持つ。遮蔽物の
+///          三角形はタイル毎にSSEで1回のエッジ判定につき4ピクセルずつラスタライズし、レイヤへ統合する
+///          （Masked Occlusion Culling）。タイル行の帯毎に並列にラスタライズする。その後タイルの奥側深度
+///          から階層深度バッファを作り、各レベルは下のレベルの2x2テクセルの最も奥の深度を持つ為、多くの
+///          タイルを覆う球は粗いレベルの少数のテクセルで棄却できる。深度は射影後のz/wで、大きいほど奥
+class OcclusionCuller {
+public:
+    /// @~english
+    /// @brief Initialize
+    /// @param[in] width  Buffer width, rounded up to a multiple of the tile width
+    /// @param[in] height Buffer height, rounded up to a multiple of the tile height
+    /// @return True if initialization succeeded, false otherwise
+    /// @~japanese
+    /// @brief 初期化
+    /// @param[in] width  バッファ幅、タイル幅の倍数に切り上げる
+    /// @param[in] height バッファ高さ、タイル高さの倍数に切り上げる
+    /// @return 初期化に成功した場合にはTrue、そうでないならFalseを返す
+    bool Init(UINT width, UINT height);
+
+    /// @~english
+    /// @brief Deinitialize
+    /// @~japanese
+    /// @brief 終了処理
+    void Deinit();
+
+    /// @~english
+    /// @brief Start a frame, the occluders of the previous frame are removed
+    /// @param[in] viewProjMtx View-projection matrix (not transposed
+    /// @~japanese
+    /// @brief フレームを開始、前フレームの遮蔽物は削除される
+    /// @param[in] viewProjMtx View-Projection行列（転置前
+    void Begin(DirectX::FXMMATRIX viewProjMtx);
+
+    /// @~english
+    /// @brief Add the triangles of a mesh as an occluder
+    /// @details Triangles crossing the near plane are dropped, which only makes the result more conservative.
+    /// @param[in] mesh Occluder mesh
+    /// @param[in] worldMtx World transformation matrix
+    /// @~japanese
+    /// @brief メッシュの三角形を遮蔽物として追加
+    /// @details ニア平面と交差する三角形は除外するが、結果がより保守的になるだけである
+    /// @param[in] mesh 遮蔽物のメッシュ
+    /// @param[in] worldMtx World変換行列
+    void AddOccluder(const MeshAsset &mesh, DirectX::FXMMATRIX worldMtx);
+
+    /// @~english
+    /// @brief Rasterize the occluders added since Begin()
+    /// @param[in] jobSystem Job system to distribute the tile rows to (nullptr to run on the calling thread
+    /// @~japanese
+    /// @brief Begin()以降に追加した遮蔽物をラスタライズ
+    /// @param[in] jobSystem タイル行を分散するJobSystem（nullptrの場合は呼び出し元スレッドで実行
+    void Rasterize(JobSystem *jobSystem);
+
+    /// @~english
+    /// @brief Test if a sphere may be visible, thread safe after Rasterize()
+    /// @param[in] center Sphere center in world space
+    /// @param[in] radius Sphere radius
+    /// @return False if the sphere is hidden by the occluders or outside the screen, true otherwise
+    /// @~japanese
+    /// @brief 球が可視の可能性があるか調べる、Rasterize()の後はスレッドセーフ
+    /// @param[in] center ワールド空間の球の中心
+    /// @param[in] radius 球の半径
+    /// @return 遮蔽物に隠れているか画面外の場合はFalse、そうでないならTrueを返す
+    bool TestSphere(DirectX::FXMVECTOR center, float radius) const;
+
+    /// @~english
+    /// @brief Get the conservative far depth of the occluders covering a tile
+    /// @~japanese
+    /// @brief タイルを覆う遮蔽物の保守的な奥側深度を取得
+    float GetTileDepth(UINT tileX, UINT tileY) const {
+        return tiles[tileY * tileCountX + tileX].zMax0;
+    }
+
+    /// @~english
+    /// @brief Get the number of levels of the hierarchical depth buffer, level 0 holds a texel per tile
+    /// @~japanese
+    /// @brief 階層深度バッファのレベル数を取得、レベル0はタイル毎に1テクセルを持つ
+    UINT GetHiZLevelCount() const {
+        return static_cast<UINT>(hiZLevels.size());
+    }
+
+    /// @~english
+    /// @brief Get the farthest depth of the tiles under a texel of the hierarchical depth buffer
+    /// @~japanese
+    /// @brief 階層深度バッファのテクセル下のタイルの最も奥の深度を取得
+    float GetHiZDepth(UINT level, UINT x, UINT y) const {
+        const HiZLevel &hiZLevel = hiZLevels[level];
+        return hiZDepths[hiZLevel.offset + static_cast<size_t>(y) * hiZLevel.width + x];
+    }
+
+    /// @~english
+    /// @brief Get the number of tiles in X
+    /// @~japanese
+    /// @brief X方向のタイル数を取得
+    UINT GetTileCountX() const {
+        return tileCountX;
+    }
+
+    /// @~english
+    /// @brief Get the number of tiles in Y
+    /// @~japanese
+    /// @brief Y方向のタイル数を取得
+    UINT GetTileCountY() const {
+        return tileCountY;
+    }
+
+    /// @~english
+    /// @brief Get the statistics, the test counts are filled by the caller of TestSphere()
+    /// @~japanese
+    /// @brief 統計情報を取得、テスト数はTestSphere()の呼び出し元が設定する
+    const OcclusionCullStats& GetStats() const {
+        return stats;
+    }
+
+    /// @~english
+    /// @brief Set the results of the sphere tests
+    /// @~japanese
+    /// @brief 球のテスト結果をセット
+    void SetTestResult(UINT testedCount, UINT culledCount) {
+        stats.testedCount = testedCount;
+        stats.culledCount = culledCount;
+    }
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    OcclusionCuller();
+
+    /// @~english
+    /// @brief Destructor
+    /// @~japanese
+    /// @brief デストラクタ
+    ~OcclusionCuller();
+
+private:
+    /// @~english
+    /// @brief Depth layers of a tile
+    /// @~japanese
+    /// @brief タイルの深度レイヤ
+    /// @~
+    /// @struct Tile
+    struct Tile {
+        UINT    mask;   ///< @~english Coverage of the working layer, bit = y * 8 + x @~japanese 作業レイヤのカバレッジ、ビット = y * 8 + x
+        float   zMax0;  ///< @~english Far depth of the occluders covering the whole tile @~japanese タイル全体を覆う遮蔽物の奥側深度
+        float   zMax1;  ///< @~english Far depth of the working layer @~japanese 作業レイヤの奥側深度
+    };
+
+    /// @~english
+    /// @brief Occluder triangle in buffer space
+    /// @~japanese
+    /// @brief バッファ空間の遮蔽物の三角形
+    /// @~
+    /// @struct ScreenTriangle
+    struct ScreenTriangle {
+        float   edgeA[3];   ///< @~english Edge functions, inside when A * x + B * y + C >= 0 @~japanese エッジ関数、A * x + B * y + C >= 0の場合に内側
+        float   edgeB[3];
+        float   edgeC[3];
+        float   zMax;
+        UINT    tileMinX;
+        UINT    tileMinY;
+        UINT    tileMaxX;   ///< @~english Inclusive @~japanese 末尾を含む
+        UINT    tileMaxY;   ///< @~english Inclusive @~japanese 末尾を含む
+    };
+
+    /// @~english
+    /// @brief Level of the hierarchical depth buffer
+    /// @~japanese
+    /// @brief 階層深度バッファのレベル
+    /// @~
+    /// @struct HiZLevel
+    struct HiZLevel {
+        UINT    width;
+        UINT    height;
+        size_t  offset;     ///< @~english First texel in hiZDepths @~japanese hiZDepths内の先頭テクセル
+    };
+
+    /// @~english
+    /// @brief Rasterize the triangles overlapping a tile row
+    /// @~japanese
+    /// @brief タイル行に重なる三角形をラスタライズ
+    void RasterizeTileRow(UINT tileY);
+
+    /// @~english
+    /// @brief Build the hierarchical depth buffer from the far depths of the tiles
+    /// @~japanese
+    /// @brief タイルの奥側深度から階層深度バッファを構築
+    void BuildHiZ();
+
+    /// @~english
+    /// @brief Merge the coverage of a triangle into a tile
+    /// @~japanese
+    /// @brief 三角形のカバレッジをタイルへ統合
+    static void UpdateTile(Tile *tile, UINT coverage, float zTriangle);
+
+private:
+    UINT                        width;
+    UINT                        height;
+    UINT                        tileCountX;
+    UINT                        tileCountY;
+    std::vector<Tile>           tiles;
+    std::vector<ScreenTriangle> triangles;
+    std::vector<HiZLevel>       hiZLevels;
+    std::vector<float>          hiZDepths;  ///< @~english Every level, finest first @~japanese 全レベル、細かい順
+    DirectX::XMFLOAT4X4         viewProjMtx;
+    OcclusionCullStats          stats;
+};
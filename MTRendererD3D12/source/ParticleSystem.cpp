@@ -0,0 +1,387 @@
+/// @file ParticleSystem.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "ParticleSystem.h"
+#include "JobSystem.h"
+
+using namespace DirectX;
+
+namespace {
+// Number of set bits of a 4-bit lane mask
+// 4bitのレーンマスクのセットされたビット数
+const UINT LANE_COUNTS[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+// Integer hash used as a stateless random number generator
+// 状態を持たない乱数生成に使用する整数ハッシュ
+UINT HashUint(UINT x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+// Next random number in [0, 1) of a hash chain
+// ハッシュ連鎖の次の[0, 1)の乱数
+float NextRandom(UINT *state) {
+    *state = HashUint(*state);
+    return static_cast<float>(*state >> 8) * (1.0f / 16777216.0f);
+}
+
+// Pack a color to R8G8B8A8_UNORM
+// 色をR8G8B8A8_UNORMへパック
+UINT PackColor(const XMFLOAT4 &color) {
+    auto toByte = [](float value) {
+        return static_cast<UINT>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    };
+    return toByte(color.x) | (toByte(color.y) << 8) | (toByte(color.z) << 16) | (toByte(color.w) << 24);
+}
+} // namespace ""
+
+//----------------------------------------------------------------------------------------------------
+// ParticleSystem
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+ParticleSystem::ParticleSystem()
+: maxParticleCount(0)
+, reservedCount(0)
+, frameIndex(0)
+{
+    ;
+}
+
+// Initialize
+// 初期化
+bool ParticleSystem::Init(UINT inMaxParticleCount) {
+    if (!emitters.empty()) {
+        return false;
+    }
+
+    maxParticleCount = inMaxParticleCount;
+    return true;
+}
+
+// Create an emitter
+// エミッタを生成
+UINT ParticleSystem::CreateEmitter(const ParticleEmitterDesc &desc) {
+    const UINT capacity = (desc.capacity + 3) & ~3u;
+    if (capacity == 0 || maxParticleCount - reservedCount < capacity || desc.maxLifetime <= 0.0f) {
+        return INVALID_PARTICLE_EMITTER;
+    }
+
+    Emitter emitter;
+    emitter.desc            = desc;
+    emitter.capacity        = capacity;
+    emitter.poolIndex       = 0;
+    emitter.aliveCount      = 0;
+    emitter.emitAccumulator = 0.0f;
+    emitter.emitSeed        = HashUint(static_cast<UINT>(emitters.size()) + 1);
+    emitter.survivorCount   = 0;
+    emitter.emitCount       = 0;
+    emitter.instanceOffset  = 0;
+    for (auto &pool : emitter.pools) {
+        pool.resize(static_cast<size_t>(capacity) * PARTICLE_STREAM_COUNT);
+    }
+    emitters.push_back(std::move(emitter));
+    reservedCount += capacity;
+
+    // Size everything an update writes now, so updates do not use the heap
+    // 更新処理で書き込むもの全てを今確保し、更新処理がヒープを使用しないようにする
+    UINT taskCapacity = 0;
+    for (const auto &e : emitters) {
+        taskCapacity += (e.capacity + DEFAULT_PARTICLE_BATCH_SIZE - 1) / DEFAULT_PARTICLE_BATCH_SIZE;
+    }
+    simulateTasks.reserve(taskCapacity);
+    emitTasks.reserve(taskCapacity);
+    for (UINT i = 0; i < 2; ++i) {
+        instanceStreams[i].resize(reservedCount);
+        drawLists[i].reserve(emitters.size());
+    }
+
+    return static_cast<UINT>(emitters.size() - 1);
+}
+
+// Move an emitter
+// エミッタを移動
+void ParticleSystem::SetEmitterPosition(UINT emitter, const XMFLOAT3 &position) {
+    if (emitter < emitters.size()) {
+        emitters[emitter].desc.position = position;
+    }
+}
+
+// Set the number of particles an emitter emits per second
+// エミッタが1秒あたりに放出するパーティクル数をセット
+void ParticleSystem::SetEmitRate(UINT emitter, float emitRate) {
+    if (emitter < emitters.size()) {
+        emitters[emitter].desc.emitRate = std::max(emitRate, 0.0f);
+    }
+}
+
+// Simulate the particles and write the instance stream
+// パーティクルをシミュレーションしインスタンスストリームを書き込む
+void ParticleSystem::Update(float delta, JobSystem *jobSystem) {
+    auto beginTime = std::chrono::high_resolution_clock::now();
+
+    // Split the live particles into batches
+    // 生存するパーティクルをバッチに分割
+    simulateTasks.clear();
+    emitTasks.clear();
+    for (UINT e = 0; e < emitters.size(); ++e) {
+        for (UINT first = 0; first < emitters[e].aliveCount; first += DEFAULT_PARTICLE_BATCH_SIZE) {
+            simulateTasks.push_back({ e, first, std::min(emitters[e].aliveCount - first, DEFAULT_PARTICLE_BATCH_SIZE), 0, 0 });
+        }
+    }
+
+    auto runTasks = [jobSystem](UINT taskCount, const auto &func) {
+        if (jobSystem != nullptr && 1 < taskCount) {
+            jobSystem->ParallelFor(taskCount, 1, func);
+        } else {
+            func(0, taskCount);
+        }
+    };
+
+    const UINT simulateTaskCount = static_cast<UINT>(simulateTasks.size());
+    runTasks(simulateTaskCount, [this, delta](UINT begin, UINT end) {
+        for (UINT t = begin; t < end; ++t) {
+            CountSurvivors(&simulateTasks[t], delta);
+        }
+    });
+
+    // The survivors of each batch follow those of the earlier batches of the emitter, the new particles follow them
+    // 各バッチの生存したパーティクルはエミッタの前のバッチのものに続き、新しいパーティクルはその後に続く
+    for (auto &emitter : emitters) {
+        emitter.survivorCount = 0;
+    }
+    for (auto &task : simulateTasks) {
+        Emitter &emitter = emitters[task.emitter];
+        task.dstOffset = emitter.survivorCount;
+        emitter.survivorCount += task.survivorCount;
+    }
+
+    frameIndex ^= 1;
+    ParticleInstance *instances = instanceStreams[frameIndex].data();
+    auto &draws = drawLists[frameIndex];
+    draws.clear();
+
+    UINT instanceCount = 0;
+    ParticleStats newStats;
+    for (UINT e = 0; e < emitters.size(); ++e) {
+        Emitter &emitter = emitters[e];
+
+        // Emission beyond the capacity is dropped rather than deferred
+        // 容量を超える放出は遅延させずに破棄する
+        emitter.emitAccumulator += emitter.desc.emitRate * delta;
+        const float requested = std::floor(emitter.emitAccumulator);
+        emitter.emitAccumulator -= requested;
+        emitter.emitCount = std::min(static_cast<UINT>(requested), emitter.capacity - emitter.survivorCount);
+
+        for (UINT first = 0; first < emitter.emitCount; first += DEFAULT_PARTICLE_BATCH_SIZE) {
+            emitTasks.push_back({ e, first, std::min(emitter.emitCount - first, DEFAULT_PARTICLE_BATCH_SIZE), emitter.survivorCount + first, 0 });
+        }
+
+        emitter.instanceOffset = instanceCount;
+        const UINT emitterInstanceCount = emitter.survivorCount + emitter.emitCount;
+        if (0 < emitterInstanceCount) {
+            draws.push_back({ e, instanceCount, emitterInstanceCount });
+        }
+        instanceCount += emitterInstanceCount;
+
+        newStats.emittedCount += emitter.emitCount;
+        newStats.killedCount  += emitter.aliveCount - emitter.survivorCount;
+    }
+
+    // Integrate and pack the survivors, and emit, all batches are independent
+    // 生存したものの積分と詰め込み、放出を行う、全てのバッチは独立している
+    const UINT emitTaskCount = static_cast<UINT>(emitTasks.size());
+    runTasks(simulateTaskCount + emitTaskCount, [this, delta, simulateTaskCount, instances](UINT begin, UINT end) {
+        for (UINT t = begin; t < end; ++t) {
+            if (t < simulateTaskCount) {
+                Simulate(simulateTasks[t], delta, instances);
+            } else {
+                Emit(emitTasks[t - simulateTaskCount], instances);
+            }
+        }
+    });
+
+    for (auto &emitter : emitters) {
+        emitter.poolIndex ^= 1;
+        emitter.aliveCount = emitter.survivorCount + emitter.emitCount;
+        emitter.emitSeed   = HashUint(emitter.emitSeed);
+    }
+
+    frame.instances     = instances;
+    frame.instanceCount = instanceCount;
+    frame.draws         = draws.data();
+    frame.drawCount     = static_cast<UINT>(draws.size());
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    newStats.emitterCount = static_cast<UINT>(emitters.size());
+    newStats.aliveCount   = instanceCount;
+    newStats.taskCount    = simulateTaskCount + emitTaskCount;
+    newStats.timeInMs     = std::chrono::duration<float, std::milli>(endTime - beginTime).count();
+    stats = newStats;
+}
+
+// Count the particles of a batch that survive this update
+// バッチのパーティクルのうち今回の更新で生存する数を数える
+void ParticleSystem::CountSurvivors(Task *task, float delta) {
+    Emitter &emitter = emitters[task->emitter];
+    const float *ages      = emitter.GetStream(emitter.poolIndex, Age) + task->first;
+    const float *lifetimes = emitter.GetStream(emitter.poolIndex, Lifetime) + task->first;
+    const __m128 dt = _mm_set1_ps(delta);
+
+    // Same arithmetic as Simulate, so both agree on every particle
+    // Simulateと同じ演算の為、全パーティクルで両者の判定は一致する
+    UINT survivorCount = 0;
+    for (UINT i = 0; i < task->count; i += 4) {
+        const UINT laneMask = (task->count - i < 4) ? (1u << (task->count - i)) - 1 : 0xfu;
+        const __m128 age = _mm_add_ps(_mm_loadu_ps(ages + i), dt);
+        const UINT alive = static_cast<UINT>(_mm_movemask_ps(_mm_cmplt_ps(age, _mm_loadu_ps(lifetimes + i)))) & laneMask;
+        survivorCount += LANE_COUNTS[alive];
+    }
+    task->survivorCount = survivorCount;
+}
+
+// Integrate the particles of a batch and write the survivors packed
+// バッチのパーティクルを積分し生存したものを詰めて書き込む
+void ParticleSystem::Simulate(const Task &task, float delta, ParticleInstance *dstInstances) {
+    Emitter &emitter = emitters[task.emitter];
+    const ParticleEmitterDesc &desc = emitter.desc;
+
+    const float *srcStreams[PARTICLE_STREAM_COUNT];
+    float *dstStreams[PARTICLE_STREAM_COUNT];
+    for (UINT s = 0; s < PARTICLE_STREAM_COUNT; ++s) {
+        srcStreams[s] = emitter.GetStream(emitter.poolIndex, s) + task.first;
+        dstStreams[s] = emitter.GetStream(emitter.poolIndex ^ 1, s) + task.dstOffset;
+    }
+    ParticleInstance *instances = dstInstances + emitter.instanceOffset + task.dstOffset;
+
+    const __m128 dt         = _mm_set1_ps(delta);
+    const __m128 damping    = _mm_set1_ps(std::max(1.0f - desc.drag * delta, 0.0f));
+    const __m128 dvx        = _mm_set1_ps(desc.acceleration.x * delta);
+    const __m128 dvy        = _mm_set1_ps(desc.acceleration.y * delta);
+    const __m128 dvz        = _mm_set1_ps(desc.acceleration.z * delta);
+    const __m128 one        = _mm_set1_ps(1.0f);
+    const __m128 sizeStart  = _mm_set1_ps(desc.startSize);
+    const __m128 sizeDelta  = _mm_set1_ps(desc.endSize - desc.startSize);
+
+    // Colors are interpolated in [0, 255] per channel
+    // 色はチャンネル毎に[0, 255]で補間する
+    const float startColor[4] = { desc.startColor.x, desc.startColor.y, desc.startColor.z, desc.startColor.w };
+    const float endColor[4]   = { desc.endColor.x, desc.endColor.y, desc.endColor.z, desc.endColor.w };
+    __m128 colorStart[4], colorDelta[4];
+    for (UINT c = 0; c < 4; ++c) {
+        const float start = std::clamp(startColor[c], 0.0f, 1.0f) * 255.0f;
+        const float end   = std::clamp(endColor[c], 0.0f, 1.0f) * 255.0f;
+        colorStart[c] = _mm_set1_ps(start);
+        colorDelta[c] = _mm_set1_ps(end - start);
+    }
+
+    UINT written = 0;
+    for (UINT i = 0; i < task.count; i += 4) {
+        const UINT laneMask = (task.count - i < 4) ? (1u << (task.count - i)) - 1 : 0xfu;
+
+        __m128 values[PARTICLE_STREAM_COUNT];
+        values[Age]      = _mm_add_ps(_mm_loadu_ps(srcStreams[Age] + i), dt);
+        values[Lifetime] = _mm_loadu_ps(srcStreams[Lifetime] + i);
+        const UINT alive = static_cast<UINT>(_mm_movemask_ps(_mm_cmplt_ps(values[Age], values[Lifetime]))) & laneMask;
+        if (alive == 0) {
+            continue;
+        }
+
+        // Semi-implicit Euler with drag
+        // 抵抗付きの半陰的オイラー法
+        values[VelocityX] = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(srcStreams[VelocityX] + i), dvx), damping);
+        values[VelocityY] = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(srcStreams[VelocityY] + i), dvy), damping);
+        values[VelocityZ] = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(srcStreams[VelocityZ] + i), dvz), damping);
+        values[PositionX] = _mm_add_ps(_mm_loadu_ps(srcStreams[PositionX] + i), _mm_mul_ps(values[VelocityX], dt));
+        values[PositionY] = _mm_add_ps(_mm_loadu_ps(srcStreams[PositionY] + i), _mm_mul_ps(values[VelocityY], dt));
+        values[PositionZ] = _mm_add_ps(_mm_loadu_ps(srcStreams[PositionZ] + i), _mm_mul_ps(values[VelocityZ], dt));
+
+        // Size and color over the normalized age
+        // 正規化した経過時間に対するサイズと色
+        const __m128 t    = _mm_min_ps(_mm_div_ps(values[Age], values[Lifetime]), one);
+        const __m128 size = _mm_add_ps(sizeStart, _mm_mul_ps(sizeDelta, t));
+        __m128i color = _mm_setzero_si128();
+        for (UINT c = 0; c < 4; ++c) {
+            const __m128i channel = _mm_cvtps_epi32(_mm_add_ps(colorStart[c], _mm_mul_ps(colorDelta[c], t)));
+            color = _mm_or_si128(color, _mm_slli_epi32(channel, c * 8));
+        }
+
+        // Rows of position and size, which are contiguous in ParticleInstance
+        // ParticleInstance内で連続する位置とサイズの行
+        __m128 rows[4] = { values[PositionX], values[PositionY], values[PositionZ], size };
+        _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+        alignas(16) UINT colors[4];
+        _mm_store_si128(reinterpret_cast<__m128i *>(colors), color);
+
+        // Whole groups are stored as they are, partial ones are packed lane by lane
+        // 全て生存するグループはそのまま格納し、一部のものはレーン毎に詰める
+        if (alive == 0xfu) {
+            for (UINT s = 0; s < PARTICLE_STREAM_COUNT; ++s) {
+                _mm_storeu_ps(dstStreams[s] + written, values[s]);
+            }
+            for (UINT lane = 0; lane < 4; ++lane) {
+                ParticleInstance &instance = instances[written++];
+                _mm_storeu_ps(&instance.position.x, rows[lane]);
+                instance.color = colors[lane];
+            }
+        } else {
+            alignas(16) float lanes[PARTICLE_STREAM_COUNT][4];
+            for (UINT s = 0; s < PARTICLE_STREAM_COUNT; ++s) {
+                _mm_store_ps(lanes[s], values[s]);
+            }
+            for (UINT lane = 0; lane < 4; ++lane) {
+                if ((alive & (1u << lane)) != 0) {
+                    for (UINT s = 0; s < PARTICLE_STREAM_COUNT; ++s) {
+                        dstStreams[s][written] = lanes[s][lane];
+                    }
+                    ParticleInstance &instance = instances[written++];
+                    _mm_storeu_ps(&instance.position.x, rows[lane]);
+                    instance.color = colors[lane];
+                }
+            }
+        }
+    }
+}
+
+// Emit new particles after the survivors
+// 生存したパーティクルの後ろへ新しいパーティクルを放出
+void ParticleSystem::Emit(const Task &task, ParticleInstance *dstInstances) {
+    Emitter &emitter = emitters[task.emitter];
+    const ParticleEmitterDesc &desc = emitter.desc;
+
+    float *dstStreams[PARTICLE_STREAM_COUNT];
+    for (UINT s = 0; s < PARTICLE_STREAM_COUNT; ++s) {
+        dstStreams[s] = emitter.GetStream(emitter.poolIndex ^ 1, s) + task.dstOffset;
+    }
+    ParticleInstance *instances = dstInstances + emitter.instanceOffset + task.dstOffset;
+    const UINT color = PackColor(desc.startColor);
+
+    // Every particle hashes its own index, so the result does not depend on the batching
+    // 各パーティクルは自身の番号をハッシュする為、結果はバッチ分割に依存しない
+    for (UINT i = 0; i < task.count; ++i) {
+        UINT state = emitter.emitSeed ^ HashUint(task.first + i);
+        const float px = desc.position.x + (NextRandom(&state) * 2.0f - 1.0f) * desc.positionSpread;
+        const float py = desc.position.y + (NextRandom(&state) * 2.0f - 1.0f) * desc.positionSpread;
+        const float pz = desc.position.z + (NextRandom(&state) * 2.0f - 1.0f) * desc.positionSpread;
+
+        dstStreams[PositionX][i] = px;
+        dstStreams[PositionY][i] = py;
+        dstStreams[PositionZ][i] = pz;
+        dstStreams[VelocityX][i] = desc.velocity.x + (NextRandom(&state) * 2.0f - 1.0f) * desc.velocitySpread;
+        dstStreams[VelocityY][i] = desc.velocity.y + (NextRandom(&state) * 2.0f - 1.0f) * desc.velocitySpread;
+        dstStreams[VelocityZ][i] = desc.velocity.z + (NextRandom(&state) * 2.0f - 1.0f) * desc.velocitySpread;
+        dstStreams[Age][i]       = 0.0f;
+        dstStreams[Lifetime][i]  = desc.minLifetime + (desc.maxLifetime - desc.minLifetime) * NextRandom(&state);
+
+        ParticleInstance &instance = instances[i];
+        instance.position = XMFLOAT3(px, py, pz);
+        instance.size     = desc.startSize;
+        instance.color    = color;
+    }
+}
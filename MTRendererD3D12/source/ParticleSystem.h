@@ -0,0 +1,321 @@
+/// @file ParticleSystem.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+class JobSystem;
+
+// Default value
+const UINT INVALID_PARTICLE_EMITTER             = ~0u;
+const UINT DEFAULT_MAX_PARTICLE_COUNT           = 1u << 20u;
+const UINT DEFAULT_PARTICLE_BATCH_SIZE          = 16384;
+const UINT PARTICLE_STREAM_COUNT                = 8;
+
+static_assert((DEFAULT_PARTICLE_BATCH_SIZE % 4) == 0, "The particle batch size must be a multiple of the SIMD width.");
+
+
+/// @~english
+/// @brief Settings of an emitter
+/// @~japanese
+/// @brief エミッタの設定
+/// @~
+/// @struct ParticleEmitterDesc
+struct ParticleEmitterDesc {
+    DirectX::XMFLOAT3   position;
+    float               positionSpread;     ///< @~english Half extent of the box the particles are emitted in @~japanese パーティクルを放出する箱の半分の大きさ
+    DirectX::XMFLOAT3   velocity;
+    float               velocitySpread;     ///< @~english Random velocity added on each axis, up to this value @~japanese 各軸に加えるこの値までのランダムな速度
+    DirectX::XMFLOAT3   acceleration;
+    float               drag;               ///< @~english Fraction of the velocity lost per second @~japanese 1秒あたりに失う速度の割合
+    float               emitRate;           ///< @~english Particles per second @~japanese 1秒あたりのパーティクル数
+    float               minLifetime;
+    float               maxLifetime;
+    float               startSize;
+    float               endSize;
+    DirectX::XMFLOAT4   startColor;
+    DirectX::XMFLOAT4   endColor;
+    UINT                capacity;           ///< @~english Maximum number of live particles @~japanese 生存するパーティクルの最大数
+
+    /// @brief コンストラクタ
+    ParticleEmitterDesc()
+    : position(0.0f, 0.0f, 0.0f)
+    , positionSpread(0.0f)
+    , velocity(0.0f, 1.0f, 0.0f)
+    , velocitySpread(0.5f)
+    , acceleration(0.0f, -9.8f, 0.0f)
+    , drag(0.0f)
+    , emitRate(1000.0f)
+    , minLifetime(1.0f)
+    , maxLifetime(2.0f)
+    , startSize(0.02f)
+    , endSize(0.0f)
+    , startColor(1.0f, 1.0f, 1.0f, 1.0f)
+    , endColor(1.0f, 1.0f, 1.0f, 0.0f)
+    , capacity(4096)
+    {
+        ;
+    }
+};
+
+/// @~english
+/// @brief Per instance data of a particle, read by the instanced draw
+/// @~japanese
+/// @brief パーティクルのインスタンス毎のデータ、インスタンス描画が参照する
+/// @~
+/// @struct ParticleInstance
+struct ParticleInstance {
+    DirectX::XMFLOAT3   position;
+    float               size;
+    UINT                color;  ///< @~english R8G8B8A8_UNORM @~japanese R8G8B8A8_UNORM
+};
+
+static_assert(offsetof(ParticleInstance, size) == sizeof(DirectX::XMFLOAT3), "The position and size are written as one vector.");
+
+/// @~english
+/// @brief Range of the instance stream drawn by one instanced draw
+/// @~japanese
+/// @brief 1回のインスタンス描画で描画するインスタンスストリームの範囲
+/// @~
+/// @struct ParticleDraw
+struct ParticleDraw {
+    UINT    emitter;
+    UINT    instanceOffset;
+    UINT    instanceCount;
+};
+
+/// @~english
+/// @brief Instance stream and draws of an update
+/// @~japanese
+/// @brief 1回の更新のインスタンスストリームと描画
+/// @~
+/// @struct ParticleFrame
+struct ParticleFrame {
+    const ParticleInstance *instances;
+    UINT                    instanceCount;
+    const ParticleDraw     *draws;
+    UINT                    drawCount;
+
+    /// @brief コンストラクタ
+    ParticleFrame()
+    : instances(nullptr)
+    , instanceCount(0)
+    , draws(nullptr)
+    , drawCount(0)
+    {
+        ;
+    }
+};
+
+/// @~english
+/// @brief Statistics of the particle update
+/// @~japanese
+/// @brief パーティクル更新処理の統計情報
+/// @~
+/// @struct ParticleStats
+struct ParticleStats {
+    UINT    emitterCount;
+    UINT    aliveCount;
+    UINT    emittedCount;
+    UINT    killedCount;
+    UINT    taskCount;
+    float   timeInMs;
+
+    /// @brief コンストラクタ
+    ParticleStats()
+    : emitterCount(0)
+    , aliveCount(0)
+    , emittedCount(0)
+    , killedCount(0)
+    , taskCount(0)
+    , timeInMs(0.0f)
+    {
+        ;
+    }
+};
+
+
+/// @class ParticleSystem
+/// @~english
+/// @brief CPU particle simulation writing an instance stream drawn with one instanced draw per emitter
+/// @details Each emitter keeps its particles in two pools of separate streams (position, velocity, age,
+///          lifetime), one read and one written per update. An update runs in three steps over batches of
+///          DEFAULT_PARTICLE_BATCH_SIZE particles on the job system: the survivors of each batch are counted,
+///          their offsets are found by a prefix sum, then every batch integrates its particles four at a time
+///          with SSE and writes the survivors packed to the other pool and to the instance stream, while the
+///          new particles are emitted in parallel after them. The instance stream and the draws are double
+///          buffered, so the frame of the previous update stays readable during the next one.
+/// @~japanese
+/// @brief 1エミッタあたり1回のインスタンス描画で描画するインスタンスストリームを書き込むCPUパーティクルシミュレーション
+/// @details 各エミッタはパーティクルを個別のストリーム（位置、速度、経過時間、寿命）からなる2つのプールに保持し、
+///          更新毎に一方を読み込み他方へ書き込む。更新はJobSystem上でDEFAULT_PARTICLE_BATCH_SIZE個のパーティクル
+///          のバッチ毎に3段階で行う。各バッチの生存数を数え、プレフィックス和で出力位置を求めた後、各バッチは
+///          SSEで4つずつパーティクルを積分し、生存したものを詰めて他方のプールとインスタンスストリームへ書き込む。
+///          新しいパーティクルはその後ろへ並列に放出する。インスタンスストリームと描画はダブルバッファの為、
+///          前の更新のフレームは次の更新の間も参照できる
+class ParticleSystem {
+public:
+    /// @~english
+    /// @brief Initialize
+    /// @param[in] maxParticleCount Total capacity of the emitters
+    /// @return True if initialization succeeded, false otherwise
+    /// @~japanese
+    /// @brief 初期化
+    /// @param[in] maxParticleCount エミッタの合計容量
+    /// @return 初期化に成功した場合にはTrue、そうでないならFalseを返す
+    bool Init(UINT maxParticleCount);
+
+    /// @~english
+    /// @brief Create an emitter
+    /// @return Handle of the emitter, INVALID_PARTICLE_EMITTER if its capacity does not fit
+    /// @~japanese
+    /// @brief エミッタを生成
+    /// @return エミッタのハンドル、容量が収まらない場合はINVALID_PARTICLE_EMITTER
+    UINT CreateEmitter(const ParticleEmitterDesc &desc);
+
+    /// @~english
+    /// @brief Move an emitter
+    /// @~japanese
+    /// @brief エミッタを移動
+    void SetEmitterPosition(UINT emitter, const DirectX::XMFLOAT3 &position);
+
+    /// @~english
+    /// @brief Set the number of particles an emitter emits per second
+    /// @~japanese
+    /// @brief エミッタが1秒あたりに放出するパーティクル数をセット
+    void SetEmitRate(UINT emitter, float emitRate);
+
+    /// @~english
+    /// @brief Simulate the particles and write the instance stream
+    /// @param[in] delta Time taken since the last frame (seconds
+    /// @param[in] jobSystem JobSystem to distribute the batches to (nullptr to run serially
+    /// @~japanese
+    /// @brief パーティクルをシミュレーションしインスタンスストリームを書き込む
+    /// @param[in] delta 前フレームからの経過時間（秒
+    /// @param[in] jobSystem バッチを分散するJobSystem（nullptrの場合は逐次実行
+    void Update(float delta, JobSystem *jobSystem);
+
+    /// @~english
+    /// @brief Get the instance stream and the draws of the last update
+    /// @~japanese
+    /// @brief 最後の更新のインスタンスストリームと描画を取得
+    const ParticleFrame& GetFrame() const {
+        return frame;
+    }
+
+    /// @~english
+    /// @brief Get the total capacity of the emitters
+    /// @~japanese
+    /// @brief エミッタの合計容量を取得
+    UINT GetMaxParticleCount() const {
+        return maxParticleCount;
+    }
+
+    /// @~english
+    /// @brief Get the statistics of the last update
+    /// @~japanese
+    /// @brief 最後の更新処理の統計情報を取得
+    const ParticleStats& GetStats() const {
+        return stats;
+    }
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    ParticleSystem();
+
+private:
+    /// @~english
+    /// @brief Streams of a particle pool
+    /// @~japanese
+    /// @brief パーティクルプールのストリーム
+    enum Stream : UINT {
+        PositionX = 0,
+        PositionY,
+        PositionZ,
+        VelocityX,
+        VelocityY,
+        VelocityZ,
+        Age,
+        Lifetime,
+    };
+
+    /// @~english
+    /// @brief Emitter and its particle pools
+    /// @~japanese
+    /// @brief エミッタとそのパーティクルプール
+    /// @~
+    /// @struct Emitter
+    struct Emitter {
+        ParticleEmitterDesc desc;
+        std::vector<float>  pools[2];       ///< @~english PARTICLE_STREAM_COUNT streams of capacity floats @~japanese capacity個のfloatからなるPARTICLE_STREAM_COUNT個のストリーム
+        UINT                capacity;       ///< @~english Rounded up to the SIMD width @~japanese SIMD幅に切り上げた値
+        UINT                poolIndex;      ///< @~english Pool holding the live particles @~japanese 生存するパーティクルを保持するプール
+        UINT                aliveCount;
+        float               emitAccumulator;
+        UINT                emitSeed;
+
+        // State of the running update
+        // 実行中の更新処理の状態
+        UINT                survivorCount;
+        UINT                emitCount;
+        UINT                instanceOffset;
+
+        /// @~english
+        /// @brief Get a stream of a pool
+        /// @~japanese
+        /// @brief プールのストリームを取得
+        float* GetStream(UINT pool, UINT stream) {
+            return pools[pool].data() + static_cast<size_t>(stream) * capacity;
+        }
+    };
+
+    /// @~english
+    /// @brief Batch of particles of an emitter
+    /// @~japanese
+    /// @brief エミッタのパーティクルのバッチ
+    /// @~
+    /// @struct Task
+    struct Task {
+        UINT    emitter;
+        UINT    first;
+        UINT    count;
+        UINT    dstOffset;      ///< @~english Survivors of the earlier batches of the emitter @~japanese エミッタの前のバッチの生存数
+        UINT    survivorCount;
+    };
+
+    /// @~english
+    /// @brief Count the particles of a batch that survive this update
+    /// @~japanese
+    /// @brief バッチのパーティクルのうち今回の更新で生存する数を数える
+    void CountSurvivors(Task *task, float delta);
+
+    /// @~english
+    /// @brief Integrate the particles of a batch and write the survivors packed
+    /// @~japanese
+    /// @brief バッチのパーティクルを積分し生存したものを詰めて書き込む
+    void Simulate(const Task &task, float delta, ParticleInstance *dstInstances);
+
+    /// @~english
+    /// @brief Emit new particles after the survivors
+    /// @~japanese
+    /// @brief 生存したパーティクルの後ろへ新しいパーティクルを放出
+    void Emit(const Task &task, ParticleInstance *dstInstances);
+
+private:
+    std::vector<Emitter>            emitters;
+    UINT                            maxParticleCount;
+    UINT                            reservedCount;
+
+    std::vector<Task>               simulateTasks;
+    std::vector<Task>               emitTasks;
+
+    // Double buffered output of the updates
+    // 更新処理のダブルバッファの出力
+    std::vector<ParticleInstance>   instanceStreams[2];
+    std::vector<ParticleDraw>       drawLists[2];
+    UINT                            frameIndex;
+    ParticleFrame                   frame;
+
+    ParticleStats                   stats;
+};
@@ -0,0 +1,98 @@
+/// @file PlatformCompat.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+/// @~english
+/// @brief Windows types and the few Direct3D 12 declarations the CPU modules use, for the builds without the
+///        Windows SDK. Only the CPU library and its tests and benchmarks are built this way, the renderer
+///        itself needs the real headers.
+/// @~japanese
+/// @brief Windows SDKの無いビルド向けの、CPUモジュールが使用するWindowsの型と少数のDirect3D 12の宣言。
+///        この方法でビルドするのはCPUライブラリとそのテスト及びベンチマークのみで、レンダラー自体は
+///        実際のヘッダを必要とする
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+typedef unsigned char       BYTE;
+typedef int                 BOOL;
+typedef int                 INT;
+typedef unsigned int        UINT;
+typedef long                LONG;
+typedef unsigned long       DWORD;
+typedef int8_t              INT8;
+typedef int16_t             INT16;
+typedef int32_t             INT32;
+typedef int64_t             INT64;
+typedef uint8_t             UINT8;
+typedef uint16_t            UINT16;
+typedef uint32_t            UINT32;
+typedef uint64_t            UINT64;
+typedef size_t              SIZE_T;
+typedef const char         *LPCSTR;
+
+#ifndef TRUE
+    #define TRUE    (1)
+#endif
+#ifndef FALSE
+    #define FALSE   (0)
+#endif
+
+#ifndef _countof
+    #define _countof(array) (sizeof(array) / sizeof((array)[0]))
+#endif
+
+// Reports go to the standard error in place of the debugger
+// レポートはデバッガの代わりに標準エラーへ出力する
+inline void OutputDebugStringA(LPCSTR str) {
+    fputs(str, stderr);
+}
+
+inline void* _aligned_malloc(size_t size, size_t alignment) {
+    void *ptr = nullptr;
+    return (posix_memalign(&ptr, std::max<size_t>(alignment, sizeof(void *)), size) == 0) ? ptr : nullptr;
+}
+
+inline void _aligned_free(void *ptr) {
+    free(ptr);
+}
+
+enum DXGI_FORMAT : UINT {
+    DXGI_FORMAT_UNKNOWN     = 0,
+    DXGI_FORMAT_D32_FLOAT   = 40,
+    DXGI_FORMAT_R32_UINT    = 42,
+    DXGI_FORMAT_R16_UINT    = 57,
+};
+
+typedef UINT64 D3D12_GPU_VIRTUAL_ADDRESS;
+
+#define D3D12_MIN_DEPTH     (0.0f)
+#define D3D12_MAX_DEPTH     (1.0f)
+
+struct D3D12_VIEWPORT {
+    float   TopLeftX;
+    float   TopLeftY;
+    float   Width;
+    float   Height;
+    float   MinDepth;
+    float   MaxDepth;
+};
+
+struct D3D12_RECT {
+    LONG    left;
+    LONG    top;
+    LONG    right;
+    LONG    bottom;
+};
+
+struct D3D12_DRAW_INDEXED_ARGUMENTS {
+    UINT    IndexCountPerInstance;
+    UINT    InstanceCount;
+    UINT    StartIndexLocation;
+    INT     BaseVertexLocation;
+    UINT    StartInstanceLocation;
+};
@@ -0,0 +1,173 @@
+/// @file RenderQueue.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "RenderQueue.h"
+#include "JobSystem.h"
+
+namespace {
+// Stable insertion sort for short queues
+// 短いキュー向けの安定な挿入ソート
+void InsertionSort(RenderItem *items, UINT count) {
+    for (UINT i = 1; i < count; ++i) {
+        const RenderItem item = items[i];
+        UINT j = i;
+        for (; 0 < j && item.sortKey < items[j - 1].sortKey; --j) {
+            items[j] = items[j - 1];
+        }
+        items[j] = item;
+    }
+}
+
+// Get the digit of a key
+// キーの桁を取得
+UINT GetDigit(UINT64 sortKey, UINT shift) {
+    return static_cast<UINT>(sortKey >> shift) & (RADIX_SORT_BUCKET_COUNT - 1u);
+}
+} // namespace ""
+
+//----------------------------------------------------------------------------------------------------
+// RenderQueue
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+RenderQueue::RenderQueue()
+: items(ScratchAllocator<RenderItem>(nullptr))
+, sortBuffer(ScratchAllocator<RenderItem>(nullptr))
+, histograms(ScratchAllocator<UINT>(nullptr))
+, varyingBits(ScratchAllocator<UINT64>(nullptr))
+{
+    Reserve(DEFAULT_RENDER_QUEUE_CAPACITY);
+}
+
+// Destructor
+// デストラクタ
+RenderQueue::~RenderQueue() {
+    ;
+}
+
+// Allocate from an arena from now on, the items are removed
+// 以降はアリーナから確保する、要素は削除される
+void RenderQueue::SetArena(ScratchArena *arena) {
+    // The old storage is not touched, it may belong to an arena that was reset
+    // 古い領域には触れない、リセット済みのアリーナに属している可能性がある
+    items       = ScratchVector<RenderItem>(ScratchAllocator<RenderItem>(arena));
+    sortBuffer  = ScratchVector<RenderItem>(ScratchAllocator<RenderItem>(arena));
+    histograms  = ScratchVector<UINT>(ScratchAllocator<UINT>(arena));
+    varyingBits = ScratchVector<UINT64>(ScratchAllocator<UINT64>(arena));
+}
+
+// Reserve capacity for count items
+// count個分の容量を確保
+void RenderQueue::Reserve(UINT count) {
+    items.reserve(count);
+    sortBuffer.reserve(count);
+}
+
+// Sort the items by key, equal keys keep their push order
+// 要素をキーでソート、等しいキーは追加順を保つ
+void RenderQueue::Sort(JobSystem *jobSystem) {
+    auto beginTime = std::chrono::high_resolution_clock::now();
+
+    const UINT count = static_cast<UINT>(items.size());
+    stats = RenderQueueStats();
+    stats.itemCount = count;
+
+    if (count < DEFAULT_RADIX_SORT_MIN_COUNT) {
+        InsertionSort(items.data(), count);
+        stats.taskCount = 1;
+    } else {
+        const UINT taskCount = (count + DEFAULT_RADIX_SORT_GRAIN - 1) / DEFAULT_RADIX_SORT_GRAIN;
+        stats.taskCount = taskCount;
+
+        sortBuffer.resize(count);
+        histograms.resize(static_cast<size_t>(taskCount) * RADIX_SORT_BUCKET_COUNT);
+        varyingBits.resize(taskCount);
+
+        auto runTasks = [jobSystem, taskCount](const auto &func) {
+            if (jobSystem != nullptr) {
+                jobSystem->ParallelFor(taskCount, 1, func);
+            } else {
+                func(0, taskCount);
+            }
+        };
+
+        // Find the bits that differ between items, digits without any are skipped
+        // 要素間で異なるビットを調べ、それを含まない桁はスキップする
+        runTasks([this, count](UINT begin, UINT end) {
+            const UINT64 firstKey = items[0].sortKey;
+            for (UINT task = begin; task < end; ++task) {
+                const UINT itemEnd = std::min((task + 1) * DEFAULT_RADIX_SORT_GRAIN, count);
+                UINT64 bits = 0;
+                for (UINT i = task * DEFAULT_RADIX_SORT_GRAIN; i < itemEnd; ++i) {
+                    bits |= items[i].sortKey ^ firstKey;
+                }
+                varyingBits[task] = bits;
+            }
+        });
+
+        UINT64 varying = 0;
+        for (auto bits : varyingBits) {
+            varying |= bits;
+        }
+
+        RenderItem *src = items.data();
+        RenderItem *dst = sortBuffer.data();
+        for (UINT shift = 0; shift < 64; shift += RADIX_SORT_DIGIT_BITS) {
+            if (GetDigit(varying, shift) == 0) {
+                continue;
+            }
+
+            // Count the digits of each task
+            // タスク毎に桁の出現数を数える
+            runTasks([this, src, count, shift](UINT begin, UINT end) {
+                for (UINT task = begin; task < end; ++task) {
+                    UINT *histogram = &histograms[static_cast<size_t>(task) * RADIX_SORT_BUCKET_COUNT];
+                    memset(histogram, 0, sizeof(UINT) * RADIX_SORT_BUCKET_COUNT);
+
+                    const UINT itemEnd = std::min((task + 1) * DEFAULT_RADIX_SORT_GRAIN, count);
+                    for (UINT i = task * DEFAULT_RADIX_SORT_GRAIN; i < itemEnd; ++i) {
+                        histogram[GetDigit(src[i].sortKey, shift)]++;
+                    }
+                }
+            });
+
+            // Convert the counts to output offsets, digit major and task minor to keep the sort stable
+            // 出現数を出力位置へ変換、安定ソートとする為に桁を優先しタスク順に並べる
+            UINT offset = 0;
+            for (UINT digit = 0; digit < RADIX_SORT_BUCKET_COUNT; ++digit) {
+                for (UINT task = 0; task < taskCount; ++task) {
+                    UINT &histogram = histograms[static_cast<size_t>(task) * RADIX_SORT_BUCKET_COUNT + digit];
+                    const UINT digitCount = histogram;
+                    histogram = offset;
+                    offset += digitCount;
+                }
+            }
+
+            // Scatter the items of each task to their offsets
+            // タスク毎に要素を出力位置へ分配
+            runTasks([this, src, dst, count, shift](UINT begin, UINT end) {
+                for (UINT task = begin; task < end; ++task) {
+                    UINT *histogram = &histograms[static_cast<size_t>(task) * RADIX_SORT_BUCKET_COUNT];
+
+                    const UINT itemEnd = std::min((task + 1) * DEFAULT_RADIX_SORT_GRAIN, count);
+                    for (UINT i = task * DEFAULT_RADIX_SORT_GRAIN; i < itemEnd; ++i) {
+                        dst[histogram[GetDigit(src[i].sortKey, shift)]++] = src[i];
+                    }
+                }
+            });
+
+            std::swap(src, dst);
+            stats.sortPassCount++;
+        }
+
+        // The result is in sortBuffer after an odd number of passes
+        // 奇数回のパスの後は結果がsortBufferにある
+        if (src != items.data()) {
+            items.swap(sortBuffer);
+        }
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    stats.sortTimeInMs = std::chrono::duration<float, std::milli>(endTime - beginTime).count();
+}
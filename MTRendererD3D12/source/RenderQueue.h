@@ -0,0 +1,309 @@
+/// @file RenderQueue.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+#include "ScratchArena.h"
+
+class JobSystem;
+
+// Default value
+const UINT DEFAULT_RENDER_QUEUE_CAPACITY    = 1024;
+const UINT DEFAULT_RADIX_SORT_GRAIN         = 16 * 1024;
+const UINT DEFAULT_RADIX_SORT_MIN_COUNT     = 256;
+const UINT RADIX_SORT_DIGIT_BITS            = 8;
+const UINT RADIX_SORT_BUCKET_COUNT          = 1u << RADIX_SORT_DIGIT_BITS;
+
+// Sort key layout (MSB -> LSB) : pass 4 | pipeline 10 | material 14 | mesh 13 | lod 3 | depth 20
+// ソートキーのレイアウト（MSB -> LSB） : パス 4 | パイプライン 10 | マテリアル 14 | メッシュ 13 | LOD 3 | 深度 20
+const UINT SORT_KEY_DEPTH_BITS      = 20;
+const UINT SORT_KEY_LOD_BITS        = 3;
+const UINT SORT_KEY_MESH_BITS       = 13;
+const UINT SORT_KEY_MATERIAL_BITS   = 14;
+const UINT SORT_KEY_PIPELINE_BITS   = 10;
+const UINT SORT_KEY_PASS_BITS       = 4;
+const UINT SORT_KEY_LOD_SHIFT       = SORT_KEY_DEPTH_BITS;
+const UINT SORT_KEY_MESH_SHIFT      = SORT_KEY_LOD_SHIFT + SORT_KEY_LOD_BITS;
+const UINT SORT_KEY_MATERIAL_SHIFT  = SORT_KEY_MESH_SHIFT + SORT_KEY_MESH_BITS;
+const UINT SORT_KEY_PIPELINE_SHIFT  = SORT_KEY_MATERIAL_SHIFT + SORT_KEY_MATERIAL_BITS;
+const UINT SORT_KEY_PASS_SHIFT      = SORT_KEY_PIPELINE_SHIFT + SORT_KEY_PIPELINE_BITS;
+
+static_assert(SORT_KEY_PASS_SHIFT + SORT_KEY_PASS_BITS == 64, "Sort key fields must fill 64 bits.");
+
+
+/// @enum RenderPass
+enum class RenderPass : UINT {
+    Opaque      = 0,    ///< @~english Front to back @~japanese 手前から奥
+    Transparent = 1,    ///< @~english Back to front @~japanese 奥から手前
+    Culled      = 15,   ///< @~english Not drawn, sorted after every other pass @~japanese 描画しない、全てのパスの後ろへソートされる
+};
+
+/// @~english
+/// @brief Draw request of a proxy
+/// @~japanese
+/// @brief Proxyの描画要求
+/// @~
+/// @struct RenderItem
+struct RenderItem {
+    UINT64  sortKey;
+    UINT    instanceIndex;  ///< @~english Index of the per-instance data @~japanese インスタンス毎データのインデックス
+    UINT    reserved;
+};
+
+/// @~english
+/// @brief Statistics of the render queue sort
+/// @~japanese
+/// @brief 描画キューのソート処理の統計情報
+/// @~
+/// @struct RenderQueueStats
+struct RenderQueueStats {
+    UINT    itemCount;
+    UINT    sortPassCount;  ///< @~english Digit passes run, constant digits are skipped @~japanese 実行した桁のパス数、一定の桁はスキップされる
+    UINT    taskCount;
+    float   sortTimeInMs;
+
+    /// @brief コンストラクタ
+    RenderQueueStats()
+    : itemCount(0)
+    , sortPassCount(0)
+    , taskCount(0)
+    , sortTimeInMs(0.0f)
+    {
+        ;
+    }
+};
+
+/// @~english
+/// @brief Statistics of the command recording from a sorted render queue
+/// @~japanese
+/// @brief ソート済み描画キューからのコマンド記録の統計情報
+/// @~
+/// @struct RenderSubmitStats
+struct RenderSubmitStats {
+    UINT    drawCount;
+    UINT    prepassDrawCount;
+    UINT    instanceCount;
+    UINT    pipelineChanges;
+    UINT    rootSignatureChanges;
+    UINT    materialChanges;
+    UINT    vertexBufferChanges;
+    UINT    bundleCount;        ///< @~english Bundles executed in place of recording @~japanese 記録の代わりに実行したバンドル
+    UINT    bundledDrawCount;   ///< @~english Draws replayed from the bundles @~japanese バンドルから再生した描画
+    UINT    indirectCount;      ///< @~english ExecuteIndirect calls, each counts its records as draws @~japanese ExecuteIndirectの呼び出し、各呼び出しはレコードを描画として数える
+    float   indirectBuildTimeInMs;
+
+    /// @brief コンストラクタ
+    RenderSubmitStats()
+    : drawCount(0)
+    , prepassDrawCount(0)
+    , instanceCount(0)
+    , pipelineChanges(0)
+    , rootSignatureChanges(0)
+    , materialChanges(0)
+    , vertexBufferChanges(0)
+    , bundleCount(0)
+    , bundledDrawCount(0)
+    , indirectCount(0)
+    , indirectBuildTimeInMs(0.0f)
+    {
+        ;
+    }
+};
+
+
+/// @class RenderQueue
+/// @~english
+/// @brief Queue of draw requests sorted by a 64-bit state key
+/// @details Items are sorted by an LSD radix sort (8 bits per pass) whose histogram and scatter
+///          steps are distributed over the JobSystem. Digits that are equal for all items are skipped,
+///          so the pass count follows the number of distinct states rather than the key width.
+///          After sorting, items sharing pass, pipeline, material and mesh are adjacent.
+///          The items and the sort buffers come from the arena given to SetArena(), the heap until then.
+/// @~japanese
+/// @brief 64bitのステートキーでソートする描画要求のキュー
+/// @details LSD基数ソート（1パス8bit）でソートし、ヒストグラムと分配の処理はJobSystemへ分散する。
+///          全要素で等しい桁はスキップするため、パス数はキーの幅ではなく異なるステートの数に従う。
+///          ソート後はパス、パイプライン、マテリアル、メッシュが等しい要素が隣接する。
+///          要素とソート用のバッファはSetArena()で与えたアリーナから確保し、それまではヒープから確保する
+class RenderQueue {
+public:
+    /// @~english
+    /// @brief Make a sort key
+    /// @param[in] pass Render pass
+    /// @param[in] pipeline Pipeline index
+    /// @param[in] material Material index
+    /// @param[in] mesh Mesh index
+    /// @param[in] lod LOD index of the mesh
+    /// @param[in] depth Quantized depth (see QuantizeDepth
+    /// @~japanese
+    /// @brief ソートキーを作成
+    /// @param[in] pass 描画パス
+    /// @param[in] pipeline パイプライン番号
+    /// @param[in] material マテリアル番号
+    /// @param[in] mesh メッシュ番号
+    /// @param[in] lod メッシュのLOD番号
+    /// @param[in] depth 量子化した深度（QuantizeDepth参照
+    static UINT64 MakeSortKey(RenderPass pass, UINT pipeline, UINT material, UINT mesh, UINT lod, UINT depth) {
+        assert(static_cast<UINT>(pass) < (1u << SORT_KEY_PASS_BITS));
+        assert(pipeline < (1u << SORT_KEY_PIPELINE_BITS));
+        assert(material < (1u << SORT_KEY_MATERIAL_BITS));
+        assert(mesh < (1u << SORT_KEY_MESH_BITS));
+        assert(lod < (1u << SORT_KEY_LOD_BITS));
+
+        // Transparent items are drawn back to front
+        // 半透明は奥から手前へ描画
+        const UINT depthMask = (1u << SORT_KEY_DEPTH_BITS) - 1u;
+        if (pass == RenderPass::Transparent) {
+            depth = ~depth;
+        }
+
+        return (static_cast<UINT64>(pass)     << SORT_KEY_PASS_SHIFT)
+             | (static_cast<UINT64>(pipeline) << SORT_KEY_PIPELINE_SHIFT)
+             | (static_cast<UINT64>(material) << SORT_KEY_MATERIAL_SHIFT)
+             | (static_cast<UINT64>(mesh)     << SORT_KEY_MESH_SHIFT)
+             | (static_cast<UINT64>(lod)      << SORT_KEY_LOD_SHIFT)
+             | static_cast<UINT64>(depth & depthMask);
+    }
+
+    /// @~english
+    /// @brief Quantize a view space depth to the depth field of a sort key
+    /// @details Uses the upper bits of the IEEE 754 representation, which is monotonic for positive values
+    ///          and keeps relative precision at every distance.
+    /// @~japanese
+    /// @brief View空間の深度をソートキーの深度フィールドへ量子化
+    /// @details 正の値で単調増加となるIEEE 754表現の上位ビットを使用し、距離によらず相対精度を保つ
+    static UINT QuantizeDepth(float viewDepth) {
+        viewDepth = std::max(viewDepth, 0.0f);
+        UINT bits = 0;
+        memcpy(&bits, &viewDepth, sizeof(bits));
+        return bits >> (31 - SORT_KEY_DEPTH_BITS);
+    }
+
+    /// @~english
+    /// @brief Get the state part of a sort key (everything except the depth)
+    /// @~japanese
+    /// @brief ソートキーのステート部分を取得（深度以外
+    static UINT64 GetStateKey(UINT64 sortKey) {
+        return sortKey >> SORT_KEY_DEPTH_BITS;
+    }
+
+    /// @~english
+    /// @name Fields of a sort key
+    /// @~japanese
+    /// @name ソートキーの各フィールド
+    /// @{
+    static UINT GetPipeline(UINT64 sortKey) {
+        return static_cast<UINT>(sortKey >> SORT_KEY_PIPELINE_SHIFT) & ((1u << SORT_KEY_PIPELINE_BITS) - 1u);
+    }
+    static UINT GetMaterial(UINT64 sortKey) {
+        return static_cast<UINT>(sortKey >> SORT_KEY_MATERIAL_SHIFT) & ((1u << SORT_KEY_MATERIAL_BITS) - 1u);
+    }
+    static UINT GetMesh(UINT64 sortKey) {
+        return static_cast<UINT>(sortKey >> SORT_KEY_MESH_SHIFT) & ((1u << SORT_KEY_MESH_BITS) - 1u);
+    }
+    static UINT GetLod(UINT64 sortKey) {
+        return static_cast<UINT>(sortKey >> SORT_KEY_LOD_SHIFT) & ((1u << SORT_KEY_LOD_BITS) - 1u);
+    }
+    /// @}
+
+    /// @~english
+    /// @brief Allocate from an arena from now on, the items are removed
+    /// @details Call after every Reset() of the arena, the queue must not be used between the two.
+    /// @param[in] arena Arena to allocate from (nullptr for the heap
+    /// @~japanese
+    /// @brief 以降はアリーナから確保する、要素は削除される
+    /// @details アリーナのReset()毎に呼ぶこと、その間はキューを使用しないこと
+    /// @param[in] arena 確保元のアリーナ（nullptrの場合はヒープ
+    void SetArena(ScratchArena *arena);
+
+    /// @~english
+    /// @brief Remove all items, the capacity is kept
+    /// @~japanese
+    /// @brief 全要素を削除、確保済みの容量は維持される
+    void Clear() {
+        items.clear();
+    }
+
+    /// @~english
+    /// @brief Reserve capacity for count items
+    /// @~japanese
+    /// @brief count個分の容量を確保
+    void Reserve(UINT count);
+
+    /// @~english
+    /// @brief Add an item
+    /// @~japanese
+    /// @brief 要素を追加
+    void Push(UINT64 sortKey, UINT instanceIndex) {
+        RenderItem item;
+        item.sortKey       = sortKey;
+        item.instanceIndex = instanceIndex;
+        item.reserved      = 0;
+        items.push_back(item);
+    }
+
+    /// @~english
+    /// @brief Append count items to be filled by the caller
+    /// @details Disjoint entries may be written from multiple threads.
+    /// @return Pointer to the first appended item, valid until the next Push() or Append()
+    /// @~japanese
+    /// @brief 呼び出し元が書き込む要素をcount個追加
+    /// @details 重ならない要素には複数スレッドから書き込める
+    /// @return 追加した先頭要素へのポインタ、次のPush()もしくはAppend()まで有効
+    RenderItem* Append(UINT count) {
+        const size_t first = items.size();
+        items.resize(first + count);
+        return items.data() + first;
+    }
+
+    /// @~english
+    /// @brief Sort the items by key, equal keys keep their push order
+    /// @param[in] jobSystem Job system to distribute the sort to (nullptr to sort on the calling thread
+    /// @~japanese
+    /// @brief 要素をキーでソート、等しいキーは追加順を保つ
+    /// @param[in] jobSystem ソートを分散するJobSystem（nullptrの場合は呼び出し元スレッドでソート
+    void Sort(JobSystem *jobSystem);
+
+    /// @~english
+    /// @brief Get the items
+    /// @~japanese
+    /// @brief 要素を取得
+    const RenderItem* GetItems() const {
+        return items.data();
+    }
+
+    /// @~english
+    /// @brief Get the number of items
+    /// @~japanese
+    /// @brief 要素数を取得
+    UINT GetItemCount() const {
+        return static_cast<UINT>(items.size());
+    }
+
+    /// @~english
+    /// @brief Get the statistics of the last sort
+    /// @~japanese
+    /// @brief 直前のソートの統計情報を取得
+    const RenderQueueStats& GetStats() const {
+        return stats;
+    }
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    RenderQueue();
+
+    /// @~english
+    /// @brief Destructor
+    /// @~japanese
+    /// @brief デストラクタ
+    ~RenderQueue();
+
+private:
+    ScratchVector<RenderItem>   items;
+    ScratchVector<RenderItem>   sortBuffer;
+    ScratchVector<UINT>         histograms;     ///< @~english RADIX_SORT_BUCKET_COUNT per task @~japanese タスク毎にRADIX_SORT_BUCKET_COUNT個
+    ScratchVector<UINT64>       varyingBits;    ///< @~english Per task @~japanese タスク毎
+    RenderQueueStats            stats;
+};
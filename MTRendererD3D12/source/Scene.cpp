@@ -0,0 +1,487 @@
+/// @file Scene.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "Scene.h"
+#include "JobSystem.h"
+
+using namespace DirectX;
+
+namespace {
+// Get the world space bounding sphere of a mesh proxy (xyz: center, w: radius), the radius follows the largest scale
+// メッシュProxyのワールド空間の境界球を取得（xyz: 中心, w: 半径）、半径は最大のスケールに従う
+XMVECTOR GetWorldBoundingSphere(const XMFLOAT4X4 &worldMtx, const MeshComponent &mesh) {
+    const XMMATRIX mtx = XMLoadFloat4x4(&worldMtx);
+    const XMVECTOR center = XMVector3Transform(XMVectorSetW(XMLoadFloat4(&mesh.boundingSphere), 1.0f), mtx);
+    const float scale = std::sqrt(std::max({
+        XMVectorGetX(XMVector3LengthSq(mtx.r[0])),
+        XMVectorGetX(XMVector3LengthSq(mtx.r[1])),
+        XMVectorGetX(XMVector3LengthSq(mtx.r[2])) }));
+    return XMVectorSetW(center, mesh.boundingSphere.w * scale);
+}
+
+// Arrays of the fields common to every actor type in a scene snapshot
+// シーンスナップショットの全アクタ種別に共通のフィールドの配列
+struct SnapshotActorArrays {
+    std::vector<XMFLOAT4>           translations;
+    std::vector<XMFLOAT4>           rotations;
+    std::vector<XMFLOAT4>           scales;
+    std::vector<UINT>               nodes;
+    std::vector<SceneSnapshotTick>  ticks;
+};
+
+// Gather the common fields of the actors of a type, nodes are turned into positions in the hierarchy arrays
+// 種別のアクタの共通のフィールドを収集、ノードは階層の配列内の位置へ変換する
+template<typename ActorT>
+void GatherSnapshotActors(const std::vector<ActorT *> &actors, const std::vector<UINT> &nodeToPosition, SnapshotActorArrays *dst) {
+    const size_t count = actors.size();
+    dst->translations.resize(count);
+    dst->rotations.resize(count);
+    dst->scales.resize(count);
+    dst->nodes.resize(count);
+    dst->ticks.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const ActorT *actor = actors[i];
+        XMStoreFloat4(&dst->translations[i], actor->translation);
+        XMStoreFloat4(&dst->rotations[i], actor->rotation);
+        XMStoreFloat4(&dst->scales[i], actor->scale);
+
+        dst->nodes[i] = nodeToPosition[actor->GetTransformNode()];
+
+        auto &tick = dst->ticks[i];
+        tick.tickGroup        = static_cast<UINT>(actor->GetTickGroup());
+        tick.tickInterval     = actor->GetTickInterval();
+        tick.tickDistanceStep = actor->GetTickDistanceStep();
+        tick.flags            = actor->IsSleeping() ? SCENE_SNAPSHOT_FLAG_SLEEPING : 0;
+    }
+}
+
+// Set the arrays of the common fields of a type to a snapshot writer
+// 種別の共通のフィールドの配列をスナップショットの書き込みへセット
+void SetSnapshotActorArrays(const SnapshotActorArrays &arrays, SceneSnapshotActorType type, SceneSnapshotWriter *writer) {
+    writer->SetActorCount(type, static_cast<UINT>(arrays.ticks.size()));
+    writer->SetArray(type, SceneSnapshotField::Translation, arrays.translations.data());
+    writer->SetArray(type, SceneSnapshotField::Rotation, arrays.rotations.data());
+    writer->SetArray(type, SceneSnapshotField::Scale, arrays.scales.data());
+    writer->SetArray(type, SceneSnapshotField::Node, arrays.nodes.data());
+    writer->SetArray(type, SceneSnapshotField::Tick, arrays.ticks.data());
+}
+} // namespace ""
+
+// Constructor
+// コンストラクタ
+Scene::Scene() {
+    ;
+}
+
+// Destructor
+// デストラクタ
+Scene::~Scene() {
+    ;
+}
+
+// Play an animation clip on an actor, replacing the one playing
+// アクタにアニメーションクリップを再生、再生中のものは置き換える
+bool Scene::PlayAnimation(SceneActor *actor, const AnimationClip *clip, float speed, bool loop) {
+    if (actor == nullptr || actor->transformNode == INVALID_TRANSFORM_NODE) {
+        return false;
+    }
+
+    StopAnimation(actor);
+    actor->animationInstance = animationSystem.Play(clip, actor->transformNode, speed, loop);
+    return actor->animationInstance != INVALID_ANIMATION_INSTANCE;
+}
+
+// Stop the animation of an actor, its translation, rotation and scale apply again
+// アクタのアニメーションを停止、平行移動、回転、スケールが再び適用される
+void Scene::StopAnimation(SceneActor *actor) {
+    if (actor == nullptr || actor->animationInstance == INVALID_ANIMATION_INSTANCE) {
+        return;
+    }
+
+    animationSystem.Stop(actor->animationInstance);
+    actor->animationInstance = INVALID_ANIMATION_INSTANCE;
+}
+
+// Attach an actor to a parent actor
+// アクタを親アクタへ接続
+bool Scene::AttachActor(SceneActor *child, SceneActor *parent) {
+    if (child == nullptr || child->transformNode == INVALID_TRANSFORM_NODE) {
+        return false;
+    }
+
+    const UINT parentNode = (parent != nullptr) ? parent->transformNode : INVALID_TRANSFORM_NODE;
+    if (parent != nullptr && parentNode == INVALID_TRANSFORM_NODE) {
+        return false;
+    }
+
+    return transformHierarchy.SetParent(child->transformNode, parentNode);
+}
+
+// Tick the actors and compute the world matrices
+// アクタを更新しWorld変換行列を算出
+void Scene::Update(float delta, JobSystem *jobSystem) {
+    // Tick distances are measured from the first camera as of the last frame
+    // 更新距離は前フレーム時点の最初のカメラから測る
+    XMVECTOR viewPosition = XMVectorZero();
+    const auto &cameraActors = SceneProxyRegistry::GetActorList<CameraSceneActor>(actorLists);
+    if (!cameraActors.empty()) {
+        viewPosition = transformHierarchy.GetWorldMatrix(cameraActors.front()->transformNode).r[3];
+    }
+
+    // Tick the actors due this frame group by group on the workers
+    // 今フレーム更新するアクタをグループ毎にワーカーで更新
+    tickScheduler.Tick(delta, viewPosition, transformHierarchy, jobSystem);
+
+    for (auto actor : sceneActors) {
+        if (actor->animationInstance == INVALID_ANIMATION_INSTANCE) {
+            transformHierarchy.SetLocalTransform(actor->transformNode, actor->translation, actor->rotation, actor->scale);
+        }
+    }
+
+    // Sample the animated actors straight into the local transforms
+    // アニメーションするアクタをローカルトランスフォームへ直接サンプリング
+    animationSystem.Update(delta, &transformHierarchy, jobSystem);
+
+    // Propagate the local transforms to the world matrices
+    // ローカルトランスフォームをWorld変換行列へ伝播
+    transformHierarchy.UpdateWorldMatrices(jobSystem);
+}
+
+// Transfer render information from the actors to the proxies and refit the BVH
+// アクタからProxyへ描画情報を伝達しBVHをリフィット
+void Scene::Commit(JobSystem *jobSystem) {
+    // Dispatch once per registered type over its actor list
+    // 登録済みの型毎に1回だけ振り分け、アクタリストを一括で伝達
+    SceneProxyRegistry::CommitAll(&proxyWorld, transformHierarchy, actorLists);
+
+    UpdateProxyBVH(jobSystem);
+}
+
+// Release the proxies and the BVH
+// ProxyとBVHを解放
+void Scene::Clear() {
+    proxyWorld.Clear();
+    proxyBVH.Clear();
+}
+
+// Emit the draw requests of the mesh proxies seen from a view and sort them
+// ビューから見たメッシュProxyの描画要求を発行しソート
+UINT Scene::BuildRenderQueue(EntityWorld *world, const RenderQueueView &view, JobSystem *jobSystem, RenderQueue *dstQueue, XMFLOAT4X4 *dstInstanceMatrices) {
+    // The view matrix is stored transposed, so its third row gives the view space Z
+    // View変換行列は転置して格納されている為、3行目からView空間のZが求まる
+    XMVECTOR depthRow = XMVectorZero();
+    if (view.camera != nullptr) {
+        depthRow = XMVectorSet(view.camera->viewMtx._31, view.camera->viewMtx._32, view.camera->viewMtx._33, view.camera->viewMtx._34);
+    }
+
+    // Each chunk writes its own range of the queue
+    // 各チャンクはキューの自身の範囲へ書き込む
+    const UINT itemCount = world->CountEntities<TransformComponent, MeshComponent>();
+    dstQueue->Clear();
+    dstQueue->Reserve(itemCount);
+    RenderItem *items = dstQueue->Append(itemCount);
+
+    std::atomic<UINT> visibleCount(0);
+    world->ParallelForEachIndexed<TransformComponent, MeshComponent>(jobSystem, [&](UINT offset, UINT count, const UINT *entities, TransformComponent *transforms, MeshComponent *meshes) {
+        UINT chunkVisibleCount = 0;
+
+        // Blocks are culled first, then the LODs of the block are selected together
+        // ブロック毎に先にカリングし、その後ブロックのLODをまとめて選択
+        for (UINT blockBegin = 0; blockBegin < count; blockBegin += LOD_SELECT_BLOCK_SIZE) {
+            const UINT blockCount = std::min(count - blockBegin, LOD_SELECT_BLOCK_SIZE);
+            bool  visible[LOD_SELECT_BLOCK_SIZE];
+            float sphereDepths[LOD_SELECT_BLOCK_SIZE];
+            float sphereRadii[LOD_SELECT_BLOCK_SIZE];
+            UINT  lods[LOD_SELECT_BLOCK_SIZE];
+
+            for (UINT j = 0; j < blockCount; ++j) {
+                const UINT i = blockBegin + j;
+                sphereDepths[j] = 0.0f;
+                sphereRadii[j]  = 0.0f;
+                lods[j]         = meshes[i].lodIndex;
+
+                // Cull before the instance is packed, outside the view first then hidden by the occluders
+                // インスタンスを詰める前にカリング、視野外を先に判定し次に遮蔽物に隠れているかを判定
+                const UINT entityIndex = entities[i] & ENTITY_INDEX_MASK;
+                visible[j] = (view.entityViewMasks == nullptr) || (view.entityViewMasks[entityIndex] & view.viewMask) != 0;
+                if (!visible[j] || (view.occlusionCuller == nullptr && view.lodSelector == nullptr)) {
+                    continue;
+                }
+
+                const XMVECTOR sphere = GetWorldBoundingSphere(transforms[i].worldMtx, meshes[i]);
+                if (view.occlusionCuller != nullptr && !view.occlusionCuller->TestSphere(sphere, XMVectorGetW(sphere))) {
+                    visible[j] = false;
+                    continue;
+                }
+                sphereDepths[j] = XMVectorGetX(XMVector4Dot(XMVectorSetW(sphere, 1.0f), depthRow));
+                sphereRadii[j]  = XMVectorGetW(sphere);
+            }
+
+            if (view.lodSelector != nullptr) {
+                view.lodSelector->Select(blockCount, sphereDepths, sphereRadii, lods);
+            }
+
+            for (UINT j = 0; j < blockCount; ++j) {
+                const UINT i = blockBegin + j;
+                const XMFLOAT4X4 &worldMtx = transforms[i].worldMtx;
+                const float viewDepth = XMVectorGetX(XMVector4Dot(XMVectorSet(worldMtx._41, worldMtx._42, worldMtx._43, 1.0f), depthRow));
+
+                // Hidden instances keep the LOD they were last seen with
+                // 隠れているインスタンスは最後に見えた時のLODを維持する
+                RenderPass pass = RenderPass::Culled;
+                if (visible[j]) {
+                    pass = RenderPass::Opaque;
+                    if (view.storeLods) {
+                        meshes[i].lodIndex = lods[j];
+                    }
+                    chunkVisibleCount++;
+                } else {
+                    lods[j] = meshes[i].lodIndex;
+                }
+
+                RenderItem &item = items[offset + i];
+                item.sortKey       = RenderQueue::MakeSortKey(pass, meshes[i].pipelineIndex, meshes[i].materialIndex, meshes[i].meshIndex, lods[j], RenderQueue::QuantizeDepth(viewDepth));
+                item.instanceIndex = offset + i;
+                item.reserved      = 0;
+                dstInstanceMatrices[offset + i] = worldMtx;
+            }
+        }
+        visibleCount.fetch_add(chunkVisibleCount, std::memory_order_relaxed);
+    });
+
+    dstQueue->Sort(jobSystem);
+
+    return visibleCount.load();
+}
+
+// Pack the world matrices of the visible items of a queue in sorted order
+// キューの可視の要素のWorld変換行列をソート順に詰める
+UINT Scene::PackInstanceMatrices(const RenderQueue &queue, UINT visibleCount, const XMFLOAT4X4 *instanceMatrices, UINT capacity, XMFLOAT4X4 *dstMatrices) {
+    const RenderItem *items = queue.GetItems();
+    const UINT count = std::min(visibleCount, capacity);
+    for (UINT i = 0; i < count; ++i) {
+        dstMatrices[i] = instanceMatrices[items[i].instanceIndex];
+    }
+    return count;
+}
+
+// Save the triangle and camera actors of the scene to a snapshot file
+// シーンの三角形とカメラのアクタをスナップショットファイルへ保存
+bool Scene::SaveSnapshot(const char *path) {
+    const auto &triangleActors = SceneProxyRegistry::GetActorList<TriangleSceneActor>(actorLists);
+    const auto &cameraActors   = SceneProxyRegistry::GetActorList<CameraSceneActor>(actorLists);
+
+    // Mark the nodes of the saved actors, nodes of other actors are not saved
+    // 保存するアクタのノードに印を付ける、他のアクタのノードは保存しない
+    UINT handleCount = 0;
+    for (auto actor : sceneActors) {
+        handleCount = std::max(handleCount, actor->transformNode + 1);
+    }
+    std::vector<UINT> nodeToPosition(handleCount, INVALID_SCENE_SNAPSHOT_INDEX);
+    for (auto actor : triangleActors) {
+        nodeToPosition[actor->transformNode] = 0;
+    }
+    for (auto actor : cameraActors) {
+        nodeToPosition[actor->transformNode] = 0;
+    }
+
+    // Walk the hierarchy in its parent-before-child order, which the saved nodes keep, the parent of each is its
+    // nearest saved ancestor, as DestroyNode attaches the children to the parent
+    // 階層をその親が子より前に並ぶ順で走査し、保存するノードはその順を保つ。各ノードの親は最も近い保存する祖先と
+    // なる、DestroyNodeが子を親へ付け替えるのと同様
+    const UINT hierarchyNodeCount = transformHierarchy.GetNodeCount();
+    const UINT *parentIndices = transformHierarchy.GetParentIndices();
+    std::vector<UINT> indexToPosition(hierarchyNodeCount);
+    std::vector<UINT> nodeParents;
+    nodeParents.reserve(triangleActors.size() + cameraActors.size());
+    for (UINT index = 0; index < hierarchyNodeCount; ++index) {
+        const UINT parentPosition = (parentIndices[index] != INVALID_TRANSFORM_NODE) ? indexToPosition[parentIndices[index]] : INVALID_SCENE_SNAPSHOT_INDEX;
+        const UINT handle = transformHierarchy.GetNodeHandle(index);
+        if (handleCount <= handle || nodeToPosition[handle] == INVALID_SCENE_SNAPSHOT_INDEX) {
+            indexToPosition[index] = parentPosition;
+            continue;
+        }
+
+        indexToPosition[index]  = static_cast<UINT>(nodeParents.size());
+        nodeToPosition[handle]  = static_cast<UINT>(nodeParents.size());
+        nodeParents.push_back(parentPosition);
+    }
+
+    // Children come after their parent, so one backward pass sums the subtree sizes
+    // 子は親の後に並ぶ為、1回の逆順の走査でサブツリーのサイズを合計する
+    std::vector<UINT> nodeSubtreeSizes(nodeParents.size(), 1);
+    for (size_t position = nodeParents.size(); 0 < position--; ) {
+        if (nodeParents[position] != INVALID_SCENE_SNAPSHOT_INDEX) {
+            nodeSubtreeSizes[nodeParents[position]] += nodeSubtreeSizes[position];
+        }
+    }
+
+    SnapshotActorArrays triangleArrays;
+    std::vector<SceneSnapshotMotion> triangleMotions(triangleActors.size());
+    GatherSnapshotActors(triangleActors, nodeToPosition, &triangleArrays);
+    for (size_t i = 0; i < triangleActors.size(); ++i) {
+        const TriangleSceneActor *actor = triangleActors[i];
+        triangleMotions[i].rotSpeed   = actor->rotSpeed;
+        triangleMotions[i].scaleSpeed = actor->scaleSpeed;
+        triangleMotions[i].rotAngle   = actor->rotAngle;
+        triangleMotions[i].scaleAngle = actor->scaleAngle;
+        if (actor->occluder) {
+            triangleArrays.ticks[i].flags |= SCENE_SNAPSHOT_FLAG_OCCLUDER;
+        }
+    }
+
+    SnapshotActorArrays cameraArrays;
+    std::vector<SceneSnapshotView> cameraViews(cameraActors.size());
+    GatherSnapshotActors(cameraActors, nodeToPosition, &cameraArrays);
+    for (size_t i = 0; i < cameraActors.size(); ++i) {
+        const CameraSceneActor *actor = cameraActors[i];
+        cameraViews[i].viewportRect = actor->viewportRect;
+        cameraViews[i].screenWidth  = actor->screenWidth;
+        cameraViews[i].screenHeight = actor->screenHeight;
+        cameraViews[i].fovInDeg     = actor->fovInDeg;
+        cameraViews[i].reserved     = 0;
+    }
+
+    SceneSnapshotWriter writer;
+    SetSnapshotActorArrays(triangleArrays, SceneSnapshotActorType::Triangle, &writer);
+    writer.SetArray(SceneSnapshotActorType::Triangle, SceneSnapshotField::Params, triangleMotions.data());
+    SetSnapshotActorArrays(cameraArrays, SceneSnapshotActorType::Camera, &writer);
+    writer.SetArray(SceneSnapshotActorType::Camera, SceneSnapshotField::Params, cameraViews.data());
+    writer.SetHierarchy(nodeParents.data(), nodeSubtreeSizes.data());
+    return writer.SaveToFile(path);
+}
+
+// Add the actors of a snapshot file to the scene
+// スナップショットファイルのアクタをシーンへ追加
+bool Scene::LoadSnapshot(const char *path, JobSystem *jobSystem) {
+    SceneSnapshot snapshot;
+    if (!snapshot.LoadFromFile(path)) {
+        return false;
+    }
+
+    // Every node belongs to exactly one actor
+    // 全ノードはちょうど1つのアクタに属する
+    const UINT nodeCount = snapshot.GetNodeCount();
+    std::vector<bool> nodeUsed(nodeCount, false);
+    for (auto type : { SceneSnapshotActorType::Triangle, SceneSnapshotActorType::Camera }) {
+        const auto actorNodes = snapshot.GetArray<UINT>(type, SceneSnapshotField::Node);
+        for (UINT i = 0; i < snapshot.GetActorCount(type); ++i) {
+            if (nodeCount <= actorNodes[i] || nodeUsed[actorNodes[i]]) {
+                return false;
+            }
+            nodeUsed[actorNodes[i]] = true;
+        }
+    }
+
+    // The nodes are already in the order of the hierarchy, they are created at once with their parents
+    // ノードは既に階層の順序で並ぶ為、親と共に一括で生成する
+    std::vector<UINT> nodes(nodeCount);
+    if (!transformHierarchy.CreateNodes(nodeCount, snapshot.GetHierarchyArray(SceneSnapshotHierarchyField::Parent), snapshot.GetHierarchyArray(SceneSnapshotHierarchyField::SubtreeSize), nodes.data())) {
+        return false;
+    }
+
+    // Construct and register each actor straight from the mapped arrays in one pass, nothing is default
+    // constructed and overwritten
+    // 各アクタはマッピングした配列から1パスで直接構築して登録し、デフォルト構築後の上書きはしない
+    const auto triangleTicks   = snapshot.GetArray<SceneSnapshotTick>(SceneSnapshotActorType::Triangle, SceneSnapshotField::Tick);
+    const auto triangleMotions = snapshot.GetArray<SceneSnapshotMotion>(SceneSnapshotActorType::Triangle, SceneSnapshotField::Params);
+    auto triangleActors = BuildSnapshotActors<TriangleSceneActor>(snapshot, SceneSnapshotActorType::Triangle, nodes, jobSystem, [&](TriangleSceneActor &actor, UINT i) {
+        actor.rotSpeed   = triangleMotions[i].rotSpeed;
+        actor.scaleSpeed = triangleMotions[i].scaleSpeed;
+        actor.rotAngle   = triangleMotions[i].rotAngle;
+        actor.scaleAngle = triangleMotions[i].scaleAngle;
+        actor.occluder   = (triangleTicks[i].flags & SCENE_SNAPSHOT_FLAG_OCCLUDER) != 0;
+    });
+
+    const auto cameraViews = snapshot.GetArray<SceneSnapshotView>(SceneSnapshotActorType::Camera, SceneSnapshotField::Params);
+    auto cameraActors = BuildSnapshotActors<CameraSceneActor>(snapshot, SceneSnapshotActorType::Camera, nodes, jobSystem, [&](CameraSceneActor &actor, UINT i) {
+        actor.Init(cameraViews[i].screenWidth, cameraViews[i].screenHeight, cameraViews[i].fovInDeg);
+        actor.viewportRect = cameraViews[i].viewportRect;
+    });
+
+    snapshotTriangleActors.push_back(std::move(triangleActors));
+    snapshotCameraActors.push_back(std::move(cameraActors));
+
+    return true;
+}
+
+// Construct and add the actors of a type in place from the arrays of a snapshot
+// スナップショットの配列から種別のアクタをその場で構築し追加
+template<typename ActorT, typename InitFuncT>
+SceneActorBlock<ActorT> Scene::BuildSnapshotActors(const SceneSnapshot &snapshot, SceneSnapshotActorType type, const std::vector<UINT> &nodes, JobSystem *jobSystem, InitFuncT initFunc) {
+    const UINT count = snapshot.GetActorCount(type);
+    SceneActorBlock<ActorT> actors(static_cast<ActorT *>(::operator new[](sizeof(ActorT) * std::max(count, 1u), std::align_val_t(alignof(ActorT)))), SceneActorBlockDeleter<ActorT>{ count });
+
+    // The nodes and the list slots are made first, so each actor is registered by the pass building it
+    // ノードとリストのスロットを先に作る為、各アクタはそれを構築するパスで登録される
+    auto &actorList = SceneProxyRegistry::GetActorList<ActorT>(actorLists);
+    const size_t firstSceneActor = sceneActors.size();
+    const size_t firstListActor  = actorList.size();
+    sceneActors.resize(firstSceneActor + count);
+    actorList.resize(firstListActor + count);
+    const UINT firstTickSlot = tickScheduler.AddSlots(count);
+
+    const auto translations = snapshot.GetArray<XMFLOAT4>(type, SceneSnapshotField::Translation);
+    const auto rotations    = snapshot.GetArray<XMFLOAT4>(type, SceneSnapshotField::Rotation);
+    const auto scales       = snapshot.GetArray<XMFLOAT4>(type, SceneSnapshotField::Scale);
+    const auto ticks        = snapshot.GetArray<SceneSnapshotTick>(type, SceneSnapshotField::Tick);
+    const auto actorNodes   = snapshot.GetArray<UINT>(type, SceneSnapshotField::Node);
+    auto buildBatch = [&](UINT begin, UINT end) {
+        for (UINT i = begin; i < end; ++i) {
+            ActorT &actor = *new (&actors[i]) ActorT();
+            actor.translation = XMLoadFloat4(&translations[i]);
+            actor.rotation    = XMLoadFloat4(&rotations[i]);
+            actor.scale       = XMLoadFloat4(&scales[i]);
+            actor.SetTickGroup(static_cast<TickGroup>(std::min(ticks[i].tickGroup, TICK_GROUP_COUNT - 1)));
+            actor.SetTickInterval(ticks[i].tickInterval);
+            actor.SetTickDistanceStep(ticks[i].tickDistanceStep);
+            if ((ticks[i].flags & SCENE_SNAPSHOT_FLAG_SLEEPING) != 0) {
+                actor.Sleep();
+            }
+            initFunc(actor, i);
+
+            actor.transformNode = nodes[actorNodes[i]];
+            sceneActors[firstSceneActor + i] = &actor;
+            actorList[firstListActor + i]    = &actor;
+            tickScheduler.RegisterAt(firstTickSlot + i, &actor);
+        }
+    };
+
+    // The first touch of the block dominates, the jobs share it between the workers
+    // ブロックへの最初のアクセスが支配的な為、ジョブでワーカー間に分担する
+    if (jobSystem != nullptr) {
+        jobSystem->ParallelFor(count, SNAPSHOT_ACTOR_BATCH_SIZE, buildBatch);
+    } else {
+        buildBatch(0, count);
+    }
+    return actors;
+}
+
+// Reflect the bounds of the mesh proxies to the BVH
+// メッシュProxyの境界をBVHへ反映
+void Scene::UpdateProxyBVH(JobSystem *jobSystem) {
+    // New proxies are inserted, moved ones refit their leaf
+    // 新しいProxyは挿入し、移動したものは葉をリフィット
+    proxyWorld.ForEach<TransformComponent, MeshComponent>([&](UINT count, const UINT *entities, TransformComponent *transforms, MeshComponent *meshes) {
+        for (UINT i = 0; i < count; ++i) {
+            const XMVECTOR sphere = GetWorldBoundingSphere(transforms[i].worldMtx, meshes[i]);
+            const XMVECTOR radius = XMVectorSplatW(sphere);
+            const XMVECTOR boxMin = XMVectorSubtract(sphere, radius);
+            const XMVECTOR boxMax = XMVectorAdd(sphere, radius);
+            if (meshes[i].spatialProxy == INVALID_BVH_PROXY) {
+                meshes[i].spatialProxy = proxyBVH.Insert(boxMin, boxMax, entities[i]);
+            } else {
+                proxyBVH.Move(meshes[i].spatialProxy, boxMin, boxMax);
+            }
+        }
+    });
+
+    // Refits loosen the tree, rebuild it in slices once they are frequent enough
+    // リフィットでツリーが緩む為、十分な数になったら時分割で再構築
+    const BVHStats stats = proxyBVH.GetStats();
+    if (!proxyBVH.IsRebuilding() && static_cast<float>(stats.proxyCount) * DEFAULT_BVH_REBUILD_REFIT_RATIO < static_cast<float>(stats.refitCount)) {
+        proxyBVH.BeginRebuild();
+    }
+    proxyBVH.StepRebuild(jobSystem, DEFAULT_BVH_REBUILD_BUDGET_IN_MS);
+}
@@ -0,0 +1,396 @@
+/// @file Scene.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+#include "AnimationSystem.h"
+#include "BoundingVolumeHierarchy.h"
+#include "EntityWorld.h"
+#include "LodSelector.h"
+#include "OcclusionCuller.h"
+#include "RenderQueue.h"
+#include "SceneActor.h"
+#include "SceneProxyRegistry.h"
+#include "SceneSnapshot.h"
+#include "TickScheduler.h"
+#include "TransformHierarchy.h"
+
+class JobSystem;
+
+// Default value
+const size_t DEFAULT_SCENE_ACTOR_CAPACITY = 32;
+const UINT MAX_SCENE_INSTANCE_COUNT       = 510;
+const UINT SNAPSHOT_ACTOR_BATCH_SIZE      = 4096;   // Actors built from a snapshot per job
+
+
+/// @~english
+/// @brief Destroys actors built in place in one raw allocation and releases it
+/// @~japanese
+/// @brief 1回の確保内にその場で構築したアクタを破棄し解放する
+/// @~
+/// @struct SceneActorBlockDeleter
+template<typename ActorT>
+struct SceneActorBlockDeleter {
+    UINT    count;
+
+    void operator()(ActorT *actors) const {
+        for (UINT i = 0; i < count; ++i) {
+            actors[i].~ActorT();
+        }
+        ::operator delete[](actors, std::align_val_t(alignof(ActorT)));
+    }
+};
+
+template<typename ActorT>
+using SceneActorBlock = std::unique_ptr<ActorT[], SceneActorBlockDeleter<ActorT>>;
+
+
+/// @~english
+/// @brief View the render queue is built for
+/// @~japanese
+/// @brief 描画キューを構築するビュー
+/// @~
+/// @struct RenderQueueView
+struct RenderQueueView {
+    const CameraComponent  *camera;             ///< @~english Gives the view depth (nullptr for depth 0 @~japanese View空間の深度を与える（nullptrの場合は深度0
+    const UINT8            *entityViewMasks;    ///< @~english Views each entity index is inside of (nullptr to skip the test @~japanese エンティティ番号毎の視野内にあるビュー（nullptrの場合はテストしない
+    UINT8                   viewMask;           ///< @~english Bit of this view in entityViewMasks @~japanese entityViewMasks内のこのビューのビット
+    const OcclusionCuller  *occlusionCuller;    ///< @~english Rasterized occlusion buffer to test the bounds against (nullptr to skip the test @~japanese 境界をテストするラスタライズ済みのオクルージョンバッファ（nullptrの場合はテストしない
+    const LodSelector      *lodSelector;        ///< @~english Selects the LOD of the visible proxies (nullptr to keep the current LOD @~japanese 可視のProxyのLODを選択する（nullptrの場合は現在のLODを維持
+    bool                    storeLods;          ///< @~english Keep the selected LODs in the proxies for the hysteresis, set for one view only @~japanese ヒステリシスの為に選択したLODをProxyに保持する、1つのビューのみでセットする
+
+    /// @brief コンストラクタ
+    RenderQueueView()
+    : camera(nullptr)
+    , entityViewMasks(nullptr)
+    , viewMask(0)
+    , occlusionCuller(nullptr)
+    , lodSelector(nullptr)
+    , storeLods(true)
+    {
+        ;
+    }
+};
+
+static_assert(MAX_MESH_LOD_COUNT <= (1u << SORT_KEY_LOD_BITS), "Every LOD must fit in the sort key.");
+
+
+/// @class Scene
+/// @~english
+/// @brief Actors, their transform hierarchy and the proxies committed from them, the CPU side of a frame
+/// @details Holds no device object. The MTRenderer drives it from the MainThread and reads the proxies on the
+///          RenderThread, the CPU benchmark drives it alone. Update and Commit run on the calling thread and
+///          the workers of the given JobSystem.
+/// @~japanese
+/// @brief アクタ、そのトランスフォーム階層、及びそこから伝達するProxy、フレームのCPU側
+/// @details デバイスのオブジェクトは持たない。MTRendererがMainThreadから動かしRenderThreadでProxyを参照する、
+///          CPUベンチマークは単独で動かす。UpdateとCommitは呼び出し元スレッドと与えたJobSystemのワーカーで実行する
+class Scene {
+public:
+    /// @~english
+    /// @brief Add actor
+    /// @param[in] actor Pointer to actor, the type must be registered in SceneProxyRegistry
+    /// @~japanese
+    /// @brief アクタを追加
+    /// @param[in] actor アクタへのポインタ、型はSceneProxyRegistryに登録されている必要がある
+    template<typename ActorT>
+    void AddActor(ActorT *actor) {
+        if (actor == nullptr) {
+            return;
+        }
+
+        actor->transformNode = transformHierarchy.CreateNode(INVALID_TRANSFORM_NODE);
+        sceneActors.push_back(actor);
+        SceneProxyRegistry::GetActorList<ActorT>(actorLists).push_back(actor);
+        tickScheduler.Register(actor);
+    }
+
+    /// @~english
+    /// @brief Add a contiguous array of actors at once
+    /// @param[in] actors Array of actors, the type must be registered in SceneProxyRegistry
+    /// @param[in] count Number of actors
+    /// @~japanese
+    /// @brief 連続したアクタの配列を一括で追加
+    /// @param[in] actors アクタの配列、型はSceneProxyRegistryに登録されている必要がある
+    /// @param[in] count アクタ数
+    template<typename ActorT>
+    void AddActors(ActorT *actors, UINT count) {
+        if (actors == nullptr || count == 0) {
+            return;
+        }
+
+        auto &actorList = SceneProxyRegistry::GetActorList<ActorT>(actorLists);
+        sceneActors.reserve(sceneActors.size() + count);
+        actorList.reserve(actorList.size() + count);
+        tickScheduler.Reserve(sceneActors.size());
+
+        std::vector<UINT> nodes(count);
+        transformHierarchy.CreateRootNodes(count, nodes.data());
+        for (UINT i = 0; i < count; ++i) {
+            actors[i].transformNode = nodes[i];
+            sceneActors.push_back(&actors[i]);
+            actorList.push_back(&actors[i]);
+            tickScheduler.Register(&actors[i]);
+        }
+    }
+
+
+    /// @~english
+    /// @brief Make an actor tick after another one within the same frame
+    /// @param[in] actor Pointer to actor
+    /// @param[in] prerequisite Pointer to actor to tick first
+    /// @return True if succeeded, false if the prerequisite is in a later tick group or the dependency makes a cycle
+    /// @~japanese
+    /// @brief 同じフレーム内でアクタを別のアクタの後に更新させる
+    /// @param[in] actor アクタへのポインタ
+    /// @param[in] prerequisite 先に更新するアクタへのポインタ
+    /// @return 成功した場合にはTrue、前提条件が後の更新グループにあるか依存が循環する場合はFalseを返す
+    bool AddTickPrerequisite(SceneActor *actor, SceneActor *prerequisite) {
+        return tickScheduler.AddPrerequisite(actor, prerequisite);
+    }
+
+    /// @~english
+    /// @brief Play an animation clip on an actor, replacing the one playing
+    /// @details While the clip plays the local transform of the actor comes from the clip, not from
+    ///          its translation, rotation and scale.
+    /// @param[in] actor Pointer to actor
+    /// @param[in] clip Clip to play, must outlive the playback
+    /// @param[in] speed Playback speed
+    /// @param[in] loop True to loop, false to hold the last key
+    /// @return True if succeeded, false if the actor is not added or the clip is empty
+    /// @~japanese
+    /// @brief アクタにアニメーションクリップを再生、再生中のものは置き換える
+    /// @details 再生中のアクタのローカルトランスフォームは平行移動、回転、スケールではなくクリップから得る
+    /// @param[in] actor アクタへのポインタ
+    /// @param[in] clip 再生するクリップ、再生中は存在する必要がある
+    /// @param[in] speed 再生速度
+    /// @param[in] loop ループする場合はTrue、最後のキーで止める場合はFalse
+    /// @return 成功した場合にはTrue、アクタが追加されていないかクリップが空の場合はFalseを返す
+    bool PlayAnimation(SceneActor *actor, const AnimationClip *clip, float speed, bool loop);
+
+    /// @~english
+    /// @brief Stop the animation of an actor, its translation, rotation and scale apply again
+    /// @~japanese
+    /// @brief アクタのアニメーションを停止、平行移動、回転、スケールが再び適用される
+    void StopAnimation(SceneActor *actor);
+
+    /// @~english
+    /// @brief Attach an actor to a parent actor
+    /// @param[in] child Pointer to actor
+    /// @param[in] parent Pointer to parent actor (nullptr to detach
+    /// @return True if succeeded, false if the parent is the actor itself or one of its descendants
+    /// @~japanese
+    /// @brief アクタを親アクタへ接続
+    /// @param[in] child アクタへのポインタ
+    /// @param[in] parent 親アクタへのポインタ（nullptrの場合は切り離す
+    /// @return 成功した場合にはTrue、親がアクタ自身もしくはその子孫の場合はFalseを返す
+    bool AttachActor(SceneActor *child, SceneActor *parent);
+
+    /// @~english
+    /// @brief Tick the actors and compute the world matrices
+    /// @param[in] delta Time taken since the last frame (seconds
+    /// @param[in] jobSystem Job system to distribute the work to
+    /// @~japanese
+    /// @brief アクタを更新しWorld変換行列を算出
+    /// @param[in] delta 前フレームからの経過時間（秒
+    /// @param[in] jobSystem 処理を分散するJobSystem
+    void Update(float delta, JobSystem *jobSystem);
+
+    /// @~english
+    /// @brief Transfer render information from the actors to the proxies and refit the BVH
+    /// @param[in] jobSystem Job system the BVH rebuild steps run on
+    /// @~japanese
+    /// @brief アクタからProxyへ描画情報を伝達しBVHをリフィット
+    /// @param[in] jobSystem BVHの再構築ステップを実行するJobSystem
+    void Commit(JobSystem *jobSystem);
+
+    /// @~english
+    /// @brief Save the triangle and camera actors to a snapshot file
+    /// @param[in] path Path of the file
+    /// @return True if succeeded, false if the file can not be written
+    /// @~japanese
+    /// @brief 三角形とカメラのアクタをスナップショットファイルへ保存
+    /// @param[in] path ファイルのパス
+    /// @return 成功した場合にはTrue、ファイルに書き込めない場合はFalseを返す
+    bool SaveSnapshot(const char *path);
+
+    /// @~english
+    /// @brief Add the actors of a snapshot file
+    /// @details Each actor is constructed in place from the mapped arrays, in one pass over one raw
+    ///          allocation per type, split into SNAPSHOT_ACTOR_BATCH_SIZE jobs. The nodes are created at once
+    ///          in the parent-before-child order of the file, no subtree is moved.
+    /// @param[in] path Path of the file
+    /// @param[in] jobSystem Job system to build the actors on (nullptr to build them on the calling thread
+    /// @return True if succeeded, false if the file does not exist, its layout differs or its hierarchy is not in order
+    /// @~japanese
+    /// @brief スナップショットファイルのアクタを追加
+    /// @details 各アクタはマッピングした配列からその場で構築する、種別毎に1回の確保に対する1パスで、
+    ///          SNAPSHOT_ACTOR_BATCH_SIZE毎のジョブに分割する。ノードはファイルの親が子より前に並ぶ順で
+    ///          一括で生成し、サブツリーは移動しない
+    /// @param[in] path ファイルのパス
+    /// @param[in] jobSystem アクタを構築するJobSystem（nullptrの場合は呼び出し元スレッドで構築
+    /// @return 成功した場合にはTrue、ファイルが存在しないかレイアウトが異なるか階層が順序通りでない場合はFalseを返す
+    bool LoadSnapshot(const char *path, JobSystem *jobSystem = nullptr);
+
+    /// @~english
+    /// @brief Release the proxies and the BVH, the actors stay owned by their owners
+    /// @~japanese
+    /// @brief ProxyとBVHを解放、アクタはその所有者が持ち続ける
+    void Clear();
+
+    /// @~english
+    /// @brief Reserve the actor list
+    /// @~japanese
+    /// @brief アクタリストを予約
+    void Reserve(size_t capacity) {
+        sceneActors.reserve(capacity);
+    }
+
+    size_t GetActorCount() const {
+        return sceneActors.size();
+    }
+
+    const TransformHierarchy& GetTransformHierarchy() const {
+        return transformHierarchy;
+    }
+
+    const TickScheduler& GetTickScheduler() const {
+        return tickScheduler;
+    }
+
+    const AnimationSystem& GetAnimationSystem() const {
+        return animationSystem;
+    }
+
+    /// @~english
+    /// @brief Get the proxies, read by the RenderThread between two commits
+    /// @~japanese
+    /// @brief Proxyを取得、2回の伝達の間にRenderThreadが参照する
+    EntityWorld& GetProxyWorld() {
+        return proxyWorld;
+    }
+
+    /// @~english
+    /// @brief Get the bounding volume hierarchy over the mesh proxies for spatial queries
+    /// @details Updated by Commit, the user data is the proxy entity.
+    /// @~japanese
+    /// @brief 空間クエリ用のメッシュProxyに対する境界ボリューム階層を取得
+    /// @details Commitで更新する、ユーザーデータはProxyエンティティ
+    const BoundingVolumeHierarchy& GetProxyBVH() const {
+        return proxyBVH;
+    }
+
+
+    /// @~english
+    /// @brief Emit the draw requests of the mesh proxies seen from a view and sort them
+    /// @details Keys are built in parallel over the proxy chunks, then radix sorted, so opaque proxies
+    ///          sharing a state are ordered front to back. Proxies outside the view or failing the occlusion
+    ///          test are keyed with RenderPass::Culled and sorted after the visible ones. The LOD of the
+    ///          visible proxies is selected per block of LOD_SELECT_BLOCK_SIZE, stored in the MeshComponent
+    ///          and keyed next to the mesh, so each (mesh, LOD) pair forms its own instanced draw.
+    ///          Does not touch the device.
+    /// @param[in] world Entity world holding the proxies
+    /// @param[in] view View to build the queue for
+    /// @param[in] jobSystem Job system to distribute the work to (nullptr to run on the calling thread
+    /// @param[out] dstQueue Destination render queue
+    /// @param[out] dstInstanceMatrices World matrices indexed by RenderItem::instanceIndex, one per mesh proxy
+    /// @return Number of visible render items at the head of the queue
+    /// @~japanese
+    /// @brief ビューから見たメッシュProxyの描画要求を発行しソート
+    /// @details キーはProxyのチャンク毎に並列に構築した後、基数ソートするため、同じステートの
+    ///          不透明Proxyは手前から奥の順に並ぶ。視野外もしくはオクルージョンテストに失敗したProxyは
+    ///          RenderPass::Culledをキーとし、可視のものの後ろへソートされる。可視のProxyのLODは
+    ///          LOD_SELECT_BLOCK_SIZE毎のブロック単位で選択し、MeshComponentへ保存してメッシュの隣をキーと
+    ///          するため、(メッシュ, LOD)の組毎に1つのインスタンス描画となる。デバイスには触れない
+    /// @param[in] world Proxyを保持するエンティティワールド
+    /// @param[in] view キューを構築するビュー
+    /// @param[in] jobSystem 処理を分散するJobSystem（nullptrの場合は呼び出し元スレッドで実行
+    /// @param[out] dstQueue 出力先の描画キュー
+    /// @param[out] dstInstanceMatrices RenderItem::instanceIndexで参照するWorld変換行列、メッシュProxy毎に1つ
+    /// @return キュー先頭の可視の描画要求数
+    static UINT BuildRenderQueue(EntityWorld *world, const RenderQueueView &view, JobSystem *jobSystem, RenderQueue *dstQueue, DirectX::XMFLOAT4X4 *dstInstanceMatrices);
+
+    /// @~english
+    /// @brief Pack the world matrices of the visible items of a queue in sorted order
+    /// @details The nearest items of each state are kept when there are more than the capacity, the caller
+    ///          compares the result with visibleCount to tell the dropped ones.
+    /// @param[in] queue Queue built by BuildRenderQueue
+    /// @param[in] visibleCount Number of visible items at the head of the queue
+    /// @param[in] instanceMatrices World matrices written by BuildRenderQueue
+    /// @param[in] capacity Number of matrices dstMatrices holds
+    /// @param[out] dstMatrices Destination matrices, e.g. the constant buffer of the view
+    /// @return Number of packed matrices, at most capacity
+    /// @~japanese
+    /// @brief キューの可視の要素のWorld変換行列をソート順に詰める
+    /// @details 容量を超える場合は各ステートの手前の要素が残る、呼び出し元は結果をvisibleCountと比べて
+    ///          破棄されたものを知る
+    /// @param[in] queue BuildRenderQueueで構築したキュー
+    /// @param[in] visibleCount キュー先頭の可視の要素数
+    /// @param[in] instanceMatrices BuildRenderQueueが書き込んだWorld変換行列
+    /// @param[in] capacity dstMatricesが保持する行列数
+    /// @param[out] dstMatrices 出力先の行列、ビューの定数バッファなど
+    /// @return 詰めた行列数、最大でcapacity
+    static UINT PackInstanceMatrices(const RenderQueue &queue, UINT visibleCount, const DirectX::XMFLOAT4X4 *instanceMatrices, UINT capacity, DirectX::XMFLOAT4X4 *dstMatrices);
+
+    /// @~english 
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    Scene();
+
+    /// @~english
+    /// @brief Destructor
+    /// @~japanese
+    /// @brief デストラクタ
+    ~Scene();
+
+private:
+    /// @~english
+    /// @brief Refit the bounds of the mesh proxies in the BVH
+    /// @~japanese
+    /// @brief メッシュProxyの境界をBVHへ反映
+    void UpdateProxyBVH(JobSystem *jobSystem);
+
+    /// @~english
+    /// @brief Construct and add the actors of a type in place from the arrays of a snapshot
+    /// @param[in] nodes Handles of the nodes created from the hierarchy arrays, by position
+    /// @param[in] initFunc Sets the fields of the type, void(ActorT &actor, UINT index)
+    /// @~japanese
+    /// @brief スナップショットの配列から種別のアクタをその場で構築し追加
+    /// @param[in] nodes 階層の配列から生成したノードのハンドル、位置順
+    /// @param[in] initFunc 種別のフィールドをセットする、void(ActorT &actor, UINT index)
+    template<typename ActorT, typename InitFuncT>
+    SceneActorBlock<ActorT> BuildSnapshotActors(const SceneSnapshot &snapshot, SceneSnapshotActorType type, const std::vector<UINT> &nodes, JobSystem *jobSystem, InitFuncT initFunc);
+
+private:
+    TransformHierarchy          transformHierarchy;
+    TickScheduler               tickScheduler;
+    AnimationSystem             animationSystem;
+
+    /// @~english
+    /// @brief Actors built by LoadSnapshot, one block per type and file
+    /// @~japanese
+    /// @brief LoadSnapshotが構築したアクタ、種別とファイル毎に1ブロック
+    std::vector<SceneActorBlock<TriangleSceneActor>>    snapshotTriangleActors;
+    std::vector<SceneActorBlock<CameraSceneActor>>      snapshotCameraActors;
+
+    std::vector<SceneActor *>   sceneActors;
+
+    /// @~english
+    /// @brief Actors grouped by type for the batch commit
+    /// @~japanese
+    /// @brief 一括伝達の為に型毎にまとめたアクタ
+    SceneProxyRegistry::ActorLists  actorLists;
+
+    /// @~english
+    /// @brief Proxies read by the RenderThread, grouped by archetype
+    /// @~japanese
+    /// @brief RenderThreadが参照するProxy、アーキタイプ毎にまとめられている
+    EntityWorld                 proxyWorld;
+
+    /// @~english
+    /// @brief Bounds of the mesh proxies, written by Commit
+    /// @~japanese
+    /// @brief メッシュProxyの境界、Commitが書き込む
+    BoundingVolumeHierarchy     proxyBVH;
+};
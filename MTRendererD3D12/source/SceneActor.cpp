@@ -0,0 +1,188 @@
+/// @file SceneActor.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "SceneActor.h"
+
+using namespace DirectX;
+
+//----------------------------------------------------------------------------------------------------
+// SceneActor
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+SceneActor::SceneActor()
+: proxyEntity(INVALID_ENTITY)
+, transformNode(INVALID_TRANSFORM_NODE)
+, tickGroup(TickGroup::Update)
+, tickInterval(1)
+, tickDistanceStep(0.0f)
+, sleeping(false)
+, tickAccumulatedDelta(0.0f)
+, tickPhase(0)
+, tickTaskIndex(INVALID_TICK_TASK)
+, tickSearchStamp(0)
+, animationInstance(INVALID_ANIMATION_INSTANCE)
+{
+    translation = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
+    rotation    = XMVectorSet(0.0f, 0.0f, 0.0f, 0.0f);
+    scale       = XMVectorSet(1.0f, 1.0f, 1.0f, 0.0f);
+}
+
+// Destructor
+// デストラクタ
+SceneActor::~SceneActor() {
+    ;
+}
+
+//----------------------------------------------------------------------------------------------------
+// TriangleSceneActor
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+TriangleSceneActor::TriangleSceneActor()
+: SceneActor()
+, rotSpeed(1.0f)
+, scaleSpeed(1.0f)
+, rotAngle(0.0f)
+, scaleAngle(0.0f)
+, occluder(false)
+{
+    ;
+}
+
+// Destructor
+// デストラクタ
+TriangleSceneActor::~TriangleSceneActor() {
+    ;
+}
+
+// Update process
+// 更新処理
+void TriangleSceneActor::Update(float delta) {
+    // Z-axis rotaion at specified speed
+    // 指定速度でZ軸回転
+    rotAngle += 360.0f * GetRotSpeed() * delta;
+    while (360.0f < rotAngle) {
+        rotAngle -= 360.0f;
+    }
+    rotation = XMVectorSetZ(rotation, rotAngle);
+
+    // Zoom in and out at 0.5 to 2.5 times
+    // 0.5～2.5倍で拡大縮小
+    scaleAngle += 2.0f * XM_PI * GetScaleSpeed() * delta;
+    while ((2.0f * XM_PI) < scaleAngle) {
+        scaleAngle -= 2.0f * XM_PI;
+    }
+    float s = std::sin(scaleAngle) + 1.5f;
+    scale = XMVectorSet(s, s, s, 0.0f);
+}
+
+
+//----------------------------------------------------------------------------------------------------
+// CameraSceneActor
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+CameraSceneActor::CameraSceneActor()
+: SceneActor()
+, screenWidth(0)
+, screenHeight(0)
+, fovInDeg(0.0f) 
+, viewportRect(0.0f, 0.0f, 1.0f, 1.0f)
+{
+    translation = XMVectorSet(0.0f, 0.0f, -5.0f, 1.0f);
+    rotation    = XMVectorSet(0.0f, 0.0f, 0.0f, 0.0f);
+    scale       = XMVectorSet(1.0f, 1.0f, 1.0f, 0.0f);
+}
+
+// Destructor
+// デストラクタ
+CameraSceneActor::~CameraSceneActor() {
+    ;
+}
+
+// Update process
+// 更新処理
+void CameraSceneActor::Update(float delta) {
+    // The view is derived from the world matrix in CameraSceneProxy::Commit
+    // View変換はCameraSceneProxy::CommitでWorld変換行列から求める
+    ;
+}
+
+// Initialization process
+/// 初期化
+bool CameraSceneActor::Init(const UINT width, const UINT height, const float degFov) {
+    screenWidth  = width;
+    screenHeight = height;
+    fovInDeg     = degFov;
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+// TriangleSceneProxy
+//----------------------------------------------------------------------------------------------------
+// Create the proxy entity
+// Proxyエンティティを生成
+UINT TriangleSceneProxy::Create(EntityWorld *world) {
+    return world->CreateEntity<TransformComponent, MeshComponent>();
+}
+
+// Transfer render information from Actor to Proxy
+// ActorからProxyへ描画情報を伝達
+void TriangleSceneProxy::Commit(EntityWorld *world, TriangleSceneActor *actor, FXMMATRIX worldMtx) {
+    auto transform = world->GetComponent<TransformComponent>(actor->proxyEntity);
+    auto mesh      = world->GetComponent<MeshComponent>(actor->proxyEntity);
+    XMStoreFloat4x4(&transform->worldMtx, worldMtx);
+
+    mesh->occluder = actor->occluder;
+}
+
+//----------------------------------------------------------------------------------------------------
+// CameraSceneProxy
+//----------------------------------------------------------------------------------------------------
+// Create the proxy entity
+// Proxyエンティティを生成
+UINT CameraSceneProxy::Create(EntityWorld *world) {
+    return world->CreateEntity<TransformComponent, CameraComponent>();
+}
+
+// Transfer render information from Actor to Proxy
+// ActorからProxyへ描画情報を伝達
+void CameraSceneProxy::Commit(EntityWorld *world, CameraSceneActor *actor, FXMMATRIX worldMtx) {
+    auto transform = world->GetComponent<TransformComponent>(actor->proxyEntity);
+    auto camera    = world->GetComponent<CameraComponent>(actor->proxyEntity);
+    XMStoreFloat4x4(&transform->worldMtx, worldMtx);
+
+    // The viewport covers the area of the camera, in pixels
+    // ビューポートはカメラの領域をピクセル単位で覆う
+    const float screenWidth  = static_cast<float>(actor->screenWidth);
+    const float screenHeight = static_cast<float>(actor->screenHeight);
+    camera->viewport.TopLeftX = actor->viewportRect.x * screenWidth;
+    camera->viewport.TopLeftY = actor->viewportRect.y * screenHeight;
+    camera->viewport.Width    = actor->viewportRect.z * screenWidth;
+    camera->viewport.Height   = actor->viewportRect.w * screenHeight;
+    camera->viewport.MinDepth = D3D12_MIN_DEPTH;
+    camera->viewport.MaxDepth = D3D12_MAX_DEPTH;
+
+    camera->scissorRect.left   = static_cast<LONG>(camera->viewport.TopLeftX);
+    camera->scissorRect.top    = static_cast<LONG>(camera->viewport.TopLeftY);
+    camera->scissorRect.right  = static_cast<LONG>(camera->viewport.TopLeftX + camera->viewport.Width);
+    camera->scissorRect.bottom = static_cast<LONG>(camera->viewport.TopLeftY + camera->viewport.Height);
+
+    const float aspectRatio = camera->viewport.Width / camera->viewport.Height;
+    const float fovAngleY   = actor->fovInDeg * XM_PI / 180.0f;
+
+    // カメラ初期パラメータ
+    // 位置:   (0.0f, 0.0f, 0.0f)
+    // 前方向: (0.0f, 0.0f, 1.0f)
+    // 上方向: (0.0f, 1.0f, 0.0f)
+    // としてWorld変換を適用
+    XMVECTOR eyePos = worldMtx.r[3];
+    XMVECTOR dirVec = XMVector3Normalize(XMVector3TransformNormal(XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), worldMtx));
+    XMVECTOR upVec  = XMVector3Normalize(XMVector3TransformNormal(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), worldMtx));
+
+    XMStoreFloat4x4(&camera->viewMtx, XMMatrixTranspose(XMMatrixLookToLH(eyePos, dirVec, upVec)));
+    XMStoreFloat4x4(&camera->projMtx, XMMatrixTranspose(XMMatrixPerspectiveFovLH(fovAngleY, aspectRatio, 0.01f, 1000.0f)));
+}
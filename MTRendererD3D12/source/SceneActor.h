@@ -0,0 +1,464 @@
+/// @file SceneActor.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+#include "AnimationSystem.h"
+#include "BoundingVolumeHierarchy.h"
+#include "EntityWorld.h"
+#include "SceneProxyRegistry.h"
+#include "TickScheduler.h"
+#include "TransformHierarchy.h"
+
+
+/// @class SceneActor
+class SceneActor {
+friend class Scene;
+friend class TickScheduler;
+template<typename, typename> friend struct SceneProxyBinding;
+
+public:
+    /// @~english Translation component
+    /// @~japanese 平行移動成分
+    DirectX::XMVECTOR   translation;
+
+    /// @~english Rotation component
+    /// @~japanese 回転成分
+    DirectX::XMVECTOR   rotation;
+
+    /// @~english Scale component
+    /// @~japanese スケール成分
+    DirectX::XMVECTOR   scale;
+
+    /// @~english
+    /// @brief Update process
+    /// @details Called by the TickScheduler, possibly on a worker thread (see TickScheduler).
+    /// @param[in] delta Time taken since the last tick of the actor (seconds
+    /// @~japanese
+    /// @brief 更新処理
+    /// @details TickSchedulerから呼ばれ、ワーカースレッドで実行される場合がある（TickScheduler参照）
+    /// @param[in] delta アクタの前回の更新からの経過時間（秒
+    virtual void Update(float delta) = 0;
+
+    /// @~english
+    /// @brief Set the group the actor is ticked in, applied from the next frame
+    /// @details Prerequisites in a later group than the actor are ignored.
+    /// @~japanese
+    /// @brief アクタを更新するグループをセット、次のフレームから適用される
+    /// @details アクタより後のグループにある前提条件は無視される
+    void SetTickGroup(const TickGroup group) {
+        tickGroup = group;
+    }
+
+    /// @~english
+    /// @brief Get the group the actor is ticked in
+    /// @~japanese
+    /// @brief アクタを更新するグループを取得
+    TickGroup GetTickGroup() const {
+        return tickGroup;
+    }
+
+    /// @~english
+    /// @brief Set the number of frames between ticks, up to MAX_TICK_INTERVAL
+    /// @~japanese
+    /// @brief 更新の間のフレーム数をセット、MAX_TICK_INTERVALまで
+    void SetTickInterval(const UINT frames) {
+        tickInterval = std::clamp(frames, 1u, MAX_TICK_INTERVAL);
+    }
+
+    /// @~english
+    /// @brief Get the number of frames between ticks
+    /// @~japanese
+    /// @brief 更新の間のフレーム数を取得
+    UINT GetTickInterval() const {
+        return tickInterval;
+    }
+
+    /// @~english
+    /// @brief Set the distance to the view over which the tick interval grows by one frame (0 to disable
+    /// @~japanese
+    /// @brief 更新間隔が1フレーム伸びるビューとの距離をセット（0の場合は無効
+    void SetTickDistanceStep(const float distance) {
+        tickDistanceStep = std::max(distance, 0.0f);
+    }
+
+    /// @~english
+    /// @brief Get the distance to the view over which the tick interval grows by one frame
+    /// @~japanese
+    /// @brief 更新間隔が1フレーム伸びるビューとの距離を取得
+    float GetTickDistanceStep() const {
+        return tickDistanceStep;
+    }
+
+    /// @~english
+    /// @brief Stop ticking the actor, no time is accumulated while sleeping
+    /// @~japanese
+    /// @brief アクタの更新を停止、スリープ中は時間を蓄積しない
+    void Sleep() {
+        sleeping = true;
+    }
+
+    /// @~english
+    /// @brief Resume ticking the actor from the next frame
+    /// @~japanese
+    /// @brief 次のフレームからアクタの更新を再開
+    void Wake() {
+        sleeping             = false;
+        tickAccumulatedDelta = 0.0f;
+    }
+
+    /// @~english
+    /// @brief Get whether the actor is sleeping
+    /// @~japanese
+    /// @brief アクタがスリープ中かどうかを取得
+    bool IsSleeping() const {
+        return sleeping;
+    }
+
+    /// @~english
+    /// @brief Get the node in the transform hierarchy
+    /// @return Handle of the node
+    /// @~japanese
+    /// @brief トランスフォーム階層のノードを取得
+    /// @return ノードのハンドル
+    UINT GetTransformNode() const {
+        return transformNode;
+    }
+
+    /// @~english
+    /// @brief Get the proxy entity
+    /// @return Entity id
+    /// @~japanese
+    /// @brief Proxyエンティティを取得
+    /// @return エンティティID
+    UINT GetProxyEntity() const {
+        return proxyEntity;
+    }
+
+    /// @~english 
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    SceneActor();
+
+    /// @~english
+    /// @brief Destructor
+    /// @~japanese
+    /// @brief デストラクタ
+    virtual ~SceneActor();
+
+protected:
+    /// @~english Proxy entity
+    /// @~japanese Proxyエンティティ
+    UINT                proxyEntity;
+
+    /// @~english Node in the transform hierarchy
+    /// @~japanese トランスフォーム階層のノード
+    UINT                transformNode;
+
+    /// @~english Tick settings
+    /// @~japanese 更新設定
+    TickGroup           tickGroup;
+    UINT                tickInterval;
+    float               tickDistanceStep;
+    bool                sleeping;
+
+    /// @~english State of the TickScheduler
+    /// @~japanese TickSchedulerの状態
+    float                       tickAccumulatedDelta;
+    UINT                        tickPhase;      ///< @~english Spreads the actors sharing an interval over the frames @~japanese 同じ間隔のアクタをフレームに分散する
+    UINT                        tickTaskIndex;  ///< @~english Index in the group this frame, INVALID_TICK_TASK if not ticked @~japanese 今フレームのグループ内の番号、更新しない場合はINVALID_TICK_TASK
+    std::vector<SceneActor *>   tickPrerequisites;
+    UINT64                      tickSearchStamp;    ///< @~english Last prerequisite search that visited the actor @~japanese アクタを訪問した最後の前提条件の探索
+
+    /// @~english Instance in the AnimationSystem, which then owns the local transform
+    /// @~japanese AnimationSystemのインスタンス、再生中はAnimationSystemがローカルトランスフォームを持つ
+    UINT                animationInstance;
+};
+
+/// @class TriangleSceneActor
+class TriangleSceneActor : public SceneActor {
+friend class Scene;
+friend class TriangleSceneProxy;
+
+public:
+    /// @~english
+    /// @brief Update process
+    /// @param[in] delta Time taken between frames (seconds
+    /// @~japanese
+    /// @brief 更新処理
+    /// @param[in] delta フレーム間に掛かった時間（秒
+    virtual void Update(float delta) override;
+
+    /// @~english
+    /// @brief Set the speed at which the rotation is updated
+    /// @~japanese
+    /// @brief 回転を更新する速度をセット
+    void SetRotSpeed(const float newSpeed) {
+        rotSpeed = newSpeed;
+    }
+
+    /// @~english
+    /// @brief Get the speed at which the rotation is updated
+    /// @return Rotation speed
+    /// @~japanese
+    /// @brief 回転を更新する速度を取得
+    /// @return 回転速度
+    float GetRotSpeed() const {
+        return rotSpeed;
+    }
+
+    /// @~english
+    /// @brief Set the speed at which the scale is updated
+    /// @~japanese
+    /// @brief スケールを更新する速度をセット
+    void SetScaleSpeed(const float newSpeed) {
+        scaleSpeed = newSpeed;
+    }
+
+    /// @~english
+    /// @brief Get the speed at which the scale is updated
+    /// @return Scale speed
+    /// @~japanese
+    /// @brief スケールを更新する速度を取得
+    /// @return スケール速度
+    float GetScaleSpeed() const {
+        return scaleSpeed;
+    }
+
+    /// @~english
+    /// @brief Set whether the actor hides the actors behind it in the occlusion culling
+    /// @~japanese
+    /// @brief オクルージョンカリングで背後のアクタを隠す遮蔽物とするかセット
+    void SetOccluder(const bool enable) {
+        occluder = enable;
+    }
+
+    /// @~english
+    /// @brief Get whether the actor is an occluder
+    /// @return True if the actor is an occluder
+    /// @~japanese
+    /// @brief 遮蔽物かどうかを取得
+    /// @return 遮蔽物の場合はTrue
+    bool IsOccluder() const {
+        return occluder;
+    }
+    
+    /// @~english 
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    TriangleSceneActor();
+
+    /// @~english
+    /// @brief Destructor
+    /// @~japanese
+    /// @brief デストラクタ
+    virtual ~TriangleSceneActor();
+
+protected:
+    float   rotSpeed;
+    float   scaleSpeed;
+
+    float rotAngle;
+    float scaleAngle;
+
+    bool    occluder;
+};
+
+/// @class CameraSceneActor
+class CameraSceneActor : public SceneActor {
+friend class Scene;
+friend class CameraSceneProxy;
+
+public:
+    /// @~english
+    /// @brief Update process
+    /// @param[in] delta Time taken between frames (seconds
+    /// @~japanese
+    /// @brief 更新処理
+    /// @param[in] delta フレーム間に掛かった時間（秒
+    virtual void Update(float delta) override;
+
+    /// @~english
+    /// @brief Initialize
+    /// @param[in] width  Screen width
+    /// @param[in] height Screen height
+    /// @param[in] defFov Field of view in Degree
+    /// @return True if initialization succeeded, false otherwise
+    /// @~japanese
+    /// @brief 初期化
+    /// @param[in] width  スクリーン幅
+    /// @param[in] height スクリーン高さ
+    /// @param[in] defFov 視野角（角度
+    /// @return 初期化に成功した場合にはTrue、そうでないならFalseを返す
+    bool Init(const UINT width, const UINT height, const float degFov);
+
+    /// @~english
+    /// @brief Set the area of the screen the camera draws to, for split screen and picture in picture
+    /// @details Given in fractions of the screen. Cameras are drawn in the order they were added, each
+    ///          clearing the depth of its own area, so later cameras are drawn over earlier ones.
+    /// @param[in] x Left edge
+    /// @param[in] y Top edge
+    /// @param[in] width Width
+    /// @param[in] height Height
+    /// @~japanese
+    /// @brief カメラが描画するスクリーンの領域をセット、画面分割やピクチャーインピクチャー向け
+    /// @details スクリーンに対する割合で指定する。カメラは追加した順に描画し、各々が自身の領域の深度を
+    ///          クリアする為、後のカメラは前のカメラの上に描画される
+    /// @param[in] x 左端
+    /// @param[in] y 上端
+    /// @param[in] width 幅
+    /// @param[in] height 高さ
+    void SetViewportRect(const float x, const float y, const float width, const float height) {
+        viewportRect = DirectX::XMFLOAT4(x, y, width, height);
+    }
+
+    /// @~english 
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    CameraSceneActor();
+
+    /// @~english
+    /// @brief Destructor
+    /// @~japanese
+    /// @brief デストラクタ
+    ~CameraSceneActor();
+
+protected:
+    UINT                screenWidth;
+    UINT                screenHeight;
+    float               fovInDeg;
+    DirectX::XMFLOAT4   viewportRect;   ///< @~english Left, top, width and height in fractions of the screen @~japanese スクリーンに対する割合での左端、上端、幅、高さ
+};
+
+
+/// @~english
+/// @brief World transformation of a proxy
+/// @~japanese
+/// @brief ProxyのWorld変換
+/// @~
+/// @struct TransformComponent
+struct TransformComponent {
+    DirectX::XMFLOAT4X4 worldMtx;
+
+    /// @brief コンストラクタ
+    TransformComponent() {
+        XMStoreFloat4x4(&worldMtx, DirectX::XMMatrixIdentity());
+    }
+};
+
+/// @~english
+/// @brief Camera parameters of a proxy
+/// @~japanese
+/// @brief Proxyのカメラパラメータ
+/// @~
+/// @struct CameraComponent
+struct CameraComponent {
+    D3D12_VIEWPORT      viewport;
+    D3D12_RECT          scissorRect;
+    DirectX::XMFLOAT4X4 viewMtx;    ///< @~english Transposed @~japanese 転置済み
+    DirectX::XMFLOAT4X4 projMtx;    ///< @~english Transposed @~japanese 転置済み
+
+    /// @brief コンストラクタ
+    CameraComponent()
+    : viewport()
+    , scissorRect()
+    {
+        XMStoreFloat4x4(&viewMtx, DirectX::XMMatrixIdentity());
+        XMStoreFloat4x4(&projMtx, DirectX::XMMatrixIdentity());
+    }
+};
+
+/// @~english
+/// @brief Mesh drawn by a proxy
+/// @~japanese
+/// @brief Proxyが描画するメッシュ
+/// @~
+/// @struct MeshComponent
+struct MeshComponent {
+    UINT                meshIndex;
+    UINT                pipelineIndex;
+    UINT                materialIndex;
+    DirectX::XMFLOAT4   boundingSphere; ///< @~english Local center (xyz) and radius (w) @~japanese ローカル空間の中心（xyz）と半径（w）
+    bool                occluder;       ///< @~english Rasterized into the occlusion buffer @~japanese オクルージョンバッファへラスタライズする
+    UINT                spatialProxy;   ///< @~english Proxy in the scene BVH @~japanese シーンBVH内のProxy
+    UINT                lodIndex;       ///< @~english LOD selected when last visible @~japanese 最後に可視だった時に選択したLOD
+
+    /// @brief コンストラクタ
+    MeshComponent()
+    : meshIndex(0)
+    , pipelineIndex(0)
+    , materialIndex(0)
+    , boundingSphere(0.0f, 0.0f, 0.0f, 1.0f)
+    , occluder(false)
+    , spatialProxy(INVALID_BVH_PROXY)
+    , lodIndex(0)
+    {
+        ;
+    }
+};
+
+
+/// @class TriangleSceneProxy
+class TriangleSceneProxy {
+public:
+    /// @~english
+    /// @brief Create the proxy entity
+    /// @param[in] world Entity world holding the proxies
+    /// @return Entity id, INVALID_ENTITY if it could not be created
+    /// @~japanese
+    /// @brief Proxyエンティティを生成
+    /// @param[in] world Proxyを保持するエンティティワールド
+    /// @return エンティティID、生成できなかった場合はINVALID_ENTITY
+    static UINT Create(EntityWorld *world);
+
+    /// @~english
+    /// @brief Transfer render information from Actor to Proxy
+    /// @param[in] world Entity world holding the proxies
+    /// @param[in] actor Pointer to actor
+    /// @param[in] worldMtx World transformation matrix computed by the transform hierarchy
+    /// @~japanese
+    /// @brief ActorからProxyへ描画情報を伝達
+    /// @param[in] world Proxyを保持するエンティティワールド
+    /// @param[in] actor アクタへのポインタ
+    /// @param[in] worldMtx トランスフォーム階層で算出したWorld変換行列
+    static void Commit(EntityWorld *world, TriangleSceneActor *actor, DirectX::FXMMATRIX worldMtx);
+};
+
+/// @class CameraSceneProxy
+class CameraSceneProxy {
+public:
+    /// @~english
+    /// @brief Create the proxy entity
+    /// @param[in] world Entity world holding the proxies
+    /// @return Entity id, INVALID_ENTITY if it could not be created
+    /// @~japanese
+    /// @brief Proxyエンティティを生成
+    /// @param[in] world Proxyを保持するエンティティワールド
+    /// @return エンティティID、生成できなかった場合はINVALID_ENTITY
+    static UINT Create(EntityWorld *world);
+
+    /// @~english
+    /// @brief Transfer render information from Actor to Proxy
+    /// @param[in] world Entity world holding the proxies
+    /// @param[in] actor Pointer to actor
+    /// @param[in] worldMtx World transformation matrix computed by the transform hierarchy
+    /// @~japanese
+    /// @brief ActorからProxyへ描画情報を伝達
+    /// @param[in] world Proxyを保持するエンティティワールド
+    /// @param[in] actor アクタへのポインタ
+    /// @param[in] worldMtx トランスフォーム階層で算出したWorld変換行列
+    static void Commit(EntityWorld *world, CameraSceneActor *actor, DirectX::FXMMATRIX worldMtx);
+};
+
+
+/// @~english
+/// @brief Actor types drawn by the renderer and their proxy types
+/// @~japanese
+/// @brief レンダラーが描画するアクタ型とそのProxy型
+using SceneProxyRegistry = SceneProxyTypeList<
+    SceneProxyBinding<CameraSceneActor,   CameraSceneProxy>,
+    SceneProxyBinding<TriangleSceneActor, TriangleSceneProxy>
+>;
@@ -0,0 +1,225 @@
+/// @file SceneFeed.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "SceneFeed.h"
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+//----------------------------------------------------------------------------------------------------
+// SceneFeed
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+SceneFeed::SceneFeed()
+: header(nullptr)
+, records(nullptr)
+, capacity(0)
+, mask(0)
+, actorCapacity(0)
+, mappingSize(0)
+, created(false)
+#if defined(_WIN32)
+, mappingHandle(nullptr)
+#endif
+{
+    ;
+}
+
+// Destructor
+// デストラクタ
+SceneFeed::~SceneFeed() {
+    Close();
+}
+
+// Create the shared memory and initialize the ring
+// 共有メモリを生成しリングを初期化
+bool SceneFeed::Create(const char *name, UINT recordCapacity, UINT feedActorCapacity) {
+    if (header != nullptr || recordCapacity == 0 || (recordCapacity & (recordCapacity - 1)) != 0) {
+        return false;
+    }
+    if (!Map(name, GetMappingSize(recordCapacity), true)) {
+        return false;
+    }
+    created       = true;
+    capacity      = recordCapacity;
+    mask          = recordCapacity - 1;
+    actorCapacity = feedActorCapacity;
+
+    // The header is published last, so a process opening the feed early finds no magic and fails
+    // ヘッダは最後に公開する為、早く開いたプロセスはマジックを見つけられず失敗する
+    header->version       = SCENE_FEED_VERSION;
+    header->recordSize    = sizeof(SceneFeedRecord);
+    header->capacity      = capacity;
+    header->actorCapacity = actorCapacity;
+    header->writePosition.store(0, std::memory_order_relaxed);
+    header->droppedCount.store(0, std::memory_order_relaxed);
+    header->readPosition.store(0, std::memory_order_relaxed);
+    header->magic.store(SCENE_FEED_MAGIC, std::memory_order_release);
+    return true;
+}
+
+// Open shared memory created by the other process
+// 他方のプロセスが生成した共有メモリを開く
+bool SceneFeed::Open(const char *name) {
+    if (header != nullptr) {
+        return false;
+    }
+    if (!Map(name, 0, false)) {
+        return false;
+    }
+
+    const bool valid =
+        header->magic.load(std::memory_order_acquire) == SCENE_FEED_MAGIC &&
+        header->version == SCENE_FEED_VERSION &&
+        header->recordSize == sizeof(SceneFeedRecord) &&
+        header->capacity != 0 && (header->capacity & (header->capacity - 1)) == 0 &&
+        GetMappingSize(header->capacity) <= mappingSize;
+    if (!valid) {
+        Close();
+        return false;
+    }
+
+    // The consumer only trusts the layout checked here
+    // 消費者はここで確認したレイアウトのみを信頼する
+    capacity      = header->capacity;
+    mask          = capacity - 1;
+    actorCapacity = header->actorCapacity;
+    return true;
+}
+
+// Write records and publish them at once
+// レコードを書き込み一括で公開
+UINT SceneFeed::Publish(const SceneFeedRecord *srcRecords, UINT count) {
+    if (header == nullptr) {
+        return 0;
+    }
+
+    const UINT64 position  = header->writePosition.load(std::memory_order_relaxed);
+    const UINT64 freeCount = capacity - std::min<UINT64>(position - header->readPosition.load(std::memory_order_acquire), capacity);
+    const UINT   writeCount = static_cast<UINT>(std::min<UINT64>(count, freeCount));
+    for (UINT i = 0; i < writeCount; ++i) {
+        records[(position + i) & mask] = srcRecords[i];
+    }
+
+    // Publish the records only once they are written
+    // レコードは書き込み後に公開する
+    header->writePosition.store(position + writeCount, std::memory_order_release);
+    if (writeCount < count) {
+        header->droppedCount.fetch_add(count - writeCount, std::memory_order_relaxed);
+    }
+    return writeCount;
+}
+
+#if defined(_WIN32)
+// Map the shared memory
+// 共有メモリをマッピング
+bool SceneFeed::Map(const char *name, size_t size, bool create) {
+    if (create) {
+        mappingHandle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<UINT64>(size) >> 32), static_cast<DWORD>(size), name);
+        if (mappingHandle != nullptr && GetLastError() == ERROR_ALREADY_EXISTS) {
+            CloseHandle(mappingHandle);
+            mappingHandle = nullptr;
+        }
+    } else {
+        mappingHandle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name);
+    }
+    if (mappingHandle == nullptr) {
+        return false;
+    }
+
+    void *view = MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (view == nullptr) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+        return false;
+    }
+
+    // The view of an opened mapping covers all of it
+    // 開いたマッピングのビューは全体を覆う
+    if (size == 0) {
+        MEMORY_BASIC_INFORMATION info;
+        VirtualQuery(view, &info, sizeof(info));
+        size = info.RegionSize;
+    }
+
+    header      = static_cast<SceneFeedHeader *>(view);
+    records     = reinterpret_cast<SceneFeedRecord *>(header + 1);
+    mappingSize = size;
+    mappingName = name;
+    return true;
+}
+
+// Unmap the shared memory
+// 共有メモリのマッピングを解除
+void SceneFeed::Close() {
+    if (header != nullptr) {
+        UnmapViewOfFile(header);
+    }
+    if (mappingHandle != nullptr) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    header        = nullptr;
+    records       = nullptr;
+    capacity      = 0;
+    mask          = 0;
+    actorCapacity = 0;
+    mappingSize   = 0;
+    created       = false;
+    mappingName.clear();
+}
+#else
+// Map the shared memory
+// 共有メモリをマッピング
+bool SceneFeed::Map(const char *name, size_t size, bool create) {
+    const std::string shmName = std::string("/") + name;
+    const int fd = shm_open(shmName.c_str(), create ? (O_RDWR | O_CREAT | O_EXCL) : O_RDWR, 0600);
+    if (fd < 0) {
+        return false;
+    }
+
+    bool mapped = false;
+    struct stat fileStat;
+    if (create ? (ftruncate(fd, static_cast<off_t>(size)) == 0) : (fstat(fd, &fileStat) == 0 && (size = static_cast<size_t>(fileStat.st_size)) != 0)) {
+        void *view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (view != MAP_FAILED) {
+            header      = static_cast<SceneFeedHeader *>(view);
+            records     = reinterpret_cast<SceneFeedRecord *>(header + 1);
+            mappingSize = size;
+            mappingName = shmName;
+            mapped      = true;
+        }
+    }
+    close(fd);
+
+    if (!mapped && create) {
+        shm_unlink(shmName.c_str());
+    }
+    return mapped;
+}
+
+// Unmap the shared memory
+// 共有メモリのマッピングを解除
+void SceneFeed::Close() {
+    if (header != nullptr) {
+        munmap(header, mappingSize);
+    }
+    if (created) {
+        shm_unlink(mappingName.c_str());
+    }
+    header        = nullptr;
+    records       = nullptr;
+    capacity      = 0;
+    mask          = 0;
+    actorCapacity = 0;
+    mappingSize   = 0;
+    created       = false;
+    mappingName.clear();
+}
+#endif
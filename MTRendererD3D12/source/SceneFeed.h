@@ -0,0 +1,256 @@
+/// @file SceneFeed.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+// Default value
+const UINT   SCENE_FEED_MAGIC                   = 0x4653544Du;  // "MTSF"
+const UINT   SCENE_FEED_VERSION                 = 1;
+const UINT   DEFAULT_SCENE_FEED_CAPACITY        = 65536;        // Power of two
+const UINT   DEFAULT_SCENE_FEED_ACTOR_CAPACITY  = 4096;
+const size_t SCENE_FEED_CACHE_LINE_SIZE         = 64;
+
+
+/// @enum SceneFeedRecordType
+enum class SceneFeedRecordType : UINT {
+    Spawn,          ///< @~english Show the actor with the transform of the record @~japanese レコードのトランスフォームでアクタを表示する
+    Despawn,
+    Transform,
+};
+
+
+/// @~english
+/// @brief Record written by the simulation process, read in place by the renderer
+/// @details The transform follows SceneActor, the rotation is in degrees. One record fills a cache line.
+/// @~japanese
+/// @brief シミュレーションプロセスが書き込み、レンダラーがその場で読み込むレコード
+/// @details トランスフォームはSceneActorに従い、回転は角度。1レコードが1キャッシュラインを占める
+/// @~
+/// @struct SceneFeedRecord
+struct SceneFeedRecord {
+    INT64               timestamp;      ///< @~english Monotonic clock in nanoseconds when the record was written, shared by the processes @~japanese レコードを書き込んだ時のプロセス間で共通の単調増加する時計のナノ秒
+    SceneFeedRecordType type;
+    UINT                actorId;        ///< @~english Below the actor capacity of the feed @~japanese フィードのアクタ容量未満
+    float               translation[3];
+    float               rotation[3];
+    float               scale[3];
+    UINT                reserved[3];
+};
+static_assert(sizeof(SceneFeedRecord) == SCENE_FEED_CACHE_LINE_SIZE, "A record must fill one cache line");
+
+
+/// @~english
+/// @brief Header at the start of the shared memory, the records follow it
+/// @~japanese
+/// @brief 共有メモリの先頭のヘッダ、レコードはその後に続く
+/// @~
+/// @struct SceneFeedHeader
+struct SceneFeedHeader {
+    std::atomic<UINT>   magic;          ///< @~english Stored last by the creator @~japanese 生成した側が最後に書き込む
+    UINT                version;
+    UINT                recordSize;     ///< @~english Checked together with the version, both processes must agree on the layout @~japanese バージョンと共に確認する、両プロセスがレイアウトに合意している必要がある
+    UINT                capacity;       ///< @~english Number of records in the ring @~japanese リングのレコード数
+    UINT                actorCapacity;
+
+    // Positions count up forever, the record is the position masked by the capacity
+    // 位置は増加し続け、レコードは位置を容量でマスクしたもの
+    alignas(SCENE_FEED_CACHE_LINE_SIZE) std::atomic<UINT64> writePosition;   ///< @~english Published by the producer @~japanese 生産者が公開する
+    std::atomic<UINT64>                                     droppedCount;    ///< @~english Records the producer could not write, the ring was full @~japanese リングが満杯で生産者が書き込めなかったレコード
+    alignas(SCENE_FEED_CACHE_LINE_SIZE) std::atomic<UINT64> readPosition;    ///< @~english Written by the consumer @~japanese 消費者が書き込む
+};
+static_assert(std::atomic<UINT64>::is_always_lock_free, "The positions are shared between processes and must be lock-free");
+
+
+/// @~english
+/// @brief Statistics of the consumed records since the last reset
+/// @~japanese
+/// @brief 前回のリセット以降に消費したレコードの統計情報
+/// @~
+/// @struct SceneFeedStats
+struct SceneFeedStats {
+    UINT    recordCount;
+    UINT    spawnCount;
+    UINT    despawnCount;
+    UINT    rejectedCount;          ///< @~english Records with an unknown type or actor @~japanese 不明な種別またはアクタのレコード
+    float   latencyInMs;            ///< @~english Sum of the times from writing to consuming @~japanese 書き込みから消費までの時間の合計
+    float   maxLatencyInMs;
+    float   timeInMs;               ///< @~english Time spent consuming @~japanese 消費に掛かった時間
+
+    /// @brief コンストラクタ
+    SceneFeedStats()
+    : recordCount(0)
+    , spawnCount(0)
+    , despawnCount(0)
+    , rejectedCount(0)
+    , latencyInMs(0.0f)
+    , maxLatencyInMs(0.0f)
+    , timeInMs(0.0f)
+    {
+        ;
+    }
+};
+
+
+/// @class SceneFeed
+/// @~english
+/// @brief Named shared memory ring of scene records from a simulation process to the renderer
+/// @details One producer process publishes records with a single release store of the write position per
+///          batch, the consumer reads them where they lie in the mapping and hands the slots back with the
+///          read position, so nothing is serialized or copied on the way. The producer never waits, records
+///          not fitting in the ring are dropped and counted. Either side may create the feed, the other one
+///          opens it and checks the magic, the version and the record size. Mapped with CreateFileMapping on
+///          Windows and shm_open on Linux.
+/// @~japanese
+/// @brief シミュレーションプロセスからレンダラーへのシーンレコードの名前付き共有メモリのリング
+/// @details 1つの生産者プロセスがバッチ毎に書き込み位置の1回のリリースストアでレコードを公開し、消費者は
+///          マッピング上にあるまま読み込み、読み込み位置でスロットを返す為、途中でシリアライズもコピーも
+///          しない。生産者は待たず、リングに収まらないレコードは破棄して数える。どちらの側もフィードを
+///          生成でき、他方が開いてマジック、バージョン、レコードサイズを確認する。Windowsでは
+///          CreateFileMapping、Linuxではshm_openでマッピングする
+class SceneFeed {
+public:
+    /// @~english
+    /// @brief Create the shared memory and initialize the ring
+    /// @param[in] name Name of the shared memory
+    /// @param[in] recordCapacity Number of records, a power of two
+    /// @param[in] feedActorCapacity Number of actor ids
+    /// @return True if succeeded, false otherwise
+    /// @~japanese
+    /// @brief 共有メモリを生成しリングを初期化
+    /// @param[in] name 共有メモリの名前
+    /// @param[in] recordCapacity レコード数、2の累乗
+    /// @param[in] feedActorCapacity アクタIDの数
+    /// @return 成功した場合にはTrue、そうでないならFalseを返す
+    bool Create(const char *name, UINT recordCapacity, UINT feedActorCapacity);
+
+    /// @~english
+    /// @brief Open shared memory created by the other process
+    /// @return True if succeeded, false if it does not exist or its layout differs
+    /// @~japanese
+    /// @brief 他方のプロセスが生成した共有メモリを開く
+    /// @return 成功した場合にはTrue、存在しないかレイアウトが異なる場合はFalseを返す
+    bool Open(const char *name);
+
+    /// @~english
+    /// @brief Unmap the shared memory, the creator also removes its name
+    /// @~japanese
+    /// @brief 共有メモリのマッピングを解除、生成した側は名前も削除する
+    void Close();
+
+    /// @~english
+    /// @brief Write records and publish them at once, only called by the producer
+    /// @param[in] records Records to write
+    /// @param[in] count Number of records
+    /// @return Number of records written, the rest is dropped
+    /// @~japanese
+    /// @brief レコードを書き込み一括で公開、生産者のみが呼び出す
+    /// @param[in] records 書き込むレコード
+    /// @param[in] count レコード数
+    /// @return 書き込んだレコード数、残りは破棄される
+    UINT Publish(const SceneFeedRecord *records, UINT count);
+
+    /// @~english
+    /// @brief Pass the published records to a function in place, only called by the consumer
+    /// @details At most one ring of records is read. A write position further ahead can only come from a
+    ///          broken producer, the records beyond the ring are skipped and counted.
+    /// @param[in] func Function called with each record in order, void(const SceneFeedRecord &record)
+    /// @param[out] dstSkippedCount Number of records skipped (nullptr to ignore
+    /// @return Number of records consumed
+    /// @~japanese
+    /// @brief 公開されたレコードをその場で関数へ渡す、消費者のみが呼び出す
+    /// @details 読み込むのは最大でリング1周分のレコード。それ以上先の書き込み位置は壊れた生産者からのみ
+    ///          生じる為、リングを超えるレコードはスキップして数える
+    /// @param[in] func 各レコードと共に順に呼ばれる関数、void(const SceneFeedRecord &record)
+    /// @param[out] dstSkippedCount スキップしたレコード数（nullptrの場合は無視
+    /// @return 消費したレコード数
+    template<typename FuncT>
+    UINT Consume(FuncT func, UINT *dstSkippedCount = nullptr) {
+        if (dstSkippedCount != nullptr) {
+            *dstSkippedCount = 0;
+        }
+        if (header == nullptr) {
+            return 0;
+        }
+
+        // The capacity is the one checked at Open, the header is writable by the other process
+        // 容量はOpen時に確認したもの、ヘッダは他方のプロセスから書き込まれ得る
+        const UINT64 position      = header->readPosition.load(std::memory_order_relaxed);
+        const UINT64 writePosition = std::max(header->writePosition.load(std::memory_order_acquire), position);
+        const UINT64 endPosition   = std::min<UINT64>(writePosition, position + capacity);
+        for (UINT64 i = position; i < endPosition; ++i) {
+            func(records[i & mask]);
+        }
+        if (dstSkippedCount != nullptr) {
+            *dstSkippedCount = static_cast<UINT>(std::min<UINT64>(writePosition - endPosition, UINT_MAX));
+        }
+
+        // Hand the records back to the producer once they are read
+        // レコードは読み込み後に生産者へ返す
+        header->readPosition.store(writePosition, std::memory_order_release);
+        return static_cast<UINT>(endPosition - position);
+    }
+
+    /// @~english
+    /// @brief Get the number of records dropped by the producer since the last call and reset it
+    /// @~japanese
+    /// @brief 前回の呼び出し以降に生産者が破棄したレコード数を取得しリセット
+    UINT64 TakeDroppedCount() {
+        return (header != nullptr) ? header->droppedCount.exchange(0) : 0;
+    }
+
+    bool IsOpen() const {
+        return header != nullptr;
+    }
+
+    UINT GetActorCapacity() const {
+        return actorCapacity;
+    }
+
+    /// @~english
+    /// @brief Get the time records are stamped with, in nanoseconds of a monotonic clock shared by the processes
+    /// @~japanese
+    /// @brief レコードに記録する時刻を取得、プロセス間で共通の単調増加する時計のナノ秒
+    static INT64 GetTimestamp() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    SceneFeed();
+
+    /// @~english
+    /// @brief Destructor
+    /// @~japanese
+    /// @brief デストラクタ
+    ~SceneFeed();
+
+private:
+    /// @~english
+    /// @brief Map the shared memory
+    /// @~japanese
+    /// @brief 共有メモリをマッピング
+    bool Map(const char *name, size_t size, bool create);
+
+    /// @~english
+    /// @brief Get the size of the shared memory holding a ring
+    /// @~japanese
+    /// @brief リングを保持する共有メモリのサイズを取得
+    static size_t GetMappingSize(UINT capacity) {
+        return sizeof(SceneFeedHeader) + sizeof(SceneFeedRecord) * capacity;
+    }
+
+private:
+    SceneFeedHeader    *header;
+    SceneFeedRecord    *records;
+    UINT                capacity;       ///< @~english Copied from the header when mapped @~japanese マッピング時にヘッダからコピーする
+    UINT                mask;
+    UINT                actorCapacity;
+    size_t              mappingSize;
+    std::string         mappingName;
+    bool                created;
+#if defined(_WIN32)
+    HANDLE              mappingHandle;
+#endif
+};
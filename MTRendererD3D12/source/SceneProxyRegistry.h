@@ -0,0 +1,111 @@
+/// @file SceneProxyRegistry.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+#include "EntityWorld.h"
+#include "TransformHierarchy.h"
+
+
+/// @~english
+/// @brief Binds an actor type to its proxy type
+/// @details ProxyT provides the static functions
+///          - UINT Create(EntityWorld *world), INVALID_ENTITY if the proxy could not be created
+///          - void Commit(EntityWorld *world, ActorT *actor, DirectX::FXMMATRIX worldMtx)
+///          which are called without virtual dispatch over all actors of ActorT.
+/// @~japanese
+/// @brief アクタ型とProxy型の対応付け
+/// @details ProxyTは以下の静的関数を持つ
+///          - UINT Create(EntityWorld *world)、生成できなかった場合はINVALID_ENTITY
+///          - void Commit(EntityWorld *world, ActorT *actor, DirectX::FXMMATRIX worldMtx)
+///          これらはActorTの全アクタに対して仮想関数を介さずに呼ばれる
+/// @~
+/// @struct SceneProxyBinding
+template<typename ActorT, typename ProxyT>
+struct SceneProxyBinding {
+    using Actor = ActorT;
+    using Proxy = ProxyT;
+
+    /// @~english
+    /// @brief Transfer render information of a contiguous span of actors to the proxies
+    /// @~japanese
+    /// @brief 連続したアクタ列の描画情報をProxyへ伝達
+    static void CommitBatch(EntityWorld *world, const TransformHierarchy &hierarchy, ActorT *const *actors, UINT count) {
+        for (UINT i = 0; i < count; ++i) {
+            ActorT *actor = actors[i];
+            if (!world->IsAlive(actor->proxyEntity)) {
+                // Retried on the next commit if the proxy could not be created
+                // Proxyを生成できなかった場合は次回の伝達で再試行
+                actor->proxyEntity = ProxyT::Create(world);
+                if (actor->proxyEntity == INVALID_ENTITY) {
+                    continue;
+                }
+            }
+            ProxyT::Commit(world, actor, hierarchy.GetWorldMatrix(actor->transformNode));
+        }
+    }
+};
+
+
+/// @~english
+/// @brief Compile-time list of SceneProxyBinding
+/// @details Adding a type to the renderer means adding one binding to the list.
+/// @~japanese
+/// @brief SceneProxyBindingのコンパイル時リスト
+/// @details 描画対象の型を追加するにはリストにBindingを1つ追加する
+/// @~
+/// @struct SceneProxyTypeList
+template<typename... Bindings>
+struct SceneProxyTypeList {
+    /// @~english Number of registered types
+    /// @~japanese 登録済みの型の数
+    static constexpr UINT Count = static_cast<UINT>(sizeof...(Bindings));
+
+    /// @~english Per type actor lists, each one a contiguous span of one actor type
+    /// @~japanese 型毎のアクタリスト、それぞれが単一のアクタ型の連続した列
+    using ActorLists = std::tuple<std::vector<typename Bindings::Actor *>...>;
+
+    /// @~english
+    /// @brief Get the index of an actor type
+    /// @~japanese
+    /// @brief アクタ型のインデックスを取得
+    template<typename ActorT>
+    static constexpr UINT IndexOf() {
+        constexpr bool matches[] = { std::is_same_v<ActorT, typename Bindings::Actor>... };
+        for (UINT i = 0; i < Count; ++i) {
+            if (matches[i]) {
+                return i;
+            }
+        }
+        return Count;
+    }
+
+    /// @~english
+    /// @brief Get the actor list of an actor type
+    /// @~japanese
+    /// @brief アクタ型のアクタリストを取得
+    template<typename ActorT>
+    static std::vector<ActorT *>& GetActorList(ActorLists &lists) {
+        static_assert(IndexOf<ActorT>() < Count, "The actor type is not registered in SceneProxyRegistry.");
+        return std::get<IndexOf<ActorT>()>(lists);
+    }
+
+    /// @~english
+    /// @brief Commit all actors, dispatching once per type
+    /// @~japanese
+    /// @brief 全アクタを伝達、型毎に1回だけ振り分ける
+    static void CommitAll(EntityWorld *world, const TransformHierarchy &hierarchy, ActorLists &lists) {
+        (CommitList<Bindings>(world, hierarchy, lists), ...);
+    }
+
+private:
+    /// @~english
+    /// @brief Commit the actor list of a binding
+    /// @~japanese
+    /// @brief Bindingのアクタリストを伝達
+    template<typename Binding>
+    static void CommitList(EntityWorld *world, const TransformHierarchy &hierarchy, ActorLists &lists) {
+        auto &actors = GetActorList<typename Binding::Actor>(lists);
+        Binding::CommitBatch(world, hierarchy, actors.data(), static_cast<UINT>(actors.size()));
+    }
+};
@@ -0,0 +1,320 @@
+/// @file SceneSnapshot.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "SceneSnapshot.h"
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+    const UINT ACTOR_TYPE_COUNT         = static_cast<UINT>(SceneSnapshotActorType::Count);
+    const UINT FIELD_COUNT              = static_cast<UINT>(SceneSnapshotField::Count);
+    const UINT HIERARCHY_FIELD_COUNT    = static_cast<UINT>(SceneSnapshotHierarchyField::Count);
+
+    /// @~english
+    /// @brief Round up to the array alignment
+    /// @~japanese
+    /// @brief 配列のアライメントへ切り上げ
+    UINT64 AlignUpArray(UINT64 value) {
+        return (value + SCENE_SNAPSHOT_ALIGNMENT - 1) & ~static_cast<UINT64>(SCENE_SNAPSHOT_ALIGNMENT - 1);
+    }
+} // namespace ""
+
+//----------------------------------------------------------------------------------------------------
+// SceneSnapshotWriter
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+SceneSnapshotWriter::SceneSnapshotWriter()
+: actorCounts()
+, arrays()
+, hierarchyArrays()
+{
+    ;
+}
+
+// Set the number of actors of a type, clears its arrays
+// 種別のアクタ数をセット、その配列はクリアされる
+void SceneSnapshotWriter::SetActorCount(SceneSnapshotActorType type, UINT count) {
+    actorCounts[static_cast<UINT>(type)] = count;
+    for (auto &array : arrays[static_cast<UINT>(type)]) {
+        array = Array();
+    }
+}
+
+// Save to file
+// ファイルへ保存
+bool SceneSnapshotWriter::SaveToFile(const char *path) const {
+    SceneSnapshotHeader header = {};
+    header.magic   = SCENE_SNAPSHOT_MAGIC;
+    header.version = SCENE_SNAPSHOT_VERSION;
+
+    // Lay the arrays out type by type after the header
+    // ヘッダの後に種別毎に配列を配置
+    UINT64 tail = AlignUpArray(sizeof(SceneSnapshotHeader));
+    for (UINT type = 0; type < ACTOR_TYPE_COUNT; ++type) {
+        header.actorCounts[type] = actorCounts[type];
+        for (UINT field = 0; field < FIELD_COUNT; ++field) {
+            const auto &array = arrays[type][field];
+            const UINT elementSize = SceneSnapshot::GetElementSize(static_cast<SceneSnapshotActorType>(type), static_cast<SceneSnapshotField>(field));
+            if (0 < actorCounts[type] && (array.data == nullptr || array.elementSize != elementSize)) {
+                return false;
+            }
+
+            header.arrays[type][field].offset      = tail;
+            header.arrays[type][field].elementSize = elementSize;
+            tail = AlignUpArray(tail + static_cast<UINT64>(elementSize) * actorCounts[type]);
+        }
+    }
+
+    // The hierarchy arrays hold one node per actor and follow the arrays of the types
+    // 階層の配列はアクタ毎に1つのノードを持ち、種別の配列の後に続く
+    for (UINT type = 0; type < ACTOR_TYPE_COUNT; ++type) {
+        header.nodeCount += actorCounts[type];
+    }
+    for (UINT field = 0; field < HIERARCHY_FIELD_COUNT; ++field) {
+        if (0 < header.nodeCount && hierarchyArrays[field] == nullptr) {
+            return false;
+        }
+
+        header.hierarchyArrays[field].offset      = tail;
+        header.hierarchyArrays[field].elementSize = sizeof(UINT);
+        tail = AlignUpArray(tail + sizeof(UINT) * static_cast<UINT64>(header.nodeCount));
+    }
+    header.fileSize = tail;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    // Write the padding up to each array from a zeroed block
+    // 各配列までのパディングはゼロの領域から書き込む
+    const char padding[SCENE_SNAPSHOT_ALIGNMENT] = {};
+    UINT64 position = sizeof(SceneSnapshotHeader);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (UINT type = 0; type < ACTOR_TYPE_COUNT; ++type) {
+        for (UINT field = 0; field < FIELD_COUNT; ++field) {
+            const auto &desc = header.arrays[type][field];
+            file.write(padding, static_cast<std::streamsize>(desc.offset - position));
+            position = desc.offset;
+
+            const UINT64 size = static_cast<UINT64>(desc.elementSize) * actorCounts[type];
+            if (0 < size) {
+                file.write(static_cast<const char *>(arrays[type][field].data), static_cast<std::streamsize>(size));
+                position += size;
+            }
+        }
+    }
+    for (UINT field = 0; field < HIERARCHY_FIELD_COUNT; ++field) {
+        const auto &desc = header.hierarchyArrays[field];
+        file.write(padding, static_cast<std::streamsize>(desc.offset - position));
+        position = desc.offset;
+
+        const UINT64 size = sizeof(UINT) * static_cast<UINT64>(header.nodeCount);
+        if (0 < size) {
+            file.write(reinterpret_cast<const char *>(hierarchyArrays[field]), static_cast<std::streamsize>(size));
+            position += size;
+        }
+    }
+    file.write(padding, static_cast<std::streamsize>(header.fileSize - position));
+
+    return static_cast<bool>(file);
+}
+
+//----------------------------------------------------------------------------------------------------
+// SceneSnapshot
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+SceneSnapshot::SceneSnapshot()
+: header(nullptr)
+, mappingSize(0)
+#if defined(_WIN32)
+, fileHandle(INVALID_HANDLE_VALUE)
+, mappingHandle(nullptr)
+#endif
+{
+    ;
+}
+
+// Destructor
+// デストラクタ
+SceneSnapshot::~SceneSnapshot() {
+    Close();
+}
+
+// Map a file and validate it
+// ファイルをマッピングし検証
+bool SceneSnapshot::LoadFromFile(const char *path) {
+    Close();
+
+    if (!Map(path)) {
+        return false;
+    }
+    if (!Validate()) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+// Get the snapshot index of the first actor of a type
+// 種別の最初のアクタのスナップショット番号を取得
+UINT SceneSnapshot::GetFirstIndex(SceneSnapshotActorType type) const {
+    UINT index = 0;
+    for (UINT i = 0; i < static_cast<UINT>(type); ++i) {
+        index += GetActorCount(static_cast<SceneSnapshotActorType>(i));
+    }
+    return index;
+}
+
+// Get the size of the elements of an array
+// 配列の要素のサイズを取得
+UINT SceneSnapshot::GetElementSize(SceneSnapshotActorType type, SceneSnapshotField field) {
+    switch (field) {
+    case SceneSnapshotField::Translation:
+    case SceneSnapshotField::Rotation:
+    case SceneSnapshotField::Scale:
+        return sizeof(DirectX::XMFLOAT4);
+    case SceneSnapshotField::Node:
+        return sizeof(UINT);
+    case SceneSnapshotField::Tick:
+        return sizeof(SceneSnapshotTick);
+    case SceneSnapshotField::Params:
+        return (type == SceneSnapshotActorType::Camera) ? sizeof(SceneSnapshotView) : sizeof(SceneSnapshotMotion);
+    default:
+        return 0;
+    }
+}
+
+// Validate the header against the mapping
+// マッピングに対してヘッダを検証
+bool SceneSnapshot::Validate() const {
+    if (mappingSize < sizeof(SceneSnapshotHeader)) {
+        return false;
+    }
+    if (header->magic != SCENE_SNAPSHOT_MAGIC || header->version != SCENE_SNAPSHOT_VERSION || mappingSize < header->fileSize) {
+        return false;
+    }
+
+    // Validate the array ranges
+    // 配列範囲の検証
+    UINT64 totalCount = 0;
+    for (UINT type = 0; type < ACTOR_TYPE_COUNT; ++type) {
+        const UINT64 count = header->actorCounts[type];
+        totalCount += count;
+        for (UINT field = 0; field < FIELD_COUNT; ++field) {
+            const auto &desc = header->arrays[type][field];
+            if (desc.elementSize != GetElementSize(static_cast<SceneSnapshotActorType>(type), static_cast<SceneSnapshotField>(field))) {
+                return false;
+            }
+            if ((desc.offset % SCENE_SNAPSHOT_ALIGNMENT) != 0 || header->fileSize < desc.offset || header->fileSize - desc.offset < desc.elementSize * count) {
+                return false;
+            }
+        }
+    }
+    if (INVALID_SCENE_SNAPSHOT_INDEX <= totalCount || header->nodeCount != totalCount) {
+        return false;
+    }
+
+    // One node per actor
+    // アクタ毎に1つのノード
+    for (const auto &desc : header->hierarchyArrays) {
+        if (desc.elementSize != sizeof(UINT)) {
+            return false;
+        }
+        if ((desc.offset % SCENE_SNAPSHOT_ALIGNMENT) != 0 || header->fileSize < desc.offset || header->fileSize - desc.offset < sizeof(UINT) * totalCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#if defined(_WIN32)
+// Map the file read-only
+// ファイルを読み込み専用でマッピング
+bool SceneSnapshot::Map(const char *path) {
+    fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+        Close();
+        return false;
+    }
+
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr) {
+        Close();
+        return false;
+    }
+
+    const void *view = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        Close();
+        return false;
+    }
+
+    header      = static_cast<const SceneSnapshotHeader *>(view);
+    mappingSize = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+// Unmap the file, the arrays become invalid
+// ファイルのマッピングを解除、配列は無効になる
+void SceneSnapshot::Close() {
+    if (header != nullptr) {
+        UnmapViewOfFile(header);
+    }
+    if (mappingHandle != nullptr) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+    header      = nullptr;
+    mappingSize = 0;
+}
+#else
+// Map the file read-only
+// ファイルを読み込み専用でマッピング
+bool SceneSnapshot::Map(const char *path) {
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) == 0 && 0 < fileStat.st_size) {
+        const size_t size = static_cast<size_t>(fileStat.st_size);
+        void *view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view != MAP_FAILED) {
+            header      = static_cast<const SceneSnapshotHeader *>(view);
+            mappingSize = size;
+        }
+    }
+    close(fd);
+
+    return header != nullptr;
+}
+
+// Unmap the file, the arrays become invalid
+// ファイルのマッピングを解除、配列は無効になる
+void SceneSnapshot::Close() {
+    if (header != nullptr) {
+        munmap(const_cast<SceneSnapshotHeader *>(header), mappingSize);
+    }
+    header      = nullptr;
+    mappingSize = 0;
+}
+#endif
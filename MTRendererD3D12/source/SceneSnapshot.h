@@ -0,0 +1,302 @@
+/// @file SceneSnapshot.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+// Binary scene snapshot identifier ('MTSS')
+const UINT   SCENE_SNAPSHOT_MAGIC       = 0x5353544du;
+const UINT   SCENE_SNAPSHOT_VERSION     = 2;
+const size_t SCENE_SNAPSHOT_ALIGNMENT   = 64;       // Every array starts on a cache line
+
+// Flags of SceneSnapshotTick
+const UINT SCENE_SNAPSHOT_FLAG_SLEEPING = 0x1;
+const UINT SCENE_SNAPSHOT_FLAG_OCCLUDER = 0x2;
+
+
+/// @enum SceneSnapshotActorType
+enum class SceneSnapshotActorType : UINT {
+    Triangle,
+    Camera,
+    Count,
+};
+
+/// @enum SceneSnapshotField
+enum class SceneSnapshotField : UINT {
+    Translation,    ///< @~english DirectX::XMFLOAT4 @~japanese DirectX::XMFLOAT4
+    Rotation,       ///< @~english DirectX::XMFLOAT4, Degree @~japanese DirectX::XMFLOAT4、角度
+    Scale,          ///< @~english DirectX::XMFLOAT4 @~japanese DirectX::XMFLOAT4
+    Node,           ///< @~english UINT, position of the node of the actor in the hierarchy arrays @~japanese UINT、階層の配列内のアクタのノードの位置
+    Tick,           ///< @~english SceneSnapshotTick @~japanese SceneSnapshotTick
+    Params,         ///< @~english SceneSnapshotMotion for triangles, SceneSnapshotView for cameras @~japanese 三角形はSceneSnapshotMotion、カメラはSceneSnapshotView
+    Count,
+};
+
+/// @enum SceneSnapshotHierarchyField
+enum class SceneSnapshotHierarchyField : UINT {
+    Parent,         ///< @~english UINT, position of the parent node or INVALID_SCENE_SNAPSHOT_INDEX @~japanese UINT、親ノードの位置もしくはINVALID_SCENE_SNAPSHOT_INDEX
+    SubtreeSize,    ///< @~english UINT, number of nodes of the subtree including the node @~japanese UINT、ノード自身を含むサブツリーのノード数
+    Count,
+};
+
+const UINT INVALID_SCENE_SNAPSHOT_INDEX = ~0u;
+
+
+/// @~english
+/// @brief Tick settings of an actor
+/// @~japanese
+/// @brief アクタの更新設定
+/// @~
+/// @struct SceneSnapshotTick
+struct SceneSnapshotTick {
+    UINT    tickGroup;
+    UINT    tickInterval;
+    float   tickDistanceStep;
+    UINT    flags;              ///< @~english SCENE_SNAPSHOT_FLAG_* @~japanese SCENE_SNAPSHOT_FLAG_*
+};
+
+/// @~english
+/// @brief Parameters of a TriangleSceneActor
+/// @~japanese
+/// @brief TriangleSceneActorのパラメータ
+/// @~
+/// @struct SceneSnapshotMotion
+struct SceneSnapshotMotion {
+    float   rotSpeed;
+    float   scaleSpeed;
+    float   rotAngle;
+    float   scaleAngle;
+};
+
+/// @~english
+/// @brief Parameters of a CameraSceneActor
+/// @~japanese
+/// @brief CameraSceneActorのパラメータ
+/// @~
+/// @struct SceneSnapshotView
+struct SceneSnapshotView {
+    DirectX::XMFLOAT4   viewportRect;
+    UINT                screenWidth;
+    UINT                screenHeight;
+    float               fovInDeg;
+    UINT                reserved;
+};
+
+/// @~english
+/// @brief Location of an array in the file
+/// @~japanese
+/// @brief ファイル内の配列の位置
+/// @~
+/// @struct SceneSnapshotArrayDesc
+struct SceneSnapshotArrayDesc {
+    UINT64  offset;             ///< @~english From the start of the file, aligned to SCENE_SNAPSHOT_ALIGNMENT @~japanese ファイルの先頭から、SCENE_SNAPSHOT_ALIGNMENTに揃える
+    UINT    elementSize;
+    UINT    reserved;
+};
+
+/// @~english
+/// @brief Header at the start of the file, the arrays follow it
+/// @details The hierarchy arrays hold one node per actor in parent-before-child order (pre-order), the order of
+///          TransformHierarchy, so they are loaded as they are. Each actor refers to its node by position.
+/// @~japanese
+/// @brief ファイル先頭のヘッダ、配列はその後に続く
+/// @details 階層の配列はアクタ毎に1つのノードをTransformHierarchyと同じ親が子より前に並ぶ順（前順）で持つ為、
+///          そのまま読み込まれる。各アクタは位置でノードを参照する
+/// @~
+/// @struct SceneSnapshotHeader
+struct SceneSnapshotHeader {
+    UINT                    magic;
+    UINT                    version;
+    UINT64                  fileSize;
+    UINT                    actorCounts[static_cast<UINT>(SceneSnapshotActorType::Count)];
+    UINT                    nodeCount;          ///< @~english Sum of the actor counts @~japanese アクタ数の合計
+    UINT                    reserved;
+    SceneSnapshotArrayDesc  arrays[static_cast<UINT>(SceneSnapshotActorType::Count)][static_cast<UINT>(SceneSnapshotField::Count)];
+    SceneSnapshotArrayDesc  hierarchyArrays[static_cast<UINT>(SceneSnapshotHierarchyField::Count)];
+};
+
+
+/// @class SceneSnapshotWriter
+/// @~english
+/// @brief Writes the arrays of a scene to a snapshot file
+/// @details The arrays are only referenced until Save() returns, they are written as they are.
+/// @~japanese
+/// @brief シーンの配列をスナップショットファイルへ書き込む
+/// @details 配列はSave()が戻るまで参照するのみで、そのまま書き込まれる
+class SceneSnapshotWriter {
+public:
+    /// @~english
+    /// @brief Set the number of actors of a type, clears its arrays
+    /// @~japanese
+    /// @brief 種別のアクタ数をセット、その配列はクリアされる
+    void SetActorCount(SceneSnapshotActorType type, UINT count);
+
+    /// @~english
+    /// @brief Set an array of the actors of a type
+    /// @param[in] type Actor type
+    /// @param[in] field Field of the array
+    /// @param[in] data Elements, as many as the actors of the type
+    /// @~japanese
+    /// @brief 種別のアクタの配列をセット
+    /// @param[in] type アクタの種別
+    /// @param[in] field 配列のフィールド
+    /// @param[in] data 要素、種別のアクタ数だけ
+    template<typename T>
+    void SetArray(SceneSnapshotActorType type, SceneSnapshotField field, const T *data) {
+        auto &array = arrays[static_cast<UINT>(type)][static_cast<UINT>(field)];
+        array.data        = data;
+        array.elementSize = sizeof(T);
+    }
+
+    /// @~english
+    /// @brief Set the hierarchy arrays, one node per actor in parent-before-child order
+    /// @param[in] parents Position of the parent of each node, before the node, or INVALID_SCENE_SNAPSHOT_INDEX
+    /// @param[in] subtreeSizes Number of nodes of the subtree of each node, including the node
+    /// @~japanese
+    /// @brief 階層の配列をセット、親が子より前に並ぶ順でアクタ毎に1つのノード
+    /// @param[in] parents 各ノードの親のノードより前の位置、もしくはINVALID_SCENE_SNAPSHOT_INDEX
+    /// @param[in] subtreeSizes 各ノードのノード自身を含むサブツリーのノード数
+    void SetHierarchy(const UINT *parents, const UINT *subtreeSizes) {
+        hierarchyArrays[static_cast<UINT>(SceneSnapshotHierarchyField::Parent)]      = parents;
+        hierarchyArrays[static_cast<UINT>(SceneSnapshotHierarchyField::SubtreeSize)] = subtreeSizes;
+    }
+
+    /// @~english
+    /// @brief Save to file
+    /// @return True if succeeded, false if an array is missing or has the wrong element, or the file can not be written
+    /// @~japanese
+    /// @brief ファイルへ保存
+    /// @return 成功した場合にはTrue、配列が不足しているか要素が誤っているかファイルに書き込めない場合はFalseを返す
+    bool SaveToFile(const char *path) const;
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    SceneSnapshotWriter();
+
+private:
+    struct Array {
+        const void *data;
+        UINT        elementSize;
+    };
+
+    UINT        actorCounts[static_cast<UINT>(SceneSnapshotActorType::Count)];
+    Array       arrays[static_cast<UINT>(SceneSnapshotActorType::Count)][static_cast<UINT>(SceneSnapshotField::Count)];
+    const UINT *hierarchyArrays[static_cast<UINT>(SceneSnapshotHierarchyField::Count)];
+};
+
+
+/// @class SceneSnapshot
+/// @~english
+/// @brief Scene snapshot file mapped into memory, the arrays are read where they lie
+/// @details Loading maps the file read-only and validates the header, nothing is parsed or copied, so
+///          the cost does not depend on the number of actors until the arrays are touched. Mapped with
+///          CreateFileMapping on Windows and mmap on Linux.
+/// @~japanese
+/// @brief メモリへマッピングしたシーンスナップショットファイル、配列はその場で読み込む
+/// @details 読み込みはファイルを読み込み専用でマッピングしヘッダを検証するのみで、解析もコピーもしない為、
+///          配列に触れるまでコストはアクタ数に依存しない。WindowsではCreateFileMapping、Linuxではmmapで
+///          マッピングする
+class SceneSnapshot {
+public:
+    /// @~english
+    /// @brief Map a file and validate it
+    /// @return True if succeeded, false if it can not be mapped or its layout differs
+    /// @~japanese
+    /// @brief ファイルをマッピングし検証
+    /// @return 成功した場合にはTrue、マッピングできないかレイアウトが異なる場合はFalseを返す
+    bool LoadFromFile(const char *path);
+
+    /// @~english
+    /// @brief Unmap the file, the arrays become invalid
+    /// @~japanese
+    /// @brief ファイルのマッピングを解除、配列は無効になる
+    void Close();
+
+    /// @~english
+    /// @brief Get an array of the actors of a type
+    /// @return Elements in the mapping, nullptr if the element type differs
+    /// @~japanese
+    /// @brief 種別のアクタの配列を取得
+    /// @return マッピング内の要素、要素の型が異なる場合はnullptr
+    template<typename T>
+    const T* GetArray(SceneSnapshotActorType type, SceneSnapshotField field) const {
+        if (header == nullptr) {
+            return nullptr;
+        }
+
+        const auto &array = header->arrays[static_cast<UINT>(type)][static_cast<UINT>(field)];
+        if (array.elementSize != sizeof(T)) {
+            return nullptr;
+        }
+        return reinterpret_cast<const T *>(reinterpret_cast<const BYTE *>(header) + array.offset);
+    }
+
+    UINT GetActorCount(SceneSnapshotActorType type) const {
+        return (header != nullptr) ? header->actorCounts[static_cast<UINT>(type)] : 0;
+    }
+
+    /// @~english
+    /// @brief Get a hierarchy array, GetNodeCount() elements in parent-before-child order
+    /// @~japanese
+    /// @brief 階層の配列を取得、親が子より前に並ぶ順のGetNodeCount()個の要素
+    const UINT* GetHierarchyArray(SceneSnapshotHierarchyField field) const {
+        if (header == nullptr) {
+            return nullptr;
+        }
+        return reinterpret_cast<const UINT *>(reinterpret_cast<const BYTE *>(header) + header->hierarchyArrays[static_cast<UINT>(field)].offset);
+    }
+
+    UINT GetNodeCount() const {
+        return (header != nullptr) ? header->nodeCount : 0;
+    }
+
+    /// @~english
+    /// @brief Get the snapshot index of the first actor of a type
+    /// @~japanese
+    /// @brief 種別の最初のアクタのスナップショット番号を取得
+    UINT GetFirstIndex(SceneSnapshotActorType type) const;
+
+    bool IsOpen() const {
+        return header != nullptr;
+    }
+
+    /// @~english
+    /// @brief Get the size of the elements of an array
+    /// @~japanese
+    /// @brief 配列の要素のサイズを取得
+    static UINT GetElementSize(SceneSnapshotActorType type, SceneSnapshotField field);
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    SceneSnapshot();
+
+    /// @~english
+    /// @brief Destructor
+    /// @~japanese
+    /// @brief デストラクタ
+    ~SceneSnapshot();
+
+private:
+    /// @~english
+    /// @brief Map the file read-only
+    /// @~japanese
+    /// @brief ファイルを読み込み専用でマッピング
+    bool Map(const char *path);
+
+    /// @~english
+    /// @brief Validate the header against the mapping
+    /// @~japanese
+    /// @brief マッピングに対してヘッダを検証
+    bool Validate() const;
+
+private:
+    const SceneSnapshotHeader  *header;
+    size_t                      mappingSize;
+#if defined(_WIN32)
+    HANDLE                      fileHandle;
+    HANDLE                      mappingHandle;
+#endif
+};
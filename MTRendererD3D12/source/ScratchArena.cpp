@@ -0,0 +1,228 @@
+/// @file ScratchArena.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "ScratchArena.h"
+
+namespace {
+// Arena of the calling thread
+// 呼び出し元スレッドのアリーナ
+thread_local ScratchArena  *threadArena = nullptr;
+
+// Heap allocation guard state of the calling thread
+// 呼び出し元スレッドのヒープ確保ガードの状態
+thread_local UINT           heapGuardDepth     = 0;
+thread_local UINT           heapViolationCount = 0;
+
+// Round up value to a multiple of alignment (power of two)
+// valueをalignment（2の累乗）の倍数に切り上げ
+size_t AlignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+} // namespace ""
+
+#if ENABLE_HEAP_ALLOCATION_GUARD
+//----------------------------------------------------------------------------------------------------
+// Global operator new/delete
+//----------------------------------------------------------------------------------------------------
+// Replaced to count the heap allocations made while a HeapAllocationGuard is armed.
+// The array and nothrow forms of the runtime forward to these.
+// HeapAllocationGuardが有効な間のヒープ確保を数える為に置き換える
+// 配列版、nothrow版はランタイムがこれらへ転送する
+void* operator new(size_t size) {
+    if (heapGuardDepth != 0) {
+        heapViolationCount++;
+    }
+
+    void *ptr = malloc((size != 0) ? size : 1);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    if (heapGuardDepth != 0) {
+        heapViolationCount++;
+    }
+
+    void *ptr = _aligned_malloc((size != 0) ? size : 1, static_cast<size_t>(alignment));
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t size) noexcept {
+    free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t alignment) noexcept {
+    _aligned_free(ptr);
+}
+
+void operator delete(void *ptr, size_t size, std::align_val_t alignment) noexcept {
+    _aligned_free(ptr);
+}
+#endif
+
+//----------------------------------------------------------------------------------------------------
+// ScratchArena
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+ScratchArena::ScratchArena()
+: base(nullptr)
+, capacity(0)
+, offset(0)
+, peakSize(0)
+, overflowSize(0)
+{
+    ;
+}
+
+// Destructor
+// デストラクタ
+ScratchArena::~ScratchArena() {
+    Deinit();
+}
+
+// Initialize
+// 初期化
+bool ScratchArena::Init(size_t inCapacity) {
+    Deinit();
+
+    base = static_cast<BYTE *>(_aligned_malloc(inCapacity, MAX_SCRATCH_ALIGNMENT));
+    if (base == nullptr) {
+        return false;
+    }
+    capacity = inCapacity;
+    overflowBlocks.reserve(DEFAULT_SCRATCH_OVERFLOW_CAPACITY);
+
+    return true;
+}
+
+// Deinitialize
+// 終了処理
+void ScratchArena::Deinit() {
+    for (auto block : overflowBlocks) {
+        _aligned_free(block);
+    }
+    overflowBlocks.clear();
+    overflowSize = 0;
+
+    if (base != nullptr) {
+        _aligned_free(base);
+        base = nullptr;
+    }
+    capacity = 0;
+    offset   = 0;
+    peakSize = 0;
+}
+
+// Allocate memory valid until the next Reset()
+// 次のReset()まで有効なメモリを確保
+void* ScratchArena::Allocate(size_t size, size_t alignment) {
+    assert(alignment <= MAX_SCRATCH_ALIGNMENT);
+
+    const size_t alignedOffset = AlignUp(offset, alignment);
+    if (alignedOffset + size <= capacity) {
+        offset = alignedOffset + size;
+        return base + alignedOffset;
+    }
+
+    // Fall back to the heap until the next Reset() grows the arena
+    // 次のReset()でアリーナが拡張されるまでヒープへフォールバック
+    if (heapGuardDepth != 0) {
+        heapViolationCount++;
+    }
+    void *block = _aligned_malloc((size != 0) ? size : 1, MAX_SCRATCH_ALIGNMENT);
+    if (block != nullptr) {
+        overflowBlocks.push_back(block);
+        overflowSize += size;
+    }
+    return block;
+}
+
+// Release all allocations, the arena grows if it overflowed since the last reset
+// 全ての確保を解放、前回のリセット以降に溢れていた場合はアリーナを拡張
+void ScratchArena::Reset() {
+    peakSize = std::max(peakSize, GetUsedSize());
+
+    if (!overflowBlocks.empty()) {
+        for (auto block : overflowBlocks) {
+            _aligned_free(block);
+        }
+        overflowBlocks.clear();
+        overflowSize = 0;
+
+        // Grow to the next power of two above the peak
+        // ピーク以上の2の累乗まで拡張
+        size_t newCapacity = std::max<size_t>(capacity, DEFAULT_SCRATCH_ALIGNMENT);
+        while (newCapacity < peakSize) {
+            newCapacity *= 2;
+        }
+
+        BYTE *newBase = static_cast<BYTE *>(_aligned_malloc(newCapacity, MAX_SCRATCH_ALIGNMENT));
+        if (newBase != nullptr) {
+            _aligned_free(base);
+            base     = newBase;
+            capacity = newCapacity;
+        }
+    }
+
+    offset = 0;
+}
+
+// Set the arena of the calling thread
+// 呼び出し元スレッドのアリーナをセット
+void ScratchArena::SetThreadArena(ScratchArena *arena) {
+    threadArena = arena;
+}
+
+// Get the arena of the calling thread
+// 呼び出し元スレッドのアリーナを取得
+ScratchArena* ScratchArena::GetThreadArena() {
+    return threadArena;
+}
+
+//----------------------------------------------------------------------------------------------------
+// HeapAllocationGuard
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+HeapAllocationGuard::HeapAllocationGuard(bool arm)
+: armed(arm && (ENABLE_HEAP_ALLOCATION_GUARD != 0))
+, violationCountAtBegin(heapViolationCount)
+{
+    if (armed) {
+        heapGuardDepth++;
+    }
+}
+
+// Destructor, asserts if the heap was used
+// デストラクタ、ヒープが使用されていた場合はアサート
+HeapAllocationGuard::~HeapAllocationGuard() {
+    if (!armed) {
+        return;
+    }
+    heapGuardDepth--;
+
+    const UINT violationCount = heapViolationCount - violationCountAtBegin;
+    if (violationCount != 0) {
+        char message[128];
+        snprintf(message, sizeof(message), "HeapAllocationGuard: %u heap allocation(s) in a steady state frame\n", violationCount);
+        OutputDebugStringA(message);
+        assert(!"Heap allocation in a steady state frame");
+    }
+}
+
+// Get the number of heap allocations on the calling thread while armed
+// 有効な間に呼び出し元スレッドで行われたヒープ確保数を取得
+UINT HeapAllocationGuard::GetViolationCount() {
+    return heapViolationCount;
+}
@@ -0,0 +1,265 @@
+/// @file ScratchArena.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+// Default value
+const size_t DEFAULT_SCRATCH_ARENA_SIZE         = 4 * 1024 * 1024;
+const size_t DEFAULT_SCRATCH_ALIGNMENT          = 16;
+const size_t MAX_SCRATCH_ALIGNMENT              = 64;
+const size_t DEFAULT_SCRATCH_OVERFLOW_CAPACITY  = 64;
+const UINT   DEFAULT_HEAP_GUARD_WARMUP_FRAMES   = 8;
+
+
+/// @class ScratchArena
+/// @~english
+/// @brief Bump allocator for transient data of one frame on one thread
+/// @details Memory is released all at once by Reset(). Requests that do not fit fall back to the heap,
+///          and the next Reset() grows the arena to the peak size so the steady state stays off the heap.
+///          An arena must only be used by one thread at a time.
+/// @~japanese
+/// @brief 1スレッド1フレーム分の一時データ向けのバンプアロケータ
+/// @details メモリはReset()で一括解放される。収まらない要求はヒープへフォールバックし、次のReset()で
+///          ピークサイズまで拡張するため、定常状態ではヒープを使用しない。
+///          1つのアリーナは同時に1スレッドからのみ使用すること
+class ScratchArena {
+public:
+    /// @~english
+    /// @brief Initialize
+    /// @param[in] inCapacity Size of the arena in bytes
+    /// @return True if initialization succeeded, false otherwise
+    /// @~japanese
+    /// @brief 初期化
+    /// @param[in] inCapacity アリーナのサイズ（バイト
+    /// @return 初期化に成功した場合にはTrue、そうでないならFalseを返す
+    bool Init(size_t inCapacity);
+
+    /// @~english
+    /// @brief Deinitialize
+    /// @~japanese
+    /// @brief 終了処理
+    void Deinit();
+
+    /// @~english
+    /// @brief Allocate memory valid until the next Reset()
+    /// @~japanese
+    /// @brief 次のReset()まで有効なメモリを確保
+    void* Allocate(size_t size, size_t alignment = DEFAULT_SCRATCH_ALIGNMENT);
+
+    /// @~english
+    /// @brief Allocate an uninitialized array valid until the next Reset()
+    /// @~japanese
+    /// @brief 次のReset()まで有効な未初期化の配列を確保
+    template<typename T>
+    T* AllocateArray(size_t count) {
+        return static_cast<T *>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /// @~english
+    /// @brief Release all allocations, the arena grows if it overflowed since the last reset
+    /// @~japanese
+    /// @brief 全ての確保を解放、前回のリセット以降に溢れていた場合はアリーナを拡張
+    void Reset();
+
+    /// @~english
+    /// @brief Get the number of bytes in use
+    /// @~japanese
+    /// @brief 使用中のバイト数を取得
+    size_t GetUsedSize() const {
+        return offset + overflowSize;
+    }
+
+    /// @~english
+    /// @brief Get the size of the arena
+    /// @~japanese
+    /// @brief アリーナのサイズを取得
+    size_t GetCapacity() const {
+        return capacity;
+    }
+
+    /// @~english
+    /// @brief Get the largest number of bytes used between resets
+    /// @~japanese
+    /// @brief リセット間で使用された最大バイト数を取得
+    size_t GetPeakSize() const {
+        return peakSize;
+    }
+
+    /// @~english
+    /// @brief Set the arena of the calling thread
+    /// @~japanese
+    /// @brief 呼び出し元スレッドのアリーナをセット
+    static void SetThreadArena(ScratchArena *arena);
+
+    /// @~english
+    /// @brief Get the arena of the calling thread
+    /// @return Pointer to the arena, nullptr if not set
+    /// @~japanese
+    /// @brief 呼び出し元スレッドのアリーナを取得
+    /// @return アリーナへのポインタ、セットされていない場合はnullptr
+    static ScratchArena* GetThreadArena();
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    ScratchArena();
+
+    /// @~english
+    /// @brief Destructor
+    /// @~japanese
+    /// @brief デストラクタ
+    ~ScratchArena();
+
+    ScratchArena(const ScratchArena &) = delete;
+    ScratchArena& operator=(const ScratchArena &) = delete;
+
+private:
+    BYTE               *base;
+    size_t              capacity;
+    size_t              offset;
+    size_t              peakSize;
+    std::vector<void *> overflowBlocks;
+    size_t              overflowSize;
+};
+
+
+/// @class ScratchAllocator
+/// @~english
+/// @brief STL allocator adaptor allocating from a ScratchArena
+/// @details deallocate() does nothing, the memory is released by ScratchArena::Reset().
+///          Without an arena it allocates from the heap, so containers outside a frame keep working.
+///          The arena moves with the memory when a container is assigned or swapped.
+/// @~japanese
+/// @brief ScratchArenaから確保するSTLアロケータアダプタ
+/// @details deallocate()は何もせず、メモリはScratchArena::Reset()で解放される。
+///          アリーナが無い場合はヒープから確保する為、フレーム外のコンテナも動作する。
+///          コンテナの代入、交換ではアリーナはメモリと共に移る
+template<typename T>
+class ScratchAllocator {
+public:
+    using value_type                                = T;
+    using propagate_on_container_copy_assignment    = std::true_type;
+    using propagate_on_container_move_assignment    = std::true_type;
+    using propagate_on_container_swap               = std::true_type;
+
+    /// @~english
+    /// @brief Allocate memory for count objects
+    /// @~japanese
+    /// @brief count個分のメモリを確保
+    T* allocate(size_t count) {
+        if (arena == nullptr) {
+            return static_cast<T *>(::operator new(sizeof(T) * count));
+        }
+        return arena->AllocateArray<T>(count);
+    }
+
+    /// @~english
+    /// @brief Released by ScratchArena::Reset(), or freed if allocated from the heap
+    /// @~japanese
+    /// @brief ScratchArena::Reset()で解放される、ヒープから確保した場合は解放
+    void deallocate(T *ptr, size_t count) noexcept {
+        if (arena == nullptr) {
+            ::operator delete(ptr);
+        }
+    }
+
+    /// @~english
+    /// @brief Get the arena
+    /// @~japanese
+    /// @brief アリーナを取得
+    ScratchArena* GetArena() const noexcept {
+        return arena;
+    }
+
+    /// @~english
+    /// @brief Constructor, uses the arena of the calling thread (the heap if it has none
+    /// @~japanese
+    /// @brief コンストラクタ、呼び出し元スレッドのアリーナを使用（無い場合はヒープ
+    ScratchAllocator() noexcept
+    : arena(ScratchArena::GetThreadArena())
+    {
+        ;
+    }
+
+    /// @~english
+    /// @brief Constructor
+    /// @param[in] inArena Arena to allocate from (nullptr for the heap
+    /// @~japanese
+    /// @brief コンストラクタ
+    /// @param[in] inArena 確保元のアリーナ（nullptrの場合はヒープ
+    ScratchAllocator(ScratchArena *inArena) noexcept
+    : arena(inArena)
+    {
+        ;
+    }
+
+    /// @~english
+    /// @brief Converting constructor
+    /// @~japanese
+    /// @brief 変換コンストラクタ
+    template<typename U>
+    ScratchAllocator(const ScratchAllocator<U> &other) noexcept
+    : arena(other.GetArena())
+    {
+        ;
+    }
+
+private:
+    ScratchArena   *arena;
+};
+
+template<typename T, typename U>
+bool operator==(const ScratchAllocator<T> &lhs, const ScratchAllocator<U> &rhs) noexcept {
+    return lhs.GetArena() == rhs.GetArena();
+}
+
+template<typename T, typename U>
+bool operator!=(const ScratchAllocator<T> &lhs, const ScratchAllocator<U> &rhs) noexcept {
+    return lhs.GetArena() != rhs.GetArena();
+}
+
+/// @~english
+/// @brief std::vector allocating from a ScratchArena
+/// @~japanese
+/// @brief ScratchArenaから確保するstd::vector
+template<typename T>
+using ScratchVector = std::vector<T, ScratchAllocator<T>>;
+
+
+/// @class HeapAllocationGuard
+/// @~english
+/// @brief Asserts that the calling thread does not use the global operator new while armed
+/// @details Only active when ENABLE_HEAP_ALLOCATION_GUARD is set, otherwise it does nothing.
+/// @~japanese
+/// @brief 有効な間、呼び出し元スレッドがグローバルoperator newを使用しない事を検証
+/// @details ENABLE_HEAP_ALLOCATION_GUARDがセットされている場合のみ動作し、それ以外では何もしない
+class HeapAllocationGuard {
+public:
+    /// @~english
+    /// @brief Get the number of heap allocations on the calling thread while armed
+    /// @~japanese
+    /// @brief 有効な間に呼び出し元スレッドで行われたヒープ確保数を取得
+    static UINT GetViolationCount();
+
+    /// @~english
+    /// @brief Constructor
+    /// @param[in] arm True to start checking, false to do nothing (e.g. during warm-up frames
+    /// @~japanese
+    /// @brief コンストラクタ
+    /// @param[in] arm 検証を開始する場合はTrue、何もしない場合はFalse（ウォームアップ中など
+    explicit HeapAllocationGuard(bool arm);
+
+    /// @~english
+    /// @brief Destructor, asserts if the heap was used
+    /// @~japanese
+    /// @brief デストラクタ、ヒープが使用されていた場合はアサート
+    ~HeapAllocationGuard();
+
+    HeapAllocationGuard(const HeapAllocationGuard &) = delete;
+    HeapAllocationGuard& operator=(const HeapAllocationGuard &) = delete;
+
+private:
+    bool    armed;
+    UINT    violationCountAtBegin;
+};
@@ -0,0 +1,169 @@
+/// @file StressScene.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "StressScene.h"
+#include "TickScheduler.h"
+
+using namespace DirectX;
+
+namespace {
+    const char *DISTRIBUTION_NAMES[static_cast<UINT>(StressSceneDistribution::Count)] = {
+        "uniform",
+        "clustered",
+        "grid",
+    };
+
+    // Streams of the hash, one per generated value of an actor
+    // ハッシュの系列、アクタの生成する値毎に1つ
+    enum RandomStream : UINT {
+        RandomPositionX,
+        RandomPositionY,
+        RandomPositionZ,
+        RandomCluster,
+        RandomDynamic,
+        RandomRotSpeed,
+        RandomScaleSpeed,
+        RandomRotAngle,
+        RandomScaleAngle,
+        RandomTickInterval,
+        RandomStreamCount,
+    };
+
+    /// @~english
+    /// @brief Get a random number in [0, 1) from the seed, an index and a stream
+    /// @~japanese
+    /// @brief シード、番号、系列から[0, 1)の乱数を取得
+    float Random(UINT seed, UINT index, UINT stream) {
+        UINT hash = seed * 0x9e3779b9u ^ index * 0x85ebca6bu ^ stream * 0xc2b2ae35u;
+        hash ^= hash >> 16;
+        hash *= 0x7feb352du;
+        hash ^= hash >> 15;
+        hash *= 0x846ca68bu;
+        hash ^= hash >> 16;
+        return static_cast<float>(hash >> 8) * (1.0f / 16777216.0f);
+    }
+
+    /// @~english
+    /// @brief Get a random number in [-1, 1) bunched around 0, the mean of three uniform numbers
+    /// @~japanese
+    /// @brief 0の周りに集まる[-1, 1)の乱数を取得、3つの一様乱数の平均
+    float RandomBunched(UINT seed, UINT index, UINT stream) {
+        const UINT streamBase = stream * 3 + RandomStreamCount;
+        return (Random(seed, index, streamBase) + Random(seed, index, streamBase + 1) + Random(seed, index, streamBase + 2)) * (2.0f / 3.0f) - 1.0f;
+    }
+
+    /// @~english
+    /// @brief Get the position of an actor in [-1, 1) on each axis
+    /// @~japanese
+    /// @brief アクタの位置を各軸[-1, 1)で取得
+    XMFLOAT3 GetNormalizedPosition(const StressSceneDesc &desc, UINT index, UINT gridSize) {
+        switch (desc.distribution) {
+        case StressSceneDistribution::Clustered: {
+            // Clusters span a quarter of the volume on each axis, their centers are uniform
+            // クラスタは各軸で空間の4分の1に広がり、その中心は一様
+            const UINT clusterCount = std::max(desc.clusterCount, 1u);
+            const UINT cluster = std::min(static_cast<UINT>(Random(desc.seed, index, RandomCluster) * clusterCount), clusterCount - 1);
+            const UINT clusterIndex = ~cluster;
+            XMFLOAT3 position;
+            position.x = std::clamp(Random(desc.seed, clusterIndex, RandomPositionX) * 1.5f - 0.75f + RandomBunched(desc.seed, index, RandomPositionX) * 0.25f, -1.0f, 1.0f);
+            position.y = std::clamp(Random(desc.seed, clusterIndex, RandomPositionY) * 1.5f - 0.75f + RandomBunched(desc.seed, index, RandomPositionY) * 0.25f, -1.0f, 1.0f);
+            position.z = std::clamp(Random(desc.seed, clusterIndex, RandomPositionZ) * 1.5f - 0.75f + RandomBunched(desc.seed, index, RandomPositionZ) * 0.25f, -1.0f, 1.0f);
+            return position;
+        }
+        case StressSceneDistribution::Grid: {
+            const float step = 2.0f / gridSize;
+            return XMFLOAT3(
+                (index % gridSize + 0.5f) * step - 1.0f,
+                (index / gridSize % gridSize + 0.5f) * step - 1.0f,
+                (index / gridSize / gridSize + 0.5f) * step - 1.0f);
+        }
+        default:
+            return XMFLOAT3(
+                Random(desc.seed, index, RandomPositionX) * 2.0f - 1.0f,
+                Random(desc.seed, index, RandomPositionY) * 2.0f - 1.0f,
+                Random(desc.seed, index, RandomPositionZ) * 2.0f - 1.0f);
+        }
+    }
+} // namespace ""
+
+// Generate a stress scene as a scene snapshot file
+// ストレスシーンをシーンスナップショットファイルとして生成
+bool GenerateStressScene(const StressSceneDesc &desc, const char *path) {
+    const UINT count = desc.actorCount;
+    std::vector<XMFLOAT4>            translations(count);
+    std::vector<XMFLOAT4>            rotations(count);
+    std::vector<XMFLOAT4>            scales(count);
+    std::vector<UINT>                nodes(count);
+    std::vector<UINT>                nodeParents(count, INVALID_SCENE_SNAPSHOT_INDEX);
+    std::vector<UINT>                nodeSubtreeSizes(count, 1);
+    std::vector<SceneSnapshotTick>   ticks(count);
+    std::vector<SceneSnapshotMotion> motions(count);
+
+    UINT gridSize = 1;
+    while (gridSize * gridSize * gridSize < count) {
+        ++gridSize;
+    }
+
+    for (UINT i = 0; i < count; ++i) {
+        // Every actor is a root with its own node
+        // 全アクタは自身のノードを持つルート
+        nodes[i] = i;
+
+        // The volume lies in front of the default camera
+        // 空間はデフォルトのカメラの前方にある
+        const XMFLOAT3 position = GetNormalizedPosition(desc, i, gridSize);
+        translations[i] = XMFLOAT4(position.x * desc.extent, position.y * desc.extent, (position.z + 1.0f) * desc.extent, 1.0f);
+        scales[i]       = XMFLOAT4(desc.scale, desc.scale, desc.scale, 0.0f);
+
+        SceneSnapshotMotion &motion = motions[i];
+        motion.rotSpeed   = 0.1f + Random(desc.seed, i, RandomRotSpeed) * 0.9f;
+        motion.scaleSpeed = 0.1f + Random(desc.seed, i, RandomScaleSpeed) * 0.4f;
+        motion.rotAngle   = Random(desc.seed, i, RandomRotAngle) * 360.0f;
+        motion.scaleAngle = Random(desc.seed, i, RandomScaleAngle) * 2.0f * XM_PI;
+        rotations[i] = XMFLOAT4(0.0f, 0.0f, motion.rotAngle, 0.0f);
+
+        // Static actors sleep and are never ticked, dynamic ones spread over a few intervals
+        // 静的なアクタは休止し更新されない、動的なものはいくつかの間隔に分散する
+        SceneSnapshotTick &tick = ticks[i];
+        tick.tickGroup        = static_cast<UINT>(TickGroup::Update);
+        tick.tickInterval     = 1;
+        tick.tickDistanceStep = 0.0f;
+        tick.flags            = 0;
+        if (desc.dynamicRatio <= Random(desc.seed, i, RandomDynamic)) {
+            tick.flags |= SCENE_SNAPSHOT_FLAG_SLEEPING;
+        } else if (Random(desc.seed, i, RandomTickInterval) < 0.25f) {
+            tick.tickInterval = 2;
+        }
+    }
+
+    SceneSnapshotWriter writer;
+    writer.SetActorCount(SceneSnapshotActorType::Triangle, count);
+    writer.SetArray(SceneSnapshotActorType::Triangle, SceneSnapshotField::Translation, translations.data());
+    writer.SetArray(SceneSnapshotActorType::Triangle, SceneSnapshotField::Rotation, rotations.data());
+    writer.SetArray(SceneSnapshotActorType::Triangle, SceneSnapshotField::Scale, scales.data());
+    writer.SetArray(SceneSnapshotActorType::Triangle, SceneSnapshotField::Node, nodes.data());
+    writer.SetArray(SceneSnapshotActorType::Triangle, SceneSnapshotField::Tick, ticks.data());
+    writer.SetArray(SceneSnapshotActorType::Triangle, SceneSnapshotField::Params, motions.data());
+    writer.SetActorCount(SceneSnapshotActorType::Camera, 0);
+    writer.SetHierarchy(nodeParents.data(), nodeSubtreeSizes.data());
+    return writer.SaveToFile(path);
+}
+
+// Get the name of a distribution
+// 分布の名前を取得
+const char* GetStressSceneDistributionName(StressSceneDistribution distribution) {
+    return DISTRIBUTION_NAMES[static_cast<UINT>(distribution)];
+}
+
+// Find a distribution by its name
+// 名前から分布を検索
+bool FindStressSceneDistribution(const char *name, StressSceneDistribution *dstDistribution) {
+    for (UINT i = 0; i < static_cast<UINT>(StressSceneDistribution::Count); ++i) {
+        if (strcmp(name, DISTRIBUTION_NAMES[i]) == 0) {
+            *dstDistribution = static_cast<StressSceneDistribution>(i);
+            return true;
+        }
+    }
+    return false;
+}
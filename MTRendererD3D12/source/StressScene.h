@@ -0,0 +1,90 @@
+/// @file StressScene.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+#include "SceneSnapshot.h"
+
+// Default value
+const float DEFAULT_STRESS_SCENE_DYNAMIC_RATIO  = 0.5f;
+const float DEFAULT_STRESS_SCENE_EXTENT         = 50.0f;    // Half size of the volume holding the actors
+const float DEFAULT_STRESS_SCENE_SCALE          = 0.25f;
+const UINT  DEFAULT_STRESS_SCENE_CLUSTER_COUNT  = 16;
+
+
+/// @~english
+/// @brief Spatial distribution of the actors of a stress scene
+/// @~japanese
+/// @brief ストレスシーンのアクタの空間分布
+/// @~
+/// @enum StressSceneDistribution
+enum class StressSceneDistribution : UINT {
+    Uniform,        ///< @~english Spread evenly over the volume @~japanese 空間全体に均等に分散
+    Clustered,      ///< @~english Gathered around a few centers, dense and empty regions @~japanese 少数の中心の周りに集まる、密な領域と空の領域
+    Grid,           ///< @~english On a regular lattice @~japanese 規則的な格子上
+    Count,
+};
+
+
+/// @~english
+/// @brief Parameters of a stress scene
+/// @~japanese
+/// @brief ストレスシーンのパラメータ
+/// @~
+/// @struct StressSceneDesc
+struct StressSceneDesc {
+    UINT                    actorCount;
+    float                   dynamicRatio;   ///< @~english Share of actors updated every frame, the others sleep @~japanese 毎フレーム更新するアクタの割合、その他は休止する
+    StressSceneDistribution distribution;
+    float                   extent;         ///< @~english Half size of the volume, centered in front of the default camera @~japanese 空間の半分のサイズ、デフォルトのカメラの前方を中心とする
+    float                   scale;
+    UINT                    clusterCount;
+    UINT                    seed;
+
+    /// @brief コンストラクタ
+    StressSceneDesc()
+    : actorCount(0)
+    , dynamicRatio(DEFAULT_STRESS_SCENE_DYNAMIC_RATIO)
+    , distribution(StressSceneDistribution::Uniform)
+    , extent(DEFAULT_STRESS_SCENE_EXTENT)
+    , scale(DEFAULT_STRESS_SCENE_SCALE)
+    , clusterCount(DEFAULT_STRESS_SCENE_CLUSTER_COUNT)
+    , seed(0)
+    {
+        ;
+    }
+};
+
+
+/// @~english
+/// @brief Generate a stress scene as a scene snapshot file
+/// @details The scene only depends on the parameters, every value comes from a hash of the seed and the
+///          actor index, so the same file is generated on every platform and the actors can be generated
+///          in any order. Loaded with MTRenderer::LoadSceneSnapshot, the benchmark runs compare the same
+///          scene.
+/// @param[in] desc Parameters
+/// @param[in] path Path of the snapshot file
+/// @return True if succeeded, false if the file can not be written
+/// @~japanese
+/// @brief ストレスシーンをシーンスナップショットファイルとして生成
+/// @details シーンはパラメータのみに依存し、全ての値はシードとアクタ番号のハッシュから得る為、どの
+///          プラットフォームでも同じファイルが生成され、アクタは任意の順で生成できる。
+///          MTRenderer::LoadSceneSnapshotで読み込み、ベンチマークの実行は同じシーンを比較する
+/// @param[in] desc パラメータ
+/// @param[in] path スナップショットファイルのパス
+/// @return 成功した場合にはTrue、ファイルに書き込めない場合はFalseを返す
+bool GenerateStressScene(const StressSceneDesc &desc, const char *path);
+
+/// @~english
+/// @brief Get the name of a distribution
+/// @~japanese
+/// @brief 分布の名前を取得
+const char* GetStressSceneDistributionName(StressSceneDistribution distribution);
+
+/// @~english
+/// @brief Find a distribution by its name
+/// @return True if found, false otherwise
+/// @~japanese
+/// @brief 名前から分布を検索
+/// @return 見つかった場合はTrue、そうでないならFalseを返す
+bool FindStressSceneDistribution(const char *name, StressSceneDistribution *dstDistribution);
@@ -0,0 +1,439 @@
+/// @file ThreadTopology.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "ThreadTopology.h"
+
+#if !defined(_WIN32)
+    #include <pthread.h>
+    #include <sched.h>
+    #include <sys/resource.h>
+#endif
+
+namespace {
+#if defined(_WIN32)
+// Read the cores and caches from GetLogicalProcessorInformationEx
+// GetLogicalProcessorInformationExからコアとキャッシュを読む
+bool DetectProcessors(std::vector<LogicalProcessor> *dstProcessors) {
+    DWORD size = 0;
+    if (GetLogicalProcessorInformationEx(RelationAll, nullptr, &size) || GetLastError() != ERROR_INSUFFICIENT_BUFFER) {
+        return false;
+    }
+    std::vector<BYTE> buffer(size);
+    if (!GetLogicalProcessorInformationEx(RelationAll, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &size)) {
+        return false;
+    }
+
+    // Only the processors the process may run on, the mask is 0 when the process spans several groups
+    // プロセスが実行され得るプロセッサのみ、プロセスが複数のグループにまたがる場合はマスクが0になる
+    DWORD_PTR processMask = 0;
+    DWORD_PTR systemMask  = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) {
+        return false;
+    }
+    USHORT processGroup      = 0;
+    USHORT processGroupCount = 1;
+    if (processMask != 0 && !GetProcessGroupAffinity(GetCurrentProcess(), &processGroupCount, &processGroup)) {
+        return false;
+    }
+    const auto isAllowed = [processMask, processGroup](WORD group, UINT bit) {
+        return processMask == 0 || (group == processGroup && (processMask & (static_cast<DWORD_PTR>(1) << bit)) != 0);
+    };
+
+    // Hybrid CPUs give the performance cores the highest efficiency class
+    // ハイブリッドCPUはパフォーマンスコアに最も高い効率クラスを与える
+    std::vector<BYTE> efficiencyClasses;
+    BYTE maxEfficiencyClass = 0;
+    UINT coreIndex = 0;
+    for (DWORD offset = 0; offset < size; ) {
+        const auto *info = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX *>(buffer.data() + offset);
+        offset += info->Size;
+        if (info->Relationship != RelationProcessorCore) {
+            continue;
+        }
+
+        // The SMT index counts the allowed hardware threads only, a core with none allowed is left out
+        // SMT番号は許可されたハードウェアスレッドのみで数え、許可されたものが無いコアは除外する
+        UINT smtIndex = 0;
+        bool allowedCore = false;
+        for (WORD g = 0; g < info->Processor.GroupCount; ++g) {
+            const GROUP_AFFINITY &groupMask = info->Processor.GroupMask[g];
+            for (UINT bit = 0; bit < 64; ++bit) {
+                if ((groupMask.Mask & (static_cast<KAFFINITY>(1) << bit)) == 0) {
+                    continue;
+                }
+                if (!isAllowed(groupMask.Group, bit)) {
+                    continue;
+                }
+                LogicalProcessor processor;
+                processor.processorIndex = groupMask.Group * 64 + bit;
+                processor.coreIndex      = coreIndex;
+                processor.smtIndex       = smtIndex++;
+                processor.cacheDomain    = INVALID_LOGICAL_PROCESSOR;
+                processor.performance    = true;
+                dstProcessors->push_back(processor);
+                efficiencyClasses.push_back(info->Processor.EfficiencyClass);
+                allowedCore = true;
+            }
+        }
+        maxEfficiencyClass = std::max(maxEfficiencyClass, info->Processor.EfficiencyClass);
+        if (allowedCore) {
+            coreIndex++;
+        }
+    }
+    for (size_t i = 0; i < dstProcessors->size(); ++i) {
+        (*dstProcessors)[i].performance = efficiencyClasses[i] == maxEfficiencyClass;
+    }
+
+    // Each processor belongs to the domain of its highest cache level, named by the first processor sharing it
+    // 各プロセッサは最も高いキャッシュレベルのドメインに属し、ドメインは共有する最初のプロセッサで表す
+    std::vector<BYTE> cacheLevels(dstProcessors->size(), 0);
+    for (DWORD offset = 0; offset < size; ) {
+        const auto *info = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX *>(buffer.data() + offset);
+        offset += info->Size;
+        if (info->Relationship != RelationCache || info->Cache.Type == CacheInstruction) {
+            continue;
+        }
+
+        const GROUP_AFFINITY &groupMask = info->Cache.GroupMask;
+        UINT domain = INVALID_LOGICAL_PROCESSOR;
+        for (UINT bit = 0; bit < 64 && domain == INVALID_LOGICAL_PROCESSOR; ++bit) {
+            if ((groupMask.Mask & (static_cast<KAFFINITY>(1) << bit)) != 0) {
+                domain = groupMask.Group * 64 + bit;
+            }
+        }
+        for (size_t i = 0; i < dstProcessors->size(); ++i) {
+            LogicalProcessor &processor = (*dstProcessors)[i];
+            const UINT bit = processor.processorIndex % 64;
+            if (processor.processorIndex / 64 == groupMask.Group && (groupMask.Mask & (static_cast<KAFFINITY>(1) << bit)) != 0 && cacheLevels[i] < info->Cache.Level) {
+                cacheLevels[i]        = info->Cache.Level;
+                processor.cacheDomain = domain;
+            }
+        }
+    }
+    return !dstProcessors->empty();
+}
+#else
+// Read an unsigned value from a sysfs file
+// sysfsのファイルから符号無しの値を読む
+bool ReadSysfsValue(const std::string &path, UINT *dstValue) {
+    std::ifstream file(path);
+    unsigned long value = 0;
+    if (!(file >> value)) {
+        return false;
+    }
+    *dstValue = static_cast<UINT>(value);
+    return true;
+}
+
+// Read a sysfs list of processors such as "0-3,8,10-11"
+// "0-3,8,10-11"のようなsysfsのプロセッサリストを読む
+bool ReadSysfsList(const std::string &path, std::vector<UINT> *dstList) {
+    std::ifstream file(path);
+    std::string text;
+    if (!std::getline(file, text)) {
+        return false;
+    }
+
+    dstList->clear();
+    const char *cursor = text.c_str();
+    while (*cursor != '\0') {
+        char *end = nullptr;
+        const UINT first = static_cast<UINT>(strtoul(cursor, &end, 10));
+        if (end == cursor) {
+            break;
+        }
+        UINT last = first;
+        cursor = end;
+        if (*cursor == '-') {
+            last = static_cast<UINT>(strtoul(cursor + 1, &end, 10));
+            cursor = end;
+        }
+        for (UINT i = first; i <= last && i < MAX_LOGICAL_PROCESSOR_COUNT; ++i) {
+            dstList->push_back(i);
+        }
+        if (*cursor == ',') {
+            cursor++;
+        }
+    }
+    return !dstList->empty();
+}
+
+// Read the cores and caches from /sys/devices/system/cpu
+// /sys/devices/system/cpuからコアとキャッシュを読む
+bool DetectProcessors(std::vector<LogicalProcessor> *dstProcessors) {
+    cpu_set_t allowedSet;
+    CPU_ZERO(&allowedSet);
+    if (sched_getaffinity(0, sizeof(allowedSet), &allowedSet) != 0) {
+        return false;
+    }
+
+    // Intel hybrid CPUs list their efficiency cores under cpu_atom, others may tell the capacity of each processor
+    // IntelのハイブリッドCPUは効率コアをcpu_atomに列挙し、それ以外は各プロセッサの能力を示す場合がある
+    std::vector<UINT> atomList;
+    ReadSysfsList("/sys/devices/cpu_atom/cpus", &atomList);
+
+    const std::string cpuRoot = "/sys/devices/system/cpu/cpu";
+    std::vector<UINT> coreKeys;
+    std::vector<UINT> capacities;
+    std::vector<UINT> siblingList;
+    std::vector<UINT> sharedList;
+    bool complete = true;
+    for (UINT cpu = 0; cpu < std::min<UINT>(CPU_SETSIZE, MAX_LOGICAL_PROCESSOR_COUNT); ++cpu) {
+        if (!CPU_ISSET(cpu, &allowedSet)) {
+            continue;
+        }
+        const std::string cpuPath = cpuRoot + std::to_string(cpu);
+
+        // Cores are told apart by package and core id, the sibling list gives the hardware thread order
+        // コアはパッケージとコアのIDで区別し、兄弟リストがハードウェアスレッドの順序を与える
+        UINT packageId = 0;
+        UINT coreId    = 0;
+        UINT coreKey   = 0x80000000u | cpu;
+        UINT smtIndex  = 0;
+        if (ReadSysfsValue(cpuPath + "/topology/physical_package_id", &packageId) && ReadSysfsValue(cpuPath + "/topology/core_id", &coreId)) {
+            coreKey = (packageId << 16) | (coreId & 0xffffu);
+            if (ReadSysfsList(cpuPath + "/topology/thread_siblings_list", &siblingList)) {
+                smtIndex = static_cast<UINT>(std::find(siblingList.begin(), siblingList.end(), cpu) - siblingList.begin());
+            }
+        } else {
+            complete = false;
+        }
+
+        auto foundCore = std::find(coreKeys.begin(), coreKeys.end(), coreKey);
+        if (foundCore == coreKeys.end()) {
+            foundCore = coreKeys.insert(coreKeys.end(), coreKey);
+        }
+
+        UINT cacheDomain = cpu;
+        UINT cacheLevel  = 0;
+        for (UINT index = 0; ; ++index) {
+            const std::string cachePath = cpuPath + "/cache/index" + std::to_string(index);
+            UINT level = 0;
+            if (!ReadSysfsValue(cachePath + "/level", &level)) {
+                break;
+            }
+            if (cacheLevel < level && ReadSysfsList(cachePath + "/shared_cpu_list", &sharedList)) {
+                cacheLevel  = level;
+                cacheDomain = sharedList.front();
+            }
+        }
+
+        UINT capacity = 0;
+        ReadSysfsValue(cpuPath + "/cpu_capacity", &capacity);
+        capacities.push_back(capacity);
+
+        LogicalProcessor processor;
+        processor.processorIndex = cpu;
+        processor.coreIndex      = static_cast<UINT>(foundCore - coreKeys.begin());
+        processor.smtIndex       = smtIndex;
+        processor.cacheDomain    = cacheDomain;
+        processor.performance    = std::find(atomList.begin(), atomList.end(), cpu) == atomList.end();
+        dstProcessors->push_back(processor);
+    }
+
+    const UINT maxCapacity = capacities.empty() ? 0 : *std::max_element(capacities.begin(), capacities.end());
+    if (atomList.empty() && maxCapacity != 0) {
+        for (size_t i = 0; i < dstProcessors->size(); ++i) {
+            (*dstProcessors)[i].performance = capacities[i] == maxCapacity;
+        }
+    }
+    return complete && !dstProcessors->empty();
+}
+#endif
+} // namespace ""
+
+//----------------------------------------------------------------------------------------------------
+// CpuTopology
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+CpuTopology::CpuTopology()
+: coreCount(0)
+, cacheDomainCount(0)
+, performanceCoreCount(0)
+{
+    ;
+}
+
+// Detect the topology
+// トポロジを検出
+bool CpuTopology::Detect() {
+    processors.clear();
+    const bool detected = DetectProcessors(&processors);
+
+    if (!detected) {
+        // Every processor is a core of its own in one cache domain
+        // 各プロセッサを1つのキャッシュドメイン内の独立したコアとみなす
+        processors.clear();
+        const UINT processorCount = std::clamp(std::thread::hardware_concurrency(), 1u, MAX_LOGICAL_PROCESSOR_COUNT);
+        for (UINT i = 0; i < processorCount; ++i) {
+            LogicalProcessor processor;
+            processor.processorIndex = i;
+            processor.coreIndex      = i;
+            processor.smtIndex       = 0;
+            processor.cacheDomain    = 0;
+            processor.performance    = true;
+            processors.push_back(processor);
+        }
+    }
+
+    Finalize();
+    return detected;
+}
+
+// Number the cores and cache domains from 0 and count them
+// コアとキャッシュドメインに0から番号を振り、数える
+void CpuTopology::Finalize() {
+    std::sort(processors.begin(), processors.end(), [](const LogicalProcessor &a, const LogicalProcessor &b) {
+        return a.processorIndex < b.processorIndex;
+    });
+
+    std::vector<UINT> coreIds;
+    std::vector<UINT> domainIds;
+    std::vector<bool> corePerformance;
+    for (auto &processor : processors) {
+        auto foundCore = std::find(coreIds.begin(), coreIds.end(), processor.coreIndex);
+        if (foundCore == coreIds.end()) {
+            foundCore = coreIds.insert(coreIds.end(), processor.coreIndex);
+            corePerformance.push_back(processor.performance);
+        }
+        auto foundDomain = std::find(domainIds.begin(), domainIds.end(), processor.cacheDomain);
+        if (foundDomain == domainIds.end()) {
+            foundDomain = domainIds.insert(domainIds.end(), processor.cacheDomain);
+        }
+        processor.coreIndex   = static_cast<UINT>(foundCore - coreIds.begin());
+        processor.cacheDomain = static_cast<UINT>(foundDomain - domainIds.begin());
+    }
+
+    coreCount            = static_cast<UINT>(coreIds.size());
+    cacheDomainCount     = static_cast<UINT>(domainIds.size());
+    performanceCoreCount = static_cast<UINT>(std::count(corePerformance.begin(), corePerformance.end(), true));
+}
+
+//----------------------------------------------------------------------------------------------------
+// ThreadPlacement
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+ThreadPlacement::ThreadPlacement() {
+    ;
+}
+
+// Initialize
+// 初期化
+void ThreadPlacement::Init(const CpuTopology &topology, const ThreadPlacementDesc &inDesc) {
+    desc = inDesc;
+    ranking.clear();
+
+    const auto &processors = topology.GetProcessors();
+    if (!desc.pinThreads || processors.size() < 3) {
+        return;
+    }
+
+    // The MainThread and the RenderThread go to the cache domain holding the most performance cores
+    // MainThreadとRenderThreadは最も多くのパフォーマンスコアを持つキャッシュドメインに置く
+    std::vector<UINT> domainCoreCounts(topology.GetCacheDomainCount(), 0);
+    for (const auto &processor : processors) {
+        if (processor.performance && processor.smtIndex == 0) {
+            domainCoreCounts[processor.cacheDomain]++;
+        }
+    }
+    const UINT firstDomain = static_cast<UINT>(std::max_element(domainCoreCounts.begin(), domainCoreCounts.end()) - domainCoreCounts.begin());
+
+    std::vector<LogicalProcessor> ordered(processors);
+    std::stable_sort(ordered.begin(), ordered.end(), [firstDomain](const LogicalProcessor &a, const LogicalProcessor &b) {
+        return std::make_tuple(a.smtIndex, !a.performance, a.cacheDomain != firstDomain, a.cacheDomain, a.coreIndex)
+             < std::make_tuple(b.smtIndex, !b.performance, b.cacheDomain != firstDomain, b.cacheDomain, b.coreIndex);
+    });
+
+    ranking.reserve(ordered.size());
+    for (const auto &processor : ordered) {
+        ranking.push_back(processor.processorIndex);
+    }
+}
+
+// Get the logical processor of a thread
+// スレッドの論理プロセッサを取得
+UINT ThreadPlacement::GetProcessor(ThreadRole role, UINT workerIndex) const {
+    if (ranking.empty()) {
+        return INVALID_LOGICAL_PROCESSOR;
+    }
+
+    switch (role) {
+    case ThreadRole::Main:
+        return ranking[0];
+    case ThreadRole::Render:
+        return ranking[1];
+    default:
+        return ranking[2 + workerIndex % (ranking.size() - 2)];
+    }
+}
+
+// Pin the calling thread and set its priority
+// 呼び出し元スレッドを固定し優先度を設定
+bool ThreadPlacement::ApplyToCurrentThread(ThreadRole role, UINT workerIndex) const {
+    bool succeeded = true;
+
+    const UINT processorIndex = GetProcessor(role, workerIndex);
+    if (processorIndex != INVALID_LOGICAL_PROCESSOR) {
+        succeeded = SetCurrentThreadProcessor(processorIndex);
+    }
+
+    const ThreadPriority priority = desc.priorities[std::min(static_cast<UINT>(role), static_cast<UINT>(ThreadRole::Worker))];
+    if (priority != ThreadPriority::Normal) {
+        succeeded = SetCurrentThreadPriority(priority) && succeeded;
+    }
+    return succeeded;
+}
+
+#if defined(_WIN32)
+// Bind the calling thread to a logical processor
+// 呼び出し元スレッドを論理プロセッサに固定
+bool ThreadPlacement::SetCurrentThreadProcessor(UINT processorIndex) {
+    GROUP_AFFINITY affinity = {};
+    affinity.Mask  = static_cast<KAFFINITY>(1) << (processorIndex % 64);
+    affinity.Group = static_cast<WORD>(processorIndex / 64);
+    return SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr) != FALSE;
+}
+
+// Set the priority of the calling thread
+// 呼び出し元スレッドの優先度を設定
+bool ThreadPlacement::SetCurrentThreadPriority(ThreadPriority priority) {
+    static const int threadPriorities[] = { THREAD_PRIORITY_BELOW_NORMAL, THREAD_PRIORITY_NORMAL, THREAD_PRIORITY_ABOVE_NORMAL, THREAD_PRIORITY_HIGHEST };
+    return SetThreadPriority(GetCurrentThread(), threadPriorities[static_cast<UINT>(priority)]) != FALSE;
+}
+#else
+// Bind the calling thread to a logical processor
+// 呼び出し元スレッドを論理プロセッサに固定
+bool ThreadPlacement::SetCurrentThreadProcessor(UINT processorIndex) {
+    if (CPU_SETSIZE <= processorIndex) {
+        return false;
+    }
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(processorIndex, &cpuSet);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+}
+
+// Set the priority of the calling thread
+// 呼び出し元スレッドの優先度を設定
+bool ThreadPlacement::SetCurrentThreadPriority(ThreadPriority priority) {
+    // Linux schedules threads as tasks, so pid 0 and PRIO_PROCESS 0 name the calling thread only,
+    // a negative nice value needs CAP_SYS_NICE and the real-time class also RLIMIT_RTPRIO
+    // Linuxはスレッドをタスクとしてスケジュールする為、pid 0とPRIO_PROCESS 0は呼び出し元スレッドのみを指す、
+    // 負のnice値にはCAP_SYS_NICE、リアルタイムクラスには加えてRLIMIT_RTPRIOが必要
+    sched_param param = {};
+    switch (priority) {
+    case ThreadPriority::Low:
+        return sched_setscheduler(0, SCHED_BATCH, &param) == 0;
+    case ThreadPriority::Normal:
+        return sched_setscheduler(0, SCHED_OTHER, &param) == 0 && setpriority(PRIO_PROCESS, 0, 0) == 0;
+    case ThreadPriority::AboveNormal:
+        return sched_setscheduler(0, SCHED_OTHER, &param) == 0 && setpriority(PRIO_PROCESS, 0, -5) == 0;
+    default:
+        param.sched_priority = sched_get_priority_min(SCHED_RR);
+        return sched_setscheduler(0, SCHED_RR, &param) == 0;
+    }
+}
+#endif
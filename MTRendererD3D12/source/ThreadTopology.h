@@ -0,0 +1,246 @@
+/// @file ThreadTopology.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+// Default value
+const UINT MAX_LOGICAL_PROCESSOR_COUNT  = 1024;
+const UINT INVALID_LOGICAL_PROCESSOR    = ~0u;
+
+
+/// @~english
+/// @brief Logical processor and its place in the CPU topology
+/// @~japanese
+/// @brief 論理プロセッサとCPUトポロジ内でのその位置
+/// @~
+/// @struct LogicalProcessor
+struct LogicalProcessor {
+    UINT    processorIndex;     ///< @~english Index used by the OS, group * 64 + number on Windows @~japanese OSが使用する番号、Windowsではグループ * 64 + 番号
+    UINT    coreIndex;          ///< @~english Physical core @~japanese 物理コア
+    UINT    smtIndex;           ///< @~english 0 for the first hardware thread of the core @~japanese コアの最初のハードウェアスレッドは0
+    UINT    cacheDomain;        ///< @~english Processors sharing the last level cache @~japanese 最終レベルキャッシュを共有するプロセッサ
+    bool    performance;        ///< @~english Performance core, every core is one on non-hybrid CPUs @~japanese パフォーマンスコア、ハイブリッドでないCPUでは全コアが該当する
+};
+
+
+/// @class CpuTopology
+/// @~english
+/// @brief Physical cores, SMT siblings, cache domains and core types of the processors the process may run on
+/// @details Windows reads GetLogicalProcessorInformationEx, Linux reads /sys/devices/system/cpu. When the
+///          topology is unknown every processor is taken as a performance core of its own.
+/// @~japanese
+/// @brief プロセスが実行され得るプロセッサの物理コア、SMTの兄弟、キャッシュドメイン、コア種別
+/// @details WindowsはGetLogicalProcessorInformationEx、Linuxは/sys/devices/system/cpuを読む。トポロジが
+///          不明な場合は各プロセッサをそれぞれ独立したパフォーマンスコアとみなす
+class CpuTopology {
+public:
+    /// @~english
+    /// @brief Detect the topology
+    /// @return True if the topology was read from the OS, false if it was guessed
+    /// @~japanese
+    /// @brief トポロジを検出
+    /// @return トポロジをOSから読んだ場合にはTrue、推測した場合はFalseを返す
+    bool Detect();
+
+    /// @~english
+    /// @brief Get the logical processors ordered by processor index
+    /// @~japanese
+    /// @brief プロセッサ番号順の論理プロセッサを取得
+    const std::vector<LogicalProcessor>& GetProcessors() const {
+        return processors;
+    }
+
+    UINT GetCoreCount() const {
+        return coreCount;
+    }
+
+    UINT GetCacheDomainCount() const {
+        return cacheDomainCount;
+    }
+
+    UINT GetPerformanceCoreCount() const {
+        return performanceCoreCount;
+    }
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    CpuTopology();
+
+private:
+    /// @~english
+    /// @brief Number the cores and cache domains from 0 and count them
+    /// @~japanese
+    /// @brief コアとキャッシュドメインに0から番号を振り、数える
+    void Finalize();
+
+private:
+    std::vector<LogicalProcessor>   processors;
+    UINT                            coreCount;
+    UINT                            cacheDomainCount;
+    UINT                            performanceCoreCount;
+};
+
+
+/// @enum ThreadRole
+enum class ThreadRole : UINT {
+    Main,
+    Render,
+    Worker,
+    Count,
+};
+
+
+/// @enum ThreadPriority
+enum class ThreadPriority : UINT {
+    Low,            ///< @~english Background work @~japanese バックグラウンド処理
+    Normal,
+    AboveNormal,
+    Highest,        ///< @~english Round robin real-time class on Linux @~japanese Linuxではラウンドロビンのリアルタイムクラス
+};
+
+
+/// @~english
+/// @brief Configuration of the thread placement
+/// @~japanese
+/// @brief スレッド配置の設定
+/// @~
+/// @struct ThreadPlacementDesc
+struct ThreadPlacementDesc {
+    bool            pinThreads;     ///< @~english Bind each thread to one logical processor @~japanese 各スレッドを1つの論理プロセッサに固定する
+    ThreadPriority  priorities[static_cast<UINT>(ThreadRole::Count)];
+
+    /// @brief コンストラクタ
+    ThreadPlacementDesc()
+    : pinThreads(true)
+    , priorities{ ThreadPriority::AboveNormal, ThreadPriority::AboveNormal, ThreadPriority::Normal }
+    {
+        ;
+    }
+};
+
+
+/// @class ThreadPlacement
+/// @~english
+/// @brief Assignment of the MainThread, the RenderThread and the workers to logical processors
+/// @details The processors are ranked by the first hardware thread of each core before its SMT siblings,
+///          then performance cores before efficiency cores, then the cache domain holding the most
+///          performance cores before the others. The MainThread and the RenderThread take the first two
+///          so they share a cache domain on separate physical cores, the workers take the rest in order
+///          and wrap around when there are more workers than processors. Nothing is pinned when there are
+///          fewer than three processors.
+/// @~japanese
+/// @brief MainThread、RenderThread、ワーカーの論理プロセッサへの割り当て
+/// @details プロセッサは各コアの最初のハードウェアスレッドをSMTの兄弟より先に、パフォーマンスコアを
+///          効率コアより先に、最も多くのパフォーマンスコアを持つキャッシュドメインを他より先に並べる。
+///          MainThreadとRenderThreadは先頭の2つを取り、別々の物理コアでキャッシュドメインを共有する。
+///          ワーカーは残りを順に取り、プロセッサより多い場合は先頭に戻る。プロセッサが3つ未満の場合は
+///          固定しない
+class ThreadPlacement {
+public:
+    /// @~english
+    /// @brief Initialize
+    /// @param[in] topology Detected topology
+    /// @param[in] desc Configuration
+    /// @~japanese
+    /// @brief 初期化
+    /// @param[in] topology 検出したトポロジ
+    /// @param[in] desc 設定
+    void Init(const CpuTopology &topology, const ThreadPlacementDesc &desc);
+
+    /// @~english
+    /// @brief Get the logical processor of a thread
+    /// @param[in] role Role of the thread
+    /// @param[in] workerIndex Index of the worker, ignored by the other roles
+    /// @return Processor index, INVALID_LOGICAL_PROCESSOR if the thread is not pinned
+    /// @~japanese
+    /// @brief スレッドの論理プロセッサを取得
+    /// @param[in] role スレッドの役割
+    /// @param[in] workerIndex ワーカーの番号、他の役割では無視する
+    /// @return プロセッサ番号、スレッドを固定しない場合はINVALID_LOGICAL_PROCESSOR
+    UINT GetProcessor(ThreadRole role, UINT workerIndex) const;
+
+    /// @~english
+    /// @brief Pin the calling thread and set its priority
+    /// @param[in] role Role of the thread
+    /// @param[in] workerIndex Index of the worker, ignored by the other roles
+    /// @return True if both succeeded, false otherwise (raising the priority may need privileges)
+    /// @~japanese
+    /// @brief 呼び出し元スレッドを固定し優先度を設定
+    /// @param[in] role スレッドの役割
+    /// @param[in] workerIndex ワーカーの番号、他の役割では無視する
+    /// @return 両方に成功した場合にはTrue、そうでないならFalseを返す（優先度の引き上げには権限が必要な場合がある）
+    bool ApplyToCurrentThread(ThreadRole role, UINT workerIndex) const;
+
+    bool IsPinned() const {
+        return !ranking.empty();
+    }
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    ThreadPlacement();
+
+private:
+    /// @~english
+    /// @brief Bind the calling thread to a logical processor
+    /// @~japanese
+    /// @brief 呼び出し元スレッドを論理プロセッサに固定
+    static bool SetCurrentThreadProcessor(UINT processorIndex);
+
+    /// @~english
+    /// @brief Set the priority of the calling thread
+    /// @~japanese
+    /// @brief 呼び出し元スレッドの優先度を設定
+    static bool SetCurrentThreadPriority(ThreadPriority priority);
+
+private:
+    ThreadPlacementDesc     desc;
+    std::vector<UINT>       ranking;        ///< @~english Processor indices in the order they are handed out @~japanese 割り当てる順のプロセッサ番号
+};
+
+
+/// @~english
+/// @brief Frame time distribution over a report interval, to compare thread placements
+/// @~japanese
+/// @brief レポート間隔内のフレーム時間の分布、スレッド配置の比較用
+/// @~
+/// @struct FrameTimeStats
+struct FrameTimeStats {
+    UINT    frameCount;
+    double  sumInMs;
+    double  sumSqInMs;
+    float   maxTimeInMs;
+
+    /// @brief Add a frame
+    void Add(float timeInMs) {
+        frameCount++;
+        sumInMs     += timeInMs;
+        sumSqInMs   += static_cast<double>(timeInMs) * timeInMs;
+        maxTimeInMs  = std::max(maxTimeInMs, timeInMs);
+    }
+
+    float GetMeanInMs() const {
+        return (frameCount != 0) ? static_cast<float>(sumInMs / frameCount) : 0.0f;
+    }
+
+    float GetStdDevInMs() const {
+        if (frameCount < 2) {
+            return 0.0f;
+        }
+        const double mean = sumInMs / frameCount;
+        return static_cast<float>(std::sqrt(std::max(sumSqInMs / frameCount - mean * mean, 0.0)));
+    }
+
+    /// @brief コンストラクタ
+    FrameTimeStats()
+    : frameCount(0)
+    , sumInMs(0.0)
+    , sumSqInMs(0.0)
+    , maxTimeInMs(0.0f)
+    {
+        ;
+    }
+};
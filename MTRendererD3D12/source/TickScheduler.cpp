@@ -0,0 +1,262 @@
+/// @file TickScheduler.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "TickScheduler.h"
+#include "JobSystem.h"
+#include "SceneActor.h"
+
+using namespace DirectX;
+
+//----------------------------------------------------------------------------------------------------
+// TickScheduler
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+TickScheduler::TickScheduler()
+: frameIndex(0)
+, searchStamp(0)
+, runningTasks(nullptr)
+, readyWriteIndex(0)
+, readyReadIndex(0)
+, tickTimeInNs(0)
+{
+    ;
+}
+
+// Add an actor to the schedule
+// アクタをスケジュールへ追加
+void TickScheduler::Register(SceneActor *actor) {
+    actor->tickPhase     = static_cast<UINT>(actors.size());
+    actor->tickTaskIndex = INVALID_TICK_TASK;
+    actors.push_back(actor);
+}
+
+// Add an actor to the schedule in a slot made by AddSlots
+// AddSlotsで作ったスロットへアクタをスケジュールに追加
+void TickScheduler::RegisterAt(UINT slot, SceneActor *actor) {
+    actor->tickPhase     = slot;
+    actor->tickTaskIndex = INVALID_TICK_TASK;
+    actors[slot] = actor;
+}
+
+// Make an actor tick after a prerequisite within the same frame
+// 同じフレーム内でアクタを前提条件の後に更新させる
+bool TickScheduler::AddPrerequisite(SceneActor *actor, SceneActor *prerequisite) {
+    if (actor == nullptr || prerequisite == nullptr || actor == prerequisite) {
+        return false;
+    }
+    if (static_cast<UINT>(actor->tickGroup) < static_cast<UINT>(prerequisite->tickGroup)) {
+        return false;
+    }
+    if (IsPrerequisiteOf(actor, prerequisite)) {
+        return false;
+    }
+
+    auto &prerequisites = actor->tickPrerequisites;
+    if (std::find(prerequisites.begin(), prerequisites.end(), prerequisite) == prerequisites.end()) {
+        prerequisites.push_back(prerequisite);
+    }
+    return true;
+}
+
+// Tick the actors due this frame, group by group
+// 今フレーム更新するアクタをグループ毎に更新
+void TickScheduler::Tick(float delta, FXMVECTOR viewPosition, const TransformHierarchy &hierarchy, JobSystem *jobSystem) {
+    frameIndex++;
+
+    for (UINT group = 0; group < TICK_GROUP_COUNT; ++group) {
+        groupTasks[group].clear();
+        stats[group] = TickGroupStats();
+    }
+
+    // Sort the actors due this frame into their groups, group changes made while ticking apply next frame
+    // 今フレーム更新するアクタをグループへ振り分け、更新中のグループ変更は次のフレームから適用される
+    for (auto actor : actors) {
+        const UINT group = static_cast<UINT>(actor->tickGroup);
+        actor->tickTaskIndex = INVALID_TICK_TASK;
+
+        if (actor->sleeping) {
+            stats[group].sleepingCount++;
+            continue;
+        }
+        actor->tickAccumulatedDelta += delta;
+
+        UINT interval = actor->tickInterval;
+        if (0.0f < actor->tickDistanceStep && actor->transformNode != INVALID_TRANSFORM_NODE) {
+            const XMVECTOR position = hierarchy.GetWorldMatrix(actor->transformNode).r[3];
+            const float distance = XMVectorGetX(XMVector3Length(XMVectorSubtract(position, viewPosition)));
+            interval = std::max(interval, 1 + static_cast<UINT>(std::min(distance / actor->tickDistanceStep, static_cast<float>(MAX_TICK_INTERVAL))));
+        }
+        interval = std::min(interval, MAX_TICK_INTERVAL);
+
+        if (((frameIndex + actor->tickPhase) % interval) != 0) {
+            stats[group].throttledCount++;
+            continue;
+        }
+
+        actor->tickTaskIndex = static_cast<UINT>(groupTasks[group].size());
+        groupTasks[group].push_back(actor);
+    }
+
+    for (UINT group = 0; group < TICK_GROUP_COUNT; ++group) {
+        RunGroup(group, jobSystem);
+    }
+}
+
+// Tick the actors of a group in dependency order
+// グループのアクタを依存順に更新
+void TickScheduler::RunGroup(UINT group, JobSystem *jobSystem) {
+    const auto &tasks = groupTasks[group];
+    const UINT taskCount = static_cast<UINT>(tasks.size());
+    stats[group].tickedCount = taskCount;
+    if (taskCount == 0) {
+        return;
+    }
+
+    const auto beginTime = std::chrono::high_resolution_clock::now();
+
+    // Only prerequisites ticked in this group are waited for
+    // このグループで更新する前提条件のみを待つ
+    auto sameGroupTask = [group](const SceneActor *prerequisite) {
+        return (static_cast<UINT>(prerequisite->tickGroup) == group) ? prerequisite->tickTaskIndex : INVALID_TICK_TASK;
+    };
+
+    // Build the dependents of each task, the offsets end up shifted by one task and are moved back
+    // 各タスクの依存先を構築、オフセットは1タスク分ずれるので戻す
+    dependentOffsets.assign(taskCount + 1, 0);
+    for (auto actor : tasks) {
+        for (auto prerequisite : actor->tickPrerequisites) {
+            const UINT prerequisiteTask = sameGroupTask(prerequisite);
+            if (prerequisiteTask != INVALID_TICK_TASK) {
+                dependentOffsets[prerequisiteTask + 1]++;
+            }
+        }
+    }
+    for (UINT i = 0; i < taskCount; ++i) {
+        dependentOffsets[i + 1] += dependentOffsets[i];
+    }
+    dependents.resize(dependentOffsets[taskCount]);
+    stats[group].dependencyCount = dependentOffsets[taskCount];
+
+    if (pendingCounts.size() < taskCount) {
+        pendingCounts = std::vector<std::atomic<UINT>>(taskCount);
+        readySlots    = std::vector<std::atomic<UINT>>(taskCount);
+    }
+
+    for (UINT i = 0; i < taskCount; ++i) {
+        UINT pendingCount = 0;
+        for (auto prerequisite : tasks[i]->tickPrerequisites) {
+            const UINT prerequisiteTask = sameGroupTask(prerequisite);
+            if (prerequisiteTask != INVALID_TICK_TASK) {
+                dependents[dependentOffsets[prerequisiteTask]++] = i;
+                pendingCount++;
+            }
+        }
+        pendingCounts[i].store(pendingCount, std::memory_order_relaxed);
+        readySlots[i].store(0, std::memory_order_relaxed);
+    }
+    for (UINT i = taskCount; 0 < i; --i) {
+        dependentOffsets[i] = dependentOffsets[i - 1];
+    }
+    dependentOffsets[0] = 0;
+
+    runningTasks = &tasks;
+    readyWriteIndex.store(0, std::memory_order_relaxed);
+    readyReadIndex.store(0, std::memory_order_relaxed);
+    tickTimeInNs.store(0, std::memory_order_relaxed);
+    for (UINT i = 0; i < taskCount; ++i) {
+        if (pendingCounts[i].load(std::memory_order_relaxed) == 0) {
+            PublishTask(i);
+        }
+    }
+
+    // Every thread drains the ready list, small groups are not worth waking the workers for
+    // 全スレッドで準備完了リストを取り出す、小さなグループはワーカーを起こすに値しない
+    if (jobSystem == nullptr || jobSystem->GetWorkerCount() == 0 || taskCount < DEFAULT_TICK_PARALLEL_MIN_COUNT) {
+        DrainReadyTasks();
+    } else {
+        jobSystem->ParallelFor(jobSystem->GetWorkerCount() + 1, 1, [this](UINT begin, UINT end) {
+            DrainReadyTasks();
+        });
+    }
+    runningTasks = nullptr;
+
+    stats[group].timeInMs    = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - beginTime).count();
+    stats[group].cpuTimeInMs = static_cast<float>(tickTimeInNs.load(std::memory_order_relaxed)) / 1000000.0f;
+}
+
+// Tick the ready actors until every actor of the group has been taken
+// グループの全アクタが取得されるまで準備完了のアクタを更新
+void TickScheduler::DrainReadyTasks() {
+    const auto &tasks = *runningTasks;
+    const UINT taskCount = static_cast<UINT>(tasks.size());
+
+    UINT64 localTimeInNs = 0;
+    UINT begin = readyReadIndex.load(std::memory_order_relaxed);
+    for (;;) {
+        // Claim a batch of the slots published so far, at least one slot to wait for when none is
+        // 公開済みのスロットをバッチで取得、1つも無い場合は待つ為に1スロットを取得
+        UINT end = 0;
+        do {
+            if (taskCount <= begin) {
+                break;
+            }
+            const UINT publishedEnd = std::min(readyWriteIndex.load(std::memory_order_relaxed), taskCount);
+            const UINT claimCount   = (begin < publishedEnd) ? std::min(publishedEnd - begin, DEFAULT_TICK_CLAIM_BATCH_SIZE) : 1;
+            end = begin + claimCount;
+        } while (!readyReadIndex.compare_exchange_weak(begin, end, std::memory_order_relaxed));
+        if (taskCount <= begin) {
+            break;
+        }
+
+        const auto beginTime = std::chrono::high_resolution_clock::now();
+        for (UINT slot = begin; slot < end; ++slot) {
+            // The slot is published once a running task finishes its last prerequisite, the graph has no cycle
+            // 実行中のタスクが最後の前提条件を完了するとスロットは公開される、グラフは循環しない
+            UINT published = 0;
+            while ((published = readySlots[slot].load(std::memory_order_acquire)) == 0) {
+                std::this_thread::yield();
+            }
+            const UINT task = published - 1;
+
+            SceneActor *actor = tasks[task];
+            actor->Update(actor->tickAccumulatedDelta);
+            actor->tickAccumulatedDelta = 0.0f;
+
+            for (UINT i = dependentOffsets[task]; i < dependentOffsets[task + 1]; ++i) {
+                const UINT dependent = dependents[i];
+                if (pendingCounts[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    PublishTask(dependent);
+                }
+            }
+        }
+        localTimeInNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - beginTime).count();
+        begin = end;
+    }
+    tickTimeInNs.fetch_add(localTimeInNs, std::memory_order_relaxed);
+}
+
+// Test if an actor is reachable through the prerequisites of another
+// 別のアクタの前提条件を辿ってアクタに到達できるか調べる
+bool TickScheduler::IsPrerequisiteOf(const SceneActor *actor, SceneActor *dependent) {
+    searchStamp++;
+    searchStack.clear();
+    searchStack.push_back(dependent);
+    dependent->tickSearchStamp = searchStamp;
+
+    while (!searchStack.empty()) {
+        const SceneActor *current = searchStack.back();
+        searchStack.pop_back();
+        for (auto prerequisite : current->tickPrerequisites) {
+            if (prerequisite == actor) {
+                return true;
+            }
+            if (prerequisite->tickSearchStamp != searchStamp) {
+                prerequisite->tickSearchStamp = searchStamp;
+                searchStack.push_back(prerequisite);
+            }
+        }
+    }
+    return false;
+}
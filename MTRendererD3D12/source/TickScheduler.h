@@ -0,0 +1,222 @@
+/// @file TickScheduler.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+class JobSystem;
+class SceneActor;
+class TransformHierarchy;
+
+// Default value
+const UINT MAX_TICK_INTERVAL                    = 16;
+const UINT DEFAULT_TICK_PARALLEL_MIN_COUNT      = 64;
+const UINT DEFAULT_TICK_CLAIM_BATCH_SIZE        = 64;
+const UINT INVALID_TICK_TASK                    = ~0u;
+
+
+/// @~english
+/// @brief Group an actor is ticked in, the groups run in this order
+/// @~japanese
+/// @brief アクタを更新するグループ、グループはこの順に実行する
+/// @~
+/// @enum TickGroup
+enum class TickGroup : UINT {
+    PreUpdate   = 0,    ///< @~english Before the regular update, e.g. input and AI decisions @~japanese 通常の更新の前、入力やAIの判断など
+    Update      = 1,    ///< @~english Regular update @~japanese 通常の更新
+    PostUpdate  = 2,    ///< @~english After the regular update, e.g. cameras following other actors @~japanese 通常の更新の後、他のアクタを追うカメラなど
+    PreCommit   = 3,    ///< @~english Last changes before the proxies are committed @~japanese Proxyを伝達する前の最後の変更
+    Count,
+};
+
+const UINT TICK_GROUP_COUNT = static_cast<UINT>(TickGroup::Count);
+
+
+/// @~english
+/// @brief Statistics of a tick group
+/// @~japanese
+/// @brief 更新グループの統計情報
+/// @~
+/// @struct TickGroupStats
+struct TickGroupStats {
+    UINT    tickedCount;
+    UINT    throttledCount;     ///< @~english Waiting for their tick interval @~japanese 更新間隔の経過待ち
+    UINT    sleepingCount;
+    UINT    dependencyCount;    ///< @~english Prerequisites between actors ticked in the same group @~japanese 同じグループで更新したアクタ間の前提条件
+    float   timeInMs;           ///< @~english Wall clock time of the group @~japanese グループの経過時間
+    float   cpuTimeInMs;        ///< @~english Sum of the tick times on all threads @~japanese 全スレッドの更新時間の合計
+
+    /// @brief コンストラクタ
+    TickGroupStats()
+    : tickedCount(0)
+    , throttledCount(0)
+    , sleepingCount(0)
+    , dependencyCount(0)
+    , timeInMs(0.0f)
+    , cpuTimeInMs(0.0f)
+    {
+        ;
+    }
+};
+
+
+/// @class TickScheduler
+/// @~english
+/// @brief Ticks the scene actors group by group as a dependency graph on the job system workers
+/// @details An actor ticks once its tick interval has passed, the interval grows with the distance to the
+///          view when the actor sets a distance step, and the delta of the skipped frames is accumulated
+///          and passed to the next tick. Sleeping actors are skipped without accumulating time.
+///          Inside a group an actor only ticks after its prerequisites ticked in the same group have
+///          finished. Prerequisites in earlier groups are always finished. Actors without pending
+///          prerequisites are published to a ready list which the workers drain in batches of up to
+///          DEFAULT_TICK_CLAIM_BATCH_SIZE published slots, so independent actors tick in parallel. SceneActor::Update may therefore run on a worker thread and must only touch
+///          the actor itself and what its prerequisites have finished writing.
+/// @~japanese
+/// @brief シーンのアクタをグループ毎にJobSystemのワーカー上で依存グラフとして更新
+/// @details アクタは更新間隔が経過すると更新され、距離のステップが設定されている場合は間隔がビューとの
+///          距離に応じて伸びる。スキップしたフレームの経過時間は蓄積し、次の更新で渡す。スリープ中の
+///          アクタは時間を蓄積せずにスキップする。グループ内では同じグループで更新する前提条件のアクタが
+///          完了した後にのみ更新する。前のグループの前提条件は常に完了している。待ちの無いアクタは
+///          準備完了リストへ公開しワーカーが公開済みのスロットを最大DEFAULT_TICK_CLAIM_BATCH_SIZE個ずつ取り出すため、
+///          独立したアクタは並列に更新される。
+///          そのためSceneActor::Updateはワーカースレッドで実行される可能性があり、アクタ自身と
+///          前提条件が書き込みを終えたものにのみ触れる必要がある
+class TickScheduler {
+public:
+    /// @~english
+    /// @brief Add an actor to the schedule
+    /// @~japanese
+    /// @brief アクタをスケジュールへ追加
+    void Register(SceneActor *actor);
+
+    /// @~english
+    /// @brief Reserve the schedule for a number of actors
+    /// @~japanese
+    /// @brief アクタ数分のスケジュールを予約
+    void Reserve(size_t capacity) {
+        actors.reserve(capacity);
+    }
+
+    /// @~english
+    /// @brief Append empty slots to the schedule, filled by RegisterAt
+    /// @return First slot
+    /// @~japanese
+    /// @brief スケジュールへ空のスロットを追加、RegisterAtで埋める
+    /// @return 最初のスロット
+    UINT AddSlots(UINT count) {
+        const UINT firstSlot = static_cast<UINT>(actors.size());
+        actors.resize(actors.size() + count, nullptr);
+        return firstSlot;
+    }
+
+    /// @~english
+    /// @brief Add an actor to the schedule in a slot made by AddSlots, distinct slots may be filled in parallel
+    /// @~japanese
+    /// @brief AddSlotsで作ったスロットへアクタをスケジュールに追加、異なるスロットは並列に埋めてよい
+    void RegisterAt(UINT slot, SceneActor *actor);
+
+    /// @~english
+    /// @brief Make an actor tick after a prerequisite within the same frame
+    /// @param[in] actor Dependent actor
+    /// @param[in] prerequisite Actor to tick first
+    /// @return False if the prerequisite is in a later group or the dependency makes a cycle, true otherwise
+    /// @~japanese
+    /// @brief 同じフレーム内でアクタを前提条件の後に更新させる
+    /// @param[in] actor 依存するアクタ
+    /// @param[in] prerequisite 先に更新するアクタ
+    /// @return 前提条件が後のグループにあるか依存が循環する場合はFalse、そうでないならTrueを返す
+    bool AddPrerequisite(SceneActor *actor, SceneActor *prerequisite);
+
+    /// @~english
+    /// @brief Tick the actors due this frame, group by group
+    /// @param[in] delta Time taken since the last frame (seconds
+    /// @param[in] viewPosition Position the tick distances are measured from
+    /// @param[in] hierarchy Transform hierarchy giving the positions of the actors (last frame
+    /// @param[in] jobSystem Job system to distribute the actors to (nullptr to run on the calling thread
+    /// @~japanese
+    /// @brief 今フレーム更新するアクタをグループ毎に更新
+    /// @param[in] delta 前フレームからの経過時間（秒
+    /// @param[in] viewPosition 更新距離を測る位置
+    /// @param[in] hierarchy アクタの位置を与えるトランスフォーム階層（前フレーム
+    /// @param[in] jobSystem アクタを分散するJobSystem（nullptrの場合は呼び出し元スレッドで実行
+    void Tick(float delta, DirectX::FXMVECTOR viewPosition, const TransformHierarchy &hierarchy, JobSystem *jobSystem);
+
+    /// @~english
+    /// @brief Get the statistics of a group for the last frame
+    /// @~japanese
+    /// @brief 前フレームのグループの統計情報を取得
+    const TickGroupStats& GetStats(TickGroup group) const {
+        return stats[static_cast<UINT>(group)];
+    }
+
+    /// @~english
+    /// @brief Get the number of frames ticked so far
+    /// @~japanese
+    /// @brief これまでに更新したフレーム数を取得
+    UINT64 GetFrameIndex() const {
+        return frameIndex;
+    }
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    TickScheduler();
+
+private:
+    /// @~english
+    /// @brief Tick the actors of a group in dependency order
+    /// @~japanese
+    /// @brief グループのアクタを依存順に更新
+    void RunGroup(UINT group, JobSystem *jobSystem);
+
+    /// @~english
+    /// @brief Tick the ready actors until every actor of the group has been taken
+    /// @details Claims the published slots in batches, each batch is timed once.
+    /// @~japanese
+    /// @brief グループの全アクタが取得されるまで準備完了のアクタを更新
+    /// @details 公開済みのスロットをバッチ単位で取得し、各バッチは1回だけ計測する
+    void DrainReadyTasks();
+
+    /// @~english
+    /// @brief Append a task whose prerequisites have finished to the ready list
+    /// @~japanese
+    /// @brief 前提条件が完了したタスクを準備完了リストへ追加
+    void PublishTask(UINT task) {
+        const UINT slot = readyWriteIndex.fetch_add(1, std::memory_order_relaxed);
+        readySlots[slot].store(task + 1, std::memory_order_release);
+    }
+
+    /// @~english
+    /// @brief Test if an actor is reachable through the prerequisites of another
+    /// @details Visits each actor at most once, so shared prerequisites are not searched again.
+    /// @~japanese
+    /// @brief 別のアクタの前提条件を辿ってアクタに到達できるか調べる
+    /// @details 各アクタは最大1回だけ訪問する為、共有する前提条件を再度探索しない
+    bool IsPrerequisiteOf(const SceneActor *actor, SceneActor *dependent);
+
+private:
+    std::vector<SceneActor *>   actors;
+    std::vector<SceneActor *>   groupTasks[TICK_GROUP_COUNT];
+    UINT64                      frameIndex;
+
+    // Prerequisite search, an actor was visited by the current search if its stamp equals searchStamp
+    // 前提条件の探索、スタンプがsearchStampと等しいアクタは現在の探索で訪問済み
+    std::vector<SceneActor *>   searchStack;
+    UINT64                      searchStamp;
+
+    // Dependency graph of the running group, the dependents of task i are dependents[dependentOffsets[i], dependentOffsets[i + 1])
+    // 実行中のグループの依存グラフ、タスクiの依存先はdependents[dependentOffsets[i], dependentOffsets[i + 1])
+    const std::vector<SceneActor *>    *runningTasks;
+    std::vector<UINT>                   dependentOffsets;
+    std::vector<UINT>                   dependents;
+    std::vector<std::atomic<UINT>>      pendingCounts;
+
+    // Ready list, slots are claimed in order and hold task + 1 once published
+    // 準備完了リスト、スロットは順に取得され、公開されるとタスク + 1を保持する
+    std::vector<std::atomic<UINT>>      readySlots;
+    std::atomic<UINT>                   readyWriteIndex;
+    std::atomic<UINT>                   readyReadIndex;
+    std::atomic<UINT64>                 tickTimeInNs;
+
+    TickGroupStats              stats[TICK_GROUP_COUNT];
+};
@@ -0,0 +1,461 @@
+/// @file TransformHierarchy.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "TransformHierarchy.h"
+#include "JobSystem.h"
+
+using namespace DirectX;
+
+namespace {
+// Rotate the elements of [first, last) so that middle becomes the first
+// middleが先頭となるよう[first, last)の要素を回転
+template<typename T>
+void RotateRange(std::vector<T> &array, UINT first, UINT middle, UINT last) {
+    std::rotate(array.begin() + first, array.begin() + middle, array.begin() + last);
+}
+} // namespace ""
+
+//----------------------------------------------------------------------------------------------------
+// TransformHierarchy
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+TransformHierarchy::TransformHierarchy()
+: tasksDirty(true)
+{
+    Reserve(DEFAULT_TRANSFORM_NODE_CAPACITY);
+}
+
+// Destructor
+// デストラクタ
+TransformHierarchy::~TransformHierarchy() {
+    ;
+}
+
+// Reserve capacity
+// 容量を予約
+void TransformHierarchy::Reserve(UINT capacity) {
+    parentIndices.reserve(capacity);
+    subtreeSizes.reserve(capacity);
+    localTranslations.reserve(capacity);
+    localRotations.reserve(capacity);
+    localScales.reserve(capacity);
+    worldMatrices.reserve(capacity);
+    indexToHandle.reserve(capacity);
+    handleToIndex.reserve(capacity);
+}
+
+// Create a node
+// ノードを生成
+UINT TransformHierarchy::CreateNode(UINT parent) {
+    UINT handle = 0;
+    if (freeHandles.empty()) {
+        handle = static_cast<UINT>(handleToIndex.size());
+        handleToIndex.push_back(INVALID_TRANSFORM_NODE);
+    } else {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    }
+
+    // Append as a root, then move under the parent
+    // ルートとして末尾に追加してから親の下へ移動
+    handleToIndex[handle] = static_cast<UINT>(parentIndices.size());
+    indexToHandle.push_back(handle);
+    parentIndices.push_back(INVALID_TRANSFORM_NODE);
+    subtreeSizes.push_back(1);
+    localTranslations.push_back(XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f));
+    localRotations.push_back(XMQuaternionIdentity());
+    localScales.push_back(XMVectorSet(1.0f, 1.0f, 1.0f, 0.0f));
+    worldMatrices.push_back(XMMatrixIdentity());
+
+    tasksDirty = true;
+
+    if (parent != INVALID_TRANSFORM_NODE) {
+        SetParent(handle, parent);
+    }
+
+    return handle;
+}
+
+// Create root nodes at once
+// ルートノードを一括で生成
+void TransformHierarchy::CreateRootNodes(UINT count, UINT *dstHandles) {
+    AppendNodes(count, dstHandles);
+}
+
+// Create trees of nodes at once from arrays in parent-before-child order
+// 親が子より前に並ぶ配列からノードのツリーを一括で生成
+bool TransformHierarchy::CreateNodes(UINT count, const UINT *srcParents, const UINT *srcSubtreeSizes, UINT *dstHandles) {
+    // Each subtree lies in its parent's, its first child follows it and the next node after it is its next sibling
+    // when the parent's subtree goes on, a root otherwise. Checked node by node, the arrays form a pre-order forest.
+    // 各サブツリーは親のサブツリー内にあり、最初の子は直後に続き、直後のノードは親のサブツリーが続く場合は次の兄弟、
+    // そうでない場合はルート。ノード毎に確認すると、配列は前順の森となる
+    for (UINT i = 0; i < count; ++i) {
+        const UINT size   = srcSubtreeSizes[i];
+        const UINT parent = srcParents[i];
+        if (size == 0 || count - i < size) {
+            return false;
+        }
+        if (parent != INVALID_TRANSFORM_NODE && (i <= parent || parent + srcSubtreeSizes[parent] < i + size)) {
+            return false;
+        }
+        if (1 < size && srcParents[i + 1] != i) {
+            return false;
+        }
+
+        const UINT next = i + size;
+        if (next < count) {
+            if (parent == INVALID_TRANSFORM_NODE && srcParents[next] != INVALID_TRANSFORM_NODE) {
+                return false;
+            }
+            if (parent != INVALID_TRANSFORM_NODE && next < parent + srcSubtreeSizes[parent] && srcParents[next] != parent) {
+                return false;
+            }
+        }
+    }
+
+    // Append as roots, then link them as the arrays are, already in order
+    // ルートとして追加してから、既に順序通りの配列のまま繋ぐ
+    const UINT firstIndex = GetNodeCount();
+    AppendNodes(count, dstHandles);
+    for (UINT i = 0; i < count; ++i) {
+        parentIndices[firstIndex + i] = (srcParents[i] != INVALID_TRANSFORM_NODE) ? firstIndex + srcParents[i] : INVALID_TRANSFORM_NODE;
+        subtreeSizes[firstIndex + i]  = srcSubtreeSizes[i];
+    }
+    return true;
+}
+
+// Append root nodes with the identity transform
+// 単位変換のルートノードを末尾に追加
+void TransformHierarchy::AppendNodes(UINT count, UINT *dstHandles) {
+    const size_t firstIndex = parentIndices.size();
+    const size_t lastIndex  = firstIndex + count;
+
+    // Resize every array once instead of growing them node by node
+    // ノード毎に伸ばさずに全配列を1回でリサイズ
+    parentIndices.resize(lastIndex, INVALID_TRANSFORM_NODE);
+    subtreeSizes.resize(lastIndex, 1);
+    localTranslations.resize(lastIndex, XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f));
+    localRotations.resize(lastIndex, XMQuaternionIdentity());
+    localScales.resize(lastIndex, XMVectorSet(1.0f, 1.0f, 1.0f, 0.0f));
+    worldMatrices.resize(lastIndex, XMMatrixIdentity());
+    indexToHandle.resize(lastIndex);
+
+    // Handles are reused first, the rest are appended at once
+    // ハンドルは先に再利用し、残りは一括で追加する
+    const size_t firstNewHandle = handleToIndex.size();
+    handleToIndex.resize(firstNewHandle + (count - std::min<size_t>(count, freeHandles.size())), INVALID_TRANSFORM_NODE);
+
+    UINT nextNewHandle = static_cast<UINT>(firstNewHandle);
+    for (size_t index = firstIndex; index < lastIndex; ++index) {
+        UINT handle = 0;
+        if (freeHandles.empty()) {
+            handle = nextNewHandle++;
+        } else {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+        }
+
+        handleToIndex[handle] = static_cast<UINT>(index);
+        indexToHandle[index]  = handle;
+        dstHandles[index - firstIndex] = handle;
+    }
+
+    tasksDirty = true;
+}
+
+// Destroy a node, its children are attached to its parent
+// ノードを破棄、子ノードは親ノードへ付け替えられる
+void TransformHierarchy::DestroyNode(UINT node) {
+    if (handleToIndex.size() <= node || handleToIndex[node] == INVALID_TRANSFORM_NODE) {
+        return;
+    }
+
+    const UINT parent = GetParent(node);
+
+    // The first child always follows the node (pre-order)
+    // 最初の子ノードは常に直後に位置する（前順
+    while (1 < subtreeSizes[handleToIndex[node]]) {
+        SetParent(indexToHandle[handleToIndex[node] + 1], parent);
+    }
+
+    // Move the leaf to the end and remove it
+    // 葉ノードを末尾に移動して削除
+    SetParent(node, INVALID_TRANSFORM_NODE);
+    MoveRange(handleToIndex[node], handleToIndex[node] + 1, GetNodeCount() - 1);
+
+    parentIndices.pop_back();
+    subtreeSizes.pop_back();
+    localTranslations.pop_back();
+    localRotations.pop_back();
+    localScales.pop_back();
+    worldMatrices.pop_back();
+    indexToHandle.pop_back();
+
+    handleToIndex[node] = INVALID_TRANSFORM_NODE;
+    freeHandles.push_back(node);
+
+    tasksDirty = true;
+}
+
+// Change the parent of a node by moving its subtree
+// サブツリーを移動してノードの親を変更
+bool TransformHierarchy::SetParent(UINT node, UINT parent) {
+    const UINT index = handleToIndex[node];
+    const UINT size  = subtreeSizes[index];
+
+    UINT parentIndex = INVALID_TRANSFORM_NODE;
+    if (parent != INVALID_TRANSFORM_NODE) {
+        parentIndex = handleToIndex[parent];
+
+        // The new parent must not be in the subtree
+        // 新しい親はサブツリー内であってはならない
+        if (parentIndex == INVALID_TRANSFORM_NODE || (index <= parentIndex && parentIndex < index + size)) {
+            return false;
+        }
+    }
+
+    if (parentIndices[index] == parentIndex) {
+        return true;
+    }
+
+    // Detach from the old ancestors
+    // 元の祖先から切り離す
+    if (parentIndices[index] != INVALID_TRANSFORM_NODE) {
+        AddSubtreeSize(parentIndices[index], -static_cast<int>(size));
+    }
+
+    // Destination in the array without the subtree: end of the new parent's subtree, or the end of the array for a root
+    // サブツリーを除いた配列での移動先: 新しい親のサブツリー末尾、ルートの場合は配列末尾
+    UINT dst = GetNodeCount() - size;
+    if (parentIndex != INVALID_TRANSFORM_NODE) {
+        const UINT compactParentIndex = (parentIndex < index) ? parentIndex : parentIndex - size;
+        dst = compactParentIndex + subtreeSizes[parentIndex];
+    }
+
+    MoveRange(index, index + size, dst);
+
+    // Attach to the new ancestors
+    // 新しい祖先へ接続
+    if (parent != INVALID_TRANSFORM_NODE) {
+        parentIndex = handleToIndex[parent];
+        parentIndices[handleToIndex[node]] = parentIndex;
+        AddSubtreeSize(parentIndex, static_cast<int>(size));
+    } else {
+        parentIndices[handleToIndex[node]] = INVALID_TRANSFORM_NODE;
+    }
+
+    tasksDirty = true;
+    return true;
+}
+
+// Get the parent of a node
+// ノードの親を取得
+UINT TransformHierarchy::GetParent(UINT node) const {
+    const UINT parentIndex = parentIndices[handleToIndex[node]];
+    return (parentIndex != INVALID_TRANSFORM_NODE) ? indexToHandle[parentIndex] : INVALID_TRANSFORM_NODE;
+}
+
+// Set the local transform of a node
+// ノードのローカルトランスフォームをセット
+void TransformHierarchy::SetLocalTransform(UINT node, FXMVECTOR translation, FXMVECTOR rotation, FXMVECTOR scale) {
+    const UINT index = handleToIndex[node];
+    const float d2r = XM_PI / 180.0f; // Degree to Radian
+    const XMVECTOR d2rVec = XMVectorSet(d2r, d2r, d2r, 0.0f);
+
+    localTranslations[index] = translation;
+    localRotations[index]    = XMQuaternionRotationRollPitchYawFromVector(XMVectorMultiply(rotation, d2rVec));
+    localScales[index]       = scale;
+}
+
+// Compute a checksum of the world matrices
+// World変換行列のチェックサムを算出
+UINT64 TransformHierarchy::ComputeChecksum() const {
+    // FNV-1a over 64-bit words
+    // 64-bitワード単位のFNV-1a
+    const UINT64 *words = reinterpret_cast<const UINT64 *>(worldMatrices.data());
+    const size_t wordCount = worldMatrices.size() * sizeof(XMMATRIX) / sizeof(UINT64);
+    UINT64 checksum = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < wordCount; ++i) {
+        checksum = (checksum ^ words[i]) * 0x100000001b3ull;
+    }
+    return checksum;
+}
+
+// Move the range [first, last) to dst and fix up the indices
+// 範囲[first, last)をdstへ移動しインデックスを修正
+void TransformHierarchy::MoveRange(UINT first, UINT last, UINT dst) {
+    if (dst == first) {
+        return;
+    }
+
+    const UINT size = last - first;
+
+    // Rotated range and the mapping of old indices inside it
+    // 回転する範囲と範囲内の旧インデックスの対応
+    UINT lo, mid, hi;
+    if (dst < first) {
+        lo  = dst;
+        mid = first;
+        hi  = last;
+    } else {
+        lo  = first;
+        mid = last;
+        hi  = dst + size;
+    }
+
+    auto remap = [=](UINT oldIndex) -> UINT {
+        if (oldIndex == INVALID_TRANSFORM_NODE || oldIndex < lo || hi <= oldIndex) {
+            return oldIndex;
+        }
+        if (first <= oldIndex && oldIndex < last) {
+            return dst + (oldIndex - first);
+        }
+        return (dst < first) ? oldIndex + size : oldIndex - size;
+    };
+
+    RotateRange(parentIndices, lo, mid, hi);
+    RotateRange(subtreeSizes, lo, mid, hi);
+    RotateRange(localTranslations, lo, mid, hi);
+    RotateRange(localRotations, lo, mid, hi);
+    RotateRange(localScales, lo, mid, hi);
+    RotateRange(worldMatrices, lo, mid, hi);
+    RotateRange(indexToHandle, lo, mid, hi);
+
+    // Nodes before lo only refer to parents before themselves
+    // loより前のノードは自身より前の親しか参照しない
+    for (UINT i = lo; i < GetNodeCount(); ++i) {
+        parentIndices[i] = remap(parentIndices[i]);
+    }
+    for (UINT i = lo; i < hi; ++i) {
+        handleToIndex[indexToHandle[i]] = i;
+    }
+}
+
+// Add delta to the subtree size of index and its ancestors
+// indexとその祖先のサブツリーサイズにdeltaを加算
+void TransformHierarchy::AddSubtreeSize(UINT index, int delta) {
+    while (index != INVALID_TRANSFORM_NODE) {
+        subtreeSizes[index] = static_cast<UINT>(static_cast<int>(subtreeSizes[index]) + delta);
+        index = parentIndices[index];
+    }
+}
+
+// Split the hierarchy into serial nodes and parallel tasks
+// 階層を逐次処理ノードと並列タスクへ分割
+void TransformHierarchy::BuildTasks() {
+    serialNodes.clear();
+    taskRanges.clear();
+
+    // Pre-order walk: small subtrees are merged into tasks, a large subtree is one task unless it has a split point,
+    // then only the spine down to the split point is updated serially
+    // 前順に走査: 小さなサブツリーはタスクにまとめ、大きなサブツリーは分割点を持たない限り1つのタスクとし、
+    // 持つ場合は分割点までの背骨のみを逐次更新
+    UINT splitNode = INVALID_TRANSFORM_NODE;
+    UINT i = 0;
+    while (i < GetNodeCount()) {
+        const UINT size = subtreeSizes[i];
+        if (DEFAULT_TRANSFORM_TASK_GRAIN < size) {
+            // Large nodes before the split point are all on its spine, the light subtrees beside it are small
+            // 分割点より前の大きなノードは全てその背骨上にあり、その脇の軽いサブツリーは小さい
+            if (splitNode == INVALID_TRANSFORM_NODE || splitNode < i) {
+                splitNode = FindSplitNode(i);
+            }
+            if (splitNode != INVALID_TRANSFORM_NODE && splitNode < i + size) {
+                serialNodes.push_back(i);
+                i += 1;
+            } else {
+                taskRanges.push_back(i);
+                taskRanges.push_back(i + size);
+                i += size;
+            }
+            continue;
+        }
+
+        // Merge adjacent small subtrees into one task
+        // 隣接する小さなサブツリーを1つのタスクにまとめる
+        const size_t rangeCount = taskRanges.size() / 2;
+        if (0 < rangeCount && taskRanges[rangeCount * 2 - 1] == i && (i + size - taskRanges[rangeCount * 2 - 2]) <= DEFAULT_TRANSFORM_TASK_GRAIN) {
+            taskRanges[rangeCount * 2 - 1] = i + size;
+        } else {
+            taskRanges.push_back(i);
+            taskRanges.push_back(i + size);
+        }
+        i += size;
+    }
+
+    tasksDirty = false;
+}
+
+// Find the first node down the heavy path of a large subtree whose other children hold a task worth of nodes
+// 大きなサブツリーの重い経路を下り、他の子がタスク1つ分のノードを持つ最初のノードを検索
+UINT TransformHierarchy::FindSplitNode(UINT index) const {
+    while (DEFAULT_TRANSFORM_TASK_GRAIN < subtreeSizes[index]) {
+        const UINT last = index + subtreeSizes[index];
+        UINT heavyChild = index + 1;
+        for (UINT child = index + 1; child < last; child += subtreeSizes[child]) {
+            if (subtreeSizes[heavyChild] < subtreeSizes[child]) {
+                heavyChild = child;
+            }
+        }
+
+        if (DEFAULT_TRANSFORM_TASK_GRAIN <= subtreeSizes[index] - 1 - subtreeSizes[heavyChild]) {
+            return index;
+        }
+        index = heavyChild;
+    }
+    return INVALID_TRANSFORM_NODE;
+}
+
+// Compute world matrices of [first, last)
+// [first, last)のWorld変換行列を算出
+void TransformHierarchy::ComputeRange(UINT first, UINT last) {
+    for (UINT i = first; i < last; ++i) {
+        XMMATRIX scaleMtx = XMMatrixScalingFromVector(localScales[i]);
+        XMMATRIX rotMtx   = XMMatrixRotationQuaternion(localRotations[i]);
+        XMMATRIX transMtx = XMMatrixTranslationFromVector(localTranslations[i]);
+        XMMATRIX localMtx = XMMatrixMultiply(XMMatrixMultiply(scaleMtx, rotMtx), transMtx);
+
+        const UINT parentIndex = parentIndices[i];
+        worldMatrices[i] = (parentIndex == INVALID_TRANSFORM_NODE) ? localMtx : XMMatrixMultiply(localMtx, worldMatrices[parentIndex]);
+    }
+}
+
+// Compute the world matrices of all nodes
+// 全ノードのWorld変換行列を算出
+void TransformHierarchy::UpdateWorldMatrices(JobSystem *jobSystem) {
+    auto beginTime = std::chrono::high_resolution_clock::now();
+
+    if (tasksDirty) {
+        BuildTasks();
+    }
+
+    // Ancestors of large subtrees first
+    // 大きなサブツリーの祖先を先に処理
+    for (auto index : serialNodes) {
+        ComputeRange(index, index + 1);
+    }
+
+    // Independent subtrees in parallel
+    // 独立したサブツリーを並列に処理
+    const UINT taskCount = static_cast<UINT>(taskRanges.size() / 2);
+    auto computeTasks = [this](UINT begin, UINT end) {
+        for (UINT t = begin; t < end; ++t) {
+            ComputeRange(taskRanges[t * 2], taskRanges[t * 2 + 1]);
+        }
+    };
+
+    if (jobSystem != nullptr) {
+        jobSystem->ParallelFor(taskCount, 1, computeTasks);
+    } else {
+        computeTasks(0, taskCount);
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    stats.nodeCount       = GetNodeCount();
+    stats.serialNodeCount = static_cast<UINT>(serialNodes.size());
+    stats.taskCount       = taskCount;
+    stats.timeInMs        = std::chrono::duration<float, std::milli>(endTime - beginTime).count();
+}
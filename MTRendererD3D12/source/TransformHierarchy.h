@@ -0,0 +1,289 @@
+/// @file TransformHierarchy.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+class JobSystem;
+
+// Default value
+const UINT INVALID_TRANSFORM_NODE           = ~0u;
+const UINT DEFAULT_TRANSFORM_NODE_CAPACITY  = 32;
+const UINT DEFAULT_TRANSFORM_TASK_GRAIN     = 1024;
+
+
+/// @~english
+/// @brief Statistics of the world matrix update
+/// @~japanese
+/// @brief World変換行列更新処理の統計情報
+/// @~
+/// @struct TransformHierarchyStats
+struct TransformHierarchyStats {
+    UINT    nodeCount;
+    UINT    serialNodeCount;    ///< @~english Spines down to the split points updated before the parallel pass @~japanese 並列処理の前に更新する分割点までの背骨
+    UINT    taskCount;
+    float   timeInMs;
+
+    /// @brief コンストラクタ
+    TransformHierarchyStats()
+    : nodeCount(0)
+    , serialNodeCount(0)
+    , taskCount(0)
+    , timeInMs(0.0f)
+    {
+        ;
+    }
+};
+
+
+/// @class TransformHierarchy
+/// @~english
+/// @brief Transform hierarchy stored in flat arrays in parent-before-child order
+/// @details Every subtree occupies a contiguous range (pre-order), so the world matrices are
+///          computed by one linear pass and independent subtrees can be processed in parallel.
+/// @~japanese
+/// @brief 親が子より前に並ぶフラットな配列に格納したトランスフォーム階層
+/// @details 各サブツリーは連続した範囲を占める（前順）ため、World変換行列は1回の線形走査で
+///          算出でき、独立したサブツリーは並列に処理できる
+class TransformHierarchy {
+public:
+    /// @~english
+    /// @brief Create a node
+    /// @param[in] parent Handle of the parent node (INVALID_TRANSFORM_NODE for a root
+    /// @return Handle of the node
+    /// @~japanese
+    /// @brief ノードを生成
+    /// @param[in] parent 親ノードのハンドル（ルートの場合はINVALID_TRANSFORM_NODE
+    /// @return ノードのハンドル
+    UINT CreateNode(UINT parent);
+
+    /// @~english
+    /// @brief Create root nodes at once, with the identity transform
+    /// @param[in] count Number of nodes
+    /// @param[out] dstHandles Handles of the nodes, count elements
+    /// @~japanese
+    /// @brief ルートノードを一括で生成、トランスフォームは単位変換
+    /// @param[in] count ノード数
+    /// @param[out] dstHandles ノードのハンドル、count個の要素
+    void CreateRootNodes(UINT count, UINT *dstHandles);
+
+    /// @~english
+    /// @brief Create trees of nodes at once from arrays in parent-before-child order, with the identity transform
+    /// @details The arrays are appended as they are, no subtree is moved. They are validated first and nothing is
+    ///          created if a parent is not before its child or a subtree size does not match the parents.
+    /// @param[in] count Number of nodes
+    /// @param[in] srcParents Position of the parent of each node in the arrays, INVALID_TRANSFORM_NODE for a root
+    /// @param[in] srcSubtreeSizes Number of nodes of the subtree of each node, including the node
+    /// @param[out] dstHandles Handles of the nodes, count elements
+    /// @return True if succeeded, false if the arrays are not in parent-before-child order
+    /// @~japanese
+    /// @brief 親が子より前に並ぶ配列からノードのツリーを一括で生成、トランスフォームは単位変換
+    /// @details 配列はそのまま追加され、サブツリーは移動しない。先に検証し、親が子より前にないかサブツリーの
+    ///          サイズが親と一致しない場合は何も生成しない
+    /// @param[in] count ノード数
+    /// @param[in] srcParents 各ノードの親の配列内の位置、ルートの場合はINVALID_TRANSFORM_NODE
+    /// @param[in] srcSubtreeSizes 各ノードのノード自身を含むサブツリーのノード数
+    /// @param[out] dstHandles ノードのハンドル、count個の要素
+    /// @return 成功した場合にはTrue、配列が親が子より前に並ぶ順でない場合はFalseを返す
+    bool CreateNodes(UINT count, const UINT *srcParents, const UINT *srcSubtreeSizes, UINT *dstHandles);
+
+    /// @~english
+    /// @brief Destroy a node, its children are attached to its parent
+    /// @param[in] node Handle of the node
+    /// @~japanese
+    /// @brief ノードを破棄、子ノードは親ノードへ付け替えられる
+    /// @param[in] node ノードのハンドル
+    void DestroyNode(UINT node);
+
+    /// @~english
+    /// @brief Change the parent of a node by moving its subtree
+    /// @param[in] node Handle of the node
+    /// @param[in] parent Handle of the new parent (INVALID_TRANSFORM_NODE to make it a root
+    /// @return True if succeeded, false if the parent is invalid or a descendant
+    /// @~japanese
+    /// @brief サブツリーを移動してノードの親を変更
+    /// @param[in] node ノードのハンドル
+    /// @param[in] parent 新しい親のハンドル（ルートにする場合はINVALID_TRANSFORM_NODE
+    /// @return 成功した場合にはTrue、親が無効もしくは子孫の場合はFalseを返す
+    bool SetParent(UINT node, UINT parent);
+
+    /// @~english
+    /// @brief Get the parent of a node
+    /// @~japanese
+    /// @brief ノードの親を取得
+    UINT GetParent(UINT node) const;
+
+    /// @~english
+    /// @brief Set the local transform of a node
+    /// @param[in] node Handle of the node
+    /// @param[in] translation Translation component
+    /// @param[in] rotation Rotation component (Degree
+    /// @param[in] scale Scale component
+    /// @~japanese
+    /// @brief ノードのローカルトランスフォームをセット
+    /// @param[in] node ノードのハンドル
+    /// @param[in] translation 平行移動成分
+    /// @param[in] rotation 回転成分（角度
+    /// @param[in] scale スケール成分
+    void SetLocalTransform(UINT node, DirectX::FXMVECTOR translation, DirectX::FXMVECTOR rotation, DirectX::FXMVECTOR scale);
+
+    /// @~english
+    /// @brief Get the index of a node in the local transform arrays, valid until the structure changes
+    /// @~japanese
+    /// @brief ローカルトランスフォーム配列内のノードの番号を取得、構造が変わるまで有効
+    UINT GetNodeIndex(UINT node) const {
+        return handleToIndex[node];
+    }
+
+    /// @~english
+    /// @brief Get the handle of the node at an index
+    /// @~japanese
+    /// @brief 番号のノードのハンドルを取得
+    UINT GetNodeHandle(UINT index) const {
+        return indexToHandle[index];
+    }
+
+    /// @~english
+    /// @brief Get the index of the parent of each node, GetNodeCount() elements in parent-before-child order
+    /// @~japanese
+    /// @brief 各ノードの親の番号を取得、親が子より前に並ぶ順のGetNodeCount()個の要素
+    const UINT* GetParentIndices() const {
+        return parentIndices.data();
+    }
+
+    /// @~english
+    /// @name Local transform arrays indexed by GetNodeIndex() for batch writers, the rotation is a quaternion
+    /// @~japanese
+    /// @name 一括で書き込む為のGetNodeIndex()で参照するローカルトランスフォーム配列、回転はクォータニオン
+    /// @{
+    DirectX::XMVECTOR* GetLocalTranslations() {
+        return localTranslations.data();
+    }
+    DirectX::XMVECTOR* GetLocalRotations() {
+        return localRotations.data();
+    }
+    DirectX::XMVECTOR* GetLocalScales() {
+        return localScales.data();
+    }
+    /// @}
+
+    /// @~english
+    /// @brief Compute the world matrices of all nodes
+    /// @param[in] jobSystem JobSystem used to process independent subtrees (nullptr to run serially
+    /// @~japanese
+    /// @brief 全ノードのWorld変換行列を算出
+    /// @param[in] jobSystem 独立したサブツリーの処理に使用するJobSystem（nullptrの場合は逐次実行
+    void UpdateWorldMatrices(JobSystem *jobSystem);
+
+    /// @~english
+    /// @brief Get the world matrix of a node
+    /// @~japanese
+    /// @brief ノードのWorld変換行列を取得
+    const DirectX::XMMATRIX& GetWorldMatrix(UINT node) const {
+        return worldMatrices[handleToIndex[node]];
+    }
+
+    /// @~english
+    /// @brief Compute a checksum of the world matrices, equal only if every bit of them is
+    /// @~japanese
+    /// @brief World変換行列のチェックサムを算出、全ビットが等しい場合のみ等しい
+    UINT64 ComputeChecksum() const;
+
+    /// @~english
+    /// @brief Get the number of nodes
+    /// @~japanese
+    /// @brief ノード数を取得
+    UINT GetNodeCount() const {
+        return static_cast<UINT>(parentIndices.size());
+    }
+
+    /// @~english
+    /// @brief Get the statistics of the last update
+    /// @~japanese
+    /// @brief 最後の更新処理の統計情報を取得
+    const TransformHierarchyStats& GetStats() const {
+        return stats;
+    }
+
+    /// @~english
+    /// @brief Reserve capacity
+    /// @~japanese
+    /// @brief 容量を予約
+    void Reserve(UINT capacity);
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    TransformHierarchy();
+
+    /// @~english
+    /// @brief Destructor
+    /// @~japanese
+    /// @brief デストラクタ
+    ~TransformHierarchy();
+
+private:
+    /// @~english
+    /// @brief Append root nodes with the identity transform
+    /// @~japanese
+    /// @brief 単位変換のルートノードを末尾に追加
+    void AppendNodes(UINT count, UINT *dstHandles);
+
+    /// @~english
+    /// @brief Move the range [first, last) to dst and fix up the indices
+    /// @~japanese
+    /// @brief 範囲[first, last)をdstへ移動しインデックスを修正
+    void MoveRange(UINT first, UINT last, UINT dst);
+
+    /// @~english
+    /// @brief Add delta to the subtree size of index and its ancestors
+    /// @~japanese
+    /// @brief indexとその祖先のサブツリーサイズにdeltaを加算
+    void AddSubtreeSize(UINT index, int delta);
+
+    /// @~english
+    /// @brief Split the hierarchy into serial nodes and parallel tasks
+    /// @~japanese
+    /// @brief 階層を逐次処理ノードと並列タスクへ分割
+    void BuildTasks();
+
+    /// @~english
+    /// @brief Find the first node down the heavy path of a large subtree whose other children hold
+    ///        DEFAULT_TRANSFORM_TASK_GRAIN nodes or more
+    /// @return Index of the node, INVALID_TRANSFORM_NODE if the subtree has none and is one task
+    /// @~japanese
+    /// @brief 大きなサブツリーの重い経路を下り、他の子がDEFAULT_TRANSFORM_TASK_GRAIN個以上のノードを持つ
+    ///        最初のノードを検索
+    /// @return ノードの番号、サブツリーが持たず1つのタスクとなる場合はINVALID_TRANSFORM_NODE
+    UINT FindSplitNode(UINT index) const;
+
+    /// @~english
+    /// @brief Compute world matrices of [first, last)
+    /// @~japanese
+    /// @brief [first, last)のWorld変換行列を算出
+    void ComputeRange(UINT first, UINT last);
+
+private:
+    // Dense arrays in parent-before-child order
+    // 親が子より前に並ぶ密な配列
+    std::vector<UINT>               parentIndices;
+    std::vector<UINT>               subtreeSizes;
+    std::vector<DirectX::XMVECTOR>  localTranslations;
+    std::vector<DirectX::XMVECTOR>  localRotations;
+    std::vector<DirectX::XMVECTOR>  localScales;
+    std::vector<DirectX::XMMATRIX>  worldMatrices;
+
+    // Stable handles
+    // 不変のハンドル
+    std::vector<UINT>   indexToHandle;
+    std::vector<UINT>   handleToIndex;
+    std::vector<UINT>   freeHandles;
+
+    // Work split, rebuilt when the structure changes
+    // 構造変更時に再構築する作業分割
+    std::vector<UINT>   serialNodes;
+    std::vector<UINT>   taskRanges;
+    bool                tasksDirty;
+
+    TransformHierarchyStats stats;
+};
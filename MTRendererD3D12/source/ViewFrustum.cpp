@@ -0,0 +1,67 @@
+/// @file ViewFrustum.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "ViewFrustum.h"
+
+using namespace DirectX;
+
+//----------------------------------------------------------------------------------------------------
+// ViewFrustum
+//----------------------------------------------------------------------------------------------------
+// Constructor
+// コンストラクタ
+ViewFrustum::ViewFrustum() {
+    for (auto &plane : planes) {
+        plane = XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+}
+
+// Extract the planes from a view-projection matrix
+// View-Projection行列から平面を抽出
+void ViewFrustum::SetFromMatrix(FXMMATRIX viewProjMtx) {
+    // Rows of the transposed matrix are the columns of the row-vector matrix
+    // 転置行列の各行が行ベクトル形式の行列の各列となる
+    XMMATRIX m = XMMatrixTranspose(viewProjMtx);
+
+    XMVECTOR extracted[static_cast<UINT>(FrustumPlane::Count)];
+    extracted[static_cast<UINT>(FrustumPlane::Left)]   = XMVectorAdd(m.r[3], m.r[0]);
+    extracted[static_cast<UINT>(FrustumPlane::Right)]  = XMVectorSubtract(m.r[3], m.r[0]);
+    extracted[static_cast<UINT>(FrustumPlane::Bottom)] = XMVectorAdd(m.r[3], m.r[1]);
+    extracted[static_cast<UINT>(FrustumPlane::Top)]    = XMVectorSubtract(m.r[3], m.r[1]);
+    extracted[static_cast<UINT>(FrustumPlane::Near)]   = m.r[2];   // D3D clip space z is [0, w]
+    extracted[static_cast<UINT>(FrustumPlane::Far)]    = XMVectorSubtract(m.r[3], m.r[2]);
+
+    for (UINT i = 0; i < static_cast<UINT>(FrustumPlane::Count); ++i) {
+        XMStoreFloat4(&planes[i], XMPlaneNormalize(extracted[i]));
+    }
+}
+
+// Test if a sphere is at least partially inside the frustum
+// 球が視錐台内に含まれるか調べる
+bool ViewFrustum::TestSphere(FXMVECTOR center, float radius) const {
+    for (const auto &plane : planes) {
+        const float dist = XMVectorGetX(XMPlaneDotCoord(XMLoadFloat4(&plane), center));
+        if (dist < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Test if an axis aligned box is at least partially inside the frustum
+// 軸平行境界ボックスが視錐台内に含まれるか調べる
+bool ViewFrustum::TestBox(FXMVECTOR boxMin, FXMVECTOR boxMax) const {
+    XMVECTOR center  = XMVectorScale(XMVectorAdd(boxMin, boxMax), 0.5f);
+    XMVECTOR extents = XMVectorScale(XMVectorSubtract(boxMax, boxMin), 0.5f);
+
+    for (const auto &plane : planes) {
+        XMVECTOR p = XMLoadFloat4(&plane);
+        const float dist   = XMVectorGetX(XMPlaneDotCoord(p, center));
+        const float radius = XMVectorGetX(XMVector3Dot(extents, XMVectorAbs(p)));
+        if (dist < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
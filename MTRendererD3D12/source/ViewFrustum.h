@@ -0,0 +1,73 @@
+/// @file ViewFrustum.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+/// @enum FrustumPlane
+enum class FrustumPlane : UINT {
+    Left,
+    Right,
+    Bottom,
+    Top,
+    Near,
+    Far,
+    Count,
+};
+
+
+/// @class ViewFrustum
+/// @~english
+/// @brief View frustum planes in world space used by CPU culling
+/// @~japanese
+/// @brief CPUカリングで使用するワールド空間の視錐台平面
+class ViewFrustum {
+public:
+    /// @~english
+    /// @brief Extract the planes from a view-projection matrix
+    /// @param[in] viewProjMtx View-projection matrix (not transposed
+    /// @~japanese
+    /// @brief View-Projection行列から平面を抽出
+    /// @param[in] viewProjMtx View-Projection行列（転置前
+    void SetFromMatrix(DirectX::FXMMATRIX viewProjMtx);
+
+    /// @~english
+    /// @brief Test if a sphere is at least partially inside the frustum
+    /// @param[in] center Sphere center
+    /// @param[in] radius Sphere radius
+    /// @return True if visible, false otherwise
+    /// @~japanese
+    /// @brief 球が視錐台内に含まれるか調べる
+    /// @param[in] center 球の中心
+    /// @param[in] radius 球の半径
+    /// @return 可視であればTrue、そうでないならFalseを返す
+    bool TestSphere(DirectX::FXMVECTOR center, float radius) const;
+
+    /// @~english
+    /// @brief Test if an axis aligned box is at least partially inside the frustum
+    /// @param[in] boxMin Minimum corner
+    /// @param[in] boxMax Maximum corner
+    /// @return True if visible, false otherwise
+    /// @~japanese
+    /// @brief 軸平行境界ボックスが視錐台内に含まれるか調べる
+    /// @param[in] boxMin 最小座標
+    /// @param[in] boxMax 最大座標
+    /// @return 可視であればTrue、そうでないならFalseを返す
+    bool TestBox(DirectX::FXMVECTOR boxMin, DirectX::FXMVECTOR boxMax) const;
+
+    /// @~english
+    /// @brief Get the plane (xyz: normal pointing inside, w: distance)
+    /// @~japanese
+    /// @brief 平面を取得（xyz: 内向き法線, w: 距離
+    DirectX::XMVECTOR GetPlane(const FrustumPlane plane) const {
+        return DirectX::XMLoadFloat4(&planes[static_cast<UINT>(plane)]);
+    }
+
+    /// @~english
+    /// @brief Constructor
+    /// @~japanese
+    /// @brief コンストラクタ
+    ViewFrustum();
+
+private:
+    DirectX::XMFLOAT4   planes[static_cast<UINT>(FrustumPlane::Count)];
+};
@@ -4,6 +4,20 @@ cbuffer SceneConstantBuffer : register(b0) {
     float4x4 worldMtx[512];
 };
 
+// First instance of the draw in worldMtx
+cbuffer DrawConstants : register(b1) {
+    uint instanceOffset;
+};
+
+// Part of the scene target holding the frame, and the largest UV sampled in it
+cbuffer UpscaleConstants : register(b2) {
+    float2 uvScale;
+    float2 uvMax;
+};
+
+Texture2D    sceneTexture  : register(t0);
+SamplerState linearSampler : register(s0);
+
 // Vertex shader inputs
 struct VSInput {
     float3 Position : POSITION;
@@ -18,6 +32,14 @@ struct VSOutput
     float4 color    : COLOR;
 };
 
+// Particle vertex shader inputs, the corner is per vertex and the rest per instance
+struct VSParticleInput {
+    float2 Corner   : CORNER;
+    float3 Position : PARTICLE_POSITION;
+    float  Size     : PARTICLE_SIZE;
+    float4 Color    : COLOR;
+};
+
 #define PSInput     VSOutput
 
 // Pixel shader outputs
@@ -31,7 +53,20 @@ PSInput VSMain(in VSInput vsInput)
 {
     VSOutput vsOut = (VSOutput)0;
 
-    vsOut.position = mul(mul(mul(float4(vsInput.Position, 1.0f), worldMtx[vsInput.InstanceID]), viewMtx), projMtx);
+    vsOut.position = mul(mul(mul(float4(vsInput.Position, 1.0f), worldMtx[instanceOffset + vsInput.InstanceID]), viewMtx), projMtx);
+    vsOut.color    = vsInput.Color;
+
+    return vsOut;
+}
+
+// Particle vertex shader, the quad is expanded in view space so it always faces the camera
+PSInput VSParticle(in VSParticleInput vsInput)
+{
+    VSOutput vsOut = (VSOutput)0;
+
+    float4 viewPosition = mul(float4(vsInput.Position, 1.0f), viewMtx);
+    viewPosition.xy += vsInput.Corner * vsInput.Size;
+    vsOut.position = mul(viewPosition, projMtx);
     vsOut.color    = vsInput.Color;
 
     return vsOut;
@@ -46,3 +81,26 @@ PSOutput PSMain(in PSInput psInput)
 
     return psOut;
 }
+
+// Upscale vertex shader, a triangle covering the screen built from the vertex ID
+PSInput VSUpscale(in uint vertexID : SV_VertexID)
+{
+    VSOutput vsOut = (VSOutput)0;
+
+    float2 uv = float2((vertexID << 1) & 2, vertexID & 2);
+    vsOut.position = float4(uv * float2(2.0f, -2.0f) + float2(-1.0f, 1.0f), 0.0f, 1.0f);
+    vsOut.color    = float4(uv, 0.0f, 0.0f);
+
+    return vsOut;
+}
+
+// Upscale pixel shader, the UV is carried in the color
+PSOutput PSUpscale(in PSInput psInput)
+{
+    PSOutput psOut = (PSOutput)0;
+
+    float2 uv = min(psInput.color.xy * uvScale, uvMax);
+    psOut.color0 = sceneTexture.SampleLevel(linearSampler, uv, 0.0f);
+
+    return psOut;
+}
@@ -1,40 +1,60 @@
 #pragma once
 
-#include <SDKDDKVer.h>
+#if defined(_WIN32)
+    #include <SDKDDKVer.h>
 
-#ifndef WIN32_LEAN_AND_MEAN
-    #define WIN32_LEAN_AND_MEAN         // Exclude rarely-used stuff from Windows headers
-#endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN         // Exclude rarely-used stuff from Windows headers
+    #endif
+
+    #include <windows.h>
+
+    #include <d3d12.h>
+    #include <dxgi1_6.h>
+    #include <D3Dcompiler.h>
 
-#include <windows.h>
+    #include <malloc.h>
+    #include <memory.h>
+    #include <tchar.h>
+    #include <wrl.h>
+    #include <process.h>
+    #include <shellapi.h>
+#else
+    // The CPU library is also built without the Windows SDK, see PlatformCompat.h
+    // CPUライブラリはWindows SDK無しでもビルドされる、PlatformCompat.h参照
+    #include "PlatformCompat.h"
+#endif
 
-#include <d3d12.h>
-#include <dxgi1_6.h>
-#include <D3Dcompiler.h>
 #include <DirectXMath.h>
+#include <emmintrin.h>
 
 #include <assert.h>
 #include <stdlib.h>
-#include <malloc.h>
-#include <memory.h>
-#include <tchar.h>
-#include <wrl.h>
-#include <process.h>
-#include <shellapi.h>
+#include <string.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
 #include <chrono>
 #include <cmath>
 #include <condition_variable>
+#include <fstream>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <numbers>
+#include <numeric>
 #include <string>
 #include <thread>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
 
 #if defined(_DEBUG)
     #define ENABLE_D3D12_DEBUG_INTERFACE    (1)
+    #define ENABLE_HEAP_ALLOCATION_GUARD    (1)
 #else
     #define ENABLE_D3D12_DEBUG_INTERFACE    (0)
+    #define ENABLE_HEAP_ALLOCATION_GUARD    (0)
 #endif
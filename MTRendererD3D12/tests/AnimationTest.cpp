@@ -0,0 +1,287 @@
+/// @file AnimationTest.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include "AnimationClip.h"
+#include "AnimationSystem.h"
+
+#include <random>
+
+using namespace DirectX;
+
+namespace {
+    const UINT  TEST_CLIP_FRAME_COUNT   = 64;
+    const UINT  TEST_SAMPLE_COUNT       = 4000;
+    const float TEST_NLERP_TOLERANCE    = 1e-5f;    // Radians, SampleBatch against the scalar nlerp
+    const float TEST_SLERP_TOLERANCE    = 1e-3f;    // Radians, the approximate slerp against the exact one
+    const float TEST_VALUE_TOLERANCE    = 1e-4f;
+
+    /// @~english
+    /// @brief Angle of the rotation between two unit quaternions
+    /// @~japanese
+    /// @brief 2つの単位クォータニオン間の回転の角度
+    float GetRotationAngle(FXMVECTOR q0, FXMVECTOR q1) {
+        // The chord between the quaternions stays accurate for small angles, unlike the arc cosine of the dot product
+        // 内積の逆余弦と違い、クォータニオン間の弦は小さな角度でも正確
+        const XMVECTOR aligned = (XMVectorGetX(XMVector4Dot(q0, q1)) < 0.0f) ? XMVectorNegate(q1) : q1;
+        return 4.0f * std::asin(std::min(XMVectorGetX(XMVector4Length(XMVectorSubtract(q0, aligned))) * 0.5f, 1.0f));
+    }
+
+    /// @~english
+    /// @brief Largest difference of the components
+    /// @~japanese
+    /// @brief 成分の差の最大値
+    float GetMaxDifference(FXMVECTOR v0, FXMVECTOR v1) {
+        float difference = 0.0f;
+        for (UINT c = 0; c < 4; ++c) {
+            difference = std::max(difference, std::fabs(XMVectorGetByIndex(v0, c) - XMVectorGetByIndex(v1, c)));
+        }
+        return difference;
+    }
+
+    /// @~english
+    /// @brief Random walk of the transform, each key turns by up to maxStep radians around each axis
+    /// @~japanese
+    /// @brief トランスフォームのランダムウォーク、各キーは各軸周りに最大maxStepラジアン回転する
+    AnimationClipSource MakeRandomSource(std::mt19937 *random, float maxStep) {
+        std::uniform_real_distribution<float> stepDist(-maxStep, maxStep);
+        std::uniform_real_distribution<float> valueDist(-10.0f, 10.0f);
+        std::uniform_real_distribution<float> scaleDist(0.5f, 2.0f);
+
+        AnimationClipSource source;
+        XMVECTOR rotation = XMQuaternionIdentity();
+        for (UINT i = 0; i < TEST_CLIP_FRAME_COUNT; ++i) {
+            source.translations.push_back(XMFLOAT3(valueDist(*random), valueDist(*random), valueDist(*random)));
+            source.scales.push_back(XMFLOAT3(scaleDist(*random), scaleDist(*random), scaleDist(*random)));
+
+            XMFLOAT4 q;
+            XMStoreFloat4(&q, rotation);
+            source.rotations.push_back(q);
+            rotation = XMQuaternionNormalize(XMQuaternionMultiply(rotation, XMQuaternionRotationRollPitchYaw(stepDist(*random), stepDist(*random), stepDist(*random))));
+        }
+        return source;
+    }
+
+    /// @~english
+    /// @brief Sample instances with SampleBatch and compare them with AnimationClip::Sample
+    /// @return Largest rotation angle from the reference in radians
+    /// @~japanese
+    /// @brief SampleBatchでインスタンスをサンプリングしAnimationClip::Sampleと比較
+    /// @return 基準実装からの回転の角度の最大値（ラジアン
+    float CompareWithReference(const std::vector<const AnimationClip *> &clips, const std::vector<float> &times, bool batchSlerp, bool referenceSlerp) {
+        const UINT count = static_cast<UINT>(clips.size());
+        std::vector<UINT> dstIndices(count);
+        for (UINT i = 0; i < count; ++i) {
+            dstIndices[i] = count - 1 - i;
+        }
+        std::vector<XMVECTOR> translations(count), rotations(count), scales(count);
+        AnimationSystem::SampleBatch(count, clips.data(), times.data(), dstIndices.data(), batchSlerp, translations.data(), rotations.data(), scales.data());
+
+        float maxAngle = 0.0f;
+        UINT mismatchCount = 0;
+        for (UINT i = 0; i < count; ++i) {
+            XMVECTOR translation, rotation, scale;
+            clips[i]->Sample(times[i], referenceSlerp, &translation, &rotation, &scale);
+            const UINT dst = dstIndices[i];
+            mismatchCount += (TEST_VALUE_TOLERANCE < GetMaxDifference(translation, translations[dst])) ? 1 : 0;
+            mismatchCount += (TEST_VALUE_TOLERANCE < GetMaxDifference(scale, scales[dst])) ? 1 : 0;
+            mismatchCount += (TEST_VALUE_TOLERANCE < std::fabs(XMVectorGetX(XMVector4Length(rotations[dst])) - 1.0f)) ? 1 : 0;
+            maxAngle = std::max(maxAngle, GetRotationAngle(rotation, rotations[dst]));
+        }
+        TEST_CHECK(mismatchCount == 0);
+        return maxAngle;
+    }
+
+    /// @~english
+    /// @brief SampleBatch matches the scalar reference, nlerp exactly and the approximate slerp within its bound,
+    ///        from small steps between keys up to nearly opposite keys
+    /// @~japanese
+    /// @brief SampleBatchはスカラーの基準実装と一致する、nlerpは正確に、近似slerpはその上限内で、
+    ///        キー間の小さなステップからほぼ反対向きのキーまで
+    void TestAccuracy() {
+        std::mt19937 random(38);
+        for (float maxStep : { 0.01f, 0.3f, 1.0f, 1.8f }) {
+            std::vector<AnimationClip> clips(8);
+            for (auto &clip : clips) {
+                TEST_CHECK(clip.Build(MakeRandomSource(&random, maxStep)));
+            }
+
+            std::uniform_int_distribution<size_t> clipDist(0, clips.size() - 1);
+            std::uniform_real_distribution<float> timeDist(-0.5f, clips[0].GetDuration() + 0.5f);
+            std::vector<const AnimationClip *> sampledClips(TEST_SAMPLE_COUNT);
+            std::vector<float> times(TEST_SAMPLE_COUNT);
+            for (UINT i = 0; i < TEST_SAMPLE_COUNT; ++i) {
+                sampledClips[i] = &clips[clipDist(random)];
+                times[i] = timeDist(random);
+            }
+
+            TEST_CHECK(CompareWithReference(sampledClips, times, false, false) < TEST_NLERP_TOLERANCE);
+            TEST_CHECK(CompareWithReference(sampledClips, times, true, true) < TEST_SLERP_TOLERANCE);
+        }
+    }
+
+    /// @~english
+    /// @brief Source keys flipping to the opposite quaternion are the same rotations, they must sample the same
+    ///        as the keys without the flips, also when the keys are 180 degrees apart
+    /// @~japanese
+    /// @brief 反対のクォータニオンへ反転するソースのキーは同じ回転であり、反転の無いキーと同じくサンプリング
+    ///        されなければならない、キーが180度離れている場合も同様
+    void TestNegativeDot() {
+        std::mt19937 random(380);
+        AnimationClipSource source = MakeRandomSource(&random, 0.8f);
+        AnimationClipSource flippedSource = source;
+        for (size_t i = 1; i < flippedSource.rotations.size(); i += 2) {
+            XMStoreFloat4(&flippedSource.rotations[i], XMVectorNegate(XMLoadFloat4(&flippedSource.rotations[i])));
+        }
+
+        AnimationClip clip, flippedClip;
+        TEST_CHECK(clip.Build(source));
+        TEST_CHECK(flippedClip.Build(flippedSource));
+        std::vector<const AnimationClip *> clips;
+        std::vector<float> times;
+        for (UINT i = 0; i < TEST_SAMPLE_COUNT; ++i) {
+            clips.push_back((i % 2 == 0) ? &clip : &flippedClip);
+            times.push_back(static_cast<float>(i / 2) / static_cast<float>(TEST_SAMPLE_COUNT / 2) * clip.GetDuration());
+        }
+        TEST_CHECK(CompareWithReference(clips, times, false, false) < TEST_NLERP_TOLERANCE);
+        TEST_CHECK(CompareWithReference(clips, times, true, true) < TEST_SLERP_TOLERANCE);
+
+        UINT mismatchCount = 0;
+        for (UINT i = 0; i < TEST_SAMPLE_COUNT; i += 2) {
+            XMVECTOR t0, r0, s0, t1, r1, s1;
+            clip.Sample(times[i], true, &t0, &r0, &s0);
+            flippedClip.Sample(times[i], true, &t1, &r1, &s1);
+            mismatchCount += (TEST_SLERP_TOLERANCE < GetRotationAngle(r0, r1)) ? 1 : 0;
+        }
+        TEST_CHECK(mismatchCount == 0);
+
+        // Half a turn around X, the cosine between the keys is 0 and the middle is a quarter turn
+        // X軸周りの半回転、キー間の余弦は0で中間は4分の1回転
+        AnimationClipSource halfTurnSource;
+        halfTurnSource.sampleRate = 1.0f;
+        halfTurnSource.translations.assign(2, XMFLOAT3(0.0f, 0.0f, 0.0f));
+        halfTurnSource.scales.assign(2, XMFLOAT3(1.0f, 1.0f, 1.0f));
+        halfTurnSource.rotations = { XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f), XMFLOAT4(-1.0f, 0.0f, 0.0f, 0.0f) };
+        AnimationClip halfTurnClip;
+        TEST_CHECK(halfTurnClip.Build(halfTurnSource));
+
+        const AnimationClip *halfTurnClips[] = { &halfTurnClip, &halfTurnClip, &halfTurnClip };
+        const float halfTurnTimes[] = { 0.25f, 0.5f, 0.75f };
+        const UINT halfTurnIndices[] = { 0, 1, 2 };
+        for (bool slerp : { false, true }) {
+            XMVECTOR translations[3], rotations[3], scales[3];
+            AnimationSystem::SampleBatch(3, halfTurnClips, halfTurnTimes, halfTurnIndices, slerp, translations, rotations, scales);
+            for (UINT i = 0; i < 3; ++i) {
+                XMVECTOR translation, rotation, scale;
+                halfTurnClip.Sample(halfTurnTimes[i], slerp, &translation, &rotation, &scale);
+                TEST_CHECK(GetRotationAngle(rotation, rotations[i]) < (slerp ? TEST_SLERP_TOLERANCE : TEST_NLERP_TOLERANCE));
+            }
+            TEST_CHECK(std::fabs(GetRotationAngle(XMQuaternionIdentity(), rotations[1]) - XM_PIDIV2) < TEST_SLERP_TOLERANCE);
+            if (slerp) {
+                TEST_CHECK(std::fabs(GetRotationAngle(XMQuaternionIdentity(), rotations[0]) - XM_PIDIV4) < TEST_SLERP_TOLERANCE);
+            }
+        }
+    }
+
+    /// @~english
+    /// @brief Identical and nearly identical keys, the slerp correction must stay finite where the angle vanishes
+    /// @~japanese
+    /// @brief 同一およびほぼ同一のキー、角度が消える所でもslerpの補正は有限でなければならない
+    void TestNearIdentical() {
+        for (float step : { 0.0f, 1e-6f, 1e-4f, 1e-2f }) {
+            AnimationClipSource source;
+            XMVECTOR rotation = XMQuaternionRotationRollPitchYaw(0.3f, -1.2f, 2.0f);
+            for (UINT i = 0; i < TEST_CLIP_FRAME_COUNT; ++i) {
+                XMFLOAT4 q;
+                XMStoreFloat4(&q, rotation);
+                source.rotations.push_back(q);
+                source.translations.push_back(XMFLOAT3(1.0f, 2.0f, 3.0f));
+                source.scales.push_back(XMFLOAT3(1.0f, 1.0f, 1.0f));
+                rotation = XMQuaternionNormalize(XMQuaternionMultiply(rotation, XMQuaternionRotationRollPitchYaw(step, step * 0.5f, 0.0f)));
+            }
+            AnimationClip clip;
+            TEST_CHECK(clip.Build(source));
+
+            std::vector<const AnimationClip *> clips(TEST_SAMPLE_COUNT / 4, &clip);
+            std::vector<float> times(clips.size());
+            for (size_t i = 0; i < times.size(); ++i) {
+                times[i] = static_cast<float>(i) / static_cast<float>(times.size()) * clip.GetDuration();
+            }
+            TEST_CHECK(CompareWithReference(clips, times, false, false) < TEST_NLERP_TOLERANCE);
+            TEST_CHECK(CompareWithReference(clips, times, true, true) < TEST_SLERP_TOLERANCE);
+            TEST_CHECK(CompareWithReference(clips, times, true, false) < TEST_SLERP_TOLERANCE);
+        }
+    }
+
+    /// @~english
+    /// @brief Counts that are not a multiple of the SIMD width write only their own instances
+    /// @~japanese
+    /// @brief SIMD幅の倍数でない数は自身のインスタンスのみを書き込む
+    void TestPartialLanes() {
+        std::mt19937 random(3800);
+        AnimationClip clip;
+        TEST_CHECK(clip.Build(MakeRandomSource(&random, 0.5f)));
+
+        const XMVECTOR sentinel = XMVectorSet(-7.0f, -7.0f, -7.0f, -7.0f);
+        for (UINT count = 1; count <= 9; ++count) {
+            std::vector<const AnimationClip *> clips(count, &clip);
+            std::vector<float> times(count);
+            std::vector<UINT> dstIndices(count);
+            for (UINT i = 0; i < count; ++i) {
+                times[i]      = static_cast<float>(i) * 0.1f;
+                dstIndices[i] = i * 2 + 1;
+            }
+            std::vector<XMVECTOR> translations(count * 2 + 1, sentinel), rotations(count * 2 + 1, sentinel), scales(count * 2 + 1, sentinel);
+            AnimationSystem::SampleBatch(count, clips.data(), times.data(), dstIndices.data(), false, translations.data(), rotations.data(), scales.data());
+
+            UINT mismatchCount = 0;
+            for (UINT i = 0; i <= count * 2; i += 2) {
+                mismatchCount += XMVector4Equal(translations[i], sentinel) ? 0 : 1;
+                mismatchCount += XMVector4Equal(rotations[i], sentinel) ? 0 : 1;
+                mismatchCount += XMVector4Equal(scales[i], sentinel) ? 0 : 1;
+            }
+            for (UINT i = 0; i < count; ++i) {
+                XMVECTOR translation, rotation, scale;
+                clip.Sample(times[i], false, &translation, &rotation, &scale);
+                mismatchCount += (TEST_VALUE_TOLERANCE < GetMaxDifference(translation, translations[dstIndices[i]])) ? 1 : 0;
+                mismatchCount += (TEST_NLERP_TOLERANCE < GetRotationAngle(rotation, rotations[dstIndices[i]])) ? 1 : 0;
+            }
+            TEST_CHECK(mismatchCount == 0);
+        }
+    }
+
+    /// @~english
+    /// @brief Empty, inconsistent and too long sources are refused
+    /// @~japanese
+    /// @brief 空、不整合および長すぎるソースは拒否する
+    void TestBuild() {
+        AnimationClip clip;
+        AnimationClipSource source;
+        TEST_CHECK(!clip.Build(source));
+
+        std::mt19937 random(3);
+        source = MakeRandomSource(&random, 0.1f);
+        source.scales.pop_back();
+        TEST_CHECK(!clip.Build(source));
+
+        source = MakeRandomSource(&random, 0.1f);
+        source.sampleRate = 0.0f;
+        TEST_CHECK(!clip.Build(source));
+
+        source = MakeRandomSource(&random, 0.1f);
+        TEST_CHECK(clip.Build(source));
+        TEST_CHECK(clip.GetFrameCount() == TEST_CLIP_FRAME_COUNT);
+        TEST_CHECK(clip.GetCompressedSize() == TEST_CLIP_FRAME_COUNT * sizeof(AnimationKey));
+        TEST_CHECK_NEAR(clip.GetDuration(), static_cast<float>(TEST_CLIP_FRAME_COUNT - 1) / DEFAULT_ANIMATION_SAMPLE_RATE, 1e-6f);
+    }
+} // namespace ""
+
+int main() {
+    TestAccuracy();
+    TestNegativeDot();
+    TestNearIdentical();
+    TestPartialLanes();
+    TestBuild();
+    return FinishTest("AnimationTest");
+}
@@ -0,0 +1,156 @@
+/// @file DynamicResolutionTest.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include "DynamicResolution.h"
+
+namespace {
+    const UINT  TEST_TRACE_FRAME_COUNT  = 600;
+    const UINT  TEST_SETTLE_FRAME_COUNT = 120;
+    const UINT  TEST_TIMING_LATENCY     = 2;        // Frames until a GPU timing arrives
+
+    /// @~english
+    /// @brief GPU cost of a traced frame, a fixed part and a part proportional to the pixel count
+    /// @~japanese
+    /// @brief トレースしたフレームのGPUコスト、固定の部分とピクセル数に比例する部分
+    struct TraceFrame {
+        float   fixedInMs;
+        float   fullScalePixelInMs;
+    };
+
+    /// @~english
+    /// @brief Scales and GPU times of a trace run through the controller
+    /// @~japanese
+    /// @brief 制御を通したトレースのスケールとGPU時間
+    struct TraceResult {
+        std::vector<float>  scales;
+        std::vector<float>  gpuTimesInMs;
+
+        /// @brief Number of scale changes from a frame on
+        UINT CountChanges(size_t firstFrame) const {
+            UINT changeCount = 0;
+            for (size_t i = std::max<size_t>(firstFrame, 1); i < scales.size(); ++i) {
+                changeCount += (scales[i] != scales[i - 1]) ? 1 : 0;
+            }
+            return changeCount;
+        }
+    };
+
+    /// @~english
+    /// @brief Render a trace, each GPU timing reaches the controller TEST_TIMING_LATENCY frames late
+    /// @~japanese
+    /// @brief トレースを描画する、各GPU計測はTEST_TIMING_LATENCYフレーム遅れて制御に届く
+    TraceResult RunTrace(DynamicResolutionController *controller, const std::vector<TraceFrame> &trace) {
+        TraceResult result;
+        for (size_t f = 0; f < trace.size(); ++f) {
+            const float scale = controller->GetScale();
+            result.scales.push_back(scale);
+            result.gpuTimesInMs.push_back(trace[f].fixedInMs + trace[f].fullScalePixelInMs * scale * scale);
+            if (TEST_TIMING_LATENCY <= f) {
+                const size_t measured = f - TEST_TIMING_LATENCY;
+                controller->Update(result.gpuTimesInMs[measured], result.scales[measured]);
+            }
+        }
+        return result;
+    }
+
+    /// @~english
+    /// @brief True if a scale is within the deadband of the wanted scale, or the step below it when the deadband holds no step
+    /// @~japanese
+    /// @brief スケールが望むスケールのデッドバンド内、またはデッドバンドがステップを含まない場合はその下のステップならTrue
+    bool IsSettledNear(const DynamicResolutionDesc &desc, float wantedScale, float scale) {
+        const float tolerance = 1e-6f;
+        return std::fabs(wantedScale - scale) <= scale * desc.deadband + tolerance || (scale <= wantedScale && wantedScale - scale < desc.scaleStep);
+    }
+
+    /// @~english
+    /// @brief A steady load settles on one scale within the budget and the deadband of the wanted scale
+    /// @~japanese
+    /// @brief 一定の負荷は予算内かつ望むスケールのデッドバンド内の1つのスケールに落ち着く
+    void TestSteadyState() {
+        const DynamicResolutionDesc desc;
+        for (float pixelInMs : { 8.0f, 16.0f, 22.0f, 28.0f }) {
+            DynamicResolutionController controller;
+            controller.Init(desc);
+            const TraceResult result = RunTrace(&controller, std::vector<TraceFrame>(TEST_TRACE_FRAME_COUNT, TraceFrame{ 0.0f, pixelInMs }));
+
+            const float wantedScale = std::clamp(std::sqrt(desc.targetFrameTimeInMs * desc.headroom / pixelInMs), desc.minScale, desc.maxScale);
+            const float scale = result.scales.back();
+            TEST_CHECK(result.CountChanges(TEST_SETTLE_FRAME_COUNT) == 0);
+            TEST_CHECK(IsSettledNear(desc, wantedScale, scale));
+            TEST_CHECK(std::fmod(scale, desc.scaleStep) == 0.0f);
+            TEST_CHECK(result.gpuTimesInMs.back() <= desc.targetFrameTimeInMs);
+        }
+    }
+
+    /// @~english
+    /// @brief Isolated spikes are left at once and the scale returns to where it settled
+    /// @~japanese
+    /// @brief 単発のスパイクからは即座に抜け、スケールは落ち着いていた値へ戻る
+    void TestSpike() {
+        const DynamicResolutionDesc desc;
+        std::vector<TraceFrame> trace(TEST_TRACE_FRAME_COUNT, TraceFrame{ 2.0f, 12.0f });
+        UINT spikeCount = 0;
+        for (size_t f = TEST_SETTLE_FRAME_COUNT; f < trace.size(); f += 97) {
+            trace[f].fullScalePixelInMs = 40.0f;
+            spikeCount++;
+        }
+
+        DynamicResolutionController controller;
+        controller.Init(desc);
+        const TraceResult result = RunTrace(&controller, trace);
+        const float settledScale = result.scales[TEST_SETTLE_FRAME_COUNT];
+
+        // The spike is seen TEST_TIMING_LATENCY frames later and lowers the scale of the next frame
+        // スパイクはTEST_TIMING_LATENCYフレーム後に見え、次のフレームのスケールを下げる
+        const size_t reactFrame = TEST_SETTLE_FRAME_COUNT + TEST_TIMING_LATENCY + 1;
+        TEST_CHECK(result.scales[reactFrame] < settledScale);
+        TEST_CHECK(result.scales.back() == settledScale);
+        TEST_CHECK(result.CountChanges(0) <= spikeCount * 16);
+
+        // Only the spike frames themselves run over budget
+        // スパイクのフレーム自体のみが予算を超過する
+        UINT overBudgetCount = 0;
+        for (size_t f = TEST_SETTLE_FRAME_COUNT; f < trace.size(); ++f) {
+            overBudgetCount += (desc.targetFrameTimeInMs < result.gpuTimesInMs[f]) ? 1 : 0;
+        }
+        TEST_CHECK(overBudgetCount <= spikeCount);
+    }
+
+    /// @~english
+    /// @brief At low scales the step is close to the deadband, a change must not step past it and dither
+    /// @~japanese
+    /// @brief 低いスケールではステップがデッドバンドに近く、変更がそれを越えて揺れてはならない
+    void TestLowScale() {
+        DynamicResolutionDesc desc;
+        desc.minScale = 0.25f;
+        for (UINT i = 0; i <= 40; ++i) {
+            const float pixelInMs = 40.0f + static_cast<float>(i) * 5.0f;
+            DynamicResolutionController controller;
+            controller.Init(desc);
+            const TraceResult result = RunTrace(&controller, std::vector<TraceFrame>(TEST_TRACE_FRAME_COUNT, TraceFrame{ 0.0f, pixelInMs }));
+
+            const float wantedScale = std::clamp(std::sqrt(desc.targetFrameTimeInMs * desc.headroom / pixelInMs), desc.minScale, desc.maxScale);
+            const float scale = result.scales.back();
+            TEST_CHECK(result.CountChanges(TEST_SETTLE_FRAME_COUNT) == 0);
+            TEST_CHECK(IsSettledNear(desc, wantedScale, scale));
+            TEST_CHECK(result.gpuTimesInMs.back() <= desc.targetFrameTimeInMs);
+        }
+
+        // A load beyond the range holds the minimum scale
+        // 範囲を超える負荷は最小スケールを保つ
+        DynamicResolutionController controller;
+        controller.Init(desc);
+        const TraceResult result = RunTrace(&controller, std::vector<TraceFrame>(TEST_TRACE_FRAME_COUNT, TraceFrame{ 2.0f, 1000.0f }));
+        TEST_CHECK(result.scales.back() == desc.minScale);
+        TEST_CHECK(result.CountChanges(TEST_SETTLE_FRAME_COUNT) == 0);
+    }
+} // namespace ""
+
+int main() {
+    TestSteadyState();
+    TestSpike();
+    TestLowScale();
+    return FinishTest("DynamicResolutionTest");
+}
@@ -0,0 +1,186 @@
+/// @file FrameReadbackTest.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include "FrameReadback.h"
+
+#include <deque>
+
+namespace {
+    const UINT  TEST_SLOT_COUNT         = 4;
+    const UINT  TEST_FRAME_COUNT        = 200;
+    const UINT  TEST_GPU_LATENCY        = 2;        // Frames until the GPU finishes a copy
+    const auto  TEST_WAIT_TIMEOUT       = std::chrono::seconds(5);
+
+    /// @~english
+    /// @brief Fence standing in for the GPU, a signaled value completes a number of frames later
+    /// @~japanese
+    /// @brief GPUの代わりのフェンス、シグナルした値は数フレーム後に完了する
+    class MockFence {
+    public:
+        void Signal(UINT64 value, UINT64 frameNumber) {
+            pending.push_back(std::make_pair(value, frameNumber + TEST_GPU_LATENCY));
+        }
+
+        /// @brief Complete the values due by a frame
+        void Advance(UINT64 frameNumber) {
+            while (!pending.empty() && pending.front().second <= frameNumber) {
+                completedValue.store(pending.front().first);
+                pending.pop_front();
+            }
+        }
+
+        /// @brief Complete every value signaled
+        void Flush() {
+            Advance(~0ull);
+        }
+
+        UINT64 GetCompletedValue() const {
+            return completedValue.load();
+        }
+
+        MockFence()
+        : completedValue(0)
+        {
+            ;
+        }
+
+    private:
+        std::atomic<UINT64>                         completedValue;
+        std::deque<std::pair<UINT64, UINT64>>       pending;
+    };
+
+    /// @~english
+    /// @brief Wait until the consumer thread delivered a number of slots
+    /// @~japanese
+    /// @brief 消費者スレッドが指定数のスロットを受け渡すまで待機
+    bool WaitDelivered(FrameReadbackRing *ring, UINT count, UINT *deliveredCount) {
+        const auto endTime = std::chrono::steady_clock::now() + TEST_WAIT_TIMEOUT;
+        while (*deliveredCount < count && std::chrono::steady_clock::now() < endTime) {
+            *deliveredCount += ring->TakeDeliveredCount();
+            std::this_thread::yield();
+        }
+        return *deliveredCount == count;
+    }
+
+    /// @~english
+    /// @brief Slots are delivered in order, only after their fence completed and before they are acquired again
+    /// @~japanese
+    /// @brief スロットは順に、フェンスの完了後かつ再取得前に受け渡される
+    void TestOrdering() {
+        MockFence fence;
+        std::vector<UINT64> slotFrames(TEST_SLOT_COUNT, 0);
+        std::vector<UINT64> slotFences(TEST_SLOT_COUNT, 0);
+        std::vector<UINT64> delivered;
+        std::atomic<UINT> earlyCount(0);
+        std::atomic<UINT> overwrittenCount(0);
+
+        // The consumer thread only reads what the RenderThread wrote before the fence it waited for
+        // 消費者スレッドはRenderThreadが待機したフェンスより前に書き込んだものだけを読む
+        FrameReadbackRing ring;
+        TEST_CHECK(ring.Init(TEST_SLOT_COUNT, [&](UINT slotIndex, UINT64 frameNumber) {
+            earlyCount       += (fence.GetCompletedValue() < slotFences[slotIndex]) ? 1 : 0;
+            overwrittenCount += (slotFrames[slotIndex] != frameNumber) ? 1 : 0;
+            delivered.push_back(frameNumber);
+        }));
+
+        UINT64 lastFenceValue = 0;
+        for (UINT64 frame = 1; frame <= TEST_FRAME_COUNT; ++frame) {
+            fence.Advance(frame);
+            ring.Poll(fence.GetCompletedValue(), frame);
+
+            UINT64 fenceValue = 0;
+            const UINT slotIndex = ring.Acquire(frame, &fenceValue);
+            if (slotIndex == INVALID_READBACK_SLOT) {
+                continue;
+            }
+            TEST_CHECK(slotIndex == lastFenceValue % TEST_SLOT_COUNT);
+            TEST_CHECK(fenceValue == lastFenceValue + 1);
+            slotFrames[slotIndex] = frame;
+            slotFences[slotIndex] = fenceValue;
+            fence.Signal(fenceValue, frame);
+            lastFenceValue = fenceValue;
+        }
+        fence.Flush();
+        ring.Poll(fence.GetCompletedValue(), TEST_FRAME_COUNT + TEST_GPU_LATENCY);
+        ring.Deinit();
+
+        const FrameReadbackStats &stats = ring.GetStats();
+        TEST_CHECK(stats.capturedCount + stats.skippedCount == TEST_FRAME_COUNT);
+        TEST_CHECK(stats.readyCount == stats.capturedCount);
+        TEST_CHECK(delivered.size() == stats.capturedCount);
+        TEST_CHECK(std::is_sorted(delivered.begin(), delivered.end()));
+        TEST_CHECK(earlyCount == 0);
+        TEST_CHECK(overwrittenCount == 0);
+    }
+
+    /// @~english
+    /// @brief A stalled consumer makes the RenderThread skip frames instead of waiting, the slots return once delivered
+    /// @~japanese
+    /// @brief 停止した消費者によりRenderThreadは待たずにフレームをスキップし、スロットは受け渡し後に戻る
+    void TestStalledConsumer() {
+        std::mutex gateMtx;
+        std::unique_lock<std::mutex> gate(gateMtx);
+
+        FrameReadbackRing ring;
+        TEST_CHECK(ring.Init(TEST_SLOT_COUNT, [&gateMtx](UINT, UINT64) {
+            std::lock_guard<std::mutex> lock(gateMtx);
+        }));
+
+        UINT64 fenceValue = 0;
+        for (UINT64 frame = 1; frame <= TEST_SLOT_COUNT; ++frame) {
+            TEST_CHECK(ring.Acquire(frame, &fenceValue) != INVALID_READBACK_SLOT);
+        }
+        ring.Poll(fenceValue, TEST_SLOT_COUNT + 1);
+        TEST_CHECK(ring.Acquire(TEST_SLOT_COUNT + 1, &fenceValue) == INVALID_READBACK_SLOT);
+        TEST_CHECK(ring.GetStats().skippedCount == 1);
+
+        gate.unlock();
+        UINT deliveredCount = 0;
+        TEST_CHECK(WaitDelivered(&ring, TEST_SLOT_COUNT, &deliveredCount));
+        TEST_CHECK(ring.Acquire(TEST_SLOT_COUNT + 2, &fenceValue) == 0);
+        TEST_CHECK(fenceValue == TEST_SLOT_COUNT + 1);
+        ring.Deinit();
+    }
+
+    /// @~english
+    /// @brief Deinit delivers the slots the GPU finished and drops the ones it did not, nothing is delivered after
+    /// @~japanese
+    /// @brief DeinitはGPUが完了したスロットを受け渡し、完了していないものは破棄し、その後は何も受け渡さない
+    void TestDeinit() {
+        std::vector<UINT64> delivered;
+        FrameReadbackRing ring;
+        TEST_CHECK(ring.Init(TEST_SLOT_COUNT, [&delivered](UINT, UINT64 frameNumber) {
+            delivered.push_back(frameNumber);
+        }));
+
+        UINT64 fenceValue = 0;
+        for (UINT64 frame = 1; frame <= 3; ++frame) {
+            ring.Acquire(frame, &fenceValue);
+        }
+        ring.Poll(2, 3);
+        ring.Deinit();
+        TEST_CHECK(delivered.size() == 2 && delivered[0] == 1 && delivered[1] == 2);
+
+        ring.Poll(3, 4);
+        TEST_CHECK(delivered.size() == 2);
+
+        // The ring starts over after another Init
+        // 再度のInit後はリングは最初から始まる
+        TEST_CHECK(ring.Init(TEST_SLOT_COUNT, [&delivered](UINT, UINT64 frameNumber) {
+            delivered.push_back(frameNumber);
+        }));
+        TEST_CHECK(ring.Acquire(5, &fenceValue) == 0 && fenceValue == 1);
+        ring.Poll(1, 5);
+        ring.Deinit();
+        TEST_CHECK(delivered.size() == 3 && delivered.back() == 5);
+    }
+} // namespace ""
+
+int main() {
+    TestOrdering();
+    TestStalledConsumer();
+    TestDeinit();
+    return FinishTest("FrameReadbackTest");
+}
@@ -0,0 +1,161 @@
+/// @file IndirectDrawBuilderTest.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include "IndirectDrawBuilder.h"
+#include "JobSystem.h"
+
+#include <random>
+
+namespace {
+    const UINT TEST_MESH_COUNT      = 50;
+    const UINT TEST_PIPELINE_COUNT  = 3;
+    const UINT TEST_WORKER_COUNT    = 3;
+    const UINT TEST_SEED            = 7;
+
+    /// @~english
+    /// @brief Sorted render queue items, some naming an unknown pipeline or mesh and some sharing their state
+    /// @~japanese
+    /// @brief ソート済みの描画キューの要素、一部は未知のパイプラインまたはメッシュを参照し、一部はステートを共有する
+    std::vector<RenderItem> MakeItems(UINT count, std::mt19937 *rng) {
+        std::vector<RenderItem> items(count);
+        for (UINT i = 0; i < count; ++i) {
+            const RenderPass pass = ((*rng)() % 5 == 0) ? RenderPass::Transparent : RenderPass::Opaque;
+            const UINT pipeline = (*rng)() % (TEST_PIPELINE_COUNT + 1);
+            const UINT material = (*rng)() % 2;
+            const UINT mesh     = (*rng)() % (TEST_MESH_COUNT + 2);
+            const UINT lod      = (*rng)() % 3;
+            const UINT depth    = ((*rng)() % 4 == 0) ? 0 : (*rng)();
+            items[i].sortKey       = RenderQueue::MakeSortKey(pass, pipeline, material, mesh, lod, depth);
+            items[i].instanceIndex = i;
+            items[i].reserved      = 0;
+        }
+        std::sort(items.begin(), items.end(), [](const RenderItem &a, const RenderItem &b) {
+            return a.sortKey < b.sortKey;
+        });
+        return items;
+    }
+
+    /// @~english
+    /// @brief Records of the direct submission, one per drawable run of equal state, with the pipeline of each
+    /// @~japanese
+    /// @brief 直接発行のレコード、等しいステートの描画可能な連続毎に1つ、それぞれのパイプラインと共に
+    void BuildReference(const IndirectDrawBuildDesc &desc, std::vector<IndirectDrawRecord> *dstRecords, std::vector<UINT> *dstPipelines) {
+        for (UINT runBegin = 0; runBegin < desc.itemCount; ) {
+            const UINT64 sortKey  = desc.items[runBegin].sortKey;
+            const UINT64 stateKey = RenderQueue::GetStateKey(sortKey);
+            UINT runEnd = runBegin + 1;
+            while (runEnd < desc.itemCount && RenderQueue::GetStateKey(desc.items[runEnd].sortKey) == stateKey) {
+                runEnd++;
+            }
+            if (desc.depthOnly && (sortKey >> SORT_KEY_PASS_SHIFT) != static_cast<UINT64>(RenderPass::Opaque)) {
+                break;
+            }
+
+            const UINT pipeline = RenderQueue::GetPipeline(sortKey);
+            const UINT mesh     = RenderQueue::GetMesh(sortKey);
+            if (pipeline < desc.pipelineCount && mesh < desc.meshCount) {
+                const IndirectMeshRange &range = desc.meshRanges[mesh * MAX_MESH_LOD_COUNT + RenderQueue::GetLod(sortKey)];
+                IndirectDrawRecord record;
+                record.instanceOffset        = runBegin;
+                record.indexCountPerInstance = range.indexCount;
+                record.instanceCount         = runEnd - runBegin;
+                record.startIndexLocation    = range.startIndex;
+                record.baseVertexLocation    = range.baseVertex;
+                record.startInstanceLocation = 0;
+                dstRecords->push_back(record);
+                dstPipelines->push_back(pipeline);
+            }
+            runBegin = runEnd;
+        }
+    }
+
+    /// @~english
+    /// @brief The serial and parallel builds match the direct submission byte for byte
+    /// @~japanese
+    /// @brief 直列と並列の生成が直接発行とバイト単位で一致する
+    void TestMatchesDirectSubmission(JobSystem *jobSystem) {
+        std::vector<IndirectMeshRange> meshRanges(TEST_MESH_COUNT * MAX_MESH_LOD_COUNT);
+        for (UINT i = 0; i < static_cast<UINT>(meshRanges.size()); ++i) {
+            meshRanges[i].indexCount = 3 * (i + 1);
+            meshRanges[i].startIndex = i * 100;
+            meshRanges[i].baseVertex = static_cast<INT>(i * 7) - 20;
+        }
+
+        // Counts around the task size split a run across tasks
+        // タスクサイズ前後の数は連続をタスク間で分割する
+        std::mt19937 rng(TEST_SEED);
+        for (UINT itemCount : { 0u, 1u, 5u, DEFAULT_INDIRECT_BUILD_BATCH_SIZE - 1, DEFAULT_INDIRECT_BUILD_BATCH_SIZE + 1, 200000u }) {
+            const std::vector<RenderItem> items = MakeItems(itemCount, &rng);
+            for (bool depthOnly : { false, true }) {
+                IndirectDrawBuildDesc desc;
+                desc.items          = items.data();
+                desc.itemCount      = itemCount;
+                desc.depthOnly      = depthOnly;
+                desc.meshRanges     = meshRanges.data();
+                desc.meshCount      = TEST_MESH_COUNT;
+                desc.pipelineCount  = TEST_PIPELINE_COUNT;
+
+                std::vector<IndirectDrawRecord> reference;
+                std::vector<UINT> referencePipelines;
+                BuildReference(desc, &reference, &referencePipelines);
+
+                // Different fills show any byte left unwritten
+                // 異なる値で埋める事で書き込まれていないバイトを検出する
+                std::vector<IndirectDrawRecord> serialRecords(itemCount + 1);
+                std::vector<IndirectDrawRecord> parallelRecords(itemCount + 1);
+                std::vector<IndirectDrawBatch> serialBatches(itemCount + 1);
+                std::vector<IndirectDrawBatch> parallelBatches(itemCount + 1);
+                memset(serialRecords.data(), 0xab, serialRecords.size() * sizeof(IndirectDrawRecord));
+                memset(parallelRecords.data(), 0xcd, parallelRecords.size() * sizeof(IndirectDrawRecord));
+                IndirectDrawBuildResult serialResult;
+                IndirectDrawBuildResult parallelResult;
+                IndirectDrawBuilder::Build(desc, nullptr, serialRecords.data(), serialBatches.data(), &serialResult);
+                IndirectDrawBuilder::Build(desc, jobSystem, parallelRecords.data(), parallelBatches.data(), &parallelResult);
+
+                TEST_CHECK(serialResult.recordCount == reference.size());
+                TEST_CHECK(parallelResult.recordCount == serialResult.recordCount);
+                TEST_CHECK(parallelResult.batchCount == serialResult.batchCount);
+                if (serialResult.recordCount != reference.size() || parallelResult.recordCount != serialResult.recordCount) {
+                    continue;
+                }
+                TEST_CHECK(memcmp(serialRecords.data(), reference.data(), reference.size() * sizeof(IndirectDrawRecord)) == 0);
+                TEST_CHECK(memcmp(parallelRecords.data(), serialRecords.data(), reference.size() * sizeof(IndirectDrawRecord)) == 0);
+                TEST_CHECK(memcmp(parallelBatches.data(), serialBatches.data(), serialResult.batchCount * sizeof(IndirectDrawBatch)) == 0);
+
+                // The batches cover the records in order and each record uses the pipeline of its batch
+                // バッチは順にレコードを覆い、各レコードはそのバッチのパイプラインを使う
+                UINT nextRecord    = 0;
+                UINT instanceCount = 0;
+                for (UINT b = 0; b < serialResult.batchCount; ++b) {
+                    const IndirectDrawBatch &batch = serialBatches[b];
+                    TEST_CHECK(batch.firstRecord == nextRecord && batch.recordCount != 0);
+                    for (UINT r = batch.firstRecord; r < batch.firstRecord + batch.recordCount && r < reference.size(); ++r) {
+                        TEST_CHECK(referencePipelines[r] == batch.pipelineIndex);
+                    }
+                    nextRecord += batch.recordCount;
+                }
+                for (const auto &record : reference) {
+                    instanceCount += record.instanceCount;
+                }
+                TEST_CHECK(nextRecord == serialResult.recordCount);
+                TEST_CHECK(serialResult.instanceCount == instanceCount);
+                TEST_CHECK(parallelResult.instanceCount == instanceCount);
+            }
+        }
+    }
+} // namespace ""
+
+int main() {
+    JobSystem jobSystem;
+    if (!jobSystem.Init(TEST_WORKER_COUNT)) {
+        OutputDebugStringA("JobSystem: could not initialize\n");
+        return -1;
+    }
+
+    TestMatchesDirectSubmission(&jobSystem);
+
+    jobSystem.Deinit();
+    return FinishTest("IndirectDrawBuilderTest");
+}
@@ -0,0 +1,168 @@
+/// @file InputQueueTest.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include "InputQueue.h"
+
+namespace {
+    const UINT  TEST_EVENT_COUNT        = 20000;
+    const UINT  TEST_KEY_CODE_COUNT     = 16;
+    const auto  TEST_FRAME_INTERVAL     = std::chrono::microseconds(1000);
+
+    /// @~english
+    /// @brief Event of the synthetic source, the index is carried in the cursor position to check the order
+    /// @~japanese
+    /// @brief 合成したイベント源のイベント、順序の確認の為に番号をカーソル位置で運ぶ
+    InputEvent MakeEvent(UINT index) {
+        InputEvent event = {};
+        event.timestamp = InputQueue::GetTimestamp();
+        event.type      = (index % 3 == 2) ? InputEventType::MouseMove : ((index % 3 == 0) ? InputEventType::KeyDown : InputEventType::KeyUp);
+        event.code      = (index / 3) % TEST_KEY_CODE_COUNT;
+        event.x         = static_cast<INT>(index);
+        event.y         = -static_cast<INT>(index);
+        return event;
+    }
+
+    /// @~english
+    /// @brief A source thread standing in for the window procedure feeds a MainThread loop, no event is lost or reordered
+    /// @~japanese
+    /// @brief ウィンドウプロシージャの代わりのイベント源スレッドがMainThreadのループへ供給し、イベントの消失も入れ替わりも無い
+    void TestSyntheticSource() {
+        static InputQueue queue;
+
+        // The source retries a full ring, every failed push is counted as dropped
+        // イベント源は満杯のリングに再試行し、失敗した追加はそれぞれ破棄として数える
+        std::atomic<bool> produced(false);
+        std::atomic<UINT> failedPushCount(0);
+        std::thread source([&produced, &failedPushCount]() {
+            for (UINT i = 0; i < TEST_EVENT_COUNT; ++i) {
+                const InputEvent event = MakeEvent(i);
+                while (!queue.Push(event)) {
+                    failedPushCount++;
+                    std::this_thread::yield();
+                }
+            }
+            produced = true;
+        });
+
+        // The MainThread drains in batches at the start of each frame, the RenderThread stages follow it
+        // MainThreadは各フレームの開始時にバッチで取り出し、RenderThreadの各段階がそれに続く
+        InputState state;
+        InputState expectedState;
+        InputLatencyTracker tracker;
+        InputEvent events[DEFAULT_INPUT_DRAIN_BATCH_SIZE];
+        UINT consumedCount = 0;
+        UINT outOfOrderCount = 0;
+        while (!produced || consumedCount < TEST_EVENT_COUNT) {
+            InputFrameStamp stamp;
+            stamp.consumeTimestamp = InputQueue::GetTimestamp();
+            for (;;) {
+                const UINT count = queue.Pop(events, DEFAULT_INPUT_DRAIN_BATCH_SIZE);
+                for (UINT i = 0; i < count; ++i) {
+                    outOfOrderCount += (events[i].x != static_cast<INT>(consumedCount + i)) ? 1 : 0;
+                    state.Apply(events[i]);
+                    stamp.Add(events[i]);
+                }
+                consumedCount += count;
+                if (count < DEFAULT_INPUT_DRAIN_BATCH_SIZE) {
+                    break;
+                }
+            }
+            tracker.OnFramePresented(InputQueue::GetTimestamp());
+            tracker.OnFrameSubmitted();
+            tracker.OnFrameRecorded(stamp);
+            std::this_thread::sleep_for(TEST_FRAME_INTERVAL);
+        }
+        for (UINT i = 0; i < 2; ++i) {
+            tracker.OnFramePresented(InputQueue::GetTimestamp());
+            tracker.OnFrameSubmitted();
+        }
+        source.join();
+
+        for (UINT i = 0; i < TEST_EVENT_COUNT; ++i) {
+            expectedState.Apply(MakeEvent(i));
+        }
+        const InputLatencyStats &stats = tracker.GetStats();
+        TEST_CHECK(consumedCount == TEST_EVENT_COUNT);
+        TEST_CHECK(outOfOrderCount == 0);
+        TEST_CHECK(queue.TakeDroppedCount() == failedPushCount);
+        TEST_CHECK(stats.eventCount == TEST_EVENT_COUNT);
+        TEST_CHECK(stats.queueTimeInMs <= stats.latencyInMs);
+        TEST_CHECK(stats.maxQueueTimeInMs <= stats.maxLatencyInMs);
+        TEST_CHECK(state.cursorX == expectedState.cursorX && state.cursorY == expectedState.cursorY);
+        TEST_CHECK(memcmp(state.keyDown, expectedState.keyDown, sizeof(state.keyDown)) == 0);
+    }
+
+    /// @~english
+    /// @brief Events pushed while the ring is full are dropped and counted, the queued ones keep their order
+    /// @~japanese
+    /// @brief リングが満杯の間に追加したイベントは破棄して数え、追加済みのものは順序を保つ
+    void TestOverflow() {
+        static InputQueue queue;
+        UINT queuedCount = 0;
+        for (UINT i = 0; i < DEFAULT_INPUT_QUEUE_CAPACITY + 10; ++i) {
+            queuedCount += queue.Push(MakeEvent(i)) ? 1 : 0;
+        }
+        TEST_CHECK(queuedCount == DEFAULT_INPUT_QUEUE_CAPACITY);
+        TEST_CHECK(queue.TakeDroppedCount() == 10);
+        TEST_CHECK(queue.TakeDroppedCount() == 0);
+
+        // Popping makes room again, the positions wrap around the ring
+        // 取り出すと再び空きができ、位置はリングを一周する
+        InputEvent events[DEFAULT_INPUT_DRAIN_BATCH_SIZE];
+        TEST_CHECK(queue.Pop(events, DEFAULT_INPUT_DRAIN_BATCH_SIZE) == DEFAULT_INPUT_DRAIN_BATCH_SIZE);
+        TEST_CHECK(events[0].x == 0 && events[DEFAULT_INPUT_DRAIN_BATCH_SIZE - 1].x == static_cast<INT>(DEFAULT_INPUT_DRAIN_BATCH_SIZE - 1));
+        TEST_CHECK(queue.Push(MakeEvent(DEFAULT_INPUT_QUEUE_CAPACITY + 10)));
+
+        UINT poppedCount = 0;
+        INT lastIndex = events[DEFAULT_INPUT_DRAIN_BATCH_SIZE - 1].x;
+        UINT outOfOrderCount = 0;
+        for (UINT count; (count = queue.Pop(events, DEFAULT_INPUT_DRAIN_BATCH_SIZE)) != 0; ) {
+            for (UINT i = 0; i < count; ++i) {
+                outOfOrderCount += (events[i].x <= lastIndex) ? 1 : 0;
+                lastIndex = events[i].x;
+            }
+            poppedCount += count;
+        }
+        TEST_CHECK(poppedCount == DEFAULT_INPUT_QUEUE_CAPACITY - DEFAULT_INPUT_DRAIN_BATCH_SIZE + 1);
+        TEST_CHECK(outOfOrderCount == 0);
+        TEST_CHECK(lastIndex == static_cast<INT>(DEFAULT_INPUT_QUEUE_CAPACITY + 10));
+    }
+
+    /// @~english
+    /// @brief The input of a frame is counted at the second present after it was recorded
+    /// @~japanese
+    /// @brief フレームの入力は記録後2回目の表示で数える
+    void TestLatencyTracker() {
+        InputLatencyTracker tracker;
+        InputFrameStamp stamp;
+        InputEvent event = {};
+        event.timestamp = 1000000;
+        stamp.Add(event);
+        event.timestamp = 3000000;
+        stamp.Add(event);
+        stamp.consumeTimestamp = 4000000;
+
+        tracker.OnFrameRecorded(stamp);
+        tracker.OnFramePresented(5000000);
+        TEST_CHECK(tracker.GetStats().frameCount == 0);
+        tracker.OnFrameSubmitted();
+        tracker.OnFramePresented(9000000);
+
+        const InputLatencyStats &stats = tracker.GetStats();
+        TEST_CHECK(stats.frameCount == 1 && stats.eventCount == 2);
+        TEST_CHECK_NEAR(stats.queueTimeInMs, 3.0f, 1e-4f);
+        TEST_CHECK_NEAR(stats.latencyInMs, 8.0f, 1e-4f);
+
+        tracker.OnFramePresented(10000000);
+        TEST_CHECK(tracker.GetStats().frameCount == 1);
+    }
+} // namespace ""
+
+int main() {
+    TestSyntheticSource();
+    TestOverflow();
+    TestLatencyTracker();
+    return FinishTest("InputQueueTest");
+}
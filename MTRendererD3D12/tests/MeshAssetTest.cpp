@@ -0,0 +1,172 @@
+/// @file MeshAssetTest.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include "MeshAsset.h"
+
+namespace {
+    const UINT  TEST_GRID_SIZE          = 8;
+
+    /// @~english
+    /// @brief Grid of quads with one meshlet per row
+    /// @~japanese
+    /// @brief 行毎に1つのMeshletを持つ四角形の格子
+    void MakeGrid(UINT vertexCountPerSide, MeshData *dstMesh, MeshletData *dstMeshlets) {
+        for (UINT y = 0; y < vertexCountPerSide; ++y) {
+            for (UINT x = 0; x < vertexCountPerSide; ++x) {
+                dstMesh->vertices.push_back({ { static_cast<float>(x), static_cast<float>(y), 0.0f }, { 1.0f, 1.0f, 1.0f, 1.0f } });
+            }
+        }
+        for (UINT y = 0; y + 1 < vertexCountPerSide; ++y) {
+            Meshlet meshlet = {};
+            meshlet.vertexOffset    = static_cast<UINT>(dstMeshlets->vertexIndices.size());
+            meshlet.primitiveOffset = static_cast<UINT>(dstMeshlets->primitives.size());
+            for (UINT x = 0; x < vertexCountPerSide; ++x) {
+                dstMeshlets->vertexIndices.push_back(y * vertexCountPerSide + x);
+                dstMeshlets->vertexIndices.push_back((y + 1) * vertexCountPerSide + x);
+            }
+            for (UINT x = 0; x + 1 < vertexCountPerSide; ++x) {
+                const UINT v = y * vertexCountPerSide + x;
+                dstMesh->indices.insert(dstMesh->indices.end(), { v, v + vertexCountPerSide, v + 1, v + 1, v + vertexCountPerSide, v + vertexCountPerSide + 1 });
+                const UINT l = x * 2;
+                dstMeshlets->primitives.push_back(l | ((l + 1) << 10) | ((l + 2) << 20));
+                dstMeshlets->primitives.push_back((l + 2) | ((l + 1) << 10) | ((l + 3) << 20));
+            }
+            meshlet.vertexCount    = vertexCountPerSide * 2;
+            meshlet.primitiveCount = (vertexCountPerSide - 1) * 2;
+            dstMeshlets->meshlets.push_back(meshlet);
+            dstMeshlets->bounds.push_back({ DirectX::XMFLOAT3(0.0f, static_cast<float>(y), 0.0f), static_cast<float>(vertexCountPerSide), DirectX::XMFLOAT3(0.0f, 0.0f, 1.0f), 1.0f });
+        }
+    }
+
+    /// @~english
+    /// @brief Load a copy of a binary with one header field changed
+    /// @~japanese
+    /// @brief ヘッダの1つのフィールドを変更したバイナリのコピーを読み込む
+    bool LoadWithHeaderField(const std::vector<BYTE> &binary, UINT MeshAssetHeader::*field, UINT value) {
+        std::vector<BYTE> data = binary;
+        MeshAssetHeader header;
+        memcpy(&header, data.data(), sizeof(header));
+        header.*field = value;
+        memcpy(data.data(), &header, sizeof(header));
+
+        MeshAsset asset;
+        const bool loaded = asset.Load(data.data(), data.size());
+        TEST_CHECK(loaded == asset.IsValid());
+        return loaded;
+    }
+
+    /// @~english
+    /// @brief A built mesh survives a round trip, both index formats
+    /// @~japanese
+    /// @brief 構築したメッシュは往復しても保たれる、両方のインデックスフォーマット
+    void TestRoundTrip() {
+        for (UINT vertexCountPerSide : { TEST_GRID_SIZE, 300u }) {
+            MeshData meshData;
+            MeshletData meshletData;
+            MakeGrid(vertexCountPerSide, &meshData, &meshletData);
+
+            MeshAsset built;
+            TEST_CHECK(built.Build(meshData, &meshletData));
+            TEST_CHECK(built.GetIndexFormat() == ((meshData.vertices.size() <= 0xffff) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT));
+
+            MeshAsset loaded;
+            TEST_CHECK(loaded.Load(built.GetBinary().data(), built.GetBinary().size()));
+            TEST_CHECK(loaded.GetBinary() == built.GetBinary());
+            TEST_CHECK(loaded.GetHeader().vertexCount == meshData.vertices.size());
+            TEST_CHECK(loaded.GetHeader().indexCount == meshData.indices.size());
+            TEST_CHECK(loaded.GetMeshletCount() == meshletData.meshlets.size());
+            TEST_CHECK(memcmp(loaded.GetVertexData(), meshData.vertices.data(), loaded.GetVertexDataSize()) == 0);
+            TEST_CHECK(memcmp(loaded.GetMeshletPrimitives(), meshletData.primitives.data(), sizeof(UINT) * meshletData.primitives.size()) == 0);
+        }
+    }
+
+    /// @~english
+    /// @brief Every section of a corrupt header is refused, including counts that wrap around in 32 bits
+    /// @~japanese
+    /// @brief 破損したヘッダの全セクションを拒否する、32bitで桁あふれする数も含む
+    void TestCorruptHeader() {
+        MeshData meshData;
+        MeshletData meshletData;
+        MakeGrid(TEST_GRID_SIZE, &meshData, &meshletData);
+        MeshAsset built;
+        TEST_CHECK(built.Build(meshData, &meshletData));
+        const std::vector<BYTE> &binary = built.GetBinary();
+        const MeshAssetHeader &header = built.GetHeader();
+        const UINT size = static_cast<UINT>(binary.size());
+
+        TEST_CHECK(LoadWithHeaderField(binary, &MeshAssetHeader::magic, header.magic));
+        TEST_CHECK(!LoadWithHeaderField(binary, &MeshAssetHeader::magic, 0));
+        TEST_CHECK(!LoadWithHeaderField(binary, &MeshAssetHeader::version, MESH_ASSET_VERSION + 1));
+        TEST_CHECK(!LoadWithHeaderField(binary, &MeshAssetHeader::vertexStride, 4));
+        TEST_CHECK(!LoadWithHeaderField(binary, &MeshAssetHeader::indexFormat, DXGI_FORMAT_UNKNOWN));
+        TEST_CHECK(!LoadWithHeaderField(binary, &MeshAssetHeader::indexFormat, DXGI_FORMAT_R16_UINT + 1));
+        TEST_CHECK(!LoadWithHeaderField(binary, &MeshAssetHeader::vertexCount, 0));
+        TEST_CHECK(!LoadWithHeaderField(binary, &MeshAssetHeader::indexCount, 0));
+
+        // Offsets past the end, unaligned offsets and counts whose byte size wraps around 32 bits
+        // 末尾を越えるオフセット、整列していないオフセット、バイト数が32bitで桁あふれする数
+        struct Section {
+            UINT MeshAssetHeader::*offset;
+            UINT MeshAssetHeader::*count;
+            UINT                    stride;
+        };
+        const Section sections[] = {
+            { &MeshAssetHeader::vertexDataOffset,       &MeshAssetHeader::vertexCount,           sizeof(MeshVertex) },
+            { &MeshAssetHeader::indexDataOffset,        &MeshAssetHeader::indexCount,            2 },
+            { &MeshAssetHeader::meshletDataOffset,      &MeshAssetHeader::meshletCount,          sizeof(Meshlet) },
+            { &MeshAssetHeader::meshletBoundsOffset,    &MeshAssetHeader::meshletCount,          sizeof(MeshletBounds) },
+            { &MeshAssetHeader::meshletVertexOffset,    &MeshAssetHeader::meshletVertexCount,    sizeof(UINT) },
+            { &MeshAssetHeader::meshletPrimitiveOffset, &MeshAssetHeader::meshletPrimitiveCount, sizeof(UINT) },
+        };
+        for (const auto &section : sections) {
+            TEST_CHECK(!LoadWithHeaderField(binary, section.offset, size));
+            TEST_CHECK(!LoadWithHeaderField(binary, section.offset, size - 4));
+            TEST_CHECK(!LoadWithHeaderField(binary, section.offset, header.*section.offset + 2));
+            TEST_CHECK(!LoadWithHeaderField(binary, section.offset, ~0u - 3));
+            TEST_CHECK(!LoadWithHeaderField(binary, section.count, static_cast<UINT>((1ull << 32) / section.stride + 1)));
+            TEST_CHECK(!LoadWithHeaderField(binary, section.count, ~0u));
+        }
+
+        // Fewer meshlet vertex indices or primitives than the meshlets reference
+        // Meshletが参照するより少ないMeshlet頂点インデックスまたはプリミティブ
+        TEST_CHECK(!LoadWithHeaderField(binary, &MeshAssetHeader::meshletVertexCount, header.meshletVertexCount - 1));
+        TEST_CHECK(!LoadWithHeaderField(binary, &MeshAssetHeader::meshletPrimitiveCount, header.meshletPrimitiveCount - 1));
+
+        // Truncated data
+        // 切り詰めたデータ
+        MeshAsset asset;
+        TEST_CHECK(!asset.Load(nullptr, size));
+        TEST_CHECK(!asset.Load(binary.data(), sizeof(MeshAssetHeader) - 1));
+        TEST_CHECK(!asset.Load(binary.data(), size - 1));
+        TEST_CHECK(!asset.IsValid());
+    }
+
+    /// @~english
+    /// @brief Saved files load back, missing files fail
+    /// @~japanese
+    /// @brief 保存したファイルは読み込み直せ、存在しないファイルは失敗する
+    void TestFile() {
+        MeshData meshData;
+        MeshletData meshletData;
+        MakeGrid(TEST_GRID_SIZE, &meshData, &meshletData);
+        MeshAsset built;
+        TEST_CHECK(built.Build(meshData));
+        TEST_CHECK(built.GetMeshletCount() == 0);
+        TEST_CHECK(built.SaveToFile("MeshAssetTest.mtms"));
+
+        MeshAsset loaded;
+        TEST_CHECK(loaded.LoadFromFile("MeshAssetTest.mtms"));
+        TEST_CHECK(loaded.GetBinary() == built.GetBinary());
+        TEST_CHECK(!loaded.LoadFromFile("MeshAssetTest.missing"));
+        std::remove("MeshAssetTest.mtms");
+    }
+} // namespace ""
+
+int main() {
+    TestRoundTrip();
+    TestCorruptHeader();
+    TestFile();
+    return FinishTest("MeshAssetTest");
+}
@@ -0,0 +1,76 @@
+/// @file MeshOptimizerTest.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include "MeshOptimizer.h"
+
+#include <array>
+
+namespace {
+    const UINT  TEST_GRID_SIZE          = 16;
+    const UINT  TEST_CACHE_SIZE         = 16;
+    const float TEST_OVERDRAW_THRESHOLD = 1.05f;
+
+    /// @~english
+    /// @brief Grid of quads on a bump, so the clusters face different ways
+    /// @~japanese
+    /// @brief 隆起上の四角形の格子、クラスタは異なる向きを向く
+    void MakeGrid(UINT vertexCountPerSide, std::vector<MeshVertex> *dstVertices, std::vector<UINT> *dstIndices) {
+        for (UINT y = 0; y < vertexCountPerSide; ++y) {
+            for (UINT x = 0; x < vertexCountPerSide; ++x) {
+                const float fx = static_cast<float>(x) / static_cast<float>(vertexCountPerSide - 1) - 0.5f;
+                const float fy = static_cast<float>(y) / static_cast<float>(vertexCountPerSide - 1) - 0.5f;
+                dstVertices->push_back({ { fx, fy, 1.0f - fx * fx - fy * fy }, { 1.0f, 1.0f, 1.0f, 1.0f } });
+            }
+        }
+        for (UINT y = 0; y + 1 < vertexCountPerSide; ++y) {
+            for (UINT x = 0; x + 1 < vertexCountPerSide; ++x) {
+                const UINT v = y * vertexCountPerSide + x;
+                dstIndices->insert(dstIndices->end(), { v, v + vertexCountPerSide, v + 1, v + 1, v + vertexCountPerSide, v + vertexCountPerSide + 1 });
+            }
+        }
+    }
+
+    /// @~english
+    /// @brief Get the triangles of an index list sorted, to compare them regardless of their order
+    /// @~japanese
+    /// @brief インデックスリストの三角形をソートして取得、順序によらず比較する為
+    std::vector<std::array<UINT, 3>> GetSortedTriangles(const std::vector<UINT> &indices) {
+        std::vector<std::array<UINT, 3>> triangles(indices.size() / 3);
+        for (size_t t = 0; t < triangles.size(); ++t) {
+            triangles[t] = { indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2] };
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    /// @~english
+    /// @brief Every triangle is written once, also when the first triangle does not miss the cache three times
+    /// @~japanese
+    /// @brief 最初の三角形がキャッシュを3回ミスしない場合も、全ての三角形が1回ずつ書き込まれる
+    void TestOverdrawKeepsTriangles() {
+        std::vector<MeshVertex> vertices;
+        std::vector<UINT> gridIndices;
+        MakeGrid(TEST_GRID_SIZE, &vertices, &gridIndices);
+
+        // Led by nothing, a degenerate triangle and a triangle sharing a vertex
+        // 先頭無し、縮退した三角形、頂点を共有する三角形
+        const std::vector<UINT> leadingTriangles[] = { {}, { 0, 0, 0 }, { 0, 0, 1 } };
+        for (const auto &leadingTriangle : leadingTriangles) {
+            std::vector<UINT> srcIndices = leadingTriangle;
+            srcIndices.insert(srcIndices.end(), gridIndices.begin(), gridIndices.end());
+
+            std::vector<UINT> dstIndices(srcIndices.size(), ~0u);
+            const UINT clusterCount = MeshOptimizer::OptimizeOverdraw(dstIndices.data(), srcIndices.data(), srcIndices.size(), vertices.data(), vertices.size(), TEST_CACHE_SIZE, TEST_OVERDRAW_THRESHOLD);
+            TEST_CHECK(0 < clusterCount);
+            TEST_CHECK(std::find(dstIndices.begin(), dstIndices.end(), ~0u) == dstIndices.end());
+            TEST_CHECK(GetSortedTriangles(dstIndices) == GetSortedTriangles(srcIndices));
+        }
+    }
+} // namespace ""
+
+int main() {
+    TestOverdrawKeepsTriangles();
+    return FinishTest("MeshOptimizerTest");
+}
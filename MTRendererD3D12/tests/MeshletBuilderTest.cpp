@@ -0,0 +1,174 @@
+/// @file MeshletBuilderTest.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include "MeshletBuilder.h"
+
+using namespace DirectX;
+
+namespace {
+    const UINT  TEST_GRID_QUAD_COUNT    = 64;       // Quads per side
+    const float TEST_GRID_SPACING       = 0.1f;
+    const float TEST_CAMERA_DISTANCE    = 10.0f;
+
+    /// @~english
+    /// @brief Flat grid in the XY plane, every triangle faces -Z
+    /// @~japanese
+    /// @brief XY平面上の平らな格子、全三角形は-Zを向く
+    MeshData MakeGrid() {
+        MeshData meshData;
+        const UINT sideVertexCount = TEST_GRID_QUAD_COUNT + 1;
+        for (UINT y = 0; y < sideVertexCount; ++y) {
+            for (UINT x = 0; x < sideVertexCount; ++x) {
+                meshData.vertices.push_back({ { static_cast<float>(x) * TEST_GRID_SPACING, static_cast<float>(y) * TEST_GRID_SPACING, 0.0f }, { 1.0f, 1.0f, 1.0f, 1.0f } });
+            }
+        }
+        for (UINT y = 0; y < TEST_GRID_QUAD_COUNT; ++y) {
+            for (UINT x = 0; x < TEST_GRID_QUAD_COUNT; ++x) {
+                const UINT v = y * sideVertexCount + x;
+                meshData.indices.insert(meshData.indices.end(), { v, v + sideVertexCount, v + 1, v + 1, v + sideVertexCount, v + sideVertexCount + 1 });
+            }
+        }
+        return meshData;
+    }
+
+    /// @~english
+    /// @brief Meshlet data filled with leftovers of an earlier build
+    /// @~japanese
+    /// @brief 以前の構築の残りで埋めたMeshletデータ
+    MeshletData MakeStaleMeshletData() {
+        MeshletData meshletData;
+        meshletData.meshlets.resize(3);
+        meshletData.bounds.resize(3);
+        meshletData.vertexIndices.assign(10, 1);
+        meshletData.primitives.assign(10, 1);
+        return meshletData;
+    }
+
+    bool IsEmpty(const MeshletData &meshletData) {
+        return meshletData.meshlets.empty() && meshletData.bounds.empty() && meshletData.vertexIndices.empty() && meshletData.primitives.empty();
+    }
+
+    /// @~english
+    /// @brief Meshlets keep their limits and reproduce every triangle once in index order, the spheres contain their vertices
+    /// @~japanese
+    /// @brief Meshletは上限を守り全三角形をインデックス順に1回ずつ再現し、球はその頂点を含む
+    void TestBuild() {
+        const MeshData meshData = MakeGrid();
+        const UINT limits[][2] = { { DEFAULT_MESHLET_MAX_VERTICES, DEFAULT_MESHLET_MAX_PRIMITIVES }, { 3, 1 }, { MAX_MESHLET_VERTICES, MAX_MESHLET_PRIMITIVES } };
+        for (const auto &limit : limits) {
+            MeshletData meshletData = MakeStaleMeshletData();
+            MeshletBuildStats stats;
+            TEST_CHECK(MeshletBuilder::Build(meshData, limit[0], limit[1], &meshletData, &stats));
+            TEST_CHECK(stats.meshletCount == meshletData.meshlets.size());
+            TEST_CHECK(stats.triangleCount == meshData.indices.size() / 3);
+            TEST_CHECK(meshletData.bounds.size() == meshletData.meshlets.size());
+
+            std::vector<UINT> indices;
+            UINT mismatchCount = 0;
+            for (size_t m = 0; m < meshletData.meshlets.size(); ++m) {
+                const Meshlet &meshlet = meshletData.meshlets[m];
+                const MeshletBounds &bounds = meshletData.bounds[m];
+                mismatchCount += (meshlet.vertexCount <= limit[0] && 0 < meshlet.primitiveCount && meshlet.primitiveCount <= limit[1]) ? 0 : 1;
+                for (UINT p = 0; p < meshlet.primitiveCount; ++p) {
+                    const UINT packed = meshletData.primitives[meshlet.primitiveOffset + p];
+                    for (UINT k = 0; k < 3; ++k) {
+                        const UINT local = (packed >> (k * 10)) & 0x3ffu;
+                        mismatchCount += (local < meshlet.vertexCount) ? 0 : 1;
+                        indices.push_back(meshletData.vertexIndices[meshlet.vertexOffset + local]);
+                    }
+                }
+                for (UINT v = 0; v < meshlet.vertexCount; ++v) {
+                    const MeshVertex &vertex = meshData.vertices[meshletData.vertexIndices[meshlet.vertexOffset + v]];
+                    const XMVECTOR offset = XMVectorSubtract(XMVectorSet(vertex.pos[0], vertex.pos[1], vertex.pos[2], 0.0f), XMLoadFloat3(&bounds.center));
+                    mismatchCount += (XMVectorGetX(XMVector3Length(offset)) <= bounds.radius * 1.0001f) ? 0 : 1;
+                }
+
+                // The grid is flat, so every cone is a single axis
+                // 格子は平らな為、全てのコーンは単一の軸
+                mismatchCount += (bounds.coneCutoff < 1e-3f && bounds.coneAxis.z < -0.999f) ? 0 : 1;
+            }
+            TEST_CHECK(mismatchCount == 0);
+            TEST_CHECK(indices == meshData.indices);
+        }
+    }
+
+    /// @~english
+    /// @brief Invalid limits and meshes fail and leave the destination empty instead of a partial build
+    /// @~japanese
+    /// @brief 不正な上限とメッシュは失敗し、途中までの構築ではなく空の出力先を残す
+    void TestFailure() {
+        const MeshData meshData = MakeGrid();
+        const UINT badLimits[][2] = { { 2, 1 }, { MAX_MESHLET_VERTICES + 1, 1 }, { 3, 0 }, { 3, MAX_MESHLET_PRIMITIVES + 1 } };
+        for (const auto &limit : badLimits) {
+            MeshletData meshletData = MakeStaleMeshletData();
+            TEST_CHECK(!MeshletBuilder::Build(meshData, limit[0], limit[1], &meshletData, nullptr));
+            TEST_CHECK(IsEmpty(meshletData));
+        }
+
+        // An out of range index in the last triangle, after many meshlets would have been emitted
+        // 多数のMeshletを出力した後となる最後の三角形の範囲外のインデックス
+        MeshData badIndexMesh = meshData;
+        badIndexMesh.indices.back() = static_cast<UINT>(badIndexMesh.vertices.size());
+        MeshletData meshletData = MakeStaleMeshletData();
+        TEST_CHECK(!MeshletBuilder::Build(badIndexMesh, DEFAULT_MESHLET_MAX_VERTICES, DEFAULT_MESHLET_MAX_PRIMITIVES, &meshletData, nullptr));
+        TEST_CHECK(IsEmpty(meshletData));
+
+        MeshData partialTriangleMesh = meshData;
+        partialTriangleMesh.indices.pop_back();
+        meshletData = MakeStaleMeshletData();
+        TEST_CHECK(!MeshletBuilder::Build(partialTriangleMesh, DEFAULT_MESHLET_MAX_VERTICES, DEFAULT_MESHLET_MAX_PRIMITIVES, &meshletData, nullptr));
+        TEST_CHECK(IsEmpty(meshletData));
+
+        TEST_CHECK(!MeshletBuilder::Build(MeshData(), DEFAULT_MESHLET_MAX_VERTICES, DEFAULT_MESHLET_MAX_PRIMITIVES, &meshletData, nullptr));
+        TEST_CHECK(!MeshletBuilder::Build(meshData, DEFAULT_MESHLET_MAX_VERTICES, DEFAULT_MESHLET_MAX_PRIMITIVES, nullptr, nullptr));
+    }
+
+    /// @~english
+    /// @brief Cull the grid seen from a camera
+    /// @~japanese
+    /// @brief カメラから見た格子をカリング
+    UINT CullFrom(const MeshletData &meshletData, FXMMATRIX worldMtx, FXMVECTOR cameraPos, FXMVECTOR cameraDir, MeshletCullStats *stats) {
+        const XMMATRIX viewMtx = XMMatrixLookToLH(cameraPos, cameraDir, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+        const XMMATRIX projMtx = XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.0f, 0.1f, 100.0f);
+        ViewFrustum frustum;
+        frustum.SetFromMatrix(XMMatrixMultiply(viewMtx, projMtx));
+
+        std::vector<UINT> visible(meshletData.meshlets.size());
+        return MeshletCuller::Cull(meshletData.bounds.data(), static_cast<UINT>(meshletData.bounds.size()), worldMtx, frustum, cameraPos, visible.data(), stats);
+    }
+
+    /// @~english
+    /// @brief The grid is visible from its front, backface culled from behind and frustum culled when looked away from
+    /// @~japanese
+    /// @brief 格子は正面からは可視、背後からは裏面カリングされ、視線を外すと視錐台カリングされる
+    void TestCull() {
+        MeshletData meshletData;
+        TEST_CHECK(MeshletBuilder::Build(MakeGrid(), DEFAULT_MESHLET_MAX_VERTICES, DEFAULT_MESHLET_MAX_PRIMITIVES, &meshletData, nullptr));
+        const UINT meshletCount = static_cast<UINT>(meshletData.meshlets.size());
+        const float center = TEST_GRID_QUAD_COUNT * TEST_GRID_SPACING * 0.5f;
+
+        MeshletCullStats stats;
+        TEST_CHECK(CullFrom(meshletData, XMMatrixIdentity(), XMVectorSet(center, center, -TEST_CAMERA_DISTANCE, 1.0f), XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), &stats) == meshletCount);
+        TEST_CHECK(CullFrom(meshletData, XMMatrixIdentity(), XMVectorSet(center, center, TEST_CAMERA_DISTANCE, 1.0f), XMVectorSet(0.0f, 0.0f, -1.0f, 0.0f), &stats) == 0);
+        TEST_CHECK(CullFrom(meshletData, XMMatrixIdentity(), XMVectorSet(center, center, -TEST_CAMERA_DISTANCE, 1.0f), XMVectorSet(0.0f, 0.0f, -1.0f, 0.0f), &stats) == 0);
+        TEST_CHECK(stats.testedCount == meshletCount * 3);
+        TEST_CHECK(stats.visibleCount == meshletCount);
+        TEST_CHECK(stats.backfaceCulledCount == meshletCount);
+        TEST_CHECK(stats.frustumCulledCount == meshletCount);
+
+        // A world matrix turning the grid around Y makes the far side face the camera
+        // 格子をY軸周りに回転するWorld変換行列は裏側をカメラに向ける
+        const XMMATRIX turnMtx = XMMatrixMultiply(XMMatrixRotationRollPitchYaw(0.0f, XM_PI, 0.0f), XMMatrixTranslation(center * 2.0f, 0.0f, 0.0f));
+        TEST_CHECK(CullFrom(meshletData, turnMtx, XMVectorSet(center, center, TEST_CAMERA_DISTANCE, 1.0f), XMVectorSet(0.0f, 0.0f, -1.0f, 0.0f), nullptr) == meshletCount);
+        TEST_CHECK(CullFrom(meshletData, turnMtx, XMVectorSet(center, center, -TEST_CAMERA_DISTANCE, 1.0f), XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), nullptr) == 0);
+    }
+} // namespace ""
+
+int main() {
+    TestBuild();
+    TestFailure();
+    TestCull();
+    return FinishTest("MeshletBuilderTest");
+}
@@ -0,0 +1,252 @@
+/// @file OcclusionCullerTest.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include "OcclusionCuller.h"
+#include "JobSystem.h"
+
+using namespace DirectX;
+
+namespace {
+    const UINT  TEST_WORKER_COUNT   = 3;
+    const float TEST_QUAD_DEPTH     = 5.0f;
+    const float TEST_NEAR_Z         = 0.01f;
+    const float TEST_FAR_Z          = 1000.0f;
+
+    /// @~english
+    /// @brief Square of 4x4 units in the XY plane, made of two triangles sharing a diagonal
+    /// @~japanese
+    /// @brief XY平面上の4x4単位の正方形、対角線を共有する2つの三角形からなる
+    bool BuildQuad(MeshAsset *dstMesh, float halfSize) {
+        MeshData meshData;
+        meshData.vertices = {
+            { { -halfSize, -halfSize, 0.0f }, { 1.0f, 1.0f, 1.0f, 1.0f } },
+            { {  halfSize, -halfSize, 0.0f }, { 1.0f, 1.0f, 1.0f, 1.0f } },
+            { {  halfSize,  halfSize, 0.0f }, { 1.0f, 1.0f, 1.0f, 1.0f } },
+            { { -halfSize,  halfSize, 0.0f }, { 1.0f, 1.0f, 1.0f, 1.0f } },
+        };
+        meshData.indices = { 0, 1, 2, 0, 2, 3 };
+        return dstMesh->Build(meshData);
+    }
+
+    /// @~english
+    /// @brief Camera at the origin looking down +Z
+    /// @~japanese
+    /// @brief 原点から+Z方向を向くカメラ
+    XMMATRIX GetViewProjMtx() {
+        const XMMATRIX viewMtx = XMMatrixLookToLH(XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+        const XMMATRIX projMtx = XMMatrixPerspectiveFovLH(XM_PIDIV2, 16.0f / 9.0f, TEST_NEAR_Z, TEST_FAR_Z);
+        return XMMatrixMultiply(viewMtx, projMtx);
+    }
+
+    /// @~english
+    /// @brief Post-projection depth of a point on the view axis
+    /// @~japanese
+    /// @brief 視線軸上の点の射影後の深度
+    float GetProjectedDepth(float viewZ) {
+        return TEST_FAR_Z / (TEST_FAR_Z - TEST_NEAR_Z) * (1.0f - TEST_NEAR_Z / viewZ);
+    }
+
+    /// @~english
+    /// @brief A screen filling occluder covers every tile at its depth, the two triangles merge in the tiles on the diagonal
+    /// @~japanese
+    /// @brief 画面を埋める遮蔽物は全タイルをその深度で覆い、対角線上のタイルでは2つの三角形が統合される
+    void TestRasterizeFullScreen(JobSystem *jobSystem) {
+        MeshAsset quad;
+        TEST_CHECK(BuildQuad(&quad, 100.0f));
+
+        OcclusionCuller culler;
+        TEST_CHECK(culler.Init(DEFAULT_OCCLUSION_BUFFER_WIDTH, DEFAULT_OCCLUSION_BUFFER_HEIGHT));
+        culler.Begin(GetViewProjMtx());
+        culler.AddOccluder(quad, XMMatrixTranslation(0.0f, 0.0f, TEST_QUAD_DEPTH));
+        culler.Rasterize(jobSystem);
+
+        const OcclusionCullStats &stats = culler.GetStats();
+        TEST_CHECK(stats.occluderCount == 1 && stats.triangleCount == 2);
+
+        UINT uncoveredCount = 0;
+        for (UINT tileY = 0; tileY < culler.GetTileCountY(); ++tileY) {
+            for (UINT tileX = 0; tileX < culler.GetTileCountX(); ++tileX) {
+                uncoveredCount += (std::fabs(culler.GetTileDepth(tileX, tileY) - GetProjectedDepth(TEST_QUAD_DEPTH)) < 1e-4f) ? 0 : 1;
+            }
+        }
+        TEST_CHECK(uncoveredCount == 0);
+    }
+
+    /// @~english
+    /// @brief A smaller occluder covers the tiles inside it, partly covered tiles keep the far plane
+    /// @~japanese
+    /// @brief 小さな遮蔽物はその内側のタイルを覆い、部分的に覆われたタイルはファー平面を保つ
+    void TestRasterizePartial(JobSystem *jobSystem) {
+        MeshAsset quad;
+        TEST_CHECK(BuildQuad(&quad, 2.0f));
+
+        OcclusionCuller serial;
+        OcclusionCuller parallel;
+        for (OcclusionCuller *culler : { &serial, &parallel }) {
+            TEST_CHECK(culler->Init(DEFAULT_OCCLUSION_BUFFER_WIDTH, DEFAULT_OCCLUSION_BUFFER_HEIGHT));
+            culler->Begin(GetViewProjMtx());
+            culler->AddOccluder(quad, XMMatrixTranslation(0.0f, 0.0f, TEST_QUAD_DEPTH));
+        }
+        serial.Rasterize(nullptr);
+        parallel.Rasterize(jobSystem);
+
+        // The quad spans the middle 9/40 of the width and 2/5 of the height
+        // 正方形は幅の中央9/40、高さの中央2/5に渡る
+        const UINT tileCountX = serial.GetTileCountX();
+        const UINT tileCountY = serial.GetTileCountY();
+        TEST_CHECK(serial.GetTileDepth(tileCountX / 2, tileCountY / 2) < 1.0f);
+        TEST_CHECK(serial.GetTileDepth(0, 0) == 1.0f);
+        TEST_CHECK(serial.GetTileDepth(tileCountX - 1, tileCountY / 2) == 1.0f);
+
+        UINT coveredCount  = 0;
+        UINT mismatchCount = 0;
+        for (UINT tileY = 0; tileY < tileCountY; ++tileY) {
+            for (UINT tileX = 0; tileX < tileCountX; ++tileX) {
+                coveredCount  += (serial.GetTileDepth(tileX, tileY) < 1.0f) ? 1 : 0;
+                mismatchCount += (serial.GetTileDepth(tileX, tileY) != parallel.GetTileDepth(tileX, tileY)) ? 1 : 0;
+            }
+        }
+        const float coveredRatio = static_cast<float>(coveredCount) / static_cast<float>(tileCountX * tileCountY);
+        TEST_CHECK(0.05f < coveredRatio && coveredRatio < 9.0f / 40.0f * 2.0f / 5.0f);
+        TEST_CHECK(mismatchCount == 0);
+    }
+
+    /// @~english
+    /// @brief Triangles crossing the near plane or beyond the far plane are dropped
+    /// @~japanese
+    /// @brief ニア平面と交差する、もしくはファー平面より奥の三角形は除外する
+    void TestRasterizeClipped() {
+        MeshAsset quad;
+        TEST_CHECK(BuildQuad(&quad, 100.0f));
+
+        OcclusionCuller culler;
+        TEST_CHECK(culler.Init(DEFAULT_OCCLUSION_BUFFER_WIDTH, DEFAULT_OCCLUSION_BUFFER_HEIGHT));
+        culler.Begin(GetViewProjMtx());
+        culler.AddOccluder(quad, XMMatrixRotationRollPitchYaw(XM_PIDIV2, 0.0f, 0.0f));
+        culler.AddOccluder(quad, XMMatrixTranslation(0.0f, 0.0f, TEST_FAR_Z * 2.0f));
+        culler.Rasterize(nullptr);
+        TEST_CHECK(culler.GetStats().occluderCount == 2);
+        TEST_CHECK(culler.GetStats().triangleCount == 0);
+        TEST_CHECK(culler.GetTileDepth(culler.GetTileCountX() / 2, culler.GetTileCountY() / 2) == 1.0f);
+    }
+
+    /// @~english
+    /// @brief Each level of the hierarchical depth buffer holds the farthest depth of the texels below it
+    /// @~japanese
+    /// @brief 階層深度バッファの各レベルは下のテクセルの最も奥の深度を持つ
+    void TestHiZ(JobSystem *jobSystem) {
+        MeshAsset quad;
+        TEST_CHECK(BuildQuad(&quad, 2.0f));
+
+        OcclusionCuller culler;
+        TEST_CHECK(culler.Init(DEFAULT_OCCLUSION_BUFFER_WIDTH, DEFAULT_OCCLUSION_BUFFER_HEIGHT));
+        culler.Begin(GetViewProjMtx());
+        for (UINT i = 0; i < 9; ++i) {
+            culler.AddOccluder(quad, XMMatrixTranslation(static_cast<float>(i % 3) * 3.0f - 3.0f, static_cast<float>(i / 3) * 2.0f - 2.0f, TEST_QUAD_DEPTH + static_cast<float>(i)));
+        }
+        culler.Rasterize(jobSystem);
+
+        const UINT levelCount = culler.GetHiZLevelCount();
+        TEST_CHECK(1 < levelCount);
+        UINT mismatchCount = 0;
+        for (UINT tileY = 0; tileY < culler.GetTileCountY(); ++tileY) {
+            for (UINT tileX = 0; tileX < culler.GetTileCountX(); ++tileX) {
+                mismatchCount += (culler.GetHiZDepth(0, tileX, tileY) != culler.GetTileDepth(tileX, tileY)) ? 1 : 0;
+
+                // Every level above a tile is at least as far
+                // タイルの上の全レベルは少なくとも同じだけ奥
+                for (UINT level = 1; level < levelCount; ++level) {
+                    mismatchCount += (culler.GetHiZDepth(level, tileX >> level, tileY >> level) < culler.GetTileDepth(tileX, tileY)) ? 1 : 0;
+                }
+            }
+        }
+        TEST_CHECK(mismatchCount == 0);
+        TEST_CHECK(culler.GetHiZDepth(levelCount - 1, 0, 0) == 1.0f);
+    }
+
+    /// @~english
+    /// @brief Spheres behind, in front of, beside and around the occluder
+    /// @~japanese
+    /// @brief 遮蔽物の奥、手前、横、周囲の球
+    void TestSpheres(JobSystem *jobSystem) {
+        MeshAsset quad;
+        TEST_CHECK(BuildQuad(&quad, 2.0f));
+
+        OcclusionCuller culler;
+        TEST_CHECK(culler.Init(DEFAULT_OCCLUSION_BUFFER_WIDTH, DEFAULT_OCCLUSION_BUFFER_HEIGHT));
+        culler.Begin(GetViewProjMtx());
+        culler.AddOccluder(quad, XMMatrixTranslation(0.0f, 0.0f, TEST_QUAD_DEPTH));
+        culler.Rasterize(jobSystem);
+
+        struct SphereCase {
+            float   center[3];
+            float   radius;
+            bool    visible;
+        };
+        const SphereCase sphereCases[] = {
+            { {   0.0f, 0.0f,  10.0f }, 0.5f, false },  // Behind the middle
+            { {   0.0f, 0.0f,   2.0f }, 0.5f, true  },  // In front
+            { {   1.5f, 1.5f,  10.0f }, 0.2f, false },  // Behind a corner
+            { {   6.0f, 0.0f,  10.0f }, 0.5f, true  },  // Behind the plane but beside the occluder
+            { {   0.0f, 0.0f,   5.2f }, 3.0f, true  },  // Larger than the occluder
+            { {   0.0f, 0.0f,  -5.0f }, 0.5f, false },  // Behind the camera
+            { {   0.0f, 0.0f,   0.0f }, 0.5f, true  },  // Around the camera
+            { { 100.0f, 0.0f,  10.0f }, 0.5f, false },  // Outside the screen
+            { {   0.0f, 0.0f, 2000.0f }, 0.5f, false }, // Beyond the far plane
+        };
+        for (const auto &sphereCase : sphereCases) {
+            const XMVECTOR center = XMVectorSet(sphereCase.center[0], sphereCase.center[1], sphereCase.center[2], 1.0f);
+            TEST_CHECK(culler.TestSphere(center, sphereCase.radius) == sphereCase.visible);
+        }
+
+        // Without occluders only the screen and the far plane cull
+        // 遮蔽物が無い場合は画面とファー平面のみがカリングする
+        culler.Begin(GetViewProjMtx());
+        culler.Rasterize(jobSystem);
+        TEST_CHECK(culler.TestSphere(XMVectorSet(0.0f, 0.0f, 10.0f, 1.0f), 0.5f));
+        TEST_CHECK(!culler.TestSphere(XMVectorSet(100.0f, 0.0f, 10.0f, 1.0f), 0.5f));
+    }
+
+    /// @~english
+    /// @brief A wall of occluders hides a grid of spheres behind it, a coarse level decides the large ones
+    /// @~japanese
+    /// @brief 遮蔽物の壁はその奥の球の格子を隠し、大きな球は粗いレベルで判断する
+    void TestWall(JobSystem *jobSystem) {
+        MeshAsset quad;
+        TEST_CHECK(BuildQuad(&quad, 100.0f));
+
+        OcclusionCuller culler;
+        TEST_CHECK(culler.Init(DEFAULT_OCCLUSION_BUFFER_WIDTH, DEFAULT_OCCLUSION_BUFFER_HEIGHT));
+        culler.Begin(GetViewProjMtx());
+        culler.AddOccluder(quad, XMMatrixTranslation(0.0f, 0.0f, TEST_QUAD_DEPTH));
+        culler.Rasterize(jobSystem);
+
+        UINT visibleCount = 0;
+        for (UINT i = 0; i < 400; ++i) {
+            const XMVECTOR center = XMVectorSet(static_cast<float>(i % 20) - 10.0f, static_cast<float>(i / 20) * 0.5f - 5.0f, 20.0f, 1.0f);
+            visibleCount += culler.TestSphere(center, 0.3f + static_cast<float>(i % 7)) ? 1 : 0;
+        }
+        TEST_CHECK(visibleCount == 0);
+        TEST_CHECK(culler.TestSphere(XMVectorSet(0.0f, 0.0f, 20.0f, 1.0f), 16.0f));
+    }
+} // namespace ""
+
+int main() {
+    JobSystem jobSystem;
+    if (!jobSystem.Init(TEST_WORKER_COUNT)) {
+        OutputDebugStringA("JobSystem: could not initialize\n");
+        return -1;
+    }
+
+    TestRasterizeFullScreen(&jobSystem);
+    TestRasterizePartial(&jobSystem);
+    TestRasterizeClipped();
+    TestHiZ(&jobSystem);
+    TestSpheres(&jobSystem);
+    TestWall(&jobSystem);
+
+    jobSystem.Deinit();
+    return FinishTest("OcclusionCullerTest");
+}
@@ -0,0 +1,159 @@
+/// @file RenderQueueTest.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include "JobSystem.h"
+#include "RenderQueue.h"
+#include "ScratchArena.h"
+
+#include <random>
+
+namespace {
+    const UINT   TEST_SHORT_ITEM_COUNT  = 100;
+    const UINT   TEST_LONG_ITEM_COUNT   = 3 * DEFAULT_RADIX_SORT_GRAIN + 123;
+    const UINT   TEST_WORKER_COUNT      = 3;
+    const UINT   TEST_BATCH_COUNT       = 64;
+    const UINT   TEST_BATCH_VALUE_COUNT = 1024;
+    const size_t TEST_ARENA_SIZE        = 64 * 1024;   // Smaller than a long queue, so the arena has to grow
+    const UINT   TEST_SEED              = 11;
+
+    /// @~english
+    /// @brief Fill a queue with random keys sharing few states, the instance index is the push order
+    /// @~japanese
+    /// @brief 少数のステートを共有するランダムなキューで埋める、インスタンス番号は追加順
+    void FillQueue(UINT count, std::mt19937 *rng, RenderQueue *dstQueue) {
+        dstQueue->Clear();
+        dstQueue->Reserve(count);
+        RenderItem *items = dstQueue->Append(count);
+        for (UINT i = 0; i < count; ++i) {
+            const RenderPass pass = ((*rng)() % 4 == 0) ? RenderPass::Transparent : RenderPass::Opaque;
+            items[i].sortKey       = RenderQueue::MakeSortKey(pass, (*rng)() % 3, (*rng)() % 5, (*rng)() % 40, (*rng)() % 3, (*rng)() % 64);
+            items[i].instanceIndex = i;
+            items[i].reserved      = 0;
+        }
+    }
+
+    /// @~english
+    /// @brief The queue is in key order and equal keys keep their push order
+    /// @~japanese
+    /// @brief キューがキー順であり、等しいキーは追加順を保っている
+    bool IsStableSorted(const RenderQueue &queue) {
+        const RenderItem *items = queue.GetItems();
+        for (UINT i = 1; i < queue.GetItemCount(); ++i) {
+            if (items[i].sortKey < items[i - 1].sortKey || (items[i].sortKey == items[i - 1].sortKey && items[i].instanceIndex < items[i - 1].instanceIndex)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// @~english
+    /// @brief Sorting from an arena gives the order of sorting from the heap, with and without workers
+    /// @~japanese
+    /// @brief アリーナから確保したソートはヒープから確保したソートと同じ順序になる、ワーカーの有無によらない
+    void TestSort() {
+        JobSystem jobSystem;
+        TEST_CHECK(jobSystem.Init(TEST_WORKER_COUNT));
+        ScratchArena arena;
+        TEST_CHECK(arena.Init(TEST_ARENA_SIZE));
+
+        for (UINT count : { TEST_SHORT_ITEM_COUNT, TEST_LONG_ITEM_COUNT }) {
+            for (JobSystem *sortJobSystem : { static_cast<JobSystem *>(nullptr), &jobSystem }) {
+                std::mt19937 heapRng(TEST_SEED);
+                RenderQueue heapQueue;
+                FillQueue(count, &heapRng, &heapQueue);
+                heapQueue.Sort(sortJobSystem);
+
+                // Two frames, the second one runs after the arena grew to the peak of the first one
+                // 2フレーム、2フレーム目はアリーナが1フレーム目のピークまで拡張された後に実行する
+                for (UINT frame = 0; frame < 2; ++frame) {
+                    arena.Reset();
+                    std::mt19937 arenaRng(TEST_SEED);
+                    RenderQueue arenaQueue;
+                    arenaQueue.SetArena(&arena);
+                    FillQueue(count, &arenaRng, &arenaQueue);
+                    arenaQueue.Sort(sortJobSystem);
+
+                    TEST_CHECK(IsStableSorted(arenaQueue));
+                    TEST_CHECK(arenaQueue.GetItemCount() == heapQueue.GetItemCount());
+                    TEST_CHECK(memcmp(arenaQueue.GetItems(), heapQueue.GetItems(), sizeof(RenderItem) * count) == 0);
+                    TEST_CHECK(sizeof(RenderItem) * count <= arena.GetUsedSize());
+                    TEST_CHECK(frame == 0 || arena.GetUsedSize() <= arena.GetCapacity());
+                }
+            }
+        }
+
+        // Rebinding drops the items, so nothing refers to the reset arena
+        // 再設定で要素は破棄される為、リセットしたアリーナを参照するものは無い
+        RenderQueue queue;
+        queue.SetArena(&arena);
+        queue.Push(1, 0);
+        arena.Reset();
+        queue.SetArena(&arena);
+        TEST_CHECK(queue.GetItemCount() == 0);
+        queue.SetArena(nullptr);
+        queue.Push(1, 0);
+        TEST_CHECK(queue.GetItemCount() == 1);
+
+        jobSystem.Deinit();
+    }
+
+    /// @~english
+    /// @brief Every batch has a thread arena, the worker arenas are reset once the loop is done
+    /// @~japanese
+    /// @brief 全バッチにスレッドのアリーナがあり、ループの完了後にはワーカーのアリーナはリセットされている
+    void TestWorkerArenas() {
+        JobSystem jobSystem;
+        TEST_CHECK(jobSystem.Init(TEST_WORKER_COUNT));
+        ScratchArena callerArena;
+        TEST_CHECK(callerArena.Init(TEST_ARENA_SIZE));
+        ScratchArena::SetThreadArena(&callerArena);
+
+        std::atomic<UINT> missingArenaCount(0);
+        std::atomic<UINT> corruptCount(0);
+        std::atomic<UINT> workerBatchCount(0);
+        jobSystem.ParallelFor(TEST_BATCH_COUNT, 1, [&](UINT begin, UINT end) {
+            ScratchArena *arena = ScratchArena::GetThreadArena();
+            if (arena == nullptr) {
+                missingArenaCount++;
+                return;
+            }
+            if (arena != &callerArena) {
+                workerBatchCount++;
+            }
+
+            // Long enough batches for the workers to take some even on a single core
+            // 単一コアでもワーカーが取得できる程度に長いバッチ
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+            // The values of the batch survive a nested loop on the same thread
+            // バッチの値は同じスレッドでのネストしたループの後も残る
+            ScratchVector<UINT> values(TEST_BATCH_VALUE_COUNT, begin);
+            jobSystem.ParallelFor(2, 1, [&](UINT, UINT) {
+                ScratchVector<UINT> nestedValues(TEST_BATCH_VALUE_COUNT, ~0u);
+                missingArenaCount += (nestedValues.get_allocator().GetArena() != nullptr) ? 0 : 1;
+            });
+            corruptCount += static_cast<UINT>(std::count_if(values.begin(), values.end(), [begin](UINT value) { return value != begin; }));
+        });
+
+        TEST_CHECK(missingArenaCount.load() == 0);
+        TEST_CHECK(corruptCount.load() == 0);
+        size_t workerPeakSize = 0;
+        for (UINT i = 0; i < jobSystem.GetWorkerCount(); ++i) {
+            TEST_CHECK(jobSystem.GetWorkerArena(i).GetUsedSize() == 0);
+            workerPeakSize = std::max(workerPeakSize, jobSystem.GetWorkerArena(i).GetPeakSize());
+        }
+        TEST_CHECK(0 < workerBatchCount.load());
+        TEST_CHECK(sizeof(UINT) * TEST_BATCH_VALUE_COUNT <= workerPeakSize);
+
+        ScratchArena::SetThreadArena(nullptr);
+        jobSystem.Deinit();
+    }
+} // namespace ""
+
+int main() {
+    TestSort();
+    TestWorkerArenas();
+    return FinishTest("RenderQueueTest");
+}
@@ -0,0 +1,158 @@
+/// @file SceneSnapshotTest.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include "Scene.h"
+
+#include <deque>
+
+using namespace DirectX;
+
+namespace {
+    const UINT  TEST_TRIANGLE_COUNT     = 24;
+    const UINT  TEST_CAMERA_COUNT       = 4;
+    const char *TEST_SNAPSHOT_PATH      = "SceneSnapshotTest.mtss";
+
+    /// @~english
+    /// @brief Save a scene whose hierarchy mixes both types, load it into another one and compare them
+    /// @~japanese
+    /// @brief 両方の種別が混ざる階層のシーンを保存し、別のシーンへ読み込んで比較する
+    void TestRoundTrip() {
+        std::deque<TriangleSceneActor> triangles(TEST_TRIANGLE_COUNT);
+        std::deque<CameraSceneActor> cameras(TEST_CAMERA_COUNT);
+        std::vector<SceneActor *> actors;
+
+        Scene scene;
+        for (auto &camera : cameras) {
+            camera.Init(640, 480, 60.0f);
+            scene.AddActor(&camera);
+            actors.push_back(&camera);
+        }
+        for (auto &triangle : triangles) {
+            scene.AddActor(&triangle);
+            actors.push_back(&triangle);
+        }
+
+        // The actors sleep so the transforms only come from the snapshot, the parents are attached from the last
+        // actor backwards, so the order of the hierarchy differs from the order of the types
+        // アクタは休止しトランスフォームはスナップショットからのみ得る、親は最後のアクタから逆順に接続する為、
+        // 階層の順序は種別の順序と異なる
+        for (size_t i = 0; i < actors.size(); ++i) {
+            const float value = static_cast<float>(i);
+            actors[i]->translation = XMVectorSet(value, value * 0.5f, -value, 1.0f);
+            actors[i]->rotation    = XMVectorSet(0.0f, value * 10.0f, 0.0f, 0.0f);
+            actors[i]->Sleep();
+        }
+        for (size_t i = actors.size() - 1; 0 < i; --i) {
+            TEST_CHECK(scene.AttachActor(actors[i], actors[(i - 1) / 3]));
+        }
+        scene.Update(0.0f, nullptr);
+        TEST_CHECK(scene.SaveSnapshot(TEST_SNAPSHOT_PATH));
+
+        Scene loadedScene;
+        TEST_CHECK(loadedScene.LoadSnapshot(TEST_SNAPSHOT_PATH));
+        loadedScene.Update(0.0f, nullptr);
+
+        const TransformHierarchy &hierarchy       = scene.GetTransformHierarchy();
+        const TransformHierarchy &loadedHierarchy = loadedScene.GetTransformHierarchy();
+        TEST_CHECK(loadedScene.GetActorCount() == actors.size());
+        TEST_CHECK(loadedHierarchy.GetNodeCount() == hierarchy.GetNodeCount());
+        TEST_CHECK(std::equal(hierarchy.GetParentIndices(), hierarchy.GetParentIndices() + hierarchy.GetNodeCount(), loadedHierarchy.GetParentIndices()));
+        TEST_CHECK(loadedHierarchy.ComputeChecksum() == hierarchy.ComputeChecksum());
+    }
+
+    /// @~english
+    /// @brief Arrays out of parent-before-child order are rejected without creating any node
+    /// @~japanese
+    /// @brief 親が子より前に並ぶ順でない配列は、ノードを生成せずに拒否される
+    void TestCreateNodes() {
+        const UINT INVALID = INVALID_TRANSFORM_NODE;
+        TransformHierarchy hierarchy;
+        UINT handles[5];
+
+        // 0 -> (1 -> 2), 3, then the root 4
+        // 0 -> (1 -> 2)、3、その後にルートの4
+        const UINT parents[5] = { INVALID, 0, 1, 0, INVALID };
+        const UINT sizes[5]   = { 4, 2, 1, 1, 1 };
+        TEST_CHECK(hierarchy.CreateNodes(5, parents, sizes, handles));
+        TEST_CHECK(hierarchy.GetNodeCount() == 5);
+        TEST_CHECK(hierarchy.GetParent(handles[2]) == handles[1]);
+        TEST_CHECK(hierarchy.GetParent(handles[3]) == handles[0]);
+        TEST_CHECK(hierarchy.GetParent(handles[4]) == INVALID);
+
+        // Appended after the existing nodes, the parents are relative to the arrays
+        // 既存のノードの後に追加され、親は配列に対する位置
+        TEST_CHECK(hierarchy.CreateNodes(2, parents, sizes + 1, handles));
+        TEST_CHECK(hierarchy.GetNodeCount() == 7);
+        TEST_CHECK(hierarchy.GetParent(handles[1]) == handles[0]);
+
+        const UINT parentAfter[3]     = { 1, INVALID, INVALID };
+        const UINT parentAfterSize[3] = { 1, 1, 1 };
+        TEST_CHECK(!hierarchy.CreateNodes(3, parentAfter, parentAfterSize, handles));
+
+        const UINT tooLargeSize[3] = { 4, 1, 1 };
+        const UINT rootParents[3]  = { INVALID, 0, 0 };
+        TEST_CHECK(!hierarchy.CreateNodes(3, rootParents, tooLargeSize, handles));
+
+        // The subtree of 0 ends before its second child
+        // 0のサブツリーが2番目の子より前に終わる
+        const UINT shortSize[3] = { 2, 1, 1 };
+        TEST_CHECK(!hierarchy.CreateNodes(3, rootParents, shortSize, handles));
+
+        // 2 lies in the subtree of 1 but names 0 as its parent
+        // 2は1のサブツリー内にあるが0を親とする
+        const UINT skippedSize[3] = { 3, 2, 1 };
+        TEST_CHECK(!hierarchy.CreateNodes(3, rootParents, skippedSize, handles));
+        TEST_CHECK(hierarchy.GetNodeCount() == 7);
+    }
+
+    /// @~english
+    /// @brief A snapshot whose parent comes after its child is not loaded
+    /// @~japanese
+    /// @brief 親が子の後にあるスナップショットは読み込まれない
+    void TestInvalidSnapshot() {
+        const UINT count = 2;
+        const XMFLOAT4 translations[count] = {};
+        const XMFLOAT4 scales[count] = { XMFLOAT4(1.0f, 1.0f, 1.0f, 0.0f), XMFLOAT4(1.0f, 1.0f, 1.0f, 0.0f) };
+        const SceneSnapshotTick ticks[count] = {};
+        const SceneSnapshotMotion motions[count] = {};
+        const UINT nodes[count]        = { 0, 1 };
+        const UINT nodeParents[count]  = { 1, INVALID_SCENE_SNAPSHOT_INDEX };
+        const UINT subtreeSizes[count] = { 1, 2 };
+
+        SceneSnapshotWriter writer;
+        writer.SetActorCount(SceneSnapshotActorType::Triangle, count);
+        writer.SetArray(SceneSnapshotActorType::Triangle, SceneSnapshotField::Translation, translations);
+        writer.SetArray(SceneSnapshotActorType::Triangle, SceneSnapshotField::Rotation, translations);
+        writer.SetArray(SceneSnapshotActorType::Triangle, SceneSnapshotField::Scale, scales);
+        writer.SetArray(SceneSnapshotActorType::Triangle, SceneSnapshotField::Node, nodes);
+        writer.SetArray(SceneSnapshotActorType::Triangle, SceneSnapshotField::Tick, ticks);
+        writer.SetArray(SceneSnapshotActorType::Triangle, SceneSnapshotField::Params, motions);
+        writer.SetHierarchy(nodeParents, subtreeSizes);
+        TEST_CHECK(writer.SaveToFile(TEST_SNAPSHOT_PATH));
+
+        Scene scene;
+        TEST_CHECK(!scene.LoadSnapshot(TEST_SNAPSHOT_PATH));
+        TEST_CHECK(scene.GetActorCount() == 0);
+        TEST_CHECK(scene.GetTransformHierarchy().GetNodeCount() == 0);
+
+        // Two actors sharing a node
+        // ノードを共有する2つのアクタ
+        const UINT sharedNodes[count]  = { 0, 0 };
+        const UINT rootParents[count]  = { INVALID_SCENE_SNAPSHOT_INDEX, INVALID_SCENE_SNAPSHOT_INDEX };
+        const UINT rootSizes[count]    = { 1, 1 };
+        writer.SetArray(SceneSnapshotActorType::Triangle, SceneSnapshotField::Node, sharedNodes);
+        writer.SetHierarchy(rootParents, rootSizes);
+        TEST_CHECK(writer.SaveToFile(TEST_SNAPSHOT_PATH));
+        TEST_CHECK(!scene.LoadSnapshot(TEST_SNAPSHOT_PATH));
+        TEST_CHECK(scene.GetActorCount() == 0);
+    }
+} // namespace ""
+
+int main() {
+    TestRoundTrip();
+    TestCreateNodes();
+    TestInvalidSnapshot();
+    return FinishTest("SceneSnapshotTest");
+}
@@ -0,0 +1,48 @@
+/// @file TestCheck.h
+/// @author Masayoshi Kamai
+
+#pragma once
+
+/// @~english
+/// @brief Checks of the module tests, each test is one executable returning the number of failed checks
+/// @~japanese
+/// @brief モジュールテストの検証、各テストは失敗した検証の数を返す1つの実行ファイル
+
+/// @~english
+/// @brief Get the number of failed checks of the executable
+/// @~japanese
+/// @brief 実行ファイルの失敗した検証の数を取得
+inline UINT& GetTestFailureCount() {
+    static UINT failureCount = 0;
+    return failureCount;
+}
+
+/// @~english
+/// @brief Report a failed check with its location
+/// @~japanese
+/// @brief 失敗した検証をその位置と共に出力
+inline void ReportTestFailure(const char *expression, const char *file, int line) {
+    char reportStr[512];
+    snprintf(reportStr, sizeof(reportStr), "%s(%d): check failed: %s\n", file, line, expression);
+    OutputDebugStringA(reportStr);
+    GetTestFailureCount()++;
+}
+
+#define TEST_CHECK(expression) \
+    do { if (!(expression)) { ReportTestFailure(#expression, __FILE__, __LINE__); } } while (false)
+
+#define TEST_CHECK_NEAR(a, b, tolerance) \
+    do { if (!(std::fabs(static_cast<double>(a) - static_cast<double>(b)) <= static_cast<double>(tolerance))) { ReportTestFailure(#a " ~= " #b, __FILE__, __LINE__); } } while (false)
+
+/// @~english
+/// @brief Report the result of the executable
+/// @return Exit code, 0 if every check passed
+/// @~japanese
+/// @brief 実行ファイルの結果を出力
+/// @return 終了コード、全ての検証に成功した場合は0
+inline int FinishTest(const char *name) {
+    char reportStr[256];
+    snprintf(reportStr, sizeof(reportStr), "%s: %s (%u failed)\n", name, (GetTestFailureCount() == 0) ? "passed" : "FAILED", GetTestFailureCount());
+    OutputDebugStringA(reportStr);
+    return static_cast<int>(std::min(GetTestFailureCount(), 255u));
+}
@@ -0,0 +1,81 @@
+/// @file ThreadTopologyTest.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include "ThreadTopology.h"
+
+namespace {
+    /// @~english
+    /// @brief The detected processors are consistent with the counts
+    /// @~japanese
+    /// @brief 検出したプロセッサが数と一致する
+    void TestDetect() {
+        CpuTopology topology;
+        topology.Detect();
+
+        const auto &processors = topology.GetProcessors();
+        TEST_CHECK(!processors.empty());
+        TEST_CHECK(0 < topology.GetCoreCount() && topology.GetCoreCount() <= processors.size());
+        TEST_CHECK(0 < topology.GetCacheDomainCount() && topology.GetCacheDomainCount() <= processors.size());
+        TEST_CHECK(topology.GetPerformanceCoreCount() <= topology.GetCoreCount());
+        for (size_t i = 0; i < processors.size(); ++i) {
+            TEST_CHECK(processors[i].coreIndex < topology.GetCoreCount());
+            TEST_CHECK(processors[i].cacheDomain < topology.GetCacheDomainCount());
+            TEST_CHECK(i == 0 || processors[i - 1].processorIndex < processors[i].processorIndex);
+        }
+    }
+
+    /// @~english
+    /// @brief Without pinning no thread gets a processor, with pinning every thread gets an allowed one
+    /// @~japanese
+    /// @brief 固定しない場合はどのスレッドもプロセッサを持たず、固定する場合は全スレッドが許可されたものを持つ
+    void TestPlacement() {
+        CpuTopology topology;
+        const bool detected = topology.Detect();
+        const auto &processors = topology.GetProcessors();
+
+        ThreadPlacementDesc desc;
+        desc.pinThreads = false;
+        ThreadPlacement unpinned;
+        unpinned.Init(topology, desc);
+        TEST_CHECK(!unpinned.IsPinned());
+        TEST_CHECK(unpinned.GetProcessor(ThreadRole::Main, 0) == INVALID_LOGICAL_PROCESSOR);
+        TEST_CHECK(unpinned.GetProcessor(ThreadRole::Worker, 3) == INVALID_LOGICAL_PROCESSOR);
+
+        desc.pinThreads = true;
+        ThreadPlacement pinned;
+        pinned.Init(topology, desc);
+        TEST_CHECK(pinned.IsPinned() == (processors.size() >= 3));
+        if (!pinned.IsPinned()) {
+            return;
+        }
+
+        const auto isDetected = [&processors](UINT processorIndex) {
+            return std::any_of(processors.begin(), processors.end(), [processorIndex](const LogicalProcessor &processor) {
+                return processor.processorIndex == processorIndex;
+            });
+        };
+        const UINT mainProcessor   = pinned.GetProcessor(ThreadRole::Main, 0);
+        const UINT renderProcessor = pinned.GetProcessor(ThreadRole::Render, 0);
+        TEST_CHECK(mainProcessor != renderProcessor);
+        TEST_CHECK(isDetected(mainProcessor) && isDetected(renderProcessor));
+        for (UINT worker = 0; worker < static_cast<UINT>(processors.size()) * 2; ++worker) {
+            const UINT processor = pinned.GetProcessor(ThreadRole::Worker, worker);
+            TEST_CHECK(isDetected(processor));
+            TEST_CHECK(processor != mainProcessor && processor != renderProcessor);
+        }
+
+        // Only a detected topology names processors the thread may be bound to
+        // 検出したトポロジのみがスレッドを固定できるプロセッサを指す
+        if (detected) {
+            TEST_CHECK(pinned.ApplyToCurrentThread(ThreadRole::Worker, 0));
+        }
+    }
+} // namespace ""
+
+int main() {
+    TestDetect();
+    TestPlacement();
+    return FinishTest("ThreadTopologyTest");
+}
@@ -0,0 +1,128 @@
+/// @file TickSchedulerTest.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include "JobSystem.h"
+#include "SceneActor.h"
+#include "TickScheduler.h"
+#include "TransformHierarchy.h"
+
+#include <deque>
+#include <random>
+
+using namespace DirectX;
+
+namespace {
+    const UINT TEST_DIAMOND_LEVEL_COUNT     = 48;       // 2^48 paths, only a search visiting each actor once finishes
+    const UINT TEST_ACTOR_COUNT             = 2000;     // More than DEFAULT_TICK_PARALLEL_MIN_COUNT
+    const UINT TEST_MAX_PREREQUISITE_COUNT  = 3;
+    const UINT TEST_FRAME_COUNT             = 3;
+    const UINT TEST_WORKER_COUNT            = 3;
+    const UINT TEST_SEED                    = 5;
+
+    /// @~english
+    /// @brief Actor recording the order it ticked in
+    /// @~japanese
+    /// @brief 更新された順序を記録するアクタ
+    class TestActor : public SceneActor {
+    public:
+        void Update(float delta) override {
+            sequence = (*counter)++;
+            tickCount++;
+        }
+
+        std::atomic<UINT>          *counter = nullptr;
+        UINT                        sequence = 0;
+        UINT                        tickCount = 0;
+        std::vector<TestActor *>    prerequisites;  ///< @~english Distinct prerequisites @~japanese 重複の無い前提条件
+    };
+
+    /// @~english
+    /// @brief Prerequisites shaped as a ladder of diamonds, each actor depends on both actors of the level below
+    /// @~japanese
+    /// @brief ダイヤモンドを積み重ねた形の前提条件、各アクタは1つ下の段の両方のアクタに依存する
+    void TestDiamondGraph() {
+        TickScheduler scheduler;
+        std::deque<TestActor> actors(TEST_DIAMOND_LEVEL_COUNT * 2);
+        for (auto &actor : actors) {
+            scheduler.Register(&actor);
+        }
+
+        UINT failedCount = 0;
+        for (UINT level = 1; level < TEST_DIAMOND_LEVEL_COUNT; ++level) {
+            for (UINT i = 0; i < 2; ++i) {
+                for (UINT j = 0; j < 2; ++j) {
+                    failedCount += scheduler.AddPrerequisite(&actors[level * 2 + i], &actors[(level - 1) * 2 + j]) ? 0 : 1;
+                }
+            }
+        }
+        TEST_CHECK(failedCount == 0);
+
+        // Closing a cycle through every level is rejected, as is depending on itself
+        // 全段を通る循環を閉じる依存は拒否され、自身への依存も同様
+        TEST_CHECK(!scheduler.AddPrerequisite(&actors[0], &actors[TEST_DIAMOND_LEVEL_COUNT * 2 - 1]));
+        TEST_CHECK(!scheduler.AddPrerequisite(&actors[0], &actors[0]));
+        TEST_CHECK(scheduler.AddPrerequisite(&actors[TEST_DIAMOND_LEVEL_COUNT * 2 - 1], &actors[0]));
+    }
+
+    /// @~english
+    /// @brief Every actor ticks once per frame after its prerequisites, with and without workers
+    /// @~japanese
+    /// @brief ワーカーの有無によらず、全アクタは前提条件の後にフレーム毎に1回更新される
+    void TestOrder() {
+        JobSystem jobSystem;
+        TEST_CHECK(jobSystem.Init(TEST_WORKER_COUNT));
+        TransformHierarchy hierarchy;
+
+        for (JobSystem *tickJobSystem : { static_cast<JobSystem *>(nullptr), &jobSystem }) {
+            std::mt19937 rng(TEST_SEED);
+            std::atomic<UINT> counter(0);
+            TickScheduler scheduler;
+            std::deque<TestActor> actors(TEST_ACTOR_COUNT);
+            UINT dependencyCount = 0;
+            for (UINT i = 0; i < TEST_ACTOR_COUNT; ++i) {
+                actors[i].counter = &counter;
+                scheduler.Register(&actors[i]);
+
+                // Prerequisites among the earlier actors keep the graph acyclic
+                // 前のアクタの中から前提条件を選ぶ事でグラフは循環しない
+                const UINT prerequisiteCount = (i == 0) ? 0 : rng() % (TEST_MAX_PREREQUISITE_COUNT + 1);
+                for (UINT p = 0; p < prerequisiteCount; ++p) {
+                    TestActor *prerequisite = &actors[rng() % i];
+                    TEST_CHECK(scheduler.AddPrerequisite(&actors[i], prerequisite));
+                    auto &prerequisites = actors[i].prerequisites;
+                    if (std::find(prerequisites.begin(), prerequisites.end(), prerequisite) == prerequisites.end()) {
+                        prerequisites.push_back(prerequisite);
+                        dependencyCount++;
+                    }
+                }
+            }
+
+            for (UINT frame = 0; frame < TEST_FRAME_COUNT; ++frame) {
+                scheduler.Tick(1.0f / 60.0f, XMVectorZero(), hierarchy, tickJobSystem);
+
+                UINT orderErrorCount = 0;
+                UINT tickErrorCount  = 0;
+                for (const auto &actor : actors) {
+                    tickErrorCount += (actor.tickCount == frame + 1) ? 0 : 1;
+                    for (auto prerequisite : actor.prerequisites) {
+                        orderErrorCount += (prerequisite->sequence < actor.sequence) ? 0 : 1;
+                    }
+                }
+                TEST_CHECK(orderErrorCount == 0);
+                TEST_CHECK(tickErrorCount == 0);
+                TEST_CHECK(scheduler.GetStats(TickGroup::Update).tickedCount == TEST_ACTOR_COUNT);
+                TEST_CHECK(scheduler.GetStats(TickGroup::Update).dependencyCount == dependencyCount);
+            }
+        }
+
+        jobSystem.Deinit();
+    }
+} // namespace ""
+
+int main() {
+    TestDiamondGraph();
+    TestOrder();
+    return FinishTest("TickSchedulerTest");
+}
@@ -0,0 +1,119 @@
+/// @file TransformHierarchyTest.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include "JobSystem.h"
+#include "TransformHierarchy.h"
+
+using namespace DirectX;
+
+namespace {
+    const UINT TEST_GRAIN           = DEFAULT_TRANSFORM_TASK_GRAIN;
+    const UINT TEST_CHAIN_COUNT     = 4;
+    const UINT TEST_WORKER_COUNT    = 3;
+
+    /// @~english
+    /// @brief Append a chain of parent and child under a parent
+    /// @~japanese
+    /// @brief 親の下に親子の連鎖を追加
+    void AppendChain(UINT parent, UINT length, std::vector<UINT> *parents) {
+        for (UINT i = 0; i < length; ++i) {
+            const UINT index = static_cast<UINT>(parents->size());
+            parents->push_back((i == 0) ? parent : index - 1);
+        }
+    }
+
+    /// @~english
+    /// @brief Append leaves under a parent
+    /// @~japanese
+    /// @brief 親の下に葉を追加
+    void AppendLeaves(UINT parent, UINT count, std::vector<UINT> *parents) {
+        parents->insert(parents->end(), count, parent);
+    }
+
+    /// @~english
+    /// @brief Update a hierarchy built from parents in pre-order and compare it with updating the nodes one by one
+    /// @return Statistics of the update
+    /// @~japanese
+    /// @brief 前順の親から構築した階層を更新し、ノードを1つずつ更新した結果と比較する
+    /// @return 更新の統計情報
+    TransformHierarchyStats CheckUpdate(const std::vector<UINT> &parents, JobSystem *jobSystem) {
+        const UINT nodeCount = static_cast<UINT>(parents.size());
+        TransformHierarchy hierarchy;
+        std::vector<UINT> nodes(nodeCount);
+        std::vector<XMMATRIX> expected(nodeCount);
+        for (UINT i = 0; i < nodeCount; ++i) {
+            const float value = static_cast<float>(i % 7);
+            const XMVECTOR translation = XMVectorSet(value, 1.0f, -value, 1.0f);
+            const XMVECTOR rotation    = XMVectorSet(0.0f, value * 10.0f, 0.0f, 0.0f);
+            const XMVECTOR scale       = XMVectorSet(1.0f, 1.0f, 1.0f, 0.0f);
+            nodes[i] = hierarchy.CreateNode((parents[i] == INVALID_TRANSFORM_NODE) ? INVALID_TRANSFORM_NODE : nodes[parents[i]]);
+            hierarchy.SetLocalTransform(nodes[i], translation, rotation, scale);
+
+            const XMVECTOR rotationQuat = XMQuaternionRotationRollPitchYawFromVector(XMVectorScale(rotation, XM_PI / 180.0f));
+            const XMMATRIX localMtx = XMMatrixMultiply(XMMatrixMultiply(XMMatrixScalingFromVector(scale), XMMatrixRotationQuaternion(rotationQuat)), XMMatrixTranslationFromVector(translation));
+            expected[i] = (parents[i] == INVALID_TRANSFORM_NODE) ? localMtx : XMMatrixMultiply(localMtx, expected[parents[i]]);
+        }
+
+        hierarchy.UpdateWorldMatrices(jobSystem);
+        UINT mismatchCount = 0;
+        for (UINT i = 0; i < nodeCount; ++i) {
+            mismatchCount += (memcmp(&hierarchy.GetWorldMatrix(nodes[i]), &expected[i], sizeof(XMMATRIX)) != 0) ? 1 : 0;
+        }
+        TEST_CHECK(mismatchCount == 0);
+        return hierarchy.GetStats();
+    }
+
+    /// @~english
+    /// @brief Deep chains become one task each, without any serial node
+    /// @~japanese
+    /// @brief 深い連鎖は逐次処理のノード無しでそれぞれ1つのタスクとなる
+    void TestDeepChains(JobSystem *jobSystem) {
+        std::vector<UINT> parents;
+        for (UINT c = 0; c < TEST_CHAIN_COUNT; ++c) {
+            AppendChain(INVALID_TRANSFORM_NODE, TEST_GRAIN * 2, &parents);
+        }
+        const TransformHierarchyStats stats = CheckUpdate(parents, jobSystem);
+        TEST_CHECK(stats.serialNodeCount == 0);
+        TEST_CHECK(stats.taskCount == TEST_CHAIN_COUNT);
+    }
+
+    /// @~english
+    /// @brief Only the spine down to the split point is serial, the deep chain below it stays one task
+    /// @~japanese
+    /// @brief 分割点までの経路のみが逐次処理となり、その下の深い連鎖は1つのタスクのまま
+    void TestSpine(JobSystem *jobSystem) {
+        // 0 -> 1 -> (chain, leaves), 1 is the split point
+        // 0 -> 1 -> (連鎖、葉)、1が分割点
+        std::vector<UINT> parents;
+        AppendChain(INVALID_TRANSFORM_NODE, 2, &parents);
+        AppendChain(1, TEST_GRAIN * 3, &parents);
+        AppendLeaves(1, TEST_GRAIN * 2, &parents);
+        const TransformHierarchyStats stats = CheckUpdate(parents, jobSystem);
+        TEST_CHECK(stats.serialNodeCount == 2);
+        TEST_CHECK(3 <= stats.taskCount);
+
+        // A chain whose subtrees beside it are each small but large together
+        // 横のサブツリーは個々には小さいが合わせると大きい連鎖
+        parents.clear();
+        AppendChain(INVALID_TRANSFORM_NODE, 1, &parents);
+        AppendChain(0, TEST_GRAIN * 3, &parents);
+        for (UINT i = 0; i < TEST_GRAIN * 2; i += 8) {
+            AppendChain(0, 8, &parents);
+        }
+        const TransformHierarchyStats combStats = CheckUpdate(parents, jobSystem);
+        TEST_CHECK(combStats.serialNodeCount == 1);
+    }
+} // namespace ""
+
+int main() {
+    JobSystem jobSystem;
+    TEST_CHECK(jobSystem.Init(TEST_WORKER_COUNT));
+    for (JobSystem *system : { static_cast<JobSystem *>(nullptr), &jobSystem }) {
+        TestDeepChains(system);
+        TestSpine(system);
+    }
+    jobSystem.Deinit();
+    return FinishTest("TransformHierarchyTest");
+}
@@ -0,0 +1,125 @@
+/// @file SceneFeedProducer.cpp
+/// @author Masayoshi Kamai
+
+#include "stdafx.h"
+#include "SceneFeed.h"
+
+namespace {
+    const char *DEFAULT_PRODUCER_FEED_NAME      = "MTRendererSceneFeed";
+    const UINT  DEFAULT_PRODUCER_ACTOR_COUNT    = 1024;
+    const UINT  DEFAULT_PRODUCER_RATE           = 60;           // Frames per second
+    const UINT  DEFAULT_PRODUCER_FRAME_COUNT    = 3600;
+    const UINT  PRODUCER_RESPAWN_INTERVAL       = 120;          // Frames between two despawns of an actor group
+    const UINT  PRODUCER_RESPAWN_GROUP_COUNT    = 8;
+    const float PRODUCER_GRID_SPACING           = 1.5f;
+    const float PRODUCER_GRID_DEPTH             = 40.0f;        // In front of the default camera
+    const float PRODUCER_ACTOR_SCALE            = 0.5f;
+
+    /// @~english
+    /// @brief Get the number following an option of the command line
+    /// @~japanese
+    /// @brief コマンドラインのオプションに続く数値を取得
+    UINT GetOption(int argc, char **argv, const char *name, UINT defaultValue) {
+        for (int i = 1; i + 1 < argc; ++i) {
+            if (strcmp(argv[i], name) == 0) {
+                return static_cast<UINT>(strtoul(argv[i + 1], nullptr, 10));
+            }
+        }
+        return defaultValue;
+    }
+
+    /// @~english
+    /// @brief Get the string following an option of the command line
+    /// @~japanese
+    /// @brief コマンドラインのオプションに続く文字列を取得
+    const char* GetOption(int argc, char **argv, const char *name, const char *defaultValue) {
+        for (int i = 1; i + 1 < argc; ++i) {
+            if (strcmp(argv[i], name) == 0) {
+                return argv[i + 1];
+            }
+        }
+        return defaultValue;
+    }
+
+    /// @~english
+    /// @brief Write the record of an actor for a frame, the actors wave on a grid facing the camera
+    /// @~japanese
+    /// @brief フレームのアクタのレコードを書き込む、アクタはカメラに向いたグリッド上で波打つ
+    void FillRecord(SceneFeedRecord *record, SceneFeedRecordType type, UINT actorId, UINT gridSize, UINT frame, INT64 timestamp) {
+        const float phase  = static_cast<float>(frame) * (1.0f / static_cast<float>(DEFAULT_PRODUCER_RATE));
+        const float column = static_cast<float>(actorId % gridSize) - static_cast<float>(gridSize - 1) * 0.5f;
+        const float row    = static_cast<float>(actorId / gridSize) - static_cast<float>(gridSize - 1) * 0.5f;
+
+        *record = SceneFeedRecord();
+        record->timestamp      = timestamp;
+        record->type           = type;
+        record->actorId        = actorId;
+        record->translation[0] = column * PRODUCER_GRID_SPACING;
+        record->translation[1] = row * PRODUCER_GRID_SPACING + std::sin(phase * 2.0f + column * 0.3f) * 0.5f;
+        record->translation[2] = PRODUCER_GRID_DEPTH;
+        record->rotation[2]    = std::fmod(phase * 90.0f + static_cast<float>(actorId), 360.0f);
+        record->scale[0]       = PRODUCER_ACTOR_SCALE;
+        record->scale[1]       = PRODUCER_ACTOR_SCALE;
+        record->scale[2]       = PRODUCER_ACTOR_SCALE;
+    }
+} // namespace ""
+
+/// @~english
+/// @brief Stand-in for the simulation process driving the renderer through a scene feed
+/// @details Creates the feed, spawns the actors on the first frame and moves every actor each frame after.
+///          Every PRODUCER_RESPAWN_INTERVAL frames one group of actors is despawned and spawned again on the
+///          next frame, so the renderer sees all three record types. Records not fitting in the ring are
+///          dropped, the producer never waits for the renderer. Start it first, then the renderer with
+///          "-scenefeed <name>". "-name <name>", "-actors <count>", "-rate <frames per second>",
+///          "-frames <count>".
+/// @~japanese
+/// @brief シーンフィードを通してレンダラーを動かすシミュレーションプロセスの代役
+/// @details フィードを生成し、最初のフレームでアクタを出現させ、以降は毎フレーム全アクタを動かす。
+///          PRODUCER_RESPAWN_INTERVALフレーム毎にアクタの1グループを消滅させ次のフレームで再び出現させる為、
+///          レンダラーは3種のレコード全てを受け取る。リングに収まらないレコードは破棄し、生産者がレンダラーを
+///          待つ事はない。先に起動し、その後レンダラーを"-scenefeed <名前>"で起動する
+int main(int argc, char **argv) {
+    const char *name       = GetOption(argc, argv, "-name", DEFAULT_PRODUCER_FEED_NAME);
+    const UINT actorCount  = std::max(GetOption(argc, argv, "-actors", DEFAULT_PRODUCER_ACTOR_COUNT), 1u);
+    const UINT rate        = std::max(GetOption(argc, argv, "-rate", DEFAULT_PRODUCER_RATE), 1u);
+    const UINT frameCount  = GetOption(argc, argv, "-frames", DEFAULT_PRODUCER_FRAME_COUNT);
+    const UINT gridSize    = static_cast<UINT>(std::ceil(std::sqrt(static_cast<float>(actorCount))));
+
+    SceneFeed feed;
+    if (!feed.Create(name, DEFAULT_SCENE_FEED_CAPACITY, actorCount)) {
+        OutputDebugStringA("SceneFeed: could not create\n");
+        return -1;
+    }
+
+    std::vector<SceneFeedRecord> records(actorCount);
+    UINT64 droppedCount = 0;
+    const auto frameInterval = std::chrono::nanoseconds(1000000000ull / rate);
+    auto nextTime = std::chrono::steady_clock::now();
+    for (UINT frame = 0; frame < frameCount; ++frame) {
+        const INT64 timestamp = SceneFeed::GetTimestamp();
+        const UINT  respawnFrame = frame % PRODUCER_RESPAWN_INTERVAL;
+        const UINT  respawnGroup = (frame / PRODUCER_RESPAWN_INTERVAL) % PRODUCER_RESPAWN_GROUP_COUNT;
+        for (UINT actorId = 0; actorId < actorCount; ++actorId) {
+            SceneFeedRecordType type = SceneFeedRecordType::Transform;
+            if (frame == 0) {
+                type = SceneFeedRecordType::Spawn;
+            } else if (frame >= PRODUCER_RESPAWN_INTERVAL && actorId % PRODUCER_RESPAWN_GROUP_COUNT == respawnGroup) {
+                type = (respawnFrame == 0) ? SceneFeedRecordType::Despawn : (respawnFrame == 1) ? SceneFeedRecordType::Spawn : SceneFeedRecordType::Transform;
+            }
+            FillRecord(&records[actorId], type, actorId, gridSize, frame, timestamp);
+        }
+
+        // One publish per frame, the records of a frame become visible to the renderer together
+        // フレーム毎に1回公開する、フレームのレコードはレンダラーから同時に見えるようになる
+        droppedCount += actorCount - feed.Publish(records.data(), actorCount);
+
+        nextTime += frameInterval;
+        std::this_thread::sleep_until(nextTime);
+    }
+
+    char reportStr[256];
+    snprintf(reportStr, sizeof(reportStr), "SceneFeedProducer: %u frames of %u actors, %llu records dropped\n",
+        frameCount, actorCount, static_cast<unsigned long long>(droppedCount));
+    OutputDebugStringA(reportStr);
+    return 0;
+}